@@ -0,0 +1,153 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "monitoring/statistics_impl.h"
+#include "port/lang.h"
+#include "port/port.h"
+#include "rocksdb/advanced_cache.h"
+#include "util/atomic.h"
+#include "util/hash.h"
+#include "util/math.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// Count-min sketch of 4-bit counters with four rows. All four counters of a
+// key are in the same 64-bit word, one in each quarter of it, so that
+// recording an access takes a single compare-and-swap. Counters saturate at
+// 15.
+//
+// To let old popularity fade, the sketch is split into kAgingSteps regions,
+// and the counters of the next region are halved after every
+// 10 * num_counters / kAgingSteps recorded accesses. Every counter is thus
+// halved once per 10 * num_counters accesses, but no lookup ever pays for
+// the whole sketch. Accesses are counted in kNumStripes counters on separate
+// cache lines, picked by key hash, rather than in one contended counter.
+class TinyLFUAdmissionPolicy : public CacheAdmissionPolicy {
+ public:
+  explicit TinyLFUAdmissionPolicy(const TinyLFUAdmissionPolicyOptions& opts)
+      : statistics_(opts.statistics),
+        admit_frequency_(std::min(opts.admit_frequency, kMaxCount)) {
+    size_t words = std::max(opts.num_counters / kCountersPerRowPerWord,
+                            kAgingSteps);
+    int bits = FloorLog2(words);
+    if ((size_t{1} << bits) < words) {
+      ++bits;
+    }
+    word_bits_ = bits;
+    num_words_ = size_t{1} << bits;
+    words_.reset(new std::atomic<uint64_t>[num_words_]);
+    for (size_t i = 0; i < num_words_; ++i) {
+      words_[i].store(0, std::memory_order_relaxed);
+    }
+    accesses_per_aging_step_ =
+        10 * num_words_ * kCountersPerRowPerWord / kAgingSteps;
+  }
+
+  const char* Name() const override { return "TinyLFUAdmissionPolicy"; }
+
+  void RecordAccess(const Slice& key) override {
+    const uint64_t hash = GetSliceHash64(key);
+    std::atomic<uint64_t>& word = Word(hash);
+    uint64_t old = word.load(std::memory_order_relaxed);
+    for (;;) {
+      uint64_t updated = old;
+      for (int row = 0; row < kNumRows; ++row) {
+        const int shift = Shift(hash, row);
+        if (((old >> shift) & kMaxCount) < kMaxCount) {
+          updated += uint64_t{1} << shift;
+        }
+      }
+      if (updated == old ||
+          word.compare_exchange_weak(old, updated,
+                                     std::memory_order_relaxed)) {
+        break;
+      }
+    }
+    Stripe& stripe = stripes_[(hash >> 8) & (kNumStripes - 1)];
+    if ((stripe.accesses.FetchAddRelaxed(1) + 1) % accesses_per_aging_step_ ==
+        0) {
+      AgeStep();
+    }
+  }
+
+  bool Admit(const Slice& key) override {
+    const bool admit = Estimate(GetSliceHash64(key)) >= admit_frequency_;
+    RecordTick(statistics_.get(),
+               admit ? CACHE_ADMISSION_ADMITS : CACHE_ADMISSION_REJECTS);
+    return admit;
+  }
+
+ private:
+  static constexpr int kNumRows = 4;
+  // Each row has four counters in each word
+  static constexpr size_t kCountersPerRowPerWord = 4;
+  static constexpr uint32_t kMaxCount = 15;
+  static constexpr size_t kAgingSteps = 64;
+  static constexpr size_t kNumStripes = 16;
+
+  struct ALIGN_AS(CACHE_LINE_SIZE) Stripe {
+    RelaxedAtomic<uint64_t> accesses{0};
+  };
+
+  // The word is picked by the top bits of the hash
+  std::atomic<uint64_t>& Word(uint64_t hash) const {
+    return words_[static_cast<size_t>(hash >> (64 - word_bits_))];
+  }
+
+  // Bit offset of the counter of `row` in its word, picked by two of the
+  // low bits of the hash within the row's quarter of the word
+  static int Shift(uint64_t hash, int row) {
+    const int counter = static_cast<int>((hash >> (row * 2)) & 3);
+    return (row * 4 + counter) * 4;
+  }
+
+  uint32_t Estimate(uint64_t hash) const {
+    const uint64_t word = Word(hash).load(std::memory_order_relaxed);
+    uint32_t min_count = kMaxCount;
+    for (int row = 0; row < kNumRows; ++row) {
+      min_count = std::min(
+          min_count, static_cast<uint32_t>((word >> Shift(hash, row)) & 0xF));
+    }
+    return min_count;
+  }
+
+  // Halves every counter in the next region. Concurrent increments may be
+  // lost, which only makes the estimates slightly lower.
+  void AgeStep() {
+    const size_t words_per_step = num_words_ / kAgingSteps;
+    const size_t begin =
+        (next_aging_step_.FetchAddRelaxed(1) % kAgingSteps) * words_per_step;
+    for (size_t i = begin; i < begin + words_per_step; ++i) {
+      uint64_t word = words_[i].load(std::memory_order_relaxed);
+      words_[i].store((word >> 1) & 0x7777777777777777ULL,
+                      std::memory_order_relaxed);
+    }
+  }
+
+  const std::shared_ptr<Statistics> statistics_;
+  const uint32_t admit_frequency_;
+  int word_bits_ = 0;
+  size_t num_words_ = 0;
+  std::unique_ptr<std::atomic<uint64_t>[]> words_;
+  uint64_t accesses_per_aging_step_ = 0;
+  Stripe stripes_[kNumStripes];
+  RelaxedAtomic<size_t> next_aging_step_{0};
+};
+
+}  // namespace
+
+std::shared_ptr<CacheAdmissionPolicy> NewTinyLFUAdmissionPolicy(
+    const TinyLFUAdmissionPolicyOptions& opts) {
+  return std::make_shared<TinyLFUAdmissionPolicy>(opts);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -18,6 +18,7 @@
 #include "cache/lru_cache.h"
 #include "cache/typed_cache.h"
 #include "port/stack_trace.h"
+#include "rocksdb/statistics.h"
 #include "test_util/secondary_cache_test_util.h"
 #include "test_util/testharness.h"
 #include "util/coding.h"
@@ -921,6 +922,73 @@ TEST_P(CacheTest, GetChargeAndDeleter) {
   cache_->Release(h1);
 }
 
+TEST_P(CacheTest, AdmissionPolicy) {
+  TinyLFUAdmissionPolicyOptions policy_opts;
+  policy_opts.num_counters = 1024;
+  policy_opts.statistics = CreateDBStatistics();
+  std::shared_ptr<Cache> cache =
+      NewCache(10, [&](ShardedCacheOptions& opts) {
+        opts.num_shard_bits = 0;
+        opts.metadata_charge_policy = kDontChargeCacheMetadata;
+        opts.admission_policy = NewTinyLFUAdmissionPolicy(policy_opts);
+      });
+  Statistics* stats = policy_opts.statistics.get();
+
+  // Everything fits, so the policy is not consulted
+  for (int i = 0; i < 10; ++i) {
+    Insert(cache, i, i + 1);
+  }
+  ASSERT_EQ(stats->getTickerCount(CACHE_ADMISSION_ADMITS), 0);
+  ASSERT_EQ(stats->getTickerCount(CACHE_ADMISSION_REJECTS), 0);
+
+  // A key never looked up is rejected and does not displace anything
+  Insert(cache, 100, 101);
+  ASSERT_EQ(stats->getTickerCount(CACHE_ADMISSION_REJECTS), 1);
+  ASSERT_EQ(deleted_values_, std::vector<int>{101});
+  ASSERT_EQ(Lookup(cache, 100), -1);
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(Lookup(cache, i), i + 1);
+  }
+
+  // With a handle requested, the caller keeps the rejected object
+  Cache::Handle* handle = nullptr;
+  Status s = cache->Insert(EncodeKey(200), EncodeValue(201), &kHelper, 1,
+                           &handle);
+  ASSERT_TRUE(s.IsIncomplete());
+  ASSERT_EQ(handle, nullptr);
+  ASSERT_EQ(deleted_values_.size(), 1);
+
+  // After two lookups the key is popular enough to be admitted
+  ASSERT_EQ(Lookup(cache, 100), -1);
+  Insert(cache, 100, 101);
+  ASSERT_EQ(stats->getTickerCount(CACHE_ADMISSION_ADMITS), 1);
+  ASSERT_EQ(Lookup(cache, 100), 101);
+
+  // Reservations without an object are never rejected
+  ASSERT_OK(cache->Insert(EncodeKey(300), nullptr, &kNoopCacheItemHelper, 1,
+                          &handle));
+  cache->Release(handle);
+}
+
+TEST_P(CacheTest, AdmissionPolicyAging) {
+  TinyLFUAdmissionPolicyOptions policy_opts;
+  policy_opts.num_counters = 1024;
+  std::shared_ptr<CacheAdmissionPolicy> policy =
+      NewTinyLFUAdmissionPolicy(policy_opts);
+  policy->RecordAccess(EncodeKey(1));
+  policy->RecordAccess(EncodeKey(1));
+  ASSERT_TRUE(policy->Admit(EncodeKey(1)));
+  ASSERT_FALSE(policy->Admit(EncodeKey(2)));
+
+  // Every counter is halved once per 10 * num_counters lookups, even when
+  // they all hit the same key
+  for (size_t i = 0; i < 10 * policy_opts.num_counters; ++i) {
+    policy->RecordAccess(EncodeKey(2));
+  }
+  ASSERT_FALSE(policy->Admit(EncodeKey(1)));
+  ASSERT_TRUE(policy->Admit(EncodeKey(2)));
+}
+
 namespace {
 bool AreTwoCacheKeysOrdered(Cache* cache) {
   std::vector<std::string> keys;
@@ -131,6 +131,12 @@ inline bool ClockUpdate(ClockHandle& h, BaseClockTable::EvictionData* data,
     data->seen_pinned_count++;
     return false;
   }
+  if ((meta >> ClockHandle::kStateShift == ClockHandle::kStateVisible) &&
+      (meta & ClockHandle::kProtectedBitMask) && !data->protected_over_limit) {
+    // Protected segment within its limit (segmented mode)
+    data->seen_protected_count++;
+    return false;
+  }
   if ((meta >> ClockHandle::kStateShift == ClockHandle::kStateVisible) &&
       acquire_count > 0) {
     // Decrement clock
@@ -140,12 +146,27 @@ inline bool ClockUpdate(ClockHandle& h, BaseClockTable::EvictionData* data,
     // not aggressively
     uint64_t new_meta =
         (uint64_t{ClockHandle::kStateVisible} << ClockHandle::kStateShift) |
-        (meta & ClockHandle::kHitBitMask) |
+        (meta & (ClockHandle::kHitBitMask | ClockHandle::kProtectedBitMask)) |
         (new_count << ClockHandle::kReleaseCounterShift) |
         (new_count << ClockHandle::kAcquireCounterShift);
     h.meta.CasStrongRelaxed(meta, new_meta);
     return false;
   }
+  if ((meta >> ClockHandle::kStateShift == ClockHandle::kStateVisible) &&
+      (meta & ClockHandle::kProtectedBitMask)) {
+    // Expired protected entry (segmented mode). Demote to probation rather
+    // than evict, keeping the hit bit so that one more hit promotes it again.
+    uint64_t new_count = ClockHandle::kLowCountdown;
+    uint64_t new_meta =
+        (uint64_t{ClockHandle::kStateVisible} << ClockHandle::kStateShift) |
+        (meta & ClockHandle::kHitBitMask) |
+        (new_count << ClockHandle::kReleaseCounterShift) |
+        (new_count << ClockHandle::kAcquireCounterShift);
+    if (h.meta.CasStrongRelaxed(meta, new_meta)) {
+      data->left_protected_count += 1;
+    }
+    return false;
+  }
   // Otherwise, remove entry (either unreferenced invisible or
   // unreferenced and expired visible).
   if (h.meta.CasStrong(meta, (uint64_t{ClockHandle::kStateConstruction}
@@ -154,6 +175,9 @@ inline bool ClockUpdate(ClockHandle& h, BaseClockTable::EvictionData* data,
     // Took ownership.
     data->freed_charge += h.GetTotalCharge();
     data->freed_count += 1;
+    if (meta & ClockHandle::kProtectedBitMask) {
+      data->left_protected_count += 1;
+    }
     return true;
   } else {
     // Compare-exchange failing probably
@@ -465,9 +489,11 @@ Status BaseClockTable::ChargeUsageMaybeEvictStrict(
   }
   if (request_evict_charge > 0) {
     EvictionData data;
+    data.protected_over_limit = IsProtectedOverLimit();
     static_cast<Table*>(this)->Evict(request_evict_charge, state, &data,
                                      eviction_effort_cap);
     occupancy_.FetchSub(data.freed_count);
+    protected_occupancy_.FetchSubRelaxed(data.left_protected_count);
     if (LIKELY(data.freed_charge > need_evict_charge)) {
       assert(data.freed_count > 0);
       // Evicted more than enough
@@ -532,8 +558,10 @@ inline bool BaseClockTable::ChargeUsageMaybeEvictNonStrict(
   }
   EvictionData data;
   if (need_evict_charge > 0) {
+    data.protected_over_limit = IsProtectedOverLimit();
     static_cast<Table*>(this)->Evict(need_evict_charge, state, &data,
                                      eviction_effort_cap);
+    protected_occupancy_.FetchSubRelaxed(data.left_protected_count);
     // Deal with potential occupancy deficit
     if (UNLIKELY(need_evict_for_occupancy) && data.freed_count == 0) {
       assert(data.freed_charge == 0);
@@ -578,6 +606,19 @@ bool IsEvictionEffortExceeded(const BaseClockTable::EvictionData& data,
          data.seen_pinned_count;
 }
 
+// In segmented mode, an eviction run that skipped protected entries and is
+// about to give up (e.g. because every probation entry is pinned) instead
+// starts aging the protected segment, with a fresh eviction effort
+// allowance. Returns true if the run should continue.
+bool MaybeStartAgingProtected(BaseClockTable::EvictionData* data) {
+  if (data->protected_over_limit || data->seen_protected_count == 0) {
+    return false;
+  }
+  data->protected_over_limit = true;
+  data->seen_pinned_count = 0;
+  return true;
+}
+
 template <class Table>
 Status BaseClockTable::Insert(const ClockHandleBasicData& proto,
                               typename Table::HandleImpl** handle,
@@ -723,7 +764,7 @@ FixedHyperClockTable::FixedHyperClockTable(
     const Cache::EvictionCallback* eviction_callback, const uint32_t* hash_seed,
     const Opts& opts)
     : BaseClockTable(metadata_charge_policy, allocator, eviction_callback,
-                     hash_seed),
+                     hash_seed, opts.segmented),
       length_bits_(CalcHashBits(capacity, opts.estimated_value_size,
                                 metadata_charge_policy)),
       length_bits_mask_((size_t{1} << length_bits_) - 1),
@@ -864,9 +905,7 @@ FixedHyperClockTable::HandleImpl* FixedHyperClockTable::Lookup(
           if (h->hashed_key == hashed_key) {
             // Match
             // Update the hit bit
-            if (eviction_callback_) {
-              h->meta.FetchOrRelaxed(uint64_t{1} << ClockHandle::kHitBitShift);
-            }
+            TrackHit(h);
             return true;
           } else {
             // Mismatch. Pretend we never took the reference
@@ -945,6 +984,7 @@ bool FixedHyperClockTable::Release(HandleImpl* h, bool useful,
         !h->meta.CasWeak(old_meta, uint64_t{ClockHandle::kStateConstruction}
                                        << ClockHandle::kStateShift));
     // Took ownership
+    TrackRemoval(old_meta);
     size_t total_charge = h->GetTotalCharge();
     if (UNLIKELY(h->IsStandalone())) {
       h->FreeData(allocator_);
@@ -1009,6 +1049,7 @@ void FixedHyperClockTable::Erase(const UniqueId64x2& hashed_key) {
                                            << ClockHandle::kStateShift)) {
                 // Took ownership
                 assert(hashed_key == h->hashed_key);
+                TrackRemoval(old_meta);
                 size_t total_charge = h->GetTotalCharge();
                 FreeDataMarkEmpty(*h, allocator_);
                 ReclaimEntryUsage(total_charge);
@@ -1047,6 +1088,7 @@ void FixedHyperClockTable::EraseUnRefEntries() {
         h.meta.CasStrong(old_meta, uint64_t{ClockHandle::kStateConstruction}
                                        << ClockHandle::kStateShift)) {
       // Took ownership
+      TrackRemoval(old_meta);
       size_t total_charge = h.GetTotalCharge();
       Rollback(h.hashed_key, &h);
       FreeDataMarkEmpty(h, allocator_);
@@ -1147,9 +1189,16 @@ inline void FixedHyperClockTable::Evict(size_t requested_charge, InsertState&,
       return;
     }
     if (old_clock_pointer >= max_clock_pointer) {
-      return;
+      if (!MaybeStartAgingProtected(data)) {
+        return;
+      }
+      // Enough circles for a protected entry to count down, be demoted, and
+      // count down again in probation
+      max_clock_pointer =
+          old_clock_pointer + (3 * ClockHandle::kMaxCountdown << length_bits_);
     }
-    if (IsEvictionEffortExceeded(*data, eviction_effort_cap)) {
+    if (IsEvictionEffortExceeded(*data, eviction_effort_cap) &&
+        !MaybeStartAgingProtected(data)) {
       eviction_effort_exceeded_count_.FetchAddRelaxed(1);
       return;
     }
@@ -1396,6 +1445,18 @@ size_t ClockCacheShard<Table>::GetOccupancyCount() const {
   return table_.GetOccupancy();
 }
 
+template <class Table>
+size_t ClockCacheShard<Table>::GetProbationOccupancyCount() const {
+  size_t occupancy = table_.GetOccupancy();
+  // The two counters are not updated together
+  return occupancy - std::min(occupancy, table_.GetProtectedOccupancy());
+}
+
+template <class Table>
+size_t ClockCacheShard<Table>::GetProtectedOccupancyCount() const {
+  return table_.GetProtectedOccupancy();
+}
+
 template <class Table>
 size_t ClockCacheShard<Table>::GetOccupancyLimit() const {
   return table_.GetOccupancyLimit();
@@ -1406,6 +1467,14 @@ size_t ClockCacheShard<Table>::GetTableAddressCount() const {
   return table_.GetTableSize();
 }
 
+template <class Table>
+void ClockCacheShard<Table>::AppendPrintableOptions(std::string& str) const {
+  const int kBufferSize = 200;
+  char buffer[kBufferSize];
+  snprintf(buffer, kBufferSize, "    segmented : %d\n", table_.IsSegmented());
+  str.append(buffer);
+}
+
 // Explicit instantiation
 template class ClockCacheShard<FixedHyperClockTable>;
 template class ClockCacheShard<AutoHyperClockTable>;
@@ -1444,6 +1513,16 @@ const Cache::CacheItemHelper* BaseHyperClockCache<Table>::GetCacheItemHelper(
   return h->helper;
 }
 
+template <class Table>
+size_t BaseHyperClockCache<Table>::GetProbationOccupancyCount() const {
+  return this->SumOverShards2(&Shard::GetProbationOccupancyCount);
+}
+
+template <class Table>
+size_t BaseHyperClockCache<Table>::GetProtectedOccupancyCount() const {
+  return this->SumOverShards2(&Shard::GetProtectedOccupancyCount);
+}
+
 namespace {
 
 // For each cache shard, estimate what the table load factor would be if
@@ -1958,7 +2037,7 @@ AutoHyperClockTable::AutoHyperClockTable(
     const Cache::EvictionCallback* eviction_callback, const uint32_t* hash_seed,
     const Opts& opts)
     : BaseClockTable(metadata_charge_policy, allocator, eviction_callback,
-                     hash_seed),
+                     hash_seed, opts.segmented),
       array_(MemMapping::AllocateLazyZeroed(
           sizeof(HandleImpl) * CalcMaxUsableLength(capacity,
                                                    opts.min_avg_value_size,
@@ -3149,6 +3228,7 @@ AutoHyperClockTable::HandleImpl* AutoHyperClockTable::Lookup(
         if (LIKELY(h->hashed_key == hashed_key) &&
             LIKELY(old_meta & (uint64_t{ClockHandle::kStateVisibleBit}
                                << ClockHandle::kStateShift))) {
+          TrackHit(h);
           return h;
         } else {
           Unref(*h);
@@ -3268,9 +3348,7 @@ AutoHyperClockTable::HandleImpl* AutoHyperClockTable::Lookup(
           Unref(*read_ref_on_chain);
         }
         // Update the hit bit
-        if (eviction_callback_) {
-          h->meta.FetchOrRelaxed(uint64_t{1} << ClockHandle::kHitBitShift);
-        }
+        TrackHit(h);
         // All done.
         return h;
       } else if (UNLIKELY(shift != home_shift) &&
@@ -3348,6 +3426,7 @@ bool AutoHyperClockTable::TryEraseHandle(HandleImpl* h, bool holding_ref,
   } while (!h->meta.CasWeak(meta, uint64_t{ClockHandle::kStateConstruction}
                                       << ClockHandle::kStateShift));
   // Took ownership
+  TrackRemoval(meta);
   // TODO? Delay freeing?
   h->FreeData(allocator_);
   size_t total_charge = h->total_charge;
@@ -3440,6 +3519,7 @@ void AutoHyperClockTable::EraseUnRefEntries() {
         h.meta.CasStrong(old_meta, uint64_t{ClockHandle::kStateConstruction}
                                        << ClockHandle::kStateShift)) {
       // Took ownership
+      TrackRemoval(old_meta);
       h.FreeData(allocator_);
       usage_.FetchSubRelaxed(h.total_charge);
       // NOTE: could be more efficient with a dedicated variant of
@@ -3542,10 +3622,18 @@ void AutoHyperClockTable::Evict(size_t requested_charge, InsertState& state,
     }
 
     if (old_clock_pointer + step_size >= max_clock_pointer) {
-      return;
+      if (!MaybeStartAgingProtected(data)) {
+        return;
+      }
+      // Enough circles for a protected entry to count down, be demoted, and
+      // count down again in probation
+      max_clock_pointer =
+          old_clock_pointer +
+          (uint64_t{3 * (ClockHandle::kMaxCountdown + 1)} * major_step);
     }
 
-    if (IsEvictionEffortExceeded(*data, eviction_effort_cap)) {
+    if (IsEvictionEffortExceeded(*data, eviction_effort_cap) &&
+        !MaybeStartAgingProtected(data)) {
       eviction_effort_exceeded_count_.FetchAddRelaxed(1);
       return;
     }
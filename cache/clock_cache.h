@@ -107,6 +107,16 @@ class ClockCacheTest;
 // because entries can be referenced transiently within the cache even when
 // there are no outside references to the entry.
 //
+// With HyperClockCacheOptions::segmented, each entry is also in either the
+// probation or the protected segment, tracked by a bit in the meta word. New
+// entries are in probation, and the second Lookup hit (hit bit already set)
+// moves an entry to protected. Eviction skips protected entries unless they
+// are more than 80% of the entries in the shard. In that case, they are aged
+// like the rest, and a protected entry reaching score 0 is demoted to
+// probation with a fresh LOW score instead of being evicted. Entries hit at
+// most once, such as blocks filled by long scans, thus only ever displace
+// each other and the other probation entries.
+//
 // Cache sharding like LRUCache is used to reduce contention on usage+eviction
 // state, though here the performance improvement from more shards is small,
 // and (as noted above) potentially detrimental if shard capacity is too close
@@ -320,11 +330,11 @@ struct ClockHandle : public ClockHandleBasicData {
   // state of the handle. The meta word looks like this:
   // low bits                                                     high bits
   // -----------------------------------------------------------------------
-  // | acquire counter      | release counter     | hit bit | state marker |
+  // | acquire counter | release counter | hit bit | protected bit | state |
   // -----------------------------------------------------------------------
 
   // For reading or updating counters in meta word.
-  static constexpr uint8_t kCounterNumBits = 30;
+  static constexpr uint8_t kCounterNumBits = 29;
   static constexpr uint64_t kCounterMask = (uint64_t{1} << kCounterNumBits) - 1;
 
   static constexpr uint8_t kAcquireCounterShift = 0;
@@ -338,8 +348,14 @@ struct ClockHandle : public ClockHandleBasicData {
   static constexpr uint8_t kHitBitShift = 2U * kCounterNumBits;
   static constexpr uint64_t kHitBitMask = uint64_t{1} << kHitBitShift;
 
+  // For marking entries in the protected segment (only set in segmented
+  // mode, see HyperClockCacheOptions::segmented)
+  static constexpr uint8_t kProtectedBitShift = kHitBitShift + 1;
+  static constexpr uint64_t kProtectedBitMask = uint64_t{1}
+                                                << kProtectedBitShift;
+
   // For reading or updating the state marker in meta word
-  static constexpr uint8_t kStateShift = kHitBitShift + 1;
+  static constexpr uint8_t kStateShift = kProtectedBitShift + 1;
 
   // Bits contribution to state marker.
   // Occupied means any state other than empty
@@ -376,21 +392,23 @@ struct ClockHandle : public ClockHandleBasicData {
 class BaseClockTable {
  public:
   struct BaseOpts {
-    explicit BaseOpts(int _eviction_effort_cap)
-        : eviction_effort_cap(_eviction_effort_cap) {}
+    explicit BaseOpts(int _eviction_effort_cap, bool _segmented = false)
+        : eviction_effort_cap(_eviction_effort_cap), segmented(_segmented) {}
     explicit BaseOpts(const HyperClockCacheOptions& opts)
-        : BaseOpts(opts.eviction_effort_cap) {}
+        : BaseOpts(opts.eviction_effort_cap, opts.segmented) {}
     int eviction_effort_cap;
+    bool segmented;
   };
 
   BaseClockTable(CacheMetadataChargePolicy metadata_charge_policy,
                  MemoryAllocator* allocator,
                  const Cache::EvictionCallback* eviction_callback,
-                 const uint32_t* hash_seed)
+                 const uint32_t* hash_seed, bool segmented)
       : metadata_charge_policy_(metadata_charge_policy),
         allocator_(allocator),
         eviction_callback_(*eviction_callback),
-        hash_seed_(*hash_seed) {}
+        hash_seed_(*hash_seed),
+        segmented_(segmented) {}
 
   template <class Table>
   typename Table::HandleImpl* CreateStandalone(ClockHandleBasicData& proto,
@@ -411,6 +429,14 @@ class BaseClockTable {
 
   size_t GetStandaloneUsage() const { return standalone_usage_.LoadRelaxed(); }
 
+  // Number of entries in the table that are in the protected segment. Always
+  // zero unless segmented. The rest of the occupancy is in probation.
+  size_t GetProtectedOccupancy() const {
+    return protected_occupancy_.LoadRelaxed();
+  }
+
+  bool IsSegmented() const { return segmented_; }
+
   uint32_t GetHashSeed() const { return hash_seed_; }
 
   uint64_t GetYieldCount() const { return yield_count_.LoadRelaxed(); }
@@ -423,10 +449,61 @@ class BaseClockTable {
     size_t freed_charge = 0;
     size_t freed_count = 0;
     size_t seen_pinned_count = 0;
+    // Entries that left the protected segment, whether freed or demoted
+    // to probation
+    size_t left_protected_count = 0;
+    // Protected entries skipped because the segment was within its limit
+    size_t seen_protected_count = 0;
+    // Whether protected entries are subject to clock updates in this
+    // eviction run. Initialized from IsProtectedOverLimit(), and set by the
+    // eviction run itself if probation has nothing to give (see
+    // MaybeStartAgingProtected()).
+    bool protected_over_limit = false;
   };
 
   void TrackAndReleaseEvictedEntry(ClockHandle* h);
 
+  // Sets the hit bit on a successful lookup. In segmented mode, this also
+  // promotes a probation entry to protected on its second hit.
+  inline void TrackHit(ClockHandle* h) {
+    if (segmented_) {
+      uint64_t meta = h->meta.LoadRelaxed();
+      if (meta & ClockHandle::kProtectedBitMask) {
+        return;
+      }
+      if ((meta & ClockHandle::kHitBitMask) == 0) {
+        h->meta.FetchOrRelaxed(ClockHandle::kHitBitMask);
+        return;
+      }
+      // We hold a reference, so the entry cannot be removed concurrently,
+      // and the owner of the transition updates the counter.
+      uint64_t old_meta =
+          h->meta.FetchOrRelaxed(ClockHandle::kProtectedBitMask);
+      if ((old_meta & ClockHandle::kProtectedBitMask) == 0) {
+        protected_occupancy_.FetchAddRelaxed(1);
+      }
+    } else if (eviction_callback_) {
+      h->meta.FetchOrRelaxed(ClockHandle::kHitBitMask);
+    }
+  }
+
+  // In segmented mode, the protected segment is only aged by eviction while
+  // it holds more than kMaxProtectedPercent of the entries. Otherwise,
+  // eviction takes entries from probation only.
+  static constexpr size_t kMaxProtectedPercent = 80;
+  inline bool IsProtectedOverLimit() const {
+    return protected_occupancy_.LoadRelaxed() * 100 >
+           occupancy_.LoadRelaxed() * kMaxProtectedPercent;
+  }
+
+  // To be called with the meta word an entry had just before being taken
+  // out of the table (other than by eviction, see EvictionData).
+  inline void TrackRemoval(uint64_t old_meta) {
+    if (old_meta & ClockHandle::kProtectedBitMask) {
+      protected_occupancy_.FetchSubRelaxed(1);
+    }
+  }
+
 #ifndef NDEBUG
   // Acquire N references
   void TEST_RefN(ClockHandle& handle, size_t n);
@@ -497,6 +574,10 @@ class BaseClockTable {
   // Part of usage by standalone entries (not in table)
   AcqRelAtomic<size_t> standalone_usage_{};
 
+  // Part of occupancy in the protected segment (segmented mode only)
+  // (Relaxed: a stat counter.)
+  RelaxedAtomic<size_t> protected_occupancy_{};
+
   ALIGN_AS(CACHE_LINE_SIZE)
   const CacheMetadataChargePolicy metadata_charge_policy_;
 
@@ -508,6 +589,9 @@ class BaseClockTable {
 
   // A reference to ShardedCacheBase::hash_seed_
   const uint32_t& hash_seed_;
+
+  // See HyperClockCacheOptions::segmented
+  const bool segmented_;
 };
 
 // Hash table for cache entries with size determined at creation time.
@@ -543,8 +627,7 @@ class FixedHyperClockTable : public BaseClockTable {
     explicit Opts(size_t _estimated_value_size, int _eviction_effort_cap)
         : BaseOpts(_eviction_effort_cap),
           estimated_value_size(_estimated_value_size) {}
-    explicit Opts(const HyperClockCacheOptions& opts)
-        : BaseOpts(opts.eviction_effort_cap) {
+    explicit Opts(const HyperClockCacheOptions& opts) : BaseOpts(opts) {
       assert(opts.estimated_entry_charge > 0);
       estimated_value_size = opts.estimated_entry_charge;
     }
@@ -833,8 +916,7 @@ class AutoHyperClockTable : public BaseClockTable {
         : BaseOpts(_eviction_effort_cap),
           min_avg_value_size(_min_avg_value_size) {}
 
-    explicit Opts(const HyperClockCacheOptions& opts)
-        : BaseOpts(opts.eviction_effort_cap) {
+    explicit Opts(const HyperClockCacheOptions& opts) : BaseOpts(opts) {
       assert(opts.estimated_entry_charge == 0);
       min_avg_value_size = opts.min_avg_entry_charge;
     }
@@ -1067,6 +1149,10 @@ class ALIGN_AS(CACHE_LINE_SIZE) ClockCacheShard final : public CacheShardBase {
 
   size_t GetOccupancyCount() const;
 
+  size_t GetProbationOccupancyCount() const;
+
+  size_t GetProtectedOccupancyCount() const;
+
   size_t GetOccupancyLimit() const;
 
   size_t GetTableAddressCount() const;
@@ -1081,6 +1167,8 @@ class ALIGN_AS(CACHE_LINE_SIZE) ClockCacheShard final : public CacheShardBase {
 
   std::string GetPrintableOptions() const { return std::string{}; }
 
+  void AppendPrintableOptions(std::string& str) const;
+
   HandleImpl* Lookup(const Slice& key, const UniqueId64x2& hashed_key,
                      const Cache::CacheItemHelper* /*helper*/,
                      Cache::CreateContext* /*create_context*/,
@@ -1128,6 +1216,12 @@ class BaseHyperClockCache : public ShardedCache<ClockCacheShard<Table>> {
 
   const CacheItemHelper* GetCacheItemHelper(Handle* handle) const override;
 
+  // Split of GetOccupancyCount() between the probation and protected
+  // segments. With HyperClockCacheOptions::segmented == false, all entries
+  // count as probation.
+  size_t GetProbationOccupancyCount() const;
+  size_t GetProtectedOccupancyCount() const;
+
   void ReportProblems(
       const std::shared_ptr<Logger>& /*info_log*/) const override;
 };
@@ -977,6 +977,49 @@ TEST_P(CompressedSecondaryCacheTest, SplictValueAndMergeChunksTest) {
   SplictValueAndMergeChunksTest();
 }
 
+TEST_P(CompressedSecondaryCacheTest, AdmissionPolicy) {
+  CompressedSecondaryCacheOptions opts;
+  opts.capacity = 3000;
+  opts.num_shard_bits = 0;
+  opts.compression_type = kNoCompression;
+  opts.metadata_charge_policy = kDontChargeCacheMetadata;
+  TinyLFUAdmissionPolicyOptions policy_opts;
+  policy_opts.statistics = CreateDBStatistics();
+  opts.admission_policy = NewTinyLFUAdmissionPolicy(policy_opts);
+  Statistics* stats = policy_opts.statistics.get();
+  std::shared_ptr<SecondaryCache> sec_cache = NewCompressedSecondaryCache(opts);
+
+  Random rnd(301);
+  std::string str = rnd.RandomString(1000);
+  TestItem item(str.data(), str.length());
+  ASSERT_OK(sec_cache->Insert(key0, &item, GetHelper(), true));
+  ASSERT_OK(sec_cache->Insert(key1, &item, GetHelper(), true));
+
+  // The cache is full and key2 was never looked up
+  ASSERT_OK(sec_cache->Insert(key2, &item, GetHelper(), true));
+  ASSERT_EQ(stats->getTickerCount(CACHE_ADMISSION_REJECTS), 1);
+  bool kept_in_sec_cache = false;
+  for (const std::string& key : {key2, key2, key0, key1}) {
+    std::unique_ptr<SecondaryCacheResultHandle> handle =
+        sec_cache->Lookup(key, GetHelper(), this, true,
+                          /*advise_erase=*/false, /*stats=*/nullptr,
+                          kept_in_sec_cache);
+    ASSERT_EQ(handle == nullptr, key == key2);
+    if (handle) {
+      delete static_cast<TestItem*>(handle->Value());
+    }
+  }
+
+  // Two misses later it is admitted
+  ASSERT_OK(sec_cache->Insert(key2, &item, GetHelper(), true));
+  ASSERT_EQ(stats->getTickerCount(CACHE_ADMISSION_ADMITS), 1);
+  std::unique_ptr<SecondaryCacheResultHandle> handle = sec_cache->Lookup(
+      key2, GetHelper(), this, true, /*advise_erase=*/false,
+      /*stats=*/nullptr, kept_in_sec_cache);
+  ASSERT_NE(handle, nullptr);
+  delete static_cast<TestItem*>(handle->Value());
+}
+
 using secondary_cache_test_util::WithCacheType;
 
 class CompressedSecCacheTestWithTiered
@@ -0,0 +1,582 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/flash_secondary_cache.h"
+
+#include <atomic>
+#include <cinttypes>
+#include <cstring>
+#include <limits>
+
+#include "rocksdb/env.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
+#include "util/mutexlock.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+const char* const kSegmentFileSuffix = ".fsc";
+}  // namespace
+
+// The I/O part of a lookup. Shared between the result handle and the
+// background job, either of which may perform the read.
+struct FlashSecondaryCache::ReadRequest {
+  enum State : int { kPending, kReading, kDone };
+
+  std::shared_ptr<FSRandomAccessFile> file;
+  uint64_t offset = 0;
+  size_t size = 0;
+  std::unique_ptr<char[]> buf;
+  bool ok = false;
+
+  std::atomic<int> state{kPending};
+  port::Mutex mu;
+  port::CondVar cv{&mu};
+
+  // Performs the read unless another thread already started it
+  void TryRead() {
+    int expected = kPending;
+    if (!state.compare_exchange_strong(expected, kReading)) {
+      return;
+    }
+    Slice result;
+    IOStatus io_s = file->Read(offset, size, IOOptions(), &result, buf.get(),
+                               /*dbg=*/nullptr);
+    ok = io_s.ok() && result.size() == size;
+    if (ok && result.data() != buf.get()) {
+      memcpy(buf.get(), result.data(), size);
+    }
+    file.reset();
+    MutexLock lock(&mu);
+    state.store(kDone, std::memory_order_release);
+    cv.SignalAll();
+  }
+
+  bool IsDone() const {
+    return state.load(std::memory_order_acquire) == kDone;
+  }
+
+  void Wait() {
+    TryRead();
+    MutexLock lock(&mu);
+    while (!IsDone()) {
+      cv.Wait();
+    }
+  }
+};
+
+class FlashSecondaryCache::ResultHandle : public SecondaryCacheResultHandle {
+ public:
+  ResultHandle(FlashSecondaryCache* cache, const Slice& key,
+               const Cache::CacheItemHelper* helper,
+               Cache::CreateContext* create_context,
+               std::shared_ptr<ReadRequest> request)
+      : cache_(cache),
+        key_(key.ToString()),
+        helper_(helper),
+        create_context_(create_context),
+        request_(std::move(request)) {}
+
+  ResultHandle(const ResultHandle&) = delete;
+  ResultHandle& operator=(const ResultHandle&) = delete;
+
+  bool IsReady() override {
+    if (!finished_ && request_->IsDone()) {
+      Finish();
+    }
+    return finished_;
+  }
+
+  void Wait() override {
+    if (!finished_) {
+      request_->Wait();
+      Finish();
+    }
+  }
+
+  Cache::ObjectPtr Value() override {
+    assert(finished_);
+    return value_;
+  }
+
+  size_t Size() override {
+    assert(finished_);
+    return charge_;
+  }
+
+ private:
+  // Validates the record and creates the object from it. Runs on the thread
+  // consuming the result, since create_context is not thread safe.
+  void Finish() {
+    finished_ = true;
+    const char* rec = request_->buf.get();
+    const size_t size = request_->size;
+    bool valid = request_->ok && size >= kRecordHeaderSize &&
+                 crc32c::Unmask(DecodeFixed32(rec)) ==
+                     crc32c::Value(rec + 4, size - 4);
+    if (valid) {
+      uint32_t key_size = DecodeFixed32(rec + 4);
+      uint32_t value_size = DecodeFixed32(rec + 8);
+      valid = kRecordHeaderSize + uint64_t{key_size} + value_size == size &&
+              Slice(rec + kRecordHeaderSize, key_size) == Slice(key_);
+      if (valid) {
+        auto type = static_cast<CompressionType>(rec[12]);
+        auto source = static_cast<CacheTier>(rec[13]);
+        Slice value(rec + kRecordHeaderSize + key_size, value_size);
+        Status s =
+            helper_->create_cb(value, type, source, create_context_,
+                               /*allocator=*/nullptr, &value_, &charge_);
+        if (!s.ok()) {
+          value_ = nullptr;
+          charge_ = 0;
+        }
+      }
+    }
+    if (!valid) {
+      // Unreadable or corrupted on the device
+      cache_->Erase(key_);
+    }
+    request_.reset();
+  }
+
+  FlashSecondaryCache* cache_;
+  std::string key_;
+  const Cache::CacheItemHelper* helper_;
+  Cache::CreateContext* create_context_;
+  std::shared_ptr<ReadRequest> request_;
+  bool finished_ = false;
+  Cache::ObjectPtr value_ = nullptr;
+  size_t charge_ = 0;
+};
+
+FlashSecondaryCache::FlashSecondaryCache(
+    const FlashSecondaryCacheOptions& opts)
+    : opts_(opts) {
+  if (opts_.env == nullptr) {
+    opts_.env = Env::Default();
+  }
+  fs_ = opts_.env->GetFileSystem();
+  if (opts_.num_io_threads > 0) {
+    io_pool_.reset(NewThreadPool(opts_.num_io_threads));
+  }
+}
+
+FlashSecondaryCache::~FlashSecondaryCache() {
+  if (io_pool_) {
+    io_pool_->JoinAllThreads();
+  }
+  assert(!writing_sealed_);
+  if (writer_) {
+    writer_->Close(IOOptions(), /*dbg=*/nullptr).PermitUncheckedError();
+    writer_.reset();
+  }
+  // The contents do not outlive the cache
+  std::vector<std::string> files;
+  for (const Segment& segment : segments_) {
+    files.push_back(SegmentFileName(segment.number));
+  }
+  DeleteFiles(files);
+}
+
+std::string FlashSecondaryCache::SegmentFileName(uint64_t number) const {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "/%06" PRIu64 "%s", number, kSegmentFileSuffix);
+  return opts_.path + buf;
+}
+
+Status FlashSecondaryCache::Open() {
+  if (opts_.path.empty()) {
+    return Status::InvalidArgument("FlashSecondaryCache path is empty");
+  }
+  IOStatus io_s =
+      fs_->CreateDirIfMissing(opts_.path, IOOptions(), /*dbg=*/nullptr);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  // Remove segments left behind by a previous instance
+  std::vector<std::string> children;
+  io_s = fs_->GetChildren(opts_.path, IOOptions(), &children,
+                          /*dbg=*/nullptr);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  for (const std::string& child : children) {
+    if (EndsWith(child, kSegmentFileSuffix)) {
+      io_s = fs_->DeleteFile(opts_.path + "/" + child, IOOptions(),
+                             /*dbg=*/nullptr);
+      if (!io_s.ok()) {
+        return io_s;
+      }
+    }
+  }
+  MutexLock l(&mutex_);
+  NewSegment();
+  return Status::OK();
+}
+
+void FlashSecondaryCache::DeleteFiles(const std::vector<std::string>& files) {
+  for (const std::string& fname : files) {
+    // Reads in flight keep the file open, so it is safe to remove it now
+    fs_->DeleteFile(fname, IOOptions(), /*dbg=*/nullptr)
+        .PermitUncheckedError();
+  }
+}
+
+void FlashSecondaryCache::SealWriteBuffer(bool last) {
+  mutex_.AssertHeld();
+  if (write_buffer_.empty() && !last) {
+    return;
+  }
+  const uint64_t size = write_buffer_.size();
+  sealed_.push_back(SealedBuffer{segments_.back().number, write_buffer_offset_,
+                                 std::move(write_buffer_), last});
+  write_buffer_.clear();
+  write_buffer_offset_ += size;
+}
+
+Status FlashSecondaryCache::WriteSealedBuffers() {
+  mutex_.AssertHeld();
+  if (writing_sealed_) {
+    // The other thread also writes what was sealed in the meantime
+    return Status::OK();
+  }
+  writing_sealed_ = true;
+  Status s;
+  while (!sealed_.empty()) {
+    // Stays in place, and is still served to lookups, while it is written
+    const SealedBuffer& buffer = sealed_.front();
+    std::unique_ptr<FSRandomAccessFile> reader;
+    mutex_.Unlock();
+    IOStatus io_s = WriteSealedBuffer(buffer, &reader);
+    mutex_.Lock();
+    // Segments with sealed buffers are not evicted
+    assert(buffer.segment >= segments_.front().number);
+    Segment& segment = segments_[static_cast<size_t>(
+        buffer.segment - segments_.front().number)];
+    if (reader) {
+      segment.reader = std::move(reader);
+    }
+    if (!io_s.ok()) {
+      segment.failed = true;
+      if (s.ok()) {
+        s = io_s;
+      }
+    }
+    sealed_.pop_front();
+  }
+  writing_sealed_ = false;
+  return s;
+}
+
+IOStatus FlashSecondaryCache::WriteSealedBuffer(
+    const SealedBuffer& buffer, std::unique_ptr<FSRandomAccessFile>* reader) {
+  IOStatus io_s;
+  if (writer_segment_ != buffer.segment) {
+    // The previous segment's writer was closed after its last buffer
+    assert(!writer_);
+    writer_segment_ = buffer.segment;
+    const std::string fname = SegmentFileName(buffer.segment);
+    FileOptions file_opts;
+    io_s = fs_->NewWritableFile(fname, file_opts, &writer_, /*dbg=*/nullptr);
+    if (io_s.ok()) {
+      io_s = fs_->NewRandomAccessFile(fname, file_opts, reader,
+                                      /*dbg=*/nullptr);
+    }
+    if (!io_s.ok()) {
+      writer_.reset();
+      return io_s;
+    }
+  }
+  if (!writer_) {
+    // The segment failed earlier; its remaining records are dropped
+    return io_s;
+  }
+  if (!buffer.data.empty()) {
+    io_s = writer_->Append(buffer.data, IOOptions(), /*dbg=*/nullptr);
+    if (io_s.ok()) {
+      io_s = writer_->Flush(IOOptions(), /*dbg=*/nullptr);
+    }
+  }
+  if (buffer.last || !io_s.ok()) {
+    IOStatus close_s = writer_->Close(IOOptions(), /*dbg=*/nullptr);
+    if (io_s.ok()) {
+      io_s = close_s;
+    }
+    writer_.reset();
+  }
+  return io_s;
+}
+
+void FlashSecondaryCache::NewSegment() {
+  mutex_.AssertHeld();
+  if (!segments_.empty()) {
+    SealWriteBuffer(/*last=*/true);
+  }
+  Segment segment;
+  segment.number = next_segment_number_++;
+  segment.size = 0;
+  segment.failed = false;
+  segments_.push_back(std::move(segment));
+  write_buffer_offset_ = 0;
+}
+
+void FlashSecondaryCache::EvictSegments(
+    std::vector<std::string>* obsolete_files) {
+  mutex_.AssertHeld();
+  // Never evict the active segment, or one with records still to be
+  // written
+  const uint64_t first_kept = sealed_.empty() ? segments_.back().number
+                                              : sealed_.front().segment;
+  while (segments_.front().number < first_kept && usage_ > opts_.capacity) {
+    Segment& oldest = segments_.front();
+    for (IndexEntry* entry : oldest.entries) {
+      if (entry->second.segment == oldest.number) {
+        index_.erase(index_.find(entry->first));
+      }
+    }
+    usage_ -= oldest.size;
+    obsolete_files->push_back(SegmentFileName(oldest.number));
+    segments_.pop_front();
+  }
+}
+
+Status FlashSecondaryCache::AppendRecord(
+    const Slice& key, CompressionType type, CacheTier source,
+    size_t value_size, const std::function<Status(char*)>& fill_value) {
+  const size_t record_size = kRecordHeaderSize + key.size() + value_size;
+  if (record_size > std::numeric_limits<uint32_t>::max()) {
+    return Status::InvalidArgument("Entry too large for FlashSecondaryCache");
+  }
+  // Build the record outside of the lock
+  std::string record;
+  record.resize(record_size);
+  char* buf = &record[0];
+  EncodeFixed32(buf + 4, static_cast<uint32_t>(key.size()));
+  EncodeFixed32(buf + 8, static_cast<uint32_t>(value_size));
+  buf[12] = static_cast<char>(type);
+  buf[13] = static_cast<char>(source);
+  memcpy(buf + kRecordHeaderSize, key.data(), key.size());
+  Status s = fill_value(buf + kRecordHeaderSize + key.size());
+  if (!s.ok()) {
+    return s;
+  }
+  EncodeFixed32(buf, crc32c::Mask(crc32c::Value(buf + 4, record_size - 4)));
+
+  std::vector<std::string> obsolete_files;
+  {
+    MutexLock l(&mutex_);
+    if (segments_.empty()) {
+      return Status::Incomplete("FlashSecondaryCache is not open");
+    }
+    if (segments_.back().failed ||
+        (segments_.back().size > 0 &&
+         segments_.back().size + record_size > opts_.segment_size)) {
+      NewSegment();
+    }
+    Segment& active = segments_.back();
+    auto it = index_.find(key.ToString());
+    if (it == index_.end()) {
+      it = index_.emplace(key.ToString(), Location{0, 0, 0}).first;
+    }
+    if (it->second.segment != active.number) {
+      active.entries.push_back(&*it);
+    }
+    it->second = Location{active.number, active.size,
+                          static_cast<uint32_t>(record_size)};
+    active.size += record_size;
+    usage_ += record_size;
+    write_buffer_.append(record);
+    if (write_buffer_.size() >= opts_.write_buffer_size) {
+      SealWriteBuffer(/*last=*/false);
+    }
+    EvictSegments(&obsolete_files);
+    s = WriteSealedBuffers();
+    // More may have been evicted while the lock was released
+    EvictSegments(&obsolete_files);
+  }
+  DeleteFiles(obsolete_files);
+  return s;
+}
+
+Status FlashSecondaryCache::Insert(const Slice& key, Cache::ObjectPtr value,
+                                   const Cache::CacheItemHelper* helper,
+                                   bool /*force_insert*/) {
+  if (value == nullptr) {
+    return Status::InvalidArgument();
+  }
+  assert(helper && helper->IsSecondaryCacheCompatible());
+  size_t value_size = (*helper->size_cb)(value);
+  return AppendRecord(key, kNoCompression, CacheTier::kVolatileTier,
+                      value_size, [&](char* out) {
+                        return (*helper->saveto_cb)(value, 0, value_size, out);
+                      });
+}
+
+Status FlashSecondaryCache::InsertSaved(const Slice& key, const Slice& saved,
+                                        CompressionType type,
+                                        CacheTier source) {
+  return AppendRecord(key, type, source, saved.size(), [&](char* out) {
+    memcpy(out, saved.data(), saved.size());
+    return Status::OK();
+  });
+}
+
+std::unique_ptr<SecondaryCacheResultHandle> FlashSecondaryCache::Lookup(
+    const Slice& key, const Cache::CacheItemHelper* helper,
+    Cache::CreateContext* create_context, bool wait, bool advise_erase,
+    Statistics* /*stats*/, bool& kept_in_sec_cache) {
+  assert(helper);
+  kept_in_sec_cache = false;
+  auto request = std::make_shared<ReadRequest>();
+  {
+    MutexLock l(&mutex_);
+    auto it = index_.find(key.ToString());
+    if (it == index_.end() || it->second.size == 0) {
+      return nullptr;
+    }
+    Location& loc = it->second;
+    assert(!segments_.empty());
+    assert(loc.segment >= segments_.front().number);
+    const Segment& segment =
+        segments_[static_cast<size_t>(loc.segment - segments_.front().number)];
+    // Records not yet written to the device are in the write buffer or in
+    // a sealed buffer
+    const char* in_memory = nullptr;
+    if (loc.segment == segments_.back().number &&
+        loc.offset >= write_buffer_offset_) {
+      in_memory = write_buffer_.data() + (loc.offset - write_buffer_offset_);
+    } else {
+      for (const SealedBuffer& buffer : sealed_) {
+        if (buffer.segment == loc.segment && loc.offset >= buffer.offset &&
+            loc.offset < buffer.offset + buffer.data.size()) {
+          in_memory = buffer.data.data() + (loc.offset - buffer.offset);
+          break;
+        }
+      }
+    }
+    if (in_memory == nullptr && (segment.failed || !segment.reader)) {
+      // Lost to a failed write
+      loc.size = 0;
+      return nullptr;
+    }
+    request->size = loc.size;
+    request->buf.reset(new char[loc.size]);
+    if (in_memory != nullptr) {
+      memcpy(request->buf.get(), in_memory, loc.size);
+      request->ok = true;
+      request->state.store(ReadRequest::kDone, std::memory_order_relaxed);
+    } else {
+      request->file = segment.reader;
+      request->offset = loc.offset;
+    }
+    if (advise_erase) {
+      loc.size = 0;
+    } else {
+      kept_in_sec_cache = true;
+    }
+  }
+
+  std::unique_ptr<SecondaryCacheResultHandle> handle(
+      new ResultHandle(this, key, helper, create_context, request));
+  if (!request->IsDone()) {
+    if (wait || !io_pool_) {
+      request->TryRead();
+    } else {
+      io_pool_->SubmitJob([request]() { request->TryRead(); });
+    }
+  }
+  if (wait) {
+    handle->Wait();
+  }
+  return handle;
+}
+
+void FlashSecondaryCache::WaitAll(
+    std::vector<SecondaryCacheResultHandle*> handles) {
+  for (SecondaryCacheResultHandle* handle : handles) {
+    handle->Wait();
+  }
+}
+
+void FlashSecondaryCache::Erase(const Slice& key) {
+  MutexLock l(&mutex_);
+  auto it = index_.find(key.ToString());
+  if (it != index_.end()) {
+    it->second.size = 0;
+  }
+}
+
+Status FlashSecondaryCache::SetCapacity(size_t capacity) {
+  std::vector<std::string> obsolete_files;
+  {
+    MutexLock l(&mutex_);
+    opts_.capacity = capacity;
+    EvictSegments(&obsolete_files);
+  }
+  DeleteFiles(obsolete_files);
+  return Status::OK();
+}
+
+Status FlashSecondaryCache::GetCapacity(size_t& capacity) {
+  MutexLock l(&mutex_);
+  capacity = static_cast<size_t>(opts_.capacity);
+  return Status::OK();
+}
+
+std::string FlashSecondaryCache::GetPrintableOptions() const {
+  std::string ret;
+  const int kBufferSize{200};
+  char buffer[kBufferSize];
+  snprintf(buffer, kBufferSize, "    path : %s\n", opts_.path.c_str());
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    capacity : %" PRIu64 "\n",
+           opts_.capacity);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    segment_size : %" PRIu64 "\n",
+           opts_.segment_size);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    write_buffer_size : %" ROCKSDB_PRIszt "\n",
+           opts_.write_buffer_size);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    num_io_threads : %d\n",
+           opts_.num_io_threads);
+  ret.append(buffer);
+  return ret;
+}
+
+uint64_t FlashSecondaryCache::TEST_GetUsage() {
+  MutexLock l(&mutex_);
+  return usage_;
+}
+
+size_t FlashSecondaryCache::TEST_GetNumEntries() {
+  MutexLock l(&mutex_);
+  size_t num_entries = 0;
+  for (const auto& entry : index_) {
+    if (entry.second.size > 0) {
+      ++num_entries;
+    }
+  }
+  return num_entries;
+}
+
+size_t FlashSecondaryCache::TEST_GetNumSegments() {
+  MutexLock l(&mutex_);
+  return segments_.size();
+}
+
+Status NewFlashSecondaryCache(const FlashSecondaryCacheOptions& opts,
+                              std::shared_ptr<SecondaryCache>* result) {
+  auto cache = std::make_shared<FlashSecondaryCache>(opts);
+  Status s = cache->Open();
+  if (s.ok()) {
+    *result = std::move(cache);
+  }
+  return s;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
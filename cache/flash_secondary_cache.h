@@ -0,0 +1,177 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/file_system.h"
+#include "rocksdb/secondary_cache.h"
+#include "rocksdb/threadpool.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// FlashSecondaryCache is a SecondaryCache backed by files on a local flash
+// device (see FlashSecondaryCacheOptions).
+//
+// On-device layout: entries are appended as records to the active segment
+// file. Each record is
+//   fixed32 masked crc32c of everything after it
+//   fixed32 key size
+//   fixed32 value size
+//   uint8 compression type
+//   uint8 cache tier
+//   key
+//   value
+// The in-memory index maps each key to the segment, offset and size of its
+// latest record. Records are first collected in a write buffer. Once it
+// fills, the buffer is sealed and appended to the segment file by whichever
+// inserting thread finds no other append in progress, without holding the
+// cache mutex, while new records go to a fresh write buffer. Until then,
+// lookups of those records are served from memory. When the cache grows
+// beyond its capacity the oldest segment is deleted together with the index
+// entries still pointing into it.
+//
+// Lookup() resolves hits and misses from the index without any I/O. On a
+// hit with wait == false the read is handed to a background thread and a
+// pending handle is returned; WaitAll() then waits for the reads, or
+// performs those not yet started on the calling thread.
+class FlashSecondaryCache : public SecondaryCache {
+ public:
+  explicit FlashSecondaryCache(const FlashSecondaryCacheOptions& opts);
+  ~FlashSecondaryCache() override;
+
+  // Prepares the cache directory and the first segment. Must succeed
+  // before the cache is used.
+  Status Open();
+
+  const char* Name() const override { return "FlashSecondaryCache"; }
+
+  Status Insert(const Slice& key, Cache::ObjectPtr value,
+                const Cache::CacheItemHelper* helper,
+                bool force_insert) override;
+
+  Status InsertSaved(const Slice& key, const Slice& saved, CompressionType type,
+                     CacheTier source) override;
+
+  std::unique_ptr<SecondaryCacheResultHandle> Lookup(
+      const Slice& key, const Cache::CacheItemHelper* helper,
+      Cache::CreateContext* create_context, bool wait, bool advise_erase,
+      Statistics* stats, bool& kept_in_sec_cache) override;
+
+  bool SupportForceErase() const override { return true; }
+
+  void Erase(const Slice& key) override;
+
+  void WaitAll(std::vector<SecondaryCacheResultHandle*> handles) override;
+
+  Status SetCapacity(size_t capacity) override;
+
+  Status GetCapacity(size_t& capacity) override;
+
+  std::string GetPrintableOptions() const override;
+
+  // Bytes in all segments, including the write buffer
+  uint64_t TEST_GetUsage();
+  size_t TEST_GetNumEntries();
+  size_t TEST_GetNumSegments();
+
+ private:
+  static constexpr size_t kRecordHeaderSize = 14;
+
+  struct Location {
+    uint64_t segment;
+    uint64_t offset;
+    // 0 once erased. The index entry itself stays until its segment is
+    // evicted, because the segment refers to it.
+    uint32_t size;
+  };
+  using IndexEntry = std::pair<const std::string, Location>;
+
+  struct Segment {
+    uint64_t number;
+    // Logical size, including records not yet written to the file
+    uint64_t size;
+    // nullptr until the segment file is created
+    std::shared_ptr<FSRandomAccessFile> reader;
+    // Creating or appending to the file failed. Its records not in memory
+    // are misses, and the next insert starts a new segment.
+    bool failed;
+    // Index entries of the records in this segment, to drop those still
+    // pointing here when the segment is evicted. Each appears once.
+    std::vector<IndexEntry*> entries;
+  };
+
+  // Records waiting to be appended to a segment file
+  struct SealedBuffer {
+    uint64_t segment;
+    // Offset in the segment of the first byte of data
+    uint64_t offset;
+    std::string data;
+    // The last buffer of its segment, after which the file is closed
+    bool last;
+  };
+
+  struct ReadRequest;
+  class ResultHandle;
+
+  Status AppendRecord(const Slice& key, CompressionType type,
+                      CacheTier source, size_t value_size,
+                      const std::function<Status(char*)>& fill_value);
+
+  // REQUIRES: mutex_ held
+  void SealWriteBuffer(bool last);
+  // Writes out sealed_ unless another thread already does, releasing mutex_
+  // during the I/O. Returns the first error encountered.
+  // REQUIRES: mutex_ held
+  Status WriteSealedBuffers();
+  // Appends `buffer` to its segment file, creating the file first if
+  // needed, in which case *reader is set to a reader for it. Only called
+  // by the thread writing sealed buffers.
+  IOStatus WriteSealedBuffer(const SealedBuffer& buffer,
+                             std::unique_ptr<FSRandomAccessFile>* reader);
+  // REQUIRES: mutex_ held
+  void NewSegment();
+  // Drops the oldest segments while over capacity, and adds their file
+  // names to *obsolete_files for deletion after releasing mutex_.
+  // REQUIRES: mutex_ held
+  void EvictSegments(std::vector<std::string>* obsolete_files);
+  void DeleteFiles(const std::vector<std::string>& files);
+
+  std::string SegmentFileName(uint64_t number) const;
+
+  FlashSecondaryCacheOptions opts_;
+  std::shared_ptr<FileSystem> fs_;
+  std::unique_ptr<ThreadPool> io_pool_;
+
+  port::Mutex mutex_;
+  std::unordered_map<std::string, Location> index_;
+  // Oldest first; the last one is the segment being written
+  std::deque<Segment> segments_;
+  std::string write_buffer_;
+  // Offset in the active segment of the first byte of write_buffer_
+  uint64_t write_buffer_offset_ = 0;
+  // Oldest first
+  std::deque<SealedBuffer> sealed_;
+  // A thread is writing sealed_
+  bool writing_sealed_ = false;
+  uint64_t next_segment_number_ = 1;
+  uint64_t usage_ = 0;
+
+  // Only used by the thread writing sealed buffers
+  std::unique_ptr<FSWritableFile> writer_;
+  // The segment writer_ was opened for
+  uint64_t writer_segment_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
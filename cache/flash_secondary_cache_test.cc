@@ -0,0 +1,349 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/flash_secondary_cache.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "env/composite_env_wrapper.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/file_system.h"
+#include "test_util/secondary_cache_test_util.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+using secondary_cache_test_util::GetTestingCacheTypes;
+using secondary_cache_test_util::WithCacheTypeParam;
+
+class FlashSecondaryCacheTest : public testing::Test,
+                                public WithCacheTypeParam {
+ public:
+  FlashSecondaryCacheTest() {
+    env_ = Env::Default();
+    opts_.path = test::PerThreadDBPath(env_, "flash_secondary_cache_test");
+    opts_.env = env_;
+    opts_.capacity = 1 << 20;
+  }
+
+ protected:
+  // 16 bytes for HCC compatibility
+  static std::string Key(int i) {
+    char buf[17];
+    snprintf(buf, sizeof(buf), "____key%09d", i);
+    return buf;
+  }
+
+  std::shared_ptr<FlashSecondaryCache> NewSecondaryCache() {
+    std::shared_ptr<SecondaryCache> sec_cache;
+    EXPECT_OK(NewFlashSecondaryCache(opts_, &sec_cache));
+    return std::static_pointer_cast<FlashSecondaryCache>(sec_cache);
+  }
+
+  std::unique_ptr<TestItem> LookupItem(SecondaryCache* sec_cache,
+                                       const std::string& key,
+                                       bool advise_erase,
+                                       bool* kept_in_sec_cache = nullptr) {
+    bool kept = false;
+    std::unique_ptr<SecondaryCacheResultHandle> handle =
+        sec_cache->Lookup(key, GetHelper(), this, /*wait=*/true, advise_erase,
+                          /*stats=*/nullptr, kept);
+    if (kept_in_sec_cache) {
+      *kept_in_sec_cache = kept;
+    }
+    if (handle == nullptr) {
+      return nullptr;
+    }
+    EXPECT_TRUE(handle->IsReady());
+    return std::unique_ptr<TestItem>(static_cast<TestItem*>(handle->Value()));
+  }
+
+  Env* env_;
+  FlashSecondaryCacheOptions opts_;
+};
+
+TEST_P(FlashSecondaryCacheTest, BasicInsertAndLookup) {
+  auto sec_cache = NewSecondaryCache();
+  ASSERT_EQ(LookupItem(sec_cache.get(), Key(0), false), nullptr);
+
+  Random rnd(301);
+  std::string str1 = rnd.RandomString(1000);
+  TestItem item1(str1.data(), str1.length());
+  ASSERT_OK(sec_cache->Insert(Key(1), &item1, GetHelper(), false));
+
+  bool kept = false;
+  std::unique_ptr<TestItem> val = LookupItem(sec_cache.get(), Key(1), false,
+                                             &kept);
+  ASSERT_NE(val, nullptr);
+  ASSERT_EQ(val->ToString(), str1);
+  ASSERT_TRUE(kept);
+
+  // Overwrite, then look up with advise_erase
+  std::string str2 = rnd.RandomString(500);
+  TestItem item2(str2.data(), str2.length());
+  ASSERT_OK(sec_cache->Insert(Key(1), &item2, GetHelper(), false));
+  val = LookupItem(sec_cache.get(), Key(1), true, &kept);
+  ASSERT_NE(val, nullptr);
+  ASSERT_EQ(val->ToString(), str2);
+  ASSERT_FALSE(kept);
+  ASSERT_EQ(LookupItem(sec_cache.get(), Key(1), false), nullptr);
+
+  std::string str3 = rnd.RandomString(100);
+  TestItem item3(str3.data(), str3.length());
+  ASSERT_OK(sec_cache->Insert(Key(3), &item3, GetHelper(), false));
+  sec_cache->Erase(Key(3));
+  ASSERT_EQ(LookupItem(sec_cache.get(), Key(3), false), nullptr);
+  ASSERT_EQ(sec_cache->TEST_GetNumEntries(), 0);
+}
+
+TEST_P(FlashSecondaryCacheTest, AsyncLookup) {
+  // Send every record to the device right away
+  opts_.write_buffer_size = 1;
+  opts_.num_io_threads = 2;
+  auto sec_cache = NewSecondaryCache();
+
+  Random rnd(302);
+  const int kNumItems = 32;
+  std::vector<std::string> values;
+  for (int i = 0; i < kNumItems; ++i) {
+    values.push_back(rnd.RandomString(1000 + i));
+    TestItem item(values.back().data(), values.back().size());
+    ASSERT_OK(sec_cache->Insert(Key(i), &item, GetHelper(), false));
+  }
+
+  std::vector<std::unique_ptr<SecondaryCacheResultHandle>> handles;
+  std::vector<SecondaryCacheResultHandle*> raw_handles;
+  for (int i = 0; i < kNumItems + 1; ++i) {
+    bool kept = false;
+    handles.push_back(sec_cache->Lookup(Key(i), GetHelper(), this,
+                                        /*wait=*/false,
+                                        /*advise_erase=*/false,
+                                        /*stats=*/nullptr, kept));
+    if (i == kNumItems) {
+      // Misses are known without I/O
+      ASSERT_EQ(handles.back(), nullptr);
+      handles.pop_back();
+    } else {
+      ASSERT_NE(handles.back(), nullptr);
+      raw_handles.push_back(handles.back().get());
+    }
+  }
+  sec_cache->WaitAll(raw_handles);
+  for (int i = 0; i < kNumItems; ++i) {
+    ASSERT_TRUE(handles[i]->IsReady());
+    std::unique_ptr<TestItem> val(static_cast<TestItem*>(handles[i]->Value()));
+    ASSERT_NE(val, nullptr);
+    ASSERT_EQ(val->ToString(), values[i]);
+    ASSERT_EQ(handles[i]->Size(), values[i].size());
+  }
+}
+
+TEST_P(FlashSecondaryCacheTest, SegmentEviction) {
+  opts_.segment_size = 8 << 10;
+  opts_.capacity = 32 << 10;
+  opts_.write_buffer_size = 2 << 10;
+  auto sec_cache = NewSecondaryCache();
+
+  Random rnd(303);
+  const int kNumItems = 200;
+  std::vector<std::string> values;
+  for (int i = 0; i < kNumItems; ++i) {
+    values.push_back(rnd.RandomString(1000));
+    TestItem item(values.back().data(), values.back().size());
+    ASSERT_OK(sec_cache->Insert(Key(i), &item, GetHelper(), false));
+  }
+  ASSERT_LE(sec_cache->TEST_GetUsage(), opts_.capacity);
+  ASSERT_LE(sec_cache->TEST_GetNumSegments(), 5);
+  ASSERT_LT(sec_cache->TEST_GetNumEntries(), kNumItems);
+
+  // The oldest entries went with their segments, the newest are still there
+  ASSERT_EQ(LookupItem(sec_cache.get(), Key(0), false), nullptr);
+  std::unique_ptr<TestItem> val =
+      LookupItem(sec_cache.get(), Key(kNumItems - 1), false);
+  ASSERT_NE(val, nullptr);
+  ASSERT_EQ(val->ToString(), values[kNumItems - 1]);
+
+  // Shrinking drops everything but the active segment
+  ASSERT_OK(sec_cache->SetCapacity(0));
+  ASSERT_EQ(sec_cache->TEST_GetNumSegments(), 1);
+  size_t capacity = 1;
+  ASSERT_OK(sec_cache->GetCapacity(capacity));
+  ASSERT_EQ(capacity, 0);
+}
+
+TEST_P(FlashSecondaryCacheTest, CorruptedRecordIsMiss) {
+  opts_.write_buffer_size = 1;
+  auto sec_cache = NewSecondaryCache();
+
+  Random rnd(304);
+  std::string str = rnd.RandomString(1000);
+  TestItem item(str.data(), str.length());
+  ASSERT_OK(sec_cache->Insert(Key(1), &item, GetHelper(), false));
+  ASSERT_OK(test::CorruptFile(env_, opts_.path + "/000001.fsc", 500, 1,
+                              /*verify_checksum=*/false));
+
+  ASSERT_EQ(LookupItem(sec_cache.get(), Key(1), false), nullptr);
+  ASSERT_EQ(sec_cache->TEST_GetNumEntries(), 0);
+}
+
+TEST_P(FlashSecondaryCacheTest, SegmentFileCreationFailure) {
+  class FailingFS : public FileSystemWrapper {
+   public:
+    explicit FailingFS(const std::shared_ptr<FileSystem>& target)
+        : FileSystemWrapper(target) {}
+    static const char* kClassName() { return "FailingFS"; }
+    const char* Name() const override { return kClassName(); }
+
+    IOStatus NewWritableFile(const std::string& fname,
+                             const FileOptions& file_opts,
+                             std::unique_ptr<FSWritableFile>* result,
+                             IODebugContext* dbg) override {
+      if (fail_new_writable_file.exchange(false)) {
+        return IOStatus::IOError("Injected");
+      }
+      return target()->NewWritableFile(fname, file_opts, result, dbg);
+    }
+
+    std::atomic<bool> fail_new_writable_file{false};
+  };
+  auto fs = std::make_shared<FailingFS>(env_->GetFileSystem());
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(env_, fs));
+  opts_.env = env.get();
+  opts_.write_buffer_size = 1;
+  auto sec_cache = NewSecondaryCache();
+
+  Random rnd(306);
+  std::string str1 = rnd.RandomString(1000);
+  TestItem item1(str1.data(), str1.length());
+  fs->fail_new_writable_file = true;
+  ASSERT_NOK(sec_cache->Insert(Key(1), &item1, GetHelper(), false));
+  ASSERT_EQ(LookupItem(sec_cache.get(), Key(1), false), nullptr);
+
+  // The next insert starts over with a new segment file
+  std::string str2 = rnd.RandomString(1000);
+  TestItem item2(str2.data(), str2.length());
+  ASSERT_OK(sec_cache->Insert(Key(2), &item2, GetHelper(), false));
+  ASSERT_EQ(sec_cache->TEST_GetNumSegments(), 2);
+  std::unique_ptr<TestItem> val = LookupItem(sec_cache.get(), Key(2), false);
+  ASSERT_NE(val, nullptr);
+  ASSERT_EQ(val->ToString(), str2);
+  ASSERT_OK(sec_cache->Insert(Key(1), &item1, GetHelper(), false));
+  val = LookupItem(sec_cache.get(), Key(1), false);
+  ASSERT_NE(val, nullptr);
+  ASSERT_EQ(val->ToString(), str1);
+
+  sec_cache.reset();
+}
+
+TEST_P(FlashSecondaryCacheTest, ConcurrentInsertAndLookup) {
+  opts_.segment_size = 16 << 10;
+  opts_.capacity = 256 << 10;
+  opts_.write_buffer_size = 2 << 10;
+  opts_.num_io_threads = 2;
+  auto sec_cache = NewSecondaryCache();
+
+  const int kNumThreads = 4;
+  const int kNumItemsPerThread = 200;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumItemsPerThread; ++i) {
+        // The value identifies the key
+        std::string key = Key(t * kNumItemsPerThread + i);
+        std::string str = key + std::string(300 + i, 'a' + t);
+        TestItem item(str.data(), str.length());
+        EXPECT_OK(sec_cache->Insert(key, &item, GetHelper(), false));
+        std::unique_ptr<TestItem> val =
+            LookupItem(sec_cache.get(), Key(t * kNumItemsPerThread + i / 2),
+                       /*advise_erase=*/false);
+        if (val != nullptr) {
+          EXPECT_EQ(val->ToString().substr(0, key.size()),
+                    Key(t * kNumItemsPerThread + i / 2));
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_LE(sec_cache->TEST_GetUsage(), opts_.capacity);
+  // Depending on thread scheduling, the last entries of a thread that
+  // finished early may have been evicted, but not those of the thread that
+  // finished last. Entries still there are intact.
+  int num_found = 0;
+  for (int t = 0; t < kNumThreads; ++t) {
+    int i = kNumItemsPerThread - 1;
+    std::unique_ptr<TestItem> val =
+        LookupItem(sec_cache.get(), Key(t * kNumItemsPerThread + i), false);
+    if (val != nullptr) {
+      ++num_found;
+      ASSERT_EQ(val->ToString(), Key(t * kNumItemsPerThread + i) +
+                                     std::string(300 + i, 'a' + t));
+    }
+  }
+  ASSERT_GE(num_found, 1);
+}
+
+TEST_P(FlashSecondaryCacheTest, WithPrimaryCache) {
+  opts_.num_io_threads = 2;
+  opts_.write_buffer_size = 4 << 10;
+  std::shared_ptr<SecondaryCache> sec_cache = NewSecondaryCache();
+  std::shared_ptr<Cache> cache =
+      NewCache(/*capacity=*/4000, /*num_shard_bits=*/0,
+               /*strict_capacity_limit=*/false, sec_cache);
+
+  Random rnd(305);
+  const int kNumItems = 20;
+  std::vector<std::string> values;
+  for (int i = 0; i < kNumItems; ++i) {
+    values.push_back(rnd.RandomString(1000));
+    auto item = std::make_unique<TestItem>(values.back().data(),
+                                           values.back().size());
+    ASSERT_OK(cache->Insert(Key(i), item.get(), GetHelper(),
+                            values.back().size()));
+    item.release();
+  }
+
+  // Most items were evicted from the primary cache into the flash cache.
+  // Look them all up asynchronously.
+  std::vector<Cache::AsyncLookupHandle> async_handles(kNumItems);
+  std::vector<std::string> keys(kNumItems);
+  for (int i = 0; i < kNumItems; ++i) {
+    keys[i] = Key(i);
+    async_handles[i].key = keys[i];
+    async_handles[i].helper = GetHelper();
+    async_handles[i].create_context = this;
+    async_handles[i].priority = Cache::Priority::LOW;
+    cache->StartAsyncLookup(async_handles[i]);
+  }
+  cache->WaitAll(async_handles.data(), async_handles.size());
+  for (int i = 0; i < kNumItems; ++i) {
+    Cache::Handle* handle = async_handles[i].Result();
+    ASSERT_NE(handle, nullptr);
+    auto val = static_cast<TestItem*>(cache->Value(handle));
+    ASSERT_EQ(val->ToString(), values[i]);
+    cache->Release(handle);
+  }
+
+  cache.reset();
+  sec_cache.reset();
+}
+
+INSTANTIATE_TEST_CASE_P(FlashSecondaryCacheTest, FlashSecondaryCacheTest,
+                        GetTestingCacheTypes());
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
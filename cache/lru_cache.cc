@@ -9,12 +9,14 @@
 
 #include "cache/lru_cache.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 
 #include "cache/secondary_cache_adapter.h"
+#include "memory/slab_memory_allocator.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/statistics_impl.h"
 #include "port/lang.h"
@@ -134,7 +136,10 @@ LRUCacheShard::LRUCacheShard(size_t capacity, bool strict_capacity_limit,
       usage_(0),
       lru_usage_(0),
       mutex_(use_adaptive_mutex),
-      eviction_callback_(*eviction_callback) {
+      eviction_callback_(*eviction_callback),
+      slab_allocator_(allocator != nullptr
+                          ? allocator->CheckedCast<SlabMemoryAllocator>()
+                          : nullptr) {
   // Make empty circular linked list.
   lru_.next = &lru_;
   lru_.prev = &lru_;
@@ -154,8 +159,8 @@ void LRUCacheShard::EraseUnRefEntries() {
       LRU_Remove(old);
       table_.Remove(old->key(), old->hash);
       old->SetInCache(false);
-      assert(usage_ >= old->total_charge);
-      usage_ -= old->total_charge;
+      assert(usage_.LoadRelaxed() >= old->total_charge);
+      usage_.StoreRelaxed(usage_.LoadRelaxed() - old->total_charge);
       last_reference_list.push_back(old);
     }
   }
@@ -323,19 +328,51 @@ void LRUCacheShard::MaintainPoolSize() {
 
 void LRUCacheShard::EvictFromLRU(size_t charge,
                                  autovector<LRUHandle*>* deleted) {
-  while ((usage_ + charge) > capacity_ && lru_.next != &lru_) {
-    LRUHandle* old = lru_.next;
+  // Charge whole slabs: the slab space that holds no entry counts against
+  // the capacity too. Evicted entries are freed after the loop, so this
+  // does not change while it runs.
+  const size_t unallocated =
+      slab_allocator_ != nullptr
+          ? slab_allocator_->GetUnallocatedSlabBytes() >> num_shard_bits_
+          : 0;
+  // The slab space charged is capped at the shard's usage. A small cache
+  // can have more unallocated slab space than capacity, and evicting
+  // entries cannot give that back, so an uncapped charge would empty the
+  // shard.
+  auto total_charge = [&]() {
+    size_t usage = usage_.LoadRelaxed();
+    return usage + charge + std::min(unallocated, usage);
+  };
+  while (total_charge() > capacity_ && lru_.next != &lru_) {
+    LRUHandle* old =
+        slab_allocator_ != nullptr ? SlabAwareVictim() : lru_.next;
     // LRU list contains only elements which can be evicted.
     assert(old->InCache() && !old->HasRefs());
     LRU_Remove(old);
     table_.Remove(old->key(), old->hash);
     old->SetInCache(false);
-    assert(usage_ >= old->total_charge);
-    usage_ -= old->total_charge;
+    assert(usage_.LoadRelaxed() >= old->total_charge);
+    usage_.StoreRelaxed(usage_.LoadRelaxed() - old->total_charge);
     deleted->push_back(old);
   }
 }
 
+LRUHandle* LRUCacheShard::SlabAwareVictim() {
+  // Looking further than a few entries would stray too far from LRU order.
+  constexpr int kMaxEntriesToScan = 8;
+  LRUHandle* e = lru_.next;
+  for (int i = 0; i < kMaxEntriesToScan && e != &lru_; ++i, e = e->next) {
+    if (e->value == nullptr || e->helper->allocation_cb == nullptr) {
+      continue;
+    }
+    void* allocation = e->helper->allocation_cb(e->value, slab_allocator_);
+    if (allocation != nullptr && slab_allocator_->ReleasesMemory(allocation)) {
+      return e;
+    }
+  }
+  return lru_.next;
+}
+
 void LRUCacheShard::NotifyEvicted(
     const autovector<LRUHandle*>& evicted_handles) {
   MemoryAllocator* alloc = table_.GetAllocator();
@@ -381,7 +418,7 @@ Status LRUCacheShard::InsertItem(LRUHandle* e, LRUHandle** handle) {
     // is freed or the lru list is empty.
     EvictFromLRU(e->total_charge, &last_reference_list);
 
-    if ((usage_ + e->total_charge) > capacity_ &&
+    if ((usage_.LoadRelaxed() + e->total_charge) > capacity_ &&
         (strict_capacity_limit_ || handle == nullptr)) {
       e->SetInCache(false);
       if (handle == nullptr) {
@@ -398,7 +435,7 @@ Status LRUCacheShard::InsertItem(LRUHandle* e, LRUHandle** handle) {
       // Insert into the cache. Note that the cache might get larger than its
       // capacity if not enough space was freed up.
       LRUHandle* old = table_.Insert(e);
-      usage_ += e->total_charge;
+      usage_.StoreRelaxed(usage_.LoadRelaxed() + e->total_charge);
       if (old != nullptr) {
         s = Status::OkOverwritten();
         assert(old->InCache());
@@ -406,8 +443,8 @@ Status LRUCacheShard::InsertItem(LRUHandle* e, LRUHandle** handle) {
         if (!old->HasRefs()) {
           // old is on LRU because it's in cache and its reference count is 0.
           LRU_Remove(old);
-          assert(usage_ >= old->total_charge);
-          usage_ -= old->total_charge;
+          assert(usage_.LoadRelaxed() >= old->total_charge);
+          usage_.StoreRelaxed(usage_.LoadRelaxed() - old->total_charge);
           last_reference_list.push_back(old);
         }
       }
@@ -483,7 +520,7 @@ bool LRUCacheShard::Release(LRUHandle* e, bool /*useful*/,
     was_in_cache = e->InCache();
     if (must_free && was_in_cache) {
       // The item is still in cache, and nobody else holds a reference to it.
-      if (usage_ > capacity_ || erase_if_last_ref) {
+      if (usage_.LoadRelaxed() > capacity_ || erase_if_last_ref) {
         // The LRU list must be empty since the cache is full.
         assert(lru_.next == &lru_ || erase_if_last_ref);
         // Take this opportunity and remove the item.
@@ -497,8 +534,8 @@ bool LRUCacheShard::Release(LRUHandle* e, bool /*useful*/,
     }
     // If about to be freed, then decrement the cache usage.
     if (must_free) {
-      assert(usage_ >= e->total_charge);
-      usage_ -= e->total_charge;
+      assert(usage_.LoadRelaxed() >= e->total_charge);
+      usage_.StoreRelaxed(usage_.LoadRelaxed() - e->total_charge);
     }
   }
 
@@ -573,7 +610,8 @@ LRUHandle* LRUCacheShard::CreateStandalone(const Slice& key, uint32_t hash,
 
     EvictFromLRU(e->total_charge, &last_reference_list);
 
-    if (strict_capacity_limit_ && (usage_ + e->total_charge) > capacity_) {
+    if (strict_capacity_limit_ &&
+        (usage_.LoadRelaxed() + e->total_charge) > capacity_) {
       if (allow_uncharged) {
         e->total_charge = 0;
       } else {
@@ -581,7 +619,7 @@ LRUHandle* LRUCacheShard::CreateStandalone(const Slice& key, uint32_t hash,
         e = nullptr;
       }
     } else {
-      usage_ += e->total_charge;
+      usage_.StoreRelaxed(usage_.LoadRelaxed() + e->total_charge);
     }
   }
 
@@ -601,8 +639,8 @@ void LRUCacheShard::Erase(const Slice& key, uint32_t hash) {
       if (!e->HasRefs()) {
         // The entry is in LRU since it's in hash and has no external references
         LRU_Remove(e);
-        assert(usage_ >= e->total_charge);
-        usage_ -= e->total_charge;
+        assert(usage_.LoadRelaxed() >= e->total_charge);
+        usage_.StoreRelaxed(usage_.LoadRelaxed() - e->total_charge);
         last_reference = true;
       }
     }
@@ -615,15 +653,12 @@ void LRUCacheShard::Erase(const Slice& key, uint32_t hash) {
   }
 }
 
-size_t LRUCacheShard::GetUsage() const {
-  DMutexLock l(mutex_);
-  return usage_;
-}
+size_t LRUCacheShard::GetUsage() const { return usage_.LoadRelaxed(); }
 
 size_t LRUCacheShard::GetPinnedUsage() const {
   DMutexLock l(mutex_);
-  assert(usage_ >= lru_usage_);
-  return usage_ - lru_usage_;
+  assert(usage_.LoadRelaxed() >= lru_usage_);
+  return usage_.LoadRelaxed() - lru_usage_;
 }
 
 size_t LRUCacheShard::GetOccupancyCount() const {
@@ -658,6 +693,7 @@ LRUCache::LRUCache(const LRUCacheOptions& opts) : ShardedCache(opts) {
                            opts.use_adaptive_mutex, opts.metadata_charge_policy,
                            /* max_upper_hash_bits */ 32 - opts.num_shard_bits,
                            alloc, &eviction_callback_);
+    cs->num_shard_bits_ = GetNumShardBits();
   });
 }
 
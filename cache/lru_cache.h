@@ -20,6 +20,8 @@
 #include "util/distributed_mutex.h"
 
 namespace ROCKSDB_NAMESPACE {
+class SlabMemoryAllocator;
+
 namespace lru_cache {
 
 // LRU cache implementation. This class is not thread-safe.
@@ -369,6 +371,11 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShardBase {
   // holding the mutex_.
   void EvictFromLRU(size_t charge, autovector<LRUHandle*>* deleted);
 
+  // The next entry to evict: among the few oldest entries, the oldest whose
+  // eviction would empty a slab of slab_allocator_, or else the oldest.
+  // REQUIRES: slab_allocator_ != nullptr, mutex_ held, LRU list not empty.
+  LRUHandle* SlabAwareVictim();
+
   void NotifyEvicted(const autovector<LRUHandle*>& evicted_handles);
 
   LRUHandle* CreateHandle(const Slice& key, uint32_t hash,
@@ -425,8 +432,9 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShardBase {
   // ------------vvvvvvvvvvvvv-----------
   LRUHandleTable table_;
 
-  // Memory size for entries residing in the cache.
-  size_t usage_;
+  // Memory size for entries residing in the cache. Only modified with
+  // mutex_ held, but atomic so that GetUsage() does not need the mutex.
+  RelaxedAtomic<size_t> usage_;
 
   // Memory size for entries residing only in the LRU list.
   size_t lru_usage_;
@@ -438,6 +446,12 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShardBase {
 
   // A reference to Cache::eviction_callback_
   const Cache::EvictionCallback& eviction_callback_;
+
+  // The cache's allocator if it is a SlabMemoryAllocator, whose unallocated
+  // slab space is then charged against the capacity, split evenly over the
+  // 2^num_shard_bits_ shards (set by LRUCache). nullptr otherwise.
+  SlabMemoryAllocator* const slab_allocator_;
+  int num_shard_bits_ = 0;
 };
 
 class LRUCache
@@ -11,9 +11,11 @@
 
 #include "cache/cache_key.h"
 #include "cache/clock_cache.h"
+#include "cache/quota_cache.h"
 #include "cache_helpers.h"
 #include "db/db_test_util.h"
 #include "file/sst_file_manager_impl.h"
+#include "memory/slab_memory_allocator.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/cache.h"
@@ -393,11 +395,12 @@ class ClockCacheTest : public testing::Test {
   }
 
   void NewShard(size_t capacity, bool strict_capacity_limit = true,
-                int eviction_effort_cap = 30) {
+                int eviction_effort_cap = 30, bool segmented = false) {
     DeleteShard();
     shard_ = static_cast<Shard*>(port::cacheline_aligned_alloc(sizeof(Shard)));
 
     TableOpts opts{1 /*value_size*/, eviction_effort_cap};
+    opts.segmented = segmented;
     new (shard_)
         Shard(capacity, strict_capacity_limit, kDontChargeCacheMetadata,
               /*allocator*/ nullptr, &eviction_callback_, &hash_seed_, opts);
@@ -752,6 +755,88 @@ const Cache::CacheItemHelper kDeleteCounterHelper{
     }};
 }  // namespace
 
+TYPED_TEST(ClockCacheTest, ClockSegmentedTest) {
+  for (bool segmented : {false, true}) {
+    SCOPED_TRACE("segmented = " + std::to_string(segmented));
+
+    this->NewShard(6, /*strict_capacity_limit*/ false, /*eec*/ 30, segmented);
+    auto& shard = *this->shard_;
+    // Point lookup working set, each hit twice
+    for (char key : {'a', 'b', 'c'}) {
+      EXPECT_OK(this->Insert(key, Cache::Priority::HIGH));
+      EXPECT_TRUE(this->Lookup(key));
+      EXPECT_TRUE(this->Lookup(key));
+    }
+    EXPECT_EQ(shard.GetProtectedOccupancyCount(), segmented ? 3U : 0U);
+    EXPECT_EQ(shard.GetProbationOccupancyCount(), segmented ? 0U : 3U);
+
+    // A long scan of entries never hit
+    for (char key = 'd'; key <= 'z'; ++key) {
+      EXPECT_OK(this->Insert(key, Cache::Priority::LOW));
+    }
+    // The scan churns through the probation segment only
+    EXPECT_EQ(this->Lookup('a', /*use*/ false), segmented);
+    EXPECT_EQ(this->Lookup('b', /*use*/ false), segmented);
+    EXPECT_EQ(this->Lookup('c', /*use*/ false), segmented);
+    EXPECT_TRUE(this->Lookup('z', /*use*/ false));
+    EXPECT_EQ(shard.GetProtectedOccupancyCount(), segmented ? 3U : 0U);
+    EXPECT_EQ(shard.GetProbationOccupancyCount() +
+                  shard.GetProtectedOccupancyCount(),
+              shard.GetOccupancyCount());
+
+    this->Erase('a');
+    EXPECT_EQ(shard.GetProtectedOccupancyCount(), segmented ? 2U : 0U);
+
+    if (segmented) {
+      // Once (nearly) everything is protected, protected entries age and get
+      // demoted to probation
+      for (char key = 'A'; key <= 'F'; ++key) {
+        EXPECT_OK(this->Insert(key, Cache::Priority::LOW));
+        EXPECT_TRUE(this->Lookup(key));
+        EXPECT_TRUE(this->Lookup(key));
+      }
+      for (char key = 'G'; key <= 'Z'; ++key) {
+        EXPECT_OK(this->Insert(key, Cache::Priority::LOW));
+      }
+      EXPECT_LT(shard.GetProtectedOccupancyCount(), 6U);
+      EXPECT_EQ(shard.GetProbationOccupancyCount() +
+                    shard.GetProtectedOccupancyCount(),
+                shard.GetOccupancyCount());
+    }
+  }
+}
+
+TYPED_TEST(ClockCacheTest, ClockSegmentedAllProbationPinnedTest) {
+  using HandleImpl = typename ClockCacheTest<TypeParam>::Shard::HandleImpl;
+  this->NewShard(6, /*strict_capacity_limit*/ true, /*eec*/ 30,
+                 /*segmented*/ true);
+  auto& shard = *this->shard_;
+  for (char key : {'a', 'b', 'c'}) {
+    EXPECT_OK(this->Insert(key));
+    EXPECT_TRUE(this->Lookup(key));
+    EXPECT_TRUE(this->Lookup(key));
+  }
+  // Protected segment is within its limit, and all of probation is pinned
+  std::vector<HandleImpl*> pinned;
+  for (char key : {'d', 'e', 'f'}) {
+    EXPECT_OK(this->Insert(key));
+    UniqueId64x2 hkey = this->TestHashedKey(key);
+    pinned.push_back(shard.Lookup(this->TestKey(hkey), hkey));
+    ASSERT_NE(pinned.back(), nullptr);
+  }
+  EXPECT_EQ(shard.GetProtectedOccupancyCount(), 3U);
+
+  // Eviction ages the protected segment rather than giving up
+  EXPECT_OK(this->Insert('g'));
+  EXPECT_LT(shard.GetProtectedOccupancyCount(), 3U);
+  EXPECT_LE(shard.GetOccupancyCount(), 6U);
+  EXPECT_TRUE(this->Lookup('g', /*use*/ false));
+
+  for (HandleImpl* h : pinned) {
+    shard.Release(h, /*useful*/ true, /*erase_if_last_ref*/ false);
+  }
+}
+
 // Testing calls to CorrectNearOverflow in Release
 TYPED_TEST(ClockCacheTest, ClockCounterOverflowTest) {
   this->NewShard(6, /*strict_capacity_limit*/ false);
@@ -2501,6 +2586,187 @@ TEST_P(DBSecondaryCacheTest, TestSecondaryCacheOptionBasic) {
   Destroy(options);
 }
 
+TEST_P(DBSecondaryCacheTest, CacheSnapshotLazyLoad) {
+  std::shared_ptr<Cache> base_cache =
+      NewCache(1024 * 1024 /* capacity */, 0 /* num_shard_bits */,
+               false /* strict_capacity_limit */);
+  std::shared_ptr<CacheWithStats> cache =
+      std::make_shared<CacheWithStats>(base_cache);
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = cache;
+  table_options.block_size = 4 * 1024;
+  Options options = GetDefaultOptions();
+  options.create_if_missing = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  options.env = fault_env_.get();
+  DestroyAndReopen(options);
+  fault_fs_->SetFailGetUniqueId(true);
+
+  Random rnd(301);
+  const int N = 256;
+  std::vector<std::string> value(N);
+  for (int i = 0; i < N; i++) {
+    value[i] = rnd.RandomString(1000);
+    ASSERT_OK(Put(Key(i), value[i]));
+  }
+  ASSERT_OK(Flush());
+  Compact("a", "z");
+  for (int i = 0; i < N; i++) {
+    ASSERT_EQ(Get(Key(i)), value[i]);
+  }
+
+  CacheDumpOptions cd_options;
+  cd_options.clock = fault_env_->GetSystemClock().get();
+  std::string snapshot_path = db_->GetName() + "/cache_snapshot";
+  std::unique_ptr<CacheDumper> cache_dumper;
+  ASSERT_OK(NewCacheSnapshotDumper(cd_options, cache, fault_fs_,
+                                   snapshot_path, &cache_dumper));
+  ASSERT_OK(cache_dumper->SetDumpFilter({db_}));
+  ASSERT_OK(cache_dumper->DumpCacheEntriesToWriter());
+  cache_dumper.reset();
+
+  // Restart with the snapshot as the secondary cache of an empty block cache.
+  // Every block is faulted in from the snapshot instead of the SST file.
+  std::shared_ptr<SecondaryCache> secondary_cache;
+  ASSERT_OK(NewCacheSnapshotSecondaryCache(fault_fs_, snapshot_path,
+                                           &secondary_cache));
+  base_cache = NewCache(1024 * 1024 /* capacity */, 0 /* num_shard_bits */,
+                        false /* strict_capacity_limit */, secondary_cache);
+  cache = std::make_shared<CacheWithStats>(base_cache);
+  table_options.block_cache = cache;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  uint32_t cache_insert = cache->GetInsertCount();
+  for (int i = 0; i < N; i++) {
+    ASSERT_EQ(Get(Key(i)), value[i]);
+  }
+  ASSERT_EQ(0, static_cast<int>(cache->GetInsertCount() - cache_insert));
+
+  // A corrupted block is a miss, and is read from the SST file instead
+  Close();
+  secondary_cache.reset();
+  // Unsynced writes through fault_env_ would not reach the file
+  ASSERT_OK(test::CorruptFile(Env::Default(), snapshot_path, 10, 1,
+                              /*verify_checksum=*/false));
+  ASSERT_OK(NewCacheSnapshotSecondaryCache(fault_fs_, snapshot_path,
+                                           &secondary_cache));
+  base_cache = NewCache(1024 * 1024 /* capacity */, 0 /* num_shard_bits */,
+                        false /* strict_capacity_limit */, secondary_cache);
+  cache = std::make_shared<CacheWithStats>(base_cache);
+  table_options.block_cache = cache;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  cache_insert = cache->GetInsertCount();
+  for (int i = 0; i < N; i++) {
+    ASSERT_EQ(Get(Key(i)), value[i]);
+  }
+  ASSERT_EQ(1, static_cast<int>(cache->GetInsertCount() - cache_insert));
+
+  // A corrupted index is detected when opening
+  Close();
+  secondary_cache.reset();
+  uint64_t file_size = 0;
+  ASSERT_OK(Env::Default()->GetFileSize(snapshot_path, &file_size));
+  ASSERT_OK(test::CorruptFile(Env::Default(), snapshot_path,
+                              static_cast<int>(file_size) - 40, 1,
+                              /*verify_checksum=*/false));
+  ASSERT_TRUE(NewCacheSnapshotSecondaryCache(fault_fs_, snapshot_path,
+                                             &secondary_cache)
+                  .IsCorruption());
+
+  fault_fs_->SetFailGetUniqueId(false);
+  Destroy(options);
+}
+
+TEST_P(DBSecondaryCacheTest, CacheSnapshotBulkLoad) {
+  std::shared_ptr<Cache> base_cache =
+      NewCache(1024 * 1024 /* capacity */, 0 /* num_shard_bits */,
+               false /* strict_capacity_limit */);
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = base_cache;
+  table_options.block_size = 4 * 1024;
+  Options options = GetDefaultOptions();
+  options.create_if_missing = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  options.env = fault_env_.get();
+  DestroyAndReopen(options);
+  fault_fs_->SetFailGetUniqueId(true);
+
+  Random rnd(302);
+  const int N = 256;
+  std::vector<std::string> value(N);
+  for (int i = 0; i < N; i++) {
+    value[i] = rnd.RandomString(1000);
+    ASSERT_OK(Put(Key(i), value[i]));
+  }
+  ASSERT_OK(Flush());
+  Compact("a", "z");
+  for (int i = 0; i < N; i++) {
+    ASSERT_EQ(Get(Key(i)), value[i]);
+  }
+
+  CacheDumpOptions cd_options;
+  cd_options.clock = fault_env_->GetSystemClock().get();
+  std::string snapshot_path = db_->GetName() + "/cache_snapshot";
+  std::unique_ptr<CacheDumper> cache_dumper;
+  ASSERT_OK(NewCacheSnapshotDumper(cd_options, base_cache, fault_fs_,
+                                   snapshot_path, &cache_dumper));
+  ASSERT_OK(cache_dumper->DumpCacheEntriesToWriter());
+  cache_dumper.reset();
+
+  std::shared_ptr<TestSecondaryCache> secondary_cache =
+      std::make_shared<TestSecondaryCache>(2048 * 1024, true);
+  std::unique_ptr<CacheDumpedLoader> cache_loader;
+  ASSERT_OK(NewCacheSnapshotLoader(cd_options, fault_fs_, snapshot_path,
+                                   secondary_cache, &cache_loader));
+  ASSERT_OK(cache_loader->SetLoadFilter({db_}));
+  ASSERT_OK(cache_loader->RestoreCacheEntriesToSecondaryCache());
+  uint32_t load_insert = secondary_cache->num_inserts();
+  ASSERT_GT(load_insert, 0u);
+
+  base_cache = NewCache(1024 * 1024 /* capacity */, 0 /* num_shard_bits */,
+                        false /* strict_capacity_limit */, secondary_cache);
+  std::shared_ptr<CacheWithStats> cache =
+      std::make_shared<CacheWithStats>(base_cache);
+  table_options.block_cache = cache;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  uint32_t cache_insert = cache->GetInsertCount();
+  for (int i = 0; i < N; i++) {
+    ASSERT_EQ(Get(Key(i)), value[i]);
+  }
+  ASSERT_EQ(0, static_cast<int>(cache->GetInsertCount() - cache_insert));
+  ASSERT_EQ(load_insert, secondary_cache->num_lookups());
+
+  // Loading stops once max_size_bytes is exceeded
+  CacheDumpOptions small_options = cd_options;
+  small_options.max_size_bytes = 1;
+  std::shared_ptr<TestSecondaryCache> small_secondary_cache =
+      std::make_shared<TestSecondaryCache>(2048 * 1024, true);
+  ASSERT_OK(NewCacheSnapshotLoader(small_options, fault_fs_, snapshot_path,
+                                   small_secondary_cache, &cache_loader));
+  ASSERT_OK(cache_loader->SetLoadFilter({db_}));
+  ASSERT_OK(cache_loader->RestoreCacheEntriesToSecondaryCache());
+  ASSERT_EQ(1, static_cast<int>(small_secondary_cache->num_inserts()));
+
+  // Blocks of files no longer in the DB are not loaded
+  ASSERT_OK(Put(Key(0), "new"));
+  ASSERT_OK(Flush());
+  Compact("a", "z");
+  secondary_cache = std::make_shared<TestSecondaryCache>(2048 * 1024, true);
+  ASSERT_OK(NewCacheSnapshotLoader(cd_options, fault_fs_, snapshot_path,
+                                   secondary_cache, &cache_loader));
+  ASSERT_OK(cache_loader->SetLoadFilter({db_}));
+  ASSERT_OK(cache_loader->RestoreCacheEntriesToSecondaryCache());
+  ASSERT_EQ(0, static_cast<int>(secondary_cache->num_inserts()));
+
+  fault_fs_->SetFailGetUniqueId(false);
+  Destroy(options);
+}
+
 // We disable the secondary cache in DBOptions at first. Close and reopen the DB
 // with new options, which set the lowest_used_cache_tier to
 // kNonVolatileBlockTier. So secondary cache will be used.
@@ -2723,6 +2989,201 @@ TEST_F(LRUCacheTest, InsertAfterReducingCapacity) {
   Insert("aaa", Cache::Priority::LOW, /*charge=*/3);
 }
 
+TEST_F(LRUCacheTest, SlabAllocatorEviction) {
+  SlabAllocatorOptions sopts;
+  sopts.slab_size = 64 << 10;
+  sopts.max_slab_allocation_size = 16 << 10;
+  sopts.num_shards = 1;
+  std::shared_ptr<MemoryAllocator> allocator;
+  ASSERT_OK(NewSlabMemoryAllocator(sopts, &allocator));
+  auto slab_allocator = static_cast<SlabMemoryAllocator*>(allocator.get());
+
+  // Each value is an allocation of 4000 bytes, which takes a 4096 byte
+  // chunk and is charged its usable size. A slab holds 16 of them.
+  const size_t kChunk = 4096;
+  const size_t kUsable = kChunk - 16;
+  static const Cache::CacheItemHelper kHelper{
+      CacheEntryRole::kMisc,
+      [](Cache::ObjectPtr obj, MemoryAllocator* alloc) {
+        alloc->Deallocate(obj);
+      },
+      [](Cache::ObjectPtr obj, MemoryAllocator* /*alloc*/) -> void* {
+        return obj;
+      }};
+
+  LRUCacheOptions opts;
+  opts.capacity = 64 * kChunk;
+  opts.num_shard_bits = 0;
+  opts.metadata_charge_policy = kDontChargeCacheMetadata;
+  opts.memory_allocator = allocator;
+  std::shared_ptr<Cache> cache = opts.MakeSharedCache();
+
+  // The first 16 values fill a slab, the 17th is alone in a second one and
+  // is inserted third oldest.
+  std::vector<void*> values;
+  for (int i = 0; i < 17; ++i) {
+    values.push_back(allocator->Allocate(4000));
+  }
+  std::vector<int> order = {0, 1, 16};
+  for (int i = 2; i < 16; ++i) {
+    order.push_back(i);
+  }
+  for (int i : order) {
+    ASSERT_EQ(kUsable, allocator->UsableSize(values[i], 4000));
+    ASSERT_OK(cache->Insert(std::to_string(i), values[i], &kHelper, kUsable));
+  }
+  ASSERT_EQ(17 * kUsable, cache->GetUsage());
+  ASSERT_EQ(2 * sopts.slab_size - 17 * kUsable,
+            slab_allocator->GetUnallocatedSlabBytes());
+
+  auto in_cache = [&](const std::string& key) {
+    Cache::Handle* h = cache->BasicLookup(key, /*stats=*/nullptr);
+    if (h == nullptr) {
+      return false;
+    }
+    cache->Release(h);
+    return true;
+  };
+
+  // The two slabs take one byte more than the capacity. Evicting the entry
+  // that empties the second slab is preferred over older entries.
+  cache->SetCapacity(2 * sopts.slab_size - 1);
+  ASSERT_FALSE(in_cache("16"));
+  ASSERT_TRUE(in_cache("0"));
+  ASSERT_EQ(16 * kUsable, cache->GetUsage());
+  // The emptied slab is kept as the spare one, which is still charged.
+  ASSERT_EQ(2 * sopts.slab_size - 16 * kUsable,
+            slab_allocator->GetUnallocatedSlabBytes());
+
+  // No entry empties a slab now, so the oldest goes, which is "1" since the
+  // lookup above made "0" the most recently used.
+  cache->SetCapacity(31 * kChunk);
+  ASSERT_FALSE(in_cache("1"));
+  ASSERT_TRUE(in_cache("0"));
+  ASSERT_TRUE(in_cache("2"));
+  ASSERT_EQ(15 * kUsable, cache->GetUsage());
+}
+
+TEST_F(LRUCacheTest, SlabAllocatorSmallCapacity) {
+  SlabAllocatorOptions sopts;
+  sopts.slab_size = 64 << 10;
+  sopts.max_slab_allocation_size = 16 << 10;
+  sopts.num_shards = 1;
+  std::shared_ptr<MemoryAllocator> allocator;
+  ASSERT_OK(NewSlabMemoryAllocator(sopts, &allocator));
+  auto slab_allocator = static_cast<SlabMemoryAllocator*>(allocator.get());
+
+  const size_t kChunk = 4096;
+  const size_t kUsable = kChunk - 16;
+  static const Cache::CacheItemHelper kHelper{
+      CacheEntryRole::kMisc,
+      [](Cache::ObjectPtr obj, MemoryAllocator* alloc) {
+        alloc->Deallocate(obj);
+      },
+      [](Cache::ObjectPtr obj, MemoryAllocator* /*alloc*/) -> void* {
+        return obj;
+      }};
+
+  // The capacity is half a slab, so the unallocated slab space is larger
+  // than the capacity.
+  LRUCacheOptions opts;
+  opts.capacity = 8 * kChunk;
+  opts.num_shard_bits = 0;
+  opts.metadata_charge_policy = kDontChargeCacheMetadata;
+  opts.memory_allocator = allocator;
+  std::shared_ptr<Cache> cache = opts.MakeSharedCache();
+
+  std::vector<void*> values;
+  for (int i = 0; i < 6; ++i) {
+    values.push_back(allocator->Allocate(4000));
+  }
+  ASSERT_EQ(sopts.slab_size - 6 * kUsable,
+            slab_allocator->GetUnallocatedSlabBytes());
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_OK(cache->Insert(std::to_string(i), values[i], &kHelper, kUsable));
+  }
+
+  // The slab space charged is capped at the usage, so inserts evict only
+  // the oldest entries instead of everything in the shard.
+  ASSERT_EQ(4 * kUsable, cache->GetUsage());
+  for (int i = 0; i < 6; ++i) {
+    Cache::Handle* h = cache->BasicLookup(std::to_string(i), nullptr);
+    ASSERT_EQ(i >= 2, h != nullptr);
+    if (h != nullptr) {
+      cache->Release(h);
+    }
+  }
+}
+
+TEST_F(LRUCacheTest, QuotaGroupBorrowAndReclaim) {
+  LRUCacheOptions opts;
+  opts.capacity = 1000;
+  opts.num_shard_bits = 0;
+  opts.metadata_charge_policy = kDontChargeCacheMetadata;
+  std::shared_ptr<CacheQuotaGroup> group = NewCacheQuotaGroup(opts);
+  std::shared_ptr<Cache> a;
+  std::shared_ptr<Cache> b;
+  ASSERT_OK(group->NewQuotaCache("a", 500, &a));
+  ASSERT_OK(group->NewQuotaCache("b", 300, &b));
+  std::shared_ptr<Cache> c;
+  ASSERT_TRUE(group->NewQuotaCache("a", 100, &c).IsInvalidArgument());
+  ASSERT_TRUE(group->NewQuotaCache("c", 300, &c).IsInvalidArgument());
+
+  auto stat = [&](const std::string& key) {
+    std::map<std::string, std::string> stats;
+    group->GetQuotaStats(&stats);
+    EXPECT_TRUE(stats.count(key) > 0) << key;
+    return std::stoull(stats[key]);
+  };
+  auto insert = [](Cache* cache, const std::string& prefix, int n) {
+    for (int i = 0; i < n; i++) {
+      ASSERT_OK(cache->Insert(prefix + std::to_string(i), nullptr,
+                              &kNoopCacheItemHelper, /*charge=*/10));
+    }
+  };
+
+  // With b idle, a borrows both the free capacity and b's share
+  insert(a.get(), "a", 100);
+  ASSERT_EQ(a->GetUsage(), 1000);
+  ASSERT_EQ(stat("a.capacity"), 1000);
+  ASSERT_EQ(stat("b.capacity"), 0);
+
+  // b takes its share back, evicting from a
+  insert(b.get(), "b", 20);
+  ASSERT_EQ(b->GetUsage(), 200);
+  ASSERT_LE(a->GetUsage(), 800);
+
+  // but cannot take more than its share from a busy a
+  insert(b.get(), "bb", 100);
+  ASSERT_GE(stat("b.capacity"), 300);
+  ASSERT_LE(stat("b.capacity"), 320);
+  ASSERT_GE(stat("a.capacity"), 500);
+  ASSERT_LE(stat("a.capacity") + stat("b.capacity"), 1000);
+  ASSERT_LE(b->GetUsage(), stat("b.capacity"));
+  ASSERT_LE(a->GetUsage(), stat("a.capacity"));
+
+  // Lookups and hits are reported per quota
+  Cache::Handle* h = a->Lookup("a99");
+  ASSERT_NE(h, nullptr);
+  a->Release(h);
+  ASSERT_EQ(a->Lookup("a0"), nullptr);
+  ASSERT_EQ(stat("a.lookups"), 2);
+  ASSERT_EQ(stat("a.hits"), 1);
+  ASSERT_EQ(stat("b.lookups"), 0);
+  ASSERT_EQ(stat("a.guaranteed_capacity"), 500);
+  ASSERT_EQ(stat("capacity"), 1000);
+  std::map<std::string, std::string> stats;
+  group->GetQuotaStats(&stats);
+  ASSERT_EQ(stats["a.hit_rate"], "0.5000");
+
+  // A QuotaCache is found directly or through wrappers
+  ASSERT_NE(a->CheckedCast<QuotaCache>(), nullptr);
+  CacheWithStats wrapped(a);
+  ASSERT_EQ(wrapped.CheckedCast<QuotaCache>(), a->CheckedCast<QuotaCache>());
+  std::shared_ptr<Cache> lru = NewLRUCache(opts);
+  ASSERT_EQ(lru->CheckedCast<QuotaCache>(), nullptr);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
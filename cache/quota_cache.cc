@@ -0,0 +1,208 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/quota_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "cache/sharded_cache.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+QuotaCache::QuotaCache(std::shared_ptr<CacheQuotaGroupImpl> group,
+                       CacheQuota* quota)
+    : CacheWrapper(quota->cache), group_(std::move(group)), quota_(quota) {}
+
+Status QuotaCache::Insert(const Slice& key, ObjectPtr obj,
+                          const CacheItemHelper* helper, size_t charge,
+                          Handle** handle, Priority priority,
+                          const Slice& compressed_val, CompressionType type) {
+  const int64_t delta = static_cast<int64_t>(charge);
+  if (quota_->headroom.FetchSubRelaxed(delta) < delta) {
+    group_->MaybeGrow(quota_, charge);
+  }
+  return target_->Insert(key, obj, helper, charge, handle, priority,
+                         compressed_val, type);
+}
+
+Cache::Handle* QuotaCache::Lookup(const Slice& key,
+                                  const CacheItemHelper* helper,
+                                  CreateContext* create_context,
+                                  Priority priority, Statistics* stats) {
+  Cache::Handle* handle =
+      target_->Lookup(key, helper, create_context, priority, stats);
+  quota_->lookups.FetchAddRelaxed(1);
+  if (handle != nullptr) {
+    quota_->hits.FetchAddRelaxed(1);
+  }
+  return handle;
+}
+
+void QuotaCache::WaitAll(AsyncLookupHandle* async_handles, size_t count) {
+  target_->WaitAll(async_handles, count);
+  // Although some could finish by return of StartAsyncLookup, Wait/WaitAll
+  // will generally be used, so simpler to count here.
+  uint64_t hits = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (async_handles[i].Result() != nullptr) {
+      ++hits;
+    }
+  }
+  quota_->lookups.FetchAddRelaxed(count);
+  quota_->hits.FetchAddRelaxed(hits);
+}
+
+CacheQuotaGroupImpl::CacheQuotaGroupImpl(const LRUCacheOptions& cache_opts)
+    : cache_opts_(cache_opts),
+      min_borrow_(std::max(cache_opts.capacity / 64, size_t{1})) {}
+
+Status CacheQuotaGroupImpl::NewQuotaCache(const std::string& name,
+                                          size_t guaranteed_capacity,
+                                          std::shared_ptr<Cache>* cache) {
+  MutexLock l(&mutex_);
+  size_t assigned = 0;
+  for (const auto& quota : quotas_) {
+    if (quota->name == name) {
+      return Status::InvalidArgument("Duplicate cache quota name", name);
+    }
+    assigned += quota->capacity.LoadRelaxed();
+  }
+  if (guaranteed_capacity > cache_opts_.capacity - total_guaranteed_) {
+    return Status::InvalidArgument(
+        "Guaranteed capacity of cache quotas exceeds the group capacity",
+        name);
+  }
+
+  LRUCacheOptions opts = cache_opts_;
+  // Sized for the quota to grow to the whole group capacity
+  if (opts.num_shard_bits < 0) {
+    opts.num_shard_bits = GetDefaultCacheShardBits(cache_opts_.capacity);
+  }
+  // Whatever is not in the free pool is reclaimed on the first inserts
+  opts.capacity =
+      std::min(guaranteed_capacity, cache_opts_.capacity - assigned);
+  std::unique_ptr<CacheQuota> quota(new CacheQuota());
+  quota->name = name;
+  quota->guaranteed_capacity = guaranteed_capacity;
+  quota->capacity.StoreRelaxed(opts.capacity);
+  quota->cache = opts.MakeSharedCache();
+  if (quota->cache == nullptr) {
+    return Status::InvalidArgument("Invalid cache options for quota", name);
+  }
+  *cache = std::make_shared<QuotaCache>(shared_from_this(), quota.get());
+  total_guaranteed_ += guaranteed_capacity;
+  quotas_.push_back(std::move(quota));
+  return Status::OK();
+}
+
+void CacheQuotaGroupImpl::GetQuotaStats(
+    std::map<std::string, std::string>* stats) {
+  assert(stats != nullptr);
+  MutexLock l(&mutex_);
+  (*stats)["capacity"] = std::to_string(cache_opts_.capacity);
+  for (const auto& quota : quotas_) {
+    const std::string& prefix = quota->name;
+    uint64_t lookups = quota->lookups.LoadRelaxed();
+    uint64_t hits = quota->hits.LoadRelaxed();
+    char hit_rate[16];
+    snprintf(hit_rate, sizeof(hit_rate), "%.4f",
+             lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups);
+    (*stats)[prefix + ".guaranteed_capacity"] =
+        std::to_string(quota->guaranteed_capacity);
+    (*stats)[prefix + ".capacity"] =
+        std::to_string(quota->capacity.LoadRelaxed());
+    (*stats)[prefix + ".usage"] = std::to_string(quota->cache->GetUsage());
+    (*stats)[prefix + ".lookups"] = std::to_string(lookups);
+    (*stats)[prefix + ".hits"] = std::to_string(hits);
+    (*stats)[prefix + ".hit_rate"] = hit_rate;
+  }
+}
+
+void CacheQuotaGroupImpl::MaybeGrow(CacheQuota* quota, size_t charge) {
+  MutexLock l(&mutex_);
+  const size_t usage = quota->cache->GetUsage();
+  size_t capacity = quota->capacity.LoadRelaxed();
+  if (usage + charge > capacity) {
+    // Borrow a bit more than needed, so that the next inserts do not need
+    // to come back right away
+    size_t want = std::max(usage + charge - capacity, min_borrow_);
+    size_t got = 0;
+
+    // 1. From the free pool
+    size_t assigned = 0;
+    for (const auto& other : quotas_) {
+      assigned += other->capacity.LoadRelaxed();
+    }
+    if (assigned < cache_opts_.capacity) {
+      got = std::min(want, cache_opts_.capacity - assigned);
+    }
+
+    // 2. Capacity not in use by the other quotas
+    for (const auto& other : quotas_) {
+      if (got >= want) {
+        break;
+      }
+      if (other.get() == quota) {
+        continue;
+      }
+      size_t other_capacity = other->capacity.LoadRelaxed();
+      size_t other_usage = other->cache->GetUsage();
+      if (other_capacity > other_usage) {
+        size_t take = std::min(want - got, other_capacity - other_usage);
+        SetQuotaCapacity(other.get(), other_capacity - take);
+        got += take;
+      }
+    }
+
+    // 3. Back up to the guaranteed capacity, from the quotas that borrowed
+    for (const auto& other : quotas_) {
+      if (got >= want || capacity + got >= quota->guaranteed_capacity) {
+        break;
+      }
+      if (other.get() == quota) {
+        continue;
+      }
+      size_t other_capacity = other->capacity.LoadRelaxed();
+      if (other_capacity > other->guaranteed_capacity) {
+        size_t take = std::min({want - got,
+                                quota->guaranteed_capacity - capacity - got,
+                                other_capacity - other->guaranteed_capacity});
+        SetQuotaCapacity(other.get(), other_capacity - take);
+        got += take;
+      }
+    }
+
+    if (got > 0) {
+      capacity += got;
+      SetQuotaCapacity(quota, capacity);
+    }
+  }
+  if (usage + charge <= capacity) {
+    quota->headroom.StoreRelaxed(
+        static_cast<int64_t>(capacity - usage - charge));
+  } else {
+    // Full, so inserts evict within the quota until the next attempt
+    quota->headroom.StoreRelaxed(static_cast<int64_t>(min_borrow_));
+  }
+}
+
+void CacheQuotaGroupImpl::SetQuotaCapacity(CacheQuota* quota,
+                                           size_t capacity) {
+  mutex_.AssertHeld();
+  quota->capacity.StoreRelaxed(capacity);
+  quota->cache->SetCapacity(capacity);
+  size_t usage = quota->cache->GetUsage();
+  quota->headroom.StoreRelaxed(
+      capacity > usage ? static_cast<int64_t>(capacity - usage) : 0);
+}
+
+std::shared_ptr<CacheQuotaGroup> NewCacheQuotaGroup(
+    const LRUCacheOptions& cache_opts) {
+  return std::make_shared<CacheQuotaGroupImpl>(cache_opts);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
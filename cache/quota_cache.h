@@ -0,0 +1,108 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/advanced_cache.h"
+#include "rocksdb/cache.h"
+#include "util/atomic.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class CacheQuotaGroupImpl;
+
+// The state of one quota of a CacheQuotaGroupImpl
+struct CacheQuota {
+  std::string name;
+  size_t guaranteed_capacity = 0;
+  // Current capacity of `cache`. Only changed with the group mutex held.
+  RelaxedAtomic<size_t> capacity{0};
+  // Bytes that can still be inserted before asking the group for more
+  // capacity. Conservative, as evictions and erasures are not counted.
+  RelaxedAtomic<int64_t> headroom{0};
+  RelaxedAtomic<uint64_t> lookups{0};
+  RelaxedAtomic<uint64_t> hits{0};
+  // The LRUCache holding the entries of this quota
+  std::shared_ptr<Cache> cache;
+};
+
+// The cache of one quota. Forwards to the LRUCache of the quota, asking the
+// group for more capacity before an insert would need to evict, and counts
+// lookups and hits.
+class QuotaCache : public CacheWrapper {
+ public:
+  QuotaCache(std::shared_ptr<CacheQuotaGroupImpl> group, CacheQuota* quota);
+
+  static const char* kClassName() { return "QuotaCache"; }
+  const char* Name() const override { return kClassName(); }
+
+  Status Insert(
+      const Slice& key, ObjectPtr obj, const CacheItemHelper* helper,
+      size_t charge, Handle** handle = nullptr,
+      Priority priority = Priority::LOW, const Slice& compressed_val = Slice(),
+      CompressionType type = CompressionType::kNoCompression) override;
+
+  Cache::Handle* Lookup(const Slice& key, const CacheItemHelper* helper,
+                        CreateContext* create_context,
+                        Priority priority = Priority::LOW,
+                        Statistics* stats = nullptr) override;
+
+  void WaitAll(AsyncLookupHandle* async_handles, size_t count) override;
+
+  // The capacity is managed by the group
+  void SetCapacity(size_t /*capacity*/) override {}
+
+  CacheQuotaGroupImpl* GetGroup() const { return group_.get(); }
+
+ private:
+  std::shared_ptr<CacheQuotaGroupImpl> group_;
+  CacheQuota* const quota_;
+};
+
+// The total capacity is split among the quotas, and the capacity no quota
+// holds forms a free pool. When a quota is about to exceed its capacity, it
+// grows by taking, in order:
+// 1. capacity from the free pool,
+// 2. the capacity other quotas hold but do not use, without evicting,
+// 3. if still below its guaranteed capacity, the capacity other quotas hold
+//    beyond their guaranteed capacity, evicting their entries.
+// Since the guaranteed capacities add up to at most the total capacity,
+// a quota can always get back to its guaranteed capacity through 3.
+class CacheQuotaGroupImpl
+    : public CacheQuotaGroup,
+      public std::enable_shared_from_this<CacheQuotaGroupImpl> {
+ public:
+  explicit CacheQuotaGroupImpl(const LRUCacheOptions& cache_opts);
+
+  Status NewQuotaCache(const std::string& name, size_t guaranteed_capacity,
+                       std::shared_ptr<Cache>* cache) override;
+
+  void GetQuotaStats(std::map<std::string, std::string>* stats) override;
+
+  // Make room for inserting `charge` bytes into `quota` if it can have more
+  // capacity, and reset its headroom.
+  void MaybeGrow(CacheQuota* quota, size_t charge);
+
+ private:
+  // REQUIRES: mutex_ held
+  void SetQuotaCapacity(CacheQuota* quota, size_t capacity);
+
+  const LRUCacheOptions cache_opts_;
+  // Granularity of borrowing, and amount inserted into a full quota between
+  // attempts to borrow
+  const size_t min_borrow_;
+  port::Mutex mutex_;
+  std::vector<std::unique_ptr<CacheQuota>> quotas_;
+  size_t total_guaranteed_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
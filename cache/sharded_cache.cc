@@ -63,7 +63,9 @@ ShardedCacheBase::ShardedCacheBase(const ShardedCacheOptions& opts)
       shard_mask_((uint32_t{1} << opts.num_shard_bits) - 1),
       hash_seed_(DetermineSeed(opts.hash_seed)),
       strict_capacity_limit_(opts.strict_capacity_limit),
-      capacity_(opts.capacity) {}
+      capacity_(opts.capacity),
+      admission_policy_(opts.admission_policy),
+      admission_shard_capacity_(ComputePerShardCapacity(opts.capacity)) {}
 
 size_t ShardedCacheBase::ComputePerShardCapacity(size_t capacity) const {
   uint32_t num_shards = GetNumShards();
@@ -122,6 +124,9 @@ std::string ShardedCacheBase::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "    memory_allocator : %s\n",
            memory_allocator() ? memory_allocator()->Name() : "None");
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    admission_policy : %s\n",
+           admission_policy_ ? admission_policy_->Name() : "None");
+  ret.append(buffer);
   AppendPrintableOptions(ret);
   return ret;
 }
@@ -16,6 +16,7 @@
 #include "port/lang.h"
 #include "port/port.h"
 #include "rocksdb/advanced_cache.h"
+#include "util/atomic.h"
 #include "util/hash.h"
 #include "util/mutexlock.h"
 
@@ -122,6 +123,11 @@ class ShardedCacheBase : public Cache {
   bool strict_capacity_limit_;
   size_t capacity_;
   mutable port::Mutex config_mutex_;
+
+  const std::shared_ptr<CacheAdmissionPolicy> admission_policy_;
+  // Per-shard capacity, readable without config_mutex_ when deciding
+  // whether an insertion needs the admission policy
+  RelaxedAtomic<size_t> admission_shard_capacity_;
 };
 
 // Generic cache interface that shards cache by hash of keys. 2^num_shard_bits
@@ -162,6 +168,7 @@ class ShardedCache : public ShardedCacheBase {
     MutexLock l(&config_mutex_);
     capacity_ = capacity;
     auto per_shard = ComputePerShardCapacity(capacity);
+    admission_shard_capacity_.StoreRelaxed(per_shard);
     ForEachShard([=](CacheShard* cs) { cs->SetCapacity(per_shard); });
   }
 
@@ -180,9 +187,24 @@ class ShardedCache : public ShardedCacheBase {
       CompressionType /*type*/ = CompressionType::kNoCompression) override {
     assert(helper);
     HashVal hash = CacheShard::ComputeHash(key, hash_seed_);
+    CacheShard& shard = GetShard(hash);
+    // GetUsage() is a relaxed load for all shard types, so the common case
+    // of a cache with room to spare costs no shard lock here
+    if (admission_policy_ && obj != nullptr &&
+        shard.GetUsage() + charge >
+            admission_shard_capacity_.LoadRelaxed() &&
+        !admission_policy_->Admit(key)) {
+      if (handle == nullptr) {
+        // As if inserted and immediately evicted
+        if (helper->del_cb) {
+          helper->del_cb(obj, memory_allocator());
+        }
+        return Status::OK();
+      }
+      return Status::Incomplete("Rejected by cache admission policy");
+    }
     auto h_out = reinterpret_cast<HandleImpl**>(handle);
-    return GetShard(hash).Insert(key, hash, obj, helper, charge, h_out,
-                                 priority);
+    return shard.Insert(key, hash, obj, helper, charge, h_out, priority);
   }
 
   Handle* CreateStandalone(const Slice& key, ObjectPtr obj,
@@ -199,6 +221,9 @@ class ShardedCache : public ShardedCacheBase {
                  CreateContext* create_context = nullptr,
                  Priority priority = Priority::LOW,
                  Statistics* stats = nullptr) override {
+    if (admission_policy_) {
+      admission_policy_->RecordAccess(key);
+    }
     HashVal hash = CacheShard::ComputeHash(key, hash_seed_);
     HandleImpl* result = GetShard(hash).Lookup(key, hash, helper,
                                                create_context, priority, stats);
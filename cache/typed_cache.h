@@ -97,6 +97,16 @@ template <CacheEntryRole kRole>
 using PlaceholderSharedCacheInterface =
     PlaceholderCacheInterface<kRole, std::shared_ptr<Cache>>;
 
+// Whether TValue implements void* GetAllocation(MemoryAllocator*) const,
+// which backs CacheItemHelper::allocation_cb.
+template <class TValue, class = void>
+struct HasGetAllocation : std::false_type {};
+template <class TValue>
+struct HasGetAllocation<TValue,
+                        std::void_t<decltype(std::declval<const TValue&>()
+                                                 .GetAllocation(nullptr))>>
+    : std::true_type {};
+
 template <class TValue>
 class BasicTypedCacheHelperFns {
  public:
@@ -110,6 +120,18 @@ class BasicTypedCacheHelperFns {
     return static_cast<TValuePtr>(value);
   }
 
+  static void* GetAllocation(ObjectPtr value, MemoryAllocator* allocator) {
+    return DownCastValue(value)->GetAllocation(allocator);
+  }
+
+  static constexpr Cache::AllocationCallback GetAllocationCallback() {
+    if constexpr (HasGetAllocation<TValue>::value) {
+      return &GetAllocation;
+    } else {
+      return nullptr;
+    }
+  }
+
   static void Delete(ObjectPtr value, MemoryAllocator* allocator) {
     // FIXME: Currently, no callers actually allocate the ObjectPtr objects
     // using the custom allocator, just subobjects that keep a reference to
@@ -132,8 +154,9 @@ template <class TValue, CacheEntryRole kRole>
 class BasicTypedCacheHelper : public BasicTypedCacheHelperFns<TValue> {
  public:
   static const Cache::CacheItemHelper* GetBasicHelper() {
-    static const Cache::CacheItemHelper kHelper{kRole,
-                                                &BasicTypedCacheHelper::Delete};
+    static const Cache::CacheItemHelper kHelper{
+        kRole, &BasicTypedCacheHelper::Delete,
+        BasicTypedCacheHelper::GetAllocationCallback()};
     return &kHelper;
   }
 };
@@ -265,7 +288,8 @@ class FullTypedCacheHelper
         &FullTypedCacheHelper::Size,
         &FullTypedCacheHelper::SaveTo,
         &FullTypedCacheHelper::Create,
-        BasicTypedCacheHelper<TValue, kRole>::GetBasicHelper()};
+        BasicTypedCacheHelper<TValue, kRole>::GetBasicHelper(),
+        FullTypedCacheHelper::GetAllocationCallback()};
     return &kHelper;
   }
 };
@@ -96,6 +96,9 @@ Status BlobSource::PutBlobIntoCache(
     RecordTick(statistics_, BLOB_DB_CACHE_BYTES_WRITE,
                cached_blob->GetValue()->size());
 
+  } else if (s.IsIncomplete()) {
+    // Rejected by the cache admission policy: the caller keeps the blob.
+    return Status::OK();
   } else {
     RecordTick(statistics_, BLOB_DB_CACHE_ADD_FAILURES);
   }
@@ -246,7 +249,9 @@ Status BlobSource::GetBlob(const ReadOptions& read_options,
     if (!s.ok()) {
       return s;
     }
+  }
 
+  if (!blob_handle.IsEmpty()) {
     PinCachedBlob(&blob_handle, value);
   } else {
     PinOwnedBlob(&blob_contents, value);
@@ -409,8 +414,10 @@ void BlobSource::MultiGetBlobFromOneFile(const ReadOptions& read_options,
           s = PutBlobIntoCache(key, &blob_contents, &blob_handle);
           if (!s.ok()) {
             *req->status = s;
-          } else {
+          } else if (!blob_handle.IsEmpty()) {
             PinCachedBlob(&blob_handle, req->result);
+          } else {
+            PinOwnedBlob(&blob_contents, req->result);
           }
         }
       }
@@ -118,6 +118,8 @@ class BlobSource {
   Status GetBlobFromCache(const Slice& cache_key,
                           CacheHandleGuard<BlobContents>* cached_blob) const;
 
+  // Leaves *blob and *cached_blob as they are if the cache admission policy
+  // rejects the blob.
   Status PutBlobIntoCache(const Slice& cache_key,
                           std::unique_ptr<BlobContents>* blob,
                           CacheHandleGuard<BlobContents>* cached_blob) const;
@@ -2198,6 +2198,7 @@ void rocksdb_writebatch_iterate(rocksdb_writebatch_t* b, void* state,
 }
 
 const char* rocksdb_writebatch_data(rocksdb_writebatch_t* b, size_t* size) {
+  b->rep.MaterializePinnedValues();
   *size = b->rep.GetDataSize();
   return b->rep.Data().c_str();
 }
@@ -2439,6 +2440,7 @@ void rocksdb_writebatch_wi_iterate(
 const char* rocksdb_writebatch_wi_data(rocksdb_writebatch_wi_t* b,
                                        size_t* size) {
   WriteBatch* wb = b->rep->GetWriteBatch();
+  wb->MaterializePinnedValues();
   *size = wb->GetDataSize();
   return wb->Data().c_str();
 }
@@ -622,6 +622,12 @@ ColumnFamilyData::ColumnFamilyData(
           new LevelCompactionPicker(ioptions_, &internal_comparator_));
     }
 
+    if (db_options.write_stall_per_column_family &&
+        column_family_set_->write_controller_ != nullptr) {
+      scoped_write_controller_.reset(new WriteController(
+          column_family_set_->write_controller_->max_delayed_write_rate()));
+    }
+
     if (column_family_set_->NumberOfColumnFamilies() < 10) {
       ROCKS_LOG_INFO(ioptions_.logger,
                      "--------------- Options for column family [%s]:\n",
@@ -745,6 +751,7 @@ void ColumnFamilyData::SetDropped() {
   assert(id_ != 0);
   dropped_ = true;
   write_controller_token_.reset();
+  scoped_stall_token_.reset();
 
   // remove from column_family_set
   column_family_set_->RemoveColumnFamily(this);
@@ -956,7 +963,12 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
   auto write_stall_condition = WriteStallCondition::kNormal;
   if (current_ != nullptr) {
     auto* vstorage = current_->storage_info();
-    auto write_controller = column_family_set_->write_controller_;
+    // Stop and delay tokens come from the scoped controller if there is one;
+    // compaction pressure always applies to the whole DB.
+    auto db_write_controller = column_family_set_->write_controller_;
+    auto write_controller = scoped_write_controller_
+                                ? scoped_write_controller_.get()
+                                : db_write_controller;
     uint64_t compaction_needed_bytes =
         vstorage->estimated_compaction_needed_bytes();
 
@@ -1070,7 +1082,7 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
               mutable_cf_options.level0_file_num_compaction_trigger,
               mutable_cf_options.level0_slowdown_writes_trigger)) {
         write_controller_token_ =
-            write_controller->GetCompactionPressureToken();
+            db_write_controller->GetCompactionPressureToken();
         ROCKS_LOG_INFO(
             ioptions_.logger,
             "[%s] Increasing compaction threads because we have %d level-0 "
@@ -1080,12 +1092,12 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
         // If soft pending compaction byte limit is not set, always speed up
         // compaction.
         write_controller_token_ =
-            write_controller->GetCompactionPressureToken();
+            db_write_controller->GetCompactionPressureToken();
       } else if (vstorage->estimated_compaction_needed_bytes() >=
                  GetPendingCompactionBytesForCompactionSpeedup(
                      mutable_cf_options, vstorage)) {
         write_controller_token_ =
-            write_controller->GetCompactionPressureToken();
+            db_write_controller->GetCompactionPressureToken();
         ROCKS_LOG_INFO(
             ioptions_.logger,
             "[%s] Increasing compaction threads because of estimated pending "
@@ -1095,7 +1107,7 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
       } else if (uint64_t(vstorage->FilesMarkedForCompaction().size()) >=
                  GetMarkedFileCountForCompactionSpeedup()) {
         write_controller_token_ =
-            write_controller->GetCompactionPressureToken();
+            db_write_controller->GetCompactionPressureToken();
         ROCKS_LOG_INFO(
             ioptions_.logger,
             "[%s] Increasing compaction threads because we have %" PRIu64
@@ -1116,8 +1128,15 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
         // Note we don't reset this value even after delay condition is relased.
         // Low-pri rate will continue to apply if there is a compaction
         // pressure.
-        write_controller->low_pri_rate_limiter()->SetBytesPerSecond(write_rate /
-                                                                    4);
+        db_write_controller->low_pri_rate_limiter()->SetBytesPerSecond(
+            write_rate / 4);
+      }
+    }
+    if (scoped_write_controller_ != nullptr) {
+      if (write_stall_condition == WriteStallCondition::kNormal) {
+        scoped_stall_token_.reset();
+      } else if (scoped_stall_token_ == nullptr) {
+        scoped_stall_token_ = db_write_controller->GetScopedStallToken(id_);
       }
     }
     prev_compaction_needed_bytes_ = compaction_needed_bytes;
@@ -1423,6 +1442,16 @@ Status ColumnFamilyData::ValidateOptions(
     return s;
   }
 
+  // The adaptive radix tree orders entries by the raw bytes of the user key.
+  if (cf_options.memtable_factory->IsInstanceOf(
+          AdaptiveRadixTreeRepFactory::kClassName()) &&
+      (cf_options.comparator != BytewiseComparator() ||
+       cf_options.comparator->timestamp_size() != 0)) {
+    return Status::InvalidArgument(
+        "AdaptiveRadixTreeRepFactory requires BytewiseComparator() without "
+        "user-defined timestamps");
+  }
+
   if (cf_options.ttl > 0 && cf_options.ttl != kDefaultTtl) {
     if (!cf_options.table_factory->IsInstanceOf(
             TableFactory::kBlockBasedTableName())) {
@@ -499,6 +499,14 @@ class ColumnFamilyData {
   WriteStallCondition RecalculateWriteStallConditions(
       const MutableCFOptions& mutable_cf_options);
 
+  // The WriteController through which this column family stops and delays
+  // writes to itself only, or nullptr if its stalls apply to the whole DB.
+  // See DBOptions::write_stall_per_column_family.
+  // thread-safe
+  WriteController* scoped_write_controller() {
+    return scoped_write_controller_.get();
+  }
+
   void set_initialized() { initialized_.store(true); }
 
   bool initialized() const { return initialized_.load(); }
@@ -639,8 +647,15 @@ class ColumnFamilyData {
 
   ColumnFamilySet* column_family_set_;
 
+  // Declared before the tokens, which may refer to it.
+  std::unique_ptr<WriteController> scoped_write_controller_;
+
   std::unique_ptr<WriteControllerToken> write_controller_token_;
 
+  // Held on the DB's WriteController while this column family stops or delays
+  // writes through scoped_write_controller_.
+  std::unique_ptr<WriteControllerToken> scoped_stall_token_;
+
   // If true --> this ColumnFamily is currently present in DBImpl::flush_queue_
   bool queued_for_flush_;
 
@@ -2912,6 +2912,85 @@ TEST_P(ColumnFamilyTest, WriteStallTwoColumnFamilies) {
   ASSERT_EQ(kBaseRate / 1.25, GetDbDelayedWriteRate());
 }
 
+TEST_P(ColumnFamilyTest, WriteStallPerColumnFamily) {
+  const uint64_t kBaseRate = 810000u;
+  db_options_.delayed_write_rate = kBaseRate;
+  db_options_.write_stall_per_column_family = true;
+  Open();
+  CreateColumnFamilies({"one"});
+  ColumnFamilyData* cfd1 =
+      static_cast<ColumnFamilyHandleImpl*>(handles_[1])->cfd();
+  VersionStorageInfo* vstorage1 = cfd1->current()->storage_info();
+  WriteController* scoped_write_controller = cfd1->scoped_write_controller();
+  ASSERT_NE(nullptr, scoped_write_controller);
+
+  MutableCFOptions mutable_cf_options(column_family_options_);
+  mutable_cf_options.level0_slowdown_writes_trigger = 20;
+  mutable_cf_options.level0_stop_writes_trigger = 10000;
+  mutable_cf_options.soft_pending_compaction_bytes_limit = 200;
+  mutable_cf_options.hard_pending_compaction_bytes_limit = 2000;
+
+  auto dbmu = dbfull()->TEST_Mutex();
+  WriteOptions no_slowdown;
+  no_slowdown.no_slowdown = true;
+
+  // Stopping "one" stops writes to "one" only.
+  vstorage1->TEST_set_estimated_compaction_needed_bytes(2001, dbmu);
+  RecalculateWriteStallConditions(cfd1, mutable_cf_options);
+  ASSERT_TRUE(scoped_write_controller->IsStopped());
+  ASSERT_TRUE(!IsDbWriteStopped());
+  ASSERT_TRUE(!dbfull()->TEST_write_controler().NeedsDelay());
+  ASSERT_TRUE(dbfull()->TEST_write_controler().HasScopedStalls());
+  ASSERT_TRUE(dbfull()->TEST_write_controler().NeedSpeedupCompaction());
+  ASSERT_TRUE(dbfull()->TEST_write_controler().MayHaveScopedStall(1));
+  ASSERT_TRUE(!dbfull()->TEST_write_controler().MayHaveScopedStall(0));
+  // Only writes to "one" take the DB mutex to check its stall.
+  std::atomic<int> num_checks{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::DelayWriteForScopedStalls:CheckColumnFamilies",
+      [&](void*) { ++num_checks; });
+  SyncPoint::GetInstance()->EnableProcessing();
+  ASSERT_OK(db_->Put(no_slowdown, handles_[0], "a", "v"));
+  ASSERT_EQ(0, num_checks.load());
+  ASSERT_TRUE(db_->Put(no_slowdown, handles_[1], "a", "v").IsIncomplete());
+  ASSERT_EQ(1, num_checks.load());
+  WriteBatch batch;
+  ASSERT_OK(batch.Put(handles_[0], "b", "v"));
+  ASSERT_OK(batch.Put(handles_[1], "b", "v"));
+  ASSERT_TRUE(db_->Write(no_slowdown, &batch).IsIncomplete());
+  ASSERT_EQ(2, num_checks.load());
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  // Delaying "one" delays writes to "one" only, at its own rate.
+  vstorage1->TEST_set_estimated_compaction_needed_bytes(600, dbmu);
+  RecalculateWriteStallConditions(cfd1, mutable_cf_options);
+  ASSERT_TRUE(!scoped_write_controller->IsStopped());
+  ASSERT_TRUE(scoped_write_controller->NeedsDelay());
+  ASSERT_TRUE(!dbfull()->TEST_write_controler().NeedsDelay());
+  ASSERT_EQ(0, GetDbDelayedWriteRate());
+  ASSERT_EQ(kBaseRate, scoped_write_controller->delayed_write_rate());
+  ASSERT_OK(db_->Put(no_slowdown, handles_[0], "c", "v"));
+  ASSERT_OK(Put(1, "c", std::string(1000, 'v')));
+
+  std::map<std::string, std::string> cf_values;
+  ASSERT_TRUE(db_->GetMapProperty(
+      handles_[1], DB::Properties::kCFWriteStallStats, &cf_values));
+  ASSERT_EQ("1", cf_values[WriteStallStatsMapKeys::CFScopedWriteStalls()]);
+  ASSERT_NE(
+      "0", cf_values[WriteStallStatsMapKeys::CFScopedWriteStallMicros()]);
+  ASSERT_TRUE(db_->GetMapProperty(
+      handles_[0], DB::Properties::kCFWriteStallStats, &cf_values));
+  ASSERT_EQ("0", cf_values[WriteStallStatsMapKeys::CFScopedWriteStalls()]);
+
+  vstorage1->TEST_set_estimated_compaction_needed_bytes(50, dbmu);
+  RecalculateWriteStallConditions(cfd1, mutable_cf_options);
+  ASSERT_TRUE(!scoped_write_controller->NeedsDelay());
+  ASSERT_TRUE(!dbfull()->TEST_write_controler().HasScopedStalls());
+  ASSERT_TRUE(!dbfull()->TEST_write_controler().MayHaveScopedStall(1));
+  ASSERT_OK(db_->Put(no_slowdown, handles_[1], "d", "v"));
+}
+
 TEST_P(ColumnFamilyTest, CompactionSpeedupTwoColumnFamilies) {
   db_options_.max_background_compactions = 6;
   column_family_options_.soft_pending_compaction_bytes_limit = 200;
@@ -2151,6 +2151,12 @@ Env::IOPriority CompactionJob::GetRateLimiterPriority() {
       return Env::IO_USER;
     }
   }
+  WriteController* scoped_write_controller =
+      compact_->compaction->column_family_data()->scoped_write_controller();
+  if (scoped_write_controller && (scoped_write_controller->NeedsDelay() ||
+                                  scoped_write_controller->IsStopped())) {
+    return Env::IO_USER;
+  }
 
   return Env::IO_LOW;
 }
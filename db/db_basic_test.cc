@@ -17,6 +17,7 @@
 #include "rocksdb/merge_operator.h"
 #include "rocksdb/perf_context.h"
 #include "rocksdb/table.h"
+#include "rocksdb/threadpool.h"
 #include "rocksdb/utilities/debug.h"
 #include "table/block_based/block_based_table_reader.h"
 #include "table/block_based/block_builder.h"
@@ -3293,6 +3294,61 @@ TEST_F(DBBasicTest, ValueTypeString) {
   }
 }
 
+TEST_F(DBBasicTest, MultiGetParallelDecompression) {
+  CompressionType compression = kNoCompression;
+  for (CompressionType c : GetSupportedCompressions()) {
+    if (c != kNoCompression) {
+      compression = c;
+      break;
+    }
+  }
+  if (compression == kNoCompression) {
+    ROCKSDB_GTEST_BYPASS("No compression support");
+    return;
+  }
+  std::shared_ptr<ThreadPool> pool = NewSharedThreadPool(2);
+
+  Options options = CurrentOptions();
+  options.compression = compression;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 512;
+  table_options.block_cache = NewLRUCache(4 << 20);
+  table_options.decompression_thread_pool = pool;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  const int kNumKeys = 1000;
+  Random rnd(301);
+  std::vector<std::string> expected;
+  for (int i = 0; i < kNumKeys; ++i) {
+    // Compressible, so that the blocks are stored compressed.
+    expected.push_back(rnd.RandomString(20) + std::string(200, 'v'));
+    ASSERT_OK(Put(Key(i), expected.back()));
+  }
+  ASSERT_OK(Flush());
+
+  std::vector<std::string> key_strs;
+  for (int i = 0; i < kNumKeys; i += 3) {
+    key_strs.push_back(Key(i));
+  }
+  key_strs.push_back("missing");
+  std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+  // Cold reads without and with filling the block cache, then warm reads.
+  for (bool fill_cache : {false, true, true}) {
+    ReadOptions read_opts;
+    read_opts.fill_cache = fill_cache;
+    std::vector<PinnableSlice> values(keys.size());
+    std::vector<Status> statuses(keys.size());
+    db_->MultiGet(read_opts, db_->DefaultColumnFamily(), keys.size(),
+                  keys.data(), values.data(), statuses.data());
+    for (size_t i = 0; i + 1 < keys.size(); ++i) {
+      ASSERT_OK(statuses[i]);
+      ASSERT_EQ(expected[i * 3], values[i].ToString());
+    }
+    ASSERT_TRUE(statuses.back().IsNotFound());
+  }
+}
+
 TEST_F(DBBasicTest, MultiGetIOBufferOverrun) {
   Options options = CurrentOptions();
   Random rnd(301);
@@ -394,6 +394,85 @@ TEST_F(DBBlockCacheTest, FillCacheAndIterateDB) {
   iter = nullptr;
 }
 
+namespace {
+class RejectingAdmissionPolicy : public CacheAdmissionPolicy {
+ public:
+  const char* Name() const override { return "RejectingAdmissionPolicy"; }
+  void RecordAccess(const Slice& /*key*/) override {}
+  bool Admit(const Slice& /*key*/) override {
+    rejections_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  size_t rejections() const {
+    return rejections_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<size_t> rejections_{0};
+};
+}  // namespace
+
+TEST_F(DBBlockCacheTest, AdmissionPolicyRejectsBlocks) {
+  auto policy = std::make_shared<RejectingAdmissionPolicy>();
+  LRUCacheOptions cache_options;
+  // Full for any block, so that every insertion asks the policy.
+  cache_options.capacity = 1;
+  cache_options.num_shard_bits = 0;
+  cache_options.metadata_charge_policy = kDontChargeCacheMetadata;
+  cache_options.admission_policy = policy;
+  std::shared_ptr<Cache> cache = cache_options.MakeSharedCache();
+
+  auto table_options = GetTableOptions();
+  table_options.block_cache = cache;
+  auto options = GetOptions(table_options);
+  // The large values go to blob files, which share the cache.
+  options.enable_blob_files = true;
+  options.min_blob_size = kValueSize;
+  options.blob_cache = cache;
+  DestroyAndReopen(options);
+
+  constexpr int kNumKeys = 20;
+  auto value_of = [this](int i) {
+    return i % 2 == 0 ? "small" + std::to_string(i)
+                      : std::string(kValueSize, static_cast<char>('a' + i));
+  };
+  std::vector<std::string> keys;
+  for (int i = 0; i < kNumKeys; ++i) {
+    keys.push_back(Key(i));
+    ASSERT_OK(Put(keys.back(), value_of(i)));
+  }
+  ASSERT_OK(Flush());
+
+  // Rejected blocks and blobs are read without being cached.
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_EQ(value_of(i), Get(keys[i]));
+  }
+  std::vector<std::string> values = MultiGet(keys);
+  ASSERT_EQ(kNumKeys, values.size());
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_EQ(value_of(i), values[i]);
+  }
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int i = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++i) {
+    ASSERT_EQ(keys[i], iter->key());
+    ASSERT_EQ(value_of(i), iter->value());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumKeys, i);
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+    --i;
+    ASSERT_EQ(keys[i], iter->key());
+    ASSERT_EQ(value_of(i), iter->value());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(0, i);
+  iter.reset();
+
+  ASSERT_GT(policy->rejections(), 0);
+  ASSERT_EQ(0, TestGetTickerCount(options, BLOCK_CACHE_ADD_FAILURES));
+}
+
 TEST_F(DBBlockCacheTest, IndexAndFilterBlocksStats) {
   Options options = CurrentOptions();
   options.create_if_missing = true;
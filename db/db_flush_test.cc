@@ -263,6 +263,95 @@ TEST_F(DBFlushTest, ManualFlushWithMinWriteBufferNumberToMerge) {
   t.join();
 }
 
+TEST_F(DBFlushTest, PartitionedFlush) {
+  class TestListener : public EventListener {
+   public:
+    void OnFlushCompleted(DB* /*db*/, const FlushJobInfo& info) override {
+      MutexLock lock(&mu);
+      infos.push_back(info);
+    }
+
+    port::Mutex mu;
+    std::vector<FlushJobInfo> infos;
+  };
+  auto listener = std::make_shared<TestListener>();
+
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.write_buffer_size = 64 << 20;
+  options.max_flush_partitions = 4;
+  options.listeners.push_back(listener);
+  env_->SetBackgroundThreads(4, Env::HIGH);
+  Reopen(options);
+
+  const int kNumKeys = 40000;
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_OK(Put(Key(i), "v" + std::to_string(i)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(dbfull()->TEST_WaitForBackgroundWork());
+
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  ASSERT_GT(files.size(), 1);
+  ASSERT_LE(files.size(), 4);
+  std::sort(files.begin(), files.end(),
+            [](const LiveFileMetaData& a, const LiveFileMetaData& b) {
+              return a.smallestkey < b.smallestkey;
+            });
+  for (size_t i = 0; i < files.size(); ++i) {
+    ASSERT_EQ(0, files[i].level);
+    ASSERT_EQ(files[0].epoch_number, files[i].epoch_number);
+    if (i > 0) {
+      ASSERT_LT(files[i - 1].largestkey, files[i].smallestkey);
+    }
+  }
+
+  // Every output file is reported with its own table properties.
+  ASSERT_EQ(files.size(), listener->infos.size());
+  uint64_t num_entries = 0;
+  for (const FlushJobInfo& info : listener->infos) {
+    auto it = std::find_if(files.begin(), files.end(),
+                           [&info](const LiveFileMetaData& f) {
+                             return f.file_number == info.file_number;
+                           });
+    ASSERT_TRUE(it != files.end());
+    ASSERT_EQ(it->directory + "/" + it->relative_filename, info.file_path);
+    ASSERT_EQ(it->num_entries, info.table_properties.num_entries);
+    num_entries += info.table_properties.num_entries;
+  }
+  ASSERT_EQ(static_cast<uint64_t>(kNumKeys), num_entries);
+
+  for (int i = 0; i < kNumKeys; i += 97) {
+    ASSERT_EQ("v" + std::to_string(i), Get(Key(i)));
+  }
+  Reopen(options);
+  ASSERT_EQ("v0", Get(Key(0)));
+  ASSERT_EQ("v" + std::to_string(kNumKeys - 1), Get(Key(kNumKeys - 1)));
+}
+
+TEST_F(DBFlushTest, PartitionedFlushWithRangeDeletion) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.write_buffer_size = 64 << 20;
+  options.max_flush_partitions = 4;
+  Reopen(options);
+
+  const int kNumKeys = 40000;
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_OK(Put(Key(i), "v"));
+  }
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             Key(10), Key(20)));
+  ASSERT_OK(Flush());
+
+  // Range deletions are not split across files, so the flush is not
+  // partitioned.
+  ASSERT_EQ("1", FilesPerLevel());
+  ASSERT_EQ("NOT_FOUND", Get(Key(15)));
+  ASSERT_EQ("v", Get(Key(20)));
+}
+
 TEST_F(DBFlushTest, ScheduleOnlyOneBgThread) {
   Options options = CurrentOptions();
   Reopen(options);
@@ -53,6 +53,7 @@
 #include "db/table_properties_collector.h"
 #include "db/transaction_log_impl.h"
 #include "db/version_set.h"
+#include "db/wide/wide_columns_helper.h"
 #include "db/write_batch_internal.h"
 #include "db/write_callback.h"
 #include "env/unique_id_gen.h"
@@ -208,6 +209,7 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       write_buffer_manager_(immutable_db_options_.write_buffer_manager.get()),
       write_thread_(immutable_db_options_),
       nonmem_write_thread_(immutable_db_options_),
+      wal_shard_publish_cv_(&wal_shard_publish_mutex_),
       write_controller_(mutable_db_options_.delayed_write_rate),
       last_batch_group_size_(0),
       unscheduled_flushes_(0),
@@ -294,6 +296,11 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       &error_handler_, read_only));
   column_family_memtables_.reset(
       new ColumnFamilyMemTablesImpl(versions_->GetColumnFamilySet()));
+  if (immutable_db_options_.num_wal_shards > 1) {
+    for (uint32_t i = 0; i < immutable_db_options_.num_wal_shards; ++i) {
+      wal_shards_.emplace_back(new WalShard(immutable_db_options_));
+    }
+  }
 
   DumpRocksDBBuildVersion(immutable_db_options_.info_log.get());
   DumpDBFileSummary(immutable_db_options_, dbname_, db_session_id_);
@@ -647,6 +654,18 @@ Status DBImpl::CloseHelper() {
       }
     }
     logs_.clear();
+    for (size_t i = 0; i < wal_shards_.size(); ++i) {
+      WalShard* shard = wal_shards_[i].get();
+      if (i > 0 && shard->log_writer != nullptr) {
+        LogWriterNumber log(shard->log_file.number, shard->log_writer);
+        Status s = log.ClearWriter();
+        if (!s.ok() && ret.ok()) {
+          ret = s;
+        }
+      }
+      shard->log_writer = nullptr;
+      shard->log_file_number_size = nullptr;
+    }
   }
 
   // Table cache may have table handles holding blocks from the block cache.
@@ -1425,6 +1444,12 @@ Status DBImpl::SetDBOptions(
 
       write_controller_.set_max_delayed_write_rate(
           new_options.delayed_write_rate);
+      for (auto cfd : *versions_->GetColumnFamilySet()) {
+        if (cfd->scoped_write_controller() != nullptr) {
+          cfd->scoped_write_controller()->set_max_delayed_write_rate(
+              new_options.delayed_write_rate);
+        }
+      }
       table_cache_.get()->SetCapacity(new_options.max_open_files == -1
                                           ? TableCache::kInfiniteCapacity
                                           : new_options.max_open_files - 10);
@@ -1445,6 +1470,7 @@ Status DBImpl::SetDBOptions(
       if (wal_other_option_changed || wal_size_option_changed) {
         WriteThread::Writer w;
         write_thread_.EnterUnbatched(&w, &mutex_);
+        EnterWalShardsUnbatched();
         if (wal_other_option_changed ||
             total_log_size_ > GetMaxTotalWalSize()) {
           Status purge_wal_status = SwitchWAL(&write_context);
@@ -1454,6 +1480,7 @@ Status DBImpl::SetDBOptions(
                            purge_wal_status.ToString().c_str());
           }
         }
+        ExitWalShardsUnbatched();
         write_thread_.ExitUnbatched(&w);
       }
       persist_options_status =
@@ -1552,6 +1579,7 @@ bool DBImpl::WALBufferIsEmpty() {
 Status DBImpl::SyncWAL() {
   TEST_SYNC_POINT("DBImpl::SyncWAL:Begin");
   autovector<log::Writer*, 1> logs_to_sync;
+  autovector<log::Writer*> wal_shard_logs_to_sync;
   bool need_log_dir_sync;
   uint64_t current_log_number;
 
@@ -1566,16 +1594,25 @@ Status DBImpl::SyncWAL() {
            logs_.front().IsSyncing()) {
       log_sync_cv_.Wait();
     }
-    // First check that logs are safe to sync in background.
+    // First check that logs are safe to sync in background, including the
+    // current logs of the other WAL shards.
+    auto sync_thread_safe = [](log::Writer* writer) {
+      return writer->file()->writable_file()->IsSyncThreadSafe();
+    };
+    bool all_sync_thread_safe = true;
     for (auto it = logs_.begin();
          it != logs_.end() && it->number <= current_log_number; ++it) {
-      if (!it->writer->file()->writable_file()->IsSyncThreadSafe()) {
-        return Status::NotSupported(
-            "SyncWAL() is not supported for this implementation of WAL file",
-            immutable_db_options_.allow_mmap_writes
-                ? "try setting Options::allow_mmap_writes to false"
-                : Slice());
-      }
+      all_sync_thread_safe &= sync_thread_safe(it->writer);
+    }
+    for (size_t i = 1; i < wal_shards_.size(); ++i) {
+      all_sync_thread_safe &= sync_thread_safe(wal_shards_[i]->log_writer);
+    }
+    if (!all_sync_thread_safe) {
+      return Status::NotSupported(
+          "SyncWAL() is not supported for this implementation of WAL file",
+          immutable_db_options_.allow_mmap_writes
+              ? "try setting Options::allow_mmap_writes to false"
+              : Slice());
     }
     for (auto it = logs_.begin();
          it != logs_.end() && it->number <= current_log_number; ++it) {
@@ -1583,6 +1620,14 @@ Status DBImpl::SyncWAL() {
       log.PrepareForSync();
       logs_to_sync.push_back(log.writer);
     }
+    // The current logs of the other WAL shards are not in logs_ yet, but they
+    // belong to the WAL generation of current_log_number.
+    for (size_t i = 1; i < wal_shards_.size(); ++i) {
+      wal_shard_logs_to_sync.push_back(wal_shards_[i]->log_writer);
+    }
+    if (!wal_shard_logs_to_sync.empty()) {
+      ++wal_shard_syncs_in_progress_;
+    }
 
     need_log_dir_sync = !log_dir_synced_;
   }
@@ -1609,6 +1654,21 @@ Status DBImpl::SyncWAL() {
       }
     }
   }
+  if (!wal_shard_logs_to_sync.empty()) {
+    for (log::Writer* log : wal_shard_logs_to_sync) {
+      if (!io_s.ok()) {
+        break;
+      }
+      io_s =
+          log->file()->SyncWithoutFlush(opts, immutable_db_options_.use_fsync);
+      if (!io_s.ok()) {
+        status = io_s;
+      }
+    }
+    InstrumentedMutexLock l(&log_write_mutex_);
+    --wal_shard_syncs_in_progress_;
+    log_sync_cv_.SignalAll();
+  }
   if (!io_s.ok()) {
     ROCKS_LOG_ERROR(immutable_db_options_.info_log, "WAL Sync error %s",
                     io_s.ToString().c_str());
@@ -1676,6 +1736,7 @@ Status DBImpl::LockWAL() {
 
       WriteThread::Writer w;
       write_thread_.EnterUnbatched(&w, &mutex_);
+      EnterWalShardsUnbatched();
       WriteThread::Writer nonmem_w;
       if (two_write_queues_) {
         nonmem_write_thread_.EnterUnbatched(&nonmem_w, &mutex_);
@@ -1692,6 +1753,7 @@ Status DBImpl::LockWAL() {
       if (two_write_queues_) {
         nonmem_write_thread_.ExitUnbatched(&nonmem_w);
       }
+      ExitWalShardsUnbatched();
       write_thread_.ExitUnbatched(&w);
     }
   }
@@ -1984,7 +2046,8 @@ InternalIterator* DBImpl::NewInternalIterator(
       &cfd->internal_comparator(), arena,
       !read_options.total_order_seek &&
           super_version->mutable_cf_options.prefix_extractor != nullptr,
-      read_options.iterate_upper_bound);
+      read_options.iterate_upper_bound,
+      super_version->mutable_cf_options.use_tournament_tree_merge);
   // Collect iterator for mutable memtable
   auto mem_iter = super_version->mem->NewIterator(
       read_options, super_version->GetSeqnoToTimeMapping(), arena);
@@ -2439,6 +2502,13 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
         if (get_impl_options.value) {
           size = get_impl_options.value->size();
         } else if (get_impl_options.columns) {
+          if (read_options.column_projection) {
+            const Status project_status = WideColumnsHelper::ProjectColumns(
+                *read_options.column_projection, get_impl_options.columns);
+            if (!project_status.ok()) {
+              s = project_status;
+            }
+          }
           size = get_impl_options.columns->serialized_size();
         }
       } else {
@@ -3155,6 +3225,14 @@ Status DBImpl::MultiGetImpl(
         bytes_read += key->value->size();
       } else {
         assert(key->columns);
+        if (read_options.column_projection) {
+          const Status project_status = WideColumnsHelper::ProjectColumns(
+              *read_options.column_projection, key->columns);
+          if (!project_status.ok()) {
+            *(key->s) = project_status;
+            continue;
+          }
+        }
         bytes_read += key->columns->serialized_size();
       }
 
@@ -3426,11 +3504,13 @@ Status DBImpl::CreateColumnFamilyImpl(const ReadOptions& read_options,
     {  // write thread
       WriteThread::Writer w;
       write_thread_.EnterUnbatched(&w, &mutex_);
+      EnterWalShardsUnbatched();
       // LogAndApply will both write the creation in MANIFEST and create
       // ColumnFamilyData object
       s = versions_->LogAndApply(nullptr, MutableCFOptions(cf_options),
                                  read_options, write_options, &edit, &mutex_,
                                  directories_.GetDbDir(), false, &cf_options);
+      ExitWalShardsUnbatched();
       write_thread_.ExitUnbatched(&w);
     }
     if (s.ok()) {
@@ -3534,9 +3614,11 @@ Status DBImpl::DropColumnFamilyImpl(ColumnFamilyHandle* column_family) {
       // we drop column family from a single write thread
       WriteThread::Writer w;
       write_thread_.EnterUnbatched(&w, &mutex_);
+      EnterWalShardsUnbatched();
       s = versions_->LogAndApply(cfd, *cfd->GetLatestMutableCFOptions(),
                                  read_options, write_options, &edit, &mutex_,
                                  directories_.GetDbDir());
+      ExitWalShardsUnbatched();
       write_thread_.ExitUnbatched(&w);
     }
     if (s.ok()) {
@@ -4594,6 +4676,10 @@ Status DBImpl::GetUpdatesSince(
         "This API is not yet compatible with write-prepared/write-unprepared "
         "transactions");
   }
+  if (!wal_shards_.empty()) {
+    return Status::NotSupported(
+        "This API is not yet compatible with num_wal_shards > 1");
+  }
   if (seq > versions_->LastSequence()) {
     return Status::NotFound("Requested sequence not yet written in the db");
   }
@@ -5729,6 +5815,7 @@ Status DBImpl::IngestExternalFiles(
     // Stop writes to the DB by entering both write threads
     WriteThread::Writer w;
     write_thread_.EnterUnbatched(&w, &mutex_);
+    EnterWalShardsUnbatched();
     WriteThread::Writer nonmem_w;
     if (two_write_queues_) {
       nonmem_write_thread_.EnterUnbatched(&nonmem_w, &mutex_);
@@ -5895,6 +5982,7 @@ Status DBImpl::IngestExternalFiles(
     if (two_write_queues_) {
       nonmem_write_thread_.ExitUnbatched(&nonmem_w);
     }
+    ExitWalShardsUnbatched();
     write_thread_.ExitUnbatched(&w);
 
     if (status.ok()) {
@@ -6017,6 +6105,7 @@ Status DBImpl::CreateColumnFamilyWithImport(
       // Stop writes to the DB by entering both write threads
       WriteThread::Writer w;
       write_thread_.EnterUnbatched(&w, &mutex_);
+      EnterWalShardsUnbatched();
       WriteThread::Writer nonmem_w;
       if (two_write_queues_) {
         nonmem_write_thread_.EnterUnbatched(&nonmem_w, &mutex_);
@@ -6042,6 +6131,7 @@ Status DBImpl::CreateColumnFamilyWithImport(
       if (two_write_queues_) {
         nonmem_write_thread_.ExitUnbatched(&nonmem_w);
       }
+      ExitWalShardsUnbatched();
       write_thread_.ExitUnbatched(&w);
 
       num_running_ingest_file_--;
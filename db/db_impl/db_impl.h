@@ -1504,6 +1504,12 @@ class DBImpl : public DB {
                             bool disable_memtable = false,
                             uint64_t* seq_used = nullptr);
 
+  // Used by PipelinedWriteImpl() with enable_pipelined_wal_sync. Syncs the WAL
+  // if a sync writer in the memtable write group is not covered by a previous
+  // sync yet.
+  Status MaybeSyncWALForMemTableWriters(
+      const WriteThread::WriteGroup& memtable_write_group);
+
   // Write only to memtables without joining any write queue
   Status UnorderedWriteMemtable(const WriteOptions& write_options,
                                 WriteBatch* my_batch, WriteCallback* callback,
@@ -1738,6 +1744,31 @@ class DBImpl : public DB {
     uint64_t pre_sync_size = 0;
   };
 
+  // A WAL shard, used when num_wal_shards > 1. Every shard has its own writer
+  // queue and its own log file in the current WAL generation. The log of shard
+  // 0 is the primary WAL, logs_.back(); the logs of the other shards are owned
+  // by the shard until the WAL is switched and then handed over to logs_. The
+  // log fields are changed only with mutex_ and log_write_mutex_ held and all
+  // shards entered unbatched, so the shard group leader reads them without
+  // locks.
+  struct WalShard {
+    explicit WalShard(const ImmutableDBOptions& db_options)
+        : write_thread(db_options) {}
+
+    WriteThread write_thread;
+    // Used to enter `write_thread` unbatched; see EnterWalShardsUnbatched().
+    std::unique_ptr<WriteThread::Writer> unbatched_writer;
+    log::Writer* log_writer = nullptr;
+    // alive_log_files_.back() for shard 0, `log_file` for the others.
+    LogFileNumberSize* log_file_number_size = nullptr;
+    LogFileNumberSize log_file;
+    // Number of the primary log of the current WAL generation, i.e. the
+    // logfile_number_ the writes of this shard are recorded against. Only
+    // changes while the shards are entered unbatched.
+    uint64_t primary_log_number = 0;
+    bool log_empty = true;
+  };
+
   struct LogContext {
     explicit LogContext(bool need_sync = false)
         : need_log_sync(need_sync), need_log_dir_sync(need_sync) {}
@@ -1972,6 +2003,15 @@ class DBImpl : public DB {
   Status DelayWrite(uint64_t num_bytes, WriteThread& write_thread,
                     const WriteOptions& write_options);
 
+  // Stops or delays a write whose batch touches column families that stall
+  // writes to themselves only (see
+  // DBOptions::write_stall_per_column_family). Called before the writer
+  // joins a write queue, so that it does not hold up writes to other column
+  // families.
+  // REQUIRES: mutex_ not held
+  Status DelayWriteForScopedStalls(const WriteOptions& write_options,
+                                   WriteBatch* my_batch);
+
   // Begin stalling of writes when memory usage increases beyond a certain
   // threshold.
   void WriteBufferManagerStallWrites();
@@ -2094,6 +2134,46 @@ class DBImpl : public DB {
   Status PreprocessWrite(const WriteOptions& write_options,
                          LogContext* log_context, WriteContext* write_context);
 
+  // Write path used when num_wal_shards > 1. The writer joins the queue of
+  // one WAL shard; the shard group leader allocates the sequence numbers of
+  // its group, appends the group to the log of the shard, inserts it into the
+  // memtables concurrently with the other shards and publishes the sequence
+  // numbers in allocation order.
+  Status WalShardWriteImpl(const WriteOptions& write_options,
+                           WriteBatch* my_batch, WriteCallback* callback,
+                           uint64_t* log_used, uint64_t* seq_used);
+
+  // Writes `write_group` through `shard`. See WalShardWriteImpl().
+  Status WriteWalShardGroup(WalShard* shard,
+                            WriteThread::WriteGroup& write_group,
+                            const WriteOptions& write_options);
+
+  // Whether a write with num_wal_shards > 1 needs to run PreprocessWrite()
+  // before joining a WAL shard.
+  bool WalShardWriteNeedsPreprocess();
+
+  // Runs PreprocessWrite() with write_thread_ and all WAL shards entered
+  // unbatched. If `write_group` is not null, it is also written through the
+  // first WAL shard before leaving, so that its WriteCallback is evaluated
+  // while no other write is in progress.
+  Status PreprocessWalShardWrite(const WriteOptions& write_options,
+                                 WriteThread::WriteGroup* write_group);
+
+  // Waits until all the sequence numbers up to `prev_last_sequence` are
+  // published.
+  void WaitForWalShardPublishTurn(SequenceNumber prev_last_sequence);
+
+  // Publishes `last_sequence`. REQUIRES: WaitForWalShardPublishTurn() returned
+  // for the sequence range ending at `last_sequence`.
+  void PublishWalShardSequence(SequenceNumber last_sequence);
+
+  // With num_wal_shards > 1, acquires (releases) exclusive access to the
+  // writer queues of all WAL shards. Must be called after (before) entering
+  // (exiting) write_thread_ unbatched, which serializes the callers.
+  // REQUIRES: mutex_ held.
+  void EnterWalShardsUnbatched();
+  void ExitWalShardsUnbatched();
+
   // Merge write batches in the write group into merged_batch.
   // Returns OK if merge is successful.
   // Returns Corruption if corruption in write batch is detected.
@@ -2324,6 +2404,30 @@ class DBImpl : public DB {
                      uint64_t recycle_log_number, size_t preallocate_block_size,
                      log::Writer** new_log);
 
+  // Creates the logs of WAL shards 1..n-1 for the WAL generation whose primary
+  // log is `primary_log`, and announces them in a kWalShardsType record at the
+  // head of `primary_log`. Each shard log starts with a kWalShardOfType record
+  // naming `primary_log`. On failure, `shard_logs` is left empty.
+  IOStatus CreateWalShardLogs(const WriteOptions& write_options,
+                              log::Writer* primary_log,
+                              const std::vector<uint64_t>& shard_log_numbers,
+                              size_t preallocate_block_size,
+                              std::vector<log::Writer*>* shard_logs);
+
+  // Makes `primary_log`, which must be logs_.back(), and `shard_logs` the
+  // current logs of the WAL shards.
+  // REQUIRES: mutex_ and log_write_mutex_ held, WAL shards entered unbatched.
+  void InstallWalShardLogs(log::Writer* primary_log,
+                           const std::vector<log::Writer*>& shard_logs);
+
+  // Hands the current logs of WAL shards 1..n-1 over to logs_ and
+  // alive_log_files_, so that they are synced and purged like any closed WAL.
+  // REQUIRES: mutex_ and log_write_mutex_ held, WAL shards entered unbatched.
+  void RetireWalShardLogs();
+
+  // Whether no WAL shard has written to its current log.
+  bool WalShardLogsEmpty() const;
+
   // Validate self-consistency of DB options
   static Status ValidateOptions(const DBOptions& db_options);
   // Validate self-consistency of DB options and its consistency with cf options
@@ -2638,6 +2742,26 @@ class DBImpl : public DB {
   // in 2PC to batch the prepares separately from the serial commit.
   WriteThread nonmem_write_thread_;
 
+  // WAL shards, non-empty only if num_wal_shards > 1.
+  std::vector<std::unique_ptr<WalShard>> wal_shards_;
+  // Orders the publishing of the sequence ranges written by the WAL shards.
+  InstrumentedMutex wal_shard_publish_mutex_;
+  InstrumentedCondVar wal_shard_publish_cv_;
+  // Number of SyncWAL() calls that are syncing the current logs of the WAL
+  // shards. Switching the WAL waits for it to drop to zero before retiring
+  // them. Protected by log_write_mutex_.
+  int wal_shard_syncs_in_progress_ = 0;
+  // Set when a WAL shard writer still finds the total WAL size above the limit
+  // after preprocessing, so that the following writes do not preprocess again
+  // until the WAL is switched.
+  std::atomic<bool> wal_shard_log_oversized_{false};
+
+  // Used with enable_pipelined_wal_sync. The last sequence number appended to
+  // the WAL by a WAL write group leader, and the last sequence number known to
+  // be covered by a WAL sync.
+  std::atomic<SequenceNumber> last_wal_appended_sequence_{0};
+  std::atomic<SequenceNumber> last_wal_synced_sequence_{0};
+
   WriteController write_controller_;
 
   // Size of the last batch group. In slowdown mode, next write needs to
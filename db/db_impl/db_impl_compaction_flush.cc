@@ -430,6 +430,11 @@ Status DBImpl::FlushMemTableToOutputFile(
       // exists. Otherwise, some tests may fail.  Ignore the error in the
       // interim.
       sfm->OnAddFile(file_path).PermitUncheckedError();
+      for (const FileMetaData& pm : flush_job.GetPartitionFileMetaData()) {
+        sfm->OnAddFile(TableFileName(cfd->ioptions()->cf_paths,
+                                     pm.fd.GetNumber(), pm.fd.GetPathId()))
+            .PermitUncheckedError();
+      }
       if (sfm->IsMaxAllowedSpaceReached()) {
         Status new_bg_error =
             Status::SpaceLimit("Max allowed space was reached");
@@ -895,6 +900,11 @@ Status DBImpl::AtomicFlushMemTablesToOutputFiles(
         // exists. Otherwise, some tests may fail.  Ignore the error in the
         // interim.
         sfm->OnAddFile(file_path).PermitUncheckedError();
+        for (const FileMetaData& pm : jobs[i]->GetPartitionFileMetaData()) {
+          sfm->OnAddFile(TableFileName(cfds[i]->ioptions()->cf_paths,
+                                       pm.fd.GetNumber(), pm.fd.GetPathId()))
+              .PermitUncheckedError();
+        }
         if (sfm->IsMaxAllowedSpaceReached() &&
             error_handler_.GetBGError().ok()) {
           Status new_bg_error =
@@ -2323,6 +2333,7 @@ Status DBImpl::FlushMemTable(ColumnFamilyData* cfd,
     WriteThread::Writer nonmem_w;
     if (needs_to_join_write_thread) {
       write_thread_.EnterUnbatched(&w, &mutex_);
+      EnterWalShardsUnbatched();
       if (two_write_queues_) {
         nonmem_write_thread_.EnterUnbatched(&nonmem_w, &mutex_);
       }
@@ -2400,6 +2411,7 @@ Status DBImpl::FlushMemTable(ColumnFamilyData* cfd,
     }
 
     if (needs_to_join_write_thread) {
+      ExitWalShardsUnbatched();
       write_thread_.ExitUnbatched(&w);
       if (two_write_queues_) {
         nonmem_write_thread_.ExitUnbatched(&nonmem_w);
@@ -2497,6 +2509,7 @@ Status DBImpl::AtomicFlushMemTables(
     WriteThread::Writer nonmem_w;
     if (needs_to_join_write_thread) {
       write_thread_.EnterUnbatched(&w, &mutex_);
+      EnterWalShardsUnbatched();
       if (two_write_queues_) {
         nonmem_write_thread_.EnterUnbatched(&nonmem_w, &mutex_);
       }
@@ -2544,6 +2557,7 @@ Status DBImpl::AtomicFlushMemTables(
     }
 
     if (needs_to_join_write_thread) {
+      ExitWalShardsUnbatched();
       write_thread_.ExitUnbatched(&w);
       if (two_write_queues_) {
         nonmem_write_thread_.ExitUnbatched(&nonmem_w);
@@ -208,11 +208,13 @@ void DBImpl::TEST_SignalAllBgCv() { bg_cv_.SignalAll(); }
 void* DBImpl::TEST_BeginWrite() {
   auto w = new WriteThread::Writer();
   write_thread_.EnterUnbatched(w, &mutex_);
+  EnterWalShardsUnbatched();
   return static_cast<void*>(w);
 }
 
 void DBImpl::TEST_EndWrite(void* w) {
   auto writer = static_cast<WriteThread::Writer*>(w);
+  ExitWalShardsUnbatched();
   write_thread_.ExitUnbatched(writer);
   delete writer;
 }
@@ -271,6 +271,39 @@ Status DBImpl::ValidateOptions(const DBOptions& db_options) {
         "atomic_flush is incompatible with enable_pipelined_write");
   }
 
+  if (db_options.enable_pipelined_wal_sync &&
+      (db_options.manual_wal_flush || db_options.allow_mmap_writes)) {
+    return Status::InvalidArgument(
+        "enable_pipelined_wal_sync is incompatible with manual_wal_flush and "
+        "allow_mmap_writes");
+  }
+
+  if (db_options.num_wal_shards == 0) {
+    return Status::InvalidArgument("num_wal_shards must be greater than 0");
+  }
+
+  if (db_options.num_wal_shards > 1) {
+    if (!db_options.allow_concurrent_memtable_write) {
+      return Status::InvalidArgument(
+          "num_wal_shards > 1 is incompatible with "
+          "!allow_concurrent_memtable_write");
+    }
+    if (db_options.enable_pipelined_write || db_options.unordered_write ||
+        db_options.two_write_queues || db_options.allow_2pc) {
+      return Status::InvalidArgument(
+          "num_wal_shards > 1 is incompatible with enable_pipelined_write, "
+          "unordered_write, two_write_queues and allow_2pc");
+    }
+    if (db_options.manual_wal_flush || db_options.allow_mmap_writes ||
+        db_options.recycle_log_file_num > 0 ||
+        db_options.track_and_verify_wals_in_manifest) {
+      return Status::InvalidArgument(
+          "num_wal_shards > 1 is incompatible with manual_wal_flush, "
+          "allow_mmap_writes, recycle_log_file_num and "
+          "track_and_verify_wals_in_manifest");
+    }
+  }
+
   if (db_options.use_direct_io_for_flush_and_compaction &&
       0 == db_options.writable_file_max_buffer_size) {
     return Status::InvalidArgument(
@@ -1135,6 +1168,10 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
 
   bool stop_replay_by_wal_filter = false;
   bool stop_replay_for_corruption = false;
+  bool stop_replay_for_wal_shard_gap = false;
+  // Logs of WAL shards announced by an already replayed primary log.
+  std::unordered_set<uint64_t> wal_shard_log_numbers;
+  bool wal_shards_replayed = false;
   bool flushed = false;
   uint64_t corrupted_wal_number = kMaxSequenceNumber;
   uint64_t min_wal_number = MinLogNumberToKeep();
@@ -1155,6 +1192,10 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
     // records after allocating this log number.  So we manually
     // update the file number allocation counter in VersionSet.
     versions_->MarkFileNumberUsed(wal_number);
+    if (wal_shard_log_numbers.count(wal_number) > 0) {
+      // Replayed together with the primary log of its WAL generation.
+      continue;
+    }
     // Open the log file
     std::string fname =
         LogFileName(immutable_db_options_.GetWalDir(), wal_number);
@@ -1170,7 +1211,7 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
                        static_cast<int>(bytes));
       }
     };
-    if (stop_replay_by_wal_filter) {
+    if (stop_replay_by_wal_filter || stop_replay_for_wal_shard_gap) {
       logFileDropped();
       continue;
     }
@@ -1223,14 +1264,173 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
     const UnorderedMap<uint32_t, size_t>& running_ts_sz =
         versions_->GetRunningColumnFamiliesTimestampSize();
 
+    // If the log is the primary log of a sharded WAL generation, the logs of
+    // the other shards are opened once the primary log announces them, and
+    // the records of all of them are replayed in sequence number order.
+    // Replay stops at the first gap in the sequence numbers, which is where
+    // the unsynced tail of some shard log got lost.
+    struct WalShardHead {
+      std::string fname;
+      LogReporter reporter;
+      std::unique_ptr<log::Reader> shard_reader;
+      log::Reader* reader = nullptr;
+      std::string scratch;
+      Slice record;
+      uint64_t record_checksum = 0;
+      bool valid = false;
+      // The error reading past record, like a torn tail, which only counts
+      // once the records of the other logs before it have been replayed.
+      Status status;
+    };
+    std::vector<std::unique_ptr<WalShardHead>> wal_shard_heads;
+    bool wal_shards_opened = false;
+    SequenceNumber wal_shard_next_sequence = *next_sequence;
+    const log::Reader* record_reader = &reader;
+    uint64_t record_checksum;
+
+    auto read_wal_shard_head = [&](WalShardHead* head) {
+      LogReporter* head_reporter =
+          head->reader == &reader ? &reporter : &head->reporter;
+      Status* head_status = head_reporter->status;
+      if (head_status != nullptr) {
+        head_reporter->status = &head->status;
+      }
+      head->valid = head->reader->ReadRecord(
+          &head->record, &head->scratch,
+          immutable_db_options_.wal_recovery_mode, &head->record_checksum);
+      head_reporter->status = head_status;
+    };
+
+    auto open_wal_shards = [&](bool primary_valid) {
+      auto primary = std::make_unique<WalShardHead>();
+      primary->reader = &reader;
+      primary->valid = primary_valid;
+      if (primary_valid) {
+        primary->scratch.assign(record.data(), record.size());
+        primary->record = Slice(primary->scratch);
+        primary->record_checksum = record_checksum;
+      }
+      wal_shard_heads.push_back(std::move(primary));
+      wal_shards_replayed = true;
+      for (uint64_t shard_log_number : reader.GetWalShardLogNumbers()) {
+        wal_shard_log_numbers.insert(shard_log_number);
+        versions_->MarkFileNumberUsed(shard_log_number);
+        auto head = std::make_unique<WalShardHead>();
+        head->fname =
+            LogFileName(immutable_db_options_.GetWalDir(), shard_log_number);
+        std::unique_ptr<FSSequentialFile> file;
+        Status s = fs_->NewSequentialFile(
+            head->fname, fs_->OptimizeForLogRead(file_options_), &file,
+            nullptr);
+        if (!s.ok()) {
+          // The shard log was never written to.
+          ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                         "Missing WAL shard log #%" PRIu64 " of log #%" PRIu64
+                         ": %s",
+                         shard_log_number, wal_number, s.ToString().c_str());
+          continue;
+        }
+        ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                       "Recovering WAL shard log #%" PRIu64 " of log #%" PRIu64,
+                       shard_log_number, wal_number);
+        head->reporter = reporter;
+        head->reporter.fname = head->fname.c_str();
+        head->shard_reader.reset(new log::Reader(
+            immutable_db_options_.info_log,
+            std::unique_ptr<SequentialFileReader>(new SequentialFileReader(
+                std::move(file), head->fname,
+                immutable_db_options_.log_readahead_size, io_tracer_,
+                /*listeners=*/{}, /*rate_limiter=*/nullptr, is_retry)),
+            &head->reporter, true /*checksum*/, shard_log_number));
+        head->reader = head->shard_reader.get();
+        read_wal_shard_head(head.get());
+        wal_shard_heads.push_back(std::move(head));
+      }
+    };
+
+    auto read_record = [&]() -> bool {
+      if (!wal_shards_opened) {
+        wal_shards_opened = true;
+        bool valid =
+            reader.ReadRecord(&record, &scratch,
+                              immutable_db_options_.wal_recovery_mode,
+                              &record_checksum);
+        if (valid && reader.GetWalShardPrimaryLogNumber() != 0) {
+          // A shard log is replayed through its primary log, so the primary
+          // log of this one is gone. Its records cannot be ordered against
+          // the other shards of the generation.
+          reporter.Corruption(
+              record.size(),
+              Status::Corruption(
+                  "WAL shard log #" + std::to_string(wal_number) +
+                  " without its primary log #" +
+                  std::to_string(reader.GetWalShardPrimaryLogNumber())));
+          return false;
+        }
+        if (reader.GetWalShardLogNumbers().empty()) {
+          return valid;
+        }
+        open_wal_shards(valid);
+      } else if (wal_shard_heads.empty()) {
+        return reader.ReadRecord(&record, &scratch,
+                                 immutable_db_options_.wal_recovery_mode,
+                                 &record_checksum);
+      }
+      WalShardHead* next = nullptr;
+      for (auto& head : wal_shard_heads) {
+        if (head->valid &&
+            (next == nullptr ||
+             (head->record.size() >= WriteBatchInternal::kHeader &&
+              (next->record.size() < WriteBatchInternal::kHeader ||
+               DecodeFixed64(head->record.data()) <
+                   DecodeFixed64(next->record.data()))))) {
+          next = head.get();
+        }
+      }
+      if (next == nullptr) {
+        // Every record before the errors of the logs has been replayed.
+        for (auto& head : wal_shard_heads) {
+          if (!head->status.ok() && status.ok()) {
+            status = head->status;
+          }
+        }
+        return false;
+      }
+      scratch.assign(next->record.data(), next->record.size());
+      record = Slice(scratch);
+      record_checksum = next->record_checksum;
+      record_reader = next->reader;
+      read_wal_shard_head(next);
+      if (record.size() < WriteBatchInternal::kHeader) {
+        return true;
+      }
+      SequenceNumber sequence = DecodeFixed64(record.data());
+      if (wal_shard_next_sequence != kMaxSequenceNumber &&
+          sequence > wal_shard_next_sequence) {
+        Status gap = Status::Corruption(
+            "gap in sharded WAL: expected sequence " +
+            std::to_string(wal_shard_next_sequence) + ", found " +
+            std::to_string(sequence));
+        if (immutable_db_options_.wal_recovery_mode ==
+            WALRecoveryMode::kTolerateCorruptedTailRecords) {
+          // Everything after the gap is part of a torn tail.
+          ROCKS_LOG_WARN(immutable_db_options_.info_log, "%s: %s",
+                         fname.c_str(), gap.ToString().c_str());
+          stop_replay_for_wal_shard_gap = true;
+          stop_replay_for_corruption = true;
+          corrupted_wal_number = wal_number;
+          return false;
+        }
+        reporter.Corruption(record.size(), gap);
+      }
+      wal_shard_next_sequence =
+          sequence + DecodeFixed32(record.data() + sizeof(SequenceNumber));
+      return true;
+    };
+
     TEST_SYNC_POINT_CALLBACK("DBImpl::RecoverLogFiles:BeforeReadWal",
                              /*arg=*/nullptr);
-    uint64_t record_checksum;
-    while (!stop_replay_by_wal_filter &&
-           reader.ReadRecord(&record, &scratch,
-                             immutable_db_options_.wal_recovery_mode,
-                             &record_checksum) &&
-           status.ok()) {
+    while (!stop_replay_by_wal_filter && read_record() && status.ok()) {
       if (record.size() < WriteBatchInternal::kHeader) {
         reporter.Corruption(record.size(),
                             Status::Corruption("log record too small"));
@@ -1247,7 +1447,7 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
       }
 
       const UnorderedMap<uint32_t, size_t>& record_ts_sz =
-          reader.GetRecordedTimestampSize();
+          record_reader->GetRecordedTimestampSize();
       status = HandleWriteBatchTimestampSizeDifference(
           &batch, running_ts_sz, record_ts_sz,
           TimestampSizeConsistencyMode::kReconcileInconsistency, &new_batch);
@@ -1473,7 +1673,11 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
         // If flush happened in the middle of recovery (e.g. due to memtable
         // being full), we flush at the end. Otherwise we'll need to record
         // where we were on last flush, which make the logic complicated.
-        if (flushed || !immutable_db_options_.avoid_flush_during_recovery) {
+        // Reopening a sharded WAL with num_wal_shards = 1 always flushes, so
+        // that no sharded WAL is left behind for an older release to read.
+        if (flushed || !immutable_db_options_.avoid_flush_during_recovery ||
+            (wal_shards_replayed &&
+             immutable_db_options_.num_wal_shards == 1)) {
           status = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
           if (!status.ok()) {
             // Recovery failed
@@ -1960,6 +2164,41 @@ IOStatus DBImpl::CreateWAL(const WriteOptions& write_options,
   return io_s;
 }
 
+IOStatus DBImpl::CreateWalShardLogs(
+    const WriteOptions& write_options, log::Writer* primary_log,
+    const std::vector<uint64_t>& shard_log_numbers,
+    size_t preallocate_block_size, std::vector<log::Writer*>* shard_logs) {
+  assert(shard_logs != nullptr && shard_logs->empty());
+  IOStatus io_s;
+  for (uint64_t log_number : shard_log_numbers) {
+    log::Writer* shard_log = nullptr;
+    io_s = CreateWAL(write_options, log_number, 0 /*recycle_log_number*/,
+                     preallocate_block_size, &shard_log);
+    if (shard_log != nullptr) {
+      shard_logs->push_back(shard_log);
+    }
+    if (io_s.ok()) {
+      io_s = shard_log->AddWalShardOfRecord(write_options,
+                                            primary_log->get_log_number());
+    }
+    if (!io_s.ok()) {
+      break;
+    }
+  }
+  if (io_s.ok()) {
+    // Announce the shard logs only once they all exist. Recovery treats a
+    // missing shard log as empty.
+    io_s = primary_log->AddWalShardsRecord(write_options, shard_log_numbers);
+  }
+  if (!io_s.ok()) {
+    for (log::Writer* shard_log : *shard_logs) {
+      delete shard_log;
+    }
+    shard_logs->clear();
+  }
+  return io_s;
+}
+
 void DBImpl::TrackExistingDataFiles(
     const std::vector<std::string>& existing_data_files) {
   auto sfm = static_cast<SstFileManagerImpl*>(
@@ -2090,6 +2329,20 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
         impl->GetWalPreallocateBlockSize(max_write_buffer_size);
     s = impl->CreateWAL(write_options, new_log_number, 0 /*recycle_log_number*/,
                         preallocate_block_size, &new_log);
+    std::vector<log::Writer*> wal_shard_logs;
+    if (s.ok() && !impl->wal_shards_.empty()) {
+      std::vector<uint64_t> wal_shard_log_numbers;
+      for (size_t i = 1; i < impl->wal_shards_.size(); ++i) {
+        wal_shard_log_numbers.push_back(impl->versions_->NewFileNumber());
+      }
+      s = impl->CreateWalShardLogs(write_options, new_log,
+                                   wal_shard_log_numbers,
+                                   preallocate_block_size, &wal_shard_logs);
+      if (!s.ok()) {
+        delete new_log;
+        new_log = nullptr;
+      }
+    }
     if (s.ok()) {
       // Prevent log files created by previous instance from being recycled.
       // They might be in alive_log_file_, and might get recycled otherwise.
@@ -2105,6 +2358,10 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
 
     if (s.ok()) {
       impl->alive_log_files_.emplace_back(impl->logfile_number_);
+      if (!impl->wal_shards_.empty()) {
+        InstrumentedMutexLock wl(&impl->log_write_mutex_);
+        impl->InstallWalShardLogs(new_log, wal_shard_logs);
+      }
       // In WritePrepared there could be gap in sequence numbers. This breaks
       // the trick we use in kPointInTimeRecovery which assumes the first seq in
       // the log right after the corrupted log is one larger than the last seq
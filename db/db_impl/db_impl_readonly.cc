@@ -10,6 +10,7 @@
 #include "db/db_impl/db_impl.h"
 #include "db/db_iter.h"
 #include "db/merge_context.h"
+#include "db/wide/wide_columns_helper.h"
 #include "logging/logging.h"
 #include "monitoring/perf_context_imp.h"
 #include "util/cast_util.h"
@@ -121,6 +122,10 @@ Status DBImplReadOnly::GetImpl(const ReadOptions& read_options,
     if (get_impl_options.value) {
       size = get_impl_options.value->size();
     } else if (get_impl_options.columns) {
+      if (s.ok() && read_options.column_projection) {
+        s = WideColumnsHelper::ProjectColumns(*read_options.column_projection,
+                                              get_impl_options.columns);
+      }
       size = get_impl_options.columns->serialized_size();
     }
     RecordTick(stats_, BYTES_READ, size);
@@ -9,6 +9,7 @@
 
 #include "db/arena_wrapped_db_iter.h"
 #include "db/merge_context.h"
+#include "db/wide/wide_columns_helper.h"
 #include "logging/auto_roll_logger.h"
 #include "logging/logging.h"
 #include "monitoring/perf_context_imp.h"
@@ -452,6 +453,10 @@ Status DBImplSecondary::GetImpl(const ReadOptions& read_options,
     if (get_impl_options.value) {
       size = get_impl_options.value->size();
     } else if (get_impl_options.columns) {
+      if (s.ok() && read_options.column_projection) {
+        s = WideColumnsHelper::ProjectColumns(*read_options.column_projection,
+                                              get_impl_options.columns);
+      }
       size = get_impl_options.columns->serialized_size();
     }
     RecordTick(stats_, BYTES_READ, size);
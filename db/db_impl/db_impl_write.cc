@@ -6,7 +6,9 @@
 // Copyright (c) 2011 The LevelDB Authors. All rights reserved.
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
+#include <algorithm>
 #include <cinttypes>
+#include <limits>
 
 #include "db/db_impl/db_impl.h"
 #include "db/error_handler.h"
@@ -16,6 +18,7 @@
 #include "options/options_helper.h"
 #include "test_util/sync_point.h"
 #include "util/cast_util.h"
+#include "util/random.h"
 
 namespace ROCKSDB_NAMESPACE {
 // Convenience methods
@@ -275,6 +278,27 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     }
   }
 
+  if (UNLIKELY(!disable_memtable && write_controller_.HasScopedStalls())) {
+    Status s = DelayWriteForScopedStalls(write_options, my_batch);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  if (!wal_shards_.empty()) {
+    if (write_options.disableWAL) {
+      return Status::NotSupported(
+          "WriteOptions::disableWAL is not supported with num_wal_shards > 1");
+    }
+    if (disable_memtable || log_ref != 0 || batch_cnt != 0 ||
+        pre_release_callback != nullptr || post_memtable_callback != nullptr) {
+      return Status::NotSupported(
+          "num_wal_shards > 1 only supports plain writes to the memtable");
+    }
+    return WalShardWriteImpl(write_options, my_batch, callback, log_used,
+                             seq_used);
+  }
+
   if (two_write_queues_ && disable_memtable) {
     AssignOrder assign_order =
         seq_per_batch_ ? kDoAssignOrder : kDontAssignOrder;
@@ -692,7 +716,10 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
     if (w.callback && !w.callback->AllowWriteBatching()) {
       write_thread_.WaitForMemTableWriters();
     }
-    LogContext log_context(!write_options.disableWAL && write_options.sync);
+    // With enable_pipelined_wal_sync the WAL is synced by the memtable writer
+    // queue, see MaybeSyncWALForMemTableWriters().
+    LogContext log_context(!write_options.disableWAL && write_options.sync &&
+                           !immutable_db_options_.enable_pipelined_wal_sync);
     // PreprocessWrite does its own perf timing.
     PERF_TIMER_STOP(write_pre_and_post_process_time);
     w.status = PreprocessWrite(write_options, &log_context, &write_context);
@@ -767,6 +794,12 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
                      log_context.need_log_sync, log_context.need_log_dir_sync,
                      current_sequence, log_file_number_size);
       w.status = io_s;
+      if (io_s.ok() && immutable_db_options_.enable_pipelined_wal_sync) {
+        last_wal_appended_sequence_.store(current_sequence + total_count - 1,
+                                          std::memory_order_release);
+        TEST_SYNC_POINT_CALLBACK("DBImpl::PipelinedWriteImpl:AfterWALAppend",
+                                 &total_count);
+      }
     }
 
     if (!io_s.ok()) {
@@ -792,6 +825,19 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
       const ReadOptions read_options;
       w.status = ApplyWALToManifest(read_options, write_options, &synced_wals);
     }
+    if (w.status.ok() && write_options.sync && !write_options.disableWAL &&
+        immutable_db_options_.enable_pipelined_wal_sync) {
+      // Writers that skip the memtable never reach the memtable writer queue,
+      // so their WAL has to be synced here.
+      for (auto* writer : wal_write_group) {
+        if (!writer->CallbackFailed() && !writer->ShouldWriteToMemtable()) {
+          StopWatch sw(immutable_db_options_.clock, stats_,
+                       WAL_FILE_SYNC_MICROS);
+          w.status = SyncWAL();
+          break;
+        }
+      }
+    }
     write_thread_.ExitAsBatchGroupLeader(wal_write_group, w.status);
   }
 
@@ -805,8 +851,18 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
     PERF_TIMER_FOR_WAIT_GUARD(write_memtable_time);
     assert(w.ShouldWriteToMemtable());
     write_thread_.EnterAsMemTableWriter(&w, &memtable_write_group);
-    if (memtable_write_group.size > 1 &&
-        immutable_db_options_.allow_concurrent_memtable_write) {
+    if (immutable_db_options_.enable_pipelined_wal_sync) {
+      memtable_write_group.status =
+          MaybeSyncWALForMemTableWriters(memtable_write_group);
+    }
+    if (!memtable_write_group.status.ok()) {
+      // The WAL of the group may not be durable, so it must not become
+      // visible. Like a failed WAL sync of a non-pipelined write, this stops
+      // further writes.
+      WriteStatusCheck(memtable_write_group.status);
+      write_thread_.ExitAsMemTableWriter(&w, memtable_write_group);
+    } else if (memtable_write_group.size > 1 &&
+               immutable_db_options_.allow_concurrent_memtable_write) {
       write_thread_.LaunchParallelMemTableWriters(&memtable_write_group);
     } else {
       memtable_write_group.status = WriteBatchInternal::InsertInto(
@@ -854,6 +910,52 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
   return w.FinalStatus();
 }
 
+Status DBImpl::MaybeSyncWALForMemTableWriters(
+    const WriteThread::WriteGroup& memtable_write_group) {
+  // The group can also hold disableWAL writers, whose sequence numbers were
+  // never appended to the WAL, so only the sync writers decide how far the
+  // WAL has to be synced.
+  bool need_log_sync = false;
+  SequenceNumber required_sequence = 0;
+  for (auto* writer : memtable_write_group) {
+    if (writer->sync && !writer->CallbackFailed()) {
+      assert(!writer->disable_wal);
+      need_log_sync = true;
+      required_sequence = std::max(
+          required_sequence,
+          writer->sequence + WriteBatchInternal::Count(writer->batch) - 1);
+    }
+  }
+  if (!need_log_sync ||
+      last_wal_synced_sequence_.load(std::memory_order_acquire) >=
+          required_sequence) {
+    return Status::OK();
+  }
+  // Everything appended so far is covered by the sync, including groups that
+  // are still waiting in the memtable writer queue behind this one.
+  const SequenceNumber synced_sequence =
+      last_wal_appended_sequence_.load(std::memory_order_acquire);
+  assert(synced_sequence >= required_sequence);
+  Status s;
+  {
+    PERF_TIMER_GUARD(write_wal_time);
+    StopWatch sw(immutable_db_options_.clock, stats_, WAL_FILE_SYNC_MICROS);
+    s = SyncWAL();
+  }
+  if (s.ok()) {
+    default_cf_internal_stats_->AddDBStats(
+        InternalStats::kIntStatsWalFileSynced, 1, true /* concurrent */);
+    SequenceNumber prev_synced_sequence =
+        last_wal_synced_sequence_.load(std::memory_order_relaxed);
+    while (prev_synced_sequence < synced_sequence &&
+           !last_wal_synced_sequence_.compare_exchange_weak(
+               prev_synced_sequence, synced_sequence,
+               std::memory_order_acq_rel)) {
+    }
+  }
+  return s;
+}
+
 Status DBImpl::UnorderedWriteMemtable(const WriteOptions& write_options,
                                       WriteBatch* my_batch,
                                       WriteCallback* callback, uint64_t log_ref,
@@ -1121,6 +1223,374 @@ Status DBImpl::WriteImplWALOnly(
   return status;
 }
 
+Status DBImpl::WalShardWriteImpl(const WriteOptions& write_options,
+                                 WriteBatch* my_batch, WriteCallback* callback,
+                                 uint64_t* log_used, uint64_t* seq_used) {
+  assert(!wal_shards_.empty());
+  PERF_TIMER_GUARD(write_pre_and_post_process_time);
+  WriteThread::Writer w(write_options, my_batch, callback, /*_log_ref=*/0,
+                        /*_disable_memtable=*/false);
+  StopWatch write_sw(immutable_db_options_.clock, stats_, DB_WRITE);
+
+  Status status;
+  // A write with a callback is applied while no other write is in progress,
+  // since the callback may depend on the writes with lower sequence numbers
+  // having been applied.
+  if (UNLIKELY(callback != nullptr || WalShardWriteNeedsPreprocess())) {
+    WriteThread::WriteGroup write_group;
+    if (callback != nullptr) {
+      write_group.leader = &w;
+      write_group.last_writer = &w;
+      write_group.size = 1;
+    }
+    PERF_TIMER_STOP(write_pre_and_post_process_time);
+    status = PreprocessWalShardWrite(
+        write_options, callback != nullptr ? &write_group : nullptr);
+    PERF_TIMER_START(write_pre_and_post_process_time);
+    if (!status.ok() || callback != nullptr) {
+      if (status.ok()) {
+        if (log_used != nullptr) {
+          *log_used = w.log_used;
+        }
+        if (seq_used != nullptr) {
+          *seq_used = w.sequence;
+        }
+        status = w.FinalStatus();
+      }
+      return status;
+    }
+  }
+
+  // Spread the writers over the shards by the core they run on, so that the
+  // writers of one core mostly batch together.
+  const size_t num_shards = wal_shards_.size();
+  int core_id = port::PhysicalCoreID();
+  size_t shard_index =
+      core_id >= 0
+          ? static_cast<size_t>(core_id) % num_shards
+          : Random::GetTLSInstance()->Uniform(static_cast<int>(num_shards));
+  TEST_SYNC_POINT_CALLBACK("DBImpl::WriteImpl:WalShardIndex", &shard_index);
+  WalShard* shard = wal_shards_[shard_index].get();
+
+  shard->write_thread.JoinBatchGroup(&w);
+  if (w.state == WriteThread::STATE_COMPLETED) {
+    if (log_used != nullptr) {
+      *log_used = w.log_used;
+    }
+    if (seq_used != nullptr) {
+      *seq_used = w.sequence;
+    }
+    return w.FinalStatus();
+  }
+  assert(w.state == WriteThread::STATE_GROUP_LEADER);
+  WriteThread::WriteGroup write_group;
+  shard->write_thread.EnterAsBatchGroupLeader(&w, &write_group);
+  PERF_TIMER_STOP(write_pre_and_post_process_time);
+  status = WriteWalShardGroup(shard, write_group, write_options);
+  PERF_TIMER_START(write_pre_and_post_process_time);
+  shard->write_thread.ExitAsBatchGroupLeader(write_group, status);
+
+  if (log_used != nullptr) {
+    *log_used = w.log_used;
+  }
+  if (seq_used != nullptr) {
+    *seq_used = w.sequence;
+  }
+  if (status.ok()) {
+    status = w.FinalStatus();
+  }
+  return status;
+}
+
+Status DBImpl::WriteWalShardGroup(WalShard* shard,
+                                  WriteThread::WriteGroup& write_group,
+                                  const WriteOptions& write_options) {
+  assert(shard->log_writer != nullptr);
+  const bool need_log_sync = write_options.sync;
+  size_t total_count = 0;
+  size_t total_byte_size = 0;
+  for (auto* writer : write_group) {
+    assert(writer);
+    if (writer->CheckCallback(this)) {
+      total_count += WriteBatchInternal::Count(writer->batch);
+      total_byte_size = WriteBatchInternal::AppendedByteSize(
+          total_byte_size, WriteBatchInternal::ByteSize(writer->batch));
+    }
+  }
+  if (tracer_) {
+    InstrumentedMutexLock lock(&trace_mutex_);
+    if (tracer_ && tracer_->IsWriteOrderPreserved()) {
+      for (auto* writer : write_group) {
+        if (writer->CallbackFailed()) {
+          continue;
+        }
+        tracer_->Write(writer->batch).PermitUncheckedError();
+      }
+    }
+  }
+
+  auto stats = default_cf_internal_stats_;
+  stats->AddDBStats(InternalStats::kIntStatsNumKeysWritten, total_count,
+                    true /* concurrent */);
+  RecordTick(stats_, NUMBER_KEYS_WRITTEN, total_count);
+  stats->AddDBStats(InternalStats::kIntStatsBytesWritten, total_byte_size,
+                    true /* concurrent */);
+  RecordTick(stats_, BYTES_WRITTEN, total_byte_size);
+  stats->AddDBStats(InternalStats::kIntStatsWriteDoneBySelf, 1,
+                    true /* concurrent */);
+  RecordTick(stats_, WRITE_DONE_BY_SELF);
+  auto write_done_by_other = write_group.size - 1;
+  if (write_done_by_other > 0) {
+    stats->AddDBStats(InternalStats::kIntStatsWriteDoneByOther,
+                      write_done_by_other, true /* concurrent */);
+    RecordTick(stats_, WRITE_DONE_BY_OTHER, write_done_by_other);
+  }
+  RecordInHistogram(stats_, BYTES_PER_WRITE, total_byte_size);
+
+  // The sequence numbers are allocated before the group is appended to the
+  // log of the shard, so the logs of the shards may hold them out of order;
+  // recovery merges the logs by sequence number.
+  const SequenceNumber prev_last_sequence =
+      versions_->FetchAddLastAllocatedSequence(total_count);
+  const SequenceNumber current_sequence = prev_last_sequence + 1;
+  const SequenceNumber last_sequence = prev_last_sequence + total_count;
+
+  IOStatus io_s;
+  size_t write_with_wal = 0;
+  {
+    PERF_TIMER_GUARD(write_wal_time);
+    WriteBatch tmp_batch;
+    WriteBatch* to_be_cached_state = nullptr;
+    WriteBatch* merged_batch = nullptr;
+    io_s = status_to_io_status(MergeBatch(write_group, &tmp_batch,
+                                          &merged_batch, &write_with_wal,
+                                          &to_be_cached_state));
+    assert(to_be_cached_state == nullptr);
+    if (io_s.ok() && write_with_wal > 0) {
+      WriteBatchInternal::SetSequence(merged_batch, current_sequence);
+      // See WriteToWAL() for the values added with WriteBatch::PutPinned().
+      std::vector<Slice> log_entry_parts;
+      WriteBatchInternal::GetContentsParts(merged_batch, &log_entry_parts);
+      const size_t log_entry_size = WriteBatchInternal::ByteSize(merged_batch);
+      io_s = status_to_io_status(merged_batch->VerifyChecksum());
+      WriteOptions wal_write_options;
+      wal_write_options.rate_limiter_priority =
+          write_group.leader->rate_limiter_priority;
+      if (io_s.ok()) {
+        io_s = shard->log_writer->MaybeAddUserDefinedTimestampSizeRecord(
+            wal_write_options,
+            versions_->GetColumnFamiliesTimestampSizeForRecord());
+      }
+      if (io_s.ok()) {
+        io_s = shard->log_writer->AddRecord(
+            wal_write_options,
+            SliceParts(log_entry_parts.data(),
+                       static_cast<int>(log_entry_parts.size())));
+      }
+      if (io_s.ok()) {
+        total_log_size_ += log_entry_size;
+        shard->log_file_number_size->AddSize(log_entry_size);
+        shard->log_empty = false;
+        stats->AddDBStats(InternalStats::kIntStatsWalFileBytes,
+                          log_entry_size, true /* concurrent */);
+        RecordTick(stats_, WAL_FILE_BYTES, log_entry_size);
+        stats->AddDBStats(InternalStats::kIntStatsWriteWithWal,
+                          write_with_wal, true /* concurrent */);
+        RecordTick(stats_, WRITE_WITH_WAL, write_with_wal);
+      }
+    }
+  }
+  if (!io_s.ok()) {
+    if (shard == wal_shards_[0].get()) {
+      IOStatusCheck(io_s);
+    } else if ((immutable_db_options_.paranoid_checks && !io_s.IsBusy() &&
+                !io_s.IsIncomplete()) ||
+               io_s.IsIOFenced()) {
+      InstrumentedMutexLock l(&mutex_);
+      error_handler_.SetBGError(io_s, BackgroundErrorReason::kWriteCallback);
+    } else {
+      shard->log_writer->file()->reset_seen_error();
+    }
+  }
+  Status status = io_s;
+
+  // A synced group must not become visible before it is durable. Syncing
+  // waits for all lower sequence numbers to be in the logs, which is the case
+  // once they are published.
+  if (status.ok() && need_log_sync) {
+    WaitForWalShardPublishTurn(prev_last_sequence);
+    if (error_handler_.IsDBStopped()) {
+      // A lower sequence number may have failed to reach its log.
+      InstrumentedMutexLock l(&mutex_);
+      status = error_handler_.GetBGError();
+    }
+    if (status.ok()) {
+      StopWatch sw(immutable_db_options_.clock, stats_, WAL_FILE_SYNC_MICROS);
+      status = SyncWAL();
+    }
+    if (status.ok()) {
+      stats->AddDBStats(InternalStats::kIntStatsWalFileSynced, 1,
+                        true /* concurrent */);
+    }
+  }
+
+  if (status.ok()) {
+    PERF_TIMER_FOR_WAIT_GUARD(write_memtable_time);
+    ColumnFamilyMemTablesImpl column_family_memtables(
+        versions_->GetColumnFamilySet());
+    SequenceNumber next_sequence = current_sequence;
+    for (auto* writer : write_group) {
+      if (writer->CallbackFailed()) {
+        continue;
+      }
+      writer->sequence = next_sequence;
+      writer->log_used = shard->primary_log_number;
+      next_sequence += WriteBatchInternal::Count(writer->batch);
+      writer->status = WriteBatchInternal::InsertInto(
+          writer, writer->sequence, &column_family_memtables,
+          &flush_scheduler_, &trim_history_scheduler_,
+          write_options.ignore_missing_column_families, 0 /*log_number*/, this,
+          true /*concurrent_memtable_writes*/, seq_per_batch_,
+          writer->batch_cnt, batch_per_txn_,
+          write_options.memtable_insert_hint_per_batch);
+      if (!writer->status.ok() && write_group.status.ok()) {
+        write_group.status = writer->status;
+      }
+    }
+    assert(next_sequence == last_sequence + 1);
+  }
+
+  // The allocated range is published even if the write failed, otherwise the
+  // writers of the other shards would wait for it forever.
+  if (!(status.ok() && need_log_sync)) {
+    WaitForWalShardPublishTurn(prev_last_sequence);
+  }
+  PublishWalShardSequence(last_sequence);
+  MemTableInsertStatusCheck(write_group.status);
+  return status;
+}
+
+bool DBImpl::WalShardWriteNeedsPreprocess() {
+  return error_handler_.IsDBStopped() ||
+         (total_log_size_ > GetMaxTotalWalSize() &&
+          !wal_shard_log_oversized_.load(std::memory_order_relaxed)) ||
+         write_buffer_manager_->ShouldFlush() ||
+         !trim_history_scheduler_.Empty() || !flush_scheduler_.Empty() ||
+         write_controller_.IsStopped() || write_controller_.NeedsDelay() ||
+         write_buffer_manager_->ShouldStall();
+}
+
+Status DBImpl::PreprocessWalShardWrite(const WriteOptions& write_options,
+                                       WriteThread::WriteGroup* write_group) {
+  WriteContext write_context;
+  Status status;
+  {
+    InstrumentedMutexLock l(&mutex_);
+    WriteThread::Writer w;
+    write_thread_.EnterUnbatched(&w, &mutex_);
+    EnterWalShardsUnbatched();
+    mutex_.Unlock();
+
+    if (write_group != nullptr) {
+      last_batch_group_size_ =
+          WriteBatchInternal::ByteSize(write_group->leader->batch);
+    }
+    LogContext log_context;
+    status = PreprocessWrite(write_options, &log_context, &write_context);
+    if (total_log_size_ > GetMaxTotalWalSize()) {
+      wal_shard_log_oversized_.store(true, std::memory_order_relaxed);
+    }
+    if (status.ok() && write_group != nullptr) {
+      status = WriteWalShardGroup(wal_shards_[0].get(), *write_group,
+                                  write_options);
+    }
+
+    mutex_.Lock();
+    ExitWalShardsUnbatched();
+    write_thread_.ExitUnbatched(&w);
+  }
+  return status;
+}
+
+void DBImpl::WaitForWalShardPublishTurn(SequenceNumber prev_last_sequence) {
+  InstrumentedMutexLock l(&wal_shard_publish_mutex_);
+  while (versions_->LastSequence() != prev_last_sequence) {
+    wal_shard_publish_cv_.Wait();
+  }
+}
+
+void DBImpl::PublishWalShardSequence(SequenceNumber last_sequence) {
+  InstrumentedMutexLock l(&wal_shard_publish_mutex_);
+  versions_->SetLastSequence(last_sequence);
+  wal_shard_publish_cv_.SignalAll();
+}
+
+void DBImpl::EnterWalShardsUnbatched() {
+  mutex_.AssertHeld();
+  for (auto& shard : wal_shards_) {
+    assert(!shard->unbatched_writer);
+    shard->unbatched_writer.reset(new WriteThread::Writer());
+    shard->write_thread.EnterUnbatched(shard->unbatched_writer.get(), &mutex_);
+  }
+}
+
+void DBImpl::ExitWalShardsUnbatched() {
+  for (auto it = wal_shards_.rbegin(); it != wal_shards_.rend(); ++it) {
+    WalShard* shard = it->get();
+    assert(shard->unbatched_writer);
+    shard->write_thread.ExitUnbatched(shard->unbatched_writer.get());
+    shard->unbatched_writer.reset();
+  }
+}
+
+void DBImpl::InstallWalShardLogs(log::Writer* primary_log,
+                                 const std::vector<log::Writer*>& shard_logs) {
+  mutex_.AssertHeld();
+  log_write_mutex_.AssertHeld();
+  assert(shard_logs.size() + 1 == wal_shards_.size());
+  assert(logs_.back().writer == primary_log);
+  WalShard* primary = wal_shards_[0].get();
+  primary->log_writer = primary_log;
+  primary->log_file_number_size = std::addressof(alive_log_files_.back());
+  primary->primary_log_number = primary_log->get_log_number();
+  primary->log_empty = true;
+  for (size_t i = 1; i < wal_shards_.size(); ++i) {
+    WalShard* shard = wal_shards_[i].get();
+    assert(shard->log_writer == nullptr);
+    shard->log_writer = shard_logs[i - 1];
+    shard->log_file = LogFileNumberSize(shard->log_writer->get_log_number());
+    shard->log_file_number_size = std::addressof(shard->log_file);
+    shard->primary_log_number = primary->primary_log_number;
+    shard->log_empty = true;
+  }
+}
+
+void DBImpl::RetireWalShardLogs() {
+  mutex_.AssertHeld();
+  log_write_mutex_.AssertHeld();
+  while (wal_shard_syncs_in_progress_ > 0) {
+    log_sync_cv_.Wait();
+  }
+  for (size_t i = 1; i < wal_shards_.size(); ++i) {
+    WalShard* shard = wal_shards_[i].get();
+    assert(shard->log_writer != nullptr);
+    assert(logs_.empty() || logs_.back().number < shard->log_file.number);
+    logs_.emplace_back(shard->log_file.number, shard->log_writer);
+    alive_log_files_.push_back(shard->log_file);
+    shard->log_writer = nullptr;
+    shard->log_file_number_size = nullptr;
+  }
+}
+
+bool DBImpl::WalShardLogsEmpty() const {
+  for (const auto& shard : wal_shards_) {
+    if (!shard->log_empty) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void DBImpl::WriteStatusCheckOnLocked(const Status& status) {
   // Is setting bg_error_ enough here?  This will at least stop
   // compaction and fail any further writes.
@@ -1345,13 +1815,22 @@ IOStatus DBImpl::WriteToWAL(const WriteBatch& merged_batch,
                             LogFileNumberSize& log_file_number_size) {
   assert(log_size != nullptr);
 
-  Slice log_entry = WriteBatchInternal::Contents(&merged_batch);
-  TEST_SYNC_POINT_CALLBACK("DBImpl::WriteToWAL:log_entry", &log_entry);
+  // The values added with WriteBatch::PutPinned() go from the caller's
+  // buffers straight into the log.
+  std::vector<Slice> log_entry_parts;
+  Slice log_entry;
+  if (WriteBatchInternal::HasPinnedValues(&merged_batch)) {
+    WriteBatchInternal::GetContentsParts(&merged_batch, &log_entry_parts);
+    *log_size = WriteBatchInternal::ByteSize(&merged_batch);
+  } else {
+    log_entry = WriteBatchInternal::Contents(&merged_batch);
+    TEST_SYNC_POINT_CALLBACK("DBImpl::WriteToWAL:log_entry", &log_entry);
+    *log_size = log_entry.size();
+  }
   auto s = merged_batch.VerifyChecksum();
   if (!s.ok()) {
     return status_to_io_status(std::move(s));
   }
-  *log_size = log_entry.size();
   // When two_write_queues_ WriteToWAL has to be protected from concurretn calls
   // from the two queues anyway and log_write_mutex_ is already held. Otherwise
   // if manual_wal_flush_ is enabled we need to protect log_writer->AddRecord
@@ -1368,7 +1847,13 @@ IOStatus DBImpl::WriteToWAL(const WriteBatch& merged_batch,
   if (!io_s.ok()) {
     return io_s;
   }
-  io_s = log_writer->AddRecord(write_options, log_entry);
+  if (log_entry_parts.empty()) {
+    io_s = log_writer->AddRecord(write_options, log_entry);
+  } else {
+    io_s = log_writer->AddRecord(
+        write_options, SliceParts(log_entry_parts.data(),
+                                  static_cast<int>(log_entry_parts.size())));
+  }
 
   if (UNLIKELY(needs_locking)) {
     log_write_mutex_.Unlock();
@@ -1376,7 +1861,7 @@ IOStatus DBImpl::WriteToWAL(const WriteBatch& merged_batch,
   if (log_used != nullptr) {
     *log_used = logfile_number_;
   }
-  total_log_size_ += log_entry.size();
+  total_log_size_ += *log_size;
   log_file_number_size.AddSize(*log_size);
   log_empty_ = false;
   return io_s;
@@ -1961,6 +2446,171 @@ Status DBImpl::DelayWrite(uint64_t num_bytes, WriteThread& write_thread,
   return s;
 }
 
+namespace {
+// Collects the column families of a write batch that may stall writes to
+// themselves only, going by WriteController::MayHaveScopedStall(), which
+// does not need the DB mutex.
+class ScopedStallCollector : public WriteBatch::Handler {
+ public:
+  ScopedStallCollector(const WriteController* write_controller,
+                       std::vector<uint32_t>* column_family_ids)
+      : write_controller_(write_controller),
+        column_family_ids_(column_family_ids) {}
+
+  Status PutCF(uint32_t column_family_id, const Slice&, const Slice&) override {
+    return Add(column_family_id);
+  }
+
+  Status TimedPutCF(uint32_t column_family_id, const Slice&, const Slice&,
+                    uint64_t) override {
+    return Add(column_family_id);
+  }
+
+  Status PutEntityCF(uint32_t column_family_id, const Slice&,
+                     const Slice&) override {
+    return Add(column_family_id);
+  }
+
+  Status DeleteCF(uint32_t column_family_id, const Slice&) override {
+    return Add(column_family_id);
+  }
+
+  Status SingleDeleteCF(uint32_t column_family_id, const Slice&) override {
+    return Add(column_family_id);
+  }
+
+  Status DeleteRangeCF(uint32_t column_family_id, const Slice&,
+                       const Slice&) override {
+    return Add(column_family_id);
+  }
+
+  Status MergeCF(uint32_t column_family_id, const Slice&,
+                 const Slice&) override {
+    return Add(column_family_id);
+  }
+
+  Status PutBlobIndexCF(uint32_t column_family_id, const Slice&,
+                        const Slice&) override {
+    return Add(column_family_id);
+  }
+
+  Status MarkBeginPrepare(bool) override { return Status::OK(); }
+
+  Status MarkEndPrepare(const Slice&) override { return Status::OK(); }
+
+  Status MarkRollback(const Slice&) override { return Status::OK(); }
+
+  Status MarkCommit(const Slice&) override { return Status::OK(); }
+
+  Status MarkCommitWithTimestamp(const Slice&, const Slice&) override {
+    return Status::OK();
+  }
+
+  Status MarkNoop(bool) override { return Status::OK(); }
+
+ private:
+  Status Add(uint32_t column_family_id) {
+    if (column_family_id != last_column_family_id_) {
+      last_column_family_id_ = column_family_id;
+      if (write_controller_->MayHaveScopedStall(column_family_id) &&
+          std::find(column_family_ids_->begin(), column_family_ids_->end(),
+                    column_family_id) == column_family_ids_->end()) {
+        column_family_ids_->push_back(column_family_id);
+      }
+    }
+    return Status::OK();
+  }
+
+  const WriteController* const write_controller_;
+  std::vector<uint32_t>* const column_family_ids_;
+  // Consecutive entries mostly share their column family.
+  uint32_t last_column_family_id_ = std::numeric_limits<uint32_t>::max();
+};
+}  // namespace
+
+Status DBImpl::DelayWriteForScopedStalls(const WriteOptions& write_options,
+                                         WriteBatch* my_batch) {
+  // Only batches that touch a possibly stalled column family take the DB
+  // mutex.
+  std::vector<uint32_t> column_family_ids;
+  ScopedStallCollector collector(&write_controller_, &column_family_ids);
+  if (!my_batch->Iterate(&collector).ok()) {
+    // A corrupted batch is rejected by the write itself.
+    return Status::OK();
+  }
+  if (column_family_ids.empty()) {
+    return Status::OK();
+  }
+  TEST_SYNC_POINT("DBImpl::DelayWriteForScopedStalls:CheckColumnFamilies");
+  PERF_TIMER_FOR_WAIT_GUARD(write_delay_time);
+  SystemClock* clock = immutable_db_options_.clock;
+  const uint64_t num_bytes = WriteBatchInternal::ByteSize(my_batch);
+
+  InstrumentedMutexLock l(&mutex_);
+  for (uint32_t column_family_id : column_family_ids) {
+    ColumnFamilyData* cfd =
+        versions_->GetColumnFamilySet()->GetColumnFamily(column_family_id);
+    if (cfd == nullptr || cfd->IsDropped()) {
+      continue;
+    }
+    WriteController* write_controller = cfd->scoped_write_controller();
+    if (write_controller == nullptr ||
+        (!write_controller->IsStopped() && !write_controller->NeedsDelay())) {
+      continue;
+    }
+    if (write_options.no_slowdown) {
+      return Status::Incomplete("Write stall");
+    }
+    // Keeps the column family, and with it write_controller, alive while
+    // the mutex is released.
+    cfd->Ref();
+    const uint64_t start_time = clock->NowMicros();
+    bool delayed = false;
+    const uint64_t delay = write_controller->GetDelay(clock, num_bytes);
+    if (delay > 0) {
+      TEST_SYNC_POINT("DBImpl::DelayWriteForScopedStalls:Sleep");
+      mutex_.Unlock();
+      // Same polling as DelayWrite().
+      const uint64_t kDelayInterval = 1001;
+      const uint64_t stall_end = start_time + delay;
+      while (write_controller->NeedsDelay() &&
+             clock->NowMicros() < stall_end) {
+        delayed = true;
+        clock->SleepForMicroseconds(kDelayInterval);
+      }
+      mutex_.Lock();
+    }
+    while ((error_handler_.GetBGError().ok() ||
+            error_handler_.IsRecoveryInProgress()) &&
+           write_controller->IsStopped() && !cfd->IsDropped() &&
+           !shutting_down_.load(std::memory_order_relaxed)) {
+      delayed = true;
+      TEST_SYNC_POINT("DBImpl::DelayWriteForScopedStalls:Wait");
+      bg_cv_.Wait();
+    }
+    const bool still_stopped =
+        write_controller->IsStopped() && !cfd->IsDropped();
+    if (delayed) {
+      const uint64_t time_delayed = clock->NowMicros() - start_time;
+      cfd->internal_stats()->AddCFStats(
+          InternalStats::SCOPED_WRITE_STALL_MICROS, time_delayed);
+      default_cf_internal_stats_->AddDBStats(
+          InternalStats::kIntStatsWriteStallMicros, time_delayed);
+      RecordTick(stats_, STALL_MICROS, time_delayed);
+      RecordInHistogram(stats_, WRITE_STALL, time_delayed);
+    }
+    cfd->UnrefAndTryDelete();
+    if (still_stopped) {
+      if (shutting_down_.load(std::memory_order_relaxed)) {
+        return Status::ShutdownInProgress("stalled writes");
+      }
+      // We bailed out because of a background error
+      return Status::Incomplete(error_handler_.GetBGError().ToString());
+    }
+  }
+  return Status::OK();
+}
+
 // REQUIRES: mutex_ is held
 // REQUIRES: this thread is currently at the front of the writer queue
 void DBImpl::WriteBufferManagerStallWrites() {
@@ -2173,7 +2823,7 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
   if (two_write_queues_) {
     log_write_mutex_.Lock();
   }
-  bool creating_new_log = !log_empty_;
+  bool creating_new_log = !log_empty_ || !WalShardLogsEmpty();
   if (two_write_queues_) {
     log_write_mutex_.Unlock();
   }
@@ -2186,6 +2836,14 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
   }
   uint64_t new_log_number =
       creating_new_log ? versions_->NewFileNumber() : logfile_number_;
+  // The logs of the other WAL shards are numbered right after the primary one.
+  std::vector<uint64_t> new_wal_shard_log_numbers;
+  std::vector<log::Writer*> new_wal_shard_logs;
+  if (creating_new_log) {
+    for (size_t i = 1; i < wal_shards_.size(); ++i) {
+      new_wal_shard_log_numbers.push_back(versions_->NewFileNumber());
+    }
+  }
   const MutableCFOptions mutable_cf_options = *cfd->GetLatestMutableCFOptions();
 
   // Set memtable_info for memtable sealed callback
@@ -2206,6 +2864,11 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
     // of mutable_cf_options.write_buffer_size.
     io_s = CreateWAL(write_options, new_log_number, recycle_log_number,
                      preallocate_block_size, &new_log);
+    if (io_s.ok() && !new_wal_shard_log_numbers.empty()) {
+      io_s = CreateWalShardLogs(write_options, new_log,
+                                new_wal_shard_log_numbers,
+                                preallocate_block_size, &new_wal_shard_logs);
+    }
     if (s.ok()) {
       s = io_s;
     }
@@ -2255,11 +2918,18 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
       }
     }
     if (s.ok()) {
+      if (!wal_shards_.empty()) {
+        RetireWalShardLogs();
+      }
       logfile_number_ = new_log_number;
       log_empty_ = true;
       log_dir_synced_ = false;
       logs_.emplace_back(logfile_number_, new_log);
       alive_log_files_.emplace_back(logfile_number_);
+      if (!wal_shards_.empty()) {
+        InstallWalShardLogs(new_log, new_wal_shard_logs);
+        wal_shard_log_oversized_.store(false, std::memory_order_relaxed);
+      }
     }
   }
 
@@ -2268,6 +2938,9 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
     assert(creating_new_log);
     delete new_mem;
     delete new_log;
+    for (log::Writer* shard_log : new_wal_shard_logs) {
+      delete shard_log;
+    }
     context->superversion_context.new_superversion.reset();
     // We may have lost data from the WritableFileBuffer in-memory buffer for
     // the current log, so treat it as a fatal error and set bg_error
@@ -8,6 +8,7 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #pragma once
+#include <algorithm>
 #include <cstdint>
 #include <string>
 
@@ -312,6 +313,12 @@ class DBIter final : public Iterator {
     assert(value_.empty());
     assert(wide_columns_.empty());
 
+    if (column_projection_ &&
+        std::find(column_projection_->begin(), column_projection_->end(),
+                  kDefaultWideColumnName) == column_projection_->end()) {
+      return;
+    }
+
     value_ = slice;
     wide_columns_.emplace_back(kDefaultWideColumnName, slice);
   }
@@ -428,6 +435,8 @@ class DBIter final : public Iterator {
   const Slice* const timestamp_lb_;
   const size_t timestamp_size_;
   std::string saved_timestamp_;
+  // See ReadOptions::column_projection.
+  const std::vector<Slice>* const column_projection_;
 };
 
 // Return a new iterator that converts internal keys (yielded by
@@ -678,6 +678,40 @@ TEST_F(DbKVChecksumWALToWriteBatchTest, WriteBatchChecksumHandoff) {
   SyncPoint::GetInstance()->DisableProcessing();
 };
 
+TEST_F(DbKVChecksumWALToWriteBatchTest, PinnedValues) {
+  Options options = CurrentOptions();
+  Reopen(options);
+  const std::string value(1000, 'v');
+
+  // A checksum is over the serialized batch, pinned values included.
+  WriteBatch batch;
+  ASSERT_OK(batch.PutPinned("key0", value));
+  ASSERT_OK(batch.Put("key1", "small"));
+  WriteBatch expected;
+  ASSERT_OK(expected.Put("key0", value));
+  ASSERT_OK(expected.Put("key1", "small"));
+  uint64_t checksum =
+      XXH3_64bits(expected.Data().data(), expected.Data().size());
+  ASSERT_OK(WriteBatchInternal::UpdateProtectionInfo(&batch, 8, &checksum));
+  ASSERT_FALSE(WriteBatchInternal::HasPinnedValues(&batch));
+  ASSERT_EQ(expected.Data(), batch.Data());
+
+  // Protecting a write does not need the values copied.
+  WriteOptions write_options;
+  write_options.protection_bytes_per_key = 8;
+  batch.Clear();
+  ASSERT_OK(batch.PutPinned("key2", value));
+  ASSERT_OK(batch.Delete("key1"));
+  ASSERT_OK(batch.PutPinned("key3", value));
+  ASSERT_OK(db_->Write(write_options, &batch));
+  ASSERT_EQ(8, batch.GetProtectionBytesPerKey());
+
+  Reopen(options);
+  ASSERT_EQ(value, Get("key2"));
+  ASSERT_EQ("NOT_FOUND", Get("key1"));
+  ASSERT_EQ(value, Get("key3"));
+}
+
 // TODO (cbi): add DeleteRange coverage once it is implemented
 class DbMemtableKVChecksumTest : public DbKvChecksumTest {
  public:
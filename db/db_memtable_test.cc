@@ -5,6 +5,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "db/db_test_util.h"
 #include "db/memtable.h"
@@ -277,6 +278,216 @@ TEST_F(DBMemTableTest, ConcurrentMergeWrite) {
   delete mem;
 }
 
+TEST_F(DBMemTableTest, ConcurrentVectorRepWrite) {
+  Options options = CurrentOptions();
+  options.memtable_factory.reset(new VectorRepFactory(1000));
+  options.allow_concurrent_memtable_write = true;
+  options.write_buffer_size = 64 << 20;
+  Reopen(options);
+
+  // Enough entries for the per-core buckets to be sorted in parallel.
+  const int kNumThreads = 8;
+  const int kNumKeysPerThread = 10000;
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumKeysPerThread; i++) {
+        ASSERT_OK(Put(Key(i * kNumThreads + t), "v" + std::to_string(t)));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ("v3", Get(Key(kNumThreads + 3)));
+
+  ASSERT_OK(Flush());
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ASSERT_EQ(Key(count), iter->key().ToString());
+    ASSERT_EQ("v" + std::to_string(count % kNumThreads),
+              iter->value().ToString());
+    count++;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumThreads * kNumKeysPerThread, count);
+}
+
+TEST_F(DBMemTableTest, VectorRepContainsAfterSort) {
+  InternalKeyComparator icmp(BytewiseComparator());
+  MemTable::KeyComparator cmp(icmp);
+  Arena arena;
+  std::unique_ptr<MemTableRep> rep(VectorRepFactory(10).CreateMemTableRep(
+      cmp, &arena, nullptr /* transform */, nullptr /* logger */));
+
+  std::vector<const char*> entries;
+  for (int i = 0; i < 10; i++) {
+    std::string ikey =
+        InternalKey(Key(i), i + 1, kTypeValue).Encode().ToString();
+    char* buf = nullptr;
+    KeyHandle handle =
+        rep->Allocate(VarintLength(ikey.size()) + ikey.size(), &buf);
+    char* p = EncodeVarint32(buf, static_cast<uint32_t>(ikey.size()));
+    memcpy(p, ikey.data(), ikey.size());
+    rep->Insert(handle);
+    entries.push_back(buf);
+  }
+  for (const char* entry : entries) {
+    ASSERT_TRUE(rep->Contains(entry));
+  }
+
+  // Iterating over the immutable rep merges the per-core buckets into one
+  // sorted bucket.
+  rep->MarkReadOnly();
+  std::unique_ptr<MemTableRep::Iterator> iter(rep->GetIterator(nullptr));
+  iter->SeekToFirst();
+  ASSERT_TRUE(iter->Valid());
+  for (const char* entry : entries) {
+    ASSERT_TRUE(rep->Contains(entry));
+  }
+}
+
+TEST_F(DBMemTableTest, BatchedInsert) {
+  Options options = CurrentOptions();
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  // Merges read the memtable, which must see the earlier entries of the
+  // same batch.
+  options.max_successive_merges = 2;
+  Reopen(options);
+
+  // Large enough for the point keys to be inserted in one sorted pass.
+  const int kNumKeys = 1000;
+  Random rnd(301);
+  WriteBatch batch;
+  for (int i = 0; i < kNumKeys; i++) {
+    int k = static_cast<int>(rnd.Uniform(kNumKeys));
+    ASSERT_OK(batch.Put(Key(k), "v" + std::to_string(i)));
+  }
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(batch.Put(Key(i), "a"));
+    ASSERT_OK(batch.Merge(Key(i), "b"));
+    ASSERT_OK(batch.Merge(Key(i), "c"));
+    ASSERT_OK(batch.Merge(Key(i), "d"));
+    if (i % 2 == 0) {
+      ASSERT_OK(batch.Delete(Key(i)));
+    }
+  }
+  ASSERT_OK(db_->Write(WriteOptions(), &batch));
+
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(i % 2 == 0 ? "NOT_FOUND" : "a,b,c,d", Get(Key(i)));
+  }
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ASSERT_EQ(Key(2 * count + 1), iter->key().ToString());
+    count++;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumKeys / 2, count);
+}
+
+TEST_F(DBMemTableTest, NumaAwareMemTable) {
+  Options options = CurrentOptions();
+  options.memtable_numa_aware = true;
+  Reopen(options);
+
+  const int kNumKeys = 1000;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), std::string(100, 'v')));
+  }
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(std::string(100, 'v'), Get(Key(i)));
+  }
+
+  uint64_t placed_bytes = 0;
+  uint64_t misplaced_bytes = 0;
+  uint64_t mem_size = 0;
+  ASSERT_TRUE(dbfull()->GetIntProperty(
+      DB::Properties::kMemTableNumaPlacedBytes, &placed_bytes));
+  ASSERT_TRUE(dbfull()->GetIntProperty(
+      DB::Properties::kMemTableNumaMisplacedBytes, &misplaced_bytes));
+  ASSERT_TRUE(dbfull()->GetIntProperty(DB::Properties::kCurSizeAllMemTables,
+                                       &mem_size));
+  if (ConcurrentArena::NumNumaNodes() > 1) {
+    ASSERT_GT(placed_bytes + misplaced_bytes, 0);
+  } else {
+    ASSERT_EQ(placed_bytes + misplaced_bytes, 0);
+  }
+  ASSERT_GE(mem_size, kNumKeys * 100);
+
+  // Flushed memtables no longer count.
+  ASSERT_OK(Flush());
+  ASSERT_TRUE(dbfull()->GetIntProperty(
+      DB::Properties::kMemTableNumaPlacedBytes, &placed_bytes));
+  ASSERT_TRUE(dbfull()->GetIntProperty(
+      DB::Properties::kMemTableNumaMisplacedBytes, &misplaced_bytes));
+  ASSERT_EQ(placed_bytes + misplaced_bytes, 0);
+}
+
+TEST_F(DBMemTableTest, AdaptiveRadixTreeRep) {
+  Options options = CurrentOptions();
+  options.memtable_factory.reset(new AdaptiveRadixTreeRepFactory());
+  options.allow_concurrent_memtable_write = true;
+  Reopen(options);
+
+  // Overwrites, deletes and user keys with embedded zero bytes must iterate
+  // in internal key order.
+  const std::string zero_key("a\0b", 3);
+  ASSERT_OK(Put("a", "v1"));
+  ASSERT_OK(Put(zero_key, "v2"));
+  ASSERT_OK(Put("ab", "v3"));
+  ASSERT_OK(Put("a", "v4"));
+  ASSERT_OK(Delete("ab"));
+  ASSERT_EQ("v4", Get("a"));
+  ASSERT_EQ("v2", Get(zero_key));
+  ASSERT_EQ("NOT_FOUND", Get("ab"));
+  ASSERT_EQ("[ v4, v1 ]", AllEntriesFor("a"));
+
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  iter->SeekToFirst();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("a", iter->key().ToString());
+  iter->Next();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(zero_key, iter->key().ToString());
+  iter->Next();
+  ASSERT_FALSE(iter->Valid());
+  iter->SeekForPrev("b");
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(zero_key, iter->key().ToString());
+  ASSERT_OK(iter->status());
+  iter.reset();
+
+  ASSERT_OK(Flush());
+  ASSERT_EQ("v4", Get("a"));
+  ASSERT_EQ("v2", Get(zero_key));
+
+  // Concurrent writers insert into the same memtable.
+  const int kNumThreads = 4;
+  const int kNumKeys = 1000;
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = t; i < kNumKeys; i += kNumThreads) {
+        ASSERT_OK(Put(Key(i), "v" + std::to_string(i)));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ("v" + std::to_string(i), Get(Key(i)));
+  }
+
+  // Other comparators are rejected.
+  options.comparator = ReverseBytewiseComparator();
+  Destroy(options);
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+}
+
 TEST_F(DBMemTableTest, InsertWithHint) {
   Options options;
   options.allow_concurrent_memtable_write = false;
@@ -15,6 +15,7 @@
 #include "db/write_stall_stats.h"
 #include "options/cf_options.h"
 #include "port/stack_trace.h"
+#include "rocksdb/cache.h"
 #include "rocksdb/listener.h"
 #include "rocksdb/options.h"
 #include "rocksdb/perf_context.h"
@@ -1599,6 +1600,62 @@ TEST_P(CompressionSamplingDBPropertiesTest,
   }
 }
 
+// Excluded from RocksDB lite tests due to `GetPropertiesOfAllTables()` usage.
+TEST_F(DBPropertiesTest, AdaptiveDataBlockCompression) {
+  Options options = CurrentOptions();
+  if (ZSTD_Supported()) {
+    options.compression = kZSTD;
+  } else if (Zlib_Supported()) {
+    options.compression = kZlibCompression;
+  } else {
+    return;
+  }
+  options.disable_auto_compactions = true;
+
+  // Values of keys "a*" are random bytes, which do not compress. Values of
+  // keys "b*" are random printable characters, which entropy coding
+  // compresses.
+  Random rnd(301);
+  std::map<std::string, std::string> kvs;
+  for (int i = 0; i < 64; ++i) {
+    kvs["a" + Key(i)] = rnd.RandomBinaryString(1000);
+    kvs["b" + Key(i)] = rnd.RandomString(1000);
+  }
+
+  for (bool adaptive : {false, true}) {
+    BlockBasedTableOptions table_options;
+    table_options.adaptive_data_block_compression = adaptive;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    for (const auto& kv : kvs) {
+      ASSERT_OK(Put(kv.first, kv.second));
+    }
+    ASSERT_OK(Flush());
+    for (const auto& kv : kvs) {
+      ASSERT_EQ(kv.second, Get(kv.first));
+    }
+
+    TablePropertiesCollection file_to_props;
+    ASSERT_OK(db_->GetPropertiesOfAllTables(&file_to_props));
+    ASSERT_EQ(1, file_to_props.size());
+    const TableProperties& props = *file_to_props.begin()->second;
+    if (!adaptive) {
+      ASSERT_EQ(props.adaptive_compression_slow_blocks, 0);
+      ASSERT_EQ(props.adaptive_compression_fast_blocks, 0);
+      ASSERT_EQ(props.adaptive_compression_uncompressed_blocks, 0);
+      continue;
+    }
+    ASSERT_GT(props.adaptive_compression_slow_blocks, 0);
+    // A fast algorithm, if any, would find nothing to compress either
+    ASSERT_EQ(props.adaptive_compression_fast_blocks, 0);
+    ASSERT_GT(props.adaptive_compression_uncompressed_blocks, 0);
+    ASSERT_EQ(props.adaptive_compression_slow_blocks +
+                  props.adaptive_compression_uncompressed_blocks,
+              props.num_data_blocks);
+  }
+}
+
 TEST_F(DBPropertiesTest, EstimateNumKeysUnderflow) {
   Options options = CurrentOptions();
   Reopen(options);
@@ -2103,6 +2160,64 @@ TEST_F(DBPropertiesTest, GetMapPropertyBlockCacheEntryStats) {
   ASSERT_EQ(3 * kNumCacheEntryRoles + 4, values.size());
 }
 
+TEST_F(DBPropertiesTest, GetMapPropertyBlockCacheQuotaStats) {
+  std::map<std::string, std::string> values;
+  // Not available without a CacheQuotaGroup
+  ASSERT_FALSE(
+      db_->GetMapProperty(DB::Properties::kBlockCacheQuotaStats, &values));
+
+  LRUCacheOptions cache_opts;
+  cache_opts.capacity = 4 << 20;
+  std::shared_ptr<CacheQuotaGroup> group = NewCacheQuotaGroup(cache_opts);
+  BlockBasedTableOptions table_options;
+  ASSERT_OK(group->NewQuotaCache("default", 3 << 20,
+                                 &table_options.block_cache));
+  Options options = CurrentOptions();
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  ASSERT_OK(group->NewQuotaCache("scan", 1 << 20, &table_options.block_cache));
+  Options scan_options = options;
+  scan_options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+  CreateColumnFamilies({"scan"}, scan_options);
+  ReopenWithColumnFamilies({"default", "scan"},
+                           std::vector<Options>{options, scan_options});
+
+  ASSERT_OK(Put(0, "foo", "v0"));
+  ASSERT_OK(Put(1, "foo", "v1"));
+  ASSERT_OK(Flush(0));
+  ASSERT_OK(Flush(1));
+  std::map<std::string, std::string> before;
+  ASSERT_TRUE(db_->GetMapProperty(DB::Properties::kBlockCacheQuotaStats,
+                                  &before));
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(Get(1, "foo"), "v1");
+  }
+
+  // Every column family reports all the quotas of the group
+  for (int cf = 0; cf < 2; cf++) {
+    values.clear();
+    ASSERT_TRUE(db_->GetMapProperty(handles_[cf],
+                                    DB::Properties::kBlockCacheQuotaStats,
+                                    &values));
+    ASSERT_EQ(values["capacity"], std::to_string(4 << 20));
+    ASSERT_EQ(values["default.guaranteed_capacity"],
+              std::to_string(3 << 20));
+    ASSERT_EQ(values["scan.guaranteed_capacity"], std::to_string(1 << 20));
+    ASSERT_GT(std::stoull(values["scan.usage"]), 0);
+    ASSERT_GT(std::stoull(values["scan.hits"]),
+              std::stoull(before["scan.hits"]));
+    ASSERT_GE(std::stoull(values["scan.lookups"]),
+              std::stoull(values["scan.hits"]));
+    // Only the reads of the "scan" column family were counted since
+    ASSERT_EQ(values["default.hits"], before["default.hits"]);
+    ASSERT_EQ(values["default.lookups"], before["default.lookups"]);
+    ASSERT_EQ(values.size(), 13);
+  }
+  std::string str;
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kBlockCacheQuotaStats, &str));
+  ASSERT_NE(str.find("scan.hit_rate: "), std::string::npos);
+}
+
 TEST_F(DBPropertiesTest, WriteStallStatsSanityCheck) {
   for (uint32_t i = 0; i < static_cast<uint32_t>(WriteStallCause::kNone); ++i) {
     WriteStallCause cause = static_cast<WriteStallCause>(i);
@@ -3821,6 +3821,82 @@ TEST_F(DBRangeDelTest, RowCache) {
   ASSERT_TRUE(db_->Write(WriteOptions(), &wb).IsNotSupported());
   ASSERT_EQ(Get(Key(3)), "val");
 }
+
+TEST_F(DBRangeDelTest, TournamentTreeMerge) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.level0_slowdown_writes_trigger = 100;
+  options.level0_stop_writes_trigger = 100;
+  DestroyAndReopen(options);
+
+  // Many L0 files with interleaved keys, some with range tombstones over the
+  // keys of older files.
+  const int kNumFiles = 30;
+  const int kNumKeys = 900;
+  std::map<std::string, std::string> expected;
+  for (int f = 0; f < kNumFiles; ++f) {
+    for (int i = f; i < kNumKeys; i += kNumFiles) {
+      std::string value = "v" + std::to_string(f);
+      ASSERT_OK(Put(Key(i), value));
+      expected[Key(i)] = value;
+    }
+    if (f % 4 == 3) {
+      const int begin = f * kNumKeys / kNumFiles;
+      const int end = begin + 2 * kNumKeys / kNumFiles;
+      ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                                 Key(begin), Key(end)));
+      expected.erase(expected.lower_bound(Key(begin)),
+                     expected.lower_bound(Key(end)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ(kNumFiles, NumTableFilesAtLevel(0));
+
+  auto verify = [&]() {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    auto it = expected.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++it) {
+      ASSERT_TRUE(it != expected.end());
+      ASSERT_EQ(it->first, iter->key());
+      ASSERT_EQ(it->second, iter->value());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(it == expected.end());
+
+    auto rit = expected.rbegin();
+    for (iter->SeekToLast(); iter->Valid(); iter->Prev(), ++rit) {
+      ASSERT_TRUE(rit != expected.rend());
+      ASSERT_EQ(rit->first, iter->key());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(rit == expected.rend());
+
+    for (int i = 0; i < kNumKeys; i += 7) {
+      iter->Seek(Key(i));
+      auto lb = expected.lower_bound(Key(i));
+      ASSERT_EQ(lb != expected.end(), iter->Valid());
+      if (iter->Valid()) {
+        ASSERT_EQ(lb->first, iter->key());
+        // Switch direction after the seek.
+        iter->Prev();
+        ASSERT_EQ(lb != expected.begin(), iter->Valid());
+        if (iter->Valid()) {
+          ASSERT_EQ(std::prev(lb)->first, iter->key());
+        }
+      }
+      ASSERT_OK(iter->status());
+    }
+  };
+
+  ASSERT_OK(dbfull()->SetOptions({{"use_tournament_tree_merge", "false"}}));
+  verify();
+  ASSERT_OK(dbfull()->SetOptions({{"use_tournament_tree_merge", "true"}}));
+  verify();
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  verify();
+}
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -2667,6 +2667,269 @@ TEST_F(DBWALTest, EmptyWalReopenTest) {
   }
 }
 
+TEST_F(DBWALTest, WalShardsRecover) {
+  Options options = CurrentOptions();
+  options.num_wal_shards = 4;
+  // Shard logs are not tracked in the MANIFEST
+  options.track_and_verify_wals_in_manifest = false;
+  options.avoid_flush_during_recovery = true;
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  const int kNumThreads = 8;
+  const int kNumKeysPerThread = 500;
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      WriteOptions wo;
+      wo.sync = (t % 2 == 0);
+      for (int i = 0; i < kNumKeysPerThread; i++) {
+        std::string key = Key(t * kNumKeysPerThread + i);
+        WriteBatch batch;
+        ASSERT_OK(batch.Put(handles_[0], key, "v" + key));
+        ASSERT_OK(batch.Put(handles_[1], key, "w" + key));
+        ASSERT_OK(dbfull()->Write(wo, &batch));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // Overwrite a key from all shards so that recovery has to replay the
+  // shard logs in sequence number order.
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(1, "last", std::to_string(i)));
+  }
+  const SequenceNumber last_sequence = dbfull()->GetLatestSequenceNumber();
+  ASSERT_EQ(static_cast<SequenceNumber>(2 * kNumThreads * kNumKeysPerThread +
+                                        100),
+            last_sequence);
+
+  for (int iter = 0; iter < 2; iter++) {
+    ReopenWithColumnFamilies({"default", "pikachu"}, options);
+    ASSERT_EQ(last_sequence, dbfull()->GetLatestSequenceNumber());
+    for (int i = 0; i < kNumThreads * kNumKeysPerThread; i++) {
+      ASSERT_EQ("v" + Key(i), Get(0, Key(i)));
+      ASSERT_EQ("w" + Key(i), Get(1, Key(i)));
+    }
+    ASSERT_EQ("99", Get(1, "last"));
+  }
+
+  // Switching the WAL retires all shard logs together.
+  ASSERT_OK(Flush(0));
+  ASSERT_OK(Put(0, "after_flush", "x"));
+  ReopenWithColumnFamilies({"default", "pikachu"}, options);
+  ASSERT_EQ("x", Get(0, "after_flush"));
+  ASSERT_EQ("99", Get(1, "last"));
+
+  // The DB can be reopened with a different number of shards.
+  options.num_wal_shards = 1;
+  ReopenWithColumnFamilies({"default", "pikachu"}, options);
+  ASSERT_EQ("x", Get(0, "after_flush"));
+  ASSERT_EQ("v" + Key(0), Get(0, Key(0)));
+}
+
+TEST_F(DBWALTest, WalShardsMissingPrimaryLog) {
+  Options options = CurrentOptions();
+  options.num_wal_shards = 2;
+  options.track_and_verify_wals_in_manifest = false;
+  options.avoid_flush_during_recovery = true;
+  DestroyAndReopen(options);
+
+  // Write only to the shard log, then lose the primary log.
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::WriteImpl:WalShardIndex",
+      [](void* arg) { *static_cast<size_t*>(arg) = 1; });
+  SyncPoint::GetInstance()->EnableProcessing();
+  ASSERT_OK(Put("k", "v"));
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  Close();
+
+  std::vector<std::string> files;
+  ASSERT_OK(env_->GetChildren(dbname_, &files));
+  std::vector<uint64_t> wal_numbers;
+  for (const auto& file : files) {
+    uint64_t number = 0;
+    FileType type = kWalFile;
+    if (ParseFileName(file, &number, &type) && type == kWalFile) {
+      wal_numbers.push_back(number);
+    }
+  }
+  ASSERT_EQ(2, wal_numbers.size());
+  std::sort(wal_numbers.begin(), wal_numbers.end());
+  ASSERT_OK(env_->DeleteFile(LogFileName(dbname_, wal_numbers[0])));
+
+  options.wal_recovery_mode = WALRecoveryMode::kAbsoluteConsistency;
+  ASSERT_TRUE(TryReopen(options).IsCorruption());
+  options.wal_recovery_mode = WALRecoveryMode::kPointInTimeRecovery;
+  Reopen(options);
+  ASSERT_EQ("NOT_FOUND", Get("k"));
+}
+
+namespace {
+// Returns the numbers of the WAL files in dbname, in increasing order.
+std::vector<uint64_t> GetWalNumbers(Env* env, const std::string& dbname) {
+  std::vector<std::string> files;
+  EXPECT_OK(env->GetChildren(dbname, &files));
+  std::vector<uint64_t> wal_numbers;
+  for (const auto& file : files) {
+    uint64_t number = 0;
+    FileType type = kWalFile;
+    if (ParseFileName(file, &number, &type) && type == kWalFile) {
+      wal_numbers.push_back(number);
+    }
+  }
+  std::sort(wal_numbers.begin(), wal_numbers.end());
+  return wal_numbers;
+}
+}  // anonymous namespace
+
+TEST_F(DBWALTest, WalShardsGap) {
+  for (WALRecoveryMode mode : {WALRecoveryMode::kAbsoluteConsistency,
+                               WALRecoveryMode::kPointInTimeRecovery,
+                               WALRecoveryMode::kTolerateCorruptedTailRecords,
+                               WALRecoveryMode::kSkipAnyCorruptedRecords}) {
+    SCOPED_TRACE("mode " + std::to_string(static_cast<int>(mode)));
+    Options options = CurrentOptions();
+    options.num_wal_shards = 2;
+    options.track_and_verify_wals_in_manifest = false;
+    options.avoid_flush_during_recovery = true;
+    DestroyAndReopen(options);
+
+    // The primary log has the lower number.
+    std::vector<uint64_t> wal_numbers = GetWalNumbers(env_, dbname_);
+    ASSERT_EQ(2, wal_numbers.size());
+    const std::string shard_log = LogFileName(dbname_, wal_numbers[1]);
+
+    size_t shard_index = 0;
+    SyncPoint::GetInstance()->SetCallBack(
+        "DBImpl::WriteImpl:WalShardIndex",
+        [&](void* arg) { *static_cast<size_t*>(arg) = shard_index; });
+    SyncPoint::GetInstance()->EnableProcessing();
+    ASSERT_OK(Put("k1", "v1"));
+    uint64_t shard_log_size = 0;
+    ASSERT_OK(env_->GetFileSize(shard_log, &shard_log_size));
+    shard_index = 1;
+    ASSERT_OK(Put("k2", "v2"));
+    shard_index = 0;
+    ASSERT_OK(Put("k3", "v3"));
+    SyncPoint::GetInstance()->DisableProcessing();
+    SyncPoint::GetInstance()->ClearAllCallBacks();
+    Close();
+
+    // The shard log loses k2, while the primary log still holds the later
+    // k3.
+    ASSERT_OK(test::TruncateFile(env_, shard_log, shard_log_size));
+    options.wal_recovery_mode = mode;
+    if (mode == WALRecoveryMode::kAbsoluteConsistency) {
+      ASSERT_TRUE(TryReopen(options).IsCorruption());
+      continue;
+    }
+    Reopen(options);
+    ASSERT_EQ("v1", Get("k1"));
+    ASSERT_EQ("NOT_FOUND", Get("k2"));
+    // Only skipping corrupted records replays past the gap.
+    ASSERT_EQ(mode == WALRecoveryMode::kSkipAnyCorruptedRecords ? "v3"
+                                                                : "NOT_FOUND",
+              Get("k3"));
+  }
+}
+
+TEST_F(DBWALTest, WalShardsTornTail) {
+  for (WALRecoveryMode mode : {WALRecoveryMode::kPointInTimeRecovery,
+                               WALRecoveryMode::kTolerateCorruptedTailRecords,
+                               WALRecoveryMode::kSkipAnyCorruptedRecords}) {
+    SCOPED_TRACE("mode " + std::to_string(static_cast<int>(mode)));
+    Options options = CurrentOptions();
+    options.num_wal_shards = 2;
+    options.track_and_verify_wals_in_manifest = false;
+    options.avoid_flush_during_recovery = true;
+    DestroyAndReopen(options);
+
+    // The primary log has the lower number.
+    std::vector<uint64_t> wal_numbers = GetWalNumbers(env_, dbname_);
+    ASSERT_EQ(2, wal_numbers.size());
+    const std::string shard_log = LogFileName(dbname_, wal_numbers[1]);
+
+    size_t shard_index = 0;
+    SyncPoint::GetInstance()->SetCallBack(
+        "DBImpl::WriteImpl:WalShardIndex",
+        [&](void* arg) { *static_cast<size_t*>(arg) = shard_index; });
+    SyncPoint::GetInstance()->EnableProcessing();
+    for (int i = 0; i < 4; i++) {
+      shard_index = i % 2;
+      ASSERT_OK(Put("k" + std::to_string(i), "v" + std::to_string(i)));
+    }
+    SyncPoint::GetInstance()->DisableProcessing();
+    SyncPoint::GetInstance()->ClearAllCallBacks();
+    Close();
+
+    // The last write, to the shard log, is torn; the primary log is intact.
+    uint64_t shard_log_size = 0;
+    ASSERT_OK(env_->GetFileSize(shard_log, &shard_log_size));
+    ASSERT_OK(test::TruncateFile(env_, shard_log, shard_log_size - 3));
+    options.wal_recovery_mode = mode;
+    Reopen(options);
+    for (int i = 0; i < 3; i++) {
+      ASSERT_EQ("v" + std::to_string(i), Get("k" + std::to_string(i)));
+    }
+    ASSERT_EQ("NOT_FOUND", Get("k3"));
+    ASSERT_EQ(3, dbfull()->GetLatestSequenceNumber());
+
+    // New writes after the recovered ones survive another recovery.
+    ASSERT_OK(Put("k4", "v4"));
+    Reopen(options);
+    ASSERT_EQ("v2", Get("k2"));
+    ASSERT_EQ("v4", Get("k4"));
+  }
+}
+
+TEST_F(DBWALTest, WalShardsReopenUnsharded) {
+  Options options = CurrentOptions();
+  options.num_wal_shards = 2;
+  options.track_and_verify_wals_in_manifest = false;
+  options.avoid_flush_during_recovery = true;
+  DestroyAndReopen(options);
+  ASSERT_OK(Put("k", "v"));
+  Reopen(options);
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+
+  // Reopening without sharding flushes what the sharded WAL held, so that an
+  // older release never has to read it.
+  options.num_wal_shards = 1;
+  Reopen(options);
+  ASSERT_EQ(1, NumTableFilesAtLevel(0));
+  ASSERT_EQ("v", Get("k"));
+}
+
+TEST_F(DBWALTest, WalShardsOptions) {
+  Options options = CurrentOptions();
+  options.track_and_verify_wals_in_manifest = false;
+  options.num_wal_shards = 0;
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+
+  options.num_wal_shards = 2;
+  options.enable_pipelined_write = true;
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+  options.enable_pipelined_write = false;
+  options.allow_concurrent_memtable_write = false;
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+  options.allow_concurrent_memtable_write = true;
+  options.manual_wal_flush = true;
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+  options.manual_wal_flush = false;
+  options.track_and_verify_wals_in_manifest = true;
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+  options.track_and_verify_wals_in_manifest = false;
+
+  Reopen(options);
+  WriteOptions wo;
+  wo.disableWAL = true;
+  ASSERT_TRUE(Put("k", "v", wo).IsNotSupported());
+  ASSERT_OK(Put("k", "v"));
+  ASSERT_EQ("v", Get("k"));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
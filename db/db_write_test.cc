@@ -15,6 +15,7 @@
 #include "db/write_thread.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
+#include "rocksdb/trace_reader_writer.h"
 #include "test_util/sync_point.h"
 #include "util/random.h"
 #include "util/string_util.h"
@@ -493,6 +494,220 @@ TEST_F(DBWriteTestUnparameterized, PipelinedWriteRace) {
   ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
 }
 
+TEST_F(DBWriteTestUnparameterized, PipelinedWalSync) {
+  std::unique_ptr<FaultInjectionTestEnv> fault_env(
+      new FaultInjectionTestEnv(env_));
+  Options options = GetDefaultOptions();
+  options.create_if_missing = true;
+  options.env = fault_env.get();
+  options.enable_pipelined_write = true;
+  options.enable_pipelined_wal_sync = true;
+  options.statistics = CreateDBStatistics();
+
+  options.manual_wal_flush = true;
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+  options.manual_wal_flush = false;
+  Reopen(options);
+
+  const int kNumThreads = 8;
+  const int kNumWrites = 200;
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumWrites; i++) {
+        WriteOptions write_options;
+        // Mix in unsynced writes so that sync and unsynced groups interleave.
+        write_options.sync = (i % 4 != 3);
+        std::string key = "t" + std::to_string(t) + "_" + std::to_string(i);
+        ASSERT_OK(dbfull()->Put(write_options, key, "v" + key));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_GT(options.statistics->getTickerCount(WAL_FILE_SYNCED), 0);
+
+  // Hold the first sync in flight until sync writes from other threads have
+  // appended to the WAL behind it. Those writes then share one later sync.
+  std::atomic<size_t> appended_writes{0};
+  std::atomic<bool> first_sync{true};
+  std::atomic<bool> appended_during_sync{false};
+  std::vector<port::Thread> sync_writers;
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::PipelinedWriteImpl:AfterWALAppend", [&](void* arg) {
+        appended_writes.fetch_add(*static_cast<size_t*>(arg));
+      });
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBWALTest::SyncWALNotWaitWrite:1", [&](void* /*arg*/) {
+        if (!first_sync.exchange(false)) {
+          return;
+        }
+        const size_t appended_before = appended_writes.load();
+        for (int t = 0; t < kNumThreads; t++) {
+          sync_writers.emplace_back([&, t]() {
+            WriteOptions write_options;
+            write_options.sync = true;
+            ASSERT_OK(dbfull()->Put(write_options,
+                                    "during_sync" + std::to_string(t), "v"));
+          });
+        }
+        for (int i = 0; i < 10000; i++) {
+          if (appended_writes.load() == appended_before + kNumThreads) {
+            appended_during_sync = true;
+            break;
+          }
+          env_->SleepForMicroseconds(1000);
+        }
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  const uint64_t syncs_before =
+      options.statistics->getTickerCount(WAL_FILE_SYNCED);
+  WriteOptions sync_write_options;
+  sync_write_options.sync = true;
+  ASSERT_OK(dbfull()->Put(sync_write_options, "before_sync", "v"));
+  for (auto& thread : sync_writers) {
+    thread.join();
+  }
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_TRUE(appended_during_sync);
+  ASSERT_LT(options.statistics->getTickerCount(WAL_FILE_SYNCED) - syncs_before,
+            static_cast<uint64_t>(kNumThreads + 1));
+
+  Close();
+  // Simulate a crash that loses all unsynced WAL data.
+  ASSERT_OK(fault_env->DropUnsyncedFileData());
+  Reopen(options);
+  for (int t = 0; t < kNumThreads; t++) {
+    // The last synced write of each thread covers all its earlier writes.
+    for (int i = 0; i < kNumWrites - 1; i++) {
+      std::string key = "t" + std::to_string(t) + "_" + std::to_string(i);
+      ASSERT_EQ("v" + key, Get(key));
+    }
+  }
+  Close();
+}
+
+TEST_F(DBWriteTestUnparameterized, PipelinedWalSyncWithDisableWAL) {
+  std::unique_ptr<FaultInjectionTestEnv> fault_env(
+      new FaultInjectionTestEnv(env_));
+  Options options = GetDefaultOptions();
+  options.create_if_missing = true;
+  options.env = fault_env.get();
+  options.enable_pipelined_write = true;
+  options.enable_pipelined_wal_sync = true;
+  options.statistics = CreateDBStatistics();
+  Reopen(options);
+
+  // While the first sync write holds the memtable writer queue in its WAL
+  // sync, a sync write and then a disableWAL write queue up behind it, so
+  // that they form the next memtable write group together.
+  std::atomic<int> wal_appends{0};
+  std::atomic<int> group_exits{0};
+  std::atomic<bool> first_sync{true};
+  std::vector<port::Thread> writers;
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::PipelinedWriteImpl:AfterWALAppend",
+      [&](void* /*arg*/) { wal_appends.fetch_add(1); });
+  SyncPoint::GetInstance()->SetCallBack(
+      "WriteThread::ExitAsBatchGroupLeader:Start",
+      [&](void* /*arg*/) { group_exits.fetch_add(1); });
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBWALTest::SyncWALNotWaitWrite:1", [&](void* /*arg*/) {
+        if (!first_sync.exchange(false)) {
+          return;
+        }
+        auto wait_for = [&](std::atomic<int>& counter, int value) {
+          for (int i = 0; i < 10000 && counter.load() < value; i++) {
+            env_->SleepForMicroseconds(1000);
+          }
+          ASSERT_GE(counter.load(), value);
+        };
+        const int appends_before = wal_appends.load();
+        const int exits_before = group_exits.load();
+        writers.emplace_back([&]() {
+          WriteOptions write_options;
+          write_options.sync = true;
+          ASSERT_OK(dbfull()->Put(write_options, "sync", "v"));
+        });
+        wait_for(wal_appends, appends_before + 1);
+        wait_for(group_exits, exits_before + 1);
+        writers.emplace_back([&]() {
+          WriteOptions write_options;
+          write_options.disableWAL = true;
+          ASSERT_OK(dbfull()->Put(write_options, "no_wal", "v"));
+        });
+        wait_for(group_exits, exits_before + 2);
+        // Let the disableWAL writer link into the memtable writer queue
+        env_->SleepForMicroseconds(10000);
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  const uint64_t syncs_before =
+      options.statistics->getTickerCount(WAL_FILE_SYNCED);
+  WriteOptions sync_write_options;
+  sync_write_options.sync = true;
+  ASSERT_OK(dbfull()->Put(sync_write_options, "first", "v"));
+  for (auto& thread : writers) {
+    thread.join();
+  }
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  // One sync for each sync write, none for the disableWAL write
+  ASSERT_EQ(options.statistics->getTickerCount(WAL_FILE_SYNCED) - syncs_before,
+            2);
+  ASSERT_EQ("v", Get("no_wal"));
+
+  // A disableWAL write on its own does not sync either
+  WriteOptions no_wal_options;
+  no_wal_options.disableWAL = true;
+  ASSERT_OK(dbfull()->Put(no_wal_options, "no_wal2", "v"));
+  ASSERT_EQ(options.statistics->getTickerCount(WAL_FILE_SYNCED) - syncs_before,
+            2);
+
+  Close();
+  ASSERT_OK(fault_env->DropUnsyncedFileData());
+  Reopen(options);
+  ASSERT_EQ("v", Get("first"));
+  ASSERT_EQ("v", Get("sync"));
+  Close();
+}
+
+TEST_F(DBWriteTestUnparameterized, PipelinedWalSyncFailure) {
+  std::unique_ptr<FaultInjectionTestEnv> fault_env(
+      new FaultInjectionTestEnv(env_));
+  Options options = GetDefaultOptions();
+  options.create_if_missing = true;
+  options.env = fault_env.get();
+  options.enable_pipelined_write = true;
+  options.enable_pipelined_wal_sync = true;
+  Reopen(options);
+
+  ASSERT_OK(Put("before", "v"));
+  const SequenceNumber seq_before = dbfull()->GetLatestSequenceNumber();
+
+  // The WAL append of the next write succeeds, its sync fails
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::SyncWAL:Begin", [&](void* /*arg*/) {
+        fault_env->SetFilesystemActive(false,
+                                       Status::IOError("injected sync error"));
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  WriteOptions sync_write_options;
+  sync_write_options.sync = true;
+  ASSERT_NOK(dbfull()->Put(sync_write_options, "failed", "v"));
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  fault_env->SetFilesystemActive(true);
+
+  // The write is not published, and the DB stops taking writes
+  ASSERT_EQ(seq_before, dbfull()->GetLatestSequenceNumber());
+  ASSERT_EQ("NOT_FOUND", Get("failed"));
+  ASSERT_NOK(Put("after", "v"));
+  Close();
+}
+
 TEST_P(DBWriteTest, ManualWalFlushInEffect) {
   Options options = GetOptions();
   Reopen(options);
@@ -939,6 +1154,46 @@ TEST_P(DBWriteTest, RecycleLogToggleTest) {
   ASSERT_EQ(Get(Key(1)), "val2");
 }
 
+TEST_P(DBWriteTest, PutPinnedRecoversFromWAL) {
+  Options options = GetOptions();
+  options.avoid_flush_during_recovery = true;
+  Reopen(options);
+
+  // Values larger than a WAL block, so that records are split into
+  // fragments that span the pinned values and the rest of the batch
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < 4; ++i) {
+    values.push_back(rnd.RandomString(48 << 10));
+  }
+  WriteBatch batch;
+  ASSERT_OK(batch.PutPinned(Key(0), values[0]));
+  ASSERT_OK(batch.Put(Key(1), "small"));
+  ASSERT_OK(batch.PutPinned(Key(2), values[1]));
+  ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+  batch.Clear();
+  ASSERT_OK(batch.PutPinned(Key(3), values[2]));
+  ASSERT_OK(batch.PutPinned(Key(4), values[3]));
+  // Tracing the write copies the values into the batch
+  std::unique_ptr<TraceWriter> trace_writer;
+  ASSERT_OK(NewFileTraceWriter(env_, EnvOptions(), dbname_ + "/trace",
+                               &trace_writer));
+  ASSERT_OK(db_->StartTrace(TraceOptions(), std::move(trace_writer)));
+  ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+  ASSERT_OK(db_->EndTrace());
+  ASSERT_FALSE(WriteBatchInternal::HasPinnedValues(&batch));
+
+  ASSERT_EQ(values[0], Get(Key(0)));
+  ASSERT_EQ("small", Get(Key(1)));
+  ASSERT_EQ(values[1], Get(Key(2)));
+  Reopen(options);
+  ASSERT_EQ(values[0], Get(Key(0)));
+  ASSERT_EQ("small", Get(Key(1)));
+  ASSERT_EQ(values[1], Get(Key(2)));
+  ASSERT_EQ(values[2], Get(Key(3)));
+  ASSERT_EQ(values[3], Get(Key(4)));
+}
+
 INSTANTIATE_TEST_CASE_P(DBWriteTestInstance, DBWriteTest,
                         testing::Values(DBTestBase::kDefault,
                                         DBTestBase::kConcurrentWALWrites,
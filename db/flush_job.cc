@@ -11,9 +11,11 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <cstring>
 #include <vector>
 
 #include "db/builder.h"
+#include "db/compaction/clipping_iterator.h"
 #include "db/db_iter.h"
 #include "db/dbformat.h"
 #include "db/event_helpers.h"
@@ -36,6 +38,7 @@
 #include "port/port.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
+#include "rocksdb/sst_partitioner.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/status.h"
 #include "rocksdb/table.h"
@@ -45,6 +48,7 @@
 #include "test_util/sync_point.h"
 #include "util/coding.h"
 #include "util/mutexlock.h"
+#include "util/parallel_for.h"
 #include "util/stop_watch.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -632,7 +636,7 @@ Status FlushJob::MemPurge() {
         // Piggyback FlushJobInfo on the first flushed memtable.
         db_mutex_->AssertHeld();
         meta_.fd.file_size = 0;
-        mems_[0]->SetFlushJobInfo(GetFlushJobInfo());
+        mems_[0]->SetFlushJobInfos(GetFlushJobInfos());
         db_mutex_->Unlock();
       } else {
         s = Status::Aborted(Slice("Mempurge filled more than one memtable."));
@@ -916,10 +920,11 @@ Status FlushJob::WriteLevel0Table() {
                          << total_num_range_deletes << "flush_reason"
                          << GetFlushReasonString(flush_reason_);
 
+    const std::vector<std::string> partition_boundaries =
+        PickFlushPartitionBoundaries(total_num_entries,
+                                     total_num_range_deletes);
+
     {
-      ScopedArenaPtr<InternalIterator> iter(
-          NewMergingIterator(&cfd_->internal_comparator(), memtables.data(),
-                             static_cast<int>(memtables.size()), &arena));
       ROCKS_LOG_INFO(db_options_.info_log,
                      "[%s] [JOB %d] Level-0 flush table #%" PRIu64 ": started",
                      cfd_->GetName().c_str(), job_context_->job_id,
@@ -972,17 +977,131 @@ Status FlushJob::WriteLevel0Table() {
       const SequenceNumber job_snapshot_seq =
           job_context_->GetJobSnapshotSequence();
 
-      s = BuildTable(
-          dbname_, versions_, db_options_, tboptions, file_options_,
-          cfd_->table_cache(), iter.get(), std::move(range_del_iters), &meta_,
-          &blob_file_additions, existing_snapshots_,
-          earliest_write_conflict_snapshot_, job_snapshot_seq,
-          snapshot_checker_, mutable_cf_options_.paranoid_file_checks,
-          cfd_->internal_stats(), &io_s, io_tracer_,
-          BlobFileCreationReason::kFlush, seqno_to_time_mapping_.get(),
-          event_logger_, job_context_->job_id, &table_properties_, write_hint,
-          full_history_ts_low, blob_callback_, base_, &num_input_entries,
-          &memtable_payload_bytes, &memtable_garbage_bytes);
+      if (partition_boundaries.empty()) {
+        ScopedArenaPtr<InternalIterator> iter(
+            NewMergingIterator(&cfd_->internal_comparator(), memtables.data(),
+                               static_cast<int>(memtables.size()), &arena));
+        s = BuildTable(
+            dbname_, versions_, db_options_, tboptions, file_options_,
+            cfd_->table_cache(), iter.get(), std::move(range_del_iters),
+            &meta_, &blob_file_additions, existing_snapshots_,
+            earliest_write_conflict_snapshot_, job_snapshot_seq,
+            snapshot_checker_, mutable_cf_options_.paranoid_file_checks,
+            cfd_->internal_stats(), &io_s, io_tracer_,
+            BlobFileCreationReason::kFlush, seqno_to_time_mapping_.get(),
+            event_logger_, job_context_->job_id, &table_properties_,
+            write_hint, full_history_ts_low, blob_callback_, base_,
+            &num_input_entries, &memtable_payload_bytes,
+            &memtable_garbage_bytes);
+      } else {
+        // Partitioned flush: partition i covers the user keys in
+        // [partition_boundaries[i - 1], partition_boundaries[i]) and is
+        // written to its own file. The first partition is written to meta_.
+        // Partitions are built by this thread and by helper jobs on the
+        // background pool of this flush's priority; when that pool is busy
+        // this thread builds them all.
+        // All files share meta_'s epoch number, which is fine for L0 files
+        // whose key ranges do not overlap.
+        assert(range_del_iters.empty());
+        const size_t num_partitions = partition_boundaries.size() + 1;
+        std::vector<InternalKey> boundary_keys;
+        boundary_keys.reserve(partition_boundaries.size());
+        for (const std::string& boundary : partition_boundaries) {
+          boundary_keys.emplace_back(boundary, kMaxSequenceNumber,
+                                     kValueTypeForSeek);
+        }
+        std::vector<Slice> boundary_slices;
+        boundary_slices.reserve(boundary_keys.size());
+        for (const InternalKey& boundary_key : boundary_keys) {
+          boundary_slices.push_back(boundary_key.Encode());
+        }
+
+        partition_metas_.resize(num_partitions - 1);
+        partition_table_properties_.resize(num_partitions - 1);
+        std::vector<FileMetaData*> partition_meta(num_partitions);
+        partition_meta[0] = &meta_;
+        for (size_t i = 1; i < num_partitions; ++i) {
+          FileMetaData* pm = &partition_metas_[i - 1];
+          pm->fd = FileDescriptor(versions_->NewFileNumber(), 0, 0);
+          pm->epoch_number = meta_.epoch_number;
+          pm->temperature = meta_.temperature;
+          pm->oldest_ancester_time = meta_.oldest_ancester_time;
+          pm->file_creation_time = meta_.file_creation_time;
+          partition_meta[i] = pm;
+        }
+
+        struct FlushPartitionResult {
+          Status status;
+          IOStatus io_status;
+          std::vector<BlobFileAddition> blob_file_additions;
+          uint64_t num_input_entries = 0;
+          uint64_t memtable_payload_bytes = 0;
+          uint64_t memtable_garbage_bytes = 0;
+        };
+        std::vector<FlushPartitionResult> results(num_partitions);
+
+        auto build_partition = [&](size_t i) {
+          FlushPartitionResult& result = results[i];
+          Arena partition_arena;
+          std::vector<InternalIterator*> partition_memtables;
+          for (MemTable* m : mems_) {
+            partition_memtables.push_back(m->NewIterator(
+                ro, /*seqno_to_time_mapping=*/nullptr, &partition_arena));
+          }
+          ScopedArenaPtr<InternalIterator> partition_iter(NewMergingIterator(
+              &cfd_->internal_comparator(), partition_memtables.data(),
+              static_cast<int>(partition_memtables.size()),
+              &partition_arena));
+          ClippingIterator clipped_iter(
+              partition_iter.get(),
+              i > 0 ? &boundary_slices[i - 1] : nullptr,
+              i + 1 < num_partitions ? &boundary_slices[i] : nullptr,
+              &cfd_->internal_comparator());
+          TableBuilderOptions partition_tboptions(
+              *cfd_->ioptions(), mutable_cf_options_, read_options,
+              write_options, cfd_->internal_comparator(),
+              cfd_->internal_tbl_prop_coll_factories(), output_compression_,
+              mutable_cf_options_.compression_opts, cfd_->GetID(),
+              cfd_->GetName(), 0 /* level */, false /* is_bottommost */,
+              TableFileCreationReason::kFlush, oldest_key_time, current_time,
+              db_id_, db_session_id_, 0 /* target_file_size */,
+              partition_meta[i]->fd.GetNumber());
+          result.status = BuildTable(
+              dbname_, versions_, db_options_, partition_tboptions,
+              file_options_, cfd_->table_cache(), &clipped_iter,
+              {} /* range_del_iters */, partition_meta[i],
+              &result.blob_file_additions, existing_snapshots_,
+              earliest_write_conflict_snapshot_, job_snapshot_seq,
+              snapshot_checker_, mutable_cf_options_.paranoid_file_checks,
+              cfd_->internal_stats(), &result.io_status, io_tracer_,
+              BlobFileCreationReason::kFlush, seqno_to_time_mapping_.get(),
+              event_logger_, job_context_->job_id,
+              i == 0 ? &table_properties_
+                     : &partition_table_properties_[i - 1],
+              write_hint, full_history_ts_low, blob_callback_, base_,
+              &result.num_input_entries, &result.memtable_payload_bytes,
+              &result.memtable_garbage_bytes);
+        };
+
+        ParallelFor(db_options_.env, thread_pri_, num_partitions - 1,
+                    num_partitions, build_partition);
+
+        for (FlushPartitionResult& result : results) {
+          if (s.ok() && !result.status.ok()) {
+            s = result.status;
+          }
+          if (io_s.ok() && !result.io_status.ok()) {
+            io_s = result.io_status;
+          }
+          result.io_status.PermitUncheckedError();
+          num_input_entries += result.num_input_entries;
+          memtable_payload_bytes += result.memtable_payload_bytes;
+          memtable_garbage_bytes += result.memtable_garbage_bytes;
+          for (auto& blob_file_addition : result.blob_file_additions) {
+            blob_file_additions.emplace_back(std::move(blob_file_addition));
+          }
+        }
+      }
       TEST_SYNC_POINT_CALLBACK("FlushJob::WriteLevel0Table:s", &s);
       // TODO: Cleanup io_status in BuildTable and table builders
       assert(!s.ok() || io_s.ok());
@@ -1015,6 +1134,15 @@ Status FlushJob::WriteLevel0Table() {
                      meta_.fd.GetNumber(), meta_.fd.GetFileSize(),
                      s.ToString().c_str(),
                      meta_.marked_for_compaction ? " (needs compaction)" : "");
+    for (const FileMetaData& pm : partition_metas_) {
+      ROCKS_LOG_BUFFER(log_buffer_,
+                       "[%s] [JOB %d] Level-0 flush table #%" PRIu64
+                       ": %" PRIu64 " bytes %s%s",
+                       cfd_->GetName().c_str(), job_context_->job_id,
+                       pm.fd.GetNumber(), pm.fd.GetFileSize(),
+                       s.ToString().c_str(),
+                       pm.marked_for_compaction ? " (needs compaction)" : "");
+    }
 
     if (s.ok() && output_file_directory_ != nullptr && sync_output_directory_) {
       s = output_file_directory_->FsyncWithDirOptions(
@@ -1028,7 +1156,16 @@ Status FlushJob::WriteLevel0Table() {
 
   // Note that if file_size is zero, the file has been deleted and
   // should not be added to the manifest.
-  const bool has_output = meta_.fd.GetFileSize() > 0;
+  std::vector<const FileMetaData*> outputs;
+  if (meta_.fd.GetFileSize() > 0) {
+    outputs.push_back(&meta_);
+  }
+  for (const FileMetaData& pm : partition_metas_) {
+    if (pm.fd.GetFileSize() > 0) {
+      outputs.push_back(&pm);
+    }
+  }
+  const bool has_output = !outputs.empty();
 
   if (s.ok() && has_output) {
     TEST_SYNC_POINT("DBImpl::FlushJob:SSTFileCreated");
@@ -1037,19 +1174,21 @@ Status FlushJob::WriteLevel0Table() {
     // threads could be concurrently producing compacted files for
     // that key range.
     // Add file to L0
-    edit_->AddFile(0 /* level */, meta_.fd.GetNumber(), meta_.fd.GetPathId(),
-                   meta_.fd.GetFileSize(), meta_.smallest, meta_.largest,
-                   meta_.fd.smallest_seqno, meta_.fd.largest_seqno,
-                   meta_.marked_for_compaction, meta_.temperature,
-                   meta_.oldest_blob_file_number, meta_.oldest_ancester_time,
-                   meta_.file_creation_time, meta_.epoch_number,
-                   meta_.file_checksum, meta_.file_checksum_func_name,
-                   meta_.unique_id, meta_.compensated_range_deletion_size,
-                   meta_.tail_size, meta_.user_defined_timestamps_persisted);
+    for (const FileMetaData* out : outputs) {
+      edit_->AddFile(0 /* level */, out->fd.GetNumber(), out->fd.GetPathId(),
+                     out->fd.GetFileSize(), out->smallest, out->largest,
+                     out->fd.smallest_seqno, out->fd.largest_seqno,
+                     out->marked_for_compaction, out->temperature,
+                     out->oldest_blob_file_number, out->oldest_ancester_time,
+                     out->file_creation_time, out->epoch_number,
+                     out->file_checksum, out->file_checksum_func_name,
+                     out->unique_id, out->compensated_range_deletion_size,
+                     out->tail_size, out->user_defined_timestamps_persisted);
+    }
     edit_->SetBlobFileAdditions(std::move(blob_file_additions));
   }
   // Piggyback FlushJobInfo on the first first flushed memtable.
-  mems_[0]->SetFlushJobInfo(GetFlushJobInfo());
+  mems_[0]->SetFlushJobInfos(GetFlushJobInfos());
 
   // Note that here we treat flush as level 0 compaction in internal stats
   InternalStats::CompactionStats stats(CompactionReason::kFlush, 1);
@@ -1064,9 +1203,9 @@ Status FlushJob::WriteLevel0Table() {
                  cfd_->GetName().c_str(), job_context_->job_id, micros,
                  cpu_micros);
 
-  if (has_output) {
-    stats.bytes_written = meta_.fd.GetFileSize();
-    stats.num_output_files = 1;
+  for (const FileMetaData* out : outputs) {
+    stats.bytes_written += out->fd.GetFileSize();
+    ++stats.num_output_files;
   }
 
   const auto& blobs = edit_->GetBlobFileAdditions();
@@ -1086,6 +1225,87 @@ Status FlushJob::WriteLevel0Table() {
   return s;
 }
 
+std::vector<std::string> FlushJob::PickFlushPartitionBoundaries(
+    uint64_t total_num_entries, uint64_t total_num_range_deletes) const {
+  // Partitions smaller than this are not worth a thread and a file.
+  static constexpr uint64_t kMinEntriesPerPartition = 4096;
+  static constexpr uint64_t kSamplesPerPartition = 64;
+
+  std::vector<std::string> boundaries;
+  const uint64_t max_partitions = std::min<uint64_t>(
+      mutable_cf_options_.max_flush_partitions,
+      total_num_entries / kMinEntriesPerPartition);
+  if (max_partitions <= 1 || total_num_range_deletes > 0) {
+    return boundaries;
+  }
+  const Comparator* ucmp = cfd_->user_comparator();
+  if (ucmp->timestamp_size() > 0) {
+    return boundaries;
+  }
+  // Only these reps implement MemTableRep::UniqueRandomSample().
+  const char* rep_name = cfd_->ioptions()->memtable_factory->Name();
+  if (strcmp(rep_name, SkipListFactory::kClassName()) != 0 &&
+      strcmp(rep_name, AdaptiveRadixTreeRepFactory::kClassName()) != 0) {
+    return boundaries;
+  }
+
+  // Sample each memtable in proportion to its number of entries. The
+  // sampled keys point into the memtables, which outlive this flush job.
+  std::vector<Slice> samples;
+  std::unordered_set<const char*> entries;
+  for (MemTable* m : mems_) {
+    const uint64_t target_sample_size =
+        1 + kSamplesPerPartition * max_partitions * m->num_entries() /
+                total_num_entries;
+    entries.clear();
+    m->UniqueRandomSample(target_sample_size, &entries);
+    for (const char* entry : entries) {
+      samples.push_back(ExtractUserKey(GetLengthPrefixedSlice(entry)));
+    }
+  }
+  if (samples.size() < max_partitions) {
+    return boundaries;
+  }
+  std::sort(samples.begin(), samples.end(),
+            [ucmp](const Slice& a, const Slice& b) {
+              return ucmp->Compare(a, b) < 0;
+            });
+
+  std::unique_ptr<SstPartitioner> partitioner;
+  const auto& partitioner_factory = cfd_->ioptions()->sst_partitioner_factory;
+  if (partitioner_factory) {
+    SstPartitioner::Context context;
+    context.is_full_compaction = false;
+    context.is_manual_compaction = false;
+    context.output_level = 0;
+    context.smallest_user_key = samples.front();
+    context.largest_user_key = samples.back();
+    partitioner = partitioner_factory->CreatePartitioner(context);
+  }
+
+  for (uint64_t i = 1; i < max_partitions; ++i) {
+    size_t idx = static_cast<size_t>(samples.size() * i / max_partitions);
+    // Never split the versions of one user key, and with a partitioner only
+    // cut between two sampled keys that it would put in different files.
+    while (idx < samples.size() &&
+           (ucmp->Compare(samples[idx - 1], samples[idx]) == 0 ||
+            (partitioner &&
+             partitioner->ShouldPartition(PartitionerRequest(
+                 samples[idx - 1], samples[idx], 0 /* output_file_size */)) !=
+                 PartitionerResult::kRequired))) {
+      ++idx;
+    }
+    if (idx == samples.size()) {
+      break;
+    }
+    if (boundaries.empty() ||
+        ucmp->Compare(boundaries.back(), samples[idx]) < 0) {
+      boundaries.push_back(samples[idx].ToString());
+    }
+  }
+  return boundaries;
+}
+
 Env::IOPriority FlushJob::GetRateLimiterPriority() {
   if (versions_ && versions_->GetColumnFamilySet() &&
       versions_->GetColumnFamilySet()->write_controller()) {
@@ -1095,28 +1315,48 @@ Env::IOPriority FlushJob::GetRateLimiterPriority() {
       return Env::IO_USER;
     }
   }
+  WriteController* scoped_write_controller = cfd_->scoped_write_controller();
+  if (scoped_write_controller && (scoped_write_controller->IsStopped() ||
+                                  scoped_write_controller->NeedsDelay())) {
+    return Env::IO_USER;
+  }
 
   return Env::IO_HIGH;
 }
 
-std::unique_ptr<FlushJobInfo> FlushJob::GetFlushJobInfo() const {
+std::list<std::unique_ptr<FlushJobInfo>> FlushJob::GetFlushJobInfos() const {
   db_mutex_->AssertHeld();
-  std::unique_ptr<FlushJobInfo> info(new FlushJobInfo{});
-  info->cf_id = cfd_->GetID();
-  info->cf_name = cfd_->GetName();
-
-  const uint64_t file_number = meta_.fd.GetNumber();
-  info->file_path =
-      MakeTableFileName(cfd_->ioptions()->cf_paths[0].path, file_number);
-  info->file_number = file_number;
-  info->oldest_blob_file_number = meta_.oldest_blob_file_number;
-  info->thread_id = db_options_.env->GetThreadID();
-  info->job_id = job_context_->job_id;
-  info->smallest_seqno = meta_.fd.smallest_seqno;
-  info->largest_seqno = meta_.fd.largest_seqno;
-  info->table_properties = table_properties_;
-  info->flush_reason = flush_reason_;
-  info->blob_compression_type = mutable_cf_options_.blob_compression_type;
+  std::list<std::unique_ptr<FlushJobInfo>> infos;
+  auto add_info = [&](const FileMetaData& file_meta,
+                      const TableProperties& table_properties) {
+    std::unique_ptr<FlushJobInfo> info(new FlushJobInfo{});
+    info->cf_id = cfd_->GetID();
+    info->cf_name = cfd_->GetName();
+
+    const uint64_t file_number = file_meta.fd.GetNumber();
+    info->file_path = TableFileName(cfd_->ioptions()->cf_paths, file_number,
+                                    file_meta.fd.GetPathId());
+    info->file_number = file_number;
+    info->oldest_blob_file_number = file_meta.oldest_blob_file_number;
+    info->thread_id = db_options_.env->GetThreadID();
+    info->job_id = job_context_->job_id;
+    info->smallest_seqno = file_meta.fd.smallest_seqno;
+    info->largest_seqno = file_meta.fd.largest_seqno;
+    info->table_properties = table_properties;
+    info->flush_reason = flush_reason_;
+    info->blob_compression_type = mutable_cf_options_.blob_compression_type;
+    infos.push_back(std::move(info));
+  };
+  add_info(meta_, table_properties_);
+  assert(partition_table_properties_.size() == partition_metas_.size());
+  for (size_t i = 0; i < partition_metas_.size(); ++i) {
+    if (partition_metas_[i].fd.GetFileSize() > 0) {
+      add_info(partition_metas_[i], partition_table_properties_[i]);
+    }
+  }
+
+  // Blob files are reported once, with the first table file.
+  FlushJobInfo* info = infos.front().get();
 
   // Update BlobFilesInfo.
   for (const auto& blob_file : edit_->GetBlobFileAdditions()) {
@@ -1128,7 +1368,7 @@ std::unique_ptr<FlushJobInfo> FlushJob::GetFlushJobInfo() const {
     info->blob_file_addition_infos.emplace_back(
         std::move(blob_file_addition_info));
   }
-  return info;
+  return infos;
 }
 
 void FlushJob::GetEffectiveCutoffUDTForPickedMemTables() {
@@ -97,6 +97,13 @@ class FlushJob {
     return &committed_flush_jobs_info_;
   }
 
+  // Output files of a partitioned flush other than the one returned through
+  // Run()'s file_meta. Empty unless the flush was partitioned, see
+  // ColumnFamilyOptions::max_flush_partitions.
+  const std::vector<FileMetaData>& GetPartitionFileMetaData() const {
+    return partition_metas_;
+  }
+
  private:
   friend class FlushJobTest_GetRateLimiterPriorityForWrite_Test;
 
@@ -104,6 +111,10 @@ class FlushJob {
   void ReportFlushInputSize(const autovector<MemTable*>& mems);
   void RecordFlushIOStats();
   Status WriteLevel0Table();
+  // Returns the user keys at which the output of this flush is split into
+  // separate L0 files, or an empty vector if the flush is not partitioned.
+  std::vector<std::string> PickFlushPartitionBoundaries(
+      uint64_t total_num_entries, uint64_t total_num_range_deletes) const;
 
   // Memtable Garbage Collection algorithm: a MemPurge takes the list
   // of immutable memtables and filters out (or "purge") the outdated bytes
@@ -129,7 +140,9 @@ class FlushJob {
   bool MemPurgeDecider(double threshold);
   // The rate limiter priority (io_priority) is determined dynamically here.
   Env::IOPriority GetRateLimiterPriority();
-  std::unique_ptr<FlushJobInfo> GetFlushJobInfo() const;
+  // One FlushJobInfo for meta_ and one for each partition_metas_ entry with
+  // output.
+  std::list<std::unique_ptr<FlushJobInfo>> GetFlushJobInfos() const;
 
   // Require db_mutex held.
   // Called only when UDT feature is enabled and
@@ -197,6 +210,11 @@ class FlushJob {
 
   // Variables below are set by PickMemTable():
   FileMetaData meta_;
+  // Set by WriteLevel0Table() for the partitions after the first one, whose
+  // output is meta_.
+  std::vector<FileMetaData> partition_metas_;
+  // Table properties of the partition_metas_ files, in the same order.
+  std::vector<TableProperties> partition_table_properties_;
   autovector<MemTable*> mems_;
   VersionEdit* edit_;
   Version* base_;
@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <cinttypes>
 #include <cstddef>
+#include <cstring>
 #include <limits>
 #include <sstream>
 #include <string>
@@ -21,6 +22,7 @@
 
 #include "cache/cache_entry_roles.h"
 #include "cache/cache_entry_stats.h"
+#include "cache/quota_cache.h"
 #include "db/column_family.h"
 #include "db/db_impl/db_impl.h"
 #include "db/write_stall_stats.h"
@@ -255,6 +257,7 @@ static const std::string levelstats = "levelstats";
 static const std::string block_cache_entry_stats = "block-cache-entry-stats";
 static const std::string fast_block_cache_entry_stats =
     "fast-block-cache-entry-stats";
+static const std::string block_cache_quota_stats = "block-cache-quota-stats";
 static const std::string num_immutable_mem_table = "num-immutable-mem-table";
 static const std::string num_immutable_mem_table_flushed =
     "num-immutable-mem-table-flushed";
@@ -265,6 +268,12 @@ static const std::string cur_size_active_mem_table =
     "cur-size-active-mem-table";
 static const std::string cur_size_all_mem_tables = "cur-size-all-mem-tables";
 static const std::string size_all_mem_tables = "size-all-mem-tables";
+static const std::string memtable_numa_placed_bytes =
+    "memtable-numa-placed-bytes";
+static const std::string memtable_numa_misplaced_bytes =
+    "memtable-numa-misplaced-bytes";
+static const std::string memtable_hugetlb_bytes = "memtable-hugetlb-bytes";
+static const std::string memtable_thp_bytes = "memtable-thp-bytes";
 static const std::string num_entries_active_mem_table =
     "num-entries-active-mem-table";
 static const std::string num_entries_imm_mem_tables =
@@ -341,6 +350,8 @@ const std::string DB::Properties::kBlockCacheEntryStats =
     rocksdb_prefix + block_cache_entry_stats;
 const std::string DB::Properties::kFastBlockCacheEntryStats =
     rocksdb_prefix + fast_block_cache_entry_stats;
+const std::string DB::Properties::kBlockCacheQuotaStats =
+    rocksdb_prefix + block_cache_quota_stats;
 const std::string DB::Properties::kNumImmutableMemTable =
     rocksdb_prefix + num_immutable_mem_table;
 const std::string DB::Properties::kNumImmutableMemTableFlushed =
@@ -361,6 +372,14 @@ const std::string DB::Properties::kCurSizeAllMemTables =
     rocksdb_prefix + cur_size_all_mem_tables;
 const std::string DB::Properties::kSizeAllMemTables =
     rocksdb_prefix + size_all_mem_tables;
+const std::string DB::Properties::kMemTableNumaPlacedBytes =
+    rocksdb_prefix + memtable_numa_placed_bytes;
+const std::string DB::Properties::kMemTableNumaMisplacedBytes =
+    rocksdb_prefix + memtable_numa_misplaced_bytes;
+const std::string DB::Properties::kMemTableHugeTlbBytes =
+    rocksdb_prefix + memtable_hugetlb_bytes;
+const std::string DB::Properties::kMemTableThpBytes =
+    rocksdb_prefix + memtable_thp_bytes;
 const std::string DB::Properties::kNumEntriesActiveMemTable =
     rocksdb_prefix + num_entries_active_mem_table;
 const std::string DB::Properties::kNumEntriesImmMemTables =
@@ -479,6 +498,9 @@ const UnorderedMap<std::string, DBPropertyInfo>
         {DB::Properties::kFastBlockCacheEntryStats,
          {true, &InternalStats::HandleFastBlockCacheEntryStats, nullptr,
           &InternalStats::HandleFastBlockCacheEntryStatsMap, nullptr}},
+        {DB::Properties::kBlockCacheQuotaStats,
+         {true, &InternalStats::HandleBlockCacheQuotaStats, nullptr,
+          &InternalStats::HandleBlockCacheQuotaStatsMap, nullptr}},
         {DB::Properties::kSSTables,
          {false, &InternalStats::HandleSsTables, nullptr, nullptr, nullptr}},
         {DB::Properties::kAggregatedTableProperties,
@@ -512,6 +534,18 @@ const UnorderedMap<std::string, DBPropertyInfo>
         {DB::Properties::kSizeAllMemTables,
          {false, nullptr, &InternalStats::HandleSizeAllMemTables, nullptr,
           nullptr}},
+        {DB::Properties::kMemTableNumaPlacedBytes,
+         {false, nullptr, &InternalStats::HandleMemTableNumaPlacedBytes,
+          nullptr, nullptr}},
+        {DB::Properties::kMemTableNumaMisplacedBytes,
+         {false, nullptr, &InternalStats::HandleMemTableNumaMisplacedBytes,
+          nullptr, nullptr}},
+        {DB::Properties::kMemTableHugeTlbBytes,
+         {false, nullptr, &InternalStats::HandleMemTableHugeTlbBytes, nullptr,
+          nullptr}},
+        {DB::Properties::kMemTableThpBytes,
+         {false, nullptr, &InternalStats::HandleMemTableThpBytes, nullptr,
+          nullptr}},
         {DB::Properties::kNumEntriesActiveMemTable,
          {false, nullptr, &InternalStats::HandleNumEntriesActiveMemTable,
           nullptr, nullptr}},
@@ -816,6 +850,36 @@ bool InternalStats::HandleFastBlockCacheEntryStatsMap(
   return HandleBlockCacheEntryStatsMapInternal(values, true /* fast */);
 }
 
+bool InternalStats::HandleBlockCacheQuotaStats(std::string* value,
+                                               Slice suffix) {
+  std::map<std::string, std::string> values;
+  if (!HandleBlockCacheQuotaStatsMap(&values, suffix)) {
+    return false;
+  }
+  value->clear();
+  for (const auto& kv : values) {
+    value->append(kv.first);
+    value->append(": ");
+    value->append(kv.second);
+    value->append("\n");
+  }
+  return true;
+}
+
+bool InternalStats::HandleBlockCacheQuotaStatsMap(
+    std::map<std::string, std::string>* values, Slice /*suffix*/) {
+  Cache* block_cache = GetBlockCacheForStats();
+  if (block_cache == nullptr) {
+    return false;
+  }
+  auto* quota_cache = block_cache->CheckedCast<QuotaCache>();
+  if (quota_cache == nullptr) {
+    return false;
+  }
+  quota_cache->GetGroup()->GetQuotaStats(values);
+  return true;
+}
+
 bool InternalStats::HandleLiveSstFilesSizeAtTemperature(std::string* value,
                                                         Slice suffix) {
   uint64_t temperature;
@@ -1297,6 +1361,41 @@ bool InternalStats::HandleSizeAllMemTables(uint64_t* value, DBImpl* /*db*/,
   return true;
 }
 
+bool InternalStats::HandleMemTableNumaPlacedBytes(uint64_t* value,
+                                                  DBImpl* /*db*/,
+                                                  Version* /*version*/) {
+  // Arena bytes of the active and unflushed immutable memtables whose pages
+  // the kernel reported on the requested NUMA node when they were allocated
+  *value = cfd_->mem()->NumaPlacedBytes() +
+           cfd_->imm()->UnflushedMemTablesNumaPlacedBytes();
+  return true;
+}
+
+bool InternalStats::HandleMemTableNumaMisplacedBytes(uint64_t* value,
+                                                     DBImpl* /*db*/,
+                                                     Version* /*version*/) {
+  *value = cfd_->mem()->NumaMisplacedBytes() +
+           cfd_->imm()->UnflushedMemTablesNumaMisplacedBytes();
+  return true;
+}
+
+bool InternalStats::HandleMemTableHugeTlbBytes(uint64_t* value,
+                                               DBImpl* /*db*/,
+                                               Version* /*version*/) {
+  // Arena bytes of the active and unflushed immutable memtables that are
+  // backed by reserved huge pages
+  *value = cfd_->mem()->HugeTlbBytes() +
+           cfd_->imm()->UnflushedMemTablesHugeTlbBytes();
+  return true;
+}
+
+bool InternalStats::HandleMemTableThpBytes(uint64_t* value, DBImpl* /*db*/,
+                                           Version* /*version*/) {
+  *value = cfd_->mem()->TransparentHugePageBytes() +
+           cfd_->imm()->UnflushedMemTablesTransparentHugePageBytes();
+  return true;
+}
+
 bool InternalStats::HandleNumEntriesActiveMemTable(uint64_t* value,
                                                    DBImpl* /*db*/,
                                                    Version* /*version*/) {
@@ -1876,6 +1975,11 @@ void InternalStats::DumpCFMapStatsWriteStall(
       std::to_string(
           cf_stats_count_[L0_FILE_COUNT_LIMIT_STOPS_WITH_ONGOING_COMPACTION]);
 
+  (*value)[WriteStallStatsMapKeys::CFScopedWriteStalls()] =
+      std::to_string(cf_stats_count_[SCOPED_WRITE_STALL_MICROS]);
+  (*value)[WriteStallStatsMapKeys::CFScopedWriteStallMicros()] =
+      std::to_string(cf_stats_value_[SCOPED_WRITE_STALL_MICROS]);
+
   (*value)[WriteStallStatsMapKeys::TotalStops()] = std::to_string(total_stops);
   (*value)[WriteStallStatsMapKeys::TotalDelays()] =
       std::to_string(total_delays);
@@ -123,6 +123,10 @@ class InternalStats {
     INGESTED_NUM_FILES_TOTAL,
     INGESTED_LEVEL0_NUM_FILES_TOTAL,
     INGESTED_NUM_KEYS_TOTAL,
+    // Writes stopped or delayed by this column family alone (see
+    // DBOptions::write_stall_per_column_family); the value is the time they
+    // spent stalled.
+    SCOPED_WRITE_STALL_MICROS,
     INTERNAL_CF_STATS_ENUM_MAX,
   };
 
@@ -798,6 +802,13 @@ class InternalStats {
                                    Version* version);
   bool HandleCurSizeAllMemTables(uint64_t* value, DBImpl* db, Version* version);
   bool HandleSizeAllMemTables(uint64_t* value, DBImpl* db, Version* version);
+  bool HandleMemTableNumaPlacedBytes(uint64_t* value, DBImpl* db,
+                                     Version* version);
+  bool HandleMemTableNumaMisplacedBytes(uint64_t* value, DBImpl* db,
+                                        Version* version);
+  bool HandleMemTableHugeTlbBytes(uint64_t* value, DBImpl* db,
+                                  Version* version);
+  bool HandleMemTableThpBytes(uint64_t* value, DBImpl* db, Version* version);
   bool HandleNumEntriesActiveMemTable(uint64_t* value, DBImpl* db,
                                       Version* version);
   bool HandleNumEntriesImmMemTables(uint64_t* value, DBImpl* db,
@@ -848,6 +859,9 @@ class InternalStats {
   bool HandleFastBlockCacheEntryStats(std::string* value, Slice suffix);
   bool HandleFastBlockCacheEntryStatsMap(
       std::map<std::string, std::string>* values, Slice suffix);
+  bool HandleBlockCacheQuotaStats(std::string* value, Slice suffix);
+  bool HandleBlockCacheQuotaStatsMap(
+      std::map<std::string, std::string>* values, Slice suffix);
   bool HandleLiveSstFilesSizeAtTemperature(std::string* value, Slice suffix);
   bool HandleNumBlobFiles(uint64_t* value, DBImpl* db, Version* version);
   bool HandleBlobStats(std::string* value, Slice suffix);
@@ -39,8 +39,15 @@ enum RecordType {
   // User-defined timestamp sizes
   kUserDefinedTimestampSizeType = 10,
   kRecyclableUserDefinedTimestampSizeType = 11,
+
+  // Log numbers of the other shards of a sharded WAL generation. Older
+  // releases do not know these types and report them as corruption.
+  kWalShardsType = 12,
+  // Log number of the primary log of the sharded WAL generation this shard
+  // log belongs to
+  kWalShardOfType = 13,
 };
-constexpr int kMaxRecordType = kRecyclableUserDefinedTimestampSizeType;
+constexpr int kMaxRecordType = kWalShardOfType;
 
 constexpr unsigned int kBlockSize = 32768;
 
@@ -211,6 +211,38 @@ bool Reader::ReadRecord(Slice* record, std::string* scratch,
         break;
       }
 
+      case kWalShardsType: {
+        if (first_record_read_ || !wal_shard_log_numbers_.empty()) {
+          ReportCorruption(fragment.size(),
+                           "WalShards record not before the first record");
+        }
+        prospective_record_offset = physical_record_offset;
+        scratch->clear();
+        last_record_offset_ = prospective_record_offset;
+        size_t fragment_size = fragment.size();
+        Status s = DecodeWalShardsRecord(&fragment);
+        if (!s.ok()) {
+          ReportCorruption(fragment_size, s.getState());
+        }
+        break;
+      }
+
+      case kWalShardOfType: {
+        if (first_record_read_ || wal_shard_primary_log_number_ != 0) {
+          ReportCorruption(fragment.size(),
+                           "WalShardOf record not before the first record");
+        }
+        prospective_record_offset = physical_record_offset;
+        scratch->clear();
+        last_record_offset_ = prospective_record_offset;
+        size_t fragment_size = fragment.size();
+        Status s = DecodeWalShardOfRecord(&fragment);
+        if (!s.ok()) {
+          ReportCorruption(fragment_size, s.getState());
+        }
+        break;
+      }
+
       case kBadHeader:
         if (wal_recovery_mode == WALRecoveryMode::kAbsoluteConsistency ||
             wal_recovery_mode == WALRecoveryMode::kPointInTimeRecovery) {
@@ -548,7 +580,8 @@ unsigned int Reader::ReadPhysicalRecord(Slice* result, size_t* drop_size,
 
     if (!uncompress_ || type == kSetCompressionType ||
         type == kUserDefinedTimestampSizeType ||
-        type == kRecyclableUserDefinedTimestampSizeType) {
+        type == kRecyclableUserDefinedTimestampSizeType ||
+        type == kWalShardsType || type == kWalShardOfType) {
       *result = Slice(header + header_size, length);
       return type;
     } else {
@@ -635,6 +668,34 @@ Status Reader::UpdateRecordedTimestampSize(
   return Status::OK();
 }
 
+Status Reader::DecodeWalShardsRecord(Slice* fragment) {
+  uint32_t num_shards = 0;
+  if (!GetVarint32(fragment, &num_shards)) {
+    return Status::Corruption("could not decode WalShards record");
+  }
+  std::vector<uint64_t> numbers;
+  numbers.reserve(num_shards);
+  for (uint32_t i = 0; i < num_shards; ++i) {
+    uint64_t number = 0;
+    if (!GetVarint64(fragment, &number) || number <= log_number_) {
+      return Status::Corruption("could not decode WalShards record");
+    }
+    numbers.push_back(number);
+  }
+  wal_shard_log_numbers_ = std::move(numbers);
+  return Status::OK();
+}
+
+Status Reader::DecodeWalShardOfRecord(Slice* fragment) {
+  uint64_t primary_log_number = 0;
+  if (!GetVarint64(fragment, &primary_log_number) ||
+      primary_log_number == 0 || primary_log_number >= log_number_) {
+    return Status::Corruption("could not decode WalShardOf record");
+  }
+  wal_shard_primary_log_number_ = primary_log_number;
+  return Status::OK();
+}
+
 bool FragmentBufferedReader::ReadRecord(Slice* record, std::string* scratch,
                                         WALRecoveryMode /*unused*/,
                                         uint64_t* /* checksum */) {
@@ -754,6 +815,40 @@ bool FragmentBufferedReader::ReadRecord(Slice* record, std::string* scratch,
         break;
       }
 
+      case kWalShardsType: {
+        if (first_record_read_ || !wal_shard_log_numbers_.empty()) {
+          ReportCorruption(fragment.size(),
+                           "WalShards record not before the first record");
+        }
+        fragments_.clear();
+        prospective_record_offset = physical_record_offset;
+        last_record_offset_ = prospective_record_offset;
+        in_fragmented_record_ = false;
+        size_t fragment_size = fragment.size();
+        Status s = DecodeWalShardsRecord(&fragment);
+        if (!s.ok()) {
+          ReportCorruption(fragment_size, s.getState());
+        }
+        break;
+      }
+
+      case kWalShardOfType: {
+        if (first_record_read_ || wal_shard_primary_log_number_ != 0) {
+          ReportCorruption(fragment.size(),
+                           "WalShardOf record not before the first record");
+        }
+        fragments_.clear();
+        prospective_record_offset = physical_record_offset;
+        last_record_offset_ = prospective_record_offset;
+        in_fragmented_record_ = false;
+        size_t fragment_size = fragment.size();
+        Status s = DecodeWalShardOfRecord(&fragment);
+        if (!s.ok()) {
+          ReportCorruption(fragment_size, s.getState());
+        }
+        break;
+      }
+
       case kBadHeader:
       case kBadRecord:
       case kEof:
@@ -920,7 +1015,8 @@ bool FragmentBufferedReader::TryReadFragment(
 
   if (!uncompress_ || type == kSetCompressionType ||
       type == kUserDefinedTimestampSizeType ||
-      type == kRecyclableUserDefinedTimestampSizeType) {
+      type == kRecyclableUserDefinedTimestampSizeType ||
+      type == kWalShardsType || type == kWalShardOfType) {
     *fragment = Slice(header + header_size, length);
     *fragment_type_or_err = type;
     return true;
@@ -86,6 +86,20 @@ class Reader {
     return recorded_cf_to_ts_sz_;
   }
 
+  // Return the log numbers of the other shards of this WAL generation, as
+  // announced by a kWalShardsType record. Empty if the log is not sharded or
+  // the record has not been read yet. This only applies to WAL logs.
+  const std::vector<uint64_t>& GetWalShardLogNumbers() const {
+    return wal_shard_log_numbers_;
+  }
+
+  // Return the log number of the primary log of the WAL generation this
+  // shard log belongs to, as announced by a kWalShardOfType record. Zero if
+  // the log is not a shard log or the record has not been read yet.
+  uint64_t GetWalShardPrimaryLogNumber() const {
+    return wal_shard_primary_log_number_;
+  }
+
   // Returns the physical offset of the last record returned by ReadRecord.
   //
   // Undefined before the first call to ReadRecord.
@@ -170,6 +184,12 @@ class Reader {
   // is only for WAL logs.
   UnorderedMap<uint32_t, size_t> recorded_cf_to_ts_sz_;
 
+  // The log numbers announced by the kWalShardsType record, if any.
+  std::vector<uint64_t> wal_shard_log_numbers_;
+
+  // The primary log number announced by the kWalShardOfType record, if any.
+  uint64_t wal_shard_primary_log_number_ = 0;
+
   // Extend record types with the following special values
   enum {
     kEof = kMaxRecordType + 1,
@@ -210,6 +230,12 @@ class Reader {
 
   Status UpdateRecordedTimestampSize(
       const std::vector<std::pair<uint32_t, size_t>>& cf_to_ts_sz);
+
+  // Decodes a kWalShardsType record into `wal_shard_log_numbers_`.
+  Status DecodeWalShardsRecord(Slice* fragment);
+
+  // Decodes a kWalShardOfType record into `wal_shard_primary_log_number_`.
+  Status DecodeWalShardOfRecord(Slice* fragment);
 };
 
 class FragmentBufferedReader : public Reader {
@@ -9,11 +9,13 @@
 
 #include "db/log_writer.h"
 
+#include <algorithm>
 #include <cstdint>
 
 #include "file/writable_file_writer.h"
 #include "rocksdb/env.h"
 #include "rocksdb/io_status.h"
+#include "util/autovector.h"
 #include "util/coding.h"
 #include "util/crc32c.h"
 #include "util/udt_util.h"
@@ -74,17 +76,39 @@ IOStatus Writer::Close(const WriteOptions& write_options) {
 
 IOStatus Writer::AddRecord(const WriteOptions& write_options,
                            const Slice& slice) {
+  return AddRecord(write_options, SliceParts(&slice, 1));
+}
+
+IOStatus Writer::AddRecord(const WriteOptions& write_options,
+                           const SliceParts& record) {
   if (dest_->seen_error()) {
     return IOStatus::IOError("Seen error. Skip writing buffer.");
   }
-  const char* ptr = slice.data();
-  size_t left = slice.size();
+  std::string contiguous_buf;
+  Slice contiguous;
+  const Slice* parts = record.parts;
+  size_t num_parts = static_cast<size_t>(record.num_parts);
+  if (compress_ && num_parts != 1) {
+    // Streaming compression takes the record in one piece.
+    contiguous = Slice(record, &contiguous_buf);
+    parts = &contiguous;
+    num_parts = 1;
+  }
+  const char* ptr = nullptr;
+  size_t left = 0;
+  for (size_t i = 0; i < num_parts; ++i) {
+    left += parts[i].size();
+  }
+  // Position of the next uncompressed byte to emit
+  size_t part_idx = 0;
+  size_t part_offset = 0;
+  std::vector<Slice> fragments;
 
   // Header size varies depending on whether we are recycling or not.
   const int header_size =
       recycle_log_files_ ? kRecyclableHeaderSize : kHeaderSize;
 
-  // Fragment the record if necessary and emit it.  Note that if slice
+  // Fragment the record if necessary and emit it.  Note that if record
   // is empty, we still want to iterate once to emit a single
   // zero-length record
   bool begin = true;
@@ -130,7 +154,7 @@ IOStatus Writer::AddRecord(const WriteOptions& write_options,
       // physical records (left=0).
       if (compress_ && (compress_start || left == 0)) {
         compress_remaining = compress_->Compress(
-            slice.data(), slice.size(), compressed_buffer_.get(), &left);
+            parts[0].data(), parts[0].size(), compressed_buffer_.get(), &left);
 
         if (compress_remaining < 0) {
           // Set failure status
@@ -161,8 +185,31 @@ IOStatus Writer::AddRecord(const WriteOptions& write_options,
         type = recycle_log_files_ ? kRecyclableMiddleType : kMiddleType;
       }
 
-      s = EmitPhysicalRecord(write_options, type, ptr, fragment_length);
-      ptr += fragment_length;
+      if (compress_) {
+        s = EmitPhysicalRecord(write_options, type, ptr, fragment_length);
+        ptr += fragment_length;
+      } else if (num_parts == 1) {
+        s = EmitPhysicalRecord(write_options, type,
+                               parts[0].data() + part_offset, fragment_length);
+        part_offset += fragment_length;
+      } else {
+        fragments.clear();
+        size_t needed = fragment_length;
+        while (needed > 0) {
+          assert(part_idx < num_parts);
+          const Slice& part = parts[part_idx];
+          const size_t n = std::min(needed, part.size() - part_offset);
+          fragments.emplace_back(part.data() + part_offset, n);
+          needed -= n;
+          part_offset += n;
+          if (part_offset == part.size()) {
+            ++part_idx;
+            part_offset = 0;
+          }
+        }
+        s = EmitPhysicalRecord(write_options, type, fragments.data(),
+                               fragments.size(), fragment_length);
+      }
       left -= fragment_length;
       begin = false;
     } while (s.ok() && (left > 0 || compress_remaining > 0));
@@ -248,10 +295,63 @@ IOStatus Writer::MaybeAddUserDefinedTimestampSizeRecord(
                             encoded.size());
 }
 
+IOStatus Writer::AddWalShardsRecord(
+    const WriteOptions& write_options,
+    const std::vector<uint64_t>& shard_log_numbers) {
+  assert(!recycle_log_files_);
+  if (dest_->seen_error()) {
+    return IOStatus::IOError("Seen error. Skip writing buffer.");
+  }
+  std::string encoded;
+  PutVarint32(&encoded, static_cast<uint32_t>(shard_log_numbers.size()));
+  for (uint64_t number : shard_log_numbers) {
+    PutVarint64(&encoded, number);
+  }
+  assert(block_offset_ + kHeaderSize + encoded.size() <= kBlockSize);
+  IOStatus s = EmitPhysicalRecord(write_options, kWalShardsType,
+                                  encoded.data(), encoded.size());
+  if (s.ok() && !manual_flush_) {
+    IOOptions io_opts;
+    s = WritableFileWriter::PrepareIOOptions(write_options, io_opts);
+    if (s.ok()) {
+      s = dest_->Flush(io_opts);
+    }
+  }
+  return s;
+}
+
+IOStatus Writer::AddWalShardOfRecord(const WriteOptions& write_options,
+                                     uint64_t primary_log_number) {
+  assert(!recycle_log_files_);
+  if (dest_->seen_error()) {
+    return IOStatus::IOError("Seen error. Skip writing buffer.");
+  }
+  std::string encoded;
+  PutVarint64(&encoded, primary_log_number);
+  assert(block_offset_ + kHeaderSize + encoded.size() <= kBlockSize);
+  IOStatus s = EmitPhysicalRecord(write_options, kWalShardOfType,
+                                  encoded.data(), encoded.size());
+  if (s.ok() && !manual_flush_) {
+    IOOptions io_opts;
+    s = WritableFileWriter::PrepareIOOptions(write_options, io_opts);
+    if (s.ok()) {
+      s = dest_->Flush(io_opts);
+    }
+  }
+  return s;
+}
+
 bool Writer::BufferIsEmpty() { return dest_->BufferIsEmpty(); }
 
 IOStatus Writer::EmitPhysicalRecord(const WriteOptions& write_options,
                                     RecordType t, const char* ptr, size_t n) {
+  const Slice payload(ptr, n);
+  return EmitPhysicalRecord(write_options, t, &payload, 1, n);
+}
+
+IOStatus Writer::EmitPhysicalRecord(const WriteOptions& write_options,
+                                    RecordType t, const Slice* fragments,
+                                    size_t num_fragments, size_t n) {
   assert(n <= 0xffff);  // Must fit in two bytes
 
   size_t header_size;
@@ -264,7 +364,8 @@ IOStatus Writer::EmitPhysicalRecord(const WriteOptions& write_options,
 
   uint32_t crc = type_crc_[t];
   if (t < kRecyclableFullType || t == kSetCompressionType ||
-      t == kUserDefinedTimestampSizeType) {
+      t == kUserDefinedTimestampSizeType || t == kWalShardsType ||
+      t == kWalShardOfType) {
     // Legacy record format
     assert(block_offset_ + kHeaderSize + n <= kBlockSize);
     header_size = kHeaderSize;
@@ -283,7 +384,15 @@ IOStatus Writer::EmitPhysicalRecord(const WriteOptions& write_options,
   }
 
   // Compute the crc of the record type and the payload.
-  uint32_t payload_crc = crc32c::Value(ptr, n);
+  autovector<uint32_t, 4> fragment_crcs;
+  uint32_t payload_crc = 0;
+  for (size_t i = 0; i < num_fragments; ++i) {
+    const Slice& fragment = fragments[i];
+    fragment_crcs.push_back(crc32c::Value(fragment.data(), fragment.size()));
+    payload_crc = i == 0 ? fragment_crcs[0]
+                         : crc32c::Crc32cCombine(payload_crc, fragment_crcs[i],
+                                                 fragment.size());
+  }
   crc = crc32c::Crc32cCombine(crc, payload_crc, n);
   crc = crc32c::Mask(crc);  // Adjust for storage
   TEST_SYNC_POINT_CALLBACK("LogWriter::EmitPhysicalRecord:BeforeEncodeChecksum",
@@ -296,8 +405,8 @@ IOStatus Writer::EmitPhysicalRecord(const WriteOptions& write_options,
   if (s.ok()) {
     s = dest_->Append(opts, Slice(buf, header_size), 0 /* crc32c_checksum */);
   }
-  if (s.ok()) {
-    s = dest_->Append(opts, Slice(ptr, n), payload_crc);
+  for (size_t i = 0; s.ok() && i < num_fragments; ++i) {
+    s = dest_->Append(opts, fragments[i], fragment_crcs[i]);
   }
   block_offset_ += header_size + n;
   return s;
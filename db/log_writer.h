@@ -87,6 +87,10 @@ class Writer {
   ~Writer();
 
   IOStatus AddRecord(const WriteOptions& write_options, const Slice& slice);
+  // Adds the concatenation of the parts of `record` as one record, copying
+  // the parts straight into the file's buffer.
+  IOStatus AddRecord(const WriteOptions& write_options,
+                     const SliceParts& record);
   IOStatus AddCompressionTypeRecord(const WriteOptions& write_options);
 
   // If there are column families in `cf_to_ts_sz` not included in
@@ -98,6 +102,18 @@ class Writer {
       const WriteOptions& write_options,
       const UnorderedMap<uint32_t, size_t>& cf_to_ts_sz);
 
+  // Adds a record of type kWalShardsType listing the log numbers of the other
+  // shard logs that belong to the same WAL generation as this log. Must be
+  // added before any data record, right after the compression type record.
+  IOStatus AddWalShardsRecord(const WriteOptions& write_options,
+                              const std::vector<uint64_t>& shard_log_numbers);
+
+  // Adds a record of type kWalShardOfType naming the primary log of the WAL
+  // generation this shard log belongs to, so recovery can tell a shard log
+  // whose primary log is gone. Same placement rules as AddWalShardsRecord.
+  IOStatus AddWalShardOfRecord(const WriteOptions& write_options,
+                               uint64_t primary_log_number);
+
   WritableFileWriter* file() { return dest_.get(); }
   const WritableFileWriter* file() const { return dest_.get(); }
 
@@ -122,6 +138,11 @@ class Writer {
 
   IOStatus EmitPhysicalRecord(const WriteOptions& write_options,
                               RecordType type, const char* ptr, size_t length);
+  // Emits the concatenation of `fragments`, `length` bytes in total, as one
+  // physical record.
+  IOStatus EmitPhysicalRecord(const WriteOptions& write_options,
+                              RecordType type, const Slice* fragments,
+                              size_t num_fragments, size_t length);
 
   // If true, it does not flush after each write. Instead it relies on the upper
   // layer to manually does the flush by calling ::WriteBuffer()
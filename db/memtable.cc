@@ -86,7 +86,9 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
                write_buffer_manager->cost_to_cache()))
                  ? &mem_tracker_
                  : nullptr,
-             mutable_cf_options.memtable_huge_page_size),
+             mutable_cf_options.memtable_huge_page_size,
+             ioptions.memtable_numa_aware,
+             ioptions.memtable_huge_page_pool.get()),
       table_(ioptions.memtable_factory->CreateMemTableRep(
           comparator_, &arena_, mutable_cf_options.prefix_extractor.get(),
           ioptions.logger, column_family_id)),
@@ -721,7 +723,8 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
                      const Slice& value,
                      const ProtectionInfoKVOS64* kv_prot_info,
                      bool allow_concurrent,
-                     MemTablePostProcessInfo* post_process_info, void** hint) {
+                     MemTablePostProcessInfo* post_process_info, void** hint,
+                     std::vector<KeyHandle>* batched_keys) {
   // Format of an entry is concatenation of:
   //  key_size     : varint32 of internal_key.size()
   //  key bytes    : char[internal_key.size()]
@@ -764,11 +767,18 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
 
   Slice key_without_ts = StripTimestampFromUserKey(key, ts_sz_);
 
+  // Batched inserts are for point key table (`table_`) only, and are done by
+  // InsertBatch().
+  const bool batched = batched_keys != nullptr && table == table_;
+
   if (!allow_concurrent) {
     // Extract prefix for insert with hint. Hints are for point key table
     // (`table_`) only, not `range_del_table_`.
-    if (table == table_ && insert_with_hint_prefix_extractor_ != nullptr &&
-        insert_with_hint_prefix_extractor_->InDomain(key_slice)) {
+    if (batched) {
+      batched_keys->push_back(handle);
+    } else if (table == table_ &&
+               insert_with_hint_prefix_extractor_ != nullptr &&
+               insert_with_hint_prefix_extractor_->InDomain(key_slice)) {
       Slice prefix = insert_with_hint_prefix_extractor_->Transform(key_slice);
       bool res = table->InsertKeyWithHint(handle, &insert_hints_[prefix]);
       if (UNLIKELY(!res)) {
@@ -821,11 +831,15 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
     MaybeUpdateNewestUDT(key_slice);
     UpdateFlushState();
   } else {
-    bool res = (hint == nullptr)
-                   ? table->InsertKeyConcurrently(handle)
-                   : table->InsertKeyWithHintConcurrently(handle, hint);
-    if (UNLIKELY(!res)) {
-      return Status::TryAgain("key+seq exists");
+    if (batched) {
+      batched_keys->push_back(handle);
+    } else {
+      bool res = (hint == nullptr)
+                     ? table->InsertKeyConcurrently(handle)
+                     : table->InsertKeyWithHintConcurrently(handle, hint);
+      if (UNLIKELY(!res)) {
+        return Status::TryAgain("key+seq exists");
+      }
     }
 
     assert(post_process_info != nullptr);
@@ -891,6 +905,20 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
   return Status::OK();
 }
 
+void MemTable::InsertBatch(std::vector<KeyHandle>* batched_keys,
+                           bool allow_concurrent) {
+  if (batched_keys->empty()) {
+    return;
+  }
+  if (allow_concurrent) {
+    table_->InsertBatchConcurrently(batched_keys->data(),
+                                    batched_keys->size());
+  } else {
+    table_->InsertBatch(batched_keys->data(), batched_keys->size());
+  }
+  batched_keys->clear();
+}
+
 // Callback from MemTable::Get()
 namespace {
 
@@ -11,6 +11,7 @@
 #include <atomic>
 #include <deque>
 #include <functional>
+#include <list>
 #include <memory>
 #include <string>
 #include <unordered_set>
@@ -158,6 +159,20 @@ class MemTable {
            arena_.MemoryAllocatedBytes();
   }
 
+  // Bytes of arena blocks whose pages were on the NUMA node requested for
+  // them, respectively on another node, when they were allocated. See
+  // DBOptions::memtable_numa_aware.
+  size_t NumaPlacedBytes() const { return arena_.NumaPlacedBytes(); }
+  size_t NumaMisplacedBytes() const { return arena_.NumaMisplacedBytes(); }
+
+  // Bytes of arena blocks backed by reserved huge pages, respectively
+  // advised to use transparent huge pages. See
+  // ColumnFamilyOptions::memtable_huge_page_size.
+  size_t HugeTlbBytes() const { return arena_.HugeTlbBytes(); }
+  size_t TransparentHugePageBytes() const {
+    return arena_.TransparentHugePageBytes();
+  }
+
   // Returns a vector of unique random memtable entries of size 'sample_size'.
   //
   // Note: the entries are stored in the unordered_set as length-prefixed keys,
@@ -238,11 +253,26 @@ class MemTable {
   // Returns `Status::TryAgain` if the `seq`, `key` combination already exists
   // in the memtable and `MemTableRepFactory::CanHandleDuplicatedKey()` is true.
   // The next attempt should try a larger value for `seq`.
+  //
+  // If `batched_keys` is not null and the entry is a point key, the entry is
+  // encoded and accounted for, but its handle is appended to `*batched_keys`
+  // instead of being inserted; the caller must pass them to InsertBatch()
+  // before the entry is read from the memtable. Such entries are not checked
+  // for duplicates.
   Status Add(SequenceNumber seq, ValueType type, const Slice& key,
              const Slice& value, const ProtectionInfoKVOS64* kv_prot_info,
              bool allow_concurrent = false,
              MemTablePostProcessInfo* post_process_info = nullptr,
-             void** hint = nullptr);
+             void** hint = nullptr,
+             std::vector<KeyHandle>* batched_keys = nullptr);
+
+  // Inserts the point keys deferred by Add() into the memtable in one go,
+  // which lets the memtable rep sort them and reuse its search position from
+  // one key to the next, and clears `*batched_keys`.
+  //
+  // REQUIRES: if allow_concurrent = false, external synchronization to prevent
+  // simultaneous operations on the same MemTable.
+  void InsertBatch(std::vector<KeyHandle>* batched_keys, bool allow_concurrent);
 
   // Used to Get value associated with key or Get Merge Operands associated
   // with key.
@@ -523,12 +553,13 @@ class MemTable {
     flush_in_progress_ = in_progress;
   }
 
-  void SetFlushJobInfo(std::unique_ptr<FlushJobInfo>&& info) {
-    flush_job_info_ = std::move(info);
+  void SetFlushJobInfos(std::list<std::unique_ptr<FlushJobInfo>>&& infos) {
+    flush_job_infos_ = std::move(infos);
   }
 
-  std::unique_ptr<FlushJobInfo> ReleaseFlushJobInfo() {
-    return std::move(flush_job_info_);
+  // Moves the flush job infos set by SetFlushJobInfos() to the end of *out.
+  void ReleaseFlushJobInfos(std::list<std::unique_ptr<FlushJobInfo>>* out) {
+    out->splice(out->end(), flush_job_infos_);
   }
 
   // Returns a heuristic flush decision
@@ -651,8 +682,8 @@ class MemTable {
   // unlimited.
   uint32_t memtable_max_range_deletions_ = 0;
 
-  // Flush job info of the current memtable.
-  std::unique_ptr<FlushJobInfo> flush_job_info_;
+  // Flush job infos of the current memtable, one per output table file.
+  std::list<std::unique_ptr<FlushJobInfo>> flush_job_infos_;
 
   // Size in bytes for the user-defined timestamps.
   size_t ts_sz_;
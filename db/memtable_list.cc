@@ -570,10 +570,7 @@ Status MemTableList::TryInstallMemtableFlushResults(
 
         edit_list.push_back(&m->edit_);
         memtables_to_flush.push_back(m);
-        std::unique_ptr<FlushJobInfo> info = m->ReleaseFlushJobInfo();
-        if (info != nullptr) {
-          committed_flush_jobs_info->push_back(std::move(info));
-        }
+        m->ReleaseFlushJobInfos(committed_flush_jobs_info);
       }
       batch_count++;
     }
@@ -681,6 +678,38 @@ size_t MemTableList::ApproximateUnflushedMemTablesMemoryUsage() {
   return total_size;
 }
 
+size_t MemTableList::UnflushedMemTablesNumaPlacedBytes() {
+  size_t total_size = 0;
+  for (auto& memtable : current_->memlist_) {
+    total_size += memtable->NumaPlacedBytes();
+  }
+  return total_size;
+}
+
+size_t MemTableList::UnflushedMemTablesNumaMisplacedBytes() {
+  size_t total_size = 0;
+  for (auto& memtable : current_->memlist_) {
+    total_size += memtable->NumaMisplacedBytes();
+  }
+  return total_size;
+}
+
+size_t MemTableList::UnflushedMemTablesHugeTlbBytes() {
+  size_t total_size = 0;
+  for (auto& memtable : current_->memlist_) {
+    total_size += memtable->HugeTlbBytes();
+  }
+  return total_size;
+}
+
+size_t MemTableList::UnflushedMemTablesTransparentHugePageBytes() {
+  size_t total_size = 0;
+  for (auto& memtable : current_->memlist_) {
+    total_size += memtable->TransparentHugePageBytes();
+  }
+  return total_size;
+}
+
 size_t MemTableList::ApproximateMemoryUsage() { return current_memory_usage_; }
 
 size_t MemTableList::MemoryAllocatedBytesExcludingLast() const {
@@ -868,9 +897,7 @@ Status InstallMemtableAtomicFlushResults(
     if (committed_flush_jobs_info[k]) {
       assert(!mems_list[k]->empty());
       assert((*mems_list[k])[0]);
-      std::unique_ptr<FlushJobInfo> flush_job_info =
-          (*mems_list[k])[0]->ReleaseFlushJobInfo();
-      committed_flush_jobs_info[k]->push_back(std::move(flush_job_info));
+      (*mems_list[k])[0]->ReleaseFlushJobInfos(committed_flush_jobs_info[k]);
     }
   }
 
@@ -332,6 +332,16 @@ class MemTableList {
   // the unflushed mem-tables.
   size_t ApproximateUnflushedMemTablesMemoryUsage();
 
+  // Returns the NUMA-local (respectively remote) arena bytes of the
+  // unflushed mem-tables.
+  size_t UnflushedMemTablesNumaPlacedBytes();
+  size_t UnflushedMemTablesNumaMisplacedBytes();
+
+  // Returns the arena bytes of the unflushed mem-tables that are backed by
+  // reserved huge pages, respectively advised to use transparent huge pages.
+  size_t UnflushedMemTablesHugeTlbBytes();
+  size_t UnflushedMemTablesTransparentHugePageBytes();
+
   // Returns an estimate of the timestamp of the earliest key.
   uint64_t ApproximateOldestKeyTime() const;
 
@@ -34,10 +34,12 @@ DEFINE_SYNC_AND_ASYNC(Status, TableCache::MultiGet)
   size_t row_cache_key_prefix_size = 0;
   KeyContext& first_key = *table_range.begin();
   bool lookup_row_cache =
-      ioptions_.row_cache && !first_key.get_context->NeedToReadSequence();
+      ioptions_.row_cache && !first_key.get_context->NeedToReadSequence() &&
+      !(options.column_projection && first_key.get_context->NeedColumns());
 
   // Check row cache if enabled. Since row cache does not currently store
   // sequence numbers, we cannot use it if we need to fetch the sequence.
+  // Nor entities read with a column projection, which may be incomplete.
   if (lookup_row_cache) {
     GetContext* first_context = first_key.get_context;
     CreateRowCacheKeyPrefix(options, fd, first_key.ikey, first_context,
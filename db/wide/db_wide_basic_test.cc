@@ -3,11 +3,14 @@
 //  COPYING file in the root directory) and Apache 2.0 License
 //  (found in the LICENSE.Apache file in the root directory).
 
+#include <algorithm>
 #include <array>
 #include <cctype>
+#include <deque>
 #include <memory>
 
 #include "db/db_test_util.h"
+#include "db/wide/wide_columns_helper.h"
 #include "port/stack_trace.h"
 #include "test_util/testutil.h"
 #include "util/overload.h"
@@ -1794,6 +1797,185 @@ TEST_F(DBWideBasicTest, PinnableWideColumnsMove) {
   test_move(/* fill_cache*/ true);
 }
 
+TEST_F(DBWideBasicTest, ColumnarEntityBlocks) {
+  Options options = GetDefaultOptions();
+  options.create_if_missing = true;
+  options.disable_auto_compactions = true;
+
+  BlockBasedTableOptions table_options;
+  table_options.columnar_entity_blocks = true;
+  table_options.format_version = 6;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+
+  table_options.format_version = 7;
+  // Small blocks, so that entities are spread over several column sections.
+  table_options.block_size = 1024;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // Even keys are entities, every fourth one with a default column; odd keys
+  // are plain values.
+  constexpr int num_keys = 200;
+  // Backs the column values.
+  std::deque<std::string> values;
+  auto expected_columns = [&values](int i) {
+    const std::string suffix = std::to_string(i);
+    WideColumns columns;
+    if (i % 2 == 1) {
+      values.push_back("plain" + suffix);
+      columns.emplace_back(kDefaultWideColumnName, values.back());
+      return columns;
+    }
+    if (i % 4 == 0) {
+      values.push_back("dflt" + suffix);
+      columns.emplace_back(kDefaultWideColumnName, values.back());
+    }
+    values.push_back("a" + suffix);
+    columns.emplace_back("a", values.back());
+    if (i % 3 != 0) {
+      values.push_back("b" + suffix);
+      columns.emplace_back("b", values.back());
+    }
+    values.push_back(std::string(20, static_cast<char>('c' + i % 7)));
+    columns.emplace_back("c", values.back());
+    return columns;
+  };
+  std::vector<WideColumns> all_columns;
+  for (int i = 0; i < num_keys; ++i) {
+    all_columns.push_back(expected_columns(i));
+    if (i % 2 == 1) {
+      ASSERT_OK(Put(Key(i), all_columns.back()[0].value()));
+    } else {
+      ASSERT_OK(db_->PutEntity(WriteOptions(), db_->DefaultColumnFamily(),
+                               Key(i), all_columns.back()));
+    }
+  }
+  ASSERT_OK(Flush());
+
+  TablePropertiesCollection props;
+  ASSERT_OK(db_->GetPropertiesOfAllTables(&props));
+  ASSERT_EQ(1, props.size());
+  ASSERT_EQ("1", props.begin()->second->user_collected_properties.at(
+                     BlockBasedTablePropertyNames::kColumnarEntityBlocks));
+  ASSERT_GT(props.begin()->second->num_data_blocks, 1);
+
+  auto project = [](const WideColumns& columns,
+                    const std::vector<Slice>* projection) {
+    WideColumns projected;
+    for (const auto& column : columns) {
+      if (projection == nullptr ||
+          std::find(projection->begin(), projection->end(), column.name()) !=
+              projection->end()) {
+        projected.push_back(column);
+      }
+    }
+    return projected;
+  };
+
+  const std::vector<Slice> projection_b{"b"};
+  const std::vector<Slice> projection_default_c{"c", kDefaultWideColumnName,
+                                                "missing"};
+  auto verify = [&](const std::vector<Slice>* projection) {
+    ReadOptions read_options;
+    read_options.column_projection = projection;
+
+    for (int i = 0; i < num_keys; ++i) {
+      const WideColumns expected = project(all_columns[i], projection);
+
+      PinnableWideColumns result;
+      ASSERT_OK(db_->GetEntity(read_options, db_->DefaultColumnFamily(),
+                               Key(i), &result));
+      ASSERT_EQ(expected, result.columns());
+
+      // Get() ignores the projection.
+      PinnableSlice value;
+      ASSERT_OK(db_->Get(read_options, db_->DefaultColumnFamily(), Key(i),
+                         &value));
+      ASSERT_EQ(WideColumnsHelper::HasDefaultColumn(all_columns[i])
+                    ? WideColumnsHelper::GetDefaultColumn(all_columns[i])
+                    : Slice(),
+                value);
+    }
+
+    {
+      std::vector<std::string> key_strs;
+      for (int i = 0; i < num_keys; ++i) {
+        key_strs.push_back(Key(i));
+      }
+      std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+      std::vector<PinnableWideColumns> results(num_keys);
+      std::vector<Status> statuses(num_keys);
+      db_->MultiGetEntity(read_options, db_->DefaultColumnFamily(), num_keys,
+                          keys.data(), results.data(), statuses.data());
+      for (int i = 0; i < num_keys; ++i) {
+        ASSERT_OK(statuses[i]);
+        ASSERT_EQ(project(all_columns[i], projection), results[i].columns());
+      }
+    }
+
+    {
+      std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+      int i = 0;
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++i) {
+        ASSERT_EQ(Key(i), iter->key());
+        const WideColumns expected = project(all_columns[i], projection);
+        ASSERT_EQ(expected, iter->columns());
+        ASSERT_EQ(WideColumnsHelper::HasDefaultColumn(expected)
+                      ? WideColumnsHelper::GetDefaultColumn(expected)
+                      : Slice(),
+                  iter->value());
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(num_keys, i);
+
+      i = num_keys - 1;
+      for (iter->SeekToLast(); iter->Valid(); iter->Prev(), --i) {
+        ASSERT_EQ(Key(i), iter->key());
+        ASSERT_EQ(project(all_columns[i], projection), iter->columns());
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(-1, i);
+    }
+  };
+
+  verify(nullptr);
+  verify(&projection_b);
+  verify(&projection_default_c);
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  verify(nullptr);
+  verify(&projection_b);
+
+  // Blocks buffered for a compression dictionary, then compressed in
+  // parallel, keep their column sections uncompressed.
+  if (ZSTD_Supported()) {
+    options.compression = kZSTD;
+    options.compression_opts.max_dict_bytes = 4096;
+    options.compression_opts.parallel_threads = 2;
+    Reopen(options);
+    CompactRangeOptions cro;
+    cro.bottommost_level_compaction = BottommostLevelCompaction::kForce;
+    ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+    verify(nullptr);
+    verify(&projection_default_c);
+    options.compression_opts = CompressionOptions();
+  }
+
+  // Without the option, the tables are still read as columnar.
+  table_options.columnar_entity_blocks = false;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+  verify(nullptr);
+  verify(&projection_default_c);
+
+  // With a merge operator, the projection is applied after the lookup.
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  Reopen(options);
+  verify(nullptr);
+  verify(&projection_b);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -43,4 +43,34 @@ void WideColumnsHelper::SortColumns(WideColumns& columns) {
             });
 }
 
+void WideColumnsHelper::ProjectColumns(const std::vector<Slice>& projection,
+                                       WideColumns& columns) {
+  columns.erase(std::remove_if(columns.begin(), columns.end(),
+                               [&projection](const WideColumn& column) {
+                                 return std::find(projection.begin(),
+                                                  projection.end(),
+                                                  column.name()) ==
+                                        projection.end();
+                               }),
+                columns.end());
+}
+
+Status WideColumnsHelper::ProjectColumns(const std::vector<Slice>& projection,
+                                         PinnableWideColumns* columns) {
+  assert(columns != nullptr);
+  WideColumns projected = columns->columns();
+  ProjectColumns(projection, projected);
+  if (projected.size() == columns->columns().size()) {
+    return Status::OK();
+  }
+  std::string entity;
+  const Status s = WideColumnSerialization::Serialize(projected, entity);
+  if (!s.ok()) {
+    return s;
+  }
+  // Releases the pinned value, which `entity` no longer points into.
+  columns->Reset();
+  return columns->SetWideColumnValue(std::move(entity));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -6,6 +6,7 @@
 #pragma once
 #include <ostream>
 #include <string>
+#include <vector>
 
 #include "rocksdb/rocksdb_namespace.h"
 #include "rocksdb/wide_columns.h"
@@ -35,6 +36,15 @@ class WideColumnsHelper {
   }
 
   static void SortColumns(WideColumns& columns);
+
+  // Removes the columns not named in `projection`, which may list names in
+  // any order.
+  static void ProjectColumns(const std::vector<Slice>& projection,
+                             WideColumns& columns);
+
+  // Same as above, re-serializing the remaining columns if some are removed.
+  static Status ProjectColumns(const std::vector<Slice>& projection,
+                               PinnableWideColumns* columns);
 };
 
 }  // namespace ROCKSDB_NAMESPACE
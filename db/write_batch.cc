@@ -35,6 +35,10 @@
 // varstring :=
 //    len: varint32
 //    data: uint8[len]
+//
+// For a value added with PutPinned(), rep_ holds the record only up to and
+// including the len of the value; the data is in the caller's buffer and
+// WriteBatch::pinned_values_ records where it belongs.
 
 #include "rocksdb/write_batch.h"
 
@@ -212,16 +216,26 @@ WriteBatch::WriteBatch(const WriteBatch& src)
     prot_info_.reset(new WriteBatch::ProtectionInfo());
     prot_info_->entries_ = src.prot_info_->entries_;
   }
+  if (src.pinned_values_ != nullptr) {
+    pinned_values_.reset(new PinnedValues(*src.pinned_values_));
+    pinned_bytes_ = src.pinned_bytes_;
+    // A copy does not depend on the buffers of the caller of PutPinned().
+    MaterializePinnedValues();
+  }
 }
 
 WriteBatch::WriteBatch(WriteBatch&& src) noexcept
     : save_points_(std::move(src.save_points_)),
       wal_term_point_(std::move(src.wal_term_point_)),
       content_flags_(src.content_flags_.load(std::memory_order_relaxed)),
+      pinned_values_(std::move(src.pinned_values_)),
+      pinned_bytes_(src.pinned_bytes_),
       max_bytes_(src.max_bytes_),
       prot_info_(std::move(src.prot_info_)),
       default_cf_ts_sz_(src.default_cf_ts_sz_),
-      rep_(std::move(src.rep_)) {}
+      rep_(std::move(src.rep_)) {
+  src.pinned_bytes_ = 0;
+}
 
 WriteBatch& WriteBatch::operator=(const WriteBatch& src) {
   if (&src != this) {
@@ -265,6 +279,8 @@ void WriteBatch::Clear() {
   if (prot_info_ != nullptr) {
     prot_info_->entries_.clear();
   }
+  pinned_values_.reset();
+  pinned_bytes_ = 0;
   wal_term_point_.clear();
   default_cf_ts_sz_ = 0;
 }
@@ -288,7 +304,33 @@ uint32_t WriteBatch::ComputeContentFlags() const {
   return rv;
 }
 
+void WriteBatch::MaterializePinnedValues() {
+  if (pinned_values_ == nullptr) {
+    return;
+  }
+  std::vector<Slice> parts;
+  WriteBatchInternal::GetContentsParts(this, &parts);
+  std::string rep;
+  rep.reserve(GetDataSize());
+  for (const Slice& part : parts) {
+    rep.append(part.data(), part.size());
+  }
+  rep_.swap(rep);
+  pinned_values_.reset();
+  pinned_bytes_ = 0;
+}
+
+void WriteBatch::AbortOnPinnedValues() const {
+  fprintf(stderr,
+          "WriteBatch::Data() called on a batch with %" ROCKSDB_PRIszt
+          " bytes of pinned values; call MaterializePinnedValues() first\n",
+          pinned_bytes_);
+  abort();
+}
+
 void WriteBatch::MarkWalTerminationPoint() {
+  // Keep the termination point valid as an offset in rep_.
+  MaterializePinnedValues();
   wal_term_point_.size = GetDataSize();
   wal_term_point_.count = Count();
   wal_term_point_.content_flags = content_flags_;
@@ -302,6 +344,7 @@ size_t WriteBatch::GetProtectionBytesPerKey() const {
 }
 
 std::string WriteBatch::Release() {
+  MaterializePinnedValues();
   std::string ret = std::move(rep_);
   Clear();
   return ret;
@@ -506,6 +549,56 @@ Status ReadRecordFromWriteBatch(Slice* input, char* tag,
   return Status::OK();
 }
 
+namespace {
+// Reads the record that `input` starts with, which was added with
+// PutPinned(), taking the value from the caller's buffer.
+Status ReadPinnedRecordFromWriteBatch(const PinnedValues::Entry& entry,
+                                      Slice* input, char* tag,
+                                      uint32_t* column_family, Slice* key,
+                                      Slice* value) {
+  assert(entry.value_offset > entry.record_offset);
+  const size_t record_size = entry.value_offset - entry.record_offset;
+  if (input->size() < record_size) {
+    return Status::Corruption("bad WriteBatch PutPinned");
+  }
+  Slice record(input->data(), record_size);
+  *tag = record[0];
+  record.remove_prefix(1);
+  uint32_t value_size = 0;
+  if ((*tag == kTypeColumnFamilyValue &&
+       !GetVarint32(&record, column_family)) ||
+      !GetLengthPrefixedSlice(&record, key) ||
+      !GetVarint32(&record, &value_size) || !record.empty() ||
+      value_size != entry.value.size()) {
+    return Status::Corruption("bad WriteBatch PutPinned");
+  }
+  *value = entry.value;
+  input->remove_prefix(record_size);
+  return Status::OK();
+}
+
+// Like ReadRecordFromWriteBatch(), for an `input` within `rep` that may hold
+// records added with PutPinned(). `next_pinned` is the index of the first
+// entry of `pinned` whose record does not start before `input`.
+Status ReadRecordFromPinnedWriteBatch(const PinnedValues* pinned,
+                                      const char* rep, size_t* next_pinned,
+                                      Slice* input, char* tag,
+                                      uint32_t* column_family, Slice* key,
+                                      Slice* value, Slice* blob, Slice* xid,
+                                      uint64_t* write_unix_time) {
+  if (pinned != nullptr && *next_pinned < pinned->entries.size()) {
+    const PinnedValues::Entry& entry = pinned->entries[*next_pinned];
+    if (entry.record_offset == static_cast<size_t>(input->data() - rep)) {
+      ++*next_pinned;
+      return ReadPinnedRecordFromWriteBatch(entry, input, tag, column_family,
+                                            key, value);
+    }
+  }
+  return ReadRecordFromWriteBatch(input, tag, column_family, key, value, blob,
+                                  xid, write_unix_time);
+}
+}  // anonymous namespace
+
 Status WriteBatch::Iterate(Handler* handler) const {
   if (rep_.size() < WriteBatchInternal::kHeader) {
     return Status::Corruption("malformed WriteBatch (too small)");
@@ -525,6 +618,16 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
   Slice input(wb->rep_.data() + begin, static_cast<size_t>(end - begin));
   bool whole_batch =
       (begin == WriteBatchInternal::kHeader) && (end == wb->rep_.size());
+  const PinnedValues* pinned = wb->pinned_values_.get();
+  size_t next_pinned = 0;
+  if (pinned != nullptr) {
+    next_pinned = static_cast<size_t>(
+        std::lower_bound(pinned->entries.begin(), pinned->entries.end(), begin,
+                         [](const PinnedValues::Entry& entry, size_t offset) {
+                           return entry.record_offset < offset;
+                         }) -
+        pinned->entries.begin());
+  }
 
   Slice key, value, blob, xid;
   uint64_t write_unix_time = 0;
@@ -551,8 +654,9 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
       tag = 0;
       column_family = 0;  // default
 
-      s = ReadRecordFromWriteBatch(&input, &tag, &column_family, &key, &value,
-                                   &blob, &xid, &write_unix_time);
+      s = ReadRecordFromPinnedWriteBatch(
+          pinned, wb->rep_.data(), &next_pinned, &input, &tag, &column_family,
+          &key, &value, &blob, &xid, &write_unix_time);
       if (!s.ok()) {
         return s;
       }
@@ -871,6 +975,46 @@ Status WriteBatchInternal::Put(WriteBatch* b, uint32_t column_family_id,
   return save.commit();
 }
 
+Status WriteBatchInternal::PutPinned(WriteBatch* b, uint32_t column_family_id,
+                                     const Slice& key, const Slice& value) {
+  if (value.empty()) {
+    return WriteBatchInternal::Put(b, column_family_id, key, value);
+  }
+  if (key.size() > size_t{std::numeric_limits<uint32_t>::max()}) {
+    return Status::InvalidArgument("key is too large");
+  }
+  if (value.size() > size_t{std::numeric_limits<uint32_t>::max()}) {
+    return Status::InvalidArgument("value is too large");
+  }
+
+  LocalSavePoint save(b);
+  WriteBatchInternal::SetCount(b, WriteBatchInternal::Count(b) + 1);
+  const size_t record_offset = b->rep_.size();
+  if (column_family_id == 0) {
+    b->rep_.push_back(static_cast<char>(kTypeValue));
+  } else {
+    b->rep_.push_back(static_cast<char>(kTypeColumnFamilyValue));
+    PutVarint32(&b->rep_, column_family_id);
+  }
+  PutLengthPrefixedSlice(&b->rep_, key);
+  PutVarint32(&b->rep_, static_cast<uint32_t>(value.size()));
+  if (b->pinned_values_ == nullptr) {
+    b->pinned_values_.reset(new PinnedValues());
+  }
+  b->pinned_values_->entries.push_back({record_offset, b->rep_.size(), value});
+  b->pinned_bytes_ += value.size();
+  b->content_flags_.store(
+      b->content_flags_.load(std::memory_order_relaxed) | ContentFlags::HAS_PUT,
+      std::memory_order_relaxed);
+  if (b->prot_info_ != nullptr) {
+    // See comment in first `WriteBatchInternal::Put()`.
+    b->prot_info_->entries_.emplace_back(ProtectionInfo64()
+                                             .ProtectKVO(key, value, kTypeValue)
+                                             .ProtectC(column_family_id));
+  }
+  return save.commit();
+}
+
 Status WriteBatchInternal::TimedPut(WriteBatch* b, uint32_t column_family_id,
                                     const Slice& key, const Slice& value,
                                     uint64_t write_unix_time) {
@@ -939,6 +1083,27 @@ Status WriteBatch::Put(ColumnFamilyHandle* column_family, const Slice& key,
                                  SliceParts(&value, 1));
 }
 
+Status WriteBatch::PutPinned(ColumnFamilyHandle* column_family,
+                             const Slice& key, const Slice& value) {
+  size_t ts_sz = 0;
+  uint32_t cf_id = 0;
+  Status s;
+
+  std::tie(s, cf_id, ts_sz) =
+      WriteBatchInternal::GetColumnFamilyIdAndTimestampSize(this,
+                                                            column_family);
+
+  if (!s.ok()) {
+    return s;
+  }
+
+  if (0 == ts_sz) {
+    return WriteBatchInternal::PutPinned(this, cf_id, key, value);
+  }
+  // The key needs a copy to get a timestamp, so the value might as well.
+  return Put(column_family, key, value);
+}
+
 Status WriteBatch::TimedPut(ColumnFamilyHandle* column_family, const Slice& key,
                             const Slice& value, uint64_t write_unix_time) {
   size_t ts_sz = 0;
@@ -1724,6 +1889,8 @@ void WriteBatch::SetSavePoint() {
   if (save_points_ == nullptr) {
     save_points_.reset(new SavePoints());
   }
+  // Save points are offsets in rep_, which must not move under them.
+  MaterializePinnedValues();
   // Record length and count of current batch of writes.
   save_points_->stack.push(SavePoint(
       GetDataSize(), Count(), content_flags_.load(std::memory_order_relaxed)));
@@ -1748,6 +1915,7 @@ Status WriteBatch::RollbackToSavePoint() {
     Clear();
   } else {
     rep_.resize(savepoint.size);
+    WriteBatchInternal::TruncatePinnedValues(this, savepoint.size);
     if (prot_info_ != nullptr) {
       prot_info_->entries_.resize(savepoint.count);
     }
@@ -1791,6 +1959,7 @@ Status WriteBatch::VerifyChecksum() const {
   uint32_t column_family = 0;  // default
   Status s;
   size_t prot_info_idx = 0;
+  size_t next_pinned = 0;
   bool checksum_protected = true;
   while (!input.empty() && prot_info_idx < prot_info_->entries_.size()) {
     // In case key/value/column_family are not updated by
@@ -1798,8 +1967,10 @@ Status WriteBatch::VerifyChecksum() const {
     key.clear();
     value.clear();
     column_family = 0;
-    s = ReadRecordFromWriteBatch(&input, &tag, &column_family, &key, &value,
-                                 &blob, &xid, /*write_unix_time=*/nullptr);
+    s = ReadRecordFromPinnedWriteBatch(
+        pinned_values_.get(), rep_.data(), &next_pinned, &input, &tag,
+        &column_family, &key, &value, &blob, &xid,
+        /*write_unix_time=*/nullptr);
     if (!s.ok()) {
       return s;
     }
@@ -1878,6 +2049,11 @@ Status WriteBatch::VerifyChecksum() const {
 
 namespace {
 
+// Write batches with at least this many entries defer the insertion of their
+// point keys, and insert them into each memtable in one sorted pass at the end
+// of the batch.
+constexpr uint32_t kMinCountForBatchedMemTableInsert = 64;
+
 class MemTableInserter : public WriteBatch::Handler {
   SequenceNumber sequence_;
   ColumnFamilyMemTables* const cf_mems_;
@@ -1925,6 +2101,23 @@ class MemTableInserter : public WriteBatch::Handler {
   using HintMapType = std::aligned_storage<sizeof(HintMap)>::type;
   HintMapType hint_;
 
+  // Whether point keys of the current batch are inserted by
+  // InsertBatchedKeys()
+  bool batched_insert_;
+  bool batched_keys_created_;
+  // Point keys added to each memtable but not inserted yet
+  using BatchedKeysMap = std::unordered_map<MemTable*, std::vector<KeyHandle>>;
+  using BatchedKeysMapType = std::aligned_storage<sizeof(BatchedKeysMap)>::type;
+  BatchedKeysMapType batched_keys_;
+
+  BatchedKeysMap& GetBatchedKeysMap() {
+    if (!batched_keys_created_) {
+      new (&batched_keys_) BatchedKeysMap();
+      batched_keys_created_ = true;
+    }
+    return *reinterpret_cast<BatchedKeysMap*>(&batched_keys_);
+  }
+
   HintMap& GetHintMap() {
     assert(hint_per_batch_);
     if (!hint_created_) {
@@ -2023,7 +2216,9 @@ class MemTableInserter : public WriteBatch::Handler {
         duplicate_detector_(),
         dup_dectector_on_(false),
         hint_per_batch_(hint_per_batch),
-        hint_created_(false) {
+        hint_created_(false),
+        batched_insert_(false),
+        batched_keys_created_(false) {
     assert(cf_mems_);
   }
 
@@ -2041,6 +2236,10 @@ class MemTableInserter : public WriteBatch::Handler {
       }
       reinterpret_cast<HintMap*>(&hint_)->~HintMap();
     }
+    if (batched_keys_created_) {
+      assert(GetBatchedKeysMap().empty());
+      reinterpret_cast<BatchedKeysMap*>(&batched_keys_)->~BatchedKeysMap();
+    }
     delete rebuilding_trx_;
   }
 
@@ -2071,6 +2270,27 @@ class MemTableInserter : public WriteBatch::Handler {
 
   SequenceNumber sequence() const { return sequence_; }
 
+  // Decides whether the point keys of `batch` are inserted into the
+  // memtables one by one or, for large batches, in one sorted pass per
+  // memtable by InsertBatchedKeys(). Batched keys are not checked for
+  // duplicates, which only occur with seq_per_batch.
+  void MaybeBatchInserts(const WriteBatch* batch) {
+    batched_insert_ = !seq_per_batch_ && WriteBatchInternal::Count(batch) >=
+                                             kMinCountForBatchedMemTableInsert;
+  }
+
+  // Inserts the point keys deferred so far. Must be called before the
+  // sequence numbers of the batch are published.
+  void InsertBatchedKeys() {
+    if (batched_keys_created_) {
+      auto& batched_keys = GetBatchedKeysMap();
+      for (auto& pair : batched_keys) {
+        pair.first->InsertBatch(&pair.second, concurrent_memtable_writes_);
+      }
+      batched_keys.clear();
+    }
+  }
+
   void PostProcess() {
     assert(concurrent_memtable_writes_);
     // If post info was not created there is nothing
@@ -2160,7 +2380,8 @@ class MemTableInserter : public WriteBatch::Handler {
       ret_status =
           mem->Add(sequence_, value_type, key, value, kv_prot_info,
                    concurrent_memtable_writes_, get_post_process_info(mem),
-                   hint_per_batch_ ? &GetHintMap()[mem] : nullptr);
+                   hint_per_batch_ ? &GetHintMap()[mem] : nullptr,
+                   get_batched_keys(mem));
     } else if (moptions->inplace_callback == nullptr ||
                value_type != kTypeValue) {
       assert(!concurrent_memtable_writes_);
@@ -2353,7 +2574,8 @@ class MemTableInserter : public WriteBatch::Handler {
     ret_status =
         mem->Add(sequence_, delete_type, key, value, kv_prot_info,
                  concurrent_memtable_writes_, get_post_process_info(mem),
-                 hint_per_batch_ ? &GetHintMap()[mem] : nullptr);
+                 hint_per_batch_ ? &GetHintMap()[mem] : nullptr,
+                 get_batched_keys(mem));
     if (UNLIKELY(ret_status.IsTryAgain())) {
       assert(seq_per_batch_);
       const bool kBatchBoundary = true;
@@ -2632,6 +2854,8 @@ class MemTableInserter : public WriteBatch::Handler {
     if (moptions->max_successive_merges > 0 && db_ != nullptr &&
         recovering_log_number_ == 0) {
       assert(!concurrent_memtable_writes_);
+      // The earlier entries of this batch must be visible to the reads below.
+      InsertBatchedKeys();
       LookupKey lkey(key, sequence_);
 
       // Count the number of successive merges at the head
@@ -2741,11 +2965,13 @@ class MemTableInserter : public WriteBatch::Handler {
             kv_prot_info->StripC(column_family_id).ProtectS(sequence_);
         ret_status =
             mem->Add(sequence_, kTypeMerge, key, value, &mem_kv_prot_info,
-                     concurrent_memtable_writes_, get_post_process_info(mem));
+                     concurrent_memtable_writes_, get_post_process_info(mem),
+                     nullptr /* hint */, get_batched_keys(mem));
       } else {
         ret_status = mem->Add(
             sequence_, kTypeMerge, key, value, nullptr /* kv_prot_info */,
-            concurrent_memtable_writes_, get_post_process_info(mem));
+            concurrent_memtable_writes_, get_post_process_info(mem),
+            nullptr /* hint */, get_batched_keys(mem));
       }
     }
 
@@ -3065,6 +3291,15 @@ class MemTableInserter : public WriteBatch::Handler {
     }
     return &GetPostMap()[mem];
   }
+
+  std::vector<KeyHandle>* get_batched_keys(MemTable* mem) {
+    // In-place updates look up the entries written before them.
+    if (!batched_insert_ ||
+        mem->GetImmutableMemTableOptions()->inplace_update_support) {
+      return nullptr;
+    }
+    return &GetBatchedKeysMap()[mem];
+  }
 };
 
 }  // anonymous namespace
@@ -3098,13 +3333,16 @@ Status WriteBatchInternal::InsertInto(
     SetSequence(w->batch, inserter.sequence());
     inserter.set_log_number_ref(w->log_ref);
     inserter.set_prot_info(w->batch->prot_info_.get());
+    inserter.MaybeBatchInserts(w->batch);
     w->status = w->batch->Iterate(&inserter);
     if (!w->status.ok()) {
+      inserter.InsertBatchedKeys();
       return w->status;
     }
     assert(!seq_per_batch || w->batch_cnt != 0);
     assert(!seq_per_batch || inserter.sequence() - w->sequence == w->batch_cnt);
   }
+  inserter.InsertBatchedKeys();
   return Status::OK();
 }
 
@@ -3128,7 +3366,9 @@ Status WriteBatchInternal::InsertInto(
   SetSequence(writer->batch, sequence);
   inserter.set_log_number_ref(writer->log_ref);
   inserter.set_prot_info(writer->batch->prot_info_.get());
+  inserter.MaybeBatchInserts(writer->batch);
   Status s = writer->batch->Iterate(&inserter);
+  inserter.InsertBatchedKeys();
   assert(!seq_per_batch || batch_cnt != 0);
   assert(!seq_per_batch || inserter.sequence() - sequence == batch_cnt);
   if (concurrent_memtable_writes) {
@@ -3149,7 +3389,9 @@ Status WriteBatchInternal::InsertInto(
                             ignore_missing_column_families, log_number, db,
                             concurrent_memtable_writes, batch->prot_info_.get(),
                             has_valid_writes, seq_per_batch, batch_per_txn);
+  inserter.MaybeBatchInserts(batch);
   Status s = batch->Iterate(&inserter);
+  inserter.InsertBatchedKeys();
   if (next_seq != nullptr) {
     *next_seq = inserter.sequence();
   }
@@ -3265,10 +3507,40 @@ Status WriteBatchInternal::SetContents(WriteBatch* b, const Slice& contents) {
   assert(b->prot_info_ == nullptr);
 
   b->rep_.assign(contents.data(), contents.size());
+  b->pinned_values_.reset();
+  b->pinned_bytes_ = 0;
   b->content_flags_.store(ContentFlags::DEFERRED, std::memory_order_relaxed);
   return Status::OK();
 }
 
+void WriteBatchInternal::GetContentsParts(const WriteBatch* b,
+                                          std::vector<Slice>* parts) {
+  size_t pos = 0;
+  if (b->pinned_values_ != nullptr) {
+    for (const PinnedValues::Entry& entry : b->pinned_values_->entries) {
+      parts->emplace_back(b->rep_.data() + pos, entry.value_offset - pos);
+      parts->push_back(entry.value);
+      pos = entry.value_offset;
+    }
+  }
+  parts->emplace_back(b->rep_.data() + pos, b->rep_.size() - pos);
+}
+
+void WriteBatchInternal::TruncatePinnedValues(WriteBatch* b,
+                                              size_t rep_size) {
+  if (b->pinned_values_ == nullptr) {
+    return;
+  }
+  auto& entries = b->pinned_values_->entries;
+  while (!entries.empty() && entries.back().record_offset >= rep_size) {
+    b->pinned_bytes_ -= entries.back().value.size();
+    entries.pop_back();
+  }
+  if (entries.empty()) {
+    b->pinned_values_.reset();
+  }
+}
+
 Status WriteBatchInternal::Append(WriteBatch* dst, const WriteBatch* src,
                                   const bool wal_only) {
   assert(dst->Count() == 0 ||
@@ -3312,6 +3584,23 @@ Status WriteBatchInternal::Append(WriteBatch* dst, const WriteBatch* src,
   }
   SetCount(dst, Count(dst) + src_count);
   assert(src->rep_.size() >= WriteBatchInternal::kHeader);
+  if (src->pinned_values_ != nullptr) {
+    // The values stay in the caller's buffers; only their offsets move.
+    const size_t src_end = WriteBatchInternal::kHeader + src_len;
+    const size_t shift = dst->rep_.size() - WriteBatchInternal::kHeader;
+    for (const PinnedValues::Entry& entry : src->pinned_values_->entries) {
+      if (entry.record_offset >= src_end) {
+        break;
+      }
+      if (dst->pinned_values_ == nullptr) {
+        dst->pinned_values_.reset(new PinnedValues());
+      }
+      dst->pinned_values_->entries.push_back({entry.record_offset + shift,
+                                              entry.value_offset + shift,
+                                              entry.value});
+      dst->pinned_bytes_ += entry.value.size();
+    }
+  }
   dst->rep_.append(src->rep_.data() + WriteBatchInternal::kHeader, src_len);
   dst->content_flags_.store(
       dst->content_flags_.load(std::memory_order_relaxed) | src_flags,
@@ -3345,7 +3634,10 @@ Status WriteBatchInternal::UpdateProtectionInfo(WriteBatch* wb,
       ProtectionInfoUpdater prot_info_updater(wb->prot_info_.get());
       Status s = wb->Iterate(&prot_info_updater);
       if (s.ok() && checksum != nullptr) {
-        uint64_t expected_hash = XXH3_64bits(wb->rep_.data(), wb->rep_.size());
+        // The checksum covers the serialized batch, pinned values included.
+        wb->MaterializePinnedValues();
+        const Slice contents = Contents(wb);
+        uint64_t expected_hash = XXH3_64bits(contents.data(), contents.size());
         if (expected_hash != *checksum) {
           return Status::Corruption("Write batch content corrupted.");
         }
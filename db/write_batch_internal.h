@@ -73,6 +73,20 @@ struct WriteBatch::ProtectionInfo {
   size_t GetBytesPerKey() const { return 8; }
 };
 
+// The values added with WriteBatch::PutPinned(), in rep_ order. rep_ holds
+// each such record up to and including the length of the value; the value
+// bytes stay in the caller's buffer.
+struct PinnedValues {
+  struct Entry {
+    // Offset in rep_ of the record's tag
+    size_t record_offset;
+    // Offset in rep_ where the value bytes belong
+    size_t value_offset;
+    Slice value;
+  };
+  std::vector<Entry> entries;
+};
+
 // WriteBatchInternal provides static methods for manipulating a
 // WriteBatch that we don't want in the public WriteBatch interface.
 class WriteBatchInternal {
@@ -87,6 +101,9 @@ class WriteBatchInternal {
   static Status Put(WriteBatch* batch, uint32_t column_family_id,
                     const SliceParts& key, const SliceParts& value);
 
+  static Status PutPinned(WriteBatch* batch, uint32_t column_family_id,
+                          const Slice& key, const Slice& value);
+
   static Status TimedPut(WriteBatch* batch, uint32_t column_family_id,
                          const Slice& key, const Slice& value,
                          uint64_t unix_write_time);
@@ -152,9 +169,27 @@ class WriteBatchInternal {
   // This offset is only valid if the batch is not empty.
   static size_t GetFirstOffset(WriteBatch* batch);
 
-  static Slice Contents(const WriteBatch* batch) { return Slice(batch->rep_); }
+  // REQUIRES: !HasPinnedValues(batch)
+  static Slice Contents(const WriteBatch* batch) {
+    return Slice(batch->Data());
+  }
+
+  static size_t ByteSize(const WriteBatch* batch) {
+    return batch->GetDataSize();
+  }
+
+  static bool HasPinnedValues(const WriteBatch* batch) {
+    return batch->pinned_bytes_ != 0;
+  }
+
+  // Appends to `parts` the pieces that make up Contents(batch), without
+  // copying the values added with WriteBatch::PutPinned() into the batch.
+  static void GetContentsParts(const WriteBatch* batch,
+                               std::vector<Slice>* parts);
 
-  static size_t ByteSize(const WriteBatch* batch) { return batch->rep_.size(); }
+  // Drops the values added with WriteBatch::PutPinned() whose records start
+  // at or after `rep_size`, after rep_ has been truncated to `rep_size`.
+  static void TruncatePinnedValues(WriteBatch* batch, size_t rep_size);
 
   static Status SetContents(WriteBatch* batch, const Slice& contents);
 
@@ -243,7 +278,8 @@ class WriteBatchInternal {
   }
 
   // Update per-key value protection information on this write batch.
-  // If checksum is provided, the batch content is verfied against the checksum.
+  // If checksum is provided, the batch content is verfied against the checksum,
+  // after copying the values added with PutPinned() into the batch.
   static Status UpdateProtectionInfo(WriteBatch* wb, size_t bytes_per_key,
                                      uint64_t* checksum = nullptr);
 };
@@ -253,7 +289,7 @@ class LocalSavePoint {
  public:
   explicit LocalSavePoint(WriteBatch* batch)
       : batch_(batch),
-        savepoint_(batch->GetDataSize(), batch->Count(),
+        savepoint_(batch->rep_.size(), batch->Count(),
                    batch->content_flags_.load(std::memory_order_relaxed))
 #ifndef NDEBUG
         ,
@@ -269,8 +305,9 @@ class LocalSavePoint {
 #ifndef NDEBUG
     committed_ = true;
 #endif
-    if (batch_->max_bytes_ && batch_->rep_.size() > batch_->max_bytes_) {
+    if (batch_->max_bytes_ && batch_->GetDataSize() > batch_->max_bytes_) {
       batch_->rep_.resize(savepoint_.size);
+      WriteBatchInternal::TruncatePinnedValues(batch_, savepoint_.size);
       WriteBatchInternal::SetCount(batch_, savepoint_.count);
       if (batch_->prot_info_ != nullptr) {
         batch_->prot_info_->entries_.resize(savepoint_.count);
@@ -710,6 +710,80 @@ TEST_F(WriteBatchTest, PutGatherSlices) {
   ASSERT_EQ(3u, batch.Count());
 }
 
+TEST_F(WriteBatchTest, PutPinned) {
+  std::string value_b = "vb";
+  std::string value_d = "vd";
+  WriteBatch batch;
+  ASSERT_OK(batch.Put("a", "va"));
+  ASSERT_OK(batch.PutPinned("b", value_b));
+  ASSERT_OK(batch.Delete("c"));
+  ASSERT_OK(batch.PutPinned("d", value_d));
+  WriteBatchInternal::SetSequence(&batch, 100);
+  ASSERT_EQ(4u, batch.Count());
+  ASSERT_TRUE(WriteBatchInternal::HasPinnedValues(&batch));
+
+  // The batch reads the values from the caller's buffers
+  value_b = "VB";
+  ASSERT_EQ(
+      "Put(a, va)@100"
+      "Put(b, VB)@101"
+      "Delete(c)@102"
+      "Put(d, vd)@103",
+      PrintContents(&batch));
+
+  WriteBatch expected;
+  ASSERT_OK(expected.Put("a", "va"));
+  ASSERT_OK(expected.Put("b", "VB"));
+  ASSERT_OK(expected.Delete("c"));
+  ASSERT_OK(expected.Put("d", "vd"));
+  WriteBatchInternal::SetSequence(&expected, 100);
+  ASSERT_EQ(expected.GetDataSize(), batch.GetDataSize());
+  std::vector<Slice> parts;
+  WriteBatchInternal::GetContentsParts(&batch, &parts);
+  std::string contents;
+  for (const Slice& part : parts) {
+    contents.append(part.data(), part.size());
+  }
+  ASSERT_EQ(expected.Data(), contents);
+
+  // Appending keeps the values pinned
+  WriteBatch appended;
+  ASSERT_OK(appended.Put("0", "v0"));
+  ASSERT_OK(WriteBatchInternal::Append(&appended, &batch));
+  ASSERT_TRUE(WriteBatchInternal::HasPinnedValues(&appended));
+  WriteBatchInternal::SetSequence(&appended, 200);
+  ASSERT_EQ(
+      "Put(0, v0)@200"
+      "Put(a, va)@201"
+      "Put(b, VB)@202"
+      "Delete(c)@203"
+      "Put(d, vd)@204",
+      PrintContents(&appended));
+
+  // A copy holds its own values
+  WriteBatch copy(batch);
+  ASSERT_FALSE(WriteBatchInternal::HasPinnedValues(&copy));
+  ASSERT_EQ(expected.Data(), copy.Data());
+
+  // A save point copies the values into the batch; a rollback drops the
+  // values pinned after it
+  batch.SetSavePoint();
+  ASSERT_FALSE(WriteBatchInternal::HasPinnedValues(&batch));
+  ASSERT_OK(batch.PutPinned("e", value_d));
+  ASSERT_TRUE(WriteBatchInternal::HasPinnedValues(&batch));
+  ASSERT_OK(batch.RollbackToSavePoint());
+  ASSERT_FALSE(WriteBatchInternal::HasPinnedValues(&batch));
+  value_b = "xx";
+  ASSERT_EQ(expected.Data(), batch.Data());
+
+  // MaterializePinnedValues() copies the values into the batch
+  ASSERT_OK(batch.PutPinned("e", value_d));
+  ASSERT_OK(expected.Put("e", "vd"));
+  batch.MaterializePinnedValues();
+  ASSERT_EQ(expected.Data(), batch.Data());
+  ASSERT_FALSE(WriteBatchInternal::HasPinnedValues(&batch));
+}
+
 namespace {
 class ColumnFamilyHandleImplDummy : public ColumnFamilyHandleImpl {
  public:
@@ -40,6 +40,14 @@ WriteController::GetCompactionPressureToken() {
       new CompactionPressureToken(this));
 }
 
+std::unique_ptr<WriteControllerToken> WriteController::GetScopedStallToken(
+    uint32_t column_family_id) {
+  ++total_scoped_stalls_;
+  ++scoped_stalls_by_slot_[column_family_id % kScopedStallSlots];
+  return std::unique_ptr<WriteControllerToken>(
+      new ScopedStallToken(this, column_family_id));
+}
+
 bool WriteController::IsStopped() const {
   return total_stopped_.load(std::memory_order_relaxed) > 0;
 }
@@ -118,4 +126,13 @@ CompactionPressureToken::~CompactionPressureToken() {
   assert(controller_->total_compaction_pressure_ >= 0);
 }
 
+ScopedStallToken::~ScopedStallToken() {
+  controller_->total_scoped_stalls_--;
+  assert(controller_->total_scoped_stalls_ >= 0);
+  auto& slot = controller_->scoped_stalls_by_slot_
+                   [column_family_id_ % WriteController::kScopedStallSlots];
+  slot--;
+  assert(slot >= 0);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -7,6 +7,7 @@
 
 #include <stdint.h>
 
+#include <array>
 #include <atomic>
 #include <memory>
 
@@ -28,6 +29,7 @@ class WriteController {
       : total_stopped_(0),
         total_delayed_(0),
         total_compaction_pressure_(0),
+        total_scoped_stalls_(0),
         credit_in_bytes_(0),
         next_refill_time_(0),
         low_pri_rate_limiter_(
@@ -48,12 +50,31 @@ class WriteController {
   // When an actor (column family) requests a moderate token, compaction
   // threads will be increased
   std::unique_ptr<WriteControllerToken> GetCompactionPressureToken();
-
-  // these three metods are querying the state of the WriteController
+  // When an actor (column family) stops or delays writes through its own
+  // WriteController rather than this one (see
+  // DBOptions::write_stall_per_column_family), it holds a scoped stall token
+  // of this one. Writes are not affected, but writers to that column family
+  // know that they have to check its scoped controller, and compaction
+  // threads will be increased.
+  std::unique_ptr<WriteControllerToken> GetScopedStallToken(
+      uint32_t column_family_id);
+
+  // these four metods are querying the state of the WriteController
   bool IsStopped() const;
   bool NeedsDelay() const { return total_delayed_.load() > 0; }
+  bool HasScopedStalls() const {
+    return total_scoped_stalls_.load(std::memory_order_relaxed) > 0;
+  }
+  // False if the column family holds no scoped stall token. May return true
+  // for a column family without one that shares a slot with one that has
+  // one. Unlike the other methods, can be called without the DB mutex.
+  bool MayHaveScopedStall(uint32_t column_family_id) const {
+    return scoped_stalls_by_slot_[column_family_id % kScopedStallSlots].load(
+               std::memory_order_relaxed) > 0;
+  }
   bool NeedSpeedupCompaction() const {
-    return IsStopped() || NeedsDelay() || total_compaction_pressure_.load() > 0;
+    return IsStopped() || NeedsDelay() || HasScopedStalls() ||
+           total_compaction_pressure_.load() > 0;
   }
   // return how many microseconds the caller needs to sleep after the call
   // num_bytes: how many number of bytes to put into the DB.
@@ -92,10 +113,15 @@ class WriteController {
   friend class StopWriteToken;
   friend class DelayWriteToken;
   friend class CompactionPressureToken;
+  friend class ScopedStallToken;
 
   std::atomic<int> total_stopped_;
   std::atomic<int> total_delayed_;
   std::atomic<int> total_compaction_pressure_;
+  std::atomic<int> total_scoped_stalls_;
+  // Scoped stall tokens by column family id modulo kScopedStallSlots.
+  static constexpr size_t kScopedStallSlots = 64;
+  std::array<std::atomic<int>, kScopedStallSlots> scoped_stalls_by_slot_{};
 
   // Number of bytes allowed to write without delay
   uint64_t credit_in_bytes_;
@@ -145,4 +171,15 @@ class CompactionPressureToken : public WriteControllerToken {
   virtual ~CompactionPressureToken();
 };
 
+class ScopedStallToken : public WriteControllerToken {
+ public:
+  ScopedStallToken(WriteController* controller, uint32_t column_family_id)
+      : WriteControllerToken(controller),
+        column_family_id_(column_family_id) {}
+  virtual ~ScopedStallToken();
+
+ private:
+  const uint32_t column_family_id_;
+};
+
 }  // namespace ROCKSDB_NAMESPACE
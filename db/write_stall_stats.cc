@@ -153,6 +153,16 @@ WriteStallStatsMapKeys::CFL0FileCountLimitStopsWithOngoingCompaction() {
   return ret;
 }
 
+const std::string& WriteStallStatsMapKeys::CFScopedWriteStalls() {
+  static const std::string ret = "cf-scoped-write-stalls";
+  return ret;
+}
+
+const std::string& WriteStallStatsMapKeys::CFScopedWriteStallMicros() {
+  static const std::string ret = "cf-scoped-write-stall-micros";
+  return ret;
+}
+
 std::string WriteStallStatsMapKeys::CauseConditionCount(
     WriteStallCause cause, WriteStallCondition condition) {
   std::string cause_condition_count_name;
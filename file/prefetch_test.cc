@@ -2012,6 +2012,70 @@ TEST_P(PrefetchTest1, SeekWithExtraPrefetchAsyncIO) {
   }
 }
 
+// This test verifies that ReadOptions.async_io_readahead_depth controls how
+// many buffers are filled asynchronously ahead of the one being read.
+TEST_P(PrefetchTest1, AsyncIOReadaheadDepth) {
+  const int kNumKeys = 2000;
+  // Set options
+  std::shared_ptr<MockFS> fs =
+      std::make_shared<MockFS>(env_->GetFileSystem(), false);
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(env_, fs));
+
+  Options options;
+  SetGenericOptions(env.get(), GetParam(), options);
+  BlockBasedTableOptions table_options;
+  SetBlockBasedTableOptions(table_options);
+  table_options.num_file_reads_for_auto_readahead = 0;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  Status s = TryReopen(options);
+  if (GetParam() && (s.IsNotSupported() || s.IsInvalidArgument())) {
+    // If direct IO is not supported, skip the test
+    return;
+  } else {
+    ASSERT_OK(s);
+  }
+
+  WriteBatch batch;
+  Random rnd(309);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(batch.Put(BuildKey(i), rnd.RandomString(1000)));
+  }
+  ASSERT_OK(db_->Write(WriteOptions(), &batch));
+  ASSERT_OK(Flush());
+
+  int extra_prefetch_buff_cnt = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "FilePrefetchBuffer::PrefetchAsync:ExtraPrefetching",
+      [&](void*) { extra_prefetch_buff_cnt++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  for (size_t depth : {size_t{0}, size_t{1}, size_t{3}}) {
+    ReadOptions ro;
+    ro.async_io = true;
+    ro.async_io_readahead_depth = depth;
+    auto iter = std::unique_ptr<Iterator>(db_->NewIterator(ro));
+    extra_prefetch_buff_cnt = 0;
+    // Seek parallelization prefetches on the first seek, filling every
+    // buffer but the first one asynchronously.
+    iter->Seek(BuildKey(0));
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(extra_prefetch_buff_cnt,
+              static_cast<int>(std::max<size_t>(depth, 1)));
+
+    int num_keys = 0;
+    for (; iter->Valid(); iter->Next()) {
+      num_keys++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(num_keys, kNumKeys);
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  Close();
+}
+
 // This test verifies the functionality of ReadOptions.adaptive_readahead when
 // reads are not sequential.
 TEST_P(PrefetchTest1, NonSequentialReadsWithAdaptiveReadahead) {
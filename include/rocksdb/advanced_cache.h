@@ -126,6 +126,14 @@ class Cache {
                                     MemoryAllocator* allocator,
                                     ObjectPtr* out_obj, size_t* out_charge);
 
+  // The AllocationCallback takes an object pointer and returns the memory
+  // holding the object's content if it was allocated from `allocator`, or
+  // nullptr otherwise. It lets a cache whose allocator gives memory back in
+  // units larger than one object (see NewSlabMemoryAllocator()) prefer
+  // evicting objects whose memory the allocator can give back.
+  using AllocationCallback = void* (*)(ObjectPtr obj,
+                                       MemoryAllocator* allocator);
+
   // A struct with pointers to helper functions for spilling items from the
   // cache into the secondary cache. May be extended in the future. An
   // instance of this struct is expected to outlive the cache.
@@ -147,24 +155,30 @@ class Cache {
     // primary cache without removal from the secondary cache can be prevented
     // from attempting re-insertion into secondary cache (for efficiency).
     const CacheItemHelper* without_secondary_compat;
+    // Optional, may be nullptr. See AllocationCallback.
+    AllocationCallback allocation_cb;
 
     CacheItemHelper() : CacheItemHelper(CacheEntryRole::kMisc) {}
 
     // For helpers without SecondaryCache support
-    explicit CacheItemHelper(CacheEntryRole _role, DeleterFn _del_cb = nullptr)
-        : CacheItemHelper(_role, _del_cb, nullptr, nullptr, nullptr, this) {}
+    explicit CacheItemHelper(CacheEntryRole _role, DeleterFn _del_cb = nullptr,
+                             AllocationCallback _allocation_cb = nullptr)
+        : CacheItemHelper(_role, _del_cb, nullptr, nullptr, nullptr, this,
+                          _allocation_cb) {}
 
     // For helpers with SecondaryCache support
     explicit CacheItemHelper(CacheEntryRole _role, DeleterFn _del_cb,
                              SizeCallback _size_cb, SaveToCallback _saveto_cb,
                              CreateCallback _create_cb,
-                             const CacheItemHelper* _without_secondary_compat)
+                             const CacheItemHelper* _without_secondary_compat,
+                             AllocationCallback _allocation_cb = nullptr)
         : del_cb(_del_cb),
           size_cb(_size_cb),
           saveto_cb(_saveto_cb),
           create_cb(_create_cb),
           role(_role),
-          without_secondary_compat(_without_secondary_compat) {
+          without_secondary_compat(_without_secondary_compat),
+          allocation_cb(_allocation_cb) {
       // Either all three secondary cache callbacks are non-nullptr or
       // all three are nullptr
       assert((size_cb != nullptr) == (saveto_cb != nullptr));
@@ -209,6 +223,21 @@ class Cache {
   // The type of the Cache
   virtual const char* Name() const = 0;
 
+  // The Cache this one wraps, if any (see CacheWrapper)
+  virtual Cache* Inner() const { return nullptr; }
+
+  // Returns this Cache as a T* if its Name() is T::kClassName(), else the
+  // result of the same check on Inner(), or nullptr if there is no match.
+  // Similar to Customizable::CheckedCast().
+  template <typename T>
+  T* CheckedCast() {
+    if (Slice(Name()) == Slice(T::kClassName())) {
+      return static_cast<T*>(this);
+    }
+    Cache* inner = Inner();
+    return inner != nullptr ? inner->CheckedCast<T>() : nullptr;
+  }
+
   // The Insert and Lookup APIs below are intended to allow cached objects
   // to be demoted/promoted between the primary block cache and a secondary
   // cache. The secondary cache could be a non-volatile cache, and will
@@ -652,6 +681,8 @@ class CacheWrapper : public Cache {
     target_->ReportProblems(info_log);
   }
 
+  Cache* Inner() const override { return target_.get(); }
+
   const std::shared_ptr<Cache>& GetTarget() { return target_; }
 
  protected:
@@ -662,4 +693,59 @@ class CacheWrapper : public Cache {
 // reservations
 extern const Cache::CacheItemHelper kNoopCacheItemHelper;
 
+// EXPERIMENTAL
+// Decides whether a new entry is worth keeping in a cache that is full, so
+// that one-off bursts such as long scans or compaction reads do not flush
+// the working set. Set through ShardedCacheOptions::admission_policy; one
+// instance serves all the shards of a cache and may be shared by several
+// caches. Entries inserted without an object (such as cache reservations)
+// are always admitted.
+//
+// When an insertion is rejected the entry is treated as if it had been
+// inserted and immediately evicted: if no handle was requested, Insert()
+// takes ownership of the object, deletes it and returns OK; otherwise it
+// returns Status::Incomplete() and the caller keeps ownership. Block and blob
+// reads then use the entry without caching it.
+//
+// Implementations must be thread safe.
+class CacheAdmissionPolicy {
+ public:
+  virtual ~CacheAdmissionPolicy() = default;
+
+  virtual const char* Name() const = 0;
+
+  // Reports a lookup of `key`, whether or not it was found.
+  virtual void RecordAccess(const Slice& key) = 0;
+
+  // Called before inserting `key` into a cache shard that would have to
+  // evict other entries to make room. Return false to reject the insertion.
+  virtual bool Admit(const Slice& key) = 0;
+};
+
+struct TinyLFUAdmissionPolicyOptions {
+  // Number of counters in each of the four rows of the frequency sketch,
+  // rounded up to a power of two (at least 256). Each counter takes four
+  // bits. Should be at least the number of entries expected to fit in the
+  // cache.
+  size_t num_counters = size_t{1} << 18;
+
+  // An entry is admitted into a full cache once its estimated number of
+  // recent lookups reaches this value. Each count is halved once every
+  // 10 * num_counters recorded lookups, a part of the sketch at a time, so
+  // that old popularity fades.
+  uint32_t admit_frequency = 2;
+
+  // If set, admissions and rejections are counted in the
+  // CACHE_ADMISSION_ADMITS and CACHE_ADMISSION_REJECTS tickers.
+  std::shared_ptr<Statistics> statistics;
+};
+
+// An admission policy that estimates how often each key is looked up with
+// a count-min sketch, as in TinyLFU, and admits an entry into a full cache
+// only if it is popular enough. Unlike the original TinyLFU it does not
+// compare the entry with the eviction victim, since clock-based shards have
+// no single victim to compare with.
+std::shared_ptr<CacheAdmissionPolicy> NewTinyLFUAdmissionPolicy(
+    const TinyLFUAdmissionPolicyOptions& opts);
+
 }  // namespace ROCKSDB_NAMESPACE
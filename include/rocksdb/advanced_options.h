@@ -350,8 +350,15 @@ struct AdvancedColumnFamilyOptions {
   // example:
   //      sysctl -w vm.nr_hugepages=20
   // See linux doc Documentation/vm/hugetlbpage.txt
-  // If there isn't enough free huge page available, it will fall back to
-  // malloc.
+  // Page sizes other than the default huge page size (e.g. 1GB) are
+  // requested explicitly and need huge pages of that size to be reserved.
+  // If there isn't enough free huge page available, arena blocks of at least
+  // 2MB are rounded up to whole 2MB pages and advised to be backed by
+  // transparent huge pages (madvise(MADV_HUGEPAGE)) where supported; smaller
+  // blocks come from malloc.
+  // See also DBOptions::memtable_huge_page_pool_size and the
+  // "rocksdb.memtable-hugetlb-bytes" and "rocksdb.memtable-thp-bytes"
+  // properties.
   //
   // Dynamically changeable through SetOptions() API
   size_t memtable_huge_page_size = 0;
@@ -13,6 +13,7 @@
 
 #include <cstdint>
 #include <limits>
+#include <map>
 #include <memory>
 #include <string>
 
@@ -22,8 +23,10 @@
 
 namespace ROCKSDB_NAMESPACE {
 
-class Cache;  // defined in advanced_cache.h
+class Cache;                 // defined in advanced_cache.h
+class CacheAdmissionPolicy;  // defined in advanced_cache.h
 struct ConfigOptions;
+class Env;
 class SecondaryCache;
 
 // These definitions begin source compatibility for a future change in which
@@ -160,6 +163,14 @@ struct ShardedCacheOptions {
   // this option must be kept as default empty.
   std::shared_ptr<SecondaryCache> secondary_cache;
 
+  // EXPERIMENTAL
+  // If set, consulted before inserting an entry into a shard that would have
+  // to evict other entries, and told about every lookup. See
+  // CacheAdmissionPolicy in advanced_cache.h and NewTinyLFUAdmissionPolicy().
+  // For CompressedSecondaryCacheOptions, this gates the entries demoted into
+  // the compressed cache.
+  std::shared_ptr<CacheAdmissionPolicy> admission_policy;
+
   // See hash_seed comments below
   static constexpr int32_t kQuasiRandomHashSeed = -1;
   static constexpr int32_t kHostHashSeed = -2;
@@ -478,6 +489,18 @@ struct HyperClockCacheOptions : public ShardedCacheOptions {
   // keep operations very fast.
   int eviction_effort_cap = 30;
 
+  // EXPERIMENTAL: Splits the entries of each shard into a probation and a
+  // protected segment, in the spirit of segmented LRU. New entries start in
+  // probation regardless of priority (priority still sets their initial
+  // clock count) and are promoted to protected on their second hit.
+  // Eviction only considers probation entries while the protected segment
+  // holds at most 80% of the entries; beyond that, protected entries are
+  // demoted back to probation as they age. Entries only touched once, such
+  // as data blocks filled by long range scans, thus churn through probation
+  // without displacing entries that are looked up repeatedly, such as index
+  // and filter partitions.
+  bool segmented = false;
+
   HyperClockCacheOptions(
       size_t _capacity, size_t _estimated_entry_charge,
       int _num_shard_bits = -1, bool _strict_capacity_limit = false,
@@ -576,4 +599,83 @@ Status UpdateTieredCache(
     const std::shared_ptr<Cache>& cache, int64_t total_capacity = -1,
     double compressed_secondary_ratio = std::numeric_limits<double>::max(),
     TieredAdmissionPolicy adm_policy = TieredAdmissionPolicy::kAdmPolicyMax);
+
+// EXPERIMENTAL
+// Options for a SecondaryCache that keeps entries in files on a local
+// flash device. Entries are appended to a log of fixed size segment files
+// and located through an in-memory index; space is reclaimed by dropping
+// the oldest segment once `capacity` is exceeded. Lookups that do not need
+// to wait are served by background threads, so that MultiGet can overlap
+// reads from the device. It can be used as the secondary cache of a block
+// cache, or as TieredCacheOptions::nvm_sec_cache.
+//
+// The cache is not persistent: files left in `path` by a previous instance
+// are deleted when a new one is created.
+struct FlashSecondaryCacheOptions {
+  // Directory for the segment files. It is created if missing and should
+  // not be shared with anything else.
+  std::string path;
+
+  // Env used for file I/O. If nullptr, Env::Default() is used.
+  Env* env = nullptr;
+
+  // Maximum number of bytes kept on the device, including entries that were
+  // overwritten or erased but not yet reclaimed.
+  uint64_t capacity = 0;
+
+  // Size of each segment file. The whole oldest segment is dropped at once
+  // when the cache is full, so this is the granularity of eviction.
+  uint64_t segment_size = 64 << 20;
+
+  // Inserted entries are buffered in memory and appended to the active
+  // segment in writes of about this size.
+  size_t write_buffer_size = 1 << 20;
+
+  // Number of background threads reading entries for lookups that do not
+  // wait. If 0, all lookups read synchronously.
+  int num_io_threads = 4;
+};
+
+// Create a FlashSecondaryCache. Fails if `path` is empty or cannot be
+// prepared for use.
+Status NewFlashSecondaryCache(const FlashSecondaryCacheOptions& opts,
+                              std::shared_ptr<SecondaryCache>* result);
+
+// EXPERIMENTAL
+// A group of block caches, typically one per column family or per tenant,
+// sharing a total capacity. Each member cache (a "quota") is guaranteed a
+// share of the total, and may borrow capacity that the others leave unused,
+// so that the whole capacity is used even when only some quotas are busy.
+// Borrowed capacity is reclaimed, evicting the borrower's entries, as soon as
+// a quota below its guaranteed share needs it. Each quota is its own
+// LRUCache, so a bulk scan through one quota cannot evict the guaranteed
+// share of another.
+//
+// Usage and hit rate of every quota are reported by the DB property
+// "rocksdb.block-cache-quota-stats" of any column family using one of the
+// group's caches as BlockBasedTableOptions::block_cache.
+class CacheQuotaGroup {
+ public:
+  virtual ~CacheQuotaGroup() = default;
+
+  // Create the cache of a new quota named `name`, with `guaranteed_capacity`
+  // bytes of the group capacity reserved for it. Fails if the name is taken,
+  // or if the guaranteed capacities of all quotas would exceed the group
+  // capacity. The capacity of the returned cache changes as it borrows and
+  // gives back capacity, and it cannot be set directly. The quota lives as
+  // long as the group.
+  virtual Status NewQuotaCache(const std::string& name,
+                               size_t guaranteed_capacity,
+                               std::shared_ptr<Cache>* cache) = 0;
+
+  // Fill `stats` with "<name>.<stat>" entries for every quota, where <stat>
+  // is one of guaranteed_capacity, capacity, usage, lookups, hits and
+  // hit_rate, plus "capacity" for the whole group.
+  virtual void GetQuotaStats(std::map<std::string, std::string>* stats) = 0;
+};
+
+// Create a CacheQuotaGroup. `cache_opts.capacity` is the total capacity of
+// the group; the other options apply to the LRUCache of every quota.
+std::shared_ptr<CacheQuotaGroup> NewCacheQuotaGroup(
+    const LRUCacheOptions& cache_opts);
 }  // namespace ROCKSDB_NAMESPACE
@@ -1109,6 +1109,13 @@ class DB {
     //      stale values more frequently to reduce overhead and latency.
     static const std::string kFastBlockCacheEntryStats;
 
+    //  "rocksdb.block-cache-quota-stats" - returns the capacity, usage and
+    //      hit rate of every quota of the CacheQuotaGroup the block cache
+    //      belongs to, as a map or as one "key: value" line per entry. See
+    //      CacheQuotaGroup::GetQuotaStats() for the keys. Not available if
+    //      the block cache is not from a CacheQuotaGroup.
+    static const std::string kBlockCacheQuotaStats;
+
     //  "rocksdb.num-immutable-mem-table" - returns number of immutable
     //      memtables that have not yet been flushed.
     static const std::string kNumImmutableMemTable;
@@ -1149,6 +1156,31 @@ class DB {
     //      unflushed immutable, and pinned immutable memtables (bytes).
     static const std::string kSizeAllMemTables;
 
+    //  "rocksdb.memtable-numa-placed-bytes" - returns the arena bytes of the
+    //      active and unflushed immutable memtables whose pages the kernel
+    //      faulted in on the NUMA node of the writing thread when their block
+    //      was allocated. This is allocation placement, not where later reads
+    //      land. Only non-zero with DBOptions::memtable_numa_aware on a
+    //      multi-node machine.
+    static const std::string kMemTableNumaPlacedBytes;
+
+    //  "rocksdb.memtable-numa-misplaced-bytes" - returns the arena bytes of
+    //      the active and unflushed immutable memtables that could not be
+    //      placed on the NUMA node of the writing thread when they were
+    //      allocated.
+    static const std::string kMemTableNumaMisplacedBytes;
+
+    //  "rocksdb.memtable-hugetlb-bytes" - returns the arena bytes of the
+    //      active and unflushed immutable memtables that are backed by
+    //      reserved huge pages. See
+    //      ColumnFamilyOptions::memtable_huge_page_size.
+    static const std::string kMemTableHugeTlbBytes;
+
+    //  "rocksdb.memtable-thp-bytes" - returns the arena bytes of the active
+    //      and unflushed immutable memtables that were advised to use
+    //      transparent huge pages because no reserved huge pages were left.
+    static const std::string kMemTableThpBytes;
+
     //  "rocksdb.num-entries-active-mem-table" - returns total number of entries
     //      in the active memtable.
     static const std::string kNumEntriesActiveMemTable;
@@ -1353,6 +1385,10 @@ class DB {
   //  "rocksdb.cur-size-active-mem-table"
   //  "rocksdb.cur-size-all-mem-tables"
   //  "rocksdb.size-all-mem-tables"
+  //  "rocksdb.memtable-numa-placed-bytes"
+  //  "rocksdb.memtable-numa-misplaced-bytes"
+  //  "rocksdb.memtable-hugetlb-bytes"
+  //  "rocksdb.memtable-thp-bytes"
   //  "rocksdb.num-entries-active-mem-table"
   //  "rocksdb.num-entries-imm-mem-tables"
   //  "rocksdb.num-deletes-active-mem-table"
@@ -2089,6 +2125,12 @@ struct WriteStallStatsMapKeys {
   static const std::string& CFL0FileCountLimitDelaysWithOngoingCompaction();
   static const std::string& CFL0FileCountLimitStopsWithOngoingCompaction();
 
+  // Number of writes stopped or delayed because of this column family alone,
+  // and the total time they spent stalled. Only non-zero with
+  // DBOptions::write_stall_per_column_family.
+  static const std::string& CFScopedWriteStalls();
+  static const std::string& CFScopedWriteStallMicros();
+
   // REQUIRES:
   // `cause` isn't any of these: `WriteStallCause::kNone`,
   // `WriteStallCause::kCFScopeWriteStallCauseEnumMax`,
@@ -24,10 +24,15 @@
 //  structured like "prefix:suffix" where iteration within a prefix is
 //  common and iteration across different prefixes is rare. It is backed by
 //  a hash map where each bucket is a skip list.
-//  - VectorRep: This is backed by an unordered std::vector. On iteration, the
-// vector is sorted. It is intelligent about sorting; once the MarkReadOnly()
-// has been called, the vector will only be sorted once. It is optimized for
-// random-write-heavy workloads.
+//  - VectorRep: This is backed by unordered per-core std::vectors. On
+// iteration, the vectors are sorted and merged. It is intelligent about
+// sorting; once the MarkReadOnly() has been called, the vectors will only be
+// sorted once, by the flushing thread and up to three shared helper threads.
+// It is optimized for random-write-heavy workloads and supports concurrent
+// inserts.
+//  - AdaptiveRadixTreeRep: This is backed by an adaptive radix tree over the
+// internal keys. It is optimized for point lookups and requires the bytewise
+// comparator.
 //
 // The last four implementations are designed for situations in which
 // iteration over the entire collection is rare since doing so requires all the
@@ -162,6 +167,28 @@ class MemTableRep {
     return true;
   }
 
+  // Inserts num_handles keys at once. The implementation may reorder
+  // handles, e.g. to insert the keys in sorted order and reuse the search
+  // position from one key to the next. The default implementation inserts
+  // them one by one.
+  // REQUIRES: no two handles compare equal, nothing that compares equal to
+  // any of them is currently in the collection, and no concurrent
+  // modifications to the table in progress
+  virtual void InsertBatch(KeyHandle* handles, size_t num_handles) {
+    for (size_t i = 0; i < num_handles; ++i) {
+      Insert(handles[i]);
+    }
+  }
+
+  // Like InsertBatch(), but may be called concurrent with other calls to
+  // InsertConcurrently or InsertBatchConcurrently.
+  virtual void InsertBatchConcurrently(KeyHandle* handles,
+                                       size_t num_handles) {
+    for (size_t i = 0; i < num_handles; ++i) {
+      InsertConcurrently(handles[i]);
+    }
+  }
+
   // Returns true iff an entry that compares equal to key is in the collection.
   virtual bool Contains(const char* key) const = 0;
 
@@ -359,14 +386,16 @@ class SkipListFactory : public MemTableRepFactory {
   size_t lookahead_;
 };
 
-// This creates MemTableReps that are backed by an std::vector. On iteration,
-// the vector is sorted. This is useful for workloads where iteration is very
-// rare and writes are generally not issued after reads begin.
+// This creates MemTableReps that are backed by per-core std::vectors, which
+// concurrent writers append to without contending with each other. On
+// iteration, the vectors are sorted and merged. This is useful for workloads
+// where iteration is very rare and writes are generally not issued after reads
+// begin, such as bulk loading.
 //
 // Parameters:
-//   count: Passed to the constructor of the underlying std::vector of each
-//     VectorRep. On initialization, the underlying array will be at least count
-//     bytes reserved for usage.
+//   count: Spread over the reservations of the underlying std::vectors of each
+//     VectorRep. On initialization, the underlying arrays will have at least
+//     count entries reserved for usage in total.
 class VectorRepFactory : public MemTableRepFactory {
   size_t count_;
 
@@ -384,6 +413,41 @@ class VectorRepFactory : public MemTableRepFactory {
   MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator&, Allocator*,
                                  const SliceTransform*,
                                  Logger* logger) override;
+
+  bool IsInsertConcurrentlySupported() const override { return true; }
+};
+
+// This creates MemTableReps that are backed by an adaptive radix tree over
+// the internal keys. Point lookups and inserts take time proportional to the
+// key length instead of the logarithm of the number of entries, and the tree
+// is usually shallower and more cache friendly than a skip list, which helps
+// point-heavy workloads. Entries are still kept in order, so iteration and
+// flush do not need to sort.
+//
+// The tree orders entries by the bytes of the user key, so it can only be
+// used with BytewiseComparator() and without user-defined timestamps. Opening
+// or creating a column family with any other comparator fails with
+// InvalidArgument. Concurrent inserts lock the tree nodes they change; reads
+// never block.
+class AdaptiveRadixTreeRepFactory : public MemTableRepFactory {
+ public:
+  AdaptiveRadixTreeRepFactory() {}
+
+  // Methods for Configurable/Customizable class overrides
+  static const char* kClassName() { return "AdaptiveRadixTreeRepFactory"; }
+  static const char* kNickName() { return "art"; }
+  const char* Name() const override { return kClassName(); }
+  const char* NickName() const override { return kNickName(); }
+
+  // Methods for MemTableRepFactory class overrides
+  using MemTableRepFactory::CreateMemTableRep;
+  MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator&, Allocator*,
+                                 const SliceTransform*,
+                                 Logger* logger) override;
+
+  bool IsInsertConcurrentlySupported() const override { return true; }
+
+  bool CanHandleDuplicatedKey() const override { return true; }
 };
 
 // This class contains a fixed array of buckets, each
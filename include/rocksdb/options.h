@@ -344,6 +344,41 @@ struct ColumnFamilyOptions : public AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   uint32_t memtable_max_range_deletions = 0;
 
+  // If > 1, a flush splits the key range of the memtables it flushes into up
+  // to this many partitions, and writes each partition to its own L0 file.
+  // The flush thread is helped by idle threads of the flush thread pool
+  // (Env::HIGH, or Env::LOW if it has none), so partitions are only written
+  // in parallel when such threads are available. The files of one flush do
+  // not overlap, which makes flushes of large memtables faster and lets
+  // compaction move them down independently. Each file is reported to
+  // EventListener::OnFlushCompleted() with its own FlushJobInfo. Partition
+  // boundaries are picked from a sample of the memtable keys so that the
+  // partitions are of similar size. If sst_partitioner_factory is set,
+  // boundaries are only placed where the partitioner requires a cut.
+  // Flushes that contain range deletions or too few entries are not
+  // partitioned, and neither are column families that use user-defined
+  // timestamps or a memtable rep other than the skip list and the adaptive
+  // radix tree (which support key sampling).
+  //
+  // Default: 1 (disabled)
+  //
+  // Dynamically changeable through SetOptions() API
+  uint32_t max_flush_partitions = 1;
+
+  // If true, iterators and compactions merge their sorted runs (memtables,
+  // L0 files and levels) with a tournament tree instead of a binary heap.
+  // The tree needs log2(N) key comparisons per key for N sorted runs, about
+  // half of what the heap needs when consecutive keys come from different
+  // runs, so it is faster for column families with many sorted runs, e.g.
+  // under universal compaction. The heap is faster when consecutive keys
+  // tend to come from the same run, and when there are only a few runs.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API. Iterators and
+  // compactions that already exist keep their setting.
+  bool use_tournament_tree_merge = false;
+
   // Create ColumnFamilyOptions with default values for all fields
   ColumnFamilyOptions();
   // Create ColumnFamilyOptions from Options
@@ -1110,6 +1145,20 @@ struct DBOptions {
   // Dynamically changeable through SetDBOptions() API.
   uint64_t delayed_write_rate = 0;
 
+  // If true, the write stalls and slowdowns a column family triggers (too
+  // many memtables, L0 files or pending compaction bytes) only apply to
+  // writes whose batches touch that column family. Each column family then
+  // has its own delayed write rate, starting at delayed_write_rate. Writes to
+  // other column families proceed, which keeps one column family that falls
+  // behind on compaction from stalling the whole DB. Stalls that are not
+  // caused by a single column family, such as WriteBufferManager stalls or
+  // background errors, still apply to every write. The stalls a column
+  // family imposed on writes are reported in its
+  // DB::Properties::kCFWriteStallStats.
+  //
+  // Default: false
+  bool write_stall_per_column_family = false;
+
   // By default, a single write thread queue is maintained. The thread gets
   // to the head of the queue becomes write batch group leader and responsible
   // for writing to WAL and memtable for the batch group.
@@ -1125,6 +1174,19 @@ struct DBOptions {
   // Default: false
   bool enable_pipelined_write = false;
 
+  // Only used if enable_pipelined_write is true. If true, the WAL of a sync
+  // write is synced by the memtable writer queue instead of the WAL writer
+  // queue. The leader of a WAL write group only appends its group to the WAL
+  // and hands it over, so the next group can be appended while the previous
+  // group is still being synced, and a single sync covers all groups
+  // appended before it started. A sync write is still inserted into the
+  // memtable, and thus made visible, only after its WAL is synced.
+  //
+  // Incompatible with manual_wal_flush and allow_mmap_writes.
+  //
+  // Default: false
+  bool enable_pipelined_wal_sync = false;
+
   // Setting unordered_write to true trades higher write throughput with
   // relaxing the immutability guarantee of snapshots. This violates the
   // repeatability one expects from ::Get from a snapshot, as well as
@@ -1151,6 +1213,31 @@ struct DBOptions {
   // Default: false
   bool unordered_write = false;
 
+  // If greater than 1, the WAL is split into this many shards, each with its
+  // own writer queue and its own log file. Concurrent writers are spread over
+  // the shards (by CPU core) so that WAL appends and group commit no longer
+  // serialize on a single queue. Sequence numbers are still allocated from a
+  // single counter and published in order, so snapshots keep their usual
+  // guarantees. On recovery the shard logs of one WAL generation are merged
+  // by sequence number and replay stops at the first gap, which gives
+  // prefix-consistent recovery under every wal_recovery_mode.
+  //
+  // Sharding is incompatible with enable_pipelined_write, unordered_write,
+  // two_write_queues, allow_2pc, manual_wal_flush, allow_mmap_writes,
+  // recycle_log_file_num > 0 and track_and_verify_wals_in_manifest. Writes
+  // with WriteOptions::disableWAL are rejected with Status::NotSupported.
+  // DB::GetUpdatesSince() is not supported either.
+  //
+  // A sharded WAL uses log record types that older releases report as
+  // corruption. Before downgrading, reopen the DB once with num_wal_shards = 1;
+  // that open flushes whatever it replays from a sharded WAL, even with
+  // avoid_flush_during_recovery, and leaves no sharded WAL behind. A shard log
+  // whose primary log is missing is treated as a corrupted record under
+  // wal_recovery_mode.
+  //
+  // Default: 1 (no sharding)
+  uint32_t num_wal_shards = 1;
+
   // If true, allow multi-writers to update mem tables in parallel.
   // Only some memtable_factory-s support concurrent writes; currently it
   // is implemented only for SkipListFactory.  Concurrent memtable writes
@@ -1161,6 +1248,27 @@ struct DBOptions {
   // Default: true
   bool allow_concurrent_memtable_write = true;
 
+  // If true, memtable arenas keep one pool of blocks per NUMA node, and each
+  // allocation is served from the pool of the node that runs the writing
+  // thread. Blocks of a pool are bound to its node, so writers on different
+  // sockets fill memory that is local to them. Has no effect unless RocksDB
+  // is built with NUMA support and the machine has more than one NUMA node.
+  // See the "rocksdb.memtable-numa-placed-bytes" and
+  // "rocksdb.memtable-numa-misplaced-bytes" properties.
+  //
+  // Default: false
+  bool memtable_numa_aware = false;
+
+  // If > 0, memtable arena blocks that are backed by reserved huge pages
+  // (see ColumnFamilyOptions::memtable_huge_page_size) are handed to a pool
+  // shared by all column families when their memtable is freed, and reused
+  // by later memtables instead of being unmapped. The pool keeps at most
+  // this many bytes. Reusing the pages avoids faulting in and zeroing fresh
+  // huge pages, and keeps them from being taken by other processes.
+  //
+  // Default: 0 (disabled)
+  size_t memtable_huge_page_pool_size = 0;
+
   // If true, threads synchronizing with the write batch group leader will
   // wait for up to write_thread_max_yield_usec before blocking on a mutex.
   // This can substantially improve throughput for concurrent workloads,
@@ -1648,6 +1756,17 @@ struct ReadOptions {
   // verified against corresponding checksums.
   bool verify_checksums = true;
 
+  // EXPERIMENTAL
+  //
+  // If true, along with verify_checksums, a block read from a block-based
+  // table is verified while it is uncompressed rather than in a separate
+  // pass beforehand: each piece of the compressed block is hashed just before
+  // the decompressor consumes it. Only applies to kZSTD blocks compressed
+  // without a dictionary in tables using kXXH3 checksums, and not when a
+  // persistent cache is configured or the file system can retry corrupt
+  // reads; other blocks are verified as usual.
+  bool fuse_checksum_with_decompression = false;
+
   // Should the "data block"/"index block" read for this iteration be placed in
   // block cache?
   // Callers may wish to set this field to false for bulk scans.
@@ -1676,6 +1795,18 @@ struct ReadOptions {
   // comes at the expense of slightly higher CPU overhead.
   bool optimize_multiget_for_io = true;
 
+  // If non-nullptr, GetEntity(), MultiGetEntity() and iterators only return
+  // the wide columns named here, in any order; names that an entity does not
+  // have are skipped. Plain values count as a single default column (see
+  // kDefaultWideColumnName), so they come back empty unless it is named, as
+  // does an iterator's value(). Get() and MultiGet() are not affected.
+  //
+  // In tables written with BlockBasedTableOptions::columnar_entity_blocks,
+  // only the requested columns are decompressed and decoded, unless the
+  // column family has a merge operator. The vector and the names must
+  // outlive the read or the iterator.
+  const std::vector<Slice>* column_projection = nullptr;
+
   // *** END options relevant to point lookups (as well as scans) ***
   // *** BEGIN options only relevant to iterators or scans ***
 
@@ -1689,6 +1820,16 @@ struct ReadOptions {
   // of forward iteration on spinning disks.
   size_t readahead_size = 0;
 
+  // Only used when async_io is true. The number of asynchronous reads that
+  // each table file iterator keeps in flight ahead of the block it is
+  // reading, each covering half of the current readahead size. With the
+  // default of 1, an iterator reads the next buffer while the current one is
+  // consumed. Larger values keep more reads queued on the device, so that a
+  // cold scan across many levels can approach the device bandwidth. Each
+  // extra read costs every table file iterator one more prefetch buffer.
+  // A value of 0 is treated as 1.
+  size_t async_io_readahead_depth = 1;
+
   // A threshold for the number of keys that can be skipped before failing an
   // iterator seek as incomplete. The default value of 0 should be used to
   // never fail a request as incomplete, even on skipping too many keys.
@@ -529,6 +529,11 @@ enum Tickers : uint32_t {
   // Footer corruption detected when opening an SST file for reading
   SST_FOOTER_CORRUPTION_COUNT,
 
+  // Insertions into a full cache accepted / rejected by a
+  // CacheAdmissionPolicy
+  CACHE_ADMISSION_ADMITS,
+  CACHE_ADMISSION_REJECTS,
+
   TICKER_ENUM_MAX
 };
 
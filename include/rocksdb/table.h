@@ -41,6 +41,7 @@ struct TableBuilderOptions;
 class TableBuilder;
 class TableFactory;
 class TableReader;
+class ThreadPool;
 class WritableFileWriter;
 struct ConfigOptions;
 struct EnvOptions;
@@ -232,6 +233,17 @@ struct BlockBasedTableOptions {
     // Makes the index significantly bigger (2x or more), especially when keys
     // are long.
     kBinarySearchWithFirstKey = 0x03,
+
+    // Like kBinarySearch, but the table also stores a small piecewise-linear
+    // model of the index block's restart keys, which predicts a window of a
+    // few restart points for each lookup. Seeks binary search only that
+    // window instead of the whole index block, touching fewer cache lines.
+    // Results do not depend on the model's accuracy.
+    // The model is only built with BytewiseComparator(); with other
+    // comparators this behaves exactly like kBinarySearch. Works best with
+    // keys whose leading bytes (after any prefix common to all keys of the
+    // file) are well spread, e.g. fixed-width integer keys.
+    kLearnedIndexSearch = 0x04,
   };
 
   IndexType index_type = kBinarySearch;
@@ -248,6 +260,44 @@ struct BlockBasedTableOptions {
   // kDataBlockBinaryAndHash.
   double data_block_hash_table_util_ratio = 0.75;
 
+  // If true, data blocks also store an 8-byte fingerprint of each restart
+  // key (the first 8 bytes of its user key) after the restart array. Seeks
+  // within a block then search the packed fingerprints, using SIMD where
+  // available, and only decode and compare the restart keys whose
+  // fingerprint ties with the target, instead of decoding a restart key for
+  // every step of the binary search. Costs 8 bytes per restart point.
+  //
+  // Only takes effect with BytewiseComparator(), and only for data blocks
+  // of at most 64KiB. Requires format_version >= 7, so that RocksDB versions
+  // that predate it refuse to open the files instead of misreading the
+  // number of restarts of their data blocks.
+  bool data_block_restart_fingerprints = false;
+
+  // If non-zero, the table stores a dictionary of up to this many bytes of
+  // key prefixes, as given by the column family's prefix_extractor, in a
+  // meta block. Data block keys that are not delta encoded against the
+  // previous key, including every restart key, then store a small
+  // dictionary reference in place of their prefix. This mostly shrinks
+  // data blocks with small restart intervals or with long prefixes shared
+  // by many keys, so that more of them fit in the block cache.
+  //
+  // Has no effect without a prefix_extractor, or with user-defined
+  // timestamps. Requires format_version >= 7, so that RocksDB versions that
+  // predate it refuse to open the files instead of misreading their keys.
+  size_t data_block_key_prefix_dict_max_bytes = 0;
+
+  // If true, the wide-column entities of each data block are stored column
+  // by column: the values of each column go to a mini-page that is
+  // compressed on its own, and the entries of the block refer to their row
+  // in these pages. Reads with ReadOptions::column_projection then only
+  // decompress and decode the pages of the requested columns. Data blocks
+  // that hold entities are not compressed as a whole, only their mini-pages
+  // are, and compression dictionaries do not apply to mini-pages.
+  //
+  // Requires format_version >= 7, so that RocksDB versions that predate it
+  // refuse to open the files instead of misreading their entities.
+  bool columnar_entity_blocks = false;
+
   // Option hash_index_allow_collision is now deleted.
   // It will behave as if hash_index_allow_collision=true.
 
@@ -269,6 +319,18 @@ struct BlockBasedTableOptions {
   // IF NULL, no page cache is used
   std::shared_ptr<PersistentCache> persistent_cache = nullptr;
 
+  // If non-NULL, MultiGet verifies and uncompresses the data blocks it reads
+  // from a file on the threads of this pool as well as on the calling
+  // thread, and inserts them into the block cache from there. This cuts
+  // the latency of batches that read many compressed blocks. The pool can
+  // be shared by many tables and DBs. Create it with NewSharedThreadPool(),
+  // which joins the threads when the last reference is released. When all
+  // of its threads are busy, the calling thread does the work on its own.
+  //
+  // Perf context counters for that work are not recorded when it runs on a
+  // pool thread.
+  std::shared_ptr<ThreadPool> decompression_thread_pool = nullptr;
+
   // Approximate size of user data packed per block.  Note that the
   // block size specified here corresponds to uncompressed data.  The
   // actual size of the unit read from disk may be smaller if
@@ -467,6 +529,22 @@ struct BlockBasedTableOptions {
   // algorithms.
   bool verify_compression = false;
 
+  // If true, the compression of each data block is chosen from its sampled
+  // compressibility rather than always being the column family's
+  // compression type: a block whose byte distribution is skewed enough that
+  // entropy coding alone would meet
+  // `CompressionOptions::max_compressed_bytes_per_kb` gets that compression
+  // type; otherwise only repeated byte sequences could make it compress, so
+  // it gets a fast compression algorithm (LZ4, or Snappy) and is stored
+  // uncompressed if that does not help. This saves most of the CPU spent on
+  // compressing already-compressed values with e.g. kZSTD, for little loss
+  // in compression. The outcome is counted in the table properties (see
+  // `TableProperties::adaptive_compression_slow_blocks` etc.).
+  //
+  // Has no effect with kNoCompression. Index and other meta blocks always use
+  // the column family's compression type.
+  bool adaptive_data_block_compression = false;
+
   // If used, For every data block we load into memory, we will create a bitmap
   // of size ((block_size / `read_amp_bytes_per_bit`) / 8) bytes. This bitmap
   // will be used to figure out the percentage we actually read of the blocks.
@@ -519,6 +597,10 @@ struct BlockBasedTableOptions {
   // misplaced within or between files is as likely to fail checksum
   // verification as random corruption. Also checksum-protects SST footer.
   // Can be read by RocksDB versions >= 8.6.0.
+  // 7 -- Allows data_block_key_prefix_dict_max_bytes,
+  // data_block_restart_fingerprints and columnar_entity_blocks. Otherwise the
+  // same as 6, but cannot be read by RocksDB versions that predate those
+  // options.
   //
   // Using the default setting of format_version is strongly recommended, so
   // that available enhancements are adopted eventually and automatically. The
@@ -679,6 +761,8 @@ struct BlockBasedTablePropertyNames {
   static const std::string kWholeKeyFiltering;
   // value is "1" for true and "0" for false.
   static const std::string kPrefixFiltering;
+  // value is "1" for true and "0" for false.
+  static const std::string kColumnarEntityBlocks;
 };
 
 // Create default block based table factory.
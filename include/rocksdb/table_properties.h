@@ -71,6 +71,9 @@ struct TablePropertiesNames {
   static const std::string kFileCreationTime;
   static const std::string kSlowCompressionEstimatedDataSize;
   static const std::string kFastCompressionEstimatedDataSize;
+  static const std::string kAdaptiveCompressionSlowBlocks;
+  static const std::string kAdaptiveCompressionFastBlocks;
+  static const std::string kAdaptiveCompressionUncompressedBlocks;
   static const std::string kSequenceNumberTimeMapping;
   static const std::string kTailStartOffset;
   static const std::string kUserDefinedTimestampsPersisted;
@@ -259,6 +262,13 @@ struct TableProperties {
   // compression algorithm (see `ColumnFamilyOptions::sample_for_compression`).
   // 0 means unknown.
   uint64_t fast_compression_estimated_data_size = 0;
+  // With `BlockBasedTableOptions::adaptive_data_block_compression`, the
+  // number of data blocks stored with the column family's compression type,
+  // with a faster compression algorithm, and uncompressed, respectively.
+  // All 0 otherwise.
+  uint64_t adaptive_compression_slow_blocks = 0;
+  uint64_t adaptive_compression_fast_blocks = 0;
+  uint64_t adaptive_compression_uncompressed_blocks = 0;
   // Offset of the value of the property "external sst file global seqno" in the
   // file if the property exists.
   // 0 means not exists.
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 
 #include "rocksdb/rocksdb_namespace.h"
 
@@ -64,4 +65,9 @@ class ThreadPool {
 // with `num_threads` background threads.
 ThreadPool* NewThreadPool(int num_threads);
 
+// Same as NewThreadPool(), but the returned pool joins its threads when the
+// last reference to it goes away, so it can be handed to options that share
+// ownership of a ThreadPool.
+std::shared_ptr<ThreadPool> NewSharedThreadPool(int num_threads);
+
 }  // namespace ROCKSDB_NAMESPACE
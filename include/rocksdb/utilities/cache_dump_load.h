@@ -109,6 +109,11 @@ class CacheDumper {
 class CacheDumpedLoader {
  public:
   virtual ~CacheDumpedLoader() = default;
+  // Only load the blocks of the SST files currently live in these DBs
+  virtual Status SetLoadFilter(std::vector<DB*> db_list) {
+    (void)db_list;
+    return Status::NotSupported("SetLoadFilter is not supported");
+  }
   virtual IOStatus RestoreCacheEntriesToSecondaryCache() {
     return IOStatus::NotSupported(
         "RestoreCacheEntriesToSecondaryCache is not supported");
@@ -141,4 +146,49 @@ Status NewDefaultCacheDumpedLoader(
     std::unique_ptr<CacheDumpReader>&& reader,
     std::unique_ptr<CacheDumpedLoader>* cache_dump_loader);
 
+// NOTE that: cache snapshots are EXPERIMENTAL! May be changed in the future!
+// A cache snapshot is a fast restart alternative to the CacheDumpWriter /
+// CacheDumpReader format. It holds the same blocks in a single file laid out
+// to be memory mapped: the saved blocks back to back, followed by an index of
+// fixed size entries sorted by cache key, and a fixed size footer. The footer,
+// the index and every block have their own crc32c checksum. Only blocks with
+// keys derived from SST unique IDs (see SetDumpFilter) are useful, since those
+// keys stay the same when the files are opened again after a restart.
+//
+// After a restart, a snapshot can either be
+// * bulk loaded into a SecondaryCache with NewCacheSnapshotLoader(), or
+// * used directly as a read-only SecondaryCache with
+// NewCacheSnapshotSecondaryCache(), so that blocks are lazily faulted in from
+// the mapped file on their first block cache miss.
+// Either way, a block is only ever looked up by the live SST file it was
+// dumped from, since its key is derived from that file's unique ID. Blocks of
+// files deleted in the meantime are never used, and can be skipped up front
+// with CacheDumpedLoader::SetLoadFilter().
+
+// Get a cache dumper that writes a snapshot of `cache` to `file_name` when
+// DumpCacheEntriesToWriter() is called. max_size_bytes and deadline of
+// `dump_options` are honored.
+Status NewCacheSnapshotDumper(const CacheDumpOptions& dump_options,
+                              const std::shared_ptr<Cache>& cache,
+                              const std::shared_ptr<FileSystem>& fs,
+                              const std::string& file_name,
+                              std::unique_ptr<CacheDumper>* cache_dumper);
+
+// Get a loader that bulk inserts the blocks of the snapshot in `file_name`
+// into `secondary_cache`. Blocks failing their checksum are skipped.
+// max_size_bytes and deadline of `dump_options` are honored.
+Status NewCacheSnapshotLoader(
+    const CacheDumpOptions& dump_options, const std::shared_ptr<FileSystem>& fs,
+    const std::string& file_name,
+    const std::shared_ptr<SecondaryCache>& secondary_cache,
+    std::unique_ptr<CacheDumpedLoader>* cache_dump_loader);
+
+// Open the snapshot in `file_name` as a read-only SecondaryCache, typically
+// for ShardedCacheOptions::secondary_cache of the block cache. Only the
+// footer and the index are validated when opening; each block is verified
+// when it is looked up, and treated as a miss if corrupted.
+Status NewCacheSnapshotSecondaryCache(
+    const std::shared_ptr<FileSystem>& fs, const std::string& file_name,
+    std::shared_ptr<SecondaryCache>* secondary_cache);
+
 }  // namespace ROCKSDB_NAMESPACE
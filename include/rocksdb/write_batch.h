@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <assert.h>
 #include <stdint.h>
 
 #include <atomic>
@@ -41,6 +42,7 @@ class Slice;
 class ColumnFamilyHandle;
 struct SavePoints;
 struct SliceParts;
+struct PinnedValues;
 
 struct SavePoint {
   size_t size;     // size of rep_
@@ -87,6 +89,22 @@ class WriteBatch : public WriteBatchBase {
   Status Put(ColumnFamilyHandle* column_family, const Slice& key,
              const Slice& ts, const Slice& value) override;
 
+  // Variant of Put() that does not copy `value` into the batch. The batch
+  // keeps a reference to the caller's buffer, and writing the batch copies
+  // the value from there straight into the WAL and the memtable. The caller
+  // must keep the buffer alive and unmodified until the batch is cleared or
+  // destroyed, or until MaterializePinnedValues(), Release(), SetSavePoint()
+  // or MarkWalTerminationPoint() copies the pinned values into the batch.
+  // Data() aborts until the values have been copied.
+  // Copies of the batch hold copies of the values. Values of column families
+  // with user-defined timestamps are copied as in Put(). Not for the batch
+  // of a WriteBatchWithIndex.
+  Status PutPinned(ColumnFamilyHandle* column_family, const Slice& key,
+                   const Slice& value);
+  Status PutPinned(const Slice& key, const Slice& value) {
+    return PutPinned(nullptr, key, value);
+  }
+
   // Variant of Put() that gathers output like writev(2).  The key and value
   // that will be written to the database are concatenations of arrays of
   // slices.
@@ -374,13 +392,25 @@ class WriteBatch : public WriteBatchBase {
   Status Iterate(Handler* handler) const;
 
   // Retrieve the serialized version of this batch.
-  const std::string& Data() const { return rep_; }
+  // Data() is invalid on a batch that holds values added with PutPinned(),
+  // since rep_ does not contain them; it aborts the process in all builds.
+  // Call MaterializePinnedValues() first.
+  const std::string& Data() const {
+    if (pinned_bytes_ != 0) {
+      AbortOnPinnedValues();
+    }
+    return rep_;
+  }
+
+  // Copies the values added with PutPinned() into the batch, after which the
+  // batch no longer refers to the caller's buffers.
+  void MaterializePinnedValues();
 
   // Release the serialized data and clear this batch.
   std::string Release();
 
   // Retrieve data size of the batch.
-  size_t GetDataSize() const { return rep_.size(); }
+  size_t GetDataSize() const { return rep_.size() + pinned_bytes_; }
 
   // Returns the number of updates in the batch
   uint32_t Count() const;
@@ -504,6 +534,15 @@ class WriteBatch : public WriteBatchBase {
   // Performs deferred computation of content_flags if necessary
   uint32_t ComputeContentFlags() const;
 
+  // Values added with PutPinned(), which rep_ does not hold.
+  std::unique_ptr<PinnedValues> pinned_values_;
+
+  // Total size of the values in pinned_values_.
+  size_t pinned_bytes_ = 0;
+
+  // Called by Data() on a batch that still refers to pinned values.
+  [[noreturn]] void AbortOnPinnedValues() const;
+
   // Maximum size of rep_.
   size_t max_bytes_;
 
@@ -512,7 +551,8 @@ class WriteBatch : public WriteBatchBase {
   size_t default_cf_ts_sz_ = 0;
 
  protected:
-  std::string rep_;  // See comment in write_batch.cc for the format of rep_
+  // See comment in write_batch.cc for the format of rep_.
+  std::string rep_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
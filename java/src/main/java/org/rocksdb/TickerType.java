@@ -878,6 +878,10 @@ public enum TickerType {
 
     SST_FOOTER_CORRUPTION_COUNT((byte) -0x55),
 
+    CACHE_ADMISSION_ADMITS((byte) -0x56),
+
+    CACHE_ADMISSION_REJECTS((byte) -0x57),
+
     TICKER_ENUM_MAX((byte) -0x54);
 
     private final byte value;
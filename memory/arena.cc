@@ -10,8 +10,14 @@
 #include "memory/arena.h"
 
 #include <algorithm>
+#include <vector>
+
+#ifdef NUMA
+#include <numaif.h>
+#endif
 
 #include "logging/logging.h"
+#include "memory/huge_page_pool.h"
 #include "port/malloc.h"
 #include "port/port.h"
 #include "rocksdb/env.h"
@@ -33,8 +39,12 @@ size_t Arena::OptimizeBlockSize(size_t block_size) {
   return block_size;
 }
 
-Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size)
-    : kBlockSize(OptimizeBlockSize(block_size)), tracker_(tracker) {
+Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size,
+             int numa_node, HugePageBlockPool* huge_page_pool)
+    : kBlockSize(OptimizeBlockSize(block_size)),
+      huge_page_pool_(huge_page_pool),
+      numa_node_(numa_node),
+      tracker_(tracker) {
   assert(kBlockSize >= kMinBlockSize && kBlockSize <= kMaxBlockSize &&
          kBlockSize % kAlignUnit == 0);
   TEST_SYNC_POINT_CALLBACK("Arena::Arena:0", const_cast<size_t*>(&kBlockSize));
@@ -43,6 +53,7 @@ Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size)
   aligned_alloc_ptr_ = inline_block_;
   unaligned_alloc_ptr_ = inline_block_ + alloc_bytes_remaining_;
   if (MemMapping::kHugePageSupported) {
+    huge_page_size_ = huge_page_size;
     hugetlb_size_ = huge_page_size;
     if (hugetlb_size_ && kBlockSize > hugetlb_size_) {
       hugetlb_size_ = ((kBlockSize - 1U) / hugetlb_size_ + 1U) * hugetlb_size_;
@@ -54,6 +65,11 @@ Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size)
 }
 
 Arena::~Arena() {
+  if (huge_page_pool_ != nullptr) {
+    for (auto& mm : huge_blocks_) {
+      huge_page_pool_->Release(std::move(mm), huge_page_size_);
+    }
+  }
   if (tracker_ != nullptr) {
     assert(tracker_->is_freed());
     tracker_->FreeMem();
@@ -73,7 +89,7 @@ char* Arena::AllocateFallback(size_t bytes, bool aligned) {
   char* block_head = nullptr;
   if (MemMapping::kHugePageSupported && hugetlb_size_ > 0) {
     size = hugetlb_size_;
-    block_head = AllocateFromHugePage(size);
+    block_head = AllocateFromHugePage(&size, kBlockSize);
   }
   if (!block_head) {
     size = kBlockSize;
@@ -92,14 +108,40 @@ char* Arena::AllocateFallback(size_t bytes, bool aligned) {
   }
 }
 
-char* Arena::AllocateFromHugePage(size_t bytes) {
-  MemMapping mm = MemMapping::AllocateHuge(bytes);
+char* Arena::AllocateFromHugePage(size_t* bytes, size_t min_bytes) {
+  assert(min_bytes <= *bytes);
+  MemMapping mm = huge_page_pool_ != nullptr
+                      ? huge_page_pool_->Allocate(*bytes, huge_page_size_)
+                      : MemMapping::AllocateHuge(*bytes, huge_page_size_);
   auto addr = static_cast<char*>(mm.Get());
+  // Granularity at which the pages of the block are faulted in
+  size_t page_size = huge_page_size_;
   if (addr) {
     huge_blocks_.push_back(std::move(mm));
-    blocks_memory_ += bytes;
+    hugetlb_bytes_ += *bytes;
+  } else {
+    // No reserved huge pages left. Transparent huge pages come in their own,
+    // usually smaller, size, so map only min_bytes rounded up to whole
+    // transparent huge pages instead of a block of huge_page_size_ (which
+    // may be 1GB). Less than one transparent huge page is not worth it.
+    const size_t thp_size = std::min(huge_page_size_, kTransparentHugePageSize);
+    if (min_bytes >= thp_size) {
+      *bytes = ((min_bytes - 1) / thp_size + 1) * thp_size;
+      mm = MemMapping::AllocateTransparentHuge(*bytes, thp_size);
+      addr = static_cast<char*>(mm.Get());
+      if (addr) {
+        // The kernel may still back the block with base pages.
+        page_size = port::kPageSize;
+        thp_blocks_.push_back(std::move(mm));
+        thp_bytes_ += *bytes;
+      }
+    }
+  }
+  if (addr) {
+    PlaceOnNumaNode(addr, *bytes, page_size);
+    blocks_memory_ += *bytes;
     if (tracker_ != nullptr) {
-      tracker_->Allocate(bytes);
+      tracker_->Allocate(*bytes);
     }
   }
   return addr;
@@ -114,7 +156,7 @@ char* Arena::AllocateAligned(size_t bytes, size_t huge_page_size,
         ((bytes - 1U) / huge_page_size + 1U) * huge_page_size;
     assert(reserved_size >= bytes);
 
-    char* addr = AllocateFromHugePage(reserved_size);
+    char* addr = AllocateFromHugePage(&reserved_size, bytes);
     if (addr == nullptr) {
       ROCKS_LOG_WARN(logger,
                      "AllocateAligned fail to allocate huge TLB pages: %s",
@@ -143,6 +185,26 @@ char* Arena::AllocateAligned(size_t bytes, size_t huge_page_size,
 }
 
 char* Arena::AllocateNewBlock(size_t block_bytes) {
+#ifdef NUMA
+  if (numa_node_ >= 0) {
+    // A NUMA policy stays with the pages it was set on, so blocks bound to a
+    // node are mapped by the arena itself rather than borrowed from malloc.
+    const size_t mapped_bytes =
+        (block_bytes + port::kPageSize - 1) / port::kPageSize * port::kPageSize;
+    MemMapping mm = MemMapping::AllocateLazyZeroed(mapped_bytes);
+    auto block = static_cast<char*>(mm.Get());
+    if (block != nullptr) {
+      numa_blocks_.push_back(std::move(mm));
+      PlaceOnNumaNode(block, mapped_bytes, port::kPageSize);
+      blocks_memory_ += mapped_bytes;
+      if (tracker_ != nullptr) {
+        tracker_->Allocate(mapped_bytes);
+      }
+      return block;
+    }
+    // Fall back to an unbound heap block.
+  }
+#endif  // NUMA
   // NOTE: std::make_unique zero-initializes the block so is not appropriate
   // here
   char* block = new char[block_bytes];
@@ -167,4 +229,52 @@ char* Arena::AllocateNewBlock(size_t block_bytes) {
   return block;
 }
 
+void Arena::PlaceOnNumaNode(char* block, size_t block_bytes,
+                            size_t page_size) {
+  if (numa_node_ < 0) {
+    return;
+  }
+#ifdef NUMA
+  // Blocks reaching here are page-aligned mappings owned by the arena. The
+  // policy only decides where pages are faulted in, so every page is written
+  // once before asking where it ended up; pages that were already populated
+  // (e.g. huge pages reused from a pool) keep their node.
+  assert(reinterpret_cast<uintptr_t>(block) % page_size == 0);
+  const size_t num_pages = block_bytes / page_size;
+  if (num_pages == 0) {
+    return;
+  }
+  const size_t kBitsPerWord = sizeof(unsigned long) * 8;
+  std::vector<unsigned long> nodemask(numa_node_ / kBitsPerWord + 1, 0);
+  nodemask[numa_node_ / kBitsPerWord] |= 1UL << (numa_node_ % kBitsPerWord);
+  if (mbind(block, num_pages * page_size, MPOL_PREFERRED, nodemask.data(),
+            nodemask.size() * kBitsPerWord + 1, 0) != 0) {
+    numa_misplaced_bytes_ += block_bytes;
+    return;
+  }
+  std::vector<void*> pages(num_pages);
+  for (size_t i = 0; i < num_pages; ++i) {
+    pages[i] = block + i * page_size;
+    // The block is not handed out yet, so its contents are still free to
+    // clobber.
+    *static_cast<volatile char*>(pages[i]) = 0;
+  }
+  // With no target nodes, move_pages() only reports the node of each page.
+  std::vector<int> nodes(num_pages, -1);
+  if (move_pages(0 /* self */, num_pages, pages.data(), nullptr, nodes.data(),
+                 0) != 0) {
+    numa_misplaced_bytes_ += block_bytes;
+    return;
+  }
+  size_t placed_pages = static_cast<size_t>(
+      std::count(nodes.begin(), nodes.end(), numa_node_));
+  numa_placed_bytes_ += placed_pages * page_size;
+  numa_misplaced_bytes_ += block_bytes - placed_pages * page_size;
+#else
+  (void)block;
+  (void)block_bytes;
+  (void)page_size;
+#endif  // NUMA
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -22,6 +22,8 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+class HugePageBlockPool;
+
 class Arena : public Allocator {
  public:
   // No copying allowed
@@ -31,6 +33,9 @@ class Arena : public Allocator {
   static constexpr size_t kInlineSize = 2048;
   static constexpr size_t kMinBlockSize = 4096;
   static constexpr size_t kMaxBlockSize = 2u << 30;
+  // Size of a transparent huge page: the PMD size on x86-64, and on arm64
+  // with 4KB base pages.
+  static constexpr size_t kTransparentHugePageSize = 2u << 20;
 
   static constexpr unsigned kAlignUnit = alignof(std::max_align_t);
   static_assert((kAlignUnit & (kAlignUnit - 1)) == 0,
@@ -38,9 +43,16 @@ class Arena : public Allocator {
 
   // huge_page_size: if 0, don't use huge page TLB. If > 0 (should set to the
   // supported hugepage size of the system), block allocation will try huge
-  // page TLB first. If allocation fails, will fall back to normal case.
+  // page TLB first. If no huge pages are available, blocks are allocated
+  // aligned to huge_page_size and advised to use transparent huge pages.
+  // numa_node: if >= 0, the pages of every block are bound to this NUMA node
+  // (best effort, only when built with NUMA support).
+  // huge_page_pool: if not nullptr, huge page blocks are taken from and
+  // returned to this pool.
   explicit Arena(size_t block_size = kMinBlockSize,
-                 AllocTracker* tracker = nullptr, size_t huge_page_size = 0);
+                 AllocTracker* tracker = nullptr, size_t huge_page_size = 0,
+                 int numa_node = -1,
+                 HugePageBlockPool* huge_page_pool = nullptr);
   ~Arena();
 
   char* Allocate(size_t bytes) override;
@@ -64,7 +76,8 @@ class Arena : public Allocator {
   // by the arena (exclude the space allocated but not yet used for future
   // allocations).
   size_t ApproximateMemoryUsage() const {
-    return blocks_memory_ + blocks_.size() * sizeof(char*) -
+    return blocks_memory_ +
+           (blocks_.size() + numa_blocks_.size()) * sizeof(char*) -
            alloc_bytes_remaining_;
   }
 
@@ -78,8 +91,20 @@ class Arena : public Allocator {
 
   size_t BlockSize() const override { return kBlockSize; }
 
+  // Bytes of block pages that were, respectively were not, faulted in on
+  // numa_node when their block was allocated. Both are 0 if the arena was not
+  // given a NUMA node.
+  size_t NumaPlacedBytes() const { return numa_placed_bytes_; }
+  size_t NumaMisplacedBytes() const { return numa_misplaced_bytes_; }
+
+  // Bytes of blocks backed by reserved huge pages (MAP_HUGETLB), and of
+  // blocks that were advised to use transparent huge pages instead.
+  size_t HugeTlbBytes() const { return hugetlb_bytes_; }
+  size_t TransparentHugePageBytes() const { return thp_bytes_; }
+
   bool IsInInlineBlock() const {
-    return blocks_.empty() && huge_blocks_.empty();
+    return blocks_.empty() && numa_blocks_.empty() && huge_blocks_.empty() &&
+           thp_blocks_.empty();
   }
 
   // check and adjust the block_size so that the return value is
@@ -93,8 +118,13 @@ class Arena : public Allocator {
   const size_t kBlockSize;
   // Allocated memory blocks
   std::deque<std::unique_ptr<char[]>> blocks_;
+  // Blocks bound to numa_node_, mapped separately so that the policy does not
+  // outlive them on heap memory
+  std::deque<MemMapping> numa_blocks_;
   // Huge page allocations
   std::deque<MemMapping> huge_blocks_;
+  // Transparent huge page allocations
+  std::deque<MemMapping> thp_blocks_;
   size_t irregular_block_num = 0;
 
   // Stats for current active block.
@@ -108,13 +138,26 @@ class Arena : public Allocator {
   size_t alloc_bytes_remaining_ = 0;
 
   size_t hugetlb_size_ = 0;
+  size_t huge_page_size_ = 0;
+  HugePageBlockPool* const huge_page_pool_;
 
-  char* AllocateFromHugePage(size_t bytes);
+  // Allocates *bytes of reserved huge pages or, if none are left, at least
+  // min_bytes backed by transparent huge pages, and sets *bytes to the size
+  // of the block. Returns nullptr if neither works.
+  char* AllocateFromHugePage(size_t* bytes, size_t min_bytes);
   char* AllocateFallback(size_t bytes, bool aligned);
   char* AllocateNewBlock(size_t block_bytes);
+  // Binds the page-aligned mapping block to numa_node_, faults in each of its
+  // pages of page_size and counts where they landed.
+  void PlaceOnNumaNode(char* block, size_t block_bytes, size_t page_size);
 
   // Bytes of memory in blocks allocated so far
   size_t blocks_memory_ = 0;
+  const int numa_node_;
+  size_t numa_placed_bytes_ = 0;
+  size_t numa_misplaced_bytes_ = 0;
+  size_t hugetlb_bytes_ = 0;
+  size_t thp_bytes_ = 0;
   // Non-owned
   AllocTracker* tracker_;
 };
@@ -12,6 +12,12 @@
 #ifndef OS_WIN
 #include <sys/resource.h>
 #endif
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "memory/concurrent_arena.h"
+#include "memory/huge_page_pool.h"
 #include "port/jemalloc_helper.h"
 #include "port/port.h"
 #include "test_util/testharness.h"
@@ -203,6 +209,143 @@ TEST_F(ArenaTest, Simple) {
   SimpleTest(kHugePageSize);
 }
 
+TEST_F(ArenaTest, NumaNodePlacement) {
+  constexpr size_t kBlockSize = 64 * 1024;
+  constexpr int kNumBlocks = 4;
+  Arena arena(kBlockSize, nullptr, 0, 0 /* numa_node */);
+  // Each of these allocations gets an irregular block of its own.
+  for (int i = 0; i < kNumBlocks; i++) {
+    ASSERT_NE(arena.AllocateAligned(kBlockSize / 2 + 1), nullptr);
+  }
+#ifdef NUMA
+  // Blocks are mapped in whole pages, and every page is accounted for,
+  // whether or not the kernel let us bind it.
+  const size_t mapped_bytes =
+      (kBlockSize / 2 + port::kPageSize) / port::kPageSize * port::kPageSize;
+  ASSERT_EQ(arena.NumaPlacedBytes() + arena.NumaMisplacedBytes(),
+            kNumBlocks * mapped_bytes);
+  ASSERT_EQ(arena.NumaPlacedBytes() % port::kPageSize, 0);
+  ASSERT_EQ(arena.MemoryAllocatedBytes(),
+            Arena::kInlineSize + kNumBlocks * mapped_bytes);
+#else
+  ASSERT_EQ(arena.NumaPlacedBytes(), 0);
+  ASSERT_EQ(arena.NumaMisplacedBytes(), 0);
+#endif  // NUMA
+
+  Arena plain_arena(kBlockSize);
+  ASSERT_NE(plain_arena.AllocateAligned(kBlockSize / 2), nullptr);
+  ASSERT_EQ(plain_arena.NumaPlacedBytes(), 0);
+  ASSERT_EQ(plain_arena.NumaMisplacedBytes(), 0);
+}
+
+TEST_F(ArenaTest, NumaAwareConcurrentArena) {
+  constexpr size_t kBlockSize = 64 * 1024;
+  constexpr int kThreads = 4;
+  constexpr int kAllocsPerThread = 10000;
+  ConcurrentArena arena(kBlockSize, nullptr, 0, true /* numa_aware */);
+  std::atomic<size_t> requested{0};
+
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&arena, &requested, t]() {
+      Random rnd(301 + t);
+      for (int i = 0; i < kAllocsPerThread; i++) {
+        size_t bytes = 1 + rnd.Uniform(200);
+        char* p = (i % 2 == 0) ? arena.AllocateAligned(bytes)
+                               : arena.Allocate(bytes);
+        memset(p, t, bytes);
+        requested.fetch_add(bytes, std::memory_order_relaxed);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_GE(arena.MemoryAllocatedBytes(), requested.load());
+  ASSERT_GE(arena.ApproximateMemoryUsage(), requested.load());
+  size_t numa_bytes = arena.NumaPlacedBytes() + arena.NumaMisplacedBytes();
+  if (ConcurrentArena::NumNumaNodes() > 1) {
+    // Everything beyond the inline blocks came from node-bound blocks.
+    ASSERT_GT(numa_bytes, 0);
+    ASSERT_LE(numa_bytes, arena.MemoryAllocatedBytes());
+  } else {
+    ASSERT_EQ(numa_bytes, 0);
+  }
+}
+
+TEST_F(ArenaTest, TransparentHugePageFallback) {
+  if (!MemMapping::kHugePageSupported) {
+    ROCKSDB_GTEST_BYPASS("Huge pages are not supported");
+    return;
+  }
+  Arena arena(kHugePageSize, nullptr, kHugePageSize);
+  // Use up the inline block so that the next allocation needs a block.
+  ASSERT_NE(arena.AllocateAligned(Arena::kInlineSize / 2), nullptr);
+  ASSERT_NE(arena.AllocateAligned(Arena::kInlineSize / 2), nullptr);
+  ASSERT_EQ(arena.HugeTlbBytes() + arena.TransparentHugePageBytes(), 0);
+  char* block = arena.AllocateAligned(64);
+  ASSERT_NE(block, nullptr);
+  // The first block is a whole huge page, either reserved or transparent.
+  ASSERT_EQ(arena.HugeTlbBytes() + arena.TransparentHugePageBytes(),
+            kHugePageSize);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(block) % kHugePageSize, 0);
+  memset(block, 1, kHugePageSize);
+
+  // Without reserved 1GB pages, a 4MB block falls back to 4MB of transparent
+  // huge pages rather than to a whole 1GB page.
+  const size_t kGigaHugePageSize = size_t{1} << 30;
+  const size_t kBlockSize = 2 * Arena::kTransparentHugePageSize;
+  Arena giga_arena(kBlockSize, nullptr, kGigaHugePageSize);
+  ASSERT_NE(giga_arena.AllocateAligned(Arena::kInlineSize / 2), nullptr);
+  ASSERT_NE(giga_arena.AllocateAligned(Arena::kInlineSize / 2), nullptr);
+  ASSERT_NE(giga_arena.AllocateAligned(64), nullptr);
+  if (giga_arena.HugeTlbBytes() == 0) {
+    ASSERT_EQ(giga_arena.TransparentHugePageBytes(), kBlockSize);
+    ASSERT_LT(giga_arena.MemoryAllocatedBytes(), 2 * kBlockSize);
+  }
+
+  // A block smaller than a transparent huge page is not worth mapping one.
+  Arena small_arena(Arena::kMinBlockSize, nullptr, kHugePageSize);
+  ASSERT_NE(small_arena.AllocateAligned(Arena::kInlineSize / 2), nullptr);
+  ASSERT_NE(small_arena.AllocateAligned(Arena::kInlineSize / 2), nullptr);
+  ASSERT_NE(small_arena.AllocateAligned(64), nullptr);
+  ASSERT_EQ(small_arena.TransparentHugePageBytes(), 0);
+
+  Arena plain_arena;
+  ASSERT_NE(plain_arena.AllocateAligned(Arena::kMinBlockSize), nullptr);
+  ASSERT_EQ(plain_arena.HugeTlbBytes(), 0);
+  ASSERT_EQ(plain_arena.TransparentHugePageBytes(), 0);
+}
+
+TEST_F(ArenaTest, HugePageBlockPool) {
+  if (!MemMapping::kHugePageSupported) {
+    ROCKSDB_GTEST_BYPASS("Huge pages are not supported");
+    return;
+  }
+  HugePageBlockPool pool(kHugePageSize);
+  size_t hugetlb_bytes;
+  {
+    Arena arena(Arena::kMinBlockSize, nullptr, kHugePageSize, -1, &pool);
+    ASSERT_NE(arena.AllocateAligned(Arena::kInlineSize), nullptr);
+    ASSERT_NE(arena.AllocateAligned(64), nullptr);
+    hugetlb_bytes = arena.HugeTlbBytes();
+    ASSERT_EQ(pool.GetRetainedBytes(), 0);
+  }
+  // Only reserved huge pages are pooled, and only up to the capacity.
+  ASSERT_EQ(pool.GetRetainedBytes(), std::min(hugetlb_bytes, kHugePageSize));
+
+  size_t retained = pool.GetRetainedBytes();
+  {
+    Arena arena(Arena::kMinBlockSize, nullptr, kHugePageSize, -1, &pool);
+    ASSERT_NE(arena.AllocateAligned(Arena::kInlineSize), nullptr);
+    ASSERT_NE(arena.AllocateAligned(64), nullptr);
+    ASSERT_EQ(pool.GetRetainedBytes(), retained > 0 ? retained - kHugePageSize
+                                                    : size_t{0});
+  }
+  ASSERT_LE(pool.GetRetainedBytes(), pool.GetCapacity());
+}
+
 // Number of minor page faults since last call
 size_t PopMinorPageFaultCount() {
 #ifdef RUSAGE_SELF
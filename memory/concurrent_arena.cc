@@ -11,6 +11,10 @@
 
 #include <thread>
 
+#ifdef NUMA
+#include <numa.h>
+#endif
+
 #include "port/port.h"
 #include "util/random.h"
 
@@ -24,16 +28,80 @@ namespace {
 // 1MB, 64 cores will quickly allocate 64MB, and may quickly trigger a
 // flush. Cap the size instead.
 const size_t kMaxShardBlockSize = size_t{128 * 1024};
+
+#ifdef NUMA
+struct NumaTopology {
+  size_t num_nodes = 1;
+  std::vector<size_t> node_of_cpu;
+
+  NumaTopology() {
+    if (numa_available() < 0) {
+      return;
+    }
+    num_nodes = static_cast<size_t>(numa_max_node()) + 1;
+    int num_cpus = numa_num_configured_cpus();
+    node_of_cpu.resize(num_cpus > 0 ? num_cpus : 0, 0);
+    for (int cpu = 0; cpu < num_cpus; ++cpu) {
+      int node = numa_node_of_cpu(cpu);
+      node_of_cpu[cpu] = node > 0 ? static_cast<size_t>(node) : 0;
+    }
+  }
+};
+
+const NumaTopology& GetNumaTopology() {
+  static const NumaTopology topology;
+  return topology;
+}
+#endif  // NUMA
 }  // namespace
 
 ConcurrentArena::ConcurrentArena(size_t block_size, AllocTracker* tracker,
-                                 size_t huge_page_size)
+                                 size_t huge_page_size, bool numa_aware,
+                                 HugePageBlockPool* huge_page_pool)
+    : ConcurrentArena(block_size, tracker, huge_page_size, -1 /* numa_node */,
+                      huge_page_pool) {
+  if (numa_aware) {
+    size_t num_nodes = NumNumaNodes();
+    if (num_nodes > 1) {
+      node_arenas_.reserve(num_nodes);
+      for (size_t node = 0; node < num_nodes; ++node) {
+        node_arenas_.emplace_back(
+            new ConcurrentArena(block_size, tracker, huge_page_size,
+                                static_cast<int>(node), huge_page_pool));
+      }
+    }
+  }
+}
+
+ConcurrentArena::ConcurrentArena(size_t block_size, AllocTracker* tracker,
+                                 size_t huge_page_size, int numa_node,
+                                 HugePageBlockPool* huge_page_pool)
     : shard_block_size_(std::min(kMaxShardBlockSize, block_size / 8)),
       shards_(),
-      arena_(block_size, tracker, huge_page_size) {
+      arena_(block_size, tracker, huge_page_size, numa_node, huge_page_pool) {
   Fixup();
 }
 
+size_t ConcurrentArena::NumNumaNodes() {
+#ifdef NUMA
+  return GetNumaTopology().num_nodes;
+#else
+  return 1;
+#endif  // NUMA
+}
+
+ConcurrentArena* ConcurrentArena::LocalNodeArena() {
+  size_t node = 0;
+#ifdef NUMA
+  const auto& node_of_cpu = GetNumaTopology().node_of_cpu;
+  int cpu = port::PhysicalCoreID();
+  if (cpu >= 0 && static_cast<size_t>(cpu) < node_of_cpu.size()) {
+    node = node_of_cpu[cpu];
+  }
+#endif  // NUMA
+  return node_arenas_[node < node_arenas_.size() ? node : 0].get();
+}
+
 ConcurrentArena::Shard* ConcurrentArena::Repick() {
   auto shard_and_index = shards_.AccessElementAndIndex();
   // even if we are cpu 0, use a non-zero tls_cpuid so we can tell we
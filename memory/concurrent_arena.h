@@ -11,6 +11,7 @@
 #include <atomic>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "memory/allocator.h"
 #include "memory/arena.h"
@@ -39,23 +40,36 @@ class Logger;
 // only if ConcurrentArena actually notices concurrent use, and they
 // adjust their size so that there is no fragmentation waste when the
 // shard blocks are allocated from the underlying main arena.
+//
+// If it is NUMA aware and the machine has more than one NUMA node, a
+// ConcurrentArena instead forwards every allocation to one child
+// ConcurrentArena per node, picked by the node of the calling thread's
+// CPU. The blocks of a child are bound to its node.
 class ConcurrentArena : public Allocator {
  public:
   // block_size and huge_page_size are the same as for Arena (and are
   // in fact just passed to the constructor of arena_.  The core-local
   // shards compute their shard_block_size as a fraction of block_size
   // that varies according to the hardware concurrency level.
+  // huge_page_pool is passed to the underlying arena(s) as well.
   explicit ConcurrentArena(size_t block_size = Arena::kMinBlockSize,
                            AllocTracker* tracker = nullptr,
-                           size_t huge_page_size = 0);
+                           size_t huge_page_size = 0, bool numa_aware = false,
+                           HugePageBlockPool* huge_page_pool = nullptr);
 
   char* Allocate(size_t bytes) override {
+    if (UNLIKELY(!node_arenas_.empty())) {
+      return LocalNodeArena()->Allocate(bytes);
+    }
     return AllocateImpl(bytes, false /*force_arena*/,
                         [this, bytes]() { return arena_.Allocate(bytes); });
   }
 
   char* AllocateAligned(size_t bytes, size_t huge_page_size = 0,
                         Logger* logger = nullptr) override {
+    if (UNLIKELY(!node_arenas_.empty())) {
+      return LocalNodeArena()->AllocateAligned(bytes, huge_page_size, logger);
+    }
     size_t rounded_up = ((bytes - 1) | (sizeof(void*) - 1)) + 1;
     assert(rounded_up >= bytes && rounded_up < bytes + sizeof(void*) &&
            (rounded_up % sizeof(void*)) == 0);
@@ -70,24 +84,85 @@ class ConcurrentArena : public Allocator {
   size_t ApproximateMemoryUsage() const {
     std::unique_lock<SpinMutex> lock(arena_mutex_, std::defer_lock);
     lock.lock();
-    return arena_.ApproximateMemoryUsage() - ShardAllocatedAndUnused();
+    size_t total = arena_.ApproximateMemoryUsage() - ShardAllocatedAndUnused();
+    lock.unlock();
+    for (const auto& node_arena : node_arenas_) {
+      total += node_arena->ApproximateMemoryUsage();
+    }
+    return total;
   }
 
   size_t MemoryAllocatedBytes() const {
-    return memory_allocated_bytes_.load(std::memory_order_relaxed);
+    size_t total = memory_allocated_bytes_.load(std::memory_order_relaxed);
+    for (const auto& node_arena : node_arenas_) {
+      total += node_arena->MemoryAllocatedBytes();
+    }
+    return total;
   }
 
   size_t AllocatedAndUnused() const {
-    return arena_allocated_and_unused_.load(std::memory_order_relaxed) +
-           ShardAllocatedAndUnused();
+    size_t total =
+        arena_allocated_and_unused_.load(std::memory_order_relaxed) +
+        ShardAllocatedAndUnused();
+    for (const auto& node_arena : node_arenas_) {
+      total += node_arena->AllocatedAndUnused();
+    }
+    return total;
   }
 
   size_t IrregularBlockNum() const {
-    return irregular_block_num_.load(std::memory_order_relaxed);
+    size_t total = irregular_block_num_.load(std::memory_order_relaxed);
+    for (const auto& node_arena : node_arenas_) {
+      total += node_arena->IrregularBlockNum();
+    }
+    return total;
+  }
+
+  // Bytes of blocks whose pages were on the NUMA node requested for them,
+  // respectively on another node, when they were allocated. This is the
+  // placement reported at allocation time, not where later accesses land.
+  // Both are 0 unless the arena is NUMA aware and the machine has more than
+  // one NUMA node.
+  size_t NumaPlacedBytes() const {
+    size_t total = numa_placed_bytes_.load(std::memory_order_relaxed);
+    for (const auto& node_arena : node_arenas_) {
+      total += node_arena->NumaPlacedBytes();
+    }
+    return total;
+  }
+
+  size_t NumaMisplacedBytes() const {
+    size_t total = numa_misplaced_bytes_.load(std::memory_order_relaxed);
+    for (const auto& node_arena : node_arenas_) {
+      total += node_arena->NumaMisplacedBytes();
+    }
+    return total;
+  }
+
+  // Bytes of blocks backed by reserved huge pages, respectively advised to
+  // use transparent huge pages. See Arena.
+  size_t HugeTlbBytes() const {
+    size_t total = hugetlb_bytes_.load(std::memory_order_relaxed);
+    for (const auto& node_arena : node_arenas_) {
+      total += node_arena->HugeTlbBytes();
+    }
+    return total;
+  }
+
+  size_t TransparentHugePageBytes() const {
+    size_t total = thp_bytes_.load(std::memory_order_relaxed);
+    for (const auto& node_arena : node_arenas_) {
+      total += node_arena->TransparentHugePageBytes();
+    }
+    return total;
   }
 
   size_t BlockSize() const override { return arena_.BlockSize(); }
 
+  // Number of NUMA nodes of the machine, or 1 if RocksDB is built without
+  // NUMA support or the kernel does not support it.
+  static size_t NumNumaNodes();
+
  private:
   struct Shard {
     char padding[40] ROCKSDB_FIELD_UNUSED;
@@ -100,6 +175,11 @@ class ConcurrentArena : public Allocator {
 
   static thread_local size_t tls_cpuid;
 
+  // Creates the child arena that serves the threads running on numa_node.
+  ConcurrentArena(size_t block_size, AllocTracker* tracker,
+                  size_t huge_page_size, int numa_node,
+                  HugePageBlockPool* huge_page_pool);
+
   char padding0[56] ROCKSDB_FIELD_UNUSED;
 
   size_t shard_block_size_;
@@ -111,11 +191,21 @@ class ConcurrentArena : public Allocator {
   std::atomic<size_t> arena_allocated_and_unused_;
   std::atomic<size_t> memory_allocated_bytes_;
   std::atomic<size_t> irregular_block_num_;
+  std::atomic<size_t> numa_placed_bytes_;
+  std::atomic<size_t> numa_misplaced_bytes_;
+  std::atomic<size_t> hugetlb_bytes_;
+  std::atomic<size_t> thp_bytes_;
 
   char padding1[56] ROCKSDB_FIELD_UNUSED;
 
+  // One child arena per NUMA node, indexed by node. Empty unless the arena
+  // is NUMA aware and there is more than one node.
+  std::vector<std::unique_ptr<ConcurrentArena>> node_arenas_;
+
   Shard* Repick();
 
+  ConcurrentArena* LocalNodeArena();
+
   size_t ShardAllocatedAndUnused() const {
     size_t total = 0;
     for (size_t i = 0; i < shards_.Size(); ++i) {
@@ -206,6 +296,13 @@ class ConcurrentArena : public Allocator {
                                   std::memory_order_relaxed);
     irregular_block_num_.store(arena_.IrregularBlockNum(),
                                std::memory_order_relaxed);
+    numa_placed_bytes_.store(arena_.NumaPlacedBytes(),
+                             std::memory_order_relaxed);
+    numa_misplaced_bytes_.store(arena_.NumaMisplacedBytes(),
+                                std::memory_order_relaxed);
+    hugetlb_bytes_.store(arena_.HugeTlbBytes(), std::memory_order_relaxed);
+    thp_bytes_.store(arena_.TransparentHugePageBytes(),
+                     std::memory_order_relaxed);
   }
 
   ConcurrentArena(const ConcurrentArena&) = delete;
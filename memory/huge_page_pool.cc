@@ -0,0 +1,51 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "memory/huge_page_pool.h"
+
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+MemMapping HugePageBlockPool::Allocate(size_t length, size_t huge_page_size) {
+  {
+    MutexLock l(&mutex_);
+    auto it = free_mappings_.find(std::make_pair(huge_page_size, length));
+    if (it != free_mappings_.end()) {
+      assert(!it->second.empty());
+      MemMapping mm = std::move(it->second.back());
+      it->second.pop_back();
+      if (it->second.empty()) {
+        free_mappings_.erase(it);
+      }
+      assert(retained_bytes_ >= length);
+      retained_bytes_ -= length;
+      return mm;
+    }
+  }
+  return MemMapping::AllocateHuge(length, huge_page_size);
+}
+
+void HugePageBlockPool::Release(MemMapping&& mapping, size_t huge_page_size) {
+  if (mapping.Get() == nullptr) {
+    return;
+  }
+  MutexLock l(&mutex_);
+  size_t length = mapping.Length();
+  if (retained_bytes_ + length > capacity_) {
+    // Unmapped when `mapping` goes out of scope in the caller.
+    return;
+  }
+  free_mappings_[std::make_pair(huge_page_size, length)].push_back(
+      std::move(mapping));
+  retained_bytes_ += length;
+}
+
+size_t HugePageBlockPool::GetRetainedBytes() const {
+  MutexLock l(&mutex_);
+  return retained_bytes_;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
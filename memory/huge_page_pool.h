@@ -0,0 +1,57 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "port/mmap.h"
+#include "port/port.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// HugePageBlockPool keeps the huge page mappings of arena blocks that are no
+// longer needed, so that later arenas reuse the pages instead of handing
+// them back to the kernel and faulting them in (and zeroing them) again.
+// The memtables of all column families of a DB share one pool; see
+// DBOptions::memtable_huge_page_pool_size.
+//
+// Thread safe.
+class HugePageBlockPool {
+ public:
+  // capacity: maximum number of bytes of free mappings kept for reuse.
+  explicit HugePageBlockPool(size_t capacity) : capacity_(capacity) {}
+
+  // No copying allowed
+  HugePageBlockPool(const HugePageBlockPool&) = delete;
+  void operator=(const HugePageBlockPool&) = delete;
+
+  // Returns a mapping of `length` bytes backed by huge pages of
+  // huge_page_size, reusing a free mapping of the same size if there is
+  // one. Returns an empty mapping (Get() == nullptr) if no huge pages are
+  // available.
+  MemMapping Allocate(size_t length, size_t huge_page_size);
+
+  // Takes back a mapping returned by Allocate() with the same
+  // huge_page_size. It is kept for reuse unless the pool is full.
+  void Release(MemMapping&& mapping, size_t huge_page_size);
+
+  // Number of bytes of free mappings currently kept in the pool.
+  size_t GetRetainedBytes() const;
+
+  size_t GetCapacity() const { return capacity_; }
+
+ private:
+  const size_t capacity_;
+  mutable port::Mutex mutex_;
+  size_t retained_bytes_ = 0;
+  // Free mappings, by huge page size and length.
+  std::map<std::pair<size_t, size_t>, std::vector<MemMapping>> free_mappings_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
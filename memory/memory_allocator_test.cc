@@ -4,10 +4,13 @@
 //  COPYING file in the root directory) and Apache 2.0 License
 //  (found in the LICENSE.Apache file in the root directory).
 
+#include <algorithm>
 #include <cstdio>
+#include <set>
 
 #include "memory/jemalloc_nodump_allocator.h"
 #include "memory/memkind_kmem_allocator.h"
+#include "memory/slab_memory_allocator.h"
 #include "rocksdb/cache.h"
 #include "rocksdb/convenience.h"
 #include "rocksdb/db.h"
@@ -209,9 +212,101 @@ TEST_F(CreateMemoryAllocatorTest, NewJemallocNodumpAllocator) {
   ASSERT_EQ(opts->limit_tcache_size, jopts.limit_tcache_size);
 }
 
+TEST_F(CreateMemoryAllocatorTest, SlabOptionsTest) {
+  std::shared_ptr<MemoryAllocator> allocator;
+  std::string id = std::string("id=") + SlabMemoryAllocator::kClassName();
+  ASSERT_OK(MemoryAllocator::CreateFromString(config_options_, id, &allocator));
+  ASSERT_NE(allocator, nullptr);
+  SlabAllocatorOptions sopts;
+  auto opts = allocator->GetOptions<SlabAllocatorOptions>();
+  ASSERT_NE(opts, nullptr);
+  ASSERT_EQ(opts->slab_size, sopts.slab_size);
+  ASSERT_EQ(opts->max_slab_allocation_size, sopts.max_slab_allocation_size);
+  ASSERT_EQ(opts->num_shards, sopts.num_shards);
+
+  ASSERT_NOK(MemoryAllocator::CreateFromString(
+      config_options_,
+      id + "; slab_size=65536; max_slab_allocation_size=65536", &allocator));
+  ASSERT_NOK(MemoryAllocator::CreateFromString(config_options_,
+                                               id + "; num_shards=0",
+                                               &allocator));
+  ASSERT_OK(MemoryAllocator::CreateFromString(
+      config_options_,
+      id + "; slab_size=65536; max_slab_allocation_size=16384; num_shards=2",
+      &allocator));
+  opts = allocator->GetOptions<SlabAllocatorOptions>();
+  ASSERT_NE(opts, nullptr);
+  ASSERT_EQ(opts->slab_size, 65536U);
+  ASSERT_EQ(opts->max_slab_allocation_size, 16384U);
+  ASSERT_EQ(opts->num_shards, 2U);
+}
+
+TEST_F(CreateMemoryAllocatorTest, SlabPacking) {
+  SlabAllocatorOptions sopts;
+  sopts.slab_size = 64 << 10;
+  sopts.max_slab_allocation_size = 16 << 10;
+  sopts.num_shards = 1;
+  ASSERT_NOK(NewSlabMemoryAllocator(sopts, nullptr));
+  std::shared_ptr<MemoryAllocator> allocator;
+  ASSERT_OK(NewSlabMemoryAllocator(sopts, &allocator));
+  auto slab_allocator = static_cast<SlabMemoryAllocator*>(allocator.get());
+
+  // With its header, a 4000 byte block takes a 4096 byte chunk, 16 of which
+  // fill a slab. The block can use the chunk up to the next header.
+  std::vector<char*> blocks;
+  for (int i = 0; i < 64; ++i) {
+    char* p = static_cast<char*>(allocator->Allocate(4000));
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(p) % 16);
+    ASSERT_EQ(4096 - 16, allocator->UsableSize(p, 4000));
+    memset(p, i, 4096 - 16);
+    blocks.push_back(p);
+  }
+  ASSERT_EQ(4 * sopts.slab_size, slab_allocator->GetSlabBytes());
+  ASSERT_EQ(64 * (4096 - 16), slab_allocator->GetAllocatedBytes());
+
+  // Too large to be packed.
+  void* large = allocator->Allocate(20000);
+  ASSERT_EQ(20000, allocator->UsableSize(large, 20000));
+  ASSERT_EQ(4 * sopts.slab_size, slab_allocator->GetSlabBytes());
+  allocator->Deallocate(large);
+
+  // Free half of the chunks of every slab. New blocks go to the
+  // lowest-addressed slab, which holds the 16 lowest-addressed chunks.
+  std::vector<char*> sorted = blocks;
+  std::sort(sorted.begin(), sorted.end());
+  std::set<char*> lowest_slab(sorted.begin(), sorted.begin() + 16);
+  for (int i = 1; i < 64; i += 2) {
+    allocator->Deallocate(blocks[i]);
+    blocks[i] = nullptr;
+  }
+  ASSERT_EQ(4 * sopts.slab_size, slab_allocator->GetSlabBytes());
+  for (int i = 1; i < 16; i += 2) {
+    blocks[i] = static_cast<char*>(allocator->Allocate(4000));
+    ASSERT_EQ(1, lowest_slab.count(blocks[i]));
+  }
+  for (int i = 0; i < 64; i += 2) {
+    ASSERT_EQ(static_cast<char>(i), blocks[i][4096 - 16 - 1]);
+  }
+
+  // Empty slabs are freed, except one kept for reuse.
+  for (char* p : blocks) {
+    allocator->Deallocate(p);
+  }
+  ASSERT_EQ(0, slab_allocator->GetAllocatedBytes());
+  ASSERT_EQ(sopts.slab_size, slab_allocator->GetSlabBytes());
+}
+
 INSTANTIATE_TEST_CASE_P(DefaultMemoryAllocator, MemoryAllocatorTest,
                         ::testing::Values(std::make_tuple(
                             DefaultMemoryAllocator::kClassName(), true)));
+// Small slabs, so that the slab space the LRUCache charges does not take its
+// whole capacity.
+INSTANTIATE_TEST_CASE_P(
+    SlabMemoryAllocator, MemoryAllocatorTest,
+    ::testing::Values(std::make_tuple(
+        std::string("id=") + SlabMemoryAllocator::kClassName() +
+            "; slab_size=65536; max_slab_allocation_size=16384",
+        true)));
 #ifdef MEMKIND
 INSTANTIATE_TEST_CASE_P(
     MemkindkMemAllocator, MemoryAllocatorTest,
@@ -0,0 +1,279 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "memory/slab_memory_allocator.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "rocksdb/convenience.h"
+#include "rocksdb/utilities/options_type.h"
+#include "util/math.h"
+#include "util/mutexlock.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+struct ChunkHeader {
+  // The slab holding the chunk, or nullptr if it was not packed.
+  void* slab;
+  // Requested size, only used when the chunk was not packed.
+  size_t size;
+};
+
+// Keeps the allocations 16 byte aligned, like malloc does on 64-bit
+// platforms.
+constexpr size_t kHeaderSize = 16;
+static_assert(sizeof(ChunkHeader) <= kHeaderSize, "");
+
+ChunkHeader* GetHeader(void* p) {
+  return reinterpret_cast<ChunkHeader*>(static_cast<char*>(p) - kHeaderSize);
+}
+
+static std::unordered_map<std::string, OptionTypeInfo> slab_type_info = {
+    {"slab_size",
+     {offsetof(struct SlabAllocatorOptions, slab_size), OptionType::kSizeT,
+      OptionVerificationType::kNormal, OptionTypeFlags::kNone}},
+    {"max_slab_allocation_size",
+     {offsetof(struct SlabAllocatorOptions, max_slab_allocation_size),
+      OptionType::kSizeT, OptionVerificationType::kNormal,
+      OptionTypeFlags::kNone}},
+    {"num_shards",
+     {offsetof(struct SlabAllocatorOptions, num_shards), OptionType::kSizeT,
+      OptionVerificationType::kNormal, OptionTypeFlags::kNone}},
+};
+}  // namespace
+
+SlabMemoryAllocator::SlabMemoryAllocator(const SlabAllocatorOptions& options)
+    : options_(options) {
+  RegisterOptions(&options_, &slab_type_info);
+}
+
+SlabMemoryAllocator::~SlabMemoryAllocator() {
+  // Slabs are freed as soon as they become empty, so any slab left here
+  // still holds allocations, which is a bug in the caller.
+  for (auto& shard : shards_) {
+    for (auto& size_class : shard->size_classes) {
+      for (Slab* slab : size_class.partial_slabs) {
+        delete slab;
+      }
+    }
+  }
+}
+
+Status SlabMemoryAllocator::PrepareOptions(
+    const ConfigOptions& config_options) {
+  if (options_.num_shards < 1) {
+    return Status::InvalidArgument("num_shards must be a positive integer");
+  } else if (options_.max_slab_allocation_size < 1 ||
+             options_.max_slab_allocation_size > options_.slab_size / 2) {
+    return Status::InvalidArgument(
+        "max_slab_allocation_size must be positive and at most slab_size / 2");
+  } else if (init_) {
+    // Already prepared
+    return Status::OK();
+  }
+  Status s = MemoryAllocator::PrepareOptions(config_options);
+  if (!s.ok()) {
+    return s;
+  }
+
+  // Strides are multiples of 16 that grow by 1/16 of the previous power of
+  // two, e.g. 64, 80, 96, ..., 256, 272, ..., 512, 544, ...
+  const size_t max_stride = options_.max_slab_allocation_size + kHeaderSize;
+  size_t stride = 64;
+  strides_.push_back(stride);
+  while (stride < max_stride) {
+    size_t power_of_two = size_t{1} << FloorLog2(stride);
+    stride += std::max<size_t>(16, power_of_two / 16);
+    strides_.push_back(stride);
+  }
+
+  for (size_t i = 0; i < options_.num_shards; ++i) {
+    std::unique_ptr<Shard> shard(new Shard());
+    shard->size_classes.resize(strides_.size());
+    for (size_t j = 0; j < strides_.size(); ++j) {
+      SizeClass& size_class = shard->size_classes[j];
+      size_class.shard = shard.get();
+      size_class.stride = strides_[j];
+      size_class.chunks_per_slab =
+          static_cast<uint32_t>(options_.slab_size / strides_[j]);
+      assert(size_class.chunks_per_slab > 0);
+      size_class.usable_size = strides_[j] - kHeaderSize;
+    }
+    shards_.push_back(std::move(shard));
+  }
+  init_ = true;
+  return Status::OK();
+}
+
+size_t SlabMemoryAllocator::SizeClassIndex(size_t stride) const {
+  auto it = std::lower_bound(strides_.begin(), strides_.end(), stride);
+  assert(it != strides_.end());
+  return static_cast<size_t>(it - strides_.begin());
+}
+
+SlabMemoryAllocator::Shard* SlabMemoryAllocator::GetShard() {
+  int core = port::PhysicalCoreID();
+  size_t index = core >= 0 ? static_cast<size_t>(core)
+                           : Random::GetTLSInstance()->Next();
+  return shards_[index % shards_.size()].get();
+}
+
+void* SlabMemoryAllocator::Allocate(size_t size) {
+  assert(init_);
+  if (size > options_.max_slab_allocation_size) {
+    char* mem = new char[kHeaderSize + size];
+    ChunkHeader* header = reinterpret_cast<ChunkHeader*>(mem);
+    header->slab = nullptr;
+    header->size = size;
+    allocated_bytes_.fetch_add(size, std::memory_order_relaxed);
+    return mem + kHeaderSize;
+  }
+
+  const size_t class_index = SizeClassIndex(kHeaderSize + size);
+  Shard* shard = GetShard();
+  SizeClass* size_class = &shard->size_classes[class_index];
+  Slab* slab = nullptr;
+  char* chunk = nullptr;
+  {
+    MutexLock l(&shard->mutex);
+    if (!size_class->partial_slabs.empty()) {
+      chunk = TakeChunk(size_class, &slab);
+    }
+  }
+  if (chunk == nullptr) {
+    // Before mapping a new slab, fill a partial slab of this size class in
+    // another shard, so that each size class tends to have one partial slab
+    // rather than one per shard. Busy shards are skipped.
+    for (auto& other : shards_) {
+      if (other.get() == shard || !other->mutex.TryLock()) {
+        continue;
+      }
+      SizeClass* other_class = &other->size_classes[class_index];
+      if (!other_class->partial_slabs.empty()) {
+        chunk = TakeChunk(other_class, &slab);
+      }
+      other->mutex.Unlock();
+      if (chunk != nullptr) {
+        break;
+      }
+    }
+  }
+  if (chunk == nullptr) {
+    MutexLock l(&shard->mutex);
+    if (size_class->partial_slabs.empty()) {
+      Slab* new_slab = new Slab();
+      new_slab->size_class = size_class;
+      if (shard->spare_slab) {
+        new_slab->mem = std::move(shard->spare_slab);
+      } else {
+        new_slab->mem.reset(new char[options_.slab_size]);
+        slab_bytes_.fetch_add(options_.slab_size, std::memory_order_relaxed);
+      }
+      size_class->partial_slabs.insert(new_slab);
+    }
+    chunk = TakeChunk(size_class, &slab);
+  }
+
+  ChunkHeader* header = reinterpret_cast<ChunkHeader*>(chunk);
+  header->slab = slab;
+  header->size = size;
+  const size_t usable_size = slab->size_class->usable_size;
+  allocated_bytes_.fetch_add(usable_size, std::memory_order_relaxed);
+  chunk_bytes_.fetch_add(usable_size, std::memory_order_relaxed);
+  return chunk + kHeaderSize;
+}
+
+char* SlabMemoryAllocator::TakeChunk(SizeClass* size_class, Slab** slab) {
+  size_class->shard->mutex.AssertHeld();
+  assert(!size_class->partial_slabs.empty());
+  Slab* s = *size_class->partial_slabs.begin();
+  char* chunk;
+  if (s->free_list != nullptr) {
+    chunk = static_cast<char*>(s->free_list);
+    s->free_list = *reinterpret_cast<void**>(chunk);
+  } else {
+    chunk = s->mem.get() + s->num_carved * size_class->stride;
+    ++s->num_carved;
+  }
+  const uint32_t num_used = s->num_used.load(std::memory_order_relaxed) + 1;
+  s->num_used.store(num_used, std::memory_order_relaxed);
+  if (num_used == size_class->chunks_per_slab) {
+    size_class->partial_slabs.erase(s);
+  }
+  *slab = s;
+  return chunk;
+}
+
+void SlabMemoryAllocator::Deallocate(void* p) {
+  if (p == nullptr) {
+    return;
+  }
+  ChunkHeader* header = GetHeader(p);
+  char* chunk = reinterpret_cast<char*>(header);
+  Slab* slab = static_cast<Slab*>(header->slab);
+  if (slab == nullptr) {
+    allocated_bytes_.fetch_sub(header->size, std::memory_order_relaxed);
+    delete[] chunk;
+    return;
+  }
+
+  SizeClass* size_class = slab->size_class;
+  Shard* shard = size_class->shard;
+  allocated_bytes_.fetch_sub(size_class->usable_size,
+                             std::memory_order_relaxed);
+  chunk_bytes_.fetch_sub(size_class->usable_size, std::memory_order_relaxed);
+  MutexLock l(&shard->mutex);
+  const uint32_t num_used = slab->num_used.load(std::memory_order_relaxed);
+  bool was_full = num_used == size_class->chunks_per_slab;
+  *reinterpret_cast<void**>(chunk) = slab->free_list;
+  slab->free_list = chunk;
+  slab->num_used.store(num_used - 1, std::memory_order_relaxed);
+  if (num_used == 1) {
+    if (!was_full) {
+      size_class->partial_slabs.erase(slab);
+    }
+    if (!shard->spare_slab) {
+      shard->spare_slab = std::move(slab->mem);
+    } else {
+      slab_bytes_.fetch_sub(options_.slab_size, std::memory_order_relaxed);
+    }
+    delete slab;
+  } else if (was_full) {
+    size_class->partial_slabs.insert(slab);
+  }
+}
+
+bool SlabMemoryAllocator::ReleasesMemory(void* p) const {
+  Slab* slab = static_cast<Slab*>(GetHeader(p)->slab);
+  return slab == nullptr || slab->num_used.load(std::memory_order_relaxed) == 1;
+}
+
+size_t SlabMemoryAllocator::UsableSize(void* p,
+                                       size_t /*allocation_size*/) const {
+  ChunkHeader* header = GetHeader(p);
+  if (header->slab == nullptr) {
+    return header->size;
+  }
+  return static_cast<Slab*>(header->slab)->size_class->usable_size;
+}
+
+Status NewSlabMemoryAllocator(
+    const SlabAllocatorOptions& options,
+    std::shared_ptr<MemoryAllocator>* memory_allocator) {
+  if (memory_allocator == nullptr) {
+    return Status::InvalidArgument("memory_allocator must be non-null.");
+  }
+  std::unique_ptr<MemoryAllocator> allocator(new SlabMemoryAllocator(options));
+  Status s = allocator->PrepareOptions(ConfigOptions());
+  if (s.ok()) {
+    memory_allocator->reset(allocator.release());
+  }
+  return s;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
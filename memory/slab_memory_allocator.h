@@ -0,0 +1,126 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/memory_allocator.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// See NewSlabMemoryAllocator(). Each allocation is preceded by a 16 byte
+// header that points to its slab, or to nothing for allocations too large to
+// be packed, so Deallocate() and UsableSize() need no lookup.
+//
+// LRUCache recognizes this allocator: it charges the slab space that is not
+// handed out against its capacity, so that its capacity bounds the memory of
+// whole slabs, and prefers evicting entries whose deallocation empties a slab
+// (see ReleasesMemory()).
+class SlabMemoryAllocator : public MemoryAllocator {
+ public:
+  explicit SlabMemoryAllocator(const SlabAllocatorOptions& options);
+  ~SlabMemoryAllocator() override;
+
+  static const char* kClassName() { return "SlabMemoryAllocator"; }
+  const char* Name() const override { return kClassName(); }
+
+  Status PrepareOptions(const ConfigOptions& config_options) override;
+
+  void* Allocate(size_t size) override;
+  void Deallocate(void* p) override;
+  size_t UsableSize(void* p, size_t allocation_size) const override;
+
+  // Bytes of slabs currently held, including their free space.
+  size_t GetSlabBytes() const {
+    return slab_bytes_.load(std::memory_order_relaxed);
+  }
+
+  // Sum of UsableSize() over the live allocations.
+  size_t GetAllocatedBytes() const {
+    return allocated_bytes_.load(std::memory_order_relaxed);
+  }
+
+  // Bytes of slabs held but not handed out: the free chunks of partially
+  // used slabs, the spare slabs, and the chunk headers and slab padding.
+  // Together with GetAllocatedBytes() this accounts for all the slab memory
+  // held.
+  size_t GetUnallocatedSlabBytes() const {
+    size_t slab_bytes = slab_bytes_.load(std::memory_order_relaxed);
+    size_t chunk_bytes = chunk_bytes_.load(std::memory_order_relaxed);
+    return slab_bytes > chunk_bytes ? slab_bytes - chunk_bytes : 0;
+  }
+
+  // True if deallocating `p`, which must be a live allocation of this
+  // allocator, would free a whole block of memory: `p` was too large to be
+  // packed, or it is the last allocation in its slab. Reads the slab without
+  // its shard mutex, so the answer is only a hint.
+  bool ReleasesMemory(void* p) const;
+
+ private:
+  struct SizeClass;
+  struct Shard;
+
+  struct Slab {
+    SizeClass* size_class = nullptr;
+    std::unique_ptr<char[]> mem;
+    // Only changed with the shard mutex held, but read without it by
+    // ReleasesMemory().
+    std::atomic<uint32_t> num_used{0};
+    // Chunks past this one have never been handed out.
+    uint32_t num_carved = 0;
+    // Chunks that were handed out and deallocated since.
+    void* free_list = nullptr;
+  };
+
+  struct SlabLess {
+    bool operator()(const Slab* lhs, const Slab* rhs) const {
+      return lhs->mem.get() < rhs->mem.get();
+    }
+  };
+
+  struct SizeClass {
+    Shard* shard = nullptr;
+    // Distance between chunks, header included.
+    size_t stride = 0;
+    uint32_t chunks_per_slab = 0;
+    // Bytes of a chunk after its header.
+    size_t usable_size = 0;
+    // Slabs with at least one free chunk, lowest address first.
+    std::set<Slab*, SlabLess> partial_slabs;
+  };
+
+  struct Shard {
+    port::Mutex mutex;
+    std::vector<SizeClass> size_classes;
+    // An empty slab kept to avoid freeing and allocating one repeatedly.
+    std::unique_ptr<char[]> spare_slab;
+  };
+
+  size_t SizeClassIndex(size_t stride) const;
+
+  Shard* GetShard();
+
+  // Hands out a chunk of the lowest-addressed partial slab of `size_class`,
+  // and sets *slab to that slab. REQUIRES: the mutex of the size class's
+  // shard is held, and the size class has a partial slab.
+  char* TakeChunk(SizeClass* size_class, Slab** slab);
+
+  SlabAllocatorOptions options_;
+  // Stride of each size class, ascending.
+  std::vector<size_t> strides_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::atomic<size_t> slab_bytes_{0};
+  std::atomic<size_t> allocated_bytes_{0};
+  // Sum of UsableSize() over the live packed allocations.
+  std::atomic<size_t> chunk_bytes_{0};
+  bool init_ = false;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,1058 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// AdaptiveRadixTree is an ordered index of keys allocated through the tree
+// instance, after "The Adaptive Radix Tree: ARTful Indexing for Main-Memory
+// Databases" (Leis et al., ICDE 2013). Inner nodes grow from 4 to 16, 48
+// and 256 children as needed, paths with a single child are compressed into
+// the prefix of the node below them, and a key is stored as a leaf as soon
+// as it is the only key below a node.
+//
+// The tree does not look at the keys directly. A KeyEncoder maps a key to a
+// byte string such that comparing the byte strings with memcmp orders the
+// keys. No encoded key may be a prefix of another one.
+//
+// Thread safety -------------
+//
+// Writes via Insert require external synchronization, most likely a mutex.
+// InsertConcurrently calls are safe concurrently with each other and with
+// reads, but not with Insert. Reads require a guarantee that the tree will
+// not be destroyed while the read is in progress. Apart from that, reads
+// progress without any internal locking or synchronization, concurrently
+// with writers.
+//
+// Invariants:
+//
+// (1) Allocated nodes are never deleted until the tree is destroyed. A node
+// that has to grow, or whose prefix has to be split, is replaced by a copy
+// that is published with a release-store, and readers that still hold the
+// old node see a consistent, older version of the subtree.
+//
+// (2) A child is added to a node in place by first initializing the child
+// slot and then publishing it with a release-store of the child count
+// (Node4 and Node16), of the child index (Node48) or of the slot itself
+// (Node256).
+//
+// (3) Concurrent writers lock the nodes they change, a node before its
+// children. Adding a child in place locks the node. Replacing the reference
+// in a slot locks the node that holds the slot (a tree-wide lock for the
+// root), and also the referenced node if it is copied. A replaced node is
+// marked obsolete under its lock, so that writers that reached it through
+// the old reference restart from the root.
+
+#pragma once
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "memory/allocator.h"
+#include "port/port.h"
+#include "util/autovector.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// The byte string a KeyEncoder maps a key to. Short strings are kept inline,
+// so that encoding the key of a lookup does not allocate.
+class ArtEncodedKey {
+ public:
+  ArtEncodedKey() : data_(inline_), size_(0), capacity_(sizeof(inline_)) {}
+  // No copying allowed
+  ArtEncodedKey(const ArtEncodedKey&) = delete;
+  ArtEncodedKey& operator=(const ArtEncodedKey&) = delete;
+
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+  void clear() { size_ = 0; }
+
+  void reserve(size_t n) {
+    if (n > capacity_) {
+      std::unique_ptr<char[]> buf(new char[n]);
+      memcpy(buf.get(), data_, size_);
+      heap_ = std::move(buf);
+      data_ = heap_.get();
+      capacity_ = n;
+    }
+  }
+
+  void append(const char* p, size_t n) {
+    Grow(n);
+    memcpy(data_ + size_, p, n);
+    size_ += n;
+  }
+
+  void append(size_t n, char c) {
+    Grow(n);
+    memset(data_ + size_, c, n);
+    size_ += n;
+  }
+
+  void push_back(char c) {
+    Grow(1);
+    data_[size_++] = c;
+  }
+
+  // Compares the bytes like memcmp, a shorter string ordering first on ties.
+  int compare(const ArtEncodedKey& other) const {
+    const size_t min_size = std::min(size_, other.size_);
+    int r = min_size == 0 ? 0 : memcmp(data_, other.data_, min_size);
+    if (r == 0) {
+      r = size_ < other.size_ ? -1 : (size_ > other.size_ ? 1 : 0);
+    }
+    return r;
+  }
+
+ private:
+  void Grow(size_t n) {
+    if (size_ + n > capacity_) {
+      reserve(std::max(size_ + n, 2 * capacity_));
+    }
+  }
+
+  char inline_[128];
+  std::unique_ptr<char[]> heap_;
+  char* data_;
+  size_t size_;
+  size_t capacity_;
+};
+
+template <class KeyEncoder>
+class AdaptiveRadixTree {
+ private:
+  struct Node;
+
+ public:
+  // Create a new AdaptiveRadixTree object that will use "encoder" to map keys
+  // to byte strings and will allocate memory using "*allocator". Objects
+  // allocated in the allocator must remain allocated for the lifetime of the
+  // tree object.
+  AdaptiveRadixTree(KeyEncoder encoder, Allocator* allocator);
+  // No copying allowed
+  AdaptiveRadixTree(const AdaptiveRadixTree&) = delete;
+  AdaptiveRadixTree& operator=(const AdaptiveRadixTree&) = delete;
+
+  // Allocates a key of the given size. The lowest bit of the address of a key
+  // is used to tell leaves from inner nodes, so keys must be allocated here.
+  char* AllocateKey(size_t key_size);
+
+  // Inserts a key allocated by AllocateKey, after the actual key value has
+  // been filled in.
+  //
+  // Returns false, and leaves the tree unchanged, if an entry that encodes
+  // equal to key is already in the tree.
+  //
+  // REQUIRES: no concurrent calls to Insert or InsertConcurrently.
+  bool Insert(const char* key);
+
+  // Like Insert, but external synchronization is not required.
+  bool InsertConcurrently(const char* key);
+
+  // Returns true iff an entry that encodes equal to key is in the tree.
+  bool Contains(const char* key) const;
+
+  // Iteration over the contents of the tree
+  class Iterator {
+   public:
+    // Initialize an iterator over the specified tree.
+    // The returned iterator is not valid.
+    explicit Iterator(const AdaptiveRadixTree* tree);
+
+    // Returns true iff the iterator is positioned at a valid key.
+    bool Valid() const { return key_ != nullptr; }
+
+    // Returns the key at the current position.
+    // REQUIRES: Valid()
+    const char* key() const {
+      assert(Valid());
+      return key_;
+    }
+
+    // Advances to the next position.
+    // REQUIRES: Valid()
+    void Next();
+
+    // Advances to the previous position.
+    // REQUIRES: Valid()
+    void Prev();
+
+    // Advance to the first entry with a key >= target
+    void Seek(const char* target);
+
+    // Retreat to the last entry with a key <= target
+    void SeekForPrev(const char* target);
+
+    // Position at the first entry in the tree.
+    // Final state of iterator is Valid() iff the tree is not empty.
+    void SeekToFirst();
+
+    // Position at the last entry in the tree.
+    // Final state of iterator is Valid() iff the tree is not empty.
+    void SeekToLast();
+
+   private:
+    struct Level {
+      const Node* node;
+      int byte;
+    };
+
+    // Positions at the smallest (largest) key of the subtree rooted at ref.
+    void DescendToFirst(uintptr_t ref);
+    void DescendToLast(uintptr_t ref);
+    // Positions at the smallest (largest) key after (before) the subtrees
+    // that the path currently ends in.
+    void AdvanceToNext();
+    void AdvanceToPrev();
+
+    const AdaptiveRadixTree* tree_;
+    // Inner nodes from the root down to the current key, with the byte of the
+    // child taken in each of them. Paths through the first bytes of typical
+    // keys stay inline.
+    autovector<Level, 16> path_;
+    const char* key_;
+    ArtEncodedKey target_;
+    ArtEncodedKey scratch_;
+  };
+
+ private:
+  enum NodeType : uint8_t { kNode4, kNode16, kNode48, kNode256 };
+
+  struct Node {
+    explicit Node(NodeType _type)
+        : type(_type), prefix_len(0), num_children(0), obsolete(false) {}
+
+    const NodeType type;
+    uint32_t prefix_len;
+    // For Node4 and Node16, also publishes the keys and children to readers.
+    std::atomic<uint16_t> num_children;
+    // Only used by InsertConcurrently. Protects the children and obsolete.
+    SpinMutex mutex;
+    // Set once the node has been replaced by a copy.
+    bool obsolete;
+  };
+
+  struct Node4 : public Node {
+    static constexpr uint16_t kCapacity = 4;
+    Node4() : Node(kNode4) {
+      for (auto& child : children) {
+        child.store(0, std::memory_order_relaxed);
+      }
+    }
+    // Unsorted, in insertion order.
+    uint8_t keys[kCapacity];
+    std::atomic<uintptr_t> children[kCapacity];
+  };
+
+  struct Node16 : public Node {
+    static constexpr uint16_t kCapacity = 16;
+    Node16() : Node(kNode16) {
+      for (auto& child : children) {
+        child.store(0, std::memory_order_relaxed);
+      }
+    }
+    // Unsorted, in insertion order.
+    uint8_t keys[kCapacity];
+    std::atomic<uintptr_t> children[kCapacity];
+  };
+
+  struct Node48 : public Node {
+    static constexpr uint16_t kCapacity = 48;
+    Node48() : Node(kNode48) {
+      for (auto& index : child_index) {
+        index.store(0, std::memory_order_relaxed);
+      }
+      for (auto& child : children) {
+        child.store(0, std::memory_order_relaxed);
+      }
+    }
+    // One plus the position of the child for each byte, 0 if there is none.
+    std::atomic<uint8_t> child_index[256];
+    std::atomic<uintptr_t> children[kCapacity];
+  };
+
+  struct Node256 : public Node {
+    Node256() : Node(kNode256) {
+      for (auto& child : children) {
+        child.store(0, std::memory_order_relaxed);
+      }
+    }
+    std::atomic<uintptr_t> children[256];
+  };
+
+  // A reference to a child is either a Node* or a key with the lowest bit
+  // set.
+  static bool IsLeaf(uintptr_t ref) { return (ref & 1) != 0; }
+  static const char* LeafKey(uintptr_t ref) {
+    return reinterpret_cast<const char*>(ref & ~static_cast<uintptr_t>(1));
+  }
+  static uintptr_t LeafRef(const char* key) {
+    assert((reinterpret_cast<uintptr_t>(key) & 1) == 0);
+    return reinterpret_cast<uintptr_t>(key) | 1;
+  }
+  static Node* AsNode(uintptr_t ref) {
+    assert(!IsLeaf(ref));
+    return reinterpret_cast<Node*>(ref);
+  }
+
+  static size_t NodeSize(NodeType type);
+  // The compressed path is stored right after the node.
+  static const uint8_t* Prefix(const Node* node) {
+    return reinterpret_cast<const uint8_t*>(node) + NodeSize(node->type);
+  }
+
+  Node* NewNode(NodeType type, const uint8_t* prefix, size_t prefix_len);
+  // Returns a copy of node with a different prefix, or with room for one more
+  // child if grow is true.
+  Node* CopyNode(const Node* node, const uint8_t* prefix, size_t prefix_len,
+                 bool grow);
+
+  // Returns the slot of the child for byte, or nullptr if there is none.
+  static std::atomic<uintptr_t>* FindChild(const Node* node, uint8_t byte);
+  // Finds the child with the smallest byte greater than after (the largest
+  // byte smaller than before). Returns false if there is none.
+  static bool NextChild(const Node* node, int after, int* byte,
+                        uintptr_t* child);
+  static bool PrevChild(const Node* node, int before, int* byte,
+                        uintptr_t* child);
+  // Calls f(byte, child) for each child, in no particular order.
+  template <class F>
+  static void ForEachChild(const Node* node, F f);
+
+  static bool IsFull(const Node* node);
+  // REQUIRES: !IsFull(node)
+  static void AddChildInPlace(Node* node, uint8_t byte, uintptr_t child);
+  // Adds a child to the node referenced from slot, replacing the node with a
+  // bigger one if it is full.
+  void AddChild(std::atomic<uintptr_t>* slot, Node* node, uint8_t byte,
+                uintptr_t child);
+
+  // Locks the slots of owner, unless owner has been replaced or slot no
+  // longer references ref. Returns whether the lock is held.
+  bool LockSlot(Node* owner, const std::atomic<uintptr_t>* slot,
+                uintptr_t ref);
+  // AddChild for InsertConcurrently. Returns false, without adding the
+  // child, if the insert has to restart from the root.
+  bool AddChildConcurrently(Node* owner, std::atomic<uintptr_t>* slot,
+                            Node* node, uint8_t byte, uintptr_t child);
+
+  template <bool kConcurrent>
+  bool InsertImpl(const char* key, ArtEncodedKey* encoded_key,
+                  ArtEncodedKey* scratch);
+
+  // The lock of the slots of owner, the node that holds them, or of the root
+  // if owner is nullptr.
+  SpinMutex* SlotMutex(Node* owner) {
+    return owner == nullptr ? &root_mutex_ : &owner->mutex;
+  }
+
+  KeyEncoder encoder_;
+  Allocator* const allocator_;
+  std::atomic<uintptr_t> root_;
+  // Only used by InsertConcurrently.
+  SpinMutex root_mutex_;
+  // Only used by the inserting thread.
+  ArtEncodedKey insert_key_;
+  ArtEncodedKey insert_scratch_;
+};
+
+template <class KeyEncoder>
+AdaptiveRadixTree<KeyEncoder>::AdaptiveRadixTree(KeyEncoder encoder,
+                                                 Allocator* allocator)
+    : encoder_(encoder), allocator_(allocator), root_(0) {}
+
+template <class KeyEncoder>
+char* AdaptiveRadixTree<KeyEncoder>::AllocateKey(size_t key_size) {
+  return allocator_->AllocateAligned(key_size);
+}
+
+template <class KeyEncoder>
+size_t AdaptiveRadixTree<KeyEncoder>::NodeSize(NodeType type) {
+  switch (type) {
+    case kNode4:
+      return sizeof(Node4);
+    case kNode16:
+      return sizeof(Node16);
+    case kNode48:
+      return sizeof(Node48);
+    case kNode256:
+      return sizeof(Node256);
+  }
+  assert(false);
+  return 0;
+}
+
+template <class KeyEncoder>
+typename AdaptiveRadixTree<KeyEncoder>::Node*
+AdaptiveRadixTree<KeyEncoder>::NewNode(NodeType type, const uint8_t* prefix,
+                                       size_t prefix_len) {
+  char* mem = allocator_->AllocateAligned(NodeSize(type) + prefix_len);
+  Node* node = nullptr;
+  switch (type) {
+    case kNode4:
+      node = new (mem) Node4();
+      break;
+    case kNode16:
+      node = new (mem) Node16();
+      break;
+    case kNode48:
+      node = new (mem) Node48();
+      break;
+    case kNode256:
+      node = new (mem) Node256();
+      break;
+  }
+  node->prefix_len = static_cast<uint32_t>(prefix_len);
+  if (prefix_len > 0) {
+    memcpy(mem + NodeSize(type), prefix, prefix_len);
+  }
+  return node;
+}
+
+template <class KeyEncoder>
+typename AdaptiveRadixTree<KeyEncoder>::Node*
+AdaptiveRadixTree<KeyEncoder>::CopyNode(const Node* node,
+                                        const uint8_t* prefix,
+                                        size_t prefix_len, bool grow) {
+  NodeType type = node->type;
+  if (grow) {
+    assert(type != kNode256);
+    type = static_cast<NodeType>(type + 1);
+  }
+  Node* copy = NewNode(type, prefix, prefix_len);
+  ForEachChild(node, [copy](uint8_t byte, uintptr_t child) {
+    AddChildInPlace(copy, byte, child);
+  });
+  return copy;
+}
+
+template <class KeyEncoder>
+std::atomic<uintptr_t>* AdaptiveRadixTree<KeyEncoder>::FindChild(
+    const Node* node, uint8_t byte) {
+  switch (node->type) {
+    case kNode4: {
+      auto* n = const_cast<Node4*>(static_cast<const Node4*>(node));
+      const uint16_t num_children =
+          node->num_children.load(std::memory_order_acquire);
+      for (uint16_t i = 0; i < num_children; ++i) {
+        if (n->keys[i] == byte) {
+          return &n->children[i];
+        }
+      }
+      return nullptr;
+    }
+    case kNode16: {
+      auto* n = const_cast<Node16*>(static_cast<const Node16*>(node));
+      const uint16_t num_children =
+          node->num_children.load(std::memory_order_acquire);
+      for (uint16_t i = 0; i < num_children; ++i) {
+        if (n->keys[i] == byte) {
+          return &n->children[i];
+        }
+      }
+      return nullptr;
+    }
+    case kNode48: {
+      auto* n = const_cast<Node48*>(static_cast<const Node48*>(node));
+      const uint8_t index =
+          n->child_index[byte].load(std::memory_order_acquire);
+      return index == 0 ? nullptr : &n->children[index - 1];
+    }
+    case kNode256: {
+      auto* n = const_cast<Node256*>(static_cast<const Node256*>(node));
+      return n->children[byte].load(std::memory_order_acquire) == 0
+                 ? nullptr
+                 : &n->children[byte];
+    }
+  }
+  assert(false);
+  return nullptr;
+}
+
+template <class KeyEncoder>
+template <class F>
+void AdaptiveRadixTree<KeyEncoder>::ForEachChild(const Node* node, F f) {
+  switch (node->type) {
+    case kNode4: {
+      auto* n = static_cast<const Node4*>(node);
+      const uint16_t num_children =
+          node->num_children.load(std::memory_order_acquire);
+      for (uint16_t i = 0; i < num_children; ++i) {
+        f(n->keys[i], n->children[i].load(std::memory_order_acquire));
+      }
+      break;
+    }
+    case kNode16: {
+      auto* n = static_cast<const Node16*>(node);
+      const uint16_t num_children =
+          node->num_children.load(std::memory_order_acquire);
+      for (uint16_t i = 0; i < num_children; ++i) {
+        f(n->keys[i], n->children[i].load(std::memory_order_acquire));
+      }
+      break;
+    }
+    case kNode48: {
+      auto* n = static_cast<const Node48*>(node);
+      for (int byte = 0; byte < 256; ++byte) {
+        const uint8_t index =
+            n->child_index[byte].load(std::memory_order_acquire);
+        if (index != 0) {
+          f(static_cast<uint8_t>(byte),
+            n->children[index - 1].load(std::memory_order_acquire));
+        }
+      }
+      break;
+    }
+    case kNode256: {
+      auto* n = static_cast<const Node256*>(node);
+      for (int byte = 0; byte < 256; ++byte) {
+        const uintptr_t child =
+            n->children[byte].load(std::memory_order_acquire);
+        if (child != 0) {
+          f(static_cast<uint8_t>(byte), child);
+        }
+      }
+      break;
+    }
+  }
+}
+
+template <class KeyEncoder>
+bool AdaptiveRadixTree<KeyEncoder>::NextChild(const Node* node, int after,
+                                              int* byte, uintptr_t* child) {
+  switch (node->type) {
+    case kNode4:
+    case kNode16: {
+      int best = 256;
+      ForEachChild(node, [&](uint8_t b, uintptr_t c) {
+        if (b > after && b < best) {
+          best = b;
+          *child = c;
+        }
+      });
+      *byte = best;
+      return best < 256;
+    }
+    case kNode48: {
+      auto* n = static_cast<const Node48*>(node);
+      for (int b = after + 1; b < 256; ++b) {
+        const uint8_t index = n->child_index[b].load(std::memory_order_acquire);
+        if (index != 0) {
+          *byte = b;
+          *child = n->children[index - 1].load(std::memory_order_acquire);
+          return true;
+        }
+      }
+      return false;
+    }
+    case kNode256: {
+      auto* n = static_cast<const Node256*>(node);
+      for (int b = after + 1; b < 256; ++b) {
+        const uintptr_t c = n->children[b].load(std::memory_order_acquire);
+        if (c != 0) {
+          *byte = b;
+          *child = c;
+          return true;
+        }
+      }
+      return false;
+    }
+  }
+  assert(false);
+  return false;
+}
+
+template <class KeyEncoder>
+bool AdaptiveRadixTree<KeyEncoder>::PrevChild(const Node* node, int before,
+                                              int* byte, uintptr_t* child) {
+  switch (node->type) {
+    case kNode4:
+    case kNode16: {
+      int best = -1;
+      ForEachChild(node, [&](uint8_t b, uintptr_t c) {
+        if (b < before && b > best) {
+          best = b;
+          *child = c;
+        }
+      });
+      *byte = best;
+      return best >= 0;
+    }
+    case kNode48: {
+      auto* n = static_cast<const Node48*>(node);
+      for (int b = before - 1; b >= 0; --b) {
+        const uint8_t index = n->child_index[b].load(std::memory_order_acquire);
+        if (index != 0) {
+          *byte = b;
+          *child = n->children[index - 1].load(std::memory_order_acquire);
+          return true;
+        }
+      }
+      return false;
+    }
+    case kNode256: {
+      auto* n = static_cast<const Node256*>(node);
+      for (int b = before - 1; b >= 0; --b) {
+        const uintptr_t c = n->children[b].load(std::memory_order_acquire);
+        if (c != 0) {
+          *byte = b;
+          *child = c;
+          return true;
+        }
+      }
+      return false;
+    }
+  }
+  assert(false);
+  return false;
+}
+
+template <class KeyEncoder>
+bool AdaptiveRadixTree<KeyEncoder>::IsFull(const Node* node) {
+  const uint16_t num_children =
+      node->num_children.load(std::memory_order_relaxed);
+  switch (node->type) {
+    case kNode4:
+      return num_children == Node4::kCapacity;
+    case kNode16:
+      return num_children == Node16::kCapacity;
+    case kNode48:
+      return num_children == Node48::kCapacity;
+    case kNode256:
+      return false;
+  }
+  assert(false);
+  return false;
+}
+
+template <class KeyEncoder>
+void AdaptiveRadixTree<KeyEncoder>::AddChildInPlace(Node* node, uint8_t byte,
+                                                    uintptr_t child) {
+  assert(!IsFull(node));
+  const uint16_t num_children =
+      node->num_children.load(std::memory_order_relaxed);
+  switch (node->type) {
+    case kNode4: {
+      auto* n = static_cast<Node4*>(node);
+      n->keys[num_children] = byte;
+      n->children[num_children].store(child, std::memory_order_relaxed);
+      node->num_children.store(num_children + 1, std::memory_order_release);
+      break;
+    }
+    case kNode16: {
+      auto* n = static_cast<Node16*>(node);
+      n->keys[num_children] = byte;
+      n->children[num_children].store(child, std::memory_order_relaxed);
+      node->num_children.store(num_children + 1, std::memory_order_release);
+      break;
+    }
+    case kNode48: {
+      auto* n = static_cast<Node48*>(node);
+      // Children are never removed, so the positions are used in order.
+      n->children[num_children].store(child, std::memory_order_relaxed);
+      n->child_index[byte].store(static_cast<uint8_t>(num_children + 1),
+                                 std::memory_order_release);
+      node->num_children.store(num_children + 1, std::memory_order_relaxed);
+      break;
+    }
+    case kNode256: {
+      auto* n = static_cast<Node256*>(node);
+      n->children[byte].store(child, std::memory_order_release);
+      node->num_children.store(num_children + 1, std::memory_order_relaxed);
+      break;
+    }
+  }
+}
+
+template <class KeyEncoder>
+void AdaptiveRadixTree<KeyEncoder>::AddChild(std::atomic<uintptr_t>* slot,
+                                             Node* node, uint8_t byte,
+                                             uintptr_t child) {
+  if (!IsFull(node)) {
+    AddChildInPlace(node, byte, child);
+    return;
+  }
+  Node* bigger = CopyNode(node, Prefix(node), node->prefix_len, true /*grow*/);
+  AddChildInPlace(bigger, byte, child);
+  slot->store(reinterpret_cast<uintptr_t>(bigger), std::memory_order_release);
+  node->obsolete = true;
+}
+
+template <class KeyEncoder>
+bool AdaptiveRadixTree<KeyEncoder>::LockSlot(
+    Node* owner, const std::atomic<uintptr_t>* slot, uintptr_t ref) {
+  SpinMutex* mutex = SlotMutex(owner);
+  mutex->lock();
+  if ((owner != nullptr && owner->obsolete) ||
+      slot->load(std::memory_order_relaxed) != ref) {
+    mutex->unlock();
+    return false;
+  }
+  return true;
+}
+
+template <class KeyEncoder>
+bool AdaptiveRadixTree<KeyEncoder>::AddChildConcurrently(
+    Node* owner, std::atomic<uintptr_t>* slot, Node* node, uint8_t byte,
+    uintptr_t child) {
+  node->mutex.lock();
+  if (node->obsolete || FindChild(node, byte) != nullptr) {
+    node->mutex.unlock();
+    return false;
+  }
+  if (!IsFull(node)) {
+    AddChildInPlace(node, byte, child);
+    node->mutex.unlock();
+    return true;
+  }
+  node->mutex.unlock();
+
+  // Growing the node replaces it in slot, whose lock has to be taken first.
+  if (!LockSlot(owner, slot, reinterpret_cast<uintptr_t>(node))) {
+    return false;
+  }
+  node->mutex.lock();
+  // The node is still referenced from a live slot, so it is not obsolete.
+  assert(!node->obsolete);
+  const bool added = FindChild(node, byte) == nullptr;
+  if (added) {
+    AddChild(slot, node, byte, child);
+  }
+  node->mutex.unlock();
+  SlotMutex(owner)->unlock();
+  return added;
+}
+
+template <class KeyEncoder>
+bool AdaptiveRadixTree<KeyEncoder>::Insert(const char* key) {
+  return InsertImpl<false>(key, &insert_key_, &insert_scratch_);
+}
+
+template <class KeyEncoder>
+bool AdaptiveRadixTree<KeyEncoder>::InsertConcurrently(const char* key) {
+  ArtEncodedKey encoded_key;
+  ArtEncodedKey scratch;
+  return InsertImpl<true>(key, &encoded_key, &scratch);
+}
+
+template <class KeyEncoder>
+template <bool kConcurrent>
+bool AdaptiveRadixTree<KeyEncoder>::InsertImpl(const char* key,
+                                               ArtEncodedKey* encoded_key,
+                                               ArtEncodedKey* scratch) {
+  encoder_(key, encoded_key);
+  const auto* encoded = reinterpret_cast<const uint8_t*>(encoded_key->data());
+  const size_t encoded_size = encoded_key->size();
+  const uintptr_t leaf = LeafRef(key);
+
+  // A concurrent writer that finds the tree changed under it starts over from
+  // the root.
+  while (true) {
+    // The node that holds slot, nullptr for the root.
+    Node* owner = nullptr;
+    std::atomic<uintptr_t>* slot = &root_;
+    size_t depth = 0;
+    bool restart = false;
+    while (!restart) {
+      const uintptr_t ref = slot->load(kConcurrent ? std::memory_order_acquire
+                                                   : std::memory_order_relaxed);
+      if (ref == 0 || IsLeaf(ref)) {
+        const uint8_t* other = nullptr;
+        size_t i = depth;
+        if (ref != 0) {
+          encoder_(LeafKey(ref), scratch);
+          other = reinterpret_cast<const uint8_t*>(scratch->data());
+          while (i < encoded_size && i < scratch->size() &&
+                 encoded[i] == other[i]) {
+            ++i;
+          }
+          if (i == encoded_size || i == scratch->size()) {
+            // Neither key can be a prefix of the other, so they are equal.
+            assert(i == encoded_size && i == scratch->size());
+            return false;
+          }
+        }
+        if (kConcurrent && !LockSlot(owner, slot, ref)) {
+          restart = true;
+          continue;
+        }
+        if (ref == 0) {
+          slot->store(leaf, std::memory_order_release);
+        } else {
+          // Lazy expansion: replace the leaf by a node holding both keys,
+          // with the bytes they share as its prefix.
+          Node* node = NewNode(kNode4, encoded + depth, i - depth);
+          AddChildInPlace(node, other[i], ref);
+          AddChildInPlace(node, encoded[i], leaf);
+          slot->store(reinterpret_cast<uintptr_t>(node),
+                      std::memory_order_release);
+        }
+        if (kConcurrent) {
+          SlotMutex(owner)->unlock();
+        }
+        return true;
+      }
+
+      Node* node = AsNode(ref);
+      const uint8_t* prefix = Prefix(node);
+      size_t matched = 0;
+      while (matched < node->prefix_len && depth + matched < encoded_size &&
+             prefix[matched] == encoded[depth + matched]) {
+        ++matched;
+      }
+      if (matched < node->prefix_len) {
+        // The key leaves the compressed path: split it at the first differing
+        // byte.
+        assert(depth + matched < encoded_size);
+        if (kConcurrent) {
+          if (!LockSlot(owner, slot, ref)) {
+            restart = true;
+            continue;
+          }
+          node->mutex.lock();
+          assert(!node->obsolete);
+        }
+        Node* parent = NewNode(kNode4, prefix, matched);
+        Node* rest = CopyNode(node, prefix + matched + 1,
+                              node->prefix_len - matched - 1, false /*grow*/);
+        AddChildInPlace(parent, prefix[matched],
+                        reinterpret_cast<uintptr_t>(rest));
+        AddChildInPlace(parent, encoded[depth + matched], leaf);
+        slot->store(reinterpret_cast<uintptr_t>(parent),
+                    std::memory_order_release);
+        node->obsolete = true;
+        if (kConcurrent) {
+          node->mutex.unlock();
+          SlotMutex(owner)->unlock();
+        }
+        return true;
+      }
+      depth += node->prefix_len;
+      assert(depth < encoded_size);
+      std::atomic<uintptr_t>* child = FindChild(node, encoded[depth]);
+      if (child == nullptr) {
+        if (!kConcurrent) {
+          AddChild(slot, node, encoded[depth], leaf);
+          return true;
+        }
+        if (AddChildConcurrently(owner, slot, node, encoded[depth], leaf)) {
+          return true;
+        }
+        restart = true;
+        continue;
+      }
+      owner = node;
+      slot = child;
+      ++depth;
+    }
+  }
+}
+
+template <class KeyEncoder>
+bool AdaptiveRadixTree<KeyEncoder>::Contains(const char* key) const {
+  ArtEncodedKey encoded_key;
+  encoder_(key, &encoded_key);
+  const auto* encoded = reinterpret_cast<const uint8_t*>(encoded_key.data());
+  uintptr_t ref = root_.load(std::memory_order_acquire);
+  size_t depth = 0;
+  while (ref != 0) {
+    if (IsLeaf(ref)) {
+      ArtEncodedKey leaf_key;
+      encoder_(LeafKey(ref), &leaf_key);
+      return leaf_key.compare(encoded_key) == 0;
+    }
+    const Node* node = AsNode(ref);
+    if (depth + node->prefix_len >= encoded_key.size() ||
+        memcmp(Prefix(node), encoded + depth, node->prefix_len) != 0) {
+      return false;
+    }
+    depth += node->prefix_len;
+    std::atomic<uintptr_t>* child = FindChild(node, encoded[depth]);
+    if (child == nullptr) {
+      return false;
+    }
+    ref = child->load(std::memory_order_acquire);
+    ++depth;
+  }
+  return false;
+}
+
+template <class KeyEncoder>
+AdaptiveRadixTree<KeyEncoder>::Iterator::Iterator(
+    const AdaptiveRadixTree* tree)
+    : tree_(tree), key_(nullptr) {}
+
+template <class KeyEncoder>
+void AdaptiveRadixTree<KeyEncoder>::Iterator::DescendToFirst(uintptr_t ref) {
+  while (ref != 0 && !IsLeaf(ref)) {
+    const Node* node = AsNode(ref);
+    int byte;
+    uintptr_t child = 0;
+    bool found = NextChild(node, -1, &byte, &child);
+    assert(found);
+    (void)found;
+    path_.push_back({node, byte});
+    ref = child;
+  }
+  key_ = ref == 0 ? nullptr : LeafKey(ref);
+}
+
+template <class KeyEncoder>
+void AdaptiveRadixTree<KeyEncoder>::Iterator::DescendToLast(uintptr_t ref) {
+  while (ref != 0 && !IsLeaf(ref)) {
+    const Node* node = AsNode(ref);
+    int byte;
+    uintptr_t child = 0;
+    bool found = PrevChild(node, 256, &byte, &child);
+    assert(found);
+    (void)found;
+    path_.push_back({node, byte});
+    ref = child;
+  }
+  key_ = ref == 0 ? nullptr : LeafKey(ref);
+}
+
+template <class KeyEncoder>
+void AdaptiveRadixTree<KeyEncoder>::Iterator::AdvanceToNext() {
+  while (!path_.empty()) {
+    Level& level = path_.back();
+    int byte;
+    uintptr_t child = 0;
+    if (NextChild(level.node, level.byte, &byte, &child)) {
+      level.byte = byte;
+      DescendToFirst(child);
+      return;
+    }
+    path_.pop_back();
+  }
+  key_ = nullptr;
+}
+
+template <class KeyEncoder>
+void AdaptiveRadixTree<KeyEncoder>::Iterator::AdvanceToPrev() {
+  while (!path_.empty()) {
+    Level& level = path_.back();
+    int byte;
+    uintptr_t child = 0;
+    if (PrevChild(level.node, level.byte, &byte, &child)) {
+      level.byte = byte;
+      DescendToLast(child);
+      return;
+    }
+    path_.pop_back();
+  }
+  key_ = nullptr;
+}
+
+template <class KeyEncoder>
+void AdaptiveRadixTree<KeyEncoder>::Iterator::Next() {
+  assert(Valid());
+  AdvanceToNext();
+}
+
+template <class KeyEncoder>
+void AdaptiveRadixTree<KeyEncoder>::Iterator::Prev() {
+  assert(Valid());
+  AdvanceToPrev();
+}
+
+template <class KeyEncoder>
+void AdaptiveRadixTree<KeyEncoder>::Iterator::Seek(const char* target) {
+  tree_->encoder_(target, &target_);
+  const auto* encoded = reinterpret_cast<const uint8_t*>(target_.data());
+  const size_t encoded_size = target_.size();
+  path_.clear();
+  uintptr_t ref = tree_->root_.load(std::memory_order_acquire);
+  size_t depth = 0;
+  while (true) {
+    if (ref == 0) {
+      key_ = nullptr;
+      return;
+    }
+    if (IsLeaf(ref)) {
+      tree_->encoder_(LeafKey(ref), &scratch_);
+      if (scratch_.compare(target_) >= 0) {
+        key_ = LeafKey(ref);
+      } else {
+        AdvanceToNext();
+      }
+      return;
+    }
+    const Node* node = AsNode(ref);
+    const uint8_t* prefix = Prefix(node);
+    int cmp = 0;
+    for (size_t i = 0; i < node->prefix_len && cmp == 0; ++i) {
+      if (depth + i >= encoded_size) {
+        // The target is a prefix of every key below the node.
+        cmp = 1;
+      } else if (prefix[i] != encoded[depth + i]) {
+        cmp = prefix[i] < encoded[depth + i] ? -1 : 1;
+      }
+    }
+    if (cmp > 0) {
+      // Every key below the node is greater than the target.
+      DescendToFirst(ref);
+      return;
+    }
+    if (cmp < 0) {
+      // Every key below the node is smaller than the target.
+      AdvanceToNext();
+      return;
+    }
+    depth += node->prefix_len;
+    if (depth >= encoded_size) {
+      DescendToFirst(ref);
+      return;
+    }
+    const uint8_t byte = encoded[depth];
+    std::atomic<uintptr_t>* child = FindChild(node, byte);
+    if (child != nullptr) {
+      path_.push_back({node, byte});
+      ref = child->load(std::memory_order_acquire);
+      ++depth;
+      continue;
+    }
+    int next_byte;
+    uintptr_t next_child = 0;
+    if (NextChild(node, byte, &next_byte, &next_child)) {
+      path_.push_back({node, next_byte});
+      DescendToFirst(next_child);
+    } else {
+      AdvanceToNext();
+    }
+    return;
+  }
+}
+
+template <class KeyEncoder>
+void AdaptiveRadixTree<KeyEncoder>::Iterator::SeekForPrev(const char* target) {
+  Seek(target);
+  if (!Valid()) {
+    SeekToLast();
+    return;
+  }
+  // Seek() left the encoded target in target_.
+  tree_->encoder_(key_, &scratch_);
+  if (scratch_.compare(target_) > 0) {
+    Prev();
+  }
+}
+
+template <class KeyEncoder>
+void AdaptiveRadixTree<KeyEncoder>::Iterator::SeekToFirst() {
+  path_.clear();
+  DescendToFirst(tree_->root_.load(std::memory_order_acquire));
+}
+
+template <class KeyEncoder>
+void AdaptiveRadixTree<KeyEncoder>::Iterator::SeekToLast() {
+  path_.clear();
+  DescendToLast(tree_->root_.load(std::memory_order_acquire));
+}
+
+}  // namespace ROCKSDB_NAMESPACE
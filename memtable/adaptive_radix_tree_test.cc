@@ -0,0 +1,254 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "memtable/adaptive_radix_tree.h"
+
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "memory/concurrent_arena.h"
+#include "test_util/testharness.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Our test tree stores 8-byte unsigned integers
+using Key = uint64_t;
+
+static const char* Encode(const uint64_t* key) {
+  return reinterpret_cast<const char*>(key);
+}
+
+static Key Decode(const char* key) {
+  Key rv;
+  memcpy(&rv, key, sizeof(Key));
+  return rv;
+}
+
+// Big-endian bytes order the same way as the integers, and have a fixed
+// width so that no encoded key is a prefix of another one.
+struct TestEncoder {
+  void operator()(const char* key, ArtEncodedKey* encoded) const {
+    Key k = Decode(key);
+    encoded->clear();
+    for (int shift = 56; shift >= 0; shift -= 8) {
+      encoded->push_back(static_cast<char>((k >> shift) & 0xff));
+    }
+  }
+};
+
+using TestTree = AdaptiveRadixTree<TestEncoder>;
+
+class AdaptiveRadixTreeTest : public testing::Test {
+ public:
+  static bool Insert(TestTree* tree, Key key) {
+    char* buf = tree->AllocateKey(sizeof(Key));
+    memcpy(buf, &key, sizeof(Key));
+    return tree->Insert(buf);
+  }
+
+  static void Validate(const TestTree& tree, const std::set<Key>& keys,
+                       Key max_key) {
+    for (Key key : keys) {
+      ASSERT_TRUE(tree.Contains(Encode(&key)));
+    }
+
+    TestTree::Iterator iter(&tree);
+    iter.SeekToFirst();
+    for (Key key : keys) {
+      ASSERT_TRUE(iter.Valid());
+      ASSERT_EQ(key, Decode(iter.key()));
+      iter.Next();
+    }
+    ASSERT_FALSE(iter.Valid());
+
+    iter.SeekToLast();
+    for (auto it = keys.rbegin(); it != keys.rend(); ++it) {
+      ASSERT_TRUE(iter.Valid());
+      ASSERT_EQ(*it, Decode(iter.key()));
+      iter.Prev();
+    }
+    ASSERT_FALSE(iter.Valid());
+
+    // Compare seeks against the model for every target in range.
+    for (Key i = 0; i <= max_key; i++) {
+      iter.Seek(Encode(&i));
+      auto lower = keys.lower_bound(i);
+      if (lower == keys.end()) {
+        ASSERT_FALSE(iter.Valid());
+      } else {
+        ASSERT_TRUE(iter.Valid());
+        ASSERT_EQ(*lower, Decode(iter.key()));
+      }
+
+      iter.SeekForPrev(Encode(&i));
+      auto upper = keys.upper_bound(i);
+      if (upper == keys.begin()) {
+        ASSERT_FALSE(iter.Valid());
+      } else {
+        ASSERT_TRUE(iter.Valid());
+        ASSERT_EQ(*std::prev(upper), Decode(iter.key()));
+      }
+    }
+  }
+};
+
+TEST_F(AdaptiveRadixTreeTest, Empty) {
+  Arena arena;
+  TestTree tree(TestEncoder(), &arena);
+  Key key = 10;
+  ASSERT_FALSE(tree.Contains(Encode(&key)));
+
+  TestTree::Iterator iter(&tree);
+  ASSERT_FALSE(iter.Valid());
+  iter.SeekToFirst();
+  ASSERT_FALSE(iter.Valid());
+  iter.Seek(Encode(&key));
+  ASSERT_FALSE(iter.Valid());
+  iter.SeekForPrev(Encode(&key));
+  ASSERT_FALSE(iter.Valid());
+  iter.SeekToLast();
+  ASSERT_FALSE(iter.Valid());
+}
+
+TEST_F(AdaptiveRadixTreeTest, InsertAndLookup) {
+  // Dense keys grow nodes up to Node256; sparse ones leave long compressed
+  // paths that later inserts have to split.
+  for (Key range : {Key{300}, Key{5000}, Key{1} << 40}) {
+    Random rnd(1000);
+    std::set<Key> keys;
+    ConcurrentArena arena;
+    TestTree tree(TestEncoder(), &arena);
+    for (int i = 0; i < 2000; i++) {
+      Key key = (static_cast<Key>(rnd.Next()) << 32 | rnd.Next()) % range;
+      ASSERT_EQ(keys.insert(key).second, Insert(&tree, key));
+    }
+    Validate(tree, keys, std::min<Key>(range, 6000));
+  }
+}
+
+TEST_F(AdaptiveRadixTreeTest, ConcurrentInsertAndRead) {
+  const int kNumKeys = 20000;
+  const int kReaders = 2;
+  ConcurrentArena arena;
+  TestTree tree(TestEncoder(), &arena);
+  std::atomic<bool> writer_done{false};
+
+  std::vector<port::Thread> threads;
+  // Readers must always see a sorted sequence of keys while the writer runs.
+  for (int t = 0; t < kReaders; t++) {
+    threads.emplace_back([&]() {
+      while (!writer_done.load()) {
+        TestTree::Iterator iter(&tree);
+        iter.SeekToFirst();
+        bool first = true;
+        Key prev = 0;
+        for (; iter.Valid(); iter.Next()) {
+          Key key = Decode(iter.key());
+          ASSERT_TRUE(first || prev < key);
+          first = false;
+          prev = key;
+        }
+      }
+    });
+  }
+  for (int i = 0; i < kNumKeys; i++) {
+    // Insert out of order so that inner nodes grow and split under readers.
+    Key key = (static_cast<Key>(i) * 7919) % kNumKeys;
+    ASSERT_TRUE(Insert(&tree, key));
+  }
+  writer_done.store(true);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::set<Key> keys;
+  for (Key key = 0; key < Key{kNumKeys}; key++) {
+    keys.insert(key);
+  }
+  Validate(tree, keys, Key{kNumKeys});
+}
+
+TEST_F(AdaptiveRadixTreeTest, ConcurrentInsert) {
+  // Dense keys make the writers grow the same nodes, sparse ones make them
+  // split the same compressed paths.
+  for (Key stride : {Key{1}, Key{1} << 28}) {
+    const int kNumKeys = 20000;
+    const int kWriters = 4;
+    ConcurrentArena arena;
+    TestTree tree(TestEncoder(), &arena);
+    std::atomic<bool> writers_done{false};
+
+    std::vector<port::Thread> writers;
+    for (int t = 0; t < kWriters; t++) {
+      writers.emplace_back([&, t]() {
+        // Every writer also tries to insert the keys of the next writer, so
+        // that the duplicate check races with the inserts.
+        for (int i = 0; i < kNumKeys; i++) {
+          if (i % kWriters != t && i % kWriters != (t + 1) % kWriters) {
+            continue;
+          }
+          Key key = ((static_cast<Key>(i) * 7919) % kNumKeys) * stride;
+          char* buf = tree.AllocateKey(sizeof(Key));
+          memcpy(buf, &key, sizeof(Key));
+          tree.InsertConcurrently(buf);
+        }
+      });
+    }
+    port::Thread reader([&]() {
+      while (!writers_done.load()) {
+        TestTree::Iterator iter(&tree);
+        iter.SeekToFirst();
+        bool first = true;
+        Key prev = 0;
+        for (; iter.Valid(); iter.Next()) {
+          Key key = Decode(iter.key());
+          ASSERT_TRUE(first || prev < key);
+          first = false;
+          prev = key;
+        }
+      }
+    });
+    for (auto& writer : writers) {
+      writer.join();
+    }
+    writers_done.store(true);
+    reader.join();
+
+    std::set<Key> keys;
+    for (Key i = 0; i < Key{kNumKeys}; i++) {
+      keys.insert(i * stride);
+      ASSERT_FALSE(Insert(&tree, i * stride));
+    }
+    Validate(tree, keys, std::min<Key>(Key{kNumKeys} * stride, 6000));
+  }
+}
+
+TEST_F(AdaptiveRadixTreeTest, LongEncodedKeys) {
+  // Encoded keys longer than the inline buffer of ArtEncodedKey
+  ArtEncodedKey a;
+  ArtEncodedKey b;
+  const std::string long_key(1000, 'x');
+  a.append(long_key.data(), long_key.size());
+  b.append(long_key.data(), long_key.size());
+  ASSERT_EQ(0, a.compare(b));
+  b.push_back('y');
+  ASSERT_LT(a.compare(b), 0);
+  ASSERT_GT(b.compare(a), 0);
+  a.clear();
+  a.append(2, 'z');
+  ASSERT_GT(a.compare(b), 0);
+  ASSERT_EQ(2, a.size());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,208 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+#include <string>
+
+#include "db/dbformat.h"
+#include "db/memtable.h"
+#include "memory/arena.h"
+#include "memtable/adaptive_radix_tree.h"
+#include "rocksdb/memtablerep.h"
+#include "util/coding.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+// Maps a memtable entry (or a memtable key) to a byte string that orders the
+// same way as its internal key under the bytewise comparator. The user key is
+// escaped so that it can be terminated without becoming a prefix of a longer
+// user key: every 0x00 is written as 0x00 0xFF and the key ends with
+// 0x00 0x00. The sequence number follows, inverted and big-endian, so that
+// newer entries of a user key come first. Like the memtable's key comparator,
+// the encoding ignores the value type.
+struct ArtKeyEncoder {
+  void operator()(const char* entry, ArtEncodedKey* encoded) const {
+    Slice internal_key = GetLengthPrefixedSlice(entry);
+    assert(internal_key.size() >= kNumInternalBytes);
+    Slice user_key = ExtractUserKey(internal_key);
+    uint64_t inverted_seq = ~(ExtractInternalKeyFooter(internal_key) >> 8);
+
+    encoded->clear();
+    encoded->reserve(user_key.size() + 2 + sizeof(inverted_seq));
+    const char* p = user_key.data();
+    const char* limit = p + user_key.size();
+    while (p < limit) {
+      const size_t remaining = static_cast<size_t>(limit - p);
+      const char* zero = static_cast<const char*>(memchr(p, 0, remaining));
+      if (zero == nullptr) {
+        encoded->append(p, remaining);
+        break;
+      }
+      encoded->append(p, static_cast<size_t>(zero - p) + 1);
+      encoded->push_back(static_cast<char>(0xff));
+      p = zero + 1;
+    }
+    encoded->append(2, '\0');
+    for (int shift = 56; shift >= 0; shift -= 8) {
+      encoded->push_back(static_cast<char>((inverted_seq >> shift) & 0xff));
+    }
+  }
+};
+
+class AdaptiveRadixTreeRep : public MemTableRep {
+  AdaptiveRadixTree<ArtKeyEncoder> tree_;
+
+ public:
+  explicit AdaptiveRadixTreeRep(Allocator* allocator)
+      : MemTableRep(allocator), tree_(ArtKeyEncoder(), allocator) {}
+
+  KeyHandle Allocate(const size_t len, char** buf) override {
+    *buf = tree_.AllocateKey(len);
+    return static_cast<KeyHandle>(*buf);
+  }
+
+  // Insert key into the tree.
+  // REQUIRES: nothing that compares equal to key is currently in the tree.
+  void Insert(KeyHandle handle) override {
+    tree_.Insert(static_cast<char*>(handle));
+  }
+
+  bool InsertKey(KeyHandle handle) override {
+    return tree_.Insert(static_cast<char*>(handle));
+  }
+
+  bool InsertKeyWithHint(KeyHandle handle, void** /*hint*/) override {
+    return tree_.Insert(static_cast<char*>(handle));
+  }
+
+  bool InsertKeyWithHintConcurrently(KeyHandle handle,
+                                     void** /*hint*/) override {
+    return tree_.InsertConcurrently(static_cast<char*>(handle));
+  }
+
+  void InsertConcurrently(KeyHandle handle) override {
+    tree_.InsertConcurrently(static_cast<char*>(handle));
+  }
+
+  bool InsertKeyConcurrently(KeyHandle handle) override {
+    return tree_.InsertConcurrently(static_cast<char*>(handle));
+  }
+
+  // Returns true iff an entry that compares equal to key is in the tree.
+  bool Contains(const char* key) const override { return tree_.Contains(key); }
+
+  size_t ApproximateMemoryUsage() override {
+    // All memory is allocated through allocator; nothing to report here
+    return 0;
+  }
+
+  void Get(const LookupKey& k, void* callback_args,
+           bool (*callback_func)(void* arg, const char* entry)) override {
+    AdaptiveRadixTree<ArtKeyEncoder>::Iterator iter(&tree_);
+    for (iter.Seek(k.memtable_key().data());
+         iter.Valid() && callback_func(callback_args, iter.key());
+         iter.Next()) {
+    }
+  }
+
+  void UniqueRandomSample(const uint64_t num_entries,
+                          const uint64_t target_sample_size,
+                          std::unordered_set<const char*>* entries) override {
+    entries->clear();
+    // Avoid divide-by-0.
+    assert(target_sample_size > 0);
+    assert(num_entries > 0);
+    // The tree has no random access, so iterate linearly through the entries
+    // and add each of them to the sample set with probability
+    // (target_sample_size - entries.size()) / (num_entries - i).
+    Random* rnd = Random::GetTLSInstance();
+    AdaptiveRadixTree<ArtKeyEncoder>::Iterator iter(&tree_);
+    iter.SeekToFirst();
+    uint64_t counter = 0, num_samples_left = target_sample_size;
+    for (; iter.Valid() && (num_samples_left > 0) && counter < num_entries;
+         iter.Next(), counter++) {
+      if (rnd->Next() % (num_entries - counter) < num_samples_left) {
+        entries->insert(iter.key());
+        num_samples_left--;
+      }
+    }
+  }
+
+  ~AdaptiveRadixTreeRep() override = default;
+
+  // Iteration over the contents of an adaptive radix tree
+  class Iterator : public MemTableRep::Iterator {
+    AdaptiveRadixTree<ArtKeyEncoder>::Iterator iter_;
+
+   public:
+    // Initialize an iterator over the specified tree.
+    // The returned iterator is not valid.
+    explicit Iterator(const AdaptiveRadixTree<ArtKeyEncoder>* tree)
+        : iter_(tree) {}
+
+    ~Iterator() override = default;
+
+    // Returns true iff the iterator is positioned at a valid node.
+    bool Valid() const override { return iter_.Valid(); }
+
+    // Returns the key at the current position.
+    // REQUIRES: Valid()
+    const char* key() const override { return iter_.key(); }
+
+    // Advances to the next position.
+    // REQUIRES: Valid()
+    void Next() override { iter_.Next(); }
+
+    // Advances to the previous position.
+    // REQUIRES: Valid()
+    void Prev() override { iter_.Prev(); }
+
+    // Advance to the first entry with a key >= target
+    void Seek(const Slice& user_key, const char* memtable_key) override {
+      if (memtable_key != nullptr) {
+        iter_.Seek(memtable_key);
+      } else {
+        iter_.Seek(EncodeKey(&tmp_, user_key));
+      }
+    }
+
+    // Retreat to the last entry with a key <= target
+    void SeekForPrev(const Slice& user_key, const char* memtable_key) override {
+      if (memtable_key != nullptr) {
+        iter_.SeekForPrev(memtable_key);
+      } else {
+        iter_.SeekForPrev(EncodeKey(&tmp_, user_key));
+      }
+    }
+
+    // Position at the first entry in the tree.
+    // Final state of iterator is Valid() iff the tree is not empty.
+    void SeekToFirst() override { iter_.SeekToFirst(); }
+
+    // Position at the last entry in the tree.
+    // Final state of iterator is Valid() iff the tree is not empty.
+    void SeekToLast() override { iter_.SeekToLast(); }
+
+   protected:
+    std::string tmp_;  // For passing to EncodeKey
+  };
+
+  MemTableRep::Iterator* GetIterator(Arena* arena = nullptr) override {
+    void* mem =
+        arena ? arena->AllocateAligned(sizeof(AdaptiveRadixTreeRep::Iterator))
+              :
+              operator new(sizeof(AdaptiveRadixTreeRep::Iterator));
+    return new (mem) AdaptiveRadixTreeRep::Iterator(&tree_);
+  }
+};
+}  // namespace
+
+MemTableRep* AdaptiveRadixTreeRepFactory::CreateMemTableRep(
+    const MemTableRep::KeyComparator& /*compare*/, Allocator* allocator,
+    const SliceTransform* /*transform*/, Logger* /*logger*/) {
+  return new AdaptiveRadixTreeRep(allocator);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
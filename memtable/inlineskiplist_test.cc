@@ -11,6 +11,7 @@
 
 #include <set>
 #include <unordered_set>
+#include <vector>
 
 #include "memory/concurrent_arena.h"
 #include "rocksdb/env.h"
@@ -70,6 +71,28 @@ class InlineSkipTest : public testing::Test {
     keys_.insert(key);
   }
 
+  // Inserts keys in batches of batch_size, returning the number of keys
+  // that were not present yet.
+  size_t InsertBatch(TestInlineSkipList* list, const std::vector<Key>& keys,
+                     size_t batch_size, bool concurrently) {
+    size_t num_inserted = 0;
+    std::vector<char*> bufs;
+    for (size_t i = 0; i < keys.size(); i++) {
+      char* buf = list->AllocateKey(sizeof(Key));
+      memcpy(buf, &keys[i], sizeof(Key));
+      bufs.push_back(buf);
+      keys_.insert(keys[i]);
+      if (bufs.size() == batch_size || i + 1 == keys.size()) {
+        num_inserted +=
+            concurrently
+                ? list->InsertBatchConcurrently(bufs.data(), bufs.size())
+                : list->InsertBatch(bufs.data(), bufs.size());
+        bufs.clear();
+      }
+    }
+    return num_inserted;
+  }
+
   bool InsertWithHint(TestInlineSkipList* list, Key key, void** hint) {
     char* buf = list->AllocateKey(sizeof(Key));
     memcpy(buf, &key, sizeof(Key));
@@ -309,6 +332,29 @@ TEST_F(InlineSkipTest, InsertWithHint_CompatibleWithInsertWithoutHint) {
   Validate(&list);
 }
 
+TEST_F(InlineSkipTest, InsertBatch) {
+  const int N = 100000;
+  const int S = 100;
+  for (bool concurrently : {false, true}) {
+    Random rnd(534);
+    ConcurrentArena arena;
+    TestComparator cmp;
+    TestInlineSkipList list(cmp, &arena);
+    // Clustered batches of keys from a few groups, with some keys repeated
+    // within and across batches.
+    std::vector<Key> keys;
+    std::set<Key> unique_keys;
+    for (int i = 0; i < N; i++) {
+      Key key = (static_cast<Key>(rnd.Uniform(S)) << 32) + rnd.Uniform(N);
+      keys.push_back(key);
+      unique_keys.insert(key);
+    }
+    ASSERT_EQ(unique_keys.size(),
+              InsertBatch(&list, keys, 1000 /* batch_size */, concurrently));
+    Validate(&list);
+  }
+}
+
 #if !defined(ROCKSDB_VALGRIND_RUN) || defined(ROCKSDB_FULL_VALGRIND_RUN)
 // We want to make sure that with a single writer and multiple
 // concurrent readers (with no synchronization other than when a
@@ -72,6 +72,21 @@ class SkipListRep : public MemTableRep {
     return skip_list_.InsertConcurrently(static_cast<char*>(handle));
   }
 
+  void InsertBatch(KeyHandle* handles, size_t num_handles) override {
+    size_t num_inserted = skip_list_.InsertBatch(
+        reinterpret_cast<char**>(handles), num_handles);
+    assert(num_inserted == num_handles);
+    (void)num_inserted;
+  }
+
+  void InsertBatchConcurrently(KeyHandle* handles,
+                               size_t num_handles) override {
+    size_t num_inserted = skip_list_.InsertBatchConcurrently(
+        reinterpret_cast<char**>(handles), num_handles);
+    assert(num_inserted == num_handles);
+    (void)num_inserted;
+  }
+
   // Returns true iff an entry that compares equal to key is in the list.
   bool Contains(const char* key) const override {
     return skip_list_.Contains(key);
@@ -14,8 +14,11 @@
 #include "memtable/stl_wrappers.h"
 #include "port/port.h"
 #include "rocksdb/memtablerep.h"
+#include "rocksdb/threadpool.h"
 #include "rocksdb/utilities/options_type.h"
+#include "util/core_local.h"
 #include "util/mutexlock.h"
+#include "util/parallel_for.h"
 
 namespace ROCKSDB_NAMESPACE {
 namespace {
@@ -30,6 +33,10 @@ class VectorRep : public MemTableRep {
   // collection.
   void Insert(KeyHandle handle) override;
 
+  // Like Insert(handle), but may be called concurrently. Entries are appended
+  // to the bucket of the core the caller runs on.
+  void InsertConcurrently(KeyHandle handle) override;
+
   // Returns true iff an entry that compares equal to key is in the collection.
   bool Contains(const char* key) const override;
 
@@ -43,8 +50,10 @@ class VectorRep : public MemTableRep {
   ~VectorRep() override = default;
 
   class Iterator : public MemTableRep::Iterator {
+    // Non-null iff iterating over an immutable memtable, in which case the
+    // bucket is the sorted one shared by all iterators of vrep_.
     class VectorRep* vrep_;
-    std::shared_ptr<std::vector<const char*>> bucket_;
+    std::shared_ptr<std::vector<const char*>> mutable bucket_;
     std::vector<const char*>::const_iterator mutable cit_;
     const KeyComparator& compare_;
     std::string tmp_;  // For passing to EncodeKey
@@ -97,6 +106,30 @@ class VectorRep : public MemTableRep {
  private:
   friend class Iterator;
   using Bucket = std::vector<const char*>;
+
+  // Entries are appended to per-core buckets, so that concurrent writers
+  // rarely contend on the same mutex or cache line. The buckets are only
+  // sorted and merged once the memtable is immutable.
+  struct CoreBucket {
+    char padding[40] ROCKSDB_FIELD_UNUSED;
+    mutable SpinMutex mutex;
+    Bucket entries;
+  };
+
+  // Returns an unsorted copy of all entries.
+  std::shared_ptr<Bucket> CopyEntries() const;
+
+  // Returns the sorted entries of the immutable memtable, sorting and merging
+  // the per-core buckets the first time.
+  std::shared_ptr<Bucket> GetSortedBucket();
+
+  // Sorts the per-core buckets and merges them into a single sorted bucket,
+  // with the help of a small shared thread pool if there are many entries.
+  void SortAndMerge(std::vector<Bucket*>& runs, Bucket* result) const;
+
+  CoreLocalArray<CoreBucket> core_buckets_;
+  std::atomic<size_t> num_entries_;
+  // Sorted entries, set once the immutable memtable is first iterated.
   std::shared_ptr<Bucket> bucket_;
   mutable port::RWMutex rwlock_;
   bool immutable_;
@@ -104,17 +137,52 @@ class VectorRep : public MemTableRep {
   const KeyComparator& compare_;
 };
 
-void VectorRep::Insert(KeyHandle handle) {
+// Below this many entries the buckets are sorted by the calling thread alone.
+const size_t kMinEntriesForParallelSort = 64 << 10;
+
+// At most this many threads help the calling thread sort and merge the
+// buckets. They are shared by all VectorReps, so concurrent flushes do not
+// start more threads.
+const size_t kMaxSortHelpers = 3;
+
+ThreadPool* SortHelperPool() {
+  static std::unique_ptr<ThreadPool, void (*)(ThreadPool*)> pool(
+      NewThreadPool(static_cast<int>(kMaxSortHelpers)), [](ThreadPool* p) {
+        p->JoinAllThreads();
+        delete p;
+      });
+  return pool.get();
+}
+
+void VectorRep::Insert(KeyHandle handle) { InsertConcurrently(handle); }
+
+void VectorRep::InsertConcurrently(KeyHandle handle) {
   auto* key = static_cast<char*>(handle);
-  WriteLock l(&rwlock_);
   assert(!immutable_);
-  bucket_->push_back(key);
+  CoreBucket* core_bucket = core_buckets_.Access();
+  {
+    std::lock_guard<SpinMutex> l(core_bucket->mutex);
+    core_bucket->entries.push_back(key);
+  }
+  num_entries_.fetch_add(1, std::memory_order_relaxed);
 }
 
 // Returns true iff an entry that compares equal to key is in the collection.
 bool VectorRep::Contains(const char* key) const {
   ReadLock l(&rwlock_);
-  return std::find(bucket_->begin(), bucket_->end(), key) != bucket_->end();
+  if (sorted_) {
+    // The per-core buckets have been merged into bucket_.
+    return std::find(bucket_->begin(), bucket_->end(), key) != bucket_->end();
+  }
+  for (size_t i = 0; i < core_buckets_.Size(); ++i) {
+    CoreBucket* core_bucket = core_buckets_.AccessAtCore(i);
+    std::lock_guard<SpinMutex> guard(core_bucket->mutex);
+    if (std::find(core_bucket->entries.begin(), core_bucket->entries.end(),
+                  key) != core_bucket->entries.end()) {
+      return true;
+    }
+  }
+  return false;
 }
 
 void VectorRep::MarkReadOnly() {
@@ -123,20 +191,106 @@ void VectorRep::MarkReadOnly() {
 }
 
 size_t VectorRep::ApproximateMemoryUsage() {
-  return sizeof(bucket_) + sizeof(*bucket_) +
-         bucket_->size() *
-             sizeof(
-                 std::remove_reference<decltype(*bucket_)>::type::value_type);
+  return sizeof(*this) + core_buckets_.Size() * sizeof(CoreBucket) +
+         num_entries_.load(std::memory_order_relaxed) *
+             sizeof(Bucket::value_type);
 }
 
 VectorRep::VectorRep(const KeyComparator& compare, Allocator* allocator,
                      size_t count)
     : MemTableRep(allocator),
-      bucket_(new Bucket()),
+      num_entries_(0),
       immutable_(false),
       sorted_(false),
       compare_(compare) {
-  bucket_.get()->reserve(count);
+  const size_t count_per_core = count / core_buckets_.Size();
+  for (size_t i = 0; i < core_buckets_.Size(); ++i) {
+    core_buckets_.AccessAtCore(i)->entries.reserve(count_per_core);
+  }
+}
+
+std::shared_ptr<VectorRep::Bucket> VectorRep::CopyEntries() const {
+  std::shared_ptr<Bucket> bucket(new Bucket());
+  bucket->reserve(num_entries_.load(std::memory_order_relaxed));
+  for (size_t i = 0; i < core_buckets_.Size(); ++i) {
+    CoreBucket* core_bucket = core_buckets_.AccessAtCore(i);
+    std::lock_guard<SpinMutex> l(core_bucket->mutex);
+    bucket->insert(bucket->end(), core_bucket->entries.begin(),
+                   core_bucket->entries.end());
+  }
+  return bucket;
+}
+
+std::shared_ptr<VectorRep::Bucket> VectorRep::GetSortedBucket() {
+  {
+    ReadLock l(&rwlock_);
+    assert(immutable_);
+    if (sorted_) {
+      return bucket_;
+    }
+  }
+  WriteLock l(&rwlock_);
+  if (!sorted_) {
+    // No more writes, so the per-core buckets can be used without locking.
+    std::vector<Bucket*> runs;
+    for (size_t i = 0; i < core_buckets_.Size(); ++i) {
+      Bucket* entries = &core_buckets_.AccessAtCore(i)->entries;
+      if (!entries->empty()) {
+        runs.push_back(entries);
+      }
+    }
+    bucket_.reset(new Bucket());
+    SortAndMerge(runs, bucket_.get());
+    for (size_t i = 0; i < core_buckets_.Size(); ++i) {
+      Bucket().swap(core_buckets_.AccessAtCore(i)->entries);
+    }
+    sorted_ = true;
+  }
+  return bucket_;
+}
+
+void VectorRep::SortAndMerge(std::vector<Bucket*>& runs,
+                             Bucket* result) const {
+  stl_wrappers::Compare cmp(compare_);
+  ThreadPool* pool = runs.size() > 1 &&
+                             num_entries_.load(std::memory_order_relaxed) >=
+                                 kMinEntriesForParallelSort
+                         ? SortHelperPool()
+                         : nullptr;
+  ParallelFor(pool, kMaxSortHelpers, runs.size(), [&runs, &cmp](size_t i) {
+    std::sort(runs[i]->begin(), runs[i]->end(), cmp);
+  });
+
+  // Merge pairs of sorted runs until a single one is left, merging the pairs
+  // of one round in parallel. owned[i] holds runs[i] if it is the output of
+  // an earlier round.
+  std::vector<std::unique_ptr<Bucket>> owned(runs.size());
+  while (runs.size() > 1) {
+    const size_t num_runs = runs.size();
+    std::vector<Bucket*> next_runs((num_runs + 1) / 2);
+    std::vector<std::unique_ptr<Bucket>> next_owned(next_runs.size());
+    for (size_t i = 0; i + 1 < num_runs; i += 2) {
+      Bucket* out = new Bucket(runs[i]->size() + runs[i + 1]->size());
+      next_owned[i / 2].reset(out);
+      next_runs[i / 2] = out;
+    }
+    ParallelFor(pool, kMaxSortHelpers, num_runs / 2,
+                [&runs, &next_runs, &cmp](size_t i) {
+                  Bucket* a = runs[2 * i];
+                  Bucket* b = runs[2 * i + 1];
+                  std::merge(a->begin(), a->end(), b->begin(), b->end(),
+                             next_runs[i]->begin(), cmp);
+                });
+    if (num_runs % 2 == 1) {
+      next_runs.back() = runs.back();
+      next_owned.back() = std::move(owned.back());
+    }
+    runs = std::move(next_runs);
+    owned = std::move(next_owned);
+  }
+  if (runs.size() == 1) {
+    result->swap(*runs[0]);
+  }
 }
 
 VectorRep::Iterator::Iterator(class VectorRep* vrep,
@@ -144,20 +298,15 @@ VectorRep::Iterator::Iterator(class VectorRep* vrep,
                               const KeyComparator& compare)
     : vrep_(vrep),
       bucket_(bucket),
-      cit_(bucket_->end()),
+      cit_(),
       compare_(compare),
       sorted_(false) {}
 
 void VectorRep::Iterator::DoSort() const {
   // vrep is non-null means that we are working on an immutable memtable
   if (!sorted_ && vrep_ != nullptr) {
-    WriteLock l(&vrep_->rwlock_);
-    if (!vrep_->sorted_) {
-      std::sort(bucket_->begin(), bucket_->end(),
-                stl_wrappers::Compare(compare_));
-      cit_ = bucket_->begin();
-      vrep_->sorted_ = true;
-    }
+    bucket_ = vrep_->GetSortedBucket();
+    cit_ = bucket_->begin();
     sorted_ = true;
   }
   if (!sorted_) {
@@ -251,11 +400,12 @@ void VectorRep::Get(const LookupKey& k, void* callback_args,
   std::shared_ptr<Bucket> bucket;
   if (immutable_) {
     vector_rep = this;
+    bucket = bucket_;
   } else {
     vector_rep = nullptr;
-    bucket.reset(new Bucket(*bucket_));  // make a copy
+    bucket = CopyEntries();
   }
-  VectorRep::Iterator iter(vector_rep, immutable_ ? bucket_ : bucket, compare_);
+  VectorRep::Iterator iter(vector_rep, bucket, compare_);
   rwlock_.ReadUnlock();
 
   for (iter.Seek(k.user_key(), k.memtable_key().data());
@@ -278,8 +428,7 @@ MemTableRep::Iterator* VectorRep::GetIterator(Arena* arena) {
       return new (mem) Iterator(this, bucket_, compare_);
     }
   } else {
-    std::shared_ptr<Bucket> tmp;
-    tmp.reset(new Bucket(*bucket_));  // make a copy
+    std::shared_ptr<Bucket> tmp = CopyEntries();
     if (arena == nullptr) {
       return new Iterator(nullptr, tmp, compare_);
     } else {
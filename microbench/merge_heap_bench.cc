@@ -0,0 +1,117 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+// Compares BinaryHeap and TournamentTree as the merge heap of a k-way merge
+// of sorted runs of internal keys, the way MergingIterator and
+// CompactionMergingIterator use them.
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "db/dbformat.h"
+#include "util/coding.h"
+#include "util/heap.h"
+#include "util/math.h"
+#include "util/tournament_tree.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+struct SortedRun {
+  std::vector<std::string> keys;
+  size_t pos = 0;
+
+  Slice key() const { return keys[pos]; }
+};
+
+// Orders runs by their current key, smallest on top.
+class SortedRunComparator {
+ public:
+  SortedRunComparator(const InternalKeyComparator* icmp, uint64_t* num_compares)
+      : icmp_(icmp), num_compares_(num_compares) {}
+
+  bool operator()(SortedRun* a, SortedRun* b) const {
+    ++*num_compares_;
+    return icmp_->Compare(a->key(), b->key()) > 0;
+  }
+
+ private:
+  const InternalKeyComparator* icmp_;
+  uint64_t* num_compares_;
+};
+
+// Spreads `num_keys` keys over `fan_in` runs in chunks of `chunk_size`
+// consecutive keys, so chunk_size 1 interleaves the runs completely.
+std::vector<SortedRun> MakeRuns(int64_t fan_in, int64_t chunk_size,
+                                int64_t num_keys) {
+  std::vector<SortedRun> runs(fan_in);
+  for (int64_t i = 0; i < num_keys; ++i) {
+    std::string user_key = "key_prefix_";
+    PutFixed64(&user_key, EndianSwapValue(static_cast<uint64_t>(i)));
+    InternalKey ikey(user_key, static_cast<SequenceNumber>(i), kTypeValue);
+    runs[(i / chunk_size) % fan_in].keys.push_back(ikey.Encode().ToString());
+  }
+  return runs;
+}
+
+template <typename Heap>
+void MergeRuns(benchmark::State& state) {
+  const int64_t kNumKeys = 1 << 16;
+  InternalKeyComparator icmp(BytewiseComparator());
+  std::vector<SortedRun> runs =
+      MakeRuns(state.range(1), state.range(2), kNumKeys);
+  uint64_t num_compares = 0;
+  Heap heap(SortedRunComparator(&icmp, &num_compares));
+
+  for (auto _ : state) {
+    for (auto& run : runs) {
+      run.pos = 0;
+      if (!run.keys.empty()) {
+        heap.push(&run);
+      }
+    }
+    while (!heap.empty()) {
+      SortedRun* top = heap.top();
+      if (++top->pos < top->keys.size()) {
+        heap.replace_top(top);
+      } else {
+        heap.pop();
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumKeys);
+  state.counters["compares_per_key"] = static_cast<double>(num_compares) /
+                                       static_cast<double>(state.iterations()) /
+                                       static_cast<double>(kNumKeys);
+}
+}  // namespace
+
+// benchmark arguments:
+// 0. merge heap: 0 for BinaryHeap, 1 for TournamentTree
+// 1. number of sorted runs
+// 2. number of consecutive keys taken from the same run
+static void CustomArguments(benchmark::internal::Benchmark* b) {
+  for (int impl : {0, 1}) {
+    for (int fan_in : {4, 8, 16, 32, 64, 128}) {
+      for (int chunk_size : {1, 16}) {
+        b->Args({impl, fan_in, chunk_size});
+      }
+    }
+  }
+  b->ArgNames({"tournament_tree", "fan_in", "chunk_size"});
+}
+
+static void MergeHeapMerge(benchmark::State& state) {
+  if (state.range(0) == 0) {
+    MergeRuns<BinaryHeap<SortedRun*, SortedRunComparator>>(state);
+  } else {
+    MergeRuns<TournamentTree<SortedRun*, SortedRunComparator>>(state);
+  }
+}
+BENCHMARK(MergeHeapMerge)->Apply(CustomArguments);
+
+}  // namespace ROCKSDB_NAMESPACE
+
+BENCHMARK_MAIN();
@@ -266,6 +266,8 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {PREFETCH_BYTES_USEFUL, "rocksdb.prefetch.bytes.useful"},
     {PREFETCH_HITS, "rocksdb.prefetch.hits"},
     {SST_FOOTER_CORRUPTION_COUNT, "rocksdb.footer.corruption.count"},
+    {CACHE_ADMISSION_ADMITS, "rocksdb.cache.admission.admits"},
+    {CACHE_ADMISSION_REJECTS, "rocksdb.cache.admission.rejects"},
 };
 
 const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
@@ -568,6 +568,14 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, memtable_max_range_deletions),
           OptionType::kUInt32T, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"max_flush_partitions",
+         {offsetof(struct MutableCFOptions, max_flush_partitions),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"use_tournament_tree_merge",
+         {offsetof(struct MutableCFOptions, use_tournament_tree_merge),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
 
 };
 
@@ -1123,6 +1131,10 @@ void MutableCFOptions::Dump(Logger* log) const {
                  experimental_mempurge_threshold);
   ROCKS_LOG_INFO(log, "         bottommost_file_compaction_delay: %" PRIu32,
                  bottommost_file_compaction_delay);
+  ROCKS_LOG_INFO(log, "                     max_flush_partitions: %" PRIu32,
+                 max_flush_partitions);
+  ROCKS_LOG_INFO(log, "                use_tournament_tree_merge: %d",
+                 use_tournament_tree_merge);
 
   // Universal Compaction Options
   ROCKS_LOG_INFO(log, "compaction_options_universal.size_ratio : %d",
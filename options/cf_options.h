@@ -172,6 +172,8 @@ struct MutableCFOptions {
             options.sample_for_compression),  // TODO: is 0 fine here?
         compression_per_level(options.compression_per_level),
         memtable_max_range_deletions(options.memtable_max_range_deletions),
+        max_flush_partitions(options.max_flush_partitions),
+        use_tournament_tree_merge(options.use_tournament_tree_merge),
         bottommost_file_compaction_delay(
             options.bottommost_file_compaction_delay) {
     RefreshDerivedOptions(options.num_levels, options.compaction_style);
@@ -223,7 +225,9 @@ struct MutableCFOptions {
         memtable_protection_bytes_per_key(0),
         block_protection_bytes_per_key(0),
         sample_for_compression(0),
-        memtable_max_range_deletions(0) {}
+        memtable_max_range_deletions(0),
+        max_flush_partitions(1),
+        use_tournament_tree_merge(false) {}
 
   explicit MutableCFOptions(const Options& options);
 
@@ -318,6 +322,8 @@ struct MutableCFOptions {
   uint64_t sample_for_compression;
   std::vector<CompressionType> compression_per_level;
   uint32_t memtable_max_range_deletions;
+  uint32_t max_flush_partitions;
+  bool use_tournament_tree_merge;
   uint32_t bottommost_file_compaction_delay;
 
   // Derived options
@@ -8,6 +8,7 @@
 #include <cinttypes>
 
 #include "logging/logging.h"
+#include "memory/huge_page_pool.h"
 #include "options/configurable_helper.h"
 #include "options/options_helper.h"
 #include "options/options_parser.h"
@@ -322,14 +323,30 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, enable_pipelined_write),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"enable_pipelined_wal_sync",
+         {offsetof(struct ImmutableDBOptions, enable_pipelined_wal_sync),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"unordered_write",
          {offsetof(struct ImmutableDBOptions, unordered_write),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"num_wal_shards",
+         {offsetof(struct ImmutableDBOptions, num_wal_shards),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"allow_concurrent_memtable_write",
          {offsetof(struct ImmutableDBOptions, allow_concurrent_memtable_write),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"memtable_numa_aware",
+         {offsetof(struct ImmutableDBOptions, memtable_numa_aware),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"memtable_huge_page_pool_size",
+         {offsetof(struct ImmutableDBOptions, memtable_huge_page_pool_size),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"wal_recovery_mode",
          OptionTypeInfo::Enum<WALRecoveryMode>(
              offsetof(struct ImmutableDBOptions, wal_recovery_mode),
@@ -343,6 +360,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, write_thread_slow_yield_usec),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"write_stall_per_column_family",
+         {offsetof(struct ImmutableDBOptions, write_stall_per_column_family),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"max_write_batch_group_size_bytes",
          {offsetof(struct ImmutableDBOptions, max_write_batch_group_size_bytes),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
@@ -735,12 +756,17 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       listeners(options.listeners),
       enable_thread_tracking(options.enable_thread_tracking),
       enable_pipelined_write(options.enable_pipelined_write),
+      enable_pipelined_wal_sync(options.enable_pipelined_wal_sync),
       unordered_write(options.unordered_write),
+      num_wal_shards(options.num_wal_shards),
       allow_concurrent_memtable_write(options.allow_concurrent_memtable_write),
+      memtable_numa_aware(options.memtable_numa_aware),
+      memtable_huge_page_pool_size(options.memtable_huge_page_pool_size),
       enable_write_thread_adaptive_yield(
           options.enable_write_thread_adaptive_yield),
       write_thread_max_yield_usec(options.write_thread_max_yield_usec),
       write_thread_slow_yield_usec(options.write_thread_slow_yield_usec),
+      write_stall_per_column_family(options.write_stall_per_column_family),
       skip_stats_update_on_db_open(options.skip_stats_update_on_db_open),
       skip_checking_sst_file_sizes_on_db_open(
           options.skip_checking_sst_file_sizes_on_db_open),
@@ -778,6 +804,10 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
   clock = env->GetSystemClock().get();
   logger = info_log.get();
   stats = statistics.get();
+  if (memtable_huge_page_pool_size > 0) {
+    memtable_huge_page_pool =
+        std::make_shared<HugePageBlockPool>(memtable_huge_page_pool_size);
+  }
 }
 
 void ImmutableDBOptions::Dump(Logger* log) const {
@@ -887,10 +917,19 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    enable_thread_tracking);
   ROCKS_LOG_HEADER(log, "                 Options.enable_pipelined_write: %d",
                    enable_pipelined_write);
+  ROCKS_LOG_HEADER(log, "              Options.enable_pipelined_wal_sync: %d",
+                   enable_pipelined_wal_sync);
   ROCKS_LOG_HEADER(log, "                 Options.unordered_write: %d",
                    unordered_write);
+  ROCKS_LOG_HEADER(log, "                 Options.num_wal_shards: %" PRIu32,
+                   num_wal_shards);
   ROCKS_LOG_HEADER(log, "        Options.allow_concurrent_memtable_write: %d",
                    allow_concurrent_memtable_write);
+  ROCKS_LOG_HEADER(log, "                    Options.memtable_numa_aware: %d",
+                   memtable_numa_aware);
+  ROCKS_LOG_HEADER(
+      log, "           Options.memtable_huge_page_pool_size: %" ROCKSDB_PRIszt,
+      memtable_huge_page_pool_size);
   ROCKS_LOG_HEADER(log, "     Options.enable_write_thread_adaptive_yield: %d",
                    enable_write_thread_adaptive_yield);
   ROCKS_LOG_HEADER(log,
@@ -899,6 +938,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
   ROCKS_LOG_HEADER(log,
                    "           Options.write_thread_slow_yield_usec: %" PRIu64,
                    write_thread_slow_yield_usec);
+  ROCKS_LOG_HEADER(log, "          Options.write_stall_per_column_family: %d",
+                   write_stall_per_column_family);
   if (row_cache) {
     ROCKS_LOG_HEADER(
         log,
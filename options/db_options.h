@@ -11,6 +11,7 @@
 #include "rocksdb/options.h"
 
 namespace ROCKSDB_NAMESPACE {
+class HugePageBlockPool;
 class SystemClock;
 
 struct ImmutableDBOptions {
@@ -66,11 +67,16 @@ struct ImmutableDBOptions {
   std::vector<std::shared_ptr<EventListener>> listeners;
   bool enable_thread_tracking;
   bool enable_pipelined_write;
+  bool enable_pipelined_wal_sync;
   bool unordered_write;
+  uint32_t num_wal_shards;
   bool allow_concurrent_memtable_write;
+  bool memtable_numa_aware;
+  size_t memtable_huge_page_pool_size;
   bool enable_write_thread_adaptive_yield;
   uint64_t write_thread_max_yield_usec;
   uint64_t write_thread_slow_yield_usec;
+  bool write_stall_per_column_family;
   bool skip_stats_update_on_db_open;
   bool skip_checking_sst_file_sizes_on_db_open;
   WALRecoveryMode wal_recovery_mode;
@@ -102,6 +108,9 @@ struct ImmutableDBOptions {
   SystemClock* clock;
   Statistics* stats;
   Logger* logger;
+  // Shared by the memtables of all column families. nullptr unless
+  // memtable_huge_page_pool_size > 0.
+  std::shared_ptr<HugePageBlockPool> memtable_huge_page_pool;
   std::shared_ptr<CompactionService> compaction_service;
   bool enforce_single_del_contracts;
   uint64_t follower_refresh_catchup_period_ms;
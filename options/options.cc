@@ -466,6 +466,10 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
                      experimental_mempurge_threshold);
     ROCKS_LOG_HEADER(log, "           Options.memtable_max_range_deletions: %d",
                      memtable_max_range_deletions);
+    ROCKS_LOG_HEADER(log, "                   Options.max_flush_partitions: %u",
+                     max_flush_partitions);
+    ROCKS_LOG_HEADER(log, "              Options.use_tournament_tree_merge: %d",
+                     use_tournament_tree_merge);
 }  // ColumnFamilyOptions::Dump
 
 void Options::Dump(Logger* log) const {
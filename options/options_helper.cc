@@ -131,9 +131,15 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.enable_thread_tracking = immutable_db_options.enable_thread_tracking;
   options.delayed_write_rate = mutable_db_options.delayed_write_rate;
   options.enable_pipelined_write = immutable_db_options.enable_pipelined_write;
+  options.enable_pipelined_wal_sync =
+      immutable_db_options.enable_pipelined_wal_sync;
   options.unordered_write = immutable_db_options.unordered_write;
+  options.num_wal_shards = immutable_db_options.num_wal_shards;
   options.allow_concurrent_memtable_write =
       immutable_db_options.allow_concurrent_memtable_write;
+  options.memtable_numa_aware = immutable_db_options.memtable_numa_aware;
+  options.memtable_huge_page_pool_size =
+      immutable_db_options.memtable_huge_page_pool_size;
   options.enable_write_thread_adaptive_yield =
       immutable_db_options.enable_write_thread_adaptive_yield;
   options.max_write_batch_group_size_bytes =
@@ -142,6 +148,8 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
       immutable_db_options.write_thread_max_yield_usec;
   options.write_thread_slow_yield_usec =
       immutable_db_options.write_thread_slow_yield_usec;
+  options.write_stall_per_column_family =
+      immutable_db_options.write_stall_per_column_family;
   options.skip_stats_update_on_db_open =
       immutable_db_options.skip_stats_update_on_db_open;
   options.skip_checking_sst_file_sizes_on_db_open =
@@ -274,6 +282,8 @@ void UpdateColumnFamilyOptions(const MutableCFOptions& moptions,
   cf_opts->last_level_temperature = moptions.last_level_temperature;
   cf_opts->default_write_temperature = moptions.default_write_temperature;
   cf_opts->memtable_max_range_deletions = moptions.memtable_max_range_deletions;
+  cf_opts->max_flush_partitions = moptions.max_flush_partitions;
+  cf_opts->use_tournament_tree_merge = moptions.use_tournament_tree_merge;
 }
 
 void UpdateColumnFamilyOptions(const ImmutableCFOptions& ioptions,
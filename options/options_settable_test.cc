@@ -125,6 +125,8 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
        sizeof(std::shared_ptr<Cache>)},
       {offsetof(struct BlockBasedTableOptions, persistent_cache),
        sizeof(std::shared_ptr<PersistentCache>)},
+      {offsetof(struct BlockBasedTableOptions, decompression_thread_pool),
+       sizeof(std::shared_ptr<ThreadPool>)},
       {offsetof(struct BlockBasedTableOptions, cache_usage_options),
        sizeof(CacheUsageOptions)},
       {offsetof(struct BlockBasedTableOptions, filter_policy),
@@ -183,6 +185,9 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
       "data_block_index_type=kDataBlockBinaryAndHash;"
       "index_shortening=kNoShortening;"
       "data_block_hash_table_util_ratio=0.75;"
+      "data_block_restart_fingerprints=true;"
+      "data_block_key_prefix_dict_max_bytes=4096;"
+      "columnar_entity_blocks=true;"
       "checksum=kxxHash;no_block_cache=1;"
       "block_cache=1M;block_cache_compressed=1k;block_size=1024;"
       "block_size_deviation=8;block_restart_interval=4; "
@@ -195,6 +200,7 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
       "construct_corruption=false;"
       "format_version=1;"
       "verify_compression=true;read_amp_bytes_per_bit=0;"
+      "adaptive_data_block_compression=true;"
       "enable_index_compression=false;"
       "block_align=true;"
       "max_auto_readahead_size=0;"
@@ -337,12 +343,17 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "advise_random_on_open=true;"
                              "fail_if_options_file_error=false;"
                              "enable_pipelined_write=false;"
+                             "enable_pipelined_wal_sync=false;"
                              "unordered_write=false;"
+                             "num_wal_shards=1;"
                              "allow_concurrent_memtable_write=true;"
+                             "memtable_numa_aware=false;"
+                             "memtable_huge_page_pool_size=0;"
                              "wal_recovery_mode=kPointInTimeRecovery;"
                              "enable_write_thread_adaptive_yield=true;"
                              "write_thread_slow_yield_usec=5;"
                              "write_thread_max_yield_usec=1000;"
+                             "write_stall_per_column_family=false;"
                              "info_log_level=DEBUG_LEVEL;"
                              "dump_malloc_stats=false;"
                              "allow_2pc=false;"
@@ -565,6 +576,8 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "persist_user_defined_timestamps=true;"
       "block_protection_bytes_per_key=1;"
       "memtable_max_range_deletions=999999;"
+      "max_flush_partitions=4;"
+      "use_tournament_tree_merge=true;"
       "bottommost_file_compaction_delay=7200;",
       new_options));
 
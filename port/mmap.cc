@@ -6,6 +6,7 @@
 #include "port/mmap.h"
 
 #include <cassert>
+#include <cerrno>
 #include <cstdio>
 #include <cstring>
 #include <new>
@@ -48,7 +49,8 @@ MemMapping& MemMapping::operator=(MemMapping&& other) noexcept {
   return *this;
 }
 
-MemMapping MemMapping::AllocateAnonymous(size_t length, bool huge) {
+MemMapping MemMapping::AllocateAnonymous(size_t length, bool huge,
+                                         size_t huge_page_size) {
   MemMapping mm;
   mm.length_ = length;
   assert(mm.addr_ == nullptr);
@@ -76,10 +78,27 @@ MemMapping MemMapping::AllocateAnonymous(size_t length, bool huge) {
   if (huge) {
 #ifdef MAP_HUGETLB
     huge_flag = MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+    if (huge_page_size != 0 && (huge_page_size & (huge_page_size - 1)) == 0) {
+      int page_shift = 0;
+      while ((size_t{1} << page_shift) < huge_page_size) {
+        ++page_shift;
+      }
+      huge_flag |= page_shift << MAP_HUGE_SHIFT;
+    }
+#endif  // MAP_HUGE_SHIFT
 #endif  // MAP_HUGE_TLB
   }
   mm.addr_ = mmap(nullptr, length, PROT_READ | PROT_WRITE,
                   MAP_PRIVATE | MAP_ANONYMOUS | huge_flag, -1, 0);
+#ifdef MAP_HUGETLB
+  if (mm.addr_ == MAP_FAILED && huge_flag != MAP_HUGETLB && huge_flag != 0 &&
+      errno == EINVAL) {
+    // Not a huge page size the kernel knows; use the default one.
+    mm.addr_ = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  }
+#endif  // MAP_HUGETLB
   if (mm.addr_ == MAP_FAILED) {
     mm.addr_ = nullptr;
   }
@@ -87,8 +106,46 @@ MemMapping MemMapping::AllocateAnonymous(size_t length, bool huge) {
   return mm;
 }
 
-MemMapping MemMapping::AllocateHuge(size_t length) {
-  return AllocateAnonymous(length, /*huge*/ true);
+MemMapping MemMapping::AllocateHuge(size_t length, size_t huge_page_size) {
+  return AllocateAnonymous(length, /*huge*/ true, huge_page_size);
+}
+
+MemMapping MemMapping::AllocateTransparentHuge(size_t length,
+                                               size_t huge_page_size) {
+#if defined(OS_WIN) || !defined(MADV_HUGEPAGE)
+  (void)huge_page_size;
+  return AllocateAnonymous(length, /*huge*/ false);
+#else
+  if (length == 0 || huge_page_size == 0 ||
+      (huge_page_size & (huge_page_size - 1)) != 0) {
+    return AllocateAnonymous(length, /*huge*/ false);
+  }
+  // Over-allocate so that an aligned range of whole huge pages fits, then
+  // unmap the unaligned head and tail. Only aligned ranges can be backed by
+  // transparent huge pages.
+  length = ((length - 1) / huge_page_size + 1) * huge_page_size;
+  MemMapping mm = AllocateAnonymous(length + huge_page_size, /*huge*/ false);
+  if (mm.addr_ == nullptr) {
+    return mm;
+  }
+  char* begin = static_cast<char*>(mm.addr_);
+  char* aligned = reinterpret_cast<char*>(
+      (reinterpret_cast<uintptr_t>(begin) + huge_page_size - 1) &
+      ~(huge_page_size - 1));
+  size_t head = static_cast<size_t>(aligned - begin);
+  size_t tail = huge_page_size - head;
+  if (head > 0) {
+    munmap(begin, head);
+  }
+  if (tail > 0) {
+    munmap(aligned + length, tail);
+  }
+  mm.addr_ = aligned;
+  mm.length_ = length;
+  // Best effort: without THP support the memory is still usable.
+  (void)madvise(aligned, length, MADV_HUGEPAGE);
+  return mm;
+#endif  // OS_WIN || !MADV_HUGEPAGE
 }
 
 MemMapping MemMapping::AllocateLazyZeroed(size_t length) {
@@ -30,8 +30,18 @@ class MemMapping {
       false;
 #endif
 
-  // Allocate memory requesting to be backed by huge pages
-  static MemMapping AllocateHuge(size_t length);
+  // Allocate memory requesting to be backed by huge pages. If huge_page_size
+  // is not 0, it selects the page size (e.g. 2MB or 1GB) where the platform
+  // supports more than one; otherwise the default huge page size is used.
+  static MemMapping AllocateHuge(size_t length, size_t huge_page_size = 0);
+
+  // Allocate lazily mapped, zero-initialized memory that is aligned to
+  // huge_page_size and advised to be backed by transparent huge pages where
+  // the platform supports it. Unlike AllocateHuge(), this does not need
+  // huge pages to be reserved, but the kernel may still back (parts of) it
+  // with normal pages.
+  static MemMapping AllocateTransparentHuge(size_t length,
+                                            size_t huge_page_size);
 
   // Allocate memory that is only lazily mapped to resident memory and
   // guaranteed to be zero-initialized. Note that some platforms like
@@ -65,7 +75,8 @@ class MemMapping {
   HANDLE page_file_handle_ = NULL;
 #endif  // OS_WIN
 
-  static MemMapping AllocateAnonymous(size_t length, bool huge);
+  static MemMapping AllocateAnonymous(size_t length, bool huge,
+                                      size_t huge_page_size = 0);
 };
 
 // Simple MemMapping wrapper that presents the memory as an array of T.
@@ -12,6 +12,7 @@
 #include "table/block_based/block.h"
 
 #include <algorithm>
+#include <limits>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -22,6 +23,7 @@
 #include "rocksdb/comparator.h"
 #include "table/block_based/block_prefix_index.h"
 #include "table/block_based/data_block_footer.h"
+#include "table/block_based/restart_fingerprints.h"
 #include "table/format.h"
 #include "util/coding.h"
 
@@ -285,14 +287,14 @@ void DataBlockIter::PrevImpl() {
     if (raw_key_.IsKeyPinned()) {
       // The key is not delta encoded
       prev_entries_.emplace_back(current_, current_key.data(), 0,
-                                 current_key.size(), value());
+                                 current_key.size(), RawValue());
     } else {
       // The key is delta encoded, cache decoded key in buffer
       size_t new_key_offset = prev_entries_keys_buff_.size();
       prev_entries_keys_buff_.append(current_key.data(), current_key.size());
 
       prev_entries_.emplace_back(current_, nullptr, new_key_offset,
-                                 current_key.size(), value());
+                                 current_key.size(), RawValue());
     }
     // Loop until end of current entry hits the start of original entry
   } while (NextEntryOffset() < original);
@@ -307,7 +309,7 @@ void DataBlockIter::SeekImpl(const Slice& target) {
   }
   uint32_t index = 0;
   bool skip_linear_scan = false;
-  bool ok = BinarySeek<DecodeKey>(seek_key, &index, &skip_linear_scan);
+  bool ok = SeekRestartPoint(seek_key, &index, &skip_linear_scan);
 
   if (!ok) {
     return;
@@ -315,6 +317,26 @@ void DataBlockIter::SeekImpl(const Slice& target) {
   FindKeyAfterBinarySeek(seek_key, index, skip_linear_scan);
 }
 
+bool DataBlockIter::SeekRestartPoint(const Slice& target, uint32_t* index,
+                                     bool* skip_linear_scan) {
+  if (restart_fingerprints_ == nullptr || restarts_ == 0) {
+    return BinarySeek<DecodeKey>(target, index, skip_linear_scan);
+  }
+  // Restart keys with a smaller fingerprint are smaller than the target and
+  // those with a larger one are larger, so only the restart points in
+  // [lower, upper) need their keys compared.
+  uint64_t fp = RestartKeyFingerprint(ExtractUserKey(target));
+  const char* fps = restart_fingerprints_;
+  uint32_t lower = CountRestartFingerprintsLessThan(fps, num_restarts_, fp);
+  uint32_t upper =
+      fp == std::numeric_limits<uint64_t>::max()
+          ? num_restarts_
+          : CountRestartFingerprintsLessThan(fps, num_restarts_, fp + 1);
+  return BinarySeekInRange<DecodeKey>(target, static_cast<int64_t>(lower) - 1,
+                                      static_cast<int64_t>(upper) - 1, index,
+                                      skip_linear_scan);
+}
+
 void MetaBlockIter::SeekImpl(const Slice& target) {
   Slice seek_key = target;
   PERF_TIMER_GUARD(block_seek_nanos);
@@ -494,6 +516,8 @@ void IndexBlockIter::SeekImpl(const Slice& target) {
     // restart interval must be one when hash search is enabled so the binary
     // search simply lands at the right place.
     skip_linear_scan = true;
+  } else if (learned_index_) {
+    ok = LearnedSeek(seek_key, &index, &skip_linear_scan);
   } else if (value_delta_encoded_) {
     ok = BinarySeek<DecodeKeyV4>(seek_key, &index, &skip_linear_scan);
   } else {
@@ -514,7 +538,7 @@ void DataBlockIter::SeekForPrevImpl(const Slice& target) {
   }
   uint32_t index = 0;
   bool skip_linear_scan = false;
-  bool ok = BinarySeek<DecodeKey>(seek_key, &index, &skip_linear_scan);
+  bool ok = SeekRestartPoint(seek_key, &index, &skip_linear_scan);
 
   if (!ok) {
     return;
@@ -659,7 +683,10 @@ bool BlockIter<TValue>::ParseNextKey(bool* is_shared) {
       // If this key doesn't share any bytes with prev key, and no min timestamp
       // needs to be padded to the key, then we don't need to decode it and
       // can use its address in the block directly (no copy).
-      UpdateRawKeyAndMaybePadMinTimestamp(Slice(p, non_shared));
+      if (!UpdateRawKeyAndMaybePadMinTimestamp(Slice(p, non_shared))) {
+        CorruptionError();
+        return false;
+      }
     } else {
       // This key share `shared` bytes with prev key, we need to decode it
       *is_shared = true;
@@ -714,6 +741,43 @@ bool DataBlockIter::ParseNextDataKey(bool* is_shared) {
   }
 }
 
+Slice DataBlockIter::EntityFromColumns() const {
+  if (entity_offset_ == current_) {
+    return entity_;
+  }
+  entity_offset_ = kNoEntity;
+  Slice input = value_;
+  uint32_t row = 0;
+  Status s;
+  if (!GetVarint32(&input, &row) || !input.empty()) {
+    s = Status::Corruption("bad entity row in data block");
+  }
+  if (s.ok() && columnar_reader_ == nullptr) {
+    s = ColumnarBlockReader::Create(column_section_, &columnar_reader_);
+  }
+  std::string* entity = &entity_buf_;
+  if (s.ok() && pinned_entities_ != nullptr) {
+    pinned_entities_->emplace_back();
+    entity = &pinned_entities_->back();
+  }
+  if (s.ok()) {
+    s = columnar_reader_->GetSerializedEntity(row, column_projection_, entity);
+  }
+  if (!s.ok()) {
+    // An empty value does not deserialize as an entity either.
+    column_status_ = s;
+    entity_ = Slice();
+    return entity_;
+  }
+  entity_ = *entity;
+  entity_offset_ = current_;
+  return entity_;
+}
+
+void DataBlockIter::DeletePinnedEntities(void* arg1, void* /*arg2*/) {
+  delete static_cast<std::deque<std::string>*>(arg1);
+}
+
 bool IndexBlockIter::ParseNextIndexKey() {
   bool is_shared = false;
   bool ok = (value_delta_encoded_) ? ParseNextKey<DecodeEntryV4>(&is_shared)
@@ -837,7 +901,15 @@ bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
     // key accesses.
     return false;
   }
+  return BinarySeekInRange<DecodeKeyFunc>(target, -1, num_restarts_ - 1, index,
+                                          skip_linear_scan);
+}
 
+template <class TValue>
+template <typename DecodeKeyFunc>
+bool BlockIter<TValue>::BinarySeekInRange(const Slice& target, int64_t left,
+                                          int64_t right, uint32_t* index,
+                                          bool* skip_linear_scan) {
   *skip_linear_scan = false;
   // Loop invariants:
   // - Restart key at index `left` is less than or equal to the target key. The
@@ -845,7 +917,6 @@ bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
   //   keys.
   // - Any restart keys after index `right` are strictly greater than the target
   //   key.
-  int64_t left = -1, right = num_restarts_ - 1;
   while (left != right) {
     // The `mid` is computed by rounding up so it lands in (`left`, `right`].
     int64_t mid = left + (right - left + 1) / 2;
@@ -858,7 +929,10 @@ bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
       return false;
     }
     Slice mid_key(key_ptr, non_shared);
-    UpdateRawKeyAndMaybePadMinTimestamp(mid_key);
+    if (!UpdateRawKeyAndMaybePadMinTimestamp(mid_key)) {
+      CorruptionError();
+      return false;
+    }
     int cmp = CompareCurrentKey(target);
     if (cmp < 0) {
       // Key at "mid" is smaller than "target". Therefore all
@@ -885,6 +959,60 @@ bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
   return true;
 }
 
+bool IndexBlockIter::LearnedSeek(const Slice& target, uint32_t* index,
+                                 bool* skip_linear_scan) {
+  if (restarts_ == 0) {
+    // See BinarySeek().
+    return false;
+  }
+  int64_t left = -1, right = num_restarts_ - 1;
+  uint32_t first = 0, last = 0;
+  Slice user_key = raw_key_.IsUserKey() ? target : ExtractUserKey(target);
+  if (learned_index_->Predict(user_key, num_restarts_, &first, &last)) {
+    // Narrow [left, right] to the predicted window, checking the restart keys
+    // just outside of it. A wrong prediction only costs the extra search.
+    if (first > 0) {
+      int cmp = CompareBlockKey(first, target);
+      if (!status_.ok()) {
+        return false;
+      }
+      if (cmp == 0) {
+        *skip_linear_scan = true;
+        *index = first;
+        return true;
+      }
+      if (cmp < 0) {
+        left = first;
+      } else {
+        right = first - 1;
+      }
+    }
+    int64_t after_last = static_cast<int64_t>(last) + 1;
+    if (after_last > left && after_last <= right) {
+      int cmp = CompareBlockKey(static_cast<uint32_t>(after_last), target);
+      if (!status_.ok()) {
+        return false;
+      }
+      if (cmp == 0) {
+        *skip_linear_scan = true;
+        *index = static_cast<uint32_t>(after_last);
+        return true;
+      }
+      if (cmp > 0) {
+        right = last;
+      } else {
+        left = after_last;
+      }
+    }
+  }
+  if (value_delta_encoded_) {
+    return BinarySeekInRange<DecodeKeyV4>(target, left, right, index,
+                                          skip_linear_scan);
+  }
+  return BinarySeekInRange<DecodeKey>(target, left, right, index,
+                                      skip_linear_scan);
+}
+
 // Compare target key and the block key of the block of `block_index`.
 // Return -1 if error.
 int IndexBlockIter::CompareBlockKey(uint32_t block_index, const Slice& target) {
@@ -1037,6 +1165,19 @@ uint32_t Block::NumRestarts() const {
   return num_restarts;
 }
 
+bool Block::HasRestartFingerprints() const {
+  assert(size_ >= 2 * sizeof(uint32_t));
+  if (size_ > kMaxBlockSizeSupportedByHashIndex) {
+    // The check is for the same reason as that in NumRestarts()
+    return false;
+  }
+  uint32_t block_footer = DecodeFixed32(data_ + size_ - sizeof(uint32_t));
+  bool has_restart_fingerprints = false;
+  UnPackIndexTypeAndNumRestarts(block_footer, nullptr, nullptr,
+                                &has_restart_fingerprints);
+  return has_restart_fingerprints;
+}
+
 BlockBasedTableOptions::DataBlockIndexType Block::IndexType() const {
   assert(size_ >= 2 * sizeof(uint32_t));
   if (size_ > kMaxBlockSizeSupportedByHashIndex) {
@@ -1050,6 +1191,20 @@ BlockBasedTableOptions::DataBlockIndexType Block::IndexType() const {
   return index_type;
 }
 
+Status Block::GetColumnSection(Slice* section) const {
+  assert(section != nullptr);
+  *section = Slice();
+  if (size_ == 0 || num_restarts_ == 0) {
+    return Status::OK();
+  }
+  const uint32_t first_entry = DecodeFixed32(data_ + restart_offset_);
+  if (first_entry > restart_offset_) {
+    return Status::Corruption("bad column section in data block");
+  }
+  *section = Slice(data_, first_entry);
+  return Status::OK();
+}
+
 Block::~Block() {
   // This sync point can be re-enabled if RocksDB can control the
   // initialization order of any/all static options created by the user.
@@ -1070,15 +1225,21 @@ Block::Block(BlockContents&& contents, size_t read_amp_bytes_per_bit,
   } else {
     // Should only decode restart points for uncompressed blocks
     num_restarts_ = NumRestarts();
+    const bool has_restart_fingerprints =
+        size_ >= 2 * sizeof(uint32_t) && HasRestartFingerprints();
+    // Size of the restart array plus fingerprints, if any.
+    const uint64_t restarts_size =
+        uint64_t{num_restarts_} *
+        (sizeof(uint32_t) + (has_restart_fingerprints ? sizeof(uint64_t) : 0));
     switch (IndexType()) {
       case BlockBasedTableOptions::kDataBlockBinarySearch:
-        restart_offset_ = static_cast<uint32_t>(size_) -
-                          (1 + num_restarts_) * sizeof(uint32_t);
-        if (restart_offset_ > size_ - sizeof(uint32_t)) {
-          // The size is too small for NumRestarts() and therefore
-          // restart_offset_ wrapped around.
+        if (restarts_size > size_ - sizeof(uint32_t)) {
+          // The size is too small for NumRestarts().
           size_ = 0;
+          break;
         }
+        restart_offset_ =
+            static_cast<uint32_t>(size_ - sizeof(uint32_t) - restarts_size);
         break;
       case BlockBasedTableOptions::kDataBlockBinaryAndHash:
         if (size_ < sizeof(uint32_t) /* block footer */ +
@@ -1093,18 +1254,20 @@ Block::Block(BlockContents&& contents, size_t read_amp_bytes_per_bit,
                                                                 NUM_RESTARTS*/
             &map_offset);
 
-        restart_offset_ = map_offset - num_restarts_ * sizeof(uint32_t);
-
-        if (restart_offset_ > map_offset) {
-          // map_offset is too small for NumRestarts() and
-          // therefore restart_offset_ wrapped around.
+        if (restarts_size > map_offset) {
+          // map_offset is too small for NumRestarts().
           size_ = 0;
           break;
         }
+        restart_offset_ = static_cast<uint32_t>(map_offset - restarts_size);
         break;
       default:
         size_ = 0;  // Error marker
     }
+    if (has_restart_fingerprints && size_ != 0) {
+      restart_fingerprints_ =
+          data_ + restart_offset_ + num_restarts_ * sizeof(uint32_t);
+    }
   }
   if (read_amp_bytes_per_bit != 0 && statistics && size_ != 0) {
     read_amp_bitmap_.reset(new BlockReadAmpBitmap(
@@ -1112,8 +1275,9 @@ Block::Block(BlockContents&& contents, size_t read_amp_bytes_per_bit,
   }
 }
 
-void Block::InitializeDataBlockProtectionInfo(uint8_t protection_bytes_per_key,
-                                              const Comparator* raw_ucmp) {
+void Block::InitializeDataBlockProtectionInfo(
+    uint8_t protection_bytes_per_key, const Comparator* raw_ucmp,
+    const KeyPrefixDict* key_prefix_dict) {
   protection_bytes_per_key_ = 0;
   if (protection_bytes_per_key > 0 && num_restarts_ > 0) {
     // NewDataIterator() is called with protection_bytes_per_key_ = 0.
@@ -1126,7 +1290,7 @@ void Block::InitializeDataBlockProtectionInfo(uint8_t protection_bytes_per_key,
     std::unique_ptr<DataBlockIter> iter{NewDataIterator(
         raw_ucmp, kDisableGlobalSequenceNumber, nullptr /* iter */,
         nullptr /* stats */, true /* block_contents_pinned */,
-        true /* user_defined_timestamps_persisted */)};
+        true /* user_defined_timestamps_persisted */, key_prefix_dict)};
     if (iter->status().ok()) {
       block_restart_interval_ = iter->GetRestartInterval();
     }
@@ -1258,7 +1422,9 @@ DataBlockIter* Block::NewDataIterator(const Comparator* raw_ucmp,
                                       SequenceNumber global_seqno,
                                       DataBlockIter* iter, Statistics* stats,
                                       bool block_contents_pinned,
-                                      bool user_defined_timestamps_persisted) {
+                                      bool user_defined_timestamps_persisted,
+                                      const KeyPrefixDict* key_prefix_dict,
+                                      bool has_column_section) {
   DataBlockIter* ret_iter;
   if (iter != nullptr) {
     ret_iter = iter;
@@ -1274,12 +1440,21 @@ DataBlockIter* Block::NewDataIterator(const Comparator* raw_ucmp,
     ret_iter->Invalidate(Status::OK());
     return ret_iter;
   } else {
+    Slice column_section;
+    if (has_column_section) {
+      Status s = GetColumnSection(&column_section);
+      if (!s.ok()) {
+        ret_iter->Invalidate(s);
+        return ret_iter;
+      }
+    }
     ret_iter->Initialize(
         raw_ucmp, data_, restart_offset_, num_restarts_, global_seqno,
         read_amp_bitmap_.get(), block_contents_pinned,
         user_defined_timestamps_persisted,
         data_block_hash_index_.Valid() ? &data_block_hash_index_ : nullptr,
-        protection_bytes_per_key_, kv_checksum_, block_restart_interval_);
+        protection_bytes_per_key_, kv_checksum_, block_restart_interval_,
+        restart_fingerprints_, key_prefix_dict, column_section);
     if (read_amp_bitmap_) {
       if (read_amp_bitmap_->GetStatistics() != stats) {
         // DB changed the Statistics pointer, we need to notify read_amp_bitmap_
@@ -1296,7 +1471,7 @@ IndexBlockIter* Block::NewIndexIterator(
     IndexBlockIter* iter, Statistics* /*stats*/, bool total_order_seek,
     bool have_first_key, bool key_includes_seq, bool value_is_full,
     bool block_contents_pinned, bool user_defined_timestamps_persisted,
-    BlockPrefixIndex* prefix_index) {
+    BlockPrefixIndex* prefix_index, const LearnedIndexModel* learned_index) {
   IndexBlockIter* ret_iter;
   if (iter != nullptr) {
     ret_iter = iter;
@@ -1318,7 +1493,8 @@ IndexBlockIter* Block::NewIndexIterator(
         raw_ucmp, data_, restart_offset_, num_restarts_, global_seqno,
         prefix_index_ptr, have_first_key, key_includes_seq, value_is_full,
         block_contents_pinned, user_defined_timestamps_persisted,
-        protection_bytes_per_key_, kv_checksum_, block_restart_interval_);
+        protection_bytes_per_key_, kv_checksum_, block_restart_interval_,
+        learned_index);
   }
 
   return ret_iter;
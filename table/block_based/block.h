@@ -11,9 +11,12 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <deque>
+#include <limits>
 #include <string>
 #include <vector>
 
+#include "db/dbformat.h"
 #include "db/kv_checksum.h"
 #include "db/pinned_iterators_manager.h"
 #include "port/malloc.h"
@@ -23,7 +26,10 @@
 #include "rocksdb/statistics.h"
 #include "rocksdb/table.h"
 #include "table/block_based/block_prefix_index.h"
+#include "table/block_based/columnar_block.h"
 #include "table/block_based/data_block_hash_index.h"
+#include "table/block_based/key_prefix_dict.h"
+#include "table/block_based/learned_index.h"
 #include "table/format.h"
 #include "table/internal_iterator.h"
 #include "test_util/sync_point.h"
@@ -169,9 +175,25 @@ class Block {
   size_t usable_size() const { return contents_.usable_size(); }
   uint32_t NumRestarts() const;
   bool own_bytes() const { return contents_.own_bytes(); }
+  // The memory holding the block if it was allocated from `allocator`, or
+  // nullptr. See Cache::AllocationCallback.
+  void* GetAllocation(MemoryAllocator* allocator) const {
+    return contents_.allocation.get_deleter().allocator == allocator
+               ? contents_.allocation.get()
+               : nullptr;
+  }
 
   BlockBasedTableOptions::DataBlockIndexType IndexType() const;
 
+  // Whether the block stores restart fingerprints (see
+  // restart_fingerprints.h).
+  bool HasRestartFingerprints() const;
+
+  // For data blocks of tables written with columnar_entity_blocks, sets
+  // `section` to the column section that precedes the first entry (see
+  // columnar_block.h). It is empty if the block has no entities.
+  Status GetColumnSection(Slice* section) const;
+
   // raw_ucmp is a raw (i.e., not wrapped by `UserComparatorWrapper`) user key
   // comparator.
   //
@@ -191,15 +213,22 @@ class Block {
   // `user_defined_timestamps_persisted` controls whether a min timestamp is
   // padded while key is being parsed from the block.
   //
+  // `key_prefix_dict` must be set for data blocks of tables written with a
+  // key prefix dictionary, and must outlive the iterator.
+  //
+  // `has_column_section` must be set for data blocks of tables written with
+  // columnar_entity_blocks.
+  //
   // NOTE: for the hash based lookup, if a key prefix doesn't match any key,
   // the iterator will simply be set as "invalid", rather than returning
   // the key that is just pass the target key.
-  DataBlockIter* NewDataIterator(const Comparator* raw_ucmp,
-                                 SequenceNumber global_seqno,
-                                 DataBlockIter* iter = nullptr,
-                                 Statistics* stats = nullptr,
-                                 bool block_contents_pinned = false,
-                                 bool user_defined_timestamps_persisted = true);
+  DataBlockIter* NewDataIterator(
+      const Comparator* raw_ucmp, SequenceNumber global_seqno,
+      DataBlockIter* iter = nullptr, Statistics* stats = nullptr,
+      bool block_contents_pinned = false,
+      bool user_defined_timestamps_persisted = true,
+      const KeyPrefixDict* key_prefix_dict = nullptr,
+      bool has_column_section = false);
 
   // Returns an MetaBlockIter for iterating over blocks containing metadata
   // (like Properties blocks).  Unlike data blocks, the keys for these blocks
@@ -227,6 +256,9 @@ class Block {
   // If `prefix_index` is not nullptr this block will do hash lookup for the key
   // prefix. If total_order_seek is true, prefix_index_ is ignored.
   //
+  // If `learned_index` is not nullptr, seeks binary search only the restart
+  // points it predicts for the target (see LearnedIndexModel).
+  //
   // `have_first_key` controls whether IndexValue will contain
   // first_internal_key. It affects data serialization format, so the same value
   // have_first_key must be used when writing and reading index.
@@ -239,7 +271,8 @@ class Block {
       bool have_first_key, bool key_includes_seq, bool value_is_full,
       bool block_contents_pinned = false,
       bool user_defined_timestamps_persisted = true,
-      BlockPrefixIndex* prefix_index = nullptr);
+      BlockPrefixIndex* prefix_index = nullptr,
+      const LearnedIndexModel* learned_index = nullptr);
 
   // Report an approximation of how much memory has been used.
   size_t ApproximateMemoryUsage() const;
@@ -250,8 +283,9 @@ class Block {
   // Initializes per key-value checksum protection.
   // After this method is called, each DataBlockIterator returned
   // by NewDataIterator will verify per key-value checksum for any key it read.
-  void InitializeDataBlockProtectionInfo(uint8_t protection_bytes_per_key,
-                                         const Comparator* raw_ucmp);
+  void InitializeDataBlockProtectionInfo(
+      uint8_t protection_bytes_per_key, const Comparator* raw_ucmp,
+      const KeyPrefixDict* key_prefix_dict = nullptr);
 
   // Initializes per key-value checksum protection.
   // After this method is called, each IndexBlockIterator returned
@@ -288,6 +322,8 @@ class Block {
   uint32_t block_restart_interval_{0};
   uint8_t protection_bytes_per_key_{0};
   DataBlockHashIndex data_block_hash_index_;
+  // Points into data_ when the block stores restart fingerprints.
+  const char* restart_fingerprints_{nullptr};
 };
 
 // A `BlockIter` iterates over the entries in a `Block`'s data buffer. The
@@ -459,6 +495,9 @@ class BlockIter : public InternalIteratorBase<TValue> {
   // partitioned index blocks. In summary, this only applies to block whose key
   // are real user keys or internal keys created from user keys.
   bool pad_min_timestamp_;
+  // Dictionary of the key prefixes of keys with no shared bytes, for data
+  // blocks of tables written with a key prefix dictionary.
+  const KeyPrefixDict* key_prefix_dict_ = nullptr;
 
   // Per key-value checksum related states
   const char* kv_checksum_;
@@ -542,6 +581,7 @@ class BlockIter : public InternalIteratorBase<TValue> {
       ts_sz_ = raw_ucmp->timestamp_size();
     }
     pad_min_timestamp_ = ts_sz_ > 0 && !user_defined_timestamp_persisted;
+    key_prefix_dict_ = nullptr;
     block_contents_pinned_ = block_contents_pinned;
     cache_handle_ = nullptr;
     cur_entry_idx_ = -1;
@@ -573,7 +613,12 @@ class BlockIter : public InternalIteratorBase<TValue> {
     CorruptionError(error_msg);
   }
 
-  void UpdateRawKeyAndMaybePadMinTimestamp(const Slice& key) {
+  // Returns false if `key` refers to a prefix missing from the key prefix
+  // dictionary.
+  bool UpdateRawKeyAndMaybePadMinTimestamp(const Slice& key) {
+    if (key_prefix_dict_ != nullptr) {
+      return UpdateRawKeyFromPrefixDict(key);
+    }
     if (pad_min_timestamp_) {
       std::string buf;
       if (raw_key_.IsUserKey()) {
@@ -585,6 +630,25 @@ class BlockIter : public InternalIteratorBase<TValue> {
     } else {
       raw_key_.SetKey(key, false /* copy */);
     }
+    return true;
+  }
+
+  // Decodes a key stored as a key prefix dictionary id and a suffix. The
+  // key can only be used in place when the id refers to the empty prefix.
+  bool UpdateRawKeyFromPrefixDict(Slice key) {
+    assert(!pad_min_timestamp_);
+    uint32_t id = 0;
+    Slice prefix;
+    if (!GetVarint32(&key, &id) || !key_prefix_dict_->Get(id, &prefix)) {
+      return false;
+    }
+    if (prefix.empty()) {
+      raw_key_.SetKey(key, false /* copy */);
+    } else {
+      raw_key_.SetKey(prefix, false /* copy */);
+      raw_key_.TrimAppend(prefix.size(), key.data(), key.size());
+    }
+    return true;
   }
 
   // Must be called every time a key is found that needs to be returned to user,
@@ -675,6 +739,14 @@ class BlockIter : public InternalIteratorBase<TValue> {
   inline bool BinarySeek(const Slice& target, uint32_t* index,
                          bool* is_index_key_result);
 
+  // Like BinarySeek(), but the caller has already established that the
+  // restart key at `left` is <= target (-1 meaning none) and that restart
+  // keys after `right` are > target.
+  template <typename DecodeKeyFunc>
+  inline bool BinarySeekInRange(const Slice& target, int64_t left,
+                                int64_t right, uint32_t* index,
+                                bool* is_index_key_result);
+
   // Find the first key in restart interval `index` that is >= `target`.
   // If there is no such key, iterator is positioned at the first key in
   // restart interval `index + 1`.
@@ -700,7 +772,10 @@ class DataBlockIter final : public BlockIter<Slice> {
                   bool user_defined_timestamps_persisted,
                   DataBlockHashIndex* data_block_hash_index,
                   uint8_t protection_bytes_per_key, const char* kv_checksum,
-                  uint32_t block_restart_interval) {
+                  uint32_t block_restart_interval,
+                  const char* restart_fingerprints = nullptr,
+                  const KeyPrefixDict* key_prefix_dict = nullptr,
+                  const Slice& column_section = Slice()) {
     InitializeBase(raw_ucmp, data, restarts, num_restarts, global_seqno,
                    block_contents_pinned, user_defined_timestamps_persisted,
                    protection_bytes_per_key, kv_checksum,
@@ -709,17 +784,39 @@ class DataBlockIter final : public BlockIter<Slice> {
     read_amp_bitmap_ = read_amp_bitmap;
     last_bitmap_offset_ = current_ + 1;
     data_block_hash_index_ = data_block_hash_index;
+    restart_fingerprints_ = restart_fingerprints;
+    key_prefix_dict_ = key_prefix_dict;
+    column_section_ = column_section;
+    column_projection_ = nullptr;
+    columnar_reader_.reset();
+    entity_offset_ = kNoEntity;
+    column_status_ = Status::OK();
+    pinned_entities_ = nullptr;
+    if (!column_section_.empty() && block_contents_pinned) {
+      pinned_entities_ = new std::deque<std::string>();
+      RegisterCleanup(&DeletePinnedEntities, pinned_entities_, nullptr);
+    }
   }
 
   Slice value() const override {
-    assert(Valid());
-    if (read_amp_bitmap_ && current_ < restarts_ &&
-        current_ != last_bitmap_offset_) {
-      read_amp_bitmap_->Mark(current_ /* current entry offset */,
-                             NextEntryOffset() - 1);
-      last_bitmap_offset_ = current_;
+    if (IsEntityInColumns()) {
+      RawValue();
+      return EntityFromColumns();
     }
-    return value_;
+    return RawValue();
+  }
+
+  Status status() const override {
+    return column_status_.ok() ? status_ : column_status_;
+  }
+
+  // Makes value() return only the columns named in `projection` for
+  // entities stored in the column section, reading only their mini-pages.
+  // Entities stored as a single value are returned as is. `projection`
+  // must outlive the iterator, or the next call.
+  void SetColumnProjection(const std::vector<Slice>* projection) {
+    column_projection_ = projection;
+    entity_offset_ = kNoEntity;
   }
 
   // Returns if `target` may exist.
@@ -785,8 +882,57 @@ class DataBlockIter final : public BlockIter<Slice> {
   int32_t prev_entries_idx_ = -1;
 
   DataBlockHashIndex* data_block_hash_index_;
+  // Restart fingerprints of the block, or nullptr if it has none.
+  const char* restart_fingerprints_ = nullptr;
+
+  static constexpr uint32_t kNoEntity = std::numeric_limits<uint32_t>::max();
+  // The column section of the block, if it has one. The values of its
+  // kTypeWideColumnEntity entries are then rows in this section.
+  Slice column_section_;
+  const std::vector<Slice>* column_projection_ = nullptr;
+  // Created on first use.
+  mutable std::unique_ptr<ColumnarBlockReader> columnar_reader_;
+  // The entity of the entry at entity_offset_, rebuilt from the column
+  // section. It points into pinned_entities_ if the block contents are
+  // pinned, and into entity_buf_ otherwise.
+  mutable Slice entity_;
+  mutable uint32_t entity_offset_ = kNoEntity;
+  mutable std::string entity_buf_;
+  // Owned by a cleanup of the iterator, so that rebuilt entities stay valid
+  // as long as the block contents.
+  std::deque<std::string>* pinned_entities_ = nullptr;
+  // Set if an entity could not be rebuilt from the column section.
+  mutable Status column_status_;
+
+  // The value as stored in the block, i.e. the row of an entity stored in
+  // the column section.
+  Slice RawValue() const {
+    assert(Valid());
+    if (read_amp_bitmap_ && current_ < restarts_ &&
+        current_ != last_bitmap_offset_) {
+      read_amp_bitmap_->Mark(current_ /* current entry offset */,
+                             NextEntryOffset() - 1);
+      last_bitmap_offset_ = current_;
+    }
+    return value_;
+  }
+
+  bool IsEntityInColumns() const {
+    return !column_section_.empty() &&
+           ExtractValueType(key()) == kTypeWideColumnEntity;
+  }
+
+  Slice EntityFromColumns() const;
+
+  static void DeletePinnedEntities(void* arg1, void* arg2);
 
   bool SeekForGetImpl(const Slice& target);
+
+  // Same contract as BinarySeek(), but when the block has restart
+  // fingerprints, only compares keys of restart points whose fingerprint
+  // equals the target's.
+  bool SeekRestartPoint(const Slice& target, uint32_t* index,
+                        bool* skip_linear_scan);
 };
 
 // Iterator over MetaBlocks.  MetaBlocks are similar to Data Blocks and
@@ -831,7 +977,8 @@ class MetaBlockIter final : public BlockIter<Slice> {
 
 class IndexBlockIter final : public BlockIter<IndexValue> {
  public:
-  IndexBlockIter() : BlockIter(), prefix_index_(nullptr) {}
+  IndexBlockIter()
+      : BlockIter(), prefix_index_(nullptr), learned_index_(nullptr) {}
 
   // key_includes_seq, default true, means that the keys are in internal key
   // format.
@@ -844,13 +991,15 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
                   bool value_is_full, bool block_contents_pinned,
                   bool user_defined_timestamps_persisted,
                   uint8_t protection_bytes_per_key, const char* kv_checksum,
-                  uint32_t block_restart_interval) {
+                  uint32_t block_restart_interval,
+                  const LearnedIndexModel* learned_index = nullptr) {
     InitializeBase(raw_ucmp, data, restarts, num_restarts,
                    kDisableGlobalSequenceNumber, block_contents_pinned,
                    user_defined_timestamps_persisted, protection_bytes_per_key,
                    kv_checksum, block_restart_interval);
     raw_key_.SetIsUserKey(!key_includes_seq);
     prefix_index_ = prefix_index;
+    learned_index_ = learned_index;
     value_delta_encoded_ = !value_is_full;
     have_first_key_ = have_first_key;
     if (have_first_key_ && global_seqno != kDisableGlobalSequenceNumber) {
@@ -920,6 +1069,7 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
   bool value_delta_encoded_;
   bool have_first_key_;  // value includes first_internal_key
   BlockPrefixIndex* prefix_index_;
+  const LearnedIndexModel* learned_index_;
   // Whether the value is delta encoded. In that case the value is assumed to be
   // BlockHandle. The first value in each restart interval is the full encoded
   // BlockHandle; the restart of encoded size part of the BlockHandle. The
@@ -951,6 +1101,11 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
   // as `target`. If not set, the result position should be the same as total
   // order Seek.
   bool PrefixSeek(const Slice& target, uint32_t* index, bool* prefix_may_exist);
+  // Same contract as BinarySeek(), but only searches the window of restart
+  // points predicted by learned_index_ once the window is confirmed by
+  // comparing against the restart keys at its edges.
+  bool LearnedSeek(const Slice& target, uint32_t* index,
+                   bool* skip_linear_scan);
   // Set *prefix_may_exist to false if no key can possibly share the same
   // prefix as `target`. If not set, the result position should be the same
   // as total order seek.
@@ -9,8 +9,10 @@
 
 #include "table/block_based/block_based_table_builder.h"
 
+#include <array>
 #include <atomic>
 #include <cassert>
+#include <cmath>
 #include <cstdio>
 #include <list>
 #include <map>
@@ -41,9 +43,11 @@
 #include "table/block_based/block_based_table_factory.h"
 #include "table/block_based/block_based_table_reader.h"
 #include "table/block_based/block_builder.h"
+#include "table/block_based/columnar_block.h"
 #include "table/block_based/filter_block.h"
 #include "table/block_based/filter_policy_internal.h"
 #include "table/block_based/full_filter_block.h"
+#include "table/block_based/key_prefix_dict.h"
 #include "table/block_based/partitioned_filter_block.h"
 #include "table/format.h"
 #include "table/meta_blocks.h"
@@ -113,6 +117,47 @@ bool GoodCompressionRatio(size_t compressed_size, size_t uncomp_size,
          10;
 }
 
+// The order-0 entropy of (an evenly spaced sample of) `data`, in bits per
+// byte. A few thousand samples are plenty to tell incompressible data from
+// a skewed byte distribution.
+double SampledByteEntropy(const Slice& data) {
+  constexpr size_t kMaxSamples = 4096;
+  if (data.empty()) {
+    return 0;
+  }
+  const size_t stride = (data.size() + kMaxSamples - 1) / kMaxSamples;
+  std::array<uint32_t, 256> counts{};
+  uint32_t num_samples = 0;
+  for (size_t i = 0; i < data.size(); i += stride) {
+    ++counts[static_cast<uint8_t>(data[i])];
+    ++num_samples;
+  }
+  double entropy = 0;
+  for (uint32_t count : counts) {
+    if (count > 0) {
+      double p = static_cast<double>(count) / num_samples;
+      entropy -= p * std::log2(p);
+    }
+  }
+  return entropy;
+}
+
+// Chooses the compression type of a data block for
+// BlockBasedTableOptions::adaptive_data_block_compression
+CompressionType ChooseDataBlockCompressionType(
+    const Slice& data, CompressionType slow_type, CompressionType fast_type,
+    int max_compressed_bytes_per_kb) {
+  // Entropy coding alone, which the slow algorithms do on top of replacing
+  // repeats, would shrink the block to about entropy / 8 of its size.
+  if (SampledByteEntropy(data) * 128 <= max_compressed_bytes_per_kb) {
+    return slow_type;
+  }
+  // Otherwise only repeated byte sequences can make the block compress. The
+  // fast algorithm finds those too, and gives up quickly if there are none
+  // (e.g. already-compressed values).
+  return fast_type;
+}
+
 }  // namespace
 
 // format_version is the block format as defined in include/rocksdb/table.h
@@ -213,10 +258,11 @@ class BlockBasedTableBuilder::BlockBasedTablePropertiesCollector
  public:
   explicit BlockBasedTablePropertiesCollector(
       BlockBasedTableOptions::IndexType index_type, bool whole_key_filtering,
-      bool prefix_filtering)
+      bool prefix_filtering, bool columnar_entity_blocks)
       : index_type_(index_type),
         whole_key_filtering_(whole_key_filtering),
-        prefix_filtering_(prefix_filtering) {}
+        prefix_filtering_(prefix_filtering),
+        columnar_entity_blocks_(columnar_entity_blocks) {}
 
   Status InternalAdd(const Slice& /*key*/, const Slice& /*value*/,
                      uint64_t /*file_size*/) override {
@@ -240,6 +286,8 @@ class BlockBasedTableBuilder::BlockBasedTablePropertiesCollector
                         whole_key_filtering_ ? kPropTrue : kPropFalse});
     properties->insert({BlockBasedTablePropertyNames::kPrefixFiltering,
                         prefix_filtering_ ? kPropTrue : kPropFalse});
+    properties->insert({BlockBasedTablePropertyNames::kColumnarEntityBlocks,
+                        columnar_entity_blocks_ ? kPropTrue : kPropFalse});
     return Status::OK();
   }
 
@@ -257,6 +305,7 @@ class BlockBasedTableBuilder::BlockBasedTablePropertiesCollector
   BlockBasedTableOptions::IndexType index_type_;
   bool whole_key_filtering_;
   bool prefix_filtering_;
+  bool columnar_entity_blocks_;
 };
 
 struct BlockBasedTableBuilder::Rep {
@@ -284,11 +333,19 @@ struct BlockBasedTableBuilder::Rep {
   WritableFileWriter* file;
   std::atomic<uint64_t> offset;
   size_t alignment;
+  // Set if data block keys are encoded against a key prefix dictionary.
+  // Declared before data_block, which refers to it.
+  std::unique_ptr<KeyPrefixDictBuilder> key_prefix_dict_builder;
+  // Set if data blocks store their entities in a column section. Declared
+  // before data_block, which refers to it.
+  std::unique_ptr<ColumnarBlockBuilder> columnar_block;
   BlockBuilder data_block;
   // Buffers uncompressed data blocks to replay later. Needed when
   // compression dictionary is enabled so we can finalize the dictionary before
   // compressing any data blocks.
   std::vector<std::string> data_block_buffers;
+  // Whether each of data_block_buffers starts with a column section
+  std::vector<bool> data_block_column_sections;
   BlockBuilder range_del_block;
 
   InternalKeySliceTransform internal_prefix_transform;
@@ -304,6 +361,12 @@ struct BlockBasedTableBuilder::Rep {
   std::atomic<uint64_t> sampled_input_data_bytes;
   std::atomic<uint64_t> sampled_output_slow_data_bytes;
   std::atomic<uint64_t> sampled_output_fast_data_bytes;
+  // For BlockBasedTableOptions::adaptive_data_block_compression
+  const bool adaptive_compression;
+  const CompressionType fast_compression_type;
+  std::atomic<uint64_t> adaptive_slow_blocks;
+  std::atomic<uint64_t> adaptive_fast_blocks;
+  std::atomic<uint64_t> adaptive_uncompressed_blocks;
   CompressionOptions compression_opts;
   std::unique_ptr<CompressionDict> compression_dict;
   std::vector<std::unique_ptr<CompressionContext>> compression_ctxs;
@@ -452,6 +515,22 @@ struct BlockBasedTableBuilder::Rep {
                       ? std::min(static_cast<size_t>(table_options.block_size),
                                  kDefaultPageSize)
                       : 0),
+        key_prefix_dict_builder(
+            table_options.data_block_key_prefix_dict_max_bytes > 0 &&
+                    FormatVersionUsesKeyPrefixDict(
+                        table_options.format_version) &&
+                    prefix_extractor != nullptr && ts_sz == 0
+                ? new KeyPrefixDictBuilder(
+                      prefix_extractor.get(),
+                      table_options.data_block_key_prefix_dict_max_bytes)
+                : nullptr),
+        columnar_block(
+            table_options.columnar_entity_blocks &&
+                    FormatVersionUsesColumnarEntityBlocks(
+                        table_options.format_version)
+                ? new ColumnarBlockBuilder(tbo.compression_type,
+                                           tbo.compression_opts)
+                : nullptr),
         data_block(table_options.block_restart_interval,
                    table_options.use_delta_encoding,
                    false /* use_value_delta_encoding */,
@@ -460,7 +539,13 @@ struct BlockBasedTableBuilder::Rep {
                        ? BlockBasedTableOptions::kDataBlockBinarySearch
                        : table_options.data_block_index_type,
                    table_options.data_block_hash_table_util_ratio, ts_sz,
-                   persist_user_defined_timestamps),
+                   persist_user_defined_timestamps, false /* is_user_key */,
+                   table_options.data_block_restart_fingerprints &&
+                       FormatVersionUsesRestartFingerprints(
+                           table_options.format_version) &&
+                       tbo.internal_comparator.user_comparator() ==
+                           BytewiseComparator(),
+                   key_prefix_dict_builder.get(), columnar_block.get()),
         range_del_block(
             1 /* block_restart_interval */, true /* use_delta_encoding */,
             false /* use_value_delta_encoding */,
@@ -475,6 +560,14 @@ struct BlockBasedTableBuilder::Rep {
         sampled_input_data_bytes(0),
         sampled_output_slow_data_bytes(0),
         sampled_output_fast_data_bytes(0),
+        adaptive_compression(table_options.adaptive_data_block_compression &&
+                             tbo.compression_type != kNoCompression),
+        fast_compression_type(LZ4_Supported()      ? kLZ4Compression
+                              : Snappy_Supported() ? kSnappyCompression
+                                                   : kNoCompression),
+        adaptive_slow_blocks(0),
+        adaptive_fast_blocks(0),
+        adaptive_uncompressed_blocks(0),
         compression_opts(tbo.compression_opts),
         compression_dict(),
         compression_ctxs(tbo.compression_opts.parallel_threads),
@@ -591,7 +684,7 @@ struct BlockBasedTableBuilder::Rep {
     table_properties_collectors.emplace_back(
         new BlockBasedTablePropertiesCollector(
             table_options.index_type, table_options.whole_key_filtering,
-            prefix_extractor != nullptr));
+            prefix_extractor != nullptr, columnar_block != nullptr));
     if (ts_sz > 0 && persist_user_defined_timestamps) {
       table_properties_collectors.emplace_back(
           new TimestampTablePropertiesCollector(
@@ -694,6 +787,7 @@ struct BlockBasedTableBuilder::ParallelCompressionRep {
     std::unique_ptr<std::string> data;
     std::unique_ptr<std::string> compressed_data;
     CompressionType compression_type;
+    bool has_column_section = false;
     std::unique_ptr<std::string> first_key_in_next_block;
     std::unique_ptr<Keys> keys;
     std::unique_ptr<BlockRepSlot> slot;
@@ -883,6 +977,7 @@ struct BlockBasedTableBuilder::ParallelCompressionRep {
     BlockRep* block_rep =
         PrepareBlockInternal(compression_type, first_key_in_next_block);
     assert(block_rep != nullptr);
+    block_rep->has_column_section = data_block->has_column_section();
     data_block->SwapAndReset(*(block_rep->data));
     block_rep->contents = *(block_rep->data);
     std::swap(block_rep->keys, curr_block_keys);
@@ -893,11 +988,12 @@ struct BlockBasedTableBuilder::ParallelCompressionRep {
   // Used in EnterUnbuffered
   BlockRep* PrepareBlock(CompressionType compression_type,
                          const Slice* first_key_in_next_block,
-                         std::string* data_block,
+                         std::string* data_block, bool has_column_section,
                          std::vector<std::string>* keys) {
     BlockRep* block_rep =
         PrepareBlockInternal(compression_type, first_key_in_next_block);
     assert(block_rep != nullptr);
+    block_rep->has_column_section = has_column_section;
     std::swap(*(block_rep->data), *data_block);
     block_rep->contents = *(block_rep->data);
     block_rep->keys->SwapAssign(*keys);
@@ -1066,7 +1162,15 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
       }
     }
 
-    r->data_block.AddWithLastKey(key, value, r->last_key);
+    if (r->columnar_block != nullptr && value_type == kTypeWideColumnEntity) {
+      r->SetStatus(
+          r->data_block.AddEntityWithLastKey(key, value, r->last_key));
+      if (!ok()) {
+        return;
+      }
+    } else {
+      r->data_block.AddWithLastKey(key, value, r->last_key);
+    }
     r->last_key.assign(key.data(), key.size());
     if (r->state == Rep::State::kBuffered) {
       // Buffered keys will be replayed from data_block_buffers during
@@ -1148,21 +1252,24 @@ void BlockBasedTableBuilder::WriteBlock(BlockBuilder* block,
                                         BlockHandle* handle,
                                         BlockType block_type) {
   block->Finish();
+  const bool has_column_section = block->has_column_section();
   std::string uncompressed_block_data;
   uncompressed_block_data.reserve(rep_->table_options.block_size);
   block->SwapAndReset(uncompressed_block_data);
   if (rep_->state == Rep::State::kBuffered) {
     assert(block_type == BlockType::kData);
     rep_->data_block_buffers.emplace_back(std::move(uncompressed_block_data));
+    rep_->data_block_column_sections.push_back(has_column_section);
     rep_->data_begin_offset += rep_->data_block_buffers.back().size();
     return;
   }
-  WriteBlock(uncompressed_block_data, handle, block_type);
+  WriteBlock(uncompressed_block_data, handle, block_type, has_column_section);
 }
 
 void BlockBasedTableBuilder::WriteBlock(const Slice& uncompressed_block_data,
                                         BlockHandle* handle,
-                                        BlockType block_type) {
+                                        BlockType block_type,
+                                        bool has_column_section) {
   Rep* r = rep_;
   assert(r->state == Rep::State::kUnbuffered);
   Slice block_contents;
@@ -1170,7 +1277,7 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& uncompressed_block_data,
   Status compress_status;
   bool is_data_block = block_type == BlockType::kData;
   CompressAndVerifyBlock(uncompressed_block_data, is_data_block,
-                         *(r->compression_ctxs[0]), r->verify_ctxs[0].get(),
+                         has_column_section, *(r->compression_ctxs[0]), r->verify_ctxs[0].get(),
                          &(r->compressed_output), &(block_contents), &type,
                          &compress_status);
   r->SetStatus(compress_status);
@@ -1197,7 +1304,8 @@ void BlockBasedTableBuilder::BGWorkCompression(
   while (rep_->pc_rep->compress_queue.pop(block_rep)) {
     assert(block_rep != nullptr);
     CompressAndVerifyBlock(block_rep->contents, true, /* is_data_block*/
-                           compression_ctx, verify_ctx,
+                           block_rep->has_column_section, compression_ctx,
+                           verify_ctx,
                            block_rep->compressed_data.get(),
                            &block_rep->compressed_contents,
                            &(block_rep->compression_type), &block_rep->status);
@@ -1207,7 +1315,8 @@ void BlockBasedTableBuilder::BGWorkCompression(
 
 void BlockBasedTableBuilder::CompressAndVerifyBlock(
     const Slice& uncompressed_block_data, bool is_data_block,
-    const CompressionContext& compression_ctx, UncompressionContext* verify_ctx,
+    bool has_column_section, const CompressionContext& compression_ctx,
+    UncompressionContext* verify_ctx,
     std::string* compressed_output, Slice* block_contents,
     CompressionType* type, Status* out_status) {
   Rep* r = rep_;
@@ -1216,7 +1325,11 @@ void BlockBasedTableBuilder::CompressAndVerifyBlock(
     assert(is_status_ok);
   }
 
-  if (is_status_ok && uncompressed_block_data.size() < kCompressionSizeLimit) {
+  // The mini-pages of a column section are compressed on their own, so that
+  // reads only decompress the columns they project; the block is not.
+  assert(is_data_block || !has_column_section);
+  if (is_status_ok && !has_column_section &&
+      uncompressed_block_data.size() < kCompressionSizeLimit) {
     StopWatchNano timer(
         r->ioptions.clock,
         ShouldReportDetailedTime(r->ioptions.env, r->ioptions.stats));
@@ -1232,9 +1345,23 @@ void BlockBasedTableBuilder::CompressAndVerifyBlock(
       compression_dict = r->compression_dict.get();
     }
     assert(compression_dict != nullptr);
-    CompressionInfo compression_info(r->compression_opts, compression_ctx,
-                                     *compression_dict, r->compression_type,
-                                     r->sample_for_compression);
+    CompressionType compression_type = r->compression_type;
+    if (is_data_block && r->adaptive_compression) {
+      compression_type = ChooseDataBlockCompressionType(
+          uncompressed_block_data, r->compression_type,
+          r->fast_compression_type,
+          r->compression_opts.max_compressed_bytes_per_kb);
+    }
+    // compression_ctx is for r->compression_type. Contexts of the other
+    // types adaptive compression can choose are cheap to create.
+    std::unique_ptr<CompressionContext> adaptive_ctx;
+    if (compression_type != r->compression_type) {
+      adaptive_ctx.reset(
+          new CompressionContext(compression_type, r->compression_opts));
+    }
+    CompressionInfo compression_info(
+        r->compression_opts, adaptive_ctx ? *adaptive_ctx : compression_ctx,
+        *compression_dict, compression_type, r->sample_for_compression);
 
     std::string sampled_output_fast;
     std::string sampled_output_slow;
@@ -1270,9 +1397,14 @@ void BlockBasedTableBuilder::CompressAndVerifyBlock(
         verify_dict = r->verify_dict.get();
       }
       assert(verify_dict != nullptr);
+      std::unique_ptr<UncompressionContext> adaptive_verify_ctx;
+      if (*type != r->compression_type) {
+        adaptive_verify_ctx.reset(new UncompressionContext(*type));
+      }
       BlockContents contents;
-      UncompressionInfo uncompression_info(*verify_ctx, *verify_dict,
-                                           r->compression_type);
+      UncompressionInfo uncompression_info(
+          adaptive_verify_ctx ? *adaptive_verify_ctx : *verify_ctx,
+          *verify_dict, *type);
       Status uncompress_status = UncompressBlockData(
           uncompression_info, block_contents->data(), block_contents->size(),
           &contents, r->table_options.format_version, r->ioptions);
@@ -1299,7 +1431,8 @@ void BlockBasedTableBuilder::CompressAndVerifyBlock(
                             timer.ElapsedNanos());
     }
   } else {
-    // Status is not OK, or block is too big to be compressed.
+    // Status is not OK, block is too big to be compressed, or its columns
+    // are compressed separately.
     if (is_data_block) {
       r->uncompressible_input_data_bytes.fetch_add(
           uncompressed_block_data.size(), std::memory_order_relaxed);
@@ -1309,6 +1442,13 @@ void BlockBasedTableBuilder::CompressAndVerifyBlock(
   if (is_data_block) {
     r->uncompressible_input_data_bytes.fetch_add(kBlockTrailerSize,
                                                  std::memory_order_relaxed);
+    if (r->adaptive_compression) {
+      std::atomic<uint64_t>& blocks =
+          *type == kNoCompression         ? r->adaptive_uncompressed_blocks
+          : *type == r->compression_type ? r->adaptive_slow_blocks
+                                         : r->adaptive_fast_blocks;
+      blocks.fetch_add(1, std::memory_order_relaxed);
+    }
   }
 
   // Abort compression if the block is too big, or did not pass
@@ -1409,6 +1549,12 @@ void BlockBasedTableBuilder::WriteMaybeCompressedBlock(
         assert(false);
         warm_cache = false;
     }
+    // Parsing a data block for its per key-value checksums needs the key
+    // prefix dictionary, which is still being built.
+    if (block_type == BlockType::kData && r->key_prefix_dict_builder &&
+        r->create_context.protection_bytes_per_key > 0) {
+      warm_cache = false;
+    }
     if (warm_cache) {
       Status s = InsertBlockInCacheHelper(*uncompressed_block_data, handle,
                                           block_type);
@@ -1615,7 +1761,7 @@ void BlockBasedTableBuilder::WriteIndexBlock(
   if (index_builder_status.IsIncomplete()) {
     // We we have more than one index partition then meta_blocks are not
     // supported for the index. Currently meta_blocks are used only by
-    // HashIndexBuilder which is not multi-partition.
+    // HashIndexBuilder and LearnedIndexBuilder which are not multi-partition.
     assert(index_blocks.meta_blocks.empty());
   } else if (ok() && !index_builder_status.ok()) {
     rep_->SetStatus(index_builder_status);
@@ -1742,6 +1888,10 @@ void BlockBasedTableBuilder::WritePropertiesBlock(
           rep_->compressible_input_data_bytes +
           rep_->uncompressible_input_data_bytes;
     }
+    rep_->props.adaptive_compression_slow_blocks = rep_->adaptive_slow_blocks;
+    rep_->props.adaptive_compression_fast_blocks = rep_->adaptive_fast_blocks;
+    rep_->props.adaptive_compression_uncompressed_blocks =
+        rep_->adaptive_uncompressed_blocks;
     rep_->props.user_defined_timestamps_persisted =
         rep_->persist_user_defined_timestamps;
 
@@ -1805,6 +1955,23 @@ void BlockBasedTableBuilder::WriteCompressionDictBlock(
   }
 }
 
+void BlockBasedTableBuilder::WriteKeyPrefixDictBlock(
+    MetaIndexBuilder* meta_index_builder) {
+  // Written even if empty: its presence tells readers that data block keys
+  // start with a dictionary id. Like the metaindex block, it is held by the
+  // table reader rather than the block cache.
+  if (ok() && rep_->key_prefix_dict_builder != nullptr) {
+    BlockHandle key_prefix_dict_block_handle;
+    WriteMaybeCompressedBlock(rep_->key_prefix_dict_builder->contents(),
+                              kNoCompression, &key_prefix_dict_block_handle,
+                              BlockType::kMetaIndex);
+    if (ok()) {
+      meta_index_builder->Add(kKeyPrefixDictBlock,
+                              key_prefix_dict_block_handle);
+    }
+  }
+}
+
 void BlockBasedTableBuilder::WriteRangeDelBlock(
     MetaIndexBuilder* meta_index_builder) {
   if (ok() && !rep_->range_del_block.empty()) {
@@ -1918,7 +2085,19 @@ void BlockBasedTableBuilder::EnterUnbuffered() {
       dict, r->compression_type == kZSTD ||
                 r->compression_type == kZSTDNotFinalCompression));
 
-  auto get_iterator_for_block = [&r](size_t i) {
+  // The buffered blocks only refer to prefixes that are already in the key
+  // prefix dictionary.
+  std::unique_ptr<KeyPrefixDict> key_prefix_dict;
+  if (r->key_prefix_dict_builder != nullptr) {
+    Status s = KeyPrefixDict::Create(r->key_prefix_dict_builder->contents(),
+                                     &key_prefix_dict);
+    if (!s.ok()) {
+      r->SetStatus(s);
+      return;
+    }
+  }
+
+  auto get_iterator_for_block = [&r, &key_prefix_dict](size_t i) {
     auto& data_block = r->data_block_buffers[i];
     assert(!data_block.empty());
 
@@ -1926,7 +2105,8 @@ void BlockBasedTableBuilder::EnterUnbuffered() {
     DataBlockIter* iter = reader.NewDataIterator(
         r->internal_comparator.user_comparator(), kDisableGlobalSequenceNumber,
         nullptr /* iter */, nullptr /* stats */,
-        false /*  block_contents_pinned */, r->persist_user_defined_timestamps);
+        false /*  block_contents_pinned */, r->persist_user_defined_timestamps,
+        key_prefix_dict.get());
 
     iter->SeekToFirst();
     assert(iter->Valid());
@@ -1962,7 +2142,8 @@ void BlockBasedTableBuilder::EnterUnbuffered() {
       }
 
       ParallelCompressionRep::BlockRep* block_rep = r->pc_rep->PrepareBlock(
-          r->compression_type, first_key_in_next_block_ptr, &data_block, &keys);
+          r->compression_type, first_key_in_next_block_ptr, &data_block,
+          r->data_block_column_sections[i], &keys);
 
       assert(block_rep != nullptr);
       r->pc_rep->file_size_estimator.EmitBlock(block_rep->data->size(),
@@ -1977,7 +2158,8 @@ void BlockBasedTableBuilder::EnterUnbuffered() {
         }
         r->index_builder->OnKeyAdded(key);
       }
-      WriteBlock(Slice(data_block), &r->pending_handle, BlockType::kData);
+      WriteBlock(Slice(data_block), &r->pending_handle, BlockType::kData,
+                 r->data_block_column_sections[i]);
       if (ok() && i + 1 < r->data_block_buffers.size()) {
         assert(next_block_iter != nullptr);
         Slice first_key_in_next_block = next_block_iter->key();
@@ -1993,6 +2175,7 @@ void BlockBasedTableBuilder::EnterUnbuffered() {
     std::swap(iter, next_block_iter);
   }
   r->data_block_buffers.clear();
+  r->data_block_column_sections.clear();
   r->data_begin_offset = 0;
   // Release all reserved cache for data block buffers
   if (r->compression_dict_buffer_cache_res_mgr != nullptr) {
@@ -2033,15 +2216,17 @@ Status BlockBasedTableBuilder::Finish() {
   //    1. [meta block: filter]
   //    2. [meta block: index]
   //    3. [meta block: compression dictionary]
-  //    4. [meta block: range deletion tombstone]
-  //    5. [meta block: properties]
-  //    6. [metaindex block]
-  //    7. Footer
+  //    4. [meta block: key prefix dictionary]
+  //    5. [meta block: range deletion tombstone]
+  //    6. [meta block: properties]
+  //    7. [metaindex block]
+  //    8. Footer
   BlockHandle metaindex_block_handle, index_block_handle;
   MetaIndexBuilder meta_index_builder;
   WriteFilterBlock(&meta_index_builder);
   WriteIndexBlock(&meta_index_builder, &index_block_handle);
   WriteCompressionDictBlock(&meta_index_builder);
+  WriteKeyPrefixDictBlock(&meta_index_builder);
   WriteRangeDelBlock(&meta_index_builder);
   WritePropertiesBlock(&meta_index_builder);
   if (ok()) {
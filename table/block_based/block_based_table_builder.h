@@ -123,9 +123,10 @@ class BlockBasedTableBuilder : public TableBuilder {
   void WriteBlock(BlockBuilder* block, BlockHandle* handle,
                   BlockType blocktype);
 
-  // Compress and write block content to the file.
+  // Compress and write block content to the file. has_column_section: the
+  // data block starts with a column section (see columnar_block.h).
   void WriteBlock(const Slice& block_contents, BlockHandle* handle,
-                  BlockType block_type);
+                  BlockType block_type, bool has_column_section = false);
   // Directly write data to the file.
   void WriteMaybeCompressedBlock(
       const Slice& block_contents, CompressionType, BlockHandle* handle,
@@ -150,6 +151,7 @@ class BlockBasedTableBuilder : public TableBuilder {
                        BlockHandle* index_block_handle);
   void WritePropertiesBlock(MetaIndexBuilder* meta_index_builder);
   void WriteCompressionDictBlock(MetaIndexBuilder* meta_index_builder);
+  void WriteKeyPrefixDictBlock(MetaIndexBuilder* meta_index_builder);
   void WriteRangeDelBlock(MetaIndexBuilder* meta_index_builder);
   void WriteFooter(BlockHandle& metaindex_block_handle,
                    BlockHandle& index_block_handle);
@@ -180,7 +182,7 @@ class BlockBasedTableBuilder : public TableBuilder {
   // Given uncompressed block content, try to compress it and return result and
   // compression type
   void CompressAndVerifyBlock(const Slice& uncompressed_block_data,
-                              bool is_data_block,
+                              bool is_data_block, bool has_column_section,
                               const CompressionContext& compression_ctx,
                               UncompressionContext* verify_ctx,
                               std::string* compressed_output,
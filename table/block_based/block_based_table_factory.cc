@@ -181,7 +181,9 @@ static std::unordered_map<std::string, BlockBasedTableOptions::IndexType>
         {"kTwoLevelIndexSearch",
          BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch},
         {"kBinarySearchWithFirstKey",
-         BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey}};
+         BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey},
+        {"kLearnedIndexSearch",
+         BlockBasedTableOptions::IndexType::kLearnedIndexSearch}};
 
 static std::unordered_map<std::string,
                           BlockBasedTableOptions::DataBlockIndexType>
@@ -269,6 +271,20 @@ static std::unordered_map<std::string, OptionTypeInfo>
                    data_block_hash_table_util_ratio),
           OptionType::kDouble, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"data_block_restart_fingerprints",
+         {offsetof(struct BlockBasedTableOptions,
+                   data_block_restart_fingerprints),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"data_block_key_prefix_dict_max_bytes",
+         {offsetof(struct BlockBasedTableOptions,
+                   data_block_key_prefix_dict_max_bytes),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"columnar_entity_blocks",
+         {offsetof(struct BlockBasedTableOptions, columnar_entity_blocks),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"checksum",
          {offsetof(struct BlockBasedTableOptions, checksum),
           OptionType::kChecksumType, OptionVerificationType::kNormal,
@@ -343,6 +359,11 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct BlockBasedTableOptions, verify_compression),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"adaptive_data_block_compression",
+         {offsetof(struct BlockBasedTableOptions,
+                   adaptive_data_block_compression),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"read_amp_bytes_per_bit",
          {offsetof(struct BlockBasedTableOptions, read_amp_bytes_per_bit),
           OptionType::kUInt32T, OptionVerificationType::kNormal,
@@ -614,6 +635,21 @@ Status BlockBasedTableFactory::ValidateOptions(
         "Unsupported BlockBasedTable format_version. Please check "
         "include/rocksdb/table.h for more info");
   }
+  if (table_options_.data_block_key_prefix_dict_max_bytes > 0 &&
+      !FormatVersionUsesKeyPrefixDict(table_options_.format_version)) {
+    return Status::InvalidArgument(
+        "data_block_key_prefix_dict_max_bytes requires format_version >= 7");
+  }
+  if (table_options_.data_block_restart_fingerprints &&
+      !FormatVersionUsesRestartFingerprints(table_options_.format_version)) {
+    return Status::InvalidArgument(
+        "data_block_restart_fingerprints requires format_version >= 7");
+  }
+  if (table_options_.columnar_entity_blocks &&
+      !FormatVersionUsesColumnarEntityBlocks(table_options_.format_version)) {
+    return Status::InvalidArgument(
+        "columnar_entity_blocks requires format_version >= 7");
+  }
   if (table_options_.block_align && (cf_opts.compression != kNoCompression)) {
     return Status::InvalidArgument(
         "Enable block_align, but compression "
@@ -769,6 +805,16 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "  data_block_hash_table_util_ratio: %lf\n",
            table_options_.data_block_hash_table_util_ratio);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  data_block_restart_fingerprints: %d\n",
+           table_options_.data_block_restart_fingerprints);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize,
+           "  data_block_key_prefix_dict_max_bytes: %" ROCKSDB_PRIszt "\n",
+           table_options_.data_block_key_prefix_dict_max_bytes);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  columnar_entity_blocks: %d\n",
+           table_options_.columnar_entity_blocks);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  checksum: %d\n", table_options_.checksum);
   ret.append(buffer);
   snprintf(buffer, kBufferSize, "  no_block_cache: %d\n",
@@ -795,6 +841,9 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
     ret.append(buffer);
     ret.append(table_options_.persistent_cache->GetPrintableOptions());
   }
+  snprintf(buffer, kBufferSize, "  decompression_thread_pool: %p\n",
+           static_cast<void*>(table_options_.decompression_thread_pool.get()));
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  block_size: %" PRIu64 "\n",
            table_options_.block_size);
   ret.append(buffer);
@@ -827,6 +876,9 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "  verify_compression: %d\n",
            table_options_.verify_compression);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  adaptive_data_block_compression: %d\n",
+           table_options_.adaptive_data_block_compression);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  read_amp_bytes_per_bit: %d\n",
            table_options_.read_amp_bytes_per_bit);
   ret.append(buffer);
@@ -971,9 +1023,13 @@ const std::string BlockBasedTablePropertyNames::kWholeKeyFiltering =
     "rocksdb.block.based.table.whole.key.filtering";
 const std::string BlockBasedTablePropertyNames::kPrefixFiltering =
     "rocksdb.block.based.table.prefix.filtering";
+const std::string BlockBasedTablePropertyNames::kColumnarEntityBlocks =
+    "rocksdb.block.based.table.columnar.entity.blocks";
 const std::string kHashIndexPrefixesBlock = "rocksdb.hashindex.prefixes";
 const std::string kHashIndexPrefixesMetadataBlock =
     "rocksdb.hashindex.metadata";
+const std::string kLearnedIndexBlock = "rocksdb.learned.index";
+const std::string kKeyPrefixDictBlock = "rocksdb.key.prefix.dict";
 const std::string kPropTrue = "1";
 const std::string kPropFalse = "0";
 
@@ -395,6 +395,8 @@ void BlockBasedTableIterator::InitDataBlock() {
           /*for_compaction=*/is_for_compaction, /*async_read=*/false, s,
           use_block_cache_for_lookup);
     }
+    block_iter_.SetColumnProjection(
+        table_->GetColumnProjection(read_options_));
     block_iter_points_to_real_block_ = true;
 
     CheckDataBlockWithinUpperBound();
@@ -488,6 +490,7 @@ void BlockBasedTableIterator::AsyncInitDataBlock(bool is_first_pass) {
           /*use_block_cache_for_lookup=*/false);
     }
   }
+  block_iter_.SetColumnProjection(table_->GetColumnProjection(read_options_));
   block_iter_points_to_real_block_ = true;
   CheckDataBlockWithinUpperBound();
 
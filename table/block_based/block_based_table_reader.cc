@@ -56,6 +56,7 @@
 #include "table/block_based/filter_policy_internal.h"
 #include "table/block_based/full_filter_block.h"
 #include "table/block_based/hash_index_reader.h"
+#include "table/block_based/learned_index_reader.h"
 #include "table/block_based/partitioned_filter_block.h"
 #include "table/block_based/partitioned_index_reader.h"
 #include "table/block_fetcher.h"
@@ -134,6 +135,8 @@ namespace ROCKSDB_NAMESPACE {
 extern const uint64_t kBlockBasedTableMagicNumber;
 extern const std::string kHashIndexPrefixesBlock;
 extern const std::string kHashIndexPrefixesMetadataBlock;
+extern const std::string kLearnedIndexBlock;
+extern const std::string kKeyPrefixDictBlock;
 
 BlockBasedTable::~BlockBasedTable() { delete rep_; }
 
@@ -790,6 +793,13 @@ Status BlockBasedTable::Open(
       PersistentCacheOptions(rep->table_options.persistent_cache,
                              rep->base_cache_key, rep->ioptions.stats);
 
+  // Data blocks cannot be parsed without their key prefix dictionary, so it
+  // is loaded before any of them can be read.
+  s = new_table->ReadKeyPrefixDictBlock(ro, prefetch_buffer.get(),
+                                        metaindex_iter.get());
+  if (!s.ok()) {
+    return s;
+  }
   s = new_table->ReadRangeDelBlock(ro, prefetch_buffer.get(),
                                    metaindex_iter.get(), internal_comparator,
                                    &lookup_context);
@@ -994,6 +1004,17 @@ Status BlockBasedTable::ReadPropertiesBlock(
     rep_->index_has_first_key =
         rep_->index_type == BlockBasedTableOptions::kBinarySearchWithFirstKey;
 
+    auto columnar_pos =
+        props.find(BlockBasedTablePropertyNames::kColumnarEntityBlocks);
+    rep_->columnar_entity_blocks =
+        columnar_pos != props.end() && columnar_pos->second == kPropTrue;
+    if (rep_->columnar_entity_blocks &&
+        !FormatVersionUsesColumnarEntityBlocks(rep_->footer.format_version())) {
+      return Status::Corruption(
+          "Columnar entity blocks in a file with format_version " +
+          std::to_string(rep_->footer.format_version()));
+    }
+
     s = GetGlobalSequenceNumber(*(rep_->table_properties), largest_seqno,
                                 &(rep_->global_seqno));
     if (!s.ok()) {
@@ -1003,6 +1024,36 @@ Status BlockBasedTable::ReadPropertiesBlock(
   return s;
 }
 
+Status BlockBasedTable::ReadKeyPrefixDictBlock(
+    const ReadOptions& read_options, FilePrefetchBuffer* prefetch_buffer,
+    InternalIterator* meta_iter) {
+  BlockHandle handle;
+  Status s = FindOptionalMetaBlock(meta_iter, kKeyPrefixDictBlock, &handle);
+  if (!s.ok() || handle.IsNull()) {
+    return s;
+  }
+  if (!FormatVersionUsesKeyPrefixDict(rep_->footer.format_version())) {
+    return Status::Corruption(
+        "Key prefix dictionary in a file with format_version " +
+        std::to_string(rep_->footer.format_version()));
+  }
+  BlockContents contents;
+  BlockFetcher block_fetcher(
+      rep_->file.get(), prefetch_buffer, rep_->footer, read_options, handle,
+      &contents, rep_->ioptions, true /* decompress */,
+      true /*maybe_compressed*/, BlockType::kMetaIndex,
+      UncompressionDict::GetEmptyDict(), rep_->persistent_cache_options,
+      GetMemoryAllocator(rep_->table_options));
+  s = block_fetcher.ReadBlockContents();
+  if (s.ok()) {
+    s = KeyPrefixDict::Create(contents.data, &rep_->key_prefix_dict);
+  }
+  if (s.ok()) {
+    rep_->create_context.key_prefix_dict = rep_->key_prefix_dict.get();
+  }
+  return s;
+}
+
 Status BlockBasedTable::ReadRangeDelBlock(
     const ReadOptions& read_options, FilePrefetchBuffer* prefetch_buffer,
     InternalIterator* meta_iter,
@@ -1281,6 +1332,9 @@ size_t BlockBasedTable::ApproximateMemoryUsage() const {
   if (rep_->uncompression_dict_reader) {
     usage += rep_->uncompression_dict_reader->ApproximateMemoryUsage();
   }
+  if (rep_->key_prefix_dict) {
+    usage += rep_->key_prefix_dict->ApproximateMemoryUsage();
+  }
   if (rep_->table_properties) {
     usage += rep_->table_properties->ApproximateMemoryUsage();
   }
@@ -1430,6 +1484,11 @@ WithBlocklikeCheck<Status, TBlocklike> BlockBasedTable::PutDataBlockToCache(
 
       UpdateCacheInsertionMetrics(TBlocklike::kBlockType, get_context, charge,
                                   s.IsOkOverwritten(), rep_->ioptions.stats);
+    } else if (s.IsIncomplete()) {
+      // Rejected by the cache admission policy, which is as if the block
+      // was inserted and evicted right away: use it without caching it.
+      out_parsed_block->SetOwnedValue(std::move(block_holder));
+      s = Status::OK();
     } else {
       RecordTick(statistics, BLOCK_CACHE_ADD_FAILURES);
     }
@@ -1489,10 +1548,26 @@ template <>
 DataBlockIter* BlockBasedTable::InitBlockIterator<DataBlockIter>(
     const Rep* rep, Block* block, BlockType block_type,
     DataBlockIter* input_iter, bool block_contents_pinned) {
-  return block->NewDataIterator(rep->internal_comparator.user_comparator(),
-                                rep->get_global_seqno(block_type), input_iter,
-                                rep->ioptions.stats, block_contents_pinned,
-                                rep->user_defined_timestamps_persisted);
+  // Range deletion blocks are never built with the key prefix dictionary or
+  // a column section.
+  const bool is_data_block = block_type == BlockType::kData;
+  return block->NewDataIterator(
+      rep->internal_comparator.user_comparator(),
+      rep->get_global_seqno(block_type), input_iter, rep->ioptions.stats,
+      block_contents_pinned, rep->user_defined_timestamps_persisted,
+      is_data_block ? rep->key_prefix_dict.get() : nullptr,
+      is_data_block && rep->columnar_entity_blocks);
+}
+
+const std::vector<Slice>* BlockBasedTable::GetColumnProjection(
+    const ReadOptions& ro) const {
+  // Merge operands may read any column of their base value, so with a merge
+  // operator the projection waits for the merged result.
+  if (!rep_->columnar_entity_blocks ||
+      rep_->ioptions.merge_operator != nullptr) {
+    return nullptr;
+  }
+  return ro.column_projection;
 }
 
 // TODO?
@@ -2321,6 +2396,9 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
         s = biter.status();
         break;
       }
+      if (get_context->NeedColumns()) {
+        biter.SetColumnProjection(GetColumnProjection(read_options));
+      }
 
       bool may_exist = biter.SeekForGet(key);
       // If user-specified timestamp is supported, we cannot end the search
@@ -2604,6 +2682,14 @@ BlockType BlockBasedTable::GetBlockTypeForMetaBlockByName(
     return BlockType::kHashIndexMetadata;
   }
 
+  if (meta_block_name == kLearnedIndexBlock) {
+    return BlockType::kIndex;
+  }
+
+  if (meta_block_name == kKeyPrefixDictBlock) {
+    return BlockType::kMetaIndex;
+  }
+
   if (meta_block_name == kIndexBlockName) {
     return BlockType::kIndex;
   }
@@ -2753,6 +2839,11 @@ Status BlockBasedTable::CreateIndexReader(
                                        index_reader);
       }
     }
+    case BlockBasedTableOptions::kLearnedIndexSearch: {
+      return LearnedIndexReader::Create(this, ro, prefetch_buffer, meta_iter,
+                                        use_cache, prefetch, pin,
+                                        lookup_context, index_reader);
+    }
     default: {
       std::string error_message =
           "Unrecognized index type: " + std::to_string(rep_->index_type);
@@ -311,6 +311,10 @@ class BlockBasedTable : public TableReader {
                                    CachableEntry<Block>& block,
                                    TBlockIter* input_iter, Status s) const;
 
+  // The part of ro.column_projection that data block iterators apply to the
+  // entities of this table, if any (see DataBlockIter::SetColumnProjection()).
+  const std::vector<Slice>* GetColumnProjection(const ReadOptions& ro) const;
+
   class PartitionedIndexIteratorState;
 
   template <typename TBlocklike>
@@ -490,6 +494,9 @@ class BlockBasedTable : public TableReader {
                              FilePrefetchBuffer* prefetch_buffer,
                              InternalIterator* meta_iter,
                              const SequenceNumber largest_seqno);
+  Status ReadKeyPrefixDictBlock(const ReadOptions& ro,
+                                FilePrefetchBuffer* prefetch_buffer,
+                                InternalIterator* meta_iter);
   Status ReadRangeDelBlock(const ReadOptions& ro,
                            FilePrefetchBuffer* prefetch_buffer,
                            InternalIterator* meta_iter,
@@ -599,6 +606,11 @@ struct BlockBasedTable::Rep {
   std::unique_ptr<IndexReader> index_reader;
   std::unique_ptr<FilterBlockReader> filter;
   std::unique_ptr<UncompressionDictReader> uncompression_dict_reader;
+  // Set for tables whose data blocks use a key prefix dictionary.
+  std::unique_ptr<KeyPrefixDict> key_prefix_dict;
+  // Whether data blocks start with a column section holding their
+  // wide-column entities (see columnar_block.h).
+  bool columnar_entity_blocks = false;
 
   enum class FilterType {
     kNoFilter,
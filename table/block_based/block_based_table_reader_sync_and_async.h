@@ -6,6 +6,7 @@
 
 #include "util/async_file_reader.h"
 #include "util/coro_utils.h"
+#include "util/parallel_for.h"
 
 #if defined(WITHOUT_COROUTINES) || \
     (defined(USE_COROUTINES) && defined(WITH_COROUTINES))
@@ -161,22 +162,36 @@ DEFINE_SYNC_AND_ASYNC(void, BlockBasedTable::RetrieveMultipleBlocks)
     }
   }
 
+  // The blocks read, with their positions in the batch and in
+  // req_idx_for_block.
+  struct ReadBlock {
+    size_t idx_in_batch;
+    size_t valid_batch_idx;
+    GetContext* get_context;
+  };
+  autovector<ReadBlock, MultiGetContext::MAX_BATCH_SIZE> read_blocks;
   idx_in_batch = 0;
-  size_t valid_batch_idx = 0;
   for (auto mget_iter = batch->begin(); mget_iter != batch->end();
        ++mget_iter, ++idx_in_batch) {
-    const BlockHandle& handle = (*handles)[idx_in_batch];
-
-    if (handle.IsNull()) {
-      continue;
+    if (!(*handles)[idx_in_batch].IsNull()) {
+      read_blocks.push_back(
+          {idx_in_batch, read_blocks.size(), mget_iter->get_context});
     }
+  }
+
+  // Verifies, uncompresses and caches read_blocks[i]. Blocks only share
+  // read-only state, so this can run for several blocks at once.
+  auto retrieve_block = [&](size_t i) {
+    const size_t batch_idx = read_blocks[i].idx_in_batch;
+    const size_t valid_batch_idx = read_blocks[i].valid_batch_idx;
+    GetContext* get_context = read_blocks[i].get_context;
+    const BlockHandle& handle = (*handles)[batch_idx];
 
     assert(valid_batch_idx < req_idx_for_block.size());
     assert(valid_batch_idx < req_offset_for_block.size());
     assert(req_idx_for_block[valid_batch_idx] < read_reqs.size());
-    size_t& req_idx = req_idx_for_block[valid_batch_idx];
-    size_t& req_offset = req_offset_for_block[valid_batch_idx];
-    valid_batch_idx++;
+    const size_t req_idx = req_idx_for_block[valid_batch_idx];
+    const size_t req_offset = req_offset_for_block[valid_batch_idx];
     FSReadRequest& req = read_reqs[req_idx];
     Status s = req.status;
     if (s.ok()) {
@@ -286,13 +301,13 @@ DEFINE_SYNC_AND_ASYNC(void, BlockBasedTable::RetrieveMultipleBlocks)
 
     if (s.ok()) {
       if (options.fill_cache) {
-        CachableEntry<Block_kData>* block_entry = &results[idx_in_batch];
+        CachableEntry<Block_kData>* block_entry = &results[batch_idx];
         // MaybeReadBlockAndLoadToCache will insert into the block caches if
         // necessary. Since we're passing the serialized block contents, it
         // will avoid looking up the block cache
         s = MaybeReadBlockAndLoadToCache(
             nullptr, options, handle, uncompression_dict,
-            /*for_compaction=*/false, block_entry, mget_iter->get_context,
+            /*for_compaction=*/false, block_entry, get_context,
             /*lookup_context=*/nullptr, &serialized_block,
             /*async_read=*/false, /*use_block_cache_for_lookup=*/true);
 
@@ -302,7 +317,7 @@ DEFINE_SYNC_AND_ASYNC(void, BlockBasedTable::RetrieveMultipleBlocks)
         // through and set up the block explicitly
         if (block_entry->GetValue() != nullptr) {
           s.PermitUncheckedError();
-          continue;
+          return;
         }
       }
 
@@ -326,12 +341,25 @@ DEFINE_SYNC_AND_ASYNC(void, BlockBasedTable::RetrieveMultipleBlocks)
         contents = std::move(serialized_block);
       }
       if (s.ok()) {
-        results[idx_in_batch].SetOwnedValue(std::make_unique<Block_kData>(
+        results[batch_idx].SetOwnedValue(std::make_unique<Block_kData>(
             std::move(contents), read_amp_bytes_per_bit, ioptions.stats));
       }
     }
-    statuses[idx_in_batch] = s;
-  }
+    statuses[batch_idx] = s;
+  };
+
+  // Uncompressing a batch of cold blocks dominates MultiGet latency, so it
+  // is spread over the decompression thread pool if there is one.
+  ThreadPool* decompression_pool =
+      rep_->blocks_maybe_compressed
+          ? rep_->table_options.decompression_thread_pool.get()
+          : nullptr;
+  ParallelFor(decompression_pool,
+              decompression_pool != nullptr
+                  ? static_cast<size_t>(
+                        decompression_pool->GetBackgroundThreads())
+                  : 0,
+              read_blocks.size(), retrieve_block);
 
   if (use_fs_scratch) {
     // Free the allocated scratch buffer by fs here as read requests might have
@@ -676,6 +704,9 @@ DEFINE_SYNC_AND_ASYNC(void, BlockBasedTable::MultiGet)
           s = biter->status();
           break;
         }
+        if (get_context->NeedColumns()) {
+          biter->SetColumnProjection(GetColumnProjection(read_options));
+        }
 
         // Reusing blocks complicates pinning/Cleanable, because the cache
         // entry referenced by biter can only be released once all returned
@@ -30,6 +30,15 @@
 //     restarts: uint32[num_restarts]
 //     num_restarts: uint32
 // restarts[i] contains the offset within the block of the ith restart point.
+// Restart fingerprints and the data block hash index, when present, sit
+// between the restart array and num_restarts; see restart_fingerprints.h and
+// data_block_hash_index.h.
+//
+// In tables with a key prefix dictionary, the key delta of an entry with
+// shared == 0 starts with a varint32 dictionary id; see key_prefix_dict.h.
+//
+// In tables with columnar entity blocks, the column section of the block
+// precedes the first entry; see columnar_block.h.
 
 #include "table/block_based/block_builder.h"
 
@@ -39,6 +48,8 @@
 #include "db/dbformat.h"
 #include "rocksdb/comparator.h"
 #include "table/block_based/data_block_footer.h"
+#include "table/block_based/key_prefix_dict.h"
+#include "table/block_based/restart_fingerprints.h"
 #include "util/coding.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -48,12 +59,17 @@ BlockBuilder::BlockBuilder(
     bool use_value_delta_encoding,
     BlockBasedTableOptions::DataBlockIndexType index_type,
     double data_block_hash_table_util_ratio, size_t ts_sz,
-    bool persist_user_defined_timestamps, bool is_user_key)
+    bool persist_user_defined_timestamps, bool is_user_key,
+    bool use_restart_fingerprints, KeyPrefixDictBuilder* key_prefix_dict,
+    ColumnarBlockBuilder* columnar_block)
     : block_restart_interval_(block_restart_interval),
       use_delta_encoding_(use_delta_encoding),
       use_value_delta_encoding_(use_value_delta_encoding),
       strip_ts_sz_(persist_user_defined_timestamps ? 0 : ts_sz),
       is_user_key_(is_user_key),
+      use_restart_fingerprints_(use_restart_fingerprints),
+      key_prefix_dict_(key_prefix_dict),
+      columnar_block_(columnar_block),
       restarts_(1, 0),  // First restart point is at offset 0
       counter_(0),
       finished_(false) {
@@ -68,6 +84,10 @@ BlockBuilder::BlockBuilder(
       assert(0);
   }
   assert(block_restart_interval_ >= 1);
+  // Fingerprints are taken from user keys of internal keys.
+  assert(!use_restart_fingerprints_ || !is_user_key_);
+  assert(key_prefix_dict_ == nullptr || (!is_user_key_ && strip_ts_sz_ == 0));
+  assert(columnar_block_ == nullptr || !is_user_key_);
   estimate_ = sizeof(uint32_t) + sizeof(uint32_t);
 }
 
@@ -75,13 +95,18 @@ void BlockBuilder::Reset() {
   buffer_.clear();
   restarts_.resize(1);  // First restart point is at offset 0
   assert(restarts_[0] == 0);
+  restart_fingerprints_.clear();
   estimate_ = sizeof(uint32_t) + sizeof(uint32_t);
   counter_ = 0;
   finished_ = false;
+  has_column_section_ = false;
   last_key_.clear();
   if (data_block_hash_index_builder_.Valid()) {
     data_block_hash_index_builder_.Reset();
   }
+  if (columnar_block_ != nullptr) {
+    columnar_block_->Reset();
+  }
 #ifndef NDEBUG
   add_with_last_key_called_ = false;
 #endif
@@ -124,22 +149,47 @@ size_t BlockBuilder::EstimateSizeAfterKV(const Slice& key,
 }
 
 Slice BlockBuilder::Finish() {
+  // Like the hash index, fingerprints are only flagged in the footer of
+  // blocks of up to kMaxBlockSizeSupportedByHashIndex bytes.
+  const bool small_block =
+      CurrentSizeEstimate() <= kMaxBlockSizeSupportedByHashIndex;
+
+  // Entries move behind the column section, if any.
+  uint32_t entries_offset = 0;
+  if (columnar_block_ != nullptr && !columnar_block_->empty()) {
+    std::string column_section;
+    columnar_block_->Finish(&column_section);
+    buffer_.insert(0, column_section);
+    entries_offset = static_cast<uint32_t>(column_section.size());
+    has_column_section_ = true;
+  }
+
   // Append restart array
   for (size_t i = 0; i < restarts_.size(); i++) {
-    PutFixed32(&buffer_, restarts_[i]);
+    PutFixed32(&buffer_, entries_offset + restarts_[i]);
   }
 
   uint32_t num_restarts = static_cast<uint32_t>(restarts_.size());
+  const bool has_restart_fingerprints = use_restart_fingerprints_ &&
+                                        small_block &&
+                                        restart_fingerprints_.size() ==
+                                            restarts_.size();
+  if (has_restart_fingerprints) {
+    for (uint64_t fp : restart_fingerprints_) {
+      PutFixed64(&buffer_, fp);
+    }
+  }
   BlockBasedTableOptions::DataBlockIndexType index_type =
       BlockBasedTableOptions::kDataBlockBinarySearch;
-  if (data_block_hash_index_builder_.Valid() &&
-      CurrentSizeEstimate() <= kMaxBlockSizeSupportedByHashIndex) {
+  if (data_block_hash_index_builder_.Valid() && small_block) {
     data_block_hash_index_builder_.Finish(buffer_);
     index_type = BlockBasedTableOptions::kDataBlockBinaryAndHash;
   }
 
-  // footer is a packed format of data_block_index_type and num_restarts
-  uint32_t block_footer = PackIndexTypeAndNumRestarts(index_type, num_restarts);
+  // footer is a packed format of data_block_index_type, restart fingerprints
+  // flag and num_restarts
+  uint32_t block_footer = PackIndexTypeAndNumRestarts(
+      index_type, num_restarts, has_restart_fingerprints);
 
   PutFixed32(&buffer_, block_footer);
   finished_ = true;
@@ -177,13 +227,32 @@ void BlockBuilder::AddWithLastKey(const Slice& key, const Slice& value,
   // is sound.
   size_t buffer_size = buffer_.size();
   size_t last_key_size = last_key_param.size();
-  assert(buffer_size == 0 || buffer_size >= last_key_size - strip_ts_sz_);
+  // Keys stored against the key prefix dictionary can be shorter than the
+  // last key.
+  assert(buffer_size == 0 || key_prefix_dict_ != nullptr ||
+         buffer_size >= last_key_size - strip_ts_sz_);
 
   Slice last_key(last_key_param.data(), last_key_size * (buffer_size > 0));
 
   AddWithLastKeyImpl(key, value, last_key, delta_value, buffer_size);
 }
 
+Status BlockBuilder::AddEntityWithLastKey(const Slice& key,
+                                          const Slice& entity,
+                                          const Slice& last_key) {
+  assert(columnar_block_ != nullptr);
+  assert(ExtractValueType(key) == kTypeWideColumnEntity);
+  uint32_t row = 0;
+  Status s = columnar_block_->Add(entity, &row);
+  if (!s.ok()) {
+    return s;
+  }
+  std::string row_value;
+  PutVarint32(&row_value, row);
+  AddWithLastKey(key, row_value, last_key);
+  return Status::OK();
+}
+
 inline void BlockBuilder::AddWithLastKeyImpl(const Slice& key,
                                              const Slice& value,
                                              const Slice& last_key,
@@ -211,8 +280,19 @@ inline void BlockBuilder::AddWithLastKeyImpl(const Slice& key,
     // See how much sharing to do with previous string
     shared = key_to_persist.difference_offset(last_key_persisted);
   }
+  if (use_restart_fingerprints_ && counter_ == 0) {
+    restart_fingerprints_.push_back(
+        RestartKeyFingerprint(ExtractUserKey(key_to_persist)));
+  }
 
-  const size_t non_shared = key_to_persist.size() - shared;
+  size_t non_shared = key_to_persist.size() - shared;
+  uint32_t prefix_id = 0;
+  size_t prefix_size = 0;
+  if (key_prefix_dict_ != nullptr && shared == 0) {
+    prefix_id = key_prefix_dict_->FindOrAdd(ExtractUserKey(key_to_persist),
+                                            &prefix_size);
+    non_shared = VarintLength(prefix_id) + key_to_persist.size() - prefix_size;
+  }
 
   if (use_value_delta_encoding_) {
     // Add "<shared><non_shared>" to buffer_
@@ -226,7 +306,13 @@ inline void BlockBuilder::AddWithLastKeyImpl(const Slice& key,
   }
 
   // Add string delta to buffer_ followed by value
-  buffer_.append(key_to_persist.data() + shared, non_shared);
+  if (key_prefix_dict_ != nullptr && shared == 0) {
+    PutVarint32(&buffer_, prefix_id);
+    buffer_.append(key_to_persist.data() + prefix_size,
+                   key_to_persist.size() - prefix_size);
+  } else {
+    buffer_.append(key_to_persist.data() + shared, non_shared);
+  }
   // Use value delta encoding only when the key has shared bytes. This would
   // simplify the decoding, where it can figure which decoding to use simply by
   // looking at the shared bytes size.
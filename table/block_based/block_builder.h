@@ -14,10 +14,13 @@
 
 #include "rocksdb/slice.h"
 #include "rocksdb/table.h"
+#include "table/block_based/columnar_block.h"
 #include "table/block_based/data_block_hash_index.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+class KeyPrefixDictBuilder;
+
 class BlockBuilder {
  public:
   BlockBuilder(const BlockBuilder&) = delete;
@@ -31,7 +34,10 @@ class BlockBuilder {
                         double data_block_hash_table_util_ratio = 0.75,
                         size_t ts_sz = 0,
                         bool persist_user_defined_timestamps = true,
-                        bool is_user_key = false);
+                        bool is_user_key = false,
+                        bool use_restart_fingerprints = false,
+                        KeyPrefixDictBuilder* key_prefix_dict = nullptr,
+                        ColumnarBlockBuilder* columnar_block = nullptr);
 
   // Reset the contents as if the BlockBuilder was just constructed.
   void Reset();
@@ -61,6 +67,13 @@ class BlockBuilder {
                       const Slice& last_key,
                       const Slice* const delta_value = nullptr);
 
+  // Like AddWithLastKey(), for a kTypeWideColumnEntity key whose entity goes
+  // to the column section (see columnar_block.h). Fails if `entity` cannot be
+  // deserialized.
+  // REQUIRES: the builder was created with a ColumnarBlockBuilder.
+  Status AddEntityWithLastKey(const Slice& key, const Slice& entity,
+                              const Slice& last_key);
+
   // Finish building the block and return a slice that refers to the
   // block contents.  The returned slice will remain valid for the
   // lifetime of this builder or until Reset() is called.
@@ -69,9 +82,14 @@ class BlockBuilder {
   // Returns an estimate of the current (uncompressed) size of the block
   // we are building.
   inline size_t CurrentSizeEstimate() const {
-    return estimate_ + (data_block_hash_index_builder_.Valid()
-                            ? data_block_hash_index_builder_.EstimateSize()
-                            : 0);
+    return estimate_ +
+           (data_block_hash_index_builder_.Valid()
+                ? data_block_hash_index_builder_.EstimateSize()
+                : 0) +
+           (use_restart_fingerprints_ ? restarts_.size() * sizeof(uint64_t)
+                                      : 0) +
+           (columnar_block_ != nullptr ? columnar_block_->CurrentSizeEstimate()
+                                       : 0);
   }
 
   // Returns an estimated block size after appending key and value.
@@ -80,6 +98,10 @@ class BlockBuilder {
   // Return true iff no entries have been added since the last Reset()
   bool empty() const { return buffer_.empty(); }
 
+  // Whether Finish() put a column section in front of the entries. Valid
+  // until the next Reset().
+  bool has_column_section() const { return has_column_section_; }
+
  private:
   inline void AddWithLastKeyImpl(const Slice& key, const Slice& value,
                                  const Slice& last_key,
@@ -112,12 +134,24 @@ class BlockBuilder {
   // index block for partitioned index blocks. In summary, this only applies to
   // block whose key are real user keys or internal keys created from user keys.
   const bool is_user_key_;
+  // Whether to store restart fingerprints (see restart_fingerprints.h).
+  // Only set for data blocks of tables using BytewiseComparator().
+  const bool use_restart_fingerprints_;
+  // If set, keys with no bytes shared with the previous key are stored as a
+  // reference into this dictionary plus a suffix (see key_prefix_dict.h).
+  // Only set for data blocks with internal keys.
+  KeyPrefixDictBuilder* const key_prefix_dict_;
+  // If set, the entities added with AddEntityWithLastKey() are stored in a
+  // column section at the start of the block. Only set for data blocks.
+  ColumnarBlockBuilder* const columnar_block_;
 
   std::string buffer_;              // Destination buffer
   std::vector<uint32_t> restarts_;  // Restart points
+  std::vector<uint64_t> restart_fingerprints_;
   size_t estimate_;
   int counter_;    // Number of entries emitted since restart
   bool finished_;  // Has Finish() been called?
+  bool has_column_section_ = false;
   std::string last_key_;
   DataBlockHashIndexBuilder data_block_hash_index_builder_;
 #ifndef NDEBUG
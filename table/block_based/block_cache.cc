@@ -13,8 +13,8 @@ void BlockCreateContext::Create(std::unique_ptr<Block_kData>* parsed_out,
                                 BlockContents&& block) {
   parsed_out->reset(new Block_kData(
       std::move(block), table_options->read_amp_bytes_per_bit, statistics));
-  parsed_out->get()->InitializeDataBlockProtectionInfo(protection_bytes_per_key,
-                                                       raw_ucmp);
+  parsed_out->get()->InitializeDataBlockProtectionInfo(
+      protection_bytes_per_key, raw_ucmp, key_prefix_dict);
 }
 void BlockCreateContext::Create(std::unique_ptr<Block_kIndex>* parsed_out,
                                 BlockContents&& block) {
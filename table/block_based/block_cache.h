@@ -89,6 +89,8 @@ struct BlockCreateContext : public Cache::CreateContext {
   Statistics* statistics = nullptr;
   const Comparator* raw_ucmp = nullptr;
   const UncompressionDict* dict = nullptr;
+  // Only used to parse data blocks when they are created, not kept in them.
+  const KeyPrefixDict* key_prefix_dict = nullptr;
   uint32_t format_version;
   bool using_zstd = false;
   uint8_t protection_bytes_per_key = 0;
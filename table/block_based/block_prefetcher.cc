@@ -8,6 +8,8 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #include "table/block_based/block_prefetcher.h"
 
+#include <algorithm>
+
 #include "rocksdb/file_system.h"
 #include "table/block_based/block_based_table_reader.h"
 
@@ -21,7 +23,12 @@ void BlockPrefetcher::PrefetchIfNeeded(
   ReadaheadParams readahead_params;
   readahead_params.initial_readahead_size = readahead_size;
   readahead_params.max_readahead_size = readahead_size;
-  readahead_params.num_buffers = is_async_io_prefetch ? 2 : 1;
+  // One buffer is being read from while the others are filled
+  // asynchronously.
+  readahead_params.num_buffers =
+      is_async_io_prefetch
+          ? 1 + std::max<size_t>(read_options.async_io_readahead_depth, 1)
+          : 1;
 
   const size_t len = BlockBasedTable::BlockSizeWithTrailer(handle);
   const size_t offset = handle.offset();
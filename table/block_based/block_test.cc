@@ -287,6 +287,179 @@ TEST_P(BlockTest, IndexHashWithSharedPrefix) {
 }
 
 // Param 0: key use delta encoding
+TEST_P(BlockTest, RestartFingerprints) {
+  if (isUDTEnabled()) {
+    // Fingerprints are only built with BytewiseComparator().
+    return;
+  }
+  // Groups of keys sharing their first 8 bytes, so that fingerprints tie.
+  // Few enough restarts for the data block hash index to be kept.
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  for (int i = 0; i < 300; i += 2) {
+    for (int j = 0; j < 4; ++j) {
+      keys.push_back(GenerateInternalKey(i, j * 7, 0 /* padding_size */,
+                                         nullptr /* rnd */));
+      values.push_back(std::to_string(i * 4 + j));
+    }
+  }
+
+  std::vector<std::string> raw_blocks;
+  for (bool use_fingerprints : {false, true}) {
+    BlockBuilder builder(3 /* block_restart_interval */, keyUseDeltaEncoding(),
+                         false /* use_value_delta_encoding */,
+                         dataBlockIndexType(),
+                         0.75 /* data_block_hash_table_util_ratio */,
+                         0 /* ts_sz */, true /* persist_udt */,
+                         false /* is_user_key */, use_fingerprints);
+    for (size_t i = 0; i < keys.size(); ++i) {
+      builder.Add(keys[i], values[i]);
+    }
+    raw_blocks.push_back(builder.Finish().ToString());
+  }
+  ASSERT_EQ(raw_blocks[0].size() + (keys.size() + 2) / 3 * sizeof(uint64_t),
+            raw_blocks[1].size());
+
+  Block plain_block{BlockContents(raw_blocks[0])};
+  Block fingerprint_block{BlockContents(raw_blocks[1])};
+  ASSERT_FALSE(plain_block.HasRestartFingerprints());
+  ASSERT_TRUE(fingerprint_block.HasRestartFingerprints());
+  ASSERT_EQ(plain_block.NumRestarts(), fingerprint_block.NumRestarts());
+  ASSERT_EQ(dataBlockIndexType(), fingerprint_block.IndexType());
+
+  std::unique_ptr<DataBlockIter> expected(plain_block.NewDataIterator(
+      BytewiseComparator(), kDisableGlobalSequenceNumber));
+  std::unique_ptr<DataBlockIter> iter(fingerprint_block.NewDataIterator(
+      BytewiseComparator(), kDisableGlobalSequenceNumber));
+  // Existing keys, keys between them, and keys before and after all of them.
+  for (int i = -1; i <= 601; ++i) {
+    for (int j = 0; j < 30; j += 3) {
+      std::string target = GenerateInternalKey(i, j, 0, nullptr);
+      expected->Seek(target);
+      iter->Seek(target);
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(expected->Valid(), iter->Valid());
+      if (iter->Valid()) {
+        ASSERT_EQ(expected->key(), iter->key());
+        ASSERT_EQ(expected->value(), iter->value());
+      }
+
+      expected->SeekForPrev(target);
+      iter->SeekForPrev(target);
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(expected->Valid(), iter->Valid());
+      if (iter->Valid()) {
+        ASSERT_EQ(expected->key(), iter->key());
+      }
+    }
+  }
+  for (const auto &key : keys) {
+    iter->Seek(key);
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(key, iter->key());
+  }
+}
+
+TEST_P(BlockTest, KeyPrefixDict) {
+  if (isUDTEnabled()) {
+    // The dictionary is not used with user-defined timestamps.
+    return;
+  }
+  // The first 6 bytes of the user keys are the primary key.
+  std::unique_ptr<const SliceTransform> prefix_extractor(
+      NewFixedPrefixTransform(6));
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  for (int i = 0; i < 100; ++i) {
+    for (int j = 0; j < 5; ++j) {
+      keys.push_back(GenerateInternalKey(i, j, 0 /* padding_size */,
+                                         nullptr /* rnd */));
+      values.push_back(std::to_string(i * 5 + j));
+    }
+  }
+
+  // Only the first half of the primary keys fit in the dictionary.
+  KeyPrefixDictBuilder dict_builder(prefix_extractor.get(), 350);
+  std::vector<std::string> raw_blocks;
+  for (KeyPrefixDictBuilder *dict : {static_cast<KeyPrefixDictBuilder *>(
+                                         nullptr),
+                                     &dict_builder}) {
+    BlockBuilder builder(
+        3 /* block_restart_interval */, keyUseDeltaEncoding(),
+        false /* use_value_delta_encoding */, dataBlockIndexType(),
+        0.75 /* data_block_hash_table_util_ratio */, 0 /* ts_sz */,
+        true /* persist_udt */, false /* is_user_key */,
+        false /* use_restart_fingerprints */, dict);
+    for (size_t i = 0; i < keys.size(); ++i) {
+      builder.Add(keys[i], values[i]);
+    }
+    raw_blocks.push_back(builder.Finish().ToString());
+  }
+  ASSERT_EQ(50, dict_builder.NumEntries());
+  ASSERT_LT(raw_blocks[1].size(), raw_blocks[0].size());
+
+  std::unique_ptr<KeyPrefixDict> dict;
+  ASSERT_OK(KeyPrefixDict::Create(dict_builder.contents(), &dict));
+  ASSERT_EQ(50, dict->NumEntries());
+
+  Block plain_block{BlockContents(raw_blocks[0])};
+  Block dict_block{BlockContents(raw_blocks[1])};
+  // Also parses every key to compute the per key-value checksums.
+  dict_block.InitializeDataBlockProtectionInfo(
+      8 /* protection_bytes_per_key */, BytewiseComparator(), dict.get());
+  std::unique_ptr<DataBlockIter> expected(plain_block.NewDataIterator(
+      BytewiseComparator(), kDisableGlobalSequenceNumber));
+  std::unique_ptr<DataBlockIter> iter(dict_block.NewDataIterator(
+      BytewiseComparator(), kDisableGlobalSequenceNumber, nullptr /* iter */,
+      nullptr /* stats */, false /* block_contents_pinned */,
+      true /* user_defined_timestamps_persisted */, dict.get()));
+
+  size_t count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++count) {
+    ASSERT_EQ(keys[count], iter->key());
+    ASSERT_EQ(values[count], iter->value());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(keys.size(), count);
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+    ASSERT_EQ(keys[--count], iter->key());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(0, count);
+  for (int i = -1; i <= 101; ++i) {
+    for (int j = -1; j <= 6; j += 2) {
+      std::string target = GenerateInternalKey(i, j, 0, nullptr);
+      expected->Seek(target);
+      iter->Seek(target);
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(expected->Valid(), iter->Valid());
+      if (iter->Valid()) {
+        ASSERT_EQ(expected->key(), iter->key());
+        ASSERT_EQ(expected->value(), iter->value());
+      }
+
+      expected->SeekForPrev(target);
+      iter->SeekForPrev(target);
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(expected->Valid(), iter->Valid());
+      if (iter->Valid()) {
+        ASSERT_EQ(expected->key(), iter->key());
+      }
+    }
+  }
+
+  // Ids missing from the dictionary are reported as corruption.
+  std::unique_ptr<KeyPrefixDict> empty_dict;
+  ASSERT_OK(KeyPrefixDict::Create(Slice(), &empty_dict));
+  iter.reset(dict_block.NewDataIterator(
+      BytewiseComparator(), kDisableGlobalSequenceNumber, nullptr /* iter */,
+      nullptr /* stats */, false /* block_contents_pinned */,
+      true /* user_defined_timestamps_persisted */, empty_dict.get()));
+  iter->SeekToFirst();
+  ASSERT_FALSE(iter->Valid());
+  ASSERT_TRUE(iter->status().IsCorruption());
+}
+
 // Param 1: user-defined timestamp test mode
 // Param 2: data block index type. User-defined timestamp feature is not
 // compatible with `kDataBlockBinaryAndHash` data block index type because the
@@ -0,0 +1,299 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/columnar_block.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#include "db/wide/wide_column_serialization.h"
+#include "table/block_based/block_based_table_builder.h"
+#include "table/format.h"
+#include "util/coding.h"
+#include "util/compression.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Mini-pages are compressed like the blocks of tables with this
+// format_version; see GetCompressFormatForVersion().
+constexpr uint32_t kColumnarFormatVersion = 2;
+}  // namespace
+
+ColumnarBlockBuilder::ColumnarBlockBuilder(
+    CompressionType compression_type,
+    const CompressionOptions& compression_opts)
+    : compression_opts_(compression_opts) {
+  if (compression_type != kNoCompression) {
+    compression_ctx_.reset(
+        new CompressionContext(compression_type, compression_opts_));
+    compression_info_.reset(new CompressionInfo(
+        compression_opts_, *compression_ctx_, CompressionDict::GetEmptyDict(),
+        compression_type, 0 /* sample_for_compression */));
+  }
+}
+
+ColumnarBlockBuilder::~ColumnarBlockBuilder() = default;
+
+ColumnarBlockBuilder::Column* ColumnarBlockBuilder::GetOrAddColumn(
+    const Slice& name) {
+  auto it = std::lower_bound(
+      columns_.begin(), columns_.end(), name,
+      [](const std::unique_ptr<Column>& lhs, const Slice& rhs) {
+        return Slice(lhs->name).compare(rhs) < 0;
+      });
+  if (it == columns_.end() || Slice((*it)->name) != name) {
+    std::unique_ptr<Column> column(new Column());
+    column->name = name.ToString();
+    estimate_ += VarintLength(name.size()) + name.size() + 1 /* type */ +
+                 3 * sizeof(uint32_t) /* sizes and num_values */;
+    it = columns_.insert(it, std::move(column));
+  }
+  return it->get();
+}
+
+Status ColumnarBlockBuilder::Add(const Slice& entity, uint32_t* row) {
+  assert(row != nullptr);
+  if (num_rows_ == std::numeric_limits<uint32_t>::max()) {
+    return Status::InvalidArgument("Too many rows in columnar block");
+  }
+  Slice input = entity;
+  WideColumns columns;
+  Status s = WideColumnSerialization::Deserialize(input, columns);
+  if (!s.ok()) {
+    return s;
+  }
+  for (const auto& wc : columns) {
+    if (wc.value().size() > std::numeric_limits<uint32_t>::max()) {
+      return Status::InvalidArgument("Wide column value too long");
+    }
+  }
+  *row = num_rows_;
+  for (const auto& wc : columns) {
+    Column* column = GetOrAddColumn(wc.name());
+    size_t before = column->row_index.size() + column->values.size();
+    PutVarint32Varint32(
+        &column->row_index,
+        column->num_values == 0 ? *row : *row - column->last_row,
+        static_cast<uint32_t>(wc.value().size()));
+    column->values.append(wc.value().data(), wc.value().size());
+    column->last_row = *row;
+    ++column->num_values;
+    estimate_ += column->row_index.size() + column->values.size() - before;
+  }
+  ++num_rows_;
+  return Status::OK();
+}
+
+void ColumnarBlockBuilder::Finish(std::string* contents) {
+  PutVarint32Varint32(contents, num_rows_,
+                      static_cast<uint32_t>(columns_.size()));
+
+  std::string pages;
+  std::string raw;
+  std::string compressed;
+  for (const auto& column : columns_) {
+    raw.clear();
+    PutVarint32(&raw, column->num_values);
+    raw.append(column->row_index);
+    raw.append(column->values);
+
+    CompressionType type = kNoCompression;
+    Slice page = raw;
+    if (compression_info_ != nullptr) {
+      compressed.clear();
+      page = CompressBlock(raw, *compression_info_, &type,
+                           kColumnarFormatVersion, false /* do_sample */,
+                           &compressed, nullptr /* sampled_output_fast */,
+                           nullptr /* sampled_output_slow */);
+    }
+    PutLengthPrefixedSlice(contents, column->name);
+    contents->push_back(static_cast<char>(type));
+    PutVarint32Varint32(contents, static_cast<uint32_t>(raw.size()),
+                        static_cast<uint32_t>(page.size()));
+    pages.append(page.data(), page.size());
+  }
+  contents->append(pages);
+  Reset();
+}
+
+void ColumnarBlockBuilder::Reset() {
+  num_rows_ = 0;
+  columns_.clear();
+  estimate_ = 0;
+}
+
+Status ColumnarBlockReader::Create(const Slice& contents,
+                                   std::unique_ptr<ColumnarBlockReader>* reader,
+                                   MemoryAllocator* allocator) {
+  std::unique_ptr<ColumnarBlockReader> new_reader(
+      new ColumnarBlockReader(allocator));
+  Slice input = contents;
+  uint32_t num_columns = 0;
+  if (!GetVarint32(&input, &new_reader->num_rows_) ||
+      !GetVarint32(&input, &num_columns) || num_columns > input.size()) {
+    return Status::Corruption("Error decoding columnar block header");
+  }
+  new_reader->columns_.resize(num_columns);
+  uint64_t total_page_size = 0;
+  for (uint32_t i = 0; i < num_columns; ++i) {
+    Column& column = new_reader->columns_[i];
+    uint32_t page_size = 0;
+    if (!GetLengthPrefixedSlice(&input, &column.name) || input.empty()) {
+      return Status::Corruption("Error decoding columnar block column");
+    }
+    column.compression_type = static_cast<CompressionType>(input[0]);
+    input.remove_prefix(1);
+    if (!GetVarint32(&input, &column.uncompressed_size) ||
+        !GetVarint32(&input, &page_size)) {
+      return Status::Corruption("Error decoding columnar block column");
+    }
+    if (i > 0 && new_reader->columns_[i - 1].name.compare(column.name) >= 0) {
+      return Status::Corruption("Columnar block columns out of order");
+    }
+    // Pages are located once the directory has been read.
+    column.page = Slice(nullptr, page_size);
+    total_page_size += page_size;
+  }
+  if (total_page_size != input.size()) {
+    return Status::Corruption("Columnar block size mismatch");
+  }
+  for (auto& column : new_reader->columns_) {
+    column.page = Slice(input.data(), column.page.size());
+    input.remove_prefix(column.page.size());
+  }
+
+  *reader = std::move(new_reader);
+  return Status::OK();
+}
+
+Status ColumnarBlockReader::LoadColumn(Column* column) {
+  assert(!column->loaded);
+  Slice data = column->page;
+  if (column->compression_type != kNoCompression) {
+    UncompressionContext context(column->compression_type);
+    UncompressionInfo info(context, UncompressionDict::GetEmptyDict(),
+                           column->compression_type);
+    size_t uncompressed_size = 0;
+    column->uncompressed = UncompressData(
+        info, data.data(), data.size(), &uncompressed_size,
+        GetCompressFormatForVersion(kColumnarFormatVersion), allocator_);
+    if (!column->uncompressed) {
+      return Status::Corruption("Columnar block mini-page decompression failed",
+                                CompressionTypeToString(
+                                    column->compression_type));
+    }
+    data = Slice(column->uncompressed.get(), uncompressed_size);
+  }
+  if (data.size() != column->uncompressed_size) {
+    return Status::Corruption("Columnar block mini-page size mismatch");
+  }
+
+  uint32_t num_values = 0;
+  if (!GetVarint32(&data, &num_values) || num_values > num_rows_) {
+    return Status::Corruption("Error decoding columnar block mini-page");
+  }
+  column->rows.resize(num_values);
+  std::vector<uint32_t> value_sizes(num_values);
+  uint64_t row = 0;
+  uint64_t total_value_size = 0;
+  for (uint32_t i = 0; i < num_values; ++i) {
+    uint32_t row_delta = 0;
+    if (!GetVarint32(&data, &row_delta) ||
+        !GetVarint32(&data, &value_sizes[i]) || (i > 0 && row_delta == 0)) {
+      return Status::Corruption("Error decoding columnar block mini-page");
+    }
+    row += row_delta;
+    if (row >= num_rows_) {
+      return Status::Corruption("Columnar block row out of range");
+    }
+    column->rows[i] = static_cast<uint32_t>(row);
+    total_value_size += value_sizes[i];
+  }
+  if (total_value_size != data.size()) {
+    return Status::Corruption("Columnar block mini-page size mismatch");
+  }
+  column->values.resize(num_values);
+  for (uint32_t i = 0; i < num_values; ++i) {
+    column->values[i] = Slice(data.data(), value_sizes[i]);
+    data.remove_prefix(value_sizes[i]);
+  }
+  column->loaded = true;
+  decoded_bytes_ += column->uncompressed_size;
+  return Status::OK();
+}
+
+Status ColumnarBlockReader::AppendValue(Column* column, uint32_t row,
+                                        WideColumns* columns) {
+  if (!column->loaded) {
+    Status s = LoadColumn(column);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  auto it = std::lower_bound(column->rows.begin(), column->rows.end(), row);
+  if (it != column->rows.end() && *it == row) {
+    columns->emplace_back(column->name,
+                          column->values[it - column->rows.begin()]);
+  }
+  return Status::OK();
+}
+
+void ColumnarBlockReader::ResolveProjection(
+    const std::vector<Slice>* projection) {
+  assert(projection != nullptr);
+  resolved_projection_ = projection;
+  projected_columns_.clear();
+  for (auto& column : columns_) {
+    if (std::find(projection->begin(), projection->end(), column.name) !=
+        projection->end()) {
+      projected_columns_.push_back(&column);
+    }
+  }
+}
+
+Status ColumnarBlockReader::GetEntity(uint32_t row,
+                                      const std::vector<Slice>* projection,
+                                      WideColumns* columns) {
+  assert(columns != nullptr);
+  columns->clear();
+  if (row >= num_rows_) {
+    return Status::Corruption("Columnar block row out of range");
+  }
+  if (projection == nullptr) {
+    for (auto& column : columns_) {
+      Status s = AppendValue(&column, row, columns);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+    return Status::OK();
+  }
+
+  if (projection != resolved_projection_) {
+    ResolveProjection(projection);
+  }
+  for (Column* column : projected_columns_) {
+    Status s = AppendValue(column, row, columns);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  return Status::OK();
+}
+
+Status ColumnarBlockReader::GetSerializedEntity(
+    uint32_t row, const std::vector<Slice>* projection, std::string* entity) {
+  WideColumns columns;
+  Status s = GetEntity(row, projection, &columns);
+  if (!s.ok()) {
+    return s;
+  }
+  entity->clear();
+  return WideColumnSerialization::Serialize(columns, *entity);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,175 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "memory/memory_allocator_impl.h"
+#include "rocksdb/compression_type.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "rocksdb/wide_columns.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class CompressionContext;
+class CompressionInfo;
+
+// A PAX ("partition attributes across") layout for the wide-column entities
+// of a data block. Instead of storing one serialized entity per key, the
+// values of each column are grouped into a contiguous mini-page that is
+// compressed on its own, so a reader that only needs some of the columns
+// only decompresses and decodes the mini-pages of those columns.
+//
+// In tables written with BlockBasedTableOptions::columnar_entity_blocks, the
+// column section of a data block sits before its first entry, i.e. it spans
+// [0, restarts[0]), and is empty in blocks without entities. The value of a
+// kTypeWideColumnEntity entry is then the varint32 row of the entity in the
+// column section. Other entries are stored as usual.
+//
+// Column section format:
+//
+//   num_rows: varint32
+//   num_columns: varint32
+//   column[num_columns], sorted by name :=
+//     name: varstring
+//     compression_type: char
+//     uncompressed_size: varint32
+//     page_size: varint32
+//   page[num_columns]: bytes, concatenated in column order
+//
+// An uncompressed mini-page lists the rows that have the column, followed by
+// their values:
+//
+//   num_values: varint32
+//   (row_delta: varint32, value_size: varint32)[num_values]
+//   value[num_values]: bytes
+//
+// where row_delta is the distance to the previous row with the column (or
+// the row itself for the first one). Compressed pages use compression format
+// version 2, as block-based tables do since format_version=2.
+class ColumnarBlockBuilder {
+ public:
+  // Mini-pages are compressed with `compression_type`; those that do not
+  // compress well are stored uncompressed.
+  ColumnarBlockBuilder(CompressionType compression_type,
+                       const CompressionOptions& compression_opts);
+  ~ColumnarBlockBuilder();
+
+  ColumnarBlockBuilder(const ColumnarBlockBuilder&) = delete;
+  void operator=(const ColumnarBlockBuilder&) = delete;
+
+  // Adds a row and sets `row` to its number. `entity` is a wide-column
+  // entity as serialized by WideColumnSerialization.
+  Status Add(const Slice& entity, uint32_t* row);
+
+  // Appends the column section to `contents` and resets the builder.
+  void Finish(std::string* contents);
+
+  void Reset();
+
+  uint32_t NumRows() const { return num_rows_; }
+
+  bool empty() const { return num_rows_ == 0; }
+
+  // Size of the uncompressed section if Finish() were called now.
+  size_t CurrentSizeEstimate() const {
+    return num_rows_ == 0 ? 0 : estimate_ + 2 * sizeof(uint32_t);
+  }
+
+ private:
+  struct Column {
+    std::string name;
+    // Row of the last value added, to delta encode row numbers.
+    uint32_t last_row = 0;
+    uint32_t num_values = 0;
+    std::string row_index;
+    std::string values;
+  };
+
+  Column* GetOrAddColumn(const Slice& name);
+
+  const CompressionOptions compression_opts_;
+  // Both unset without compression.
+  std::unique_ptr<CompressionContext> compression_ctx_;
+  std::unique_ptr<CompressionInfo> compression_info_;
+  uint32_t num_rows_ = 0;
+  // Sorted by name.
+  std::vector<std::unique_ptr<Column>> columns_;
+  size_t estimate_ = 0;
+};
+
+// Reads a column section written by ColumnarBlockBuilder. Mini-pages are
+// decompressed and decoded the first time one of their values is read; the
+// section must outlive the reader.
+class ColumnarBlockReader {
+ public:
+  static Status Create(const Slice& contents,
+                       std::unique_ptr<ColumnarBlockReader>* reader,
+                       MemoryAllocator* allocator = nullptr);
+
+  ColumnarBlockReader(const ColumnarBlockReader&) = delete;
+  void operator=(const ColumnarBlockReader&) = delete;
+
+  uint32_t NumRows() const { return num_rows_; }
+
+  size_t NumColumns() const { return columns_.size(); }
+
+  // Sets `columns` to the columns of `row`, sorted by name. With a non-null
+  // `projection`, only the columns named in it are returned (names missing
+  // from the row are skipped) and only their mini-pages are read. The
+  // returned slices point into the section or the reader and stay valid
+  // while the reader is alive.
+  Status GetEntity(uint32_t row, const std::vector<Slice>* projection,
+                   WideColumns* columns);
+
+  // Like GetEntity(), but serializes the columns with
+  // WideColumnSerialization so the result can stand in for a stored entity.
+  Status GetSerializedEntity(uint32_t row,
+                             const std::vector<Slice>* projection,
+                             std::string* entity);
+
+  // Total uncompressed size of the mini-pages decoded so far.
+  uint64_t decoded_bytes() const { return decoded_bytes_; }
+
+ private:
+  struct Column {
+    Slice name;
+    CompressionType compression_type = kNoCompression;
+    uint32_t uncompressed_size = 0;
+    Slice page;
+    // Set by LoadColumn().
+    bool loaded = false;
+    CacheAllocationPtr uncompressed;
+    std::vector<uint32_t> rows;
+    std::vector<Slice> values;
+  };
+
+  explicit ColumnarBlockReader(MemoryAllocator* allocator)
+      : allocator_(allocator) {}
+
+  Status LoadColumn(Column* column);
+
+  // Appends the value of `column` for `row` to `columns`, if it has one.
+  Status AppendValue(Column* column, uint32_t row, WideColumns* columns);
+
+  // Points projected_columns_ at the columns named in `projection`.
+  void ResolveProjection(const std::vector<Slice>* projection);
+
+  MemoryAllocator* const allocator_;
+  uint32_t num_rows_ = 0;
+  // Sorted by name.
+  std::vector<Column> columns_;
+  // The projection projected_columns_ was resolved for.
+  const std::vector<Slice>* resolved_projection_ = nullptr;
+  std::vector<Column*> projected_columns_;
+  uint64_t decoded_bytes_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
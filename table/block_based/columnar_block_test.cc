@@ -0,0 +1,230 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/columnar_block.h"
+
+#include <string>
+#include <vector>
+
+#include "db/wide/wide_column_serialization.h"
+#include "rocksdb/convenience.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+#include "util/compression.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+std::string ColumnName(int column) {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "col%02d", column);
+  return buf;
+}
+
+std::string Serialize(const WideColumns& columns) {
+  std::string entity;
+  EXPECT_OK(WideColumnSerialization::Serialize(columns, entity));
+  return entity;
+}
+}  // namespace
+
+class ColumnarBlockTest : public testing::Test {
+ protected:
+  // Builds `num_rows` entities with up to `num_columns` columns each. Every
+  // third row skips the columns whose index is a multiple of the row's.
+  void BuildEntities(int num_rows, int num_columns) {
+    Random rnd(301);
+    entities_.clear();
+    for (int row = 0; row < num_rows; ++row) {
+      std::vector<std::string> names;
+      std::vector<std::string> values;
+      for (int c = 0; c < num_columns; ++c) {
+        if (row % 3 == 0 && c % (row % 5 + 2) == 0) {
+          continue;
+        }
+        names.push_back(ColumnName(c));
+        values.push_back("v" + std::to_string(row) + "_" +
+                         rnd.RandomString(static_cast<int>(rnd.Uniform(20))));
+      }
+      WideColumns columns;
+      for (size_t i = 0; i < names.size(); ++i) {
+        columns.emplace_back(names[i], values[i]);
+      }
+      entities_.push_back(Serialize(columns));
+    }
+  }
+
+  void Build(CompressionType type, std::string* contents) {
+    ColumnarBlockBuilder builder(type, CompressionOptions());
+    for (size_t i = 0; i < entities_.size(); ++i) {
+      uint32_t row = 0;
+      ASSERT_OK(builder.Add(entities_[i], &row));
+      ASSERT_EQ(i, row);
+    }
+    ASSERT_EQ(entities_.size(), builder.NumRows());
+    size_t estimate = builder.CurrentSizeEstimate();
+    builder.Finish(contents);
+    if (type == kNoCompression) {
+      ASSERT_GE(estimate, contents->size());
+    }
+    ASSERT_TRUE(builder.empty());
+    ASSERT_EQ(0, builder.CurrentSizeEstimate());
+  }
+
+  void VerifyAll(ColumnarBlockReader* reader) {
+    ASSERT_EQ(entities_.size(), reader->NumRows());
+    for (size_t i = 0; i < entities_.size(); ++i) {
+      std::string entity;
+      ASSERT_OK(reader->GetSerializedEntity(static_cast<uint32_t>(i),
+                                            nullptr, &entity));
+      ASSERT_EQ(entities_[i], entity);
+    }
+  }
+
+  std::vector<std::string> entities_;
+};
+
+TEST_F(ColumnarBlockTest, RoundTrip) {
+  BuildEntities(500, 30);
+  std::string contents;
+  Build(kNoCompression, &contents);
+
+  std::unique_ptr<ColumnarBlockReader> reader;
+  ASSERT_OK(ColumnarBlockReader::Create(contents, &reader));
+  ASSERT_EQ(30, reader->NumColumns());
+  VerifyAll(reader.get());
+
+  WideColumns columns;
+  ASSERT_TRUE(reader->GetEntity(500, nullptr, &columns).IsCorruption());
+}
+
+TEST_F(ColumnarBlockTest, EmptyEntities) {
+  ColumnarBlockBuilder builder(kNoCompression, CompressionOptions());
+  uint32_t row = 0;
+  ASSERT_OK(builder.Add(Serialize(WideColumns{}), &row));
+  ASSERT_OK(builder.Add(Serialize(WideColumns{{"x", "1"}}), &row));
+  ASSERT_OK(builder.Add(Serialize(WideColumns{}), &row));
+  ASSERT_EQ(2, row);
+  ASSERT_NOK(builder.Add("not an entity", &row));
+  std::string contents;
+  builder.Finish(&contents);
+
+  std::unique_ptr<ColumnarBlockReader> reader;
+  ASSERT_OK(ColumnarBlockReader::Create(contents, &reader));
+  ASSERT_EQ(3, reader->NumRows());
+  WideColumns columns;
+  ASSERT_OK(reader->GetEntity(0, nullptr, &columns));
+  ASSERT_TRUE(columns.empty());
+  ASSERT_OK(reader->GetEntity(1, nullptr, &columns));
+  ASSERT_EQ((WideColumns{{"x", "1"}}), columns);
+  ASSERT_OK(reader->GetEntity(2, nullptr, &columns));
+  ASSERT_TRUE(columns.empty());
+}
+
+TEST_F(ColumnarBlockTest, Projection) {
+  BuildEntities(500, 30);
+  std::string contents;
+  Build(kNoCompression, &contents);
+
+  std::unique_ptr<ColumnarBlockReader> reader;
+  ASSERT_OK(ColumnarBlockReader::Create(contents, &reader));
+  const std::string col7 = ColumnName(7);
+  const std::string col3 = ColumnName(3);
+  // Unsorted, with a duplicate and a column that does not exist.
+  std::vector<Slice> projection{col7, "missing", col3, col7};
+  for (size_t i = 0; i < entities_.size(); ++i) {
+    Slice input = entities_[i];
+    WideColumns expected_all;
+    ASSERT_OK(WideColumnSerialization::Deserialize(input, expected_all));
+    WideColumns expected;
+    for (const auto& column : expected_all) {
+      if (column.name() == col3 || column.name() == col7) {
+        expected.push_back(column);
+      }
+    }
+    WideColumns columns;
+    ASSERT_OK(
+        reader->GetEntity(static_cast<uint32_t>(i), &projection, &columns));
+    ASSERT_EQ(expected, columns);
+  }
+  // Only the two projected mini-pages were decoded.
+  uint64_t projected_bytes = reader->decoded_bytes();
+  ASSERT_GT(projected_bytes, 0);
+  ASSERT_LT(projected_bytes * 10, contents.size());
+
+  VerifyAll(reader.get());
+  ASSERT_GT(reader->decoded_bytes(), projected_bytes * 10);
+}
+
+TEST_F(ColumnarBlockTest, Compression) {
+  CompressionType type = kNoCompression;
+  for (auto t : GetSupportedCompressions()) {
+    if (t != kNoCompression) {
+      type = t;
+      break;
+    }
+  }
+  if (type == kNoCompression) {
+    ROCKSDB_GTEST_SKIP("No compression library available");
+    return;
+  }
+  BuildEntities(1000, 30);
+  std::string uncompressed;
+  Build(kNoCompression, &uncompressed);
+  std::string compressed;
+  Build(type, &compressed);
+  ASSERT_LT(compressed.size(), uncompressed.size());
+
+  std::unique_ptr<ColumnarBlockReader> reader;
+  ASSERT_OK(ColumnarBlockReader::Create(compressed, &reader));
+  VerifyAll(reader.get());
+}
+
+TEST_F(ColumnarBlockTest, Corruption) {
+  BuildEntities(50, 5);
+  std::string contents;
+  Build(kNoCompression, &contents);
+
+  std::unique_ptr<ColumnarBlockReader> reader;
+  for (size_t len : {size_t{0}, size_t{1}, contents.size() / 2,
+                     contents.size() - 1}) {
+    ASSERT_TRUE(ColumnarBlockReader::Create(Slice(contents.data(), len),
+                                            &reader)
+                    .IsCorruption());
+  }
+  contents.push_back('x');
+  ASSERT_TRUE(ColumnarBlockReader::Create(contents, &reader).IsCorruption());
+
+  // Damage a mini-page, which the reader only notices when it decodes it.
+  ColumnarBlockBuilder builder(kNoCompression, CompressionOptions());
+  uint32_t row = 0;
+  ASSERT_OK(builder.Add(Serialize(WideColumns{{"x", "abc"}}), &row));
+  std::string block;
+  builder.Finish(&block);
+  // The page is: num_values, row, value size, value.
+  ASSERT_EQ(std::string("\x01\x00\x03"
+                        "abc",
+                        6),
+            block.substr(block.size() - 6));
+  WideColumns columns;
+  for (size_t pos : {block.size() - 5, block.size() - 4}) {
+    std::string damaged = block;
+    damaged[pos] = 4;
+    ASSERT_OK(ColumnarBlockReader::Create(damaged, &reader));
+    ASSERT_TRUE(reader->GetEntity(0, nullptr, &columns).IsCorruption());
+  }
+  ASSERT_OK(ColumnarBlockReader::Create(block, &reader));
+  ASSERT_OK(reader->GetEntity(0, nullptr, &columns));
+  ASSERT_EQ((WideColumns{{"x", "abc"}}), columns);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -13,13 +13,15 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+// has_restart_fingerprints: whether the block stores restart fingerprints
+// (see restart_fingerprints.h).
 uint32_t PackIndexTypeAndNumRestarts(
     BlockBasedTableOptions::DataBlockIndexType index_type,
-    uint32_t num_restarts);
+    uint32_t num_restarts, bool has_restart_fingerprints = false);
 
 void UnPackIndexTypeAndNumRestarts(
     uint32_t block_footer,
     BlockBasedTableOptions::DataBlockIndexType* index_type,
-    uint32_t* num_restarts);
+    uint32_t* num_restarts, bool* has_restart_fingerprints = nullptr);
 
 }  // namespace ROCKSDB_NAMESPACE
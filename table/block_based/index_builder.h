@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cinttypes>
 #include <list>
 #include <string>
@@ -18,6 +19,7 @@
 #include "rocksdb/comparator.h"
 #include "table/block_based/block_based_table_factory.h"
 #include "table/block_based/block_builder.h"
+#include "table/block_based/learned_index.h"
 #include "table/format.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -419,6 +421,75 @@ class HashIndexBuilder : public IndexBuilder {
   uint64_t current_restart_index_ = 0;
 };
 
+// LearnedIndexBuilder builds a binary-searchable primary index and a metablock
+// holding a LearnedIndexModel of the user keys at its restart points. The
+// model is left out if the user comparator is not BytewiseComparator(), in
+// which case the table reads back as a plain binary search index.
+class LearnedIndexBuilder : public IndexBuilder {
+ public:
+  LearnedIndexBuilder(
+      const InternalKeyComparator* comparator, int index_block_restart_interval,
+      int format_version, bool use_value_delta_encoding,
+      BlockBasedTableOptions::IndexShorteningMode shortening_mode,
+      size_t ts_sz, const bool persist_user_defined_timestamps)
+      : IndexBuilder(comparator, ts_sz, persist_user_defined_timestamps),
+        primary_index_builder_(comparator, index_block_restart_interval,
+                               format_version, use_value_delta_encoding,
+                               shortening_mode, /* include_first_key */ false,
+                               ts_sz, persist_user_defined_timestamps),
+        index_block_restart_interval_(
+            std::max(index_block_restart_interval, 1)),
+        build_model_(comparator->user_comparator() == BytewiseComparator()),
+        model_builder_(kErrorBound) {}
+
+  void AddIndexEntry(std::string* last_key_in_current_block,
+                     const Slice* first_key_in_next_block,
+                     const BlockHandle& block_handle) override {
+    primary_index_builder_.AddIndexEntry(last_key_in_current_block,
+                                         first_key_in_next_block, block_handle);
+    // The primary index builder has replaced the key with the separator.
+    if (build_model_ && num_entries_ % index_block_restart_interval_ == 0) {
+      model_builder_.Add(ExtractUserKey(*last_key_in_current_block));
+    }
+    ++num_entries_;
+  }
+
+  void OnKeyAdded(const Slice& key) override {
+    primary_index_builder_.OnKeyAdded(key);
+  }
+
+  Status Finish(IndexBlocks* index_blocks,
+                const BlockHandle& last_partition_block_handle) override {
+    Status s = primary_index_builder_.Finish(index_blocks,
+                                             last_partition_block_handle);
+    if (build_model_ && model_builder_.Finish(&model_block_)) {
+      index_blocks->meta_blocks.insert(
+          {kLearnedIndexBlock.c_str(), model_block_});
+    }
+    return s;
+  }
+
+  size_t IndexSize() const override {
+    return primary_index_builder_.IndexSize() + model_block_.size();
+  }
+
+  bool seperator_is_key_plus_seq() override {
+    return primary_index_builder_.seperator_is_key_plus_seq();
+  }
+
+ private:
+  // Maximum distance between the restart point the model predicts for a
+  // restart key and its actual position.
+  static constexpr uint32_t kErrorBound = 4;
+
+  ShortenedIndexBuilder primary_index_builder_;
+  const int index_block_restart_interval_;
+  const bool build_model_;
+  LearnedIndexModel::Builder model_builder_;
+  std::string model_block_;
+  uint64_t num_entries_ = 0;
+};
+
 /**
  * IndexBuilder for two-level indexing. Internally it creates a new index for
  * each partition and Finish then in order when Finish is called on it
@@ -0,0 +1,74 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/key_prefix_dict.h"
+
+#include <cassert>
+
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+KeyPrefixDictBuilder::KeyPrefixDictBuilder(
+    const SliceTransform* prefix_extractor, size_t max_bytes)
+    : prefix_extractor_(prefix_extractor), max_bytes_(max_bytes) {
+  assert(prefix_extractor_ != nullptr);
+}
+
+uint32_t KeyPrefixDictBuilder::FindOrAdd(const Slice& user_key,
+                                         size_t* prefix_size) {
+  *prefix_size = 0;
+  if (!prefix_extractor_->InDomain(user_key)) {
+    return 0;
+  }
+  const Slice prefix = prefix_extractor_->Transform(user_key);
+  uint32_t id = 0;
+  if (last_id_ != 0 && prefix == Slice(last_prefix_)) {
+    id = last_id_;
+  } else {
+    std::string prefix_str = prefix.ToString();
+    auto it = ids_.find(prefix_str);
+    if (it != ids_.end()) {
+      id = it->second;
+    } else {
+      const size_t entry_size = VarintLength(prefix.size()) + prefix.size();
+      if (contents_.size() + entry_size > max_bytes_) {
+        return 0;
+      }
+      id = static_cast<uint32_t>(ids_.size() + 1);
+      // Referencing a prefix only pays off if it is longer than its id.
+      if (prefix.size() <= static_cast<size_t>(VarintLength(id))) {
+        return 0;
+      }
+      PutLengthPrefixedSlice(&contents_, prefix);
+      ids_.emplace(prefix_str, id);
+    }
+    last_prefix_ = std::move(prefix_str);
+    last_id_ = id;
+  }
+  if (prefix.size() <= static_cast<size_t>(VarintLength(id))) {
+    return 0;
+  }
+  *prefix_size = prefix.size();
+  return id;
+}
+
+Status KeyPrefixDict::Create(const Slice& contents,
+                             std::unique_ptr<KeyPrefixDict>* dict) {
+  std::unique_ptr<KeyPrefixDict> result(new KeyPrefixDict());
+  result->contents_ = contents.ToString();
+  Slice input = result->contents_;
+  while (!input.empty()) {
+    Slice prefix;
+    if (!GetLengthPrefixedSlice(&input, &prefix)) {
+      return Status::Corruption("Bad key prefix dictionary");
+    }
+    result->prefixes_.push_back(prefix);
+  }
+  *dict = std::move(result);
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,94 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/slice_transform.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Key prefix dictionary of a block-based table written with
+// BlockBasedTableOptions::data_block_key_prefix_dict_max_bytes > 0.
+//
+// In the data blocks of such a table, every key that is not delta encoded
+// against the previous key (shared == 0, which includes all restart keys)
+// starts with the varint32 id of a dictionary entry, followed by the key
+// without that entry's prefix. Id 0 is the empty prefix. Other ids number
+// the entries of the kKeyPrefixDictBlock meta block from 1, in the order
+// they are stored:
+//
+//   prefix_1: varint32 length + bytes
+//   prefix_2: varint32 length + bytes
+//   ...
+//
+// The dictionary is append-only while the table is built, so the ids used
+// by data blocks that are already written stay valid.
+class KeyPrefixDictBuilder {
+ public:
+  // Dictionary entries are prefix_extractor prefixes of user keys. Once the
+  // serialized dictionary reaches max_bytes, new prefixes are not added.
+  KeyPrefixDictBuilder(const SliceTransform* prefix_extractor,
+                       size_t max_bytes);
+
+  // Returns the id of the dictionary prefix to strip from a key with user
+  // key `user_key`, and sets *prefix_size to the prefix's size. Adds the
+  // key's prefix to the dictionary if it is new and fits.
+  uint32_t FindOrAdd(const Slice& user_key, size_t* prefix_size);
+
+  // The dictionary in the meta block format.
+  Slice contents() const { return contents_; }
+
+  size_t NumEntries() const { return ids_.size(); }
+
+ private:
+  const SliceTransform* prefix_extractor_;
+  const size_t max_bytes_;
+  std::string contents_;
+  std::unordered_map<std::string, uint32_t> ids_;
+  // Consecutive keys mostly share their prefix, so the last lookup is
+  // checked before ids_.
+  std::string last_prefix_;
+  uint32_t last_id_ = 0;
+};
+
+class KeyPrefixDict {
+ public:
+  // Parses the contents of a kKeyPrefixDictBlock meta block.
+  static Status Create(const Slice& contents,
+                       std::unique_ptr<KeyPrefixDict>* dict);
+
+  // Sets *prefix to the prefix with the given id. Returns false if there is
+  // no such id.
+  bool Get(uint32_t id, Slice* prefix) const {
+    if (id == 0) {
+      *prefix = Slice();
+      return true;
+    } else if (id > prefixes_.size()) {
+      return false;
+    }
+    *prefix = prefixes_[id - 1];
+    return true;
+  }
+
+  size_t NumEntries() const { return prefixes_.size(); }
+
+  size_t ApproximateMemoryUsage() const {
+    return sizeof(*this) + contents_.capacity() +
+           prefixes_.capacity() * sizeof(Slice);
+  }
+
+ private:
+  std::string contents_;
+  std::vector<Slice> prefixes_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
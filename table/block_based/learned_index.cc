@@ -0,0 +1,213 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/learned_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Reads up to 8 bytes of `data` as a big-endian integer, padding with zeros.
+uint64_t DecodeProjection(const char* data, size_t size) {
+  uint64_t x = 0;
+  for (size_t i = 0; i < 8; ++i) {
+    x <<= 8;
+    if (i < size) {
+      x |= static_cast<unsigned char>(data[i]);
+    }
+  }
+  return x;
+}
+
+size_t SharedPrefixLength(const Slice& a, const Slice& b) {
+  size_t n = std::min(a.size(), b.size());
+  size_t i = 0;
+  while (i < n && a[i] == b[i]) {
+    ++i;
+  }
+  return i;
+}
+}  // namespace
+
+void LearnedIndexModel::Builder::Add(const Slice& user_key) {
+  if (points_.empty()) {
+    first_key_.assign(user_key.data(), user_key.size());
+  }
+  size_t shared = SharedPrefixLength(first_key_, user_key);
+  size_t tail = std::min<size_t>(8, user_key.size() - shared);
+  points_.emplace_back(static_cast<uint32_t>(shared),
+                       std::string(user_key.data() + shared, tail));
+}
+
+bool LearnedIndexModel::Builder::Finish(std::string* contents) {
+  if (points_.empty()) {
+    return false;
+  }
+  size_t prefix_len = first_key_.size();
+  for (const auto& point : points_) {
+    prefix_len = std::min<size_t>(prefix_len, point.first);
+  }
+
+  // Project every key. Bytes between the common prefix and the point where a
+  // key diverges from the first key are the first key's bytes. Runs of keys
+  // with the same projection are collapsed to their last index.
+  std::vector<std::pair<uint64_t, uint32_t>> xs;
+  xs.reserve(points_.size());
+  for (size_t i = 0; i < points_.size(); ++i) {
+    char buf[8];
+    size_t n = 0;
+    for (size_t j = prefix_len; j < points_[i].first && n < 8; ++j) {
+      buf[n++] = first_key_[j];
+    }
+    const std::string& tail = points_[i].second;
+    for (size_t j = 0; j < tail.size() && n < 8; ++j) {
+      buf[n++] = tail[j];
+    }
+    uint64_t x = DecodeProjection(buf, n);
+    if (!xs.empty() && x < xs.back().first) {
+      // Keys were not added in bytewise order.
+      return false;
+    }
+    if (!xs.empty() && x == xs.back().first) {
+      xs.back().second = static_cast<uint32_t>(i);
+    } else {
+      xs.emplace_back(x, static_cast<uint32_t>(i));
+    }
+  }
+
+  // Greedy fit: extend the current segment while some slope keeps every
+  // point in it within error_bound_ of its index.
+  std::vector<Segment> segments;
+  const double eps = static_cast<double>(error_bound_);
+  double lo = 0;
+  double hi = 0;
+  // Any slope in [lo, hi] fits; a negative one is never needed since
+  // indexes only grow.
+  auto fitted_slope = [&]() {
+    return std::isinf(hi) ? 0.0 : std::max(0.0, (lo + hi) / 2);
+  };
+  for (size_t i = 0; i < xs.size(); ++i) {
+    if (!segments.empty()) {
+      const Segment& seg = segments.back();
+      double dx = static_cast<double>(xs[i].first - seg.start_x);
+      double dy = static_cast<double>(xs[i].second - seg.start_index);
+      double new_lo = std::max(lo, (dy - eps) / dx);
+      double new_hi = std::min(hi, (dy + eps) / dx);
+      if (new_lo <= new_hi) {
+        lo = new_lo;
+        hi = new_hi;
+        continue;
+      }
+      segments.back().slope = fitted_slope();
+    }
+    segments.push_back({xs[i].first, xs[i].second, 0});
+    lo = -std::numeric_limits<double>::infinity();
+    hi = std::numeric_limits<double>::infinity();
+  }
+  segments.back().slope = fitted_slope();
+
+  PutLengthPrefixedSlice(contents, Slice(first_key_.data(), prefix_len));
+  PutVarint32(contents, error_bound_);
+  PutVarint32(contents, static_cast<uint32_t>(points_.size()));
+  PutVarint32(contents, static_cast<uint32_t>(segments.size()));
+  for (const auto& seg : segments) {
+    uint64_t slope_bits;
+    static_assert(sizeof(slope_bits) == sizeof(seg.slope), "");
+    memcpy(&slope_bits, &seg.slope, sizeof(slope_bits));
+    PutFixed64(contents, seg.start_x);
+    PutFixed32(contents, seg.start_index);
+    PutFixed64(contents, slope_bits);
+  }
+  return true;
+}
+
+Status LearnedIndexModel::Create(const Slice& contents,
+                                 std::unique_ptr<LearnedIndexModel>* model) {
+  Slice input = contents;
+  Slice common_prefix;
+  uint32_t error_bound = 0;
+  uint32_t num_points = 0;
+  uint32_t num_segments = 0;
+  if (!GetLengthPrefixedSlice(&input, &common_prefix) ||
+      !GetVarint32(&input, &error_bound) || !GetVarint32(&input, &num_points) ||
+      !GetVarint32(&input, &num_segments) || num_segments == 0 ||
+      input.size() != static_cast<uint64_t>(num_segments) * 20) {
+    return Status::Corruption("Corrupted learned index block");
+  }
+
+  std::unique_ptr<LearnedIndexModel> new_model(new LearnedIndexModel());
+  new_model->common_prefix_ = common_prefix.ToString();
+  new_model->error_bound_ = error_bound;
+  new_model->num_points_ = num_points;
+  new_model->segments_.reserve(num_segments);
+  for (uint32_t i = 0; i < num_segments; ++i) {
+    Segment seg{};
+    uint64_t slope_bits = 0;
+    if (!GetFixed64(&input, &seg.start_x) ||
+        !GetFixed32(&input, &seg.start_index) ||
+        !GetFixed64(&input, &slope_bits)) {
+      return Status::Corruption("Corrupted learned index block");
+    }
+    memcpy(&seg.slope, &slope_bits, sizeof(seg.slope));
+    bool ordered = new_model->segments_.empty() ||
+                   (seg.start_x > new_model->segments_.back().start_x &&
+                    seg.start_index > new_model->segments_.back().start_index);
+    if (!ordered || seg.start_index >= num_points || !(seg.slope >= 0) ||
+        std::isinf(seg.slope)) {
+      return Status::Corruption("Corrupted learned index block");
+    }
+    new_model->segments_.push_back(seg);
+  }
+  *model = std::move(new_model);
+  return Status::OK();
+}
+
+uint64_t LearnedIndexModel::Project(const Slice& user_key) const {
+  size_t n = std::min(user_key.size(), common_prefix_.size());
+  int cmp = memcmp(user_key.data(), common_prefix_.data(), n);
+  if (cmp < 0 || (cmp == 0 && user_key.size() < common_prefix_.size())) {
+    return 0;
+  } else if (cmp > 0) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  return DecodeProjection(user_key.data() + n, user_key.size() - n);
+}
+
+bool LearnedIndexModel::Predict(const Slice& user_key, uint32_t num_restarts,
+                                uint32_t* first, uint32_t* last) const {
+  if (num_points_ != num_restarts || num_restarts == 0) {
+    return false;
+  }
+  uint64_t x = Project(user_key);
+  auto it = std::upper_bound(
+      segments_.begin(), segments_.end(), x,
+      [](uint64_t v, const Segment& seg) { return v < seg.start_x; });
+  if (it == segments_.begin()) {
+    // Smaller than every restart key.
+    *first = *last = 0;
+    return true;
+  }
+  uint32_t limit = it == segments_.end() ? num_restarts - 1 : it->start_index;
+  --it;
+  double pred = static_cast<double>(it->start_index) +
+                it->slope * static_cast<double>(x - it->start_x);
+  pred = std::min(pred, static_cast<double>(limit));
+  // A key between two restart keys belongs to the earlier one, so the window
+  // reaches one restart point further back than the error bound.
+  int64_t lower = static_cast<int64_t>(std::floor(pred)) - error_bound_ - 1;
+  int64_t upper = static_cast<int64_t>(std::ceil(pred)) + error_bound_;
+  *first = static_cast<uint32_t>(std::max<int64_t>(lower, 0));
+  *last = static_cast<uint32_t>(
+      std::min<int64_t>(upper, static_cast<int64_t>(num_restarts) - 1));
+  return true;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
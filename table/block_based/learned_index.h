@@ -0,0 +1,95 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A piecewise-linear model of the restart keys of an index block, used by
+// BlockBasedTableOptions::kLearnedIndexSearch. It maps a user key to a small
+// window of restart points that holds the last restart key <= the user key,
+// so that a seek only binary searches that window instead of all restart
+// points.
+//
+// Keys are projected to the 8 bytes that follow the prefix shared by all
+// restart keys, read as a big-endian integer, which preserves bytewise order.
+// The model is only built for tables using BytewiseComparator().
+//
+// Contents of the metablock:
+//   common_prefix: varstring
+//   error_bound: varint32
+//   num_points: varint32
+//   num_segments: varint32
+//   segment[num_segments] :=
+//     start_x: fixed64
+//     start_index: fixed32
+//     slope: fixed64 (bits of a double)
+class LearnedIndexModel {
+ public:
+  // Collects the restart keys of an index block and fits the model to them.
+  class Builder {
+   public:
+    // error_bound: maximum distance between the restart index the model
+    // predicts for a restart key and its actual index.
+    explicit Builder(uint32_t error_bound) : error_bound_(error_bound) {}
+
+    // Adds the user key of the next restart point. Keys must be added in
+    // ascending bytewise order.
+    void Add(const Slice& user_key);
+
+    // Returns false if there is no usable model, e.g. when no key was added.
+    bool Finish(std::string* contents);
+
+   private:
+    const uint32_t error_bound_;
+    std::string first_key_;
+    // For each key, the length of the prefix it shares with the first key
+    // and up to 8 bytes that follow it.
+    std::vector<std::pair<uint32_t, std::string>> points_;
+  };
+
+  static Status Create(const Slice& contents,
+                       std::unique_ptr<LearnedIndexModel>* model);
+
+  // Returns in [*first, *last] the window of restart points that holds the
+  // last restart key <= user_key according to the model, or returns false if
+  // the model does not apply to an index block with num_restarts restart
+  // points. The window is only a prediction; the caller must check it.
+  bool Predict(const Slice& user_key, uint32_t num_restarts, uint32_t* first,
+               uint32_t* last) const;
+
+  size_t ApproximateMemoryUsage() const {
+    return sizeof(LearnedIndexModel) + common_prefix_.size() +
+           segments_.capacity() * sizeof(Segment);
+  }
+
+ private:
+  struct Segment {
+    uint64_t start_x;
+    uint32_t start_index;
+    double slope;
+  };
+
+  LearnedIndexModel() = default;
+
+  uint64_t Project(const Slice& user_key) const;
+
+  std::string common_prefix_;
+  uint32_t error_bound_ = 0;
+  uint32_t num_points_ = 0;
+  std::vector<Segment> segments_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -29,15 +29,22 @@ Status VerifyBlockChecksum(const Footer& footer, const char* data,
   PERF_TIMER_GUARD(block_checksum_time);
 
   assert(footer.GetBlockTrailerSize() == 5);
-  ChecksumType type = footer.checksum_type();
-
   // After block_size bytes is compression type (1 byte), which is part of
   // the checksummed section.
-  size_t len = block_size + 1;
-  // And then the stored checksum value (4 bytes).
-  uint32_t stored = DecodeFixed32(data + len);
+  uint32_t computed =
+      ComputeBuiltinChecksum(footer.checksum_type(), data, block_size + 1);
+  return CheckBlockChecksum(footer, data, block_size, computed, file_name,
+                            offset);
+}
+
+Status CheckBlockChecksum(const Footer& footer, const char* data,
+                          size_t block_size, uint32_t computed,
+                          const std::string& file_name, uint64_t offset) {
+  assert(footer.GetBlockTrailerSize() == 5);
+  ChecksumType type = footer.checksum_type();
 
-  uint32_t computed = ComputeBuiltinChecksum(type, data, len);
+  // The stored checksum value (4 bytes) follows the compression type.
+  uint32_t stored = DecodeFixed32(data + block_size + 1);
 
   // Unapply context to 'stored' rather than apply to 'computed, for people
   // who might look for reference crc value in error message
@@ -33,4 +33,10 @@ inline MemoryAllocator* GetMemoryAllocator(
 Status VerifyBlockChecksum(const Footer& footer, const char* data,
                            size_t block_size, const std::string& file_name,
                            uint64_t offset);
+
+// Like VerifyBlockChecksum(), for a checksum of the block and its compression
+// type that the caller `computed` already, e.g. while uncompressing it.
+Status CheckBlockChecksum(const Footer& footer, const char* data,
+                          size_t block_size, uint32_t computed,
+                          const std::string& file_name, uint64_t offset);
 }  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,62 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/restart_fingerprints.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "util/coding_lean.h"
+#include "util/math.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Runs this short are counted with a linear scan rather than halved further.
+// 16 fingerprints span two cache lines.
+constexpr uint32_t kLinearScanLength = 16;
+
+inline uint64_t FingerprintAt(const char* fingerprints, uint32_t i) {
+  return DecodeFixed64(fingerprints + i * sizeof(uint64_t));
+}
+}  // namespace
+
+uint32_t CountRestartFingerprintsLessThan(const char* fingerprints,
+                                          uint32_t n, uint64_t fp) {
+  // Branch-free halving: the answer stays in [lo, lo + len].
+  uint32_t lo = 0;
+  uint32_t len = n;
+  while (len > kLinearScanLength) {
+    uint32_t half = len / 2;
+    lo = FingerprintAt(fingerprints, lo + half - 1) < fp ? lo + half : lo;
+    len -= half;
+  }
+
+  const char* run = fingerprints + lo * sizeof(uint64_t);
+  uint32_t count = 0;
+  uint32_t i = 0;
+#ifdef __AVX2__
+  // AVX2 only compares signed 64-bit integers, so flip the sign bits.
+  const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+  const __m256i target =
+      _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(fp)), sign);
+  for (; i + 4 <= len; i += 4) {
+    __m256i v = _mm256_xor_si256(
+        _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(run + i * sizeof(uint64_t))),
+        sign);
+    __m256i less = _mm256_cmpgt_epi64(target, v);
+    count += static_cast<uint32_t>(
+        BitsSetToOne(_mm256_movemask_pd(_mm256_castsi256_pd(less))));
+  }
+#endif
+  for (; i < len; ++i) {
+    count += FingerprintAt(run, i) < fp;
+  }
+  return lo + count;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
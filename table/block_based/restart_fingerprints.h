@@ -0,0 +1,45 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+
+#include "rocksdb/slice.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Restart fingerprints are an optional section of a data block, written
+// after the restart array when
+// BlockBasedTableOptions::data_block_restart_fingerprints is set:
+//
+//     restarts: uint32[num_restarts]
+//     fingerprints: fixed64[num_restarts]
+//     (optional hash index)
+//     footer: uint32
+//
+// The fingerprint of a restart key is the first 8 bytes of its user key
+// read as a big-endian integer, zero padded. Under BytewiseComparator() a
+// smaller fingerprint means a smaller key, so a seek can find the restart
+// interval from the fingerprints alone, comparing keys only among restart
+// points whose fingerprint equals the target's.
+
+inline uint64_t RestartKeyFingerprint(const Slice& user_key) {
+  uint64_t fp = 0;
+  for (size_t i = 0; i < sizeof(fp); ++i) {
+    fp <<= 8;
+    if (i < user_key.size()) {
+      fp |= static_cast<unsigned char>(user_key[i]);
+    }
+  }
+  return fp;
+}
+
+// Returns how many of the `n` ascending fingerprints stored at
+// `fingerprints` are less than `fp`.
+uint32_t CountRestartFingerprintsLessThan(const char* fingerprints,
+                                          uint32_t n, uint64_t fp);
+
+}  // namespace ROCKSDB_NAMESPACE
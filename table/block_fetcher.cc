@@ -29,10 +29,23 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+// A corrupt block must not reach the persistent cache, and a file system
+// that can reconstruct corrupt reads needs to hear about the corruption
+// before the block is uncompressed.
+inline bool BlockFetcher::CanDeferChecksum() const {
+  return read_options_.fuse_checksum_with_decompression && do_uncompress_ &&
+         !retry_corrupt_read_ && cache_options_.persistent_cache == nullptr &&
+         CanUncompressSerializedBlockWithChecksum(
+             footer_.checksum_type(), compression_type_, uncompression_dict_);
+}
+
 inline void BlockFetcher::ProcessTrailerIfPresent() {
   if (footer_.GetBlockTrailerSize() > 0) {
     assert(footer_.GetBlockTrailerSize() == BlockBasedTable::kBlockTrailerSize);
-    if (read_options_.verify_checksums) {
+    compression_type_ =
+        BlockBasedTable::GetBlockCompressionType(slice_.data(), block_size_);
+    checksum_deferred_ = read_options_.verify_checksums && CanDeferChecksum();
+    if (read_options_.verify_checksums && !checksum_deferred_) {
       io_status_ = status_to_io_status(
           VerifyBlockChecksum(footer_, slice_.data(), block_size_,
                               file_->file_name(), handle_.offset()));
@@ -42,8 +55,6 @@ inline void BlockFetcher::ProcessTrailerIfPresent() {
         RecordTick(ioptions_.stats, BLOCK_CHECKSUM_MISMATCH_COUNT);
       }
     }
-    compression_type_ =
-        BlockBasedTable::GetBlockCompressionType(slice_.data(), block_size_);
   } else {
     // E.g. plain table or cuckoo table
     compression_type_ = kNoCompression;
@@ -238,6 +249,39 @@ inline void BlockFetcher::GetBlockContents() {
 #endif
 }
 
+// Uncompress the block in slice_ into contents_, verifying its checksum on
+// the way if ProcessTrailerIfPresent() deferred that.
+void BlockFetcher::UncompressBlock() {
+  PERF_TIMER_GUARD(block_decompress_time);
+  // compressed page, uncompress, update cache
+  UncompressionContext context(compression_type_);
+  UncompressionInfo info(context, uncompression_dict_, compression_type_);
+  if (checksum_deferred_) {
+    uint32_t computed = 0;
+    Status s = UncompressSerializedBlockWithChecksum(
+        info, slice_.data(), block_size_, footer_.checksum_type(), contents_,
+        &computed, ioptions_, memory_allocator_);
+    RecordTick(ioptions_.stats, BLOCK_CHECKSUM_COMPUTE_COUNT);
+    Status checksum_status =
+        CheckBlockChecksum(footer_, slice_.data(), block_size_, computed,
+                           file_->file_name(), handle_.offset());
+    if (!checksum_status.ok()) {
+      RecordTick(ioptions_.stats, BLOCK_CHECKSUM_MISMATCH_COUNT);
+      s.PermitUncheckedError();
+      *contents_ = BlockContents();
+      s = std::move(checksum_status);
+    }
+    io_status_ = status_to_io_status(std::move(s));
+  } else {
+    io_status_ = status_to_io_status(UncompressSerializedBlock(
+        info, slice_.data(), block_size_, contents_, footer_.format_version(),
+        ioptions_, memory_allocator_));
+  }
+#ifndef NDEBUG
+  num_heap_buf_memcpy_++;
+#endif
+}
+
 // Read a block from the file and verify its checksum. Upon return, io_status_
 // will be updated with the status of the read, and slice_ will be updated
 // with a pointer to the data.
@@ -374,16 +418,7 @@ IOStatus BlockFetcher::ReadBlockContents() {
   }
 
   if (do_uncompress_ && compression_type_ != kNoCompression) {
-    PERF_TIMER_GUARD(block_decompress_time);
-    // compressed page, uncompress, update cache
-    UncompressionContext context(compression_type_);
-    UncompressionInfo info(context, uncompression_dict_, compression_type_);
-    io_status_ = status_to_io_status(UncompressSerializedBlock(
-        info, slice_.data(), block_size_, contents_, footer_.format_version(),
-        ioptions_, memory_allocator_));
-#ifndef NDEBUG
-    num_heap_buf_memcpy_++;
-#endif
+    UncompressBlock();
     // Save the compressed block without trailer
     slice_ = Slice(slice_.data(), block_size_);
   } else {
@@ -432,17 +467,7 @@ IOStatus BlockFetcher::ReadAsyncBlockContents() {
         used_buf_ = const_cast<char*>(slice_.data());
 
         if (do_uncompress_ && compression_type_ != kNoCompression) {
-          PERF_TIMER_GUARD(block_decompress_time);
-          // compressed page, uncompress, update cache
-          UncompressionContext context(compression_type_);
-          UncompressionInfo info(context, uncompression_dict_,
-                                 compression_type_);
-          io_status_ = status_to_io_status(UncompressSerializedBlock(
-              info, slice_.data(), block_size_, contents_,
-              footer_.format_version(), ioptions_, memory_allocator_));
-#ifndef NDEBUG
-          num_heap_buf_memcpy_++;
-#endif
+          UncompressBlock();
         } else {
           GetBlockContents();
         }
@@ -30,7 +30,9 @@ namespace ROCKSDB_NAMESPACE {
 //
 // Two read options affect the behavior of BlockFetcher: if verify_checksums is
 // true, the checksum of the (original) block is checked; if fill_cache is true,
-// the block is added to the persistent cache if needed.
+// the block is added to the persistent cache if needed. With
+// fuse_checksum_with_decompression, the checksum of a block that is
+// uncompressed is checked while uncompressing it, where supported.
 //
 // Memory for uncompressed and compressed blocks is allocated as needed
 // using memory_allocator and memory_allocator_compressed, respectively
@@ -137,6 +139,9 @@ class BlockFetcher {
   bool for_compaction_ = false;
   bool use_fs_scratch_ = false;
   bool retry_corrupt_read_ = false;
+  // Whether the checksum is verified while uncompressing the block, see
+  // ReadOptions::fuse_checksum_with_decompression
+  bool checksum_deferred_ = false;
 
   // return true if found
   bool TryGetUncompressBlockFromPersistentCache();
@@ -152,6 +157,8 @@ class BlockFetcher {
   void InsertCompressedBlockToPersistentCacheIfNeeded();
   void InsertUncompressedBlockToPersistentCacheIfNeeded();
   void ProcessTrailerIfPresent();
+  bool CanDeferChecksum() const;
+  void UncompressBlock();
   void ReadBlock(bool retry, FSAllocationPtr& fs_buf);
 
   void ReleaseFileSystemProvidedBuffer(FSReadRequest* read_req) {
@@ -18,6 +18,8 @@
 #include "table/block_based/block_based_table_reader.h"
 #include "table/format.h"
 #include "test_util/testharness.h"
+#include "test_util/testutil.h"
+#include "util/random.h"
 #include "utilities/memory_allocators.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -210,6 +212,46 @@ class BlockFetcherTest : public testing::Test {
     }
   }
 
+  // Fetches and uncompresses the first data block of `table_name`, with
+  // ReadOptions::fuse_checksum_with_decompression set to `fuse_checksum`.
+  // `corrupt_offset`, if set, is the offset in the block of a byte to flip
+  // before reading it.
+  void FetchFirstDataBlockVerifyingChecksum(
+      const std::string& table_name, bool fuse_checksum,
+      std::optional<size_t> corrupt_offset, Statistics* stats,
+      std::string* result, Status* s) {
+    BlockHandle handle;
+    GetFirstDataBlockHandle(table_name, &handle);
+    std::string file_name = table_name;
+    if (corrupt_offset.has_value()) {
+      std::string contents;
+      ASSERT_OK(ReadFileToString(env_, Path(table_name), &contents));
+      ASSERT_LT(*corrupt_offset, handle.size());
+      contents[handle.offset() + *corrupt_offset] ^= 0x40;
+      file_name = table_name + "_corrupt";
+      WriteToFile(contents, file_name);
+    }
+
+    ImmutableOptions ioptions(options_);
+    ioptions.stats = stats;
+    ReadOptions roptions;
+    roptions.fuse_checksum_with_decompression = fuse_checksum;
+    PersistentCacheOptions persistent_cache_options;
+    std::unique_ptr<RandomAccessFileReader> file;
+    NewFileReader(file_name, FileOptions(options_), &file);
+    Footer footer;
+    ReadFooter(file.get(), &footer);
+    ASSERT_EQ(footer.checksum_type(), kXXH3);
+    BlockContents contents;
+    BlockFetcher fetcher(file.get(), nullptr /* prefetch_buffer */, footer,
+                         roptions, handle, &contents, ioptions,
+                         true /* do_uncompress */, true /* maybe_compressed */,
+                         BlockType::kData, UncompressionDict::GetEmptyDict(),
+                         persistent_cache_options);
+    *s = fetcher.ReadBlockContents();
+    result->assign(contents.data.ToString());
+  }
+
   void SetMode(Mode mode) {
     switch (mode) {
       case Mode::kBufferedRead:
@@ -348,6 +390,23 @@ class BlockFetcherTest : public testing::Test {
                            MemoryAllocator* compressed_buf_allocator,
                            BlockContents* block, std::string* result,
                            MemcpyStats* memcpy_stats) {
+    BlockHandle first_block_handle;
+    GetFirstDataBlockHandle(table_name, &first_block_handle);
+
+    // Fetch first data block.
+    FileOptions foptions(options_);
+    std::unique_ptr<RandomAccessFileReader> file;
+    NewFileReader(table_name, foptions, &file);
+    CompressionType compression_type;
+    FetchBlock(file.get(), first_block_handle, BlockType::kData, compressed,
+               do_uncompress, heap_buf_allocator, compressed_buf_allocator,
+               block, memcpy_stats, &compression_type);
+    ASSERT_EQ(compression_type, expected_compression_type);
+    result->assign(block->data.ToString());
+  }
+
+  void GetFirstDataBlockHandle(const std::string& table_name,
+                               BlockHandle* handle) {
     ImmutableOptions ioptions(options_);
     InternalKeyComparator comparator(options_.comparator);
     FileOptions foptions(options_);
@@ -369,17 +428,8 @@ class BlockFetcherTest : public testing::Test {
             nullptr /* get_context */, nullptr /* lookup_context */));
     ASSERT_OK(iter->status());
     iter->SeekToFirst();
-    BlockHandle first_block_handle = iter->value().handle;
-
-    // Fetch first data block.
-    std::unique_ptr<RandomAccessFileReader> file;
-    NewFileReader(table_name, foptions, &file);
-    CompressionType compression_type;
-    FetchBlock(file.get(), first_block_handle, BlockType::kData, compressed,
-               do_uncompress, heap_buf_allocator, compressed_buf_allocator,
-               block, memcpy_stats, &compression_type);
-    ASSERT_EQ(compression_type, expected_compression_type);
-    result->assign(block->data.ToString());
+    ASSERT_TRUE(iter->Valid());
+    *handle = iter->value().handle;
   }
 };
 
@@ -529,6 +579,121 @@ TEST_F(BlockFetcherTest, FetchAndUncompressCompressedDataBlock) {
                      expected_stats_by_mode);
 }
 
+// Data blocks are compressed with ZSTD and checksummed with XXH3,
+// fetch and uncompress data block, verifying the checksum while
+// uncompressing.
+// Expects:
+// 1. the same block as with the checksum verified beforehand;
+// 2. a corrupt block is reported as a checksum mismatch, whether or not
+//    the decompressor also fails on it.
+TEST_F(BlockFetcherTest, FetchAndUncompressVerifyingChecksum) {
+  if (!ZSTD_Supported() || !ZSTD_StreamingUncompressSupported()) {
+    ROCKSDB_GTEST_SKIP("Test requires ZSTD streaming decompression");
+    return;
+  }
+  const std::string table_name = "FetchAndUncompressVerifyingChecksum";
+  CreateTable(table_name, kZSTD);
+
+  for (int i = 0; i < NumModes; ++i) {
+    SetMode(static_cast<Mode>(i));
+    std::string expected;
+    std::string block;
+    Status s;
+    FetchFirstDataBlockVerifyingChecksum(table_name, false /* fuse_checksum */,
+                                         std::nullopt, nullptr, &expected, &s);
+    ASSERT_OK(s);
+    ASSERT_FALSE(expected.empty());
+
+    std::shared_ptr<Statistics> stats = CreateDBStatistics();
+    FetchFirstDataBlockVerifyingChecksum(table_name, true /* fuse_checksum */,
+                                         std::nullopt, stats.get(), &block, &s);
+    ASSERT_OK(s);
+    ASSERT_EQ(expected, block);
+    ASSERT_EQ(stats->getTickerCount(BLOCK_CHECKSUM_COMPUTE_COUNT), 1);
+    ASSERT_EQ(stats->getTickerCount(BLOCK_CHECKSUM_MISMATCH_COUNT), 0);
+    ASSERT_EQ(stats->getTickerCount(NUMBER_BLOCK_DECOMPRESSED), 1);
+
+    // Corrupt the size header, the ZSTD magic number and the frame header
+    for (size_t offset : {size_t{0}, size_t{2}, size_t{6}}) {
+      stats = CreateDBStatistics();
+      FetchFirstDataBlockVerifyingChecksum(table_name, true /* fuse_checksum */,
+                                           offset, stats.get(), &block, &s);
+      ASSERT_TRUE(s.IsCorruption()) << s.ToString();
+      ASSERT_NE(s.ToString().find("block checksum mismatch"),
+                std::string::npos)
+          << s.ToString();
+      ASSERT_TRUE(block.empty());
+      ASSERT_EQ(stats->getTickerCount(BLOCK_CHECKSUM_COMPUTE_COUNT), 1);
+      ASSERT_EQ(stats->getTickerCount(BLOCK_CHECKSUM_MISMATCH_COUNT), 1);
+    }
+  }
+}
+
+// A block larger than the pieces it is uncompressed in gets the same contents
+// and checksum as uncompressing it and checksumming it separately, also when
+// it is corrupt.
+TEST_F(BlockFetcherTest, UncompressSerializedBlockWithChecksum) {
+  if (!ZSTD_Supported() || !ZSTD_StreamingUncompressSupported()) {
+    ROCKSDB_GTEST_SKIP("Test requires ZSTD streaming decompression");
+    return;
+  }
+  Random rnd(301);
+  std::string raw;
+  test::CompressibleString(&rnd, 0.5, 256 << 10, &raw);
+  CompressionOptions opts;
+  CompressionContext compression_ctx(kZSTD, opts);
+  CompressionInfo compression_info(opts, compression_ctx,
+                                   CompressionDict::GetEmptyDict(), kZSTD,
+                                   0 /* sample_for_compression */);
+  std::string block;
+  ASSERT_TRUE(CompressData(raw, compression_info,
+                           GetCompressFormatForVersion(kLatestFormatVersion),
+                           &block));
+  // More than one piece
+  ASSERT_GT(block.size(), size_t{64} << 10);
+  // Trailer
+  block.push_back(static_cast<char>(kZSTD));
+  block.append(4, '\0');
+  const size_t size = block.size() - BlockBasedTable::kBlockTrailerSize;
+
+  Options options;
+  ImmutableOptions ioptions(options);
+  UncompressionContext context(kZSTD);
+  UncompressionInfo info(context, UncompressionDict::GetEmptyDict(), kZSTD);
+  ASSERT_TRUE(CanUncompressSerializedBlockWithChecksum(
+      kXXH3, kZSTD, UncompressionDict::GetEmptyDict()));
+  BlockContents contents;
+  uint32_t checksum = 0;
+  ASSERT_OK(UncompressSerializedBlockWithChecksum(
+      info, block.data(), size, kXXH3, &contents, &checksum, ioptions));
+  ASSERT_EQ(raw, contents.data.ToString());
+  ASSERT_EQ(ComputeBuiltinChecksumWithLastByte(kXXH3, block.data(), size,
+                                               block[size]),
+            checksum);
+
+  // Flip a byte in the middle of the block; the decompressor might not notice
+  std::string corrupt = block;
+  corrupt[size / 2] ^= 0x40;
+  Status s = UncompressSerializedBlockWithChecksum(
+      info, corrupt.data(), size, kXXH3, &contents, &checksum, ioptions);
+  s.PermitUncheckedError();
+  ASSERT_EQ(ComputeBuiltinChecksumWithLastByte(kXXH3, corrupt.data(), size,
+                                               corrupt[size]),
+            checksum);
+
+  // Drop the end of the frame
+  corrupt = block;
+  corrupt.erase(size - 1000, 1000);
+  const size_t truncated_size = size - 1000;
+  s = UncompressSerializedBlockWithChecksum(info, corrupt.data(),
+                                            truncated_size, kXXH3, &contents,
+                                            &checksum, ioptions);
+  ASSERT_TRUE(s.IsCorruption()) << s.ToString();
+  ASSERT_EQ(ComputeBuiltinChecksumWithLastByte(kXXH3, corrupt.data(),
+                                               truncated_size,
+                                               corrupt[truncated_size]),
+            checksum);
+}
 
 }  // namespace
 }  // namespace ROCKSDB_NAMESPACE
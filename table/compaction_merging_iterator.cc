@@ -5,6 +5,8 @@
 //  (found in the LICENSE.Apache file in the root directory).
 #include "table/compaction_merging_iterator.h"
 
+#include "util/tournament_tree.h"
+
 namespace ROCKSDB_NAMESPACE {
 class CompactionMergingIterator : public InternalIterator {
  public:
@@ -13,11 +15,13 @@ class CompactionMergingIterator : public InternalIterator {
       int n, bool is_arena_mode,
       std::vector<
           std::pair<TruncatedRangeDelIterator*, TruncatedRangeDelIterator***>>
-          range_tombstones)
+          range_tombstones,
+      bool use_tournament_tree)
       : is_arena_mode_(is_arena_mode),
         comparator_(comparator),
         current_(nullptr),
-        minHeap_(CompactionHeapItemComparator(comparator_)),
+        minHeap_(CompactionHeapItemComparator(comparator_),
+                 use_tournament_tree),
         pinned_iters_mgr_(nullptr) {
     children_.resize(n);
     for (int i = 0; i < n; i++) {
@@ -184,7 +188,7 @@ class CompactionMergingIterator : public InternalIterator {
     const InternalKeyComparator* comparator_;
   };
 
-  using CompactionMinHeap = BinaryHeap<HeapItem*, CompactionHeapItemComparator>;
+  using CompactionMinHeap = MergeHeap<HeapItem*, CompactionHeapItemComparator>;
   bool is_arena_mode_;
   const InternalKeyComparator* comparator_;
   // HeapItem for all child point iterators.
@@ -351,20 +355,20 @@ InternalIterator* NewCompactionMergingIterator(
     const InternalKeyComparator* comparator, InternalIterator** children, int n,
     std::vector<std::pair<TruncatedRangeDelIterator*,
                           TruncatedRangeDelIterator***>>& range_tombstone_iters,
-    Arena* arena) {
+    Arena* arena, bool use_tournament_tree) {
   assert(n >= 0);
   if (n == 0) {
     return NewEmptyInternalIterator<Slice>(arena);
   } else {
     if (arena == nullptr) {
-      return new CompactionMergingIterator(comparator, children, n,
-                                           false /* is_arena_mode */,
-                                           range_tombstone_iters);
+      return new CompactionMergingIterator(
+          comparator, children, n, false /* is_arena_mode */,
+          range_tombstone_iters, use_tournament_tree);
     } else {
       auto mem = arena->AllocateAligned(sizeof(CompactionMergingIterator));
-      return new (mem) CompactionMergingIterator(comparator, children, n,
-                                                 true /* is_arena_mode */,
-                                                 range_tombstone_iters);
+      return new (mem) CompactionMergingIterator(
+          comparator, children, n, true /* is_arena_mode */,
+          range_tombstone_iters, use_tournament_tree);
     }
   }
 }
@@ -40,5 +40,5 @@ InternalIterator* NewCompactionMergingIterator(
     const InternalKeyComparator* comparator, InternalIterator** children, int n,
     std::vector<std::pair<TruncatedRangeDelIterator*,
                           TruncatedRangeDelIterator***>>& range_tombstone_iters,
-    Arena* arena = nullptr);
+    Arena* arena = nullptr, bool use_tournament_tree = false);
 }  // namespace ROCKSDB_NAMESPACE
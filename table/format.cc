@@ -626,6 +626,36 @@ uint32_t ComputeBuiltinChecksumWithLastByte(ChecksumType type, const char* data,
   }
 }
 
+namespace {
+Status UncompressionFailure(const UncompressionInfo& uncompression_info,
+                            const char* error_msg) {
+  if (!CompressionTypeSupported(uncompression_info.type())) {
+    return Status::NotSupported(
+        "Unsupported compression method for this build",
+        CompressionTypeToString(uncompression_info.type()));
+  }
+  std::ostringstream oss;
+  oss << "Corrupted compressed block contents";
+  if (error_msg) {
+    oss << ": " << error_msg;
+  }
+  return Status::Corruption(oss.str(),
+                            CompressionTypeToString(uncompression_info.type()));
+}
+
+void RecordUncompression(const ImmutableOptions& ioptions,
+                         StopWatchNano& timer, size_t size,
+                         const BlockContents& out_contents) {
+  if (ShouldReportDetailedTime(ioptions.env, ioptions.stats)) {
+    RecordTimeToHistogram(ioptions.stats, DECOMPRESSION_TIMES_NANOS,
+                          timer.ElapsedNanos());
+  }
+  RecordTick(ioptions.stats, BYTES_DECOMPRESSED_FROM, size);
+  RecordTick(ioptions.stats, BYTES_DECOMPRESSED_TO, out_contents.data.size());
+  RecordTick(ioptions.stats, NUMBER_BLOCK_DECOMPRESSED);
+}
+}  // namespace
+
 Status UncompressBlockData(const UncompressionInfo& uncompression_info,
                            const char* data, size_t size,
                            BlockContents* out_contents, uint32_t format_version,
@@ -644,31 +674,11 @@ Status UncompressBlockData(const UncompressionInfo& uncompression_info,
       uncompression_info, data, size, &uncompressed_size,
       GetCompressFormatForVersion(format_version), allocator, &error_msg);
   if (!ubuf) {
-    if (!CompressionTypeSupported(uncompression_info.type())) {
-      ret = Status::NotSupported(
-          "Unsupported compression method for this build",
-          CompressionTypeToString(uncompression_info.type()));
-    } else {
-      std::ostringstream oss;
-      oss << "Corrupted compressed block contents";
-      if (error_msg) {
-        oss << ": " << error_msg;
-      }
-      ret = Status::Corruption(
-          oss.str(), CompressionTypeToString(uncompression_info.type()));
-    }
-    return ret;
+    return UncompressionFailure(uncompression_info, error_msg);
   }
 
   *out_contents = BlockContents(std::move(ubuf), uncompressed_size);
-
-  if (ShouldReportDetailedTime(ioptions.env, ioptions.stats)) {
-    RecordTimeToHistogram(ioptions.stats, DECOMPRESSION_TIMES_NANOS,
-                          timer.ElapsedNanos());
-  }
-  RecordTick(ioptions.stats, BYTES_DECOMPRESSED_FROM, size);
-  RecordTick(ioptions.stats, BYTES_DECOMPRESSED_TO, out_contents->data.size());
-  RecordTick(ioptions.stats, NUMBER_BLOCK_DECOMPRESSED);
+  RecordUncompression(ioptions, timer, size, *out_contents);
 
   TEST_SYNC_POINT_CALLBACK("UncompressBlockData:TamperWithReturnValue",
                            static_cast<void*>(&ret));
@@ -692,6 +702,50 @@ Status UncompressSerializedBlock(const UncompressionInfo& uncompression_info,
                              format_version, ioptions, allocator);
 }
 
+bool CanUncompressSerializedBlockWithChecksum(ChecksumType checksum_type,
+                                              CompressionType compression_type,
+                                              const UncompressionDict& dict) {
+  return checksum_type == kXXH3 &&
+         (compression_type == kZSTD ||
+          compression_type == kZSTDNotFinalCompression) &&
+         dict.GetRawDict().empty() && ZSTD_StreamingUncompressSupported();
+}
+
+Status UncompressSerializedBlockWithChecksum(
+    const UncompressionInfo& uncompression_info, const char* data, size_t size,
+    ChecksumType checksum_type, BlockContents* out_contents, uint32_t* checksum,
+    const ImmutableOptions& ioptions, MemoryAllocator* allocator) {
+  assert(CanUncompressSerializedBlockWithChecksum(
+      checksum_type, uncompression_info.type(), uncompression_info.dict()));
+  assert(data[size] == static_cast<char>(uncompression_info.type()));
+  (void)checksum_type;
+  // Small enough for the pieces to stay in L1 between hashing and decoding
+  static constexpr size_t kChunkSize = 16 << 10;
+
+  StopWatchNano timer(ioptions.clock,
+                      ShouldReportDetailedTime(ioptions.env, ioptions.stats));
+  XXH3_state_t state;
+  XXH3_INITSTATE(&state);
+  XXH3_64bits_reset(&state);
+  size_t uncompressed_size = 0;
+  const char* error_msg = nullptr;
+  CacheAllocationPtr ubuf = ZSTD_UncompressStreaming(
+      uncompression_info, data, size, kChunkSize, &uncompressed_size,
+      allocator, &error_msg, [&state](const char* piece, size_t n) {
+        XXH3_64bits_update(&state, piece, n);
+      });
+  // Same as ComputeBuiltinChecksumWithLastByte(kXXH3, data, size, data[size])
+  *checksum = ModifyChecksumForLastByte(
+      Lower32of64(XXH3_64bits_digest(&state)), data[size]);
+  if (!ubuf) {
+    return UncompressionFailure(uncompression_info, error_msg);
+  }
+
+  *out_contents = BlockContents(std::move(ubuf), uncompressed_size);
+  RecordUncompression(ioptions, timer, size, *out_contents);
+  return Status::OK();
+}
+
 // Replace the contents of db_host_id with the actual hostname, if db_host_id
 // matches the keyword kHostnameForDbHostId
 Status ReifyDbHostIdProperty(Env* env, std::string* db_host_id) {
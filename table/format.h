@@ -28,6 +28,7 @@ namespace ROCKSDB_NAMESPACE {
 
 class RandomAccessFile;
 struct ReadOptions;
+struct UncompressionDict;
 
 bool ShouldReportDetailedTime(Env* env, Statistics* stats);
 
@@ -160,7 +161,7 @@ inline uint32_t GetCompressFormatForVersion(uint32_t format_version) {
   return format_version >= 2 ? 2 : 1;
 }
 
-constexpr uint32_t kLatestFormatVersion = 6;
+constexpr uint32_t kLatestFormatVersion = 7;
 
 inline bool IsSupportedFormatVersion(uint32_t version) {
   return version <= kLatestFormatVersion;
@@ -175,6 +176,23 @@ inline bool FormatVersionUsesIndexHandleInFooter(uint32_t version) {
   return version < 6;
 }
 
+// Data block keys may reference the "rocksdb.key.prefix.dict" meta block.
+inline bool FormatVersionUsesKeyPrefixDict(uint32_t version) {
+  return version >= 7;
+}
+
+// Data blocks may store restart fingerprints, flagged by a bit that older
+// versions read as part of the number of restarts.
+inline bool FormatVersionUsesRestartFingerprints(uint32_t version) {
+  return version >= 7;
+}
+
+// Data blocks may start with a column section holding their wide-column
+// entities; see columnar_block.h.
+inline bool FormatVersionUsesColumnarEntityBlocks(uint32_t version) {
+  return version >= 7;
+}
+
 // Footer encapsulates the fixed information stored at the tail end of every
 // SST file. In general, it should only include things that cannot go
 // elsewhere under the metaindex block. For example, checksum_type is
@@ -423,6 +441,24 @@ Status UncompressBlockData(const UncompressionInfo& info, const char* data,
                            const ImmutableOptions& ioptions,
                            MemoryAllocator* allocator = nullptr);
 
+// Whether UncompressSerializedBlockWithChecksum() supports blocks with this
+// checksum type and compression: kXXH3 checksums of kZSTD blocks compressed
+// without a dictionary.
+bool CanUncompressSerializedBlockWithChecksum(ChecksumType checksum_type,
+                                              CompressionType compression_type,
+                                              const UncompressionDict& dict);
+
+// Like UncompressSerializedBlock(), but also computes the block checksum in
+// the same pass over `data`, hashing each piece of the block just before the
+// decompressor consumes it. `checksum` is set to
+// ComputeBuiltinChecksumWithLastByte(checksum_type, data, size, data[size])
+// even when uncompressing fails, so that the caller can report a checksum
+// mismatch rather than the decompressor's error for a corrupt block.
+Status UncompressSerializedBlockWithChecksum(
+    const UncompressionInfo& info, const char* data, size_t size,
+    ChecksumType checksum_type, BlockContents* out_contents, uint32_t* checksum,
+    const ImmutableOptions& ioptions, MemoryAllocator* allocator = nullptr);
+
 // Replace db_host_id contents with the real hostname if necessary
 Status ReifyDbHostIdProperty(Env* env, std::string* db_host_id);
 
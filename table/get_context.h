@@ -150,6 +150,9 @@ class GetContext {
 
   bool NeedTimestamp() { return timestamp_ != nullptr; }
 
+  // Whether the lookup returns wide columns rather than a value.
+  bool NeedColumns() const { return columns_ != nullptr; }
+
   inline size_t TimestampSize() { return ucmp_->timestamp_size(); }
 
   void SetTimestampFromRangeTombstone(const Slice& timestamp) {
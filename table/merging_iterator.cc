@@ -10,6 +10,7 @@
 #include "table/merging_iterator.h"
 
 #include "db/arena_wrapped_db_iter.h"
+#include "util/tournament_tree.h"
 
 namespace ROCKSDB_NAMESPACE {
 // MergingIterator uses a min/max heap to combine data from point iterators.
@@ -54,13 +55,15 @@ class MergingIterator : public InternalIterator {
   MergingIterator(const InternalKeyComparator* comparator,
                   InternalIterator** children, int n, bool is_arena_mode,
                   bool prefix_seek_mode,
-                  const Slice* iterate_upper_bound = nullptr)
+                  const Slice* iterate_upper_bound = nullptr,
+                  bool use_tournament_tree = false)
       : is_arena_mode_(is_arena_mode),
         prefix_seek_mode_(prefix_seek_mode),
+        use_tournament_tree_(use_tournament_tree),
         direction_(kForward),
         comparator_(comparator),
         current_(nullptr),
-        minHeap_(MinHeapItemComparator(comparator_)),
+        minHeap_(MinHeapItemComparator(comparator_), use_tournament_tree),
         pinned_iters_mgr_(nullptr),
         iterate_upper_bound_(iterate_upper_bound) {
     children_.resize(n);
@@ -563,8 +566,8 @@ class MergingIterator : public InternalIterator {
     const InternalKeyComparator* comparator_;
   };
 
-  using MergerMinIterHeap = BinaryHeap<HeapItem*, MinHeapItemComparator>;
-  using MergerMaxIterHeap = BinaryHeap<HeapItem*, MaxHeapItemComparator>;
+  using MergerMinIterHeap = MergeHeap<HeapItem*, MinHeapItemComparator>;
+  using MergerMaxIterHeap = MergeHeap<HeapItem*, MaxHeapItemComparator>;
 
   friend class MergeIteratorBuilder;
   // Clears heaps for both directions, used when changing direction or seeking
@@ -596,6 +599,9 @@ class MergingIterator : public InternalIterator {
 
   bool is_arena_mode_;
   bool prefix_seek_mode_;
+  // Whether minHeap_ and maxHeap_ are tournament trees instead of binary
+  // heaps.
+  bool use_tournament_tree_;
   // Which direction is the iterator moving?
   enum Direction : uint8_t { kForward, kReverse };
   Direction direction_;
@@ -646,7 +652,7 @@ class MergingIterator : public InternalIterator {
   // If any of the children have non-ok status, this is one of them.
   Status status_;
   // Invariant: min heap property is maintained (parent is always <= child).
-  // This holds by using only BinaryHeap APIs to modify heap. One
+  // This holds by using only MergeHeap APIs to modify heap. One
   // exception is to modify heap top item directly (by caller iter->Next()), and
   // it should be followed by a call to replace_top() or pop().
   MergerMinIterHeap minHeap_;
@@ -1441,8 +1447,8 @@ void MergingIterator::ClearHeaps(bool clear_active) {
 
 void MergingIterator::InitMaxHeap() {
   if (!maxHeap_) {
-    maxHeap_ =
-        std::make_unique<MergerMaxIterHeap>(MaxHeapItemComparator(comparator_));
+    maxHeap_ = std::make_unique<MergerMaxIterHeap>(
+        MaxHeapItemComparator(comparator_), use_tournament_tree_);
   }
 }
 
@@ -1642,7 +1648,8 @@ inline void MergingIterator::FindPrevVisibleKey() {
 
 InternalIterator* NewMergingIterator(const InternalKeyComparator* cmp,
                                      InternalIterator** list, int n,
-                                     Arena* arena, bool prefix_seek_mode) {
+                                     Arena* arena, bool prefix_seek_mode,
+                                     bool use_tournament_tree) {
   assert(n >= 0);
   if (n == 0) {
     return NewEmptyInternalIterator<Slice>(arena);
@@ -1650,21 +1657,26 @@ InternalIterator* NewMergingIterator(const InternalKeyComparator* cmp,
     return list[0];
   } else {
     if (arena == nullptr) {
-      return new MergingIterator(cmp, list, n, false, prefix_seek_mode);
+      return new MergingIterator(cmp, list, n, false, prefix_seek_mode,
+                                 nullptr /* iterate_upper_bound */,
+                                 use_tournament_tree);
     } else {
       auto mem = arena->AllocateAligned(sizeof(MergingIterator));
-      return new (mem) MergingIterator(cmp, list, n, true, prefix_seek_mode);
+      return new (mem) MergingIterator(cmp, list, n, true, prefix_seek_mode,
+                                       nullptr /* iterate_upper_bound */,
+                                       use_tournament_tree);
     }
   }
 }
 
 MergeIteratorBuilder::MergeIteratorBuilder(
     const InternalKeyComparator* comparator, Arena* a, bool prefix_seek_mode,
-    const Slice* iterate_upper_bound)
+    const Slice* iterate_upper_bound, bool use_tournament_tree)
     : first_iter(nullptr), use_merging_iter(false), arena(a) {
   auto mem = arena->AllocateAligned(sizeof(MergingIterator));
-  merge_iter = new (mem) MergingIterator(comparator, nullptr, 0, true,
-                                         prefix_seek_mode, iterate_upper_bound);
+  merge_iter = new (mem)
+      MergingIterator(comparator, nullptr, 0, true, prefix_seek_mode,
+                      iterate_upper_bound, use_tournament_tree);
 }
 
 MergeIteratorBuilder::~MergeIteratorBuilder() {
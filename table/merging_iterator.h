@@ -31,11 +31,15 @@ using InternalIterator = InternalIteratorBase<Slice>;
 // The result does no duplicate suppression.  I.e., if a particular
 // key is present in K child iterators, it will be yielded K times.
 //
+// If use_tournament_tree is true, children are merged with a TournamentTree
+// instead of a BinaryHeap (see util/tournament_tree.h).
+//
 // REQUIRES: n >= 0
 InternalIterator* NewMergingIterator(const InternalKeyComparator* comparator,
                                      InternalIterator** children, int n,
                                      Arena* arena = nullptr,
-                                     bool prefix_seek_mode = false);
+                                     bool prefix_seek_mode = false,
+                                     bool use_tournament_tree = false);
 
 // The iterator returned by NewMergingIterator() and
 // MergeIteratorBuilder::Finish(). MergingIterator handles the merging of data
@@ -50,9 +54,11 @@ class MergeIteratorBuilder {
  public:
   // comparator: the comparator used in merging comparator
   // arena: where the merging iterator needs to be allocated from.
+  // use_tournament_tree: merge with a TournamentTree instead of a BinaryHeap.
   explicit MergeIteratorBuilder(const InternalKeyComparator* comparator,
                                 Arena* arena, bool prefix_seek_mode = false,
-                                const Slice* iterate_upper_bound = nullptr);
+                                const Slice* iterate_upper_bound = nullptr,
+                                bool use_tournament_tree = false);
   ~MergeIteratorBuilder();
 
   // Add point key iterator `iter` to the merging iterator.
@@ -117,6 +117,18 @@ void PropertyBlockBuilder::AddTableProperty(const TableProperties& props) {
     Add(TablePropertiesNames::kFastCompressionEstimatedDataSize,
         props.fast_compression_estimated_data_size);
   }
+  if (props.adaptive_compression_slow_blocks > 0) {
+    Add(TablePropertiesNames::kAdaptiveCompressionSlowBlocks,
+        props.adaptive_compression_slow_blocks);
+  }
+  if (props.adaptive_compression_fast_blocks > 0) {
+    Add(TablePropertiesNames::kAdaptiveCompressionFastBlocks,
+        props.adaptive_compression_fast_blocks);
+  }
+  if (props.adaptive_compression_uncompressed_blocks > 0) {
+    Add(TablePropertiesNames::kAdaptiveCompressionUncompressedBlocks,
+        props.adaptive_compression_uncompressed_blocks);
+  }
   Add(TablePropertiesNames::kTailStartOffset, props.tail_start_offset);
   if (props.user_defined_timestamps_persisted == 0) {
     Add(TablePropertiesNames::kUserDefinedTimestampsPersisted,
@@ -318,6 +330,12 @@ Status ReadTablePropertiesHelper(
        &new_table_properties->slow_compression_estimated_data_size},
       {TablePropertiesNames::kFastCompressionEstimatedDataSize,
        &new_table_properties->fast_compression_estimated_data_size},
+      {TablePropertiesNames::kAdaptiveCompressionSlowBlocks,
+       &new_table_properties->adaptive_compression_slow_blocks},
+      {TablePropertiesNames::kAdaptiveCompressionFastBlocks,
+       &new_table_properties->adaptive_compression_fast_blocks},
+      {TablePropertiesNames::kAdaptiveCompressionUncompressedBlocks,
+       &new_table_properties->adaptive_compression_uncompressed_blocks},
       {TablePropertiesNames::kTailStartOffset,
        &new_table_properties->tail_start_offset},
       {TablePropertiesNames::kUserDefinedTimestampsPersisted,
@@ -146,6 +146,13 @@ std::string TableProperties::ToString(const std::string& prop_delim,
                  slow_compression_estimated_data_size, prop_delim, kv_delim);
   AppendProperty(result, "fast compression estimated data size",
                  fast_compression_estimated_data_size, prop_delim, kv_delim);
+  AppendProperty(result, "adaptive compression slow blocks",
+                 adaptive_compression_slow_blocks, prop_delim, kv_delim);
+  AppendProperty(result, "adaptive compression fast blocks",
+                 adaptive_compression_fast_blocks, prop_delim, kv_delim);
+  AppendProperty(result, "adaptive compression uncompressed blocks",
+                 adaptive_compression_uncompressed_blocks, prop_delim,
+                 kv_delim);
 
   // DB identity and DB session ID
   AppendProperty(result, "DB identity", db_id, prop_delim, kv_delim);
@@ -191,6 +198,10 @@ void TableProperties::Add(const TableProperties& tp) {
       tp.slow_compression_estimated_data_size;
   fast_compression_estimated_data_size +=
       tp.fast_compression_estimated_data_size;
+  adaptive_compression_slow_blocks += tp.adaptive_compression_slow_blocks;
+  adaptive_compression_fast_blocks += tp.adaptive_compression_fast_blocks;
+  adaptive_compression_uncompressed_blocks +=
+      tp.adaptive_compression_uncompressed_blocks;
 }
 
 std::map<std::string, uint64_t>
@@ -213,6 +224,10 @@ TableProperties::GetAggregatablePropertiesAsMap() const {
       slow_compression_estimated_data_size;
   rv["fast_compression_estimated_data_size"] =
       fast_compression_estimated_data_size;
+  rv["adaptive_compression_slow_blocks"] = adaptive_compression_slow_blocks;
+  rv["adaptive_compression_fast_blocks"] = adaptive_compression_fast_blocks;
+  rv["adaptive_compression_uncompressed_blocks"] =
+      adaptive_compression_uncompressed_blocks;
   return rv;
 }
 
@@ -305,6 +320,13 @@ const std::string TablePropertiesNames::kSlowCompressionEstimatedDataSize =
     "rocksdb.sample_for_compression.slow.data.size";
 const std::string TablePropertiesNames::kFastCompressionEstimatedDataSize =
     "rocksdb.sample_for_compression.fast.data.size";
+const std::string TablePropertiesNames::kAdaptiveCompressionSlowBlocks =
+    "rocksdb.adaptive.compression.slow.blocks";
+const std::string TablePropertiesNames::kAdaptiveCompressionFastBlocks =
+    "rocksdb.adaptive.compression.fast.blocks";
+const std::string
+    TablePropertiesNames::kAdaptiveCompressionUncompressedBlocks =
+        "rocksdb.adaptive.compression.uncompressed.blocks";
 const std::string TablePropertiesNames::kSequenceNumberTimeMapping =
     "rocksdb.seqno.time.map";
 const std::string TablePropertiesNames::kTailStartOffset =
@@ -15,6 +15,7 @@ int main() {
 #include "db/dbformat.h"
 #include "file/random_access_file_reader.h"
 #include "monitoring/histogram.h"
+#include "options/options_helper.h"
 #include "rocksdb/db.h"
 #include "rocksdb/file_system.h"
 #include "rocksdb/slice_transform.h"
@@ -102,8 +103,8 @@ void TableReaderBenchmark(Options& opts, EnvOptions& env_options,
     tb = opts.table_factory->NewTableBuilder(
         TableBuilderOptions(ioptions, moptions, read_options, write_options,
                             ikc, &internal_tbl_prop_coll_factories,
-                            CompressionType::kNoCompression,
-                            CompressionOptions(), 0 /* column_family_id */,
+                            opts.compression, CompressionOptions(),
+                            0 /* column_family_id */,
                             kDefaultColumnFamilyName, unknown_level),
         file_writer.get());
   } else {
@@ -278,6 +279,19 @@ DEFINE_bool(mmap_read, true, "Whether use mmap read");
 DEFINE_string(table_factory, "block_based",
               "Table factory to use: `block_based` (default), `plain_table` or "
               "`cuckoo_hash`.");
+DEFINE_string(compression_type, "kNoCompression",
+              "Compression of the table, e.g. `kZSTD` or `kZlibCompression`.");
+DEFINE_bool(verify_checksum, true, "ReadOptions::verify_checksums");
+DEFINE_bool(no_block_cache, false,
+            "Disable the block cache of `block_based`, so that every query "
+            "reads, verifies and uncompresses data blocks (cold reads). "
+            "Comparing runs with --verify_checksum=true/false then shows the "
+            "CPU spent on block checksums.");
+DEFINE_bool(fuse_checksum_with_decompression, false,
+            "ReadOptions::fuse_checksum_with_decompression. With "
+            "--no_block_cache and --compression_type=kZSTD, compares "
+            "verifying block checksums while uncompressing with verifying "
+            "them beforehand.");
 DEFINE_string(time_unit, "microsecond",
               "The time unit used for measuring performance. User can specify "
               "`microsecond` (default) or `nanosecond`");
@@ -294,9 +308,20 @@ int main(int argc, char** argv) {
         ROCKSDB_NAMESPACE::NewFixedPrefixTransform(FLAGS_prefix_len));
   }
   ROCKSDB_NAMESPACE::ReadOptions ro;
+  ro.verify_checksums = FLAGS_verify_checksum;
+  ro.fuse_checksum_with_decompression = FLAGS_fuse_checksum_with_decompression;
   ROCKSDB_NAMESPACE::EnvOptions env_options;
   options.create_if_missing = true;
-  options.compression = ROCKSDB_NAMESPACE::CompressionType::kNoCompression;
+  auto compression_it =
+      ROCKSDB_NAMESPACE::OptionsHelper::compression_type_string_map.find(
+          FLAGS_compression_type);
+  if (compression_it ==
+      ROCKSDB_NAMESPACE::OptionsHelper::compression_type_string_map.end()) {
+    fprintf(stderr, "Invalid compression type %s\n",
+            FLAGS_compression_type.c_str());
+    return 1;
+  }
+  options.compression = compression_it->second;
 
   if (FLAGS_table_factory == "cuckoo_hash") {
     options.allow_mmap_reads = FLAGS_mmap_read;
@@ -317,7 +342,9 @@ int main(int argc, char** argv) {
     options.prefix_extractor.reset(
         ROCKSDB_NAMESPACE::NewFixedPrefixTransform(FLAGS_prefix_len));
   } else if (FLAGS_table_factory == "block_based") {
-    tf.reset(new ROCKSDB_NAMESPACE::BlockBasedTableFactory());
+    ROCKSDB_NAMESPACE::BlockBasedTableOptions table_options;
+    table_options.no_block_cache = FLAGS_no_block_cache;
+    tf.reset(new ROCKSDB_NAMESPACE::BlockBasedTableFactory(table_options));
   } else {
     fprintf(stderr, "Invalid table type %s\n", FLAGS_table_factory.c_str());
   }
@@ -2242,6 +2242,163 @@ TEST_P(BlockBasedTableTest, SkipPrefixBloomFilter) {
   }
 }
 
+TEST_P(BlockBasedTableTest, KeyPrefixDict) {
+  std::vector<CompressionType> compressions = {kNoCompression};
+  if (ZSTD_Supported()) {
+    // Buffers data blocks to train the compression dictionary, and parses
+    // them again when the buffer is flushed.
+    compressions.push_back(kZSTD);
+  }
+  for (CompressionType compression : compressions) {
+    std::vector<uint64_t> file_sizes;
+    for (size_t max_bytes : {size_t{0}, size_t{64}, size_t{4096}}) {
+      BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+      table_options.block_restart_interval = 4;
+      table_options.data_block_key_prefix_dict_max_bytes = max_bytes;
+      table_options.block_cache = NewLRUCache(1 << 20);
+
+      Options options;
+      options.comparator = BytewiseComparator();
+      options.compression = compression;
+      if (compression == kZSTD) {
+        options.compression_opts.max_dict_bytes = 1 << 10;
+      }
+      options.table_factory.reset(new BlockBasedTableFactory(table_options));
+      options.prefix_extractor.reset(NewFixedPrefixTransform(16));
+
+      // 40 tenants with long shared prefixes; 64 bytes of dictionary only
+      // hold a few of them, and keys shorter than the prefix are not in its
+      // domain.
+      TableConstructor c(options.comparator);
+      for (int tenant = 0; tenant < 40; ++tenant) {
+        char prefix[32];
+        snprintf(prefix, sizeof(prefix), "tenant-%09d", tenant);
+        c.Add(InternalKey(prefix, 1, kTypeValue).Encode().ToString(), "p");
+        for (int row = 0; row < 50; ++row) {
+          std::string user_key = prefix + std::to_string(1000 + row);
+          c.Add(InternalKey(user_key, 1, kTypeValue).Encode().ToString(),
+                std::to_string(tenant * row));
+        }
+      }
+      c.Add(InternalKey("t", 1, kTypeValue).Encode().ToString(), "short");
+
+      std::vector<std::string> keys;
+      stl_wrappers::KVMap kvmap;
+      const ImmutableOptions ioptions(options);
+      const MutableCFOptions moptions(options);
+      const InternalKeyComparator internal_comparator(options.comparator);
+      c.Finish(options, ioptions, moptions, table_options, internal_comparator,
+               &keys, &kvmap);
+      file_sizes.push_back(c.TEST_GetSink()->contents().size());
+
+      auto reader = c.GetTableReader();
+      ReadOptions read_options;
+      std::unique_ptr<InternalIterator> iter(reader->NewIterator(
+          read_options, moptions.prefix_extractor.get(), /*arena=*/nullptr,
+          /*skip_filters=*/false, TableReaderCaller::kUncategorized));
+      auto kv = kvmap.begin();
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++kv) {
+        ASSERT_TRUE(kv != kvmap.end());
+        ASSERT_EQ(kv->first, iter->key());
+        ASSERT_EQ(kv->second, iter->value());
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_TRUE(kv == kvmap.end());
+      for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+        --kv;
+        ASSERT_EQ(kv->first, iter->key());
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_TRUE(kv == kvmap.begin());
+      for (const auto& entry : kvmap) {
+        iter->Seek(entry.first);
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(entry.first, iter->key());
+        ASSERT_EQ(entry.second, iter->value());
+      }
+    }
+    if (!FormatVersionUsesKeyPrefixDict(
+            GetBlockBasedTableOptions().format_version)) {
+      // Older readers would misparse the keys, so older format_versions
+      // never use the dictionary.
+      ASSERT_EQ(file_sizes[1], file_sizes[0]);
+      ASSERT_EQ(file_sizes[2], file_sizes[0]);
+    } else if (compression == kNoCompression) {
+      // Every restart key drops most of its prefix.
+      ASSERT_LT(file_sizes[1], file_sizes[0]);
+      ASSERT_LT(file_sizes[2], file_sizes[1]);
+    }
+  }
+
+  BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+  table_options.data_block_key_prefix_dict_max_bytes = 4096;
+  std::unique_ptr<TableFactory> factory(
+      NewBlockBasedTableFactory(table_options));
+  Status s = factory->ValidateOptions(DBOptions(), ColumnFamilyOptions());
+  if (FormatVersionUsesKeyPrefixDict(table_options.format_version)) {
+    ASSERT_OK(s);
+  } else {
+    ASSERT_TRUE(s.IsInvalidArgument());
+  }
+}
+
+TEST_P(BlockBasedTableTest, RestartFingerprints) {
+  std::vector<uint64_t> file_sizes;
+  for (bool fingerprints : {false, true}) {
+    BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+    table_options.block_restart_interval = 4;
+    table_options.data_block_restart_fingerprints = fingerprints;
+
+    Options options;
+    options.comparator = BytewiseComparator();
+    options.compression = kNoCompression;
+    options.table_factory.reset(new BlockBasedTableFactory(table_options));
+
+    TableConstructor c(options.comparator);
+    for (int i = 0; i < 1000; ++i) {
+      c.Add(InternalKey("key" + std::to_string(10000 + i), 1, kTypeValue)
+                .Encode()
+                .ToString(),
+            std::to_string(i));
+    }
+    std::vector<std::string> keys;
+    stl_wrappers::KVMap kvmap;
+    const ImmutableOptions ioptions(options);
+    const MutableCFOptions moptions(options);
+    const InternalKeyComparator internal_comparator(options.comparator);
+    c.Finish(options, ioptions, moptions, table_options, internal_comparator,
+             &keys, &kvmap);
+    file_sizes.push_back(c.TEST_GetSink()->contents().size());
+
+    auto reader = c.GetTableReader();
+    std::unique_ptr<InternalIterator> iter(reader->NewIterator(
+        ReadOptions(), moptions.prefix_extractor.get(), /*arena=*/nullptr,
+        /*skip_filters=*/false, TableReaderCaller::kUncategorized));
+    for (const auto& entry : kvmap) {
+      iter->Seek(entry.first);
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(entry.first, iter->key());
+      ASSERT_EQ(entry.second, iter->value());
+    }
+    ASSERT_OK(iter->status());
+  }
+
+  // The fingerprint flag takes a bit that older format_versions read as part
+  // of the number of restarts.
+  BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+  table_options.data_block_restart_fingerprints = true;
+  std::unique_ptr<TableFactory> factory(
+      NewBlockBasedTableFactory(table_options));
+  Status s = factory->ValidateOptions(DBOptions(), ColumnFamilyOptions());
+  if (FormatVersionUsesRestartFingerprints(table_options.format_version)) {
+    ASSERT_OK(s);
+    ASSERT_GT(file_sizes[1], file_sizes[0]);
+  } else {
+    ASSERT_TRUE(s.IsInvalidArgument());
+    ASSERT_EQ(file_sizes[1], file_sizes[0]);
+  }
+}
+
 TEST_P(BlockBasedTableTest, BadChecksumType) {
   BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
 
@@ -2660,6 +2817,106 @@ TEST_P(BlockBasedTableTest, HashIndexTest) {
   IndexTest(table_options);
 }
 
+TEST_P(BlockBasedTableTest, LearnedIndexTest) {
+  BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+  table_options.index_type = BlockBasedTableOptions::kLearnedIndexSearch;
+  IndexTest(table_options);
+}
+
+namespace {
+std::string LearnedIndexTestKey(uint64_t i) {
+  std::string key = "user";
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    key.push_back(static_cast<char>((i >> shift) & 0xff));
+  }
+  return key;
+}
+}  // namespace
+
+TEST_F(GeneralTableTest, LearnedIndexModel) {
+  // Unevenly spaced keys, so that the model needs several segments.
+  std::vector<std::string> keys;
+  for (uint64_t i = 0; i < 1000; ++i) {
+    keys.push_back(LearnedIndexTestKey(i < 500 ? i * 3 : i * i));
+  }
+  std::string contents;
+  LearnedIndexModel::Builder builder(2 /* error_bound */);
+  for (const auto& key : keys) {
+    builder.Add(key);
+  }
+  ASSERT_TRUE(builder.Finish(&contents));
+
+  std::unique_ptr<LearnedIndexModel> model;
+  ASSERT_OK(LearnedIndexModel::Create(contents, &model));
+  uint32_t first = 0;
+  uint32_t last = 0;
+  // The model only applies to the index block it was built for.
+  ASSERT_FALSE(model->Predict(keys[0], 999, &first, &last));
+  for (uint32_t i = 0; i < keys.size(); ++i) {
+    ASSERT_TRUE(model->Predict(keys[i], 1000, &first, &last));
+    ASSERT_LE(first, i);
+    ASSERT_GE(last, i);
+    ASSERT_LE(last - first, 6u);
+  }
+  // Keys before the common prefix project like the smallest restart key.
+  ASSERT_TRUE(model->Predict("a", 1000, &first, &last));
+  ASSERT_EQ(0u, first);
+  ASSERT_LE(last, 6u);
+  ASSERT_TRUE(model->Predict("z", 1000, &first, &last));
+  ASSERT_EQ(999u, last);
+
+  ASSERT_TRUE(LearnedIndexModel::Create(Slice(contents.data(), 10), &model)
+                  .IsCorruption());
+}
+
+TEST_P(BlockBasedTableTest, LearnedIndexSeek) {
+  for (int restart_interval : {1, 3}) {
+    TableConstructor c(BytewiseComparator(),
+                       true /* convert_to_internal_key_ */);
+    for (uint64_t i = 0; i < 2000; ++i) {
+      c.Add(LearnedIndexTestKey(i < 1000 ? i * 2 : i * 97), "val");
+    }
+
+    std::vector<std::string> keys;
+    stl_wrappers::KVMap kvmap;
+    Options options;
+    options.compression = kNoCompression;
+    BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+    table_options.index_type = BlockBasedTableOptions::kLearnedIndexSearch;
+    table_options.block_size = 64;
+    table_options.index_block_restart_interval = restart_interval;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    const ImmutableOptions ioptions(options);
+    const MutableCFOptions moptions(options);
+    c.Finish(options, ioptions, moptions, table_options,
+             GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+    ASSERT_GT(c.GetTableReader()->GetTableProperties()->num_data_blocks,
+              100u);
+
+    ReadOptions read_options;
+    std::unique_ptr<InternalIterator> iter(c.GetTableReader()->NewIterator(
+        read_options, moptions.prefix_extractor.get(), /*arena=*/nullptr,
+        /*skip_filters=*/false, TableReaderCaller::kUncategorized));
+    // TableConstructor returns the keys as added, i.e. user keys
+    const std::vector<std::string>& user_keys = keys;
+    // Seek to every key, and to every gap between keys.
+    for (uint64_t i = 0; i < 2000 * 97 + 2; i += 1 + (i >= 2000) * 31) {
+      std::string target = LearnedIndexTestKey(i);
+      iter->Seek(InternalKey(target, kMaxSequenceNumber, kTypeValue).Encode());
+      ASSERT_OK(iter->status());
+      auto expected =
+          std::lower_bound(user_keys.begin(), user_keys.end(), target);
+      if (expected == user_keys.end()) {
+        ASSERT_FALSE(iter->Valid());
+      } else {
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(*expected, ExtractUserKey(iter->key()).ToString());
+      }
+    }
+    c.ResetTableReader();
+  }
+}
+
 TEST_P(BlockBasedTableTest, PartitionIndexTest) {
   const int max_index_keys = 5;
   const int est_max_index_key_value_size = 32;
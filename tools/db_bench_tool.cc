@@ -62,6 +62,7 @@
 #include "rocksdb/slice_transform.h"
 #include "rocksdb/stats_history.h"
 #include "rocksdb/table.h"
+#include "rocksdb/threadpool.h"
 #include "rocksdb/utilities/backup_engine.h"
 #include "rocksdb/utilities/object_registry.h"
 #include "rocksdb/utilities/optimistic_transaction_db.h"
@@ -452,6 +453,16 @@ DEFINE_int32(min_write_buffer_number_to_merge,
              " writing less data to storage if there are duplicate records "
              " in each of these individual write buffers.");
 
+DEFINE_uint32(max_flush_partitions,
+              ROCKSDB_NAMESPACE::Options().max_flush_partitions,
+              "Maximum number of L0 files, written in parallel, that one "
+              "flush splits its output into.");
+
+DEFINE_bool(use_tournament_tree_merge,
+            ROCKSDB_NAMESPACE::Options().use_tournament_tree_merge,
+            "Merge sorted runs in iterators and compactions with a "
+            "tournament tree instead of a binary heap.");
+
 DEFINE_int32(max_write_buffer_number_to_maintain,
              ROCKSDB_NAMESPACE::Options().max_write_buffer_number_to_maintain,
              "The total maximum number of write buffers to maintain in memory "
@@ -568,6 +579,14 @@ DEFINE_double(cache_low_pri_pool_ratio, 0.0,
 
 DEFINE_string(cache_type, "lru_cache", "Type of block cache.");
 
+DEFINE_bool(cache_tinylfu_admission, false,
+            "Gate insertions into a full block cache with a TinyLFU "
+            "admission policy.");
+
+DEFINE_bool(hcc_segmented, false,
+            "With a hyper clock cache, protect entries hit more than once "
+            "from eviction by one-touch entries such as scanned blocks.");
+
 DEFINE_bool(use_compressed_secondary_cache, false,
             "Use the CompressedSecondaryCache as the secondary cache.");
 
@@ -633,6 +652,10 @@ DEFINE_bool(use_cache_jemalloc_no_dump_allocator, false,
 DEFINE_bool(use_cache_memkind_kmem_allocator, false,
             "Use memkind kmem allocator for block/blob cache.");
 
+DEFINE_bool(use_cache_slab_allocator, false,
+            "Pack block/blob cache entries into slabs with "
+            "SlabMemoryAllocator.");
+
 DEFINE_bool(partition_index_and_filters, false,
             "Partition index and filter blocks.");
 
@@ -691,6 +714,13 @@ DEFINE_int32(read_amp_bytes_per_bit,
              ROCKSDB_NAMESPACE::BlockBasedTableOptions().read_amp_bytes_per_bit,
              "Number of bytes per bit to be used in block read-amp bitmap");
 
+DEFINE_bool(adaptive_data_block_compression,
+            ROCKSDB_NAMESPACE::BlockBasedTableOptions()
+                .adaptive_data_block_compression,
+            "Choose the compression of each data block from its sampled "
+            "compressibility: the configured compression type, a fast one, "
+            "or none");
+
 DEFINE_bool(
     enable_index_compression,
     ROCKSDB_NAMESPACE::BlockBasedTableOptions().enable_index_compression,
@@ -714,6 +744,27 @@ DEFINE_double(data_block_hash_table_util_ratio, 0.75,
               "This is only valid if use_data_block_hash_index is "
               "set to true");
 
+DEFINE_bool(data_block_restart_fingerprints, false,
+            "Store restart key fingerprints in data blocks. "
+            "This is valid if only we use BlockTable, and requires "
+            "--format_version=7");
+
+DEFINE_uint64(data_block_key_prefix_dict_max_bytes, 0,
+              "If non-zero, the maximum size of the per-file key prefix "
+              "dictionary used by data block keys. Needs a prefix extractor "
+              "(see --prefix_size) and --format_version=7. This is valid if "
+              "only we use BlockTable");
+
+DEFINE_bool(columnar_entity_blocks, false,
+            "Store the wide-column entities of data blocks column by column. "
+            "This is valid if only we use BlockTable, and requires "
+            "--format_version=7");
+
+DEFINE_int32(decompression_threads, 0,
+             "If positive, MultiGet uncompresses the data blocks it reads "
+             "from a file on a shared pool of this many threads as well as "
+             "on the calling thread. This is valid if only we use BlockTable");
+
 DEFINE_int64(compressed_cache_size, -1,
              "Number of bytes to use as a cache of compressed data.");
 
@@ -756,6 +807,10 @@ DEFINE_bool(memtable_whole_key_filtering, false,
 DEFINE_bool(memtable_use_huge_page, false,
             "Try to use huge page in memtables.");
 
+DEFINE_uint64(memtable_huge_page_pool_size, 0,
+              "Bytes of memtable huge pages kept for reuse by later "
+              "memtables. Only used with --memtable_use_huge_page.");
+
 DEFINE_bool(whole_key_filtering,
             ROCKSDB_NAMESPACE::BlockBasedTableOptions().whole_key_filtering,
             "Use whole keys (in addition to prefixes) in SST bloom filter.");
@@ -1190,6 +1245,11 @@ DEFINE_bool(async_io, false,
             "When set true, RocksDB does asynchronous reads for internal auto "
             "readahead prefetching.");
 
+DEFINE_uint64(async_io_readahead_depth,
+              ROCKSDB_NAMESPACE::ReadOptions().async_io_readahead_depth,
+              "Number of asynchronous reads each table file iterator keeps in "
+              "flight ahead of the scan when --async_io is set.");
+
 DEFINE_bool(optimize_multiget_for_io, true,
             "When set true, RocksDB does asynchronous reads for SST files in "
             "multiple levels for MultiGet.");
@@ -1435,17 +1495,38 @@ DEFINE_uint64(delayed_write_rate, 8388608u,
               "Limited bytes allowed to DB when soft_rate_limit or "
               "level0_slowdown_writes_trigger triggers");
 
+DEFINE_bool(write_stall_per_column_family,
+            ROCKSDB_NAMESPACE::Options().write_stall_per_column_family,
+            "Only stall writes to the column families that trigger a write "
+            "stall");
+
+DEFINE_bool(put_pinned, false,
+            "Add the values of writes to the write batch with "
+            "WriteBatch::PutPinned(), which does not copy them into the batch");
+
 DEFINE_bool(enable_pipelined_write, true,
             "Allow WAL and memtable writes to be pipelined");
 
+DEFINE_bool(enable_pipelined_wal_sync, false,
+            "With pipelined writes, sync the WAL from the memtable writer "
+            "queue so that WAL appends overlap with WAL syncs");
+
 DEFINE_bool(
     unordered_write, false,
     "Enable the unordered write feature, which provides higher throughput but "
     "relaxes the guarantees around atomic reads and immutable snapshots");
 
+DEFINE_uint32(num_wal_shards, 1,
+              "Number of WAL shards, each with its own write queue and log "
+              "file. Values > 1 require --enable_pipelined_write=false");
+
 DEFINE_bool(allow_concurrent_memtable_write, true,
             "Allow multi-writers to update mem tables in parallel.");
 
+DEFINE_bool(memtable_numa_aware, false,
+            "Allocate memtable memory from the NUMA node of the writing "
+            "thread.");
+
 DEFINE_double(experimental_mempurge_threshold, 0.0,
               "Maximum useful payload ratio estimate that triggers a mempurge "
               "(memtable garbage collection).");
@@ -1714,6 +1795,9 @@ DEFINE_double(cuckoo_hash_ratio, 0.9, "Hash ratio for Cuckoo SST table.");
 DEFINE_bool(use_hash_search, false,
             "if use kHashSearch instead of kBinarySearch. "
             "This is valid if only we use BlockTable");
+DEFINE_bool(use_learned_index, false,
+            "if use kLearnedIndexSearch instead of kBinarySearch. "
+            "This is valid if only we use BlockTable");
 DEFINE_string(merge_operator, "",
               "The merge operator to use with the database."
               "If a new merge operator is specified, be sure to use fresh"
@@ -1733,6 +1817,11 @@ DEFINE_bool(read_with_latest_user_timestamp, true,
 
 DEFINE_string(secondary_cache_uri, "",
               "Full URI for creating a custom secondary cache object");
+DEFINE_string(flash_secondary_cache_path, "",
+              "If non-empty, use a FlashSecondaryCache with files in this "
+              "directory as the secondary cache");
+DEFINE_uint64(flash_secondary_cache_size, 1ull << 30,
+              "Capacity in bytes of the FlashSecondaryCache");
 static class std::shared_ptr<ROCKSDB_NAMESPACE::SecondaryCache> secondary_cache;
 
 static const bool FLAGS_prefix_size_dummy __attribute__((__unused__)) =
@@ -3061,6 +3150,12 @@ class Benchmark {
       fprintf(stderr, "Memkind library is not linked with the binary.\n");
       exit(1);
 #endif
+    } else if (FLAGS_use_cache_slab_allocator) {
+      SlabAllocatorOptions slab_options;
+      if (!NewSlabMemoryAllocator(slab_options, &allocator).ok()) {
+        fprintf(stderr, "Invalid SlabMemoryAllocator options.\n");
+        exit(1);
+      }
     }
 
     return allocator;
@@ -3078,6 +3173,12 @@ class Benchmark {
     if (capacity <= 0) {
       return nullptr;
     }
+    std::shared_ptr<CacheAdmissionPolicy> admission_policy;
+    if (FLAGS_cache_tinylfu_admission) {
+      TinyLFUAdmissionPolicyOptions policy_opts;
+      policy_opts.statistics = dbstats;
+      admission_policy = NewTinyLFUAdmissionPolicy(policy_opts);
+    }
     if (FLAGS_use_compressed_secondary_cache) {
       secondary_cache_opts.capacity = FLAGS_compressed_secondary_cache_size;
       secondary_cache_opts.num_shard_bits =
@@ -3113,6 +3214,23 @@ class Benchmark {
                 FLAGS_secondary_cache_uri.c_str(), s.ToString().c_str());
         exit(1);
       }
+    } else if (!FLAGS_flash_secondary_cache_path.empty()) {
+      if (!use_tiered_cache && FLAGS_use_compressed_secondary_cache) {
+        fprintf(stderr,
+                "Cannot specify both --flash_secondary_cache_path and "
+                "--use_compressed_secondary_cache when using a non-tiered "
+                "cache\n");
+        exit(1);
+      }
+      FlashSecondaryCacheOptions flash_opts;
+      flash_opts.path = FLAGS_flash_secondary_cache_path;
+      flash_opts.capacity = FLAGS_flash_secondary_cache_size;
+      Status s = NewFlashSecondaryCache(flash_opts, &secondary_cache);
+      if (!s.ok()) {
+        fprintf(stderr, "Failed to create FlashSecondaryCache: %s\n",
+                s.ToString().c_str());
+        exit(1);
+      }
     }
 
     std::shared_ptr<Cache> block_cache;
@@ -3133,6 +3251,8 @@ class Benchmark {
       HyperClockCacheOptions opts(FLAGS_cache_size, estimated_entry_charge,
                                   FLAGS_cache_numshardbits);
       opts.hash_seed = GetCacheHashSeed();
+      opts.admission_policy = admission_policy;
+      opts.segmented = FLAGS_hcc_segmented;
       if (use_tiered_cache) {
         TieredCacheOptions tiered_opts;
         tiered_opts.cache_type = PrimaryCacheType::kCacheTypeHCC;
@@ -3146,7 +3266,7 @@ class Benchmark {
         tiered_opts.adm_policy = adm_policy;
         block_cache = NewTieredCache(tiered_opts);
       } else {
-        if (!FLAGS_secondary_cache_uri.empty()) {
+        if (secondary_cache) {
           opts.secondary_cache = secondary_cache;
         } else if (FLAGS_use_compressed_secondary_cache) {
           opts.secondary_cache =
@@ -3161,6 +3281,7 @@ class Benchmark {
           GetCacheAllocator(), kDefaultToAdaptiveMutex,
           kDefaultCacheMetadataChargePolicy, FLAGS_cache_low_pri_pool_ratio);
       opts.hash_seed = GetCacheHashSeed();
+      opts.admission_policy = admission_policy;
       if (use_tiered_cache) {
         TieredCacheOptions tiered_opts;
         tiered_opts.cache_type = PrimaryCacheType::kCacheTypeLRU;
@@ -3174,7 +3295,7 @@ class Benchmark {
         tiered_opts.adm_policy = adm_policy;
         block_cache = NewTieredCache(tiered_opts);
       } else {
-        if (!FLAGS_secondary_cache_uri.empty()) {
+        if (secondary_cache) {
           opts.secondary_cache = secondary_cache;
         } else if (FLAGS_use_compressed_secondary_cache) {
           opts.secondary_cache =
@@ -3459,6 +3580,8 @@ class Benchmark {
       read_options_.readahead_size = FLAGS_readahead_size;
       read_options_.adaptive_readahead = FLAGS_adaptive_readahead;
       read_options_.async_io = FLAGS_async_io;
+      read_options_.async_io_readahead_depth =
+          static_cast<size_t>(FLAGS_async_io_readahead_depth);
       read_options_.optimize_multiget_for_io = FLAGS_optimize_multiget_for_io;
       read_options_.auto_readahead_size = FLAGS_auto_readahead_size;
 
@@ -4231,6 +4354,8 @@ class Benchmark {
         FLAGS_min_write_buffer_number_to_merge;
     options.max_write_buffer_number_to_maintain =
         FLAGS_max_write_buffer_number_to_maintain;
+    options.max_flush_partitions = FLAGS_max_flush_partitions;
+    options.use_tournament_tree_merge = FLAGS_use_tournament_tree_merge;
     options.max_write_buffer_size_to_maintain =
         FLAGS_max_write_buffer_size_to_maintain;
     options.max_background_jobs = FLAGS_max_background_jobs;
@@ -4262,7 +4387,9 @@ class Benchmark {
     if (FLAGS_use_stderr_info_logger) {
       options.info_log = std::make_shared<StderrLogger>();
     }
-    options.memtable_huge_page_size = FLAGS_memtable_use_huge_page ? 2048 : 0;
+    options.memtable_huge_page_size =
+        FLAGS_memtable_use_huge_page ? 2 * 1024 * 1024 : 0;
+    options.memtable_huge_page_pool_size = FLAGS_memtable_huge_page_pool_size;
     options.memtable_prefix_bloom_size_ratio = FLAGS_memtable_bloom_size_ratio;
     options.memtable_whole_key_filtering = FLAGS_memtable_whole_key_filtering;
     if (FLAGS_memtable_insert_with_hint_prefix_size > 0) {
@@ -4344,6 +4471,9 @@ class Benchmark {
           exit(1);
         }
         block_based_options.index_type = BlockBasedTableOptions::kHashSearch;
+      } else if (FLAGS_use_learned_index) {
+        block_based_options.index_type =
+            BlockBasedTableOptions::kLearnedIndexSearch;
       } else {
         block_based_options.index_type = BlockBasedTableOptions::kBinarySearch;
       }
@@ -4443,6 +4573,8 @@ class Benchmark {
       block_based_options.read_amp_bytes_per_bit = FLAGS_read_amp_bytes_per_bit;
       block_based_options.enable_index_compression =
           FLAGS_enable_index_compression;
+      block_based_options.adaptive_data_block_compression =
+          FLAGS_adaptive_data_block_compression;
       block_based_options.block_align = FLAGS_block_align;
       block_based_options.whole_key_filtering = FLAGS_whole_key_filtering;
       block_based_options.max_auto_readahead_size =
@@ -4475,6 +4607,16 @@ class Benchmark {
       }
       block_based_options.data_block_hash_table_util_ratio =
           FLAGS_data_block_hash_table_util_ratio;
+      block_based_options.data_block_restart_fingerprints =
+          FLAGS_data_block_restart_fingerprints;
+      block_based_options.data_block_key_prefix_dict_max_bytes =
+          static_cast<size_t>(FLAGS_data_block_key_prefix_dict_max_bytes);
+      block_based_options.columnar_entity_blocks =
+          FLAGS_columnar_entity_blocks;
+      if (FLAGS_decompression_threads > 0) {
+        block_based_options.decompression_thread_pool =
+            NewSharedThreadPool(FLAGS_decompression_threads);
+      }
       if (FLAGS_read_cache_path != "") {
         Status rc_status;
 
@@ -4603,8 +4745,11 @@ class Benchmark {
     options.hard_pending_compaction_bytes_limit =
         FLAGS_hard_pending_compaction_bytes_limit;
     options.delayed_write_rate = FLAGS_delayed_write_rate;
+    options.write_stall_per_column_family =
+        FLAGS_write_stall_per_column_family;
     options.allow_concurrent_memtable_write =
         FLAGS_allow_concurrent_memtable_write;
+    options.memtable_numa_aware = FLAGS_memtable_numa_aware;
     options.experimental_mempurge_threshold =
         FLAGS_experimental_mempurge_threshold;
     options.inplace_update_support = FLAGS_inplace_update_support;
@@ -4612,7 +4757,9 @@ class Benchmark {
     options.enable_write_thread_adaptive_yield =
         FLAGS_enable_write_thread_adaptive_yield;
     options.enable_pipelined_write = FLAGS_enable_pipelined_write;
+    options.enable_pipelined_wal_sync = FLAGS_enable_pipelined_wal_sync;
     options.unordered_write = FLAGS_unordered_write;
+    options.num_wal_shards = FLAGS_num_wal_shards;
     options.write_thread_max_yield_usec = FLAGS_write_thread_max_yield_usec;
     options.write_thread_slow_yield_usec = FLAGS_write_thread_slow_yield_usec;
     options.table_cache_numshardbits = FLAGS_table_cache_numshardbits;
@@ -5385,7 +5532,12 @@ class Benchmark {
             s = blobdb->Put(write_options_, key, val);
           }
         } else if (FLAGS_num_column_families <= 1) {
-          batch.Put(key, val);
+          if (FLAGS_put_pinned && kNumDispAndPersEntries == 0) {
+            // The values of `gen` stay valid until the batch is written.
+            batch.PutPinned(key, val);
+          } else {
+            batch.Put(key, val);
+          }
         } else {
           // We use same rand_num as seed for key and column family so that we
           // can deterministically find the cfh corresponding to a particular
@@ -5856,6 +6008,8 @@ class Benchmark {
 
     options.adaptive_readahead = FLAGS_adaptive_readahead;
     options.async_io = FLAGS_async_io;
+    options.async_io_readahead_depth =
+        static_cast<size_t>(FLAGS_async_io_readahead_depth);
     options.auto_readahead_size = FLAGS_auto_readahead_size;
 
     Iterator* iter = db->NewIterator(options);
@@ -364,6 +364,7 @@ Status Tracer::Write(WriteBatch* write_batch) {
   TracerHelper::SetPayloadMap(trace.payload_map,
                               TracePayloadType::kWriteBatchData);
   PutFixed64(&trace.payload, trace.payload_map);
+  write_batch->MaterializePinnedValues();
   PutLengthPrefixedSlice(&trace.payload, Slice(write_batch->Data()));
   return WriteTrace(trace);
 }
@@ -1513,6 +1513,122 @@ inline CacheAllocationPtr ZSTD_Uncompress(
 #endif
 }
 
+inline bool ZSTD_StreamingUncompressSupported() {
+#ifdef ZSTD_ADVANCED
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Like ZSTD_Uncompress() for blocks compressed without a dictionary, but
+// feeds the input to the decoder `chunk_size` bytes at a time and calls
+// `on_input(data, size)` on each piece just before the decoder consumes it,
+// so that a checksum of the input can be computed in the same pass.
+// `on_input` sees all of the input, in order, even when decoding fails.
+template <typename OnInput>
+inline CacheAllocationPtr ZSTD_UncompressStreaming(
+    const UncompressionInfo& info, const char* input_data, size_t input_length,
+    size_t chunk_size, size_t* uncompressed_size, MemoryAllocator* allocator,
+    const char** error_message, OnInput&& on_input) {
+  assert(info.dict().GetRawDict().empty());
+  assert(chunk_size > 0);
+  const char* const input_end = input_data + input_length;
+#ifdef ZSTD_ADVANCED
+  static const char* const kErrorDecodeOutputSize =
+      "Cannot decode output size.";
+  static const char* const kErrorFrameHeader = "Invalid frame header.";
+  static const char* const kErrorOutputLenMismatch =
+      "Decompressed size does not match header.";
+  // Input before `hashed` has been passed to `on_input`
+  const char* hashed = input_data;
+  auto hash_to = [&](const char* end) {
+    if (end > hashed) {
+      on_input(hashed, static_cast<size_t>(end - hashed));
+      hashed = end;
+    }
+  };
+  auto fail = [&](const char* msg) {
+    if (error_message) {
+      *error_message = msg;
+    }
+    hash_to(input_end);
+    return CacheAllocationPtr();
+  };
+
+  uint32_t output_len = 0;
+  if (!compression::GetDecompressedSizeInfo(&input_data, &input_length,
+                                            &output_len)) {
+    return fail(kErrorDecodeOutputSize);
+  }
+  // The input is not verified yet, so check the size header against the
+  // frame header before allocating the output.
+  unsigned long long frame_content_size =
+      ZSTD_getFrameContentSize(input_data, input_length);
+  if (frame_content_size == ZSTD_CONTENTSIZE_ERROR) {
+    return fail(kErrorFrameHeader);
+  } else if (frame_content_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+    // Nothing to check the size header against, so hash all of the input
+    // before trusting it
+    hash_to(input_end);
+  } else if (frame_content_size != output_len) {
+    return fail(kErrorOutputLenMismatch);
+  }
+
+  CacheAllocationPtr output = AllocateBlock(output_len, allocator);
+  ZSTD_DCtx* context = info.context().GetZSTDContext();
+  assert(context != nullptr);
+  ZSTD_DCtx_reset(context, ZSTD_reset_session_and_parameters);
+#if defined(ZSTD_STATIC_LINKING_ONLY) && ZSTD_VERSION_NUMBER >= 10500
+  // Decode straight into `output` instead of through the window buffer
+  ZSTD_DCtx_setParameter(context, ZSTD_d_stableOutBuffer, 1);
+#endif  // ZSTD_STATIC_LINKING_ONLY && ZSTD_VERSION_NUMBER >= 10500
+  ZSTD_outBuffer out = {output.get(), output_len, 0};
+  const char* pos = input_data;
+  size_t ret = 1;
+  while (pos < input_end && ret != 0) {
+    size_t n = std::min(chunk_size, static_cast<size_t>(input_end - pos));
+    hash_to(pos + n);
+    ZSTD_inBuffer in = {pos, n, 0};
+    pos += n;
+    while (in.pos < in.size || (ret != 0 && out.pos < out.size)) {
+      size_t out_pos = out.pos;
+      size_t in_pos = in.pos;
+      ret = ZSTD_decompressStream(context, &out, &in);
+      if (ZSTD_isError(ret)) {
+        const char* msg = ZSTD_getErrorName(ret);
+        ZSTD_DCtx_reset(context, ZSTD_reset_session_and_parameters);
+        return fail(msg);
+      }
+      if (ret == 0 || (out.pos == out_pos && in.pos == in_pos)) {
+        break;
+      }
+    }
+    if (in.pos < in.size) {
+      // Trailing bytes after the frame
+      ret = 1;
+      break;
+    }
+  }
+  ZSTD_DCtx_reset(context, ZSTD_reset_session_and_parameters);
+  if (ret != 0 || pos != input_end || out.pos != output_len) {
+    return fail(kErrorOutputLenMismatch);
+  }
+  *uncompressed_size = output_len;
+  return output;
+#else   // ZSTD_ADVANCED
+  (void)info;
+  (void)chunk_size;
+  (void)uncompressed_size;
+  (void)allocator;
+  if (error_message) {
+    *error_message = "Streaming ZSTD decompression is not supported.";
+  }
+  on_input(input_data, static_cast<size_t>(input_end - input_data));
+  return CacheAllocationPtr();
+#endif  // ZSTD_ADVANCED
+}
+
 inline bool ZSTD_TrainDictionarySupported() {
 #ifdef ZSTD
   // Dictionary trainer is available since v0.6.1 for static linking, but not
@@ -13,6 +13,7 @@
 #include <utility>
 
 #include "port/stack_trace.h"
+#include "util/tournament_tree.h"
 
 #ifndef GFLAGS
 const int64_t FLAGS_iters = 100000;
@@ -22,8 +23,9 @@ DEFINE_int64(iters, 100000, "number of pseudo-random operations in each test");
 #endif  // GFLAGS
 
 /*
- * Compares the custom heap implementation in util/heap.h against
- * std::priority_queue on a pseudo-random sequence of operations.
+ * Compares the custom heap implementations in util/heap.h and
+ * util/tournament_tree.h against std::priority_queue on a pseudo-random
+ * sequence of operations.
  */
 
 namespace ROCKSDB_NAMESPACE {
@@ -31,11 +33,16 @@ namespace ROCKSDB_NAMESPACE {
 using HeapTestValue = uint64_t;
 using Params = std::tuple<size_t, HeapTestValue, int64_t>;
 
-class HeapTest : public ::testing::TestWithParam<Params> {};
+class HeapTest : public ::testing::TestWithParam<Params> {
+ protected:
+  template <typename Heap>
+  void Run();
+};
 
-TEST_P(HeapTest, Test) {
+template <typename Heap>
+void HeapTest::Run() {
   // This test performs the same pseudorandom sequence of operations on a
-  // BinaryHeap and an std::priority_queue, comparing output.  The three
+  // Heap and an std::priority_queue, comparing output.  The three
   // possible operations are insert, replace top and pop.
   //
   // Insert is chosen slightly more often than the others so that the size of
@@ -47,7 +54,7 @@ TEST_P(HeapTest, Test) {
   const auto MAX_VALUE = std::get<1>(GetParam());
   const auto RNG_SEED = std::get<2>(GetParam());
 
-  BinaryHeap<HeapTestValue> heap;
+  Heap heap;
   std::priority_queue<HeapTestValue> ref;
 
   std::mt19937 rng(static_cast<unsigned int>(RNG_SEED));
@@ -88,6 +95,7 @@ TEST_P(HeapTest, Test) {
     // results
     assert((size == 0) == ref.empty());
     ASSERT_EQ(size == 0, heap.empty());
+    ASSERT_EQ(size, heap.size());
     if (size > 0) {
       ASSERT_EQ(ref.top(), heap.top());
     }
@@ -99,8 +107,19 @@ TEST_P(HeapTest, Test) {
 
   heap.clear();
   ASSERT_TRUE(heap.empty());
+  ASSERT_EQ(0U, heap.size());
+
+  // Usable again after clear().
+  heap.push(1);
+  heap.push(3);
+  heap.push(2);
+  ASSERT_EQ(3U, heap.top());
 }
 
+TEST_P(HeapTest, Test) { Run<BinaryHeap<HeapTestValue>>(); }
+
+TEST_P(HeapTest, TournamentTree) { Run<TournamentTree<HeapTestValue>>(); }
+
 // Basic test, MAX_VALUE = 3*MAX_HEAP_SIZE (occasional duplicates)
 INSTANTIATE_TEST_CASE_P(Basic, HeapTest,
                         ::testing::Values(Params(1000, 3000,
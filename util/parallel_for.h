@@ -0,0 +1,123 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "port/port.h"
+#include "rocksdb/env.h"
+#include "rocksdb/threadpool.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Calls fn(i) for every i in [0, n), spread over the calling thread and up
+// to `max_helpers` helper jobs, each handed to submit(job) as a
+// std::function<void()>. Returns once every call has finished. The calling
+// thread never waits for a helper job to be scheduled: it takes indices
+// itself until none are left, so when the pool is busy the work simply runs
+// on the calling thread. Helper jobs that start after that return without
+// calling fn.
+//
+// fn must be safe to call concurrently for different indices.
+template <typename SubmitFn>
+void ParallelForWith(const SubmitFn& submit, size_t max_helpers, size_t n,
+                     const std::function<void(size_t)>& fn) {
+  if (max_helpers == 0 || n < 2) {
+    for (size_t i = 0; i < n; ++i) {
+      fn(i);
+    }
+    return;
+  }
+
+  // Shared with the helper jobs, which can outlive this call.
+  struct State {
+    std::atomic<size_t> next{0};
+    size_t n = 0;
+    const std::function<void(size_t)>* fn = nullptr;
+    port::Mutex mu;
+    port::CondVar cv{&mu};
+    // Helper jobs currently calling fn
+    size_t active = 0;
+    // Set once the caller is done; later helper jobs must not touch fn.
+    bool closed = false;
+
+    void Run() {
+      for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < n;
+           i = next.fetch_add(1, std::memory_order_relaxed)) {
+        (*fn)(i);
+      }
+    }
+  };
+  auto state = std::make_shared<State>();
+  state->n = n;
+  state->fn = &fn;
+
+  const size_t num_helpers = std::min(max_helpers, n - 1);
+  for (size_t h = 0; h < num_helpers; ++h) {
+    submit(std::function<void()>([state]() {
+      {
+        MutexLock lock(&state->mu);
+        if (state->closed) {
+          return;
+        }
+        ++state->active;
+      }
+      state->Run();
+      MutexLock lock(&state->mu);
+      if (--state->active == 0) {
+        state->cv.SignalAll();
+      }
+    }));
+  }
+
+  state->Run();
+  MutexLock lock(&state->mu);
+  state->closed = true;
+  while (state->active > 0) {
+    state->cv.Wait();
+  }
+}
+
+// ParallelFor() with helper jobs submitted to `pool`; runs everything on the
+// calling thread when `pool` is nullptr.
+inline void ParallelFor(ThreadPool* pool, size_t max_helpers, size_t n,
+                        const std::function<void(size_t)>& fn) {
+  if (pool == nullptr) {
+    max_helpers = 0;
+  }
+  ParallelForWith(
+      [pool](std::function<void()>&& job) { pool->SubmitJob(std::move(job)); },
+      max_helpers, n, fn);
+}
+
+// ParallelFor() with helper jobs scheduled on the `pri` background pool of
+// `env`, capped at that pool's size so that no helper waits behind another
+// helper of the same call.
+inline void ParallelFor(Env* env, Env::Priority pri, size_t max_helpers,
+                        size_t n, const std::function<void(size_t)>& fn) {
+  const int pool_size = env->GetBackgroundThreads(pri);
+  max_helpers =
+      std::min(max_helpers, static_cast<size_t>(std::max(pool_size, 0)));
+  ParallelForWith(
+      [env, pri](std::function<void()>&& job) {
+        env->Schedule(
+            [](void* arg) {
+              std::unique_ptr<std::function<void()>> f(
+                  static_cast<std::function<void()>*>(arg));
+              (*f)();
+            },
+            new std::function<void()>(std::move(job)), pri,
+            /*tag=*/nullptr,
+            [](void* arg) { delete static_cast<std::function<void()>*>(arg); });
+      },
+      max_helpers, n, fn);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
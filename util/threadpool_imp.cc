@@ -547,4 +547,12 @@ ThreadPool* NewThreadPool(int num_threads) {
   return thread_pool;
 }
 
+std::shared_ptr<ThreadPool> NewSharedThreadPool(int num_threads) {
+  return std::shared_ptr<ThreadPool>(NewThreadPool(num_threads),
+                                     [](ThreadPool* thread_pool) {
+                                       thread_pool->JoinAllThreads();
+                                       delete thread_pool;
+                                     });
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,208 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "util/heap.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Tournament tree for multi-way merges with a high fan-in, with the same
+// interface and ordering as BinaryHeap: the comparison operator provides the
+// less-than relation and top() returns the maximum.
+//
+// Each element lives in a leaf slot of a complete binary tree whose internal
+// nodes hold the winner of the match between their two children. Every
+// operation replays the matches on the path from one leaf to the root, so
+// push(), pop() and replace_top() all take exactly log2(capacity)
+// comparisons, less for levels where one side is empty. BinaryHeap needs up
+// to 2logN comparisons for pop() and replace_top(), which makes it slower
+// when the top changes on most steps, as in a merge of many interleaved
+// sorted runs. When the merge takes long chunks from the same input,
+// BinaryHeap::replace_top() needs only 1 or 2 comparisons and remains the
+// better choice.
+//
+// The tree stores winners rather than losers because a loser tree can only
+// replay the path of the current winner. Here, push() can fill any free slot,
+// which the merging iterators rely on when range tombstone keys re-enter
+// mid-scan.
+template <typename T, typename Compare = std::less<T>>
+class TournamentTree {
+ public:
+  TournamentTree() {}
+  explicit TournamentTree(Compare cmp) : cmp_(std::move(cmp)) {}
+
+  void push(const T& value) {
+    if (free_slots_.empty()) {
+      Resize(capacity_ == 0 ? kInitialCapacity : capacity_ * 2);
+    }
+    const uint32_t slot = free_slots_.back();
+    free_slots_.pop_back();
+    values_[slot] = value;
+    nodes_[capacity_ + slot] = slot;
+    ++size_;
+    Replay(slot);
+  }
+
+  const T& top() const {
+    assert(!empty());
+    return values_[nodes_[1]];
+  }
+
+  void replace_top(const T& value) {
+    assert(!empty());
+    const uint32_t slot = nodes_[1];
+    values_[slot] = value;
+    Replay(slot);
+  }
+
+  void pop() {
+    assert(!empty());
+    const uint32_t slot = nodes_[1];
+    nodes_[capacity_ + slot] = kEmpty;
+    free_slots_.push_back(slot);
+    --size_;
+    Replay(slot);
+  }
+
+  void clear() {
+    if (size_ == 0) {
+      return;
+    }
+    std::fill(nodes_.begin(), nodes_.end(), kEmpty);
+    free_slots_.clear();
+    for (uint32_t slot = capacity_; slot > 0; --slot) {
+      free_slots_.push_back(slot - 1);
+    }
+    size_ = 0;
+  }
+
+  bool empty() const { return size_ == 0; }
+
+  size_t size() const { return size_; }
+
+ private:
+  static constexpr uint32_t kEmpty = std::numeric_limits<uint32_t>::max();
+  static constexpr uint32_t kInitialCapacity = 8;
+
+  // Winner of the match between two slots, either of which may be empty.
+  uint32_t Winner(uint32_t a, uint32_t b) const {
+    if (a == kEmpty) {
+      return b;
+    } else if (b == kEmpty) {
+      return a;
+    }
+    return cmp_(values_[a], values_[b]) ? b : a;
+  }
+
+  // Replays the matches from the leaf of `slot` up to the root.
+  void Replay(uint32_t slot) {
+    for (size_t node = (capacity_ + slot) / 2; node > 0; node /= 2) {
+      nodes_[node] = Winner(nodes_[2 * node], nodes_[2 * node + 1]);
+    }
+  }
+
+  // Grows the tree to `capacity` leaves, a power of two, keeping the current
+  // elements in their slots. Nothing is allocated until the first push(), so
+  // an unused tree is free.
+  void Resize(uint32_t capacity) {
+    const uint32_t old_capacity = capacity_;
+    std::vector<uint32_t> old_leaves(nodes_.begin() + old_capacity,
+                                     nodes_.end());
+    capacity_ = capacity;
+    values_.resize(capacity_);
+    nodes_.assign(2 * capacity_, kEmpty);
+    std::copy(old_leaves.begin(), old_leaves.end(),
+              nodes_.begin() + capacity_);
+    // Hand out the lowest slots first, so that small merges only touch the
+    // left part of the tree.
+    for (uint32_t slot = capacity_; slot > old_capacity; --slot) {
+      free_slots_.push_back(slot - 1);
+    }
+    for (size_t node = capacity_ - 1; node > 0; --node) {
+      nodes_[node] = Winner(nodes_[2 * node], nodes_[2 * node + 1]);
+    }
+  }
+
+  Compare cmp_;
+  // Number of leaves, a power of two.
+  uint32_t capacity_ = 0;
+  size_t size_ = 0;
+  // nodes_[1] is the root, nodes_[i] has children 2i and 2i+1, and the
+  // leaves are nodes_[capacity_, 2 * capacity_). Each node holds the slot
+  // of the winner of its subtree, or kEmpty.
+  std::vector<uint32_t> nodes_;
+  std::vector<T> values_;
+  std::vector<uint32_t> free_slots_;
+};
+
+// Either a BinaryHeap or a TournamentTree, picked at construction, for
+// iterators where the choice is an option.
+template <typename T, typename Compare>
+class MergeHeap {
+ public:
+  MergeHeap(Compare cmp, bool use_tournament_tree)
+      : use_tournament_tree_(use_tournament_tree),
+        heap_(cmp),
+        tree_(std::move(cmp)) {}
+
+  void push(const T& value) {
+    if (use_tournament_tree_) {
+      tree_.push(value);
+    } else {
+      heap_.push(value);
+    }
+  }
+
+  const T& top() const {
+    return use_tournament_tree_ ? tree_.top() : heap_.top();
+  }
+
+  void replace_top(const T& value) {
+    if (use_tournament_tree_) {
+      tree_.replace_top(value);
+    } else {
+      heap_.replace_top(value);
+    }
+  }
+
+  void pop() {
+    if (use_tournament_tree_) {
+      tree_.pop();
+    } else {
+      heap_.pop();
+    }
+  }
+
+  void clear() {
+    if (use_tournament_tree_) {
+      tree_.clear();
+    } else {
+      heap_.clear();
+    }
+  }
+
+  bool empty() const {
+    return use_tournament_tree_ ? tree_.empty() : heap_.empty();
+  }
+
+  size_t size() const {
+    return use_tournament_tree_ ? tree_.size() : heap_.size();
+  }
+
+ private:
+  const bool use_tournament_tree_;
+  BinaryHeap<T, Compare> heap_;
+  TournamentTree<T, Compare> tree_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
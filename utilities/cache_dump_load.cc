@@ -64,4 +64,37 @@ Status NewDefaultCacheDumpedLoader(
   return Status::OK();
 }
 
+Status NewCacheSnapshotDumper(const CacheDumpOptions& dump_options,
+                              const std::shared_ptr<Cache>& cache,
+                              const std::shared_ptr<FileSystem>& fs,
+                              const std::string& file_name,
+                              std::unique_ptr<CacheDumper>* cache_dumper) {
+  cache_dumper->reset(
+      new CacheSnapshotDumperImpl(dump_options, cache, fs, file_name));
+  return Status::OK();
+}
+
+Status NewCacheSnapshotLoader(
+    const CacheDumpOptions& dump_options, const std::shared_ptr<FileSystem>& fs,
+    const std::string& file_name,
+    const std::shared_ptr<SecondaryCache>& secondary_cache,
+    std::unique_ptr<CacheDumpedLoader>* cache_dump_loader) {
+  cache_dump_loader->reset(new CacheSnapshotLoaderImpl(
+      dump_options, fs, file_name, secondary_cache));
+  return Status::OK();
+}
+
+Status NewCacheSnapshotSecondaryCache(
+    const std::shared_ptr<FileSystem>& fs, const std::string& file_name,
+    std::shared_ptr<SecondaryCache>* secondary_cache) {
+  std::unique_ptr<CacheSnapshotReader> reader;
+  IOStatus io_s = CacheSnapshotReader::Open(fs, file_name, &reader);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  *secondary_cache =
+      std::make_shared<CacheSnapshotSecondaryCache>(std::move(reader));
+  return Status::OK();
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -5,6 +5,7 @@
 
 #include "utilities/cache_dump_load_impl.h"
 
+#include <algorithm>
 #include <limits>
 
 #include "cache/cache_entry_roles.h"
@@ -25,8 +26,16 @@ namespace ROCKSDB_NAMESPACE {
 // Therefore, a filter is need to decide if the key of the block satisfy the
 // requirement.
 Status CacheDumperImpl::SetDumpFilter(std::vector<DB*> db_list) {
-  Status s = Status::OK();
   dump_all_keys_ = false;
+  return CacheDumperHelper::GetStableKeyPrefixes(db_list, &prefix_filter_);
+}
+
+// Collect the cache key prefixes of the live SST files of the DBs in
+// `db_list`, for the files whose cache keys are stable across DB::Open.
+Status CacheDumperHelper::GetStableKeyPrefixes(
+    const std::vector<DB*>& db_list, std::set<std::string>* prefixes) {
+  assert(prefixes != nullptr);
+  Status s = Status::OK();
   for (size_t i = 0; i < db_list.size(); i++) {
     assert(i < db_list.size());
     TablePropertiesCollection ptc;
@@ -46,7 +55,7 @@ Status CacheDumperImpl::SetDumpFilter(std::vector<DB*> db_list) {
       if (is_stable) {
         Slice prefix_slice = base.CommonPrefixSlice();
         assert(prefix_slice.size() == OffsetableCacheKey::kCommonPrefixSize);
-        prefix_filter_.insert(prefix_slice.ToString());
+        prefixes->insert(prefix_slice.ToString());
       }
     }
   }
@@ -97,13 +106,36 @@ IOStatus CacheDumperImpl::DumpCacheEntriesToWriter() {
 
 // Check if we need to filter out the block based on its key
 bool CacheDumperImpl::ShouldFilterOut(const Slice& key) {
+  return CacheDumperHelper::ShouldFilterOut(prefix_filter_, key);
+}
+
+bool CacheDumperHelper::ShouldFilterOut(
+    const std::set<std::string>& prefix_filter, const Slice& key) {
   if (key.size() < OffsetableCacheKey::kCommonPrefixSize) {
     return /*filter out*/ true;
   }
   Slice key_prefix(key.data(), OffsetableCacheKey::kCommonPrefixSize);
   std::string prefix = key_prefix.ToString();
   // Filter out if not found
-  return prefix_filter_.find(prefix) == prefix_filter_.end();
+  return prefix_filter.find(prefix) == prefix_filter.end();
+}
+
+// Map the role of a cache entry to the type of block to dump, or
+// kBlockTypeMax if entries of this role are not dumped.
+CacheDumpUnitType CacheDumperHelper::GetDumpUnitType(CacheEntryRole role) {
+  switch (role) {
+    case CacheEntryRole::kDataBlock:
+      return CacheDumpUnitType::kData;
+    case CacheEntryRole::kFilterBlock:
+      return CacheDumpUnitType::kFilter;
+    case CacheEntryRole::kFilterMetaBlock:
+      return CacheDumpUnitType::kFilterMetaBlock;
+    case CacheEntryRole::kIndexBlock:
+      return CacheDumpUnitType::kIndex;
+    default:
+      // FIXME? Do we need the CacheDumpUnitTypes? UncompressionDict?
+      return CacheDumpUnitType::kBlockTypeMax;
+  }
 }
 
 // This is the callback function which will be applied to
@@ -135,26 +167,10 @@ CacheDumperImpl::DumpOneBlockCallBack(std::string& buf) {
       }
     }
 
-    CacheEntryRole role = helper->role;
-    CacheDumpUnitType type = CacheDumpUnitType::kBlockTypeMax;
-
-    switch (role) {
-      case CacheEntryRole::kDataBlock:
-        type = CacheDumpUnitType::kData;
-        break;
-      case CacheEntryRole::kFilterBlock:
-        type = CacheDumpUnitType::kFilter;
-        break;
-      case CacheEntryRole::kFilterMetaBlock:
-        type = CacheDumpUnitType::kFilterMetaBlock;
-        break;
-      case CacheEntryRole::kIndexBlock:
-        type = CacheDumpUnitType::kIndex;
-        break;
-      default:
-        // Filter out other entries
-        // FIXME? Do we need the CacheDumpUnitTypes? UncompressionDict?
-        return;
+    CacheDumpUnitType type = CacheDumperHelper::GetDumpUnitType(helper->role);
+    if (type == CacheDumpUnitType::kBlockTypeMax) {
+      // Filter out other entries
+      return;
     }
 
     // based on the key prefix, check if the block should be filter out.
@@ -386,4 +402,363 @@ IOStatus CacheDumpedLoaderImpl::ReadCacheBlock(std::string* data,
   return io_s;
 }
 
+Status CacheSnapshotDumperImpl::SetDumpFilter(std::vector<DB*> db_list) {
+  dump_all_keys_ = false;
+  return CacheDumperHelper::GetStableKeyPrefixes(db_list, &prefix_filter_);
+}
+
+// Write the selected blocks to the file in cache iteration order while
+// collecting their index entries, then write the sorted index and the footer.
+IOStatus CacheSnapshotDumperImpl::DumpCacheEntriesToWriter() {
+  if (cache_ == nullptr) {
+    return IOStatus::InvalidArgument("Cache is null");
+  }
+  if (fs_ == nullptr) {
+    return IOStatus::InvalidArgument("FileSystem is null");
+  }
+  if (options_.clock == nullptr) {
+    return IOStatus::InvalidArgument("System clock is null");
+  }
+  IOStatus io_s = WritableFileWriter::Create(fs_, file_name_, FileOptions(),
+                                             &file_writer_, nullptr);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+
+  index_.clear();
+  uint64_t offset = 0;
+  std::string buf;
+  cache_->ApplyToAllEntries(
+      [&](const Slice& key, Cache::ObjectPtr value, size_t /*charge*/,
+          const Cache::CacheItemHelper* helper) {
+        if (!io_s.ok() || helper == nullptr || helper->size_cb == nullptr ||
+            helper->saveto_cb == nullptr || key.size() != kCacheKeySize) {
+          return;
+        }
+        if (options_.max_size_bytes > 0 && offset > options_.max_size_bytes) {
+          return;
+        }
+        if (options_.deadline.count() &&
+            std::chrono::microseconds(options_.clock->NowMicros()) >=
+                options_.deadline) {
+          return;
+        }
+        CacheDumpUnitType type =
+            CacheDumperHelper::GetDumpUnitType(helper->role);
+        if (type == CacheDumpUnitType::kBlockTypeMax) {
+          return;
+        }
+        if (!dump_all_keys_ &&
+            CacheDumperHelper::ShouldFilterOut(prefix_filter_, key)) {
+          return;
+        }
+        size_t len = helper->size_cb(value);
+        if (len > std::numeric_limits<uint32_t>::max()) {
+          return;
+        }
+        buf.resize(len);
+        if (!helper->saveto_cb(value, /*start*/ 0, len, buf.data()).ok()) {
+          return;
+        }
+        io_s = file_writer_->Append(IOOptions(), buf);
+        if (io_s.ok()) {
+          index_.push_back({key.ToString(), offset, static_cast<uint32_t>(len),
+                            crc32c::Mask(crc32c::Value(buf.data(), len)),
+                            type});
+          offset += len;
+        }
+      },
+      {});
+
+  if (io_s.ok()) {
+    io_s = WriteIndexAndFooter(offset);
+  }
+  if (io_s.ok()) {
+    io_s = file_writer_->Sync(IOOptions(), false /* use_fsync */);
+  }
+  if (io_s.ok()) {
+    io_s = file_writer_->Close(IOOptions());
+  }
+  file_writer_.reset();
+  index_.clear();
+  return io_s;
+}
+
+IOStatus CacheSnapshotDumperImpl::WriteIndexAndFooter(uint64_t index_offset) {
+  std::sort(index_.begin(), index_.end(),
+            [](const IndexEntry& a, const IndexEntry& b) {
+              return a.key < b.key;
+            });
+  // The same block might be seen twice while the cache is changing
+  index_.erase(std::unique(index_.begin(), index_.end(),
+                           [](const IndexEntry& a, const IndexEntry& b) {
+                             return a.key == b.key;
+                           }),
+               index_.end());
+  if (index_.size() > std::numeric_limits<uint32_t>::max()) {
+    return IOStatus::NotSupported("Too many blocks for a cache snapshot");
+  }
+
+  std::string index;
+  index.reserve(index_.size() * kCacheSnapshotIndexEntrySize);
+  for (const IndexEntry& entry : index_) {
+    index.append(entry.key);
+    PutFixed64(&index, entry.offset);
+    PutFixed32(&index, entry.size);
+    PutFixed32(&index, entry.masked_checksum);
+    index.push_back(static_cast<char>(entry.type));
+    index.append(kCacheSnapshotIndexEntrySize - kCacheKeySize - 17, '\0');
+  }
+  assert(index.size() == index_.size() * kCacheSnapshotIndexEntrySize);
+  IOStatus io_s = file_writer_->Append(IOOptions(), index);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+
+  std::string footer;
+  PutFixed64(&footer, index_offset);
+  PutFixed32(&footer, static_cast<uint32_t>(index_.size()));
+  PutFixed32(&footer,
+             crc32c::Mask(crc32c::Value(index.data(), index.size())));
+  PutFixed32(&footer, kCacheSnapshotFormatVersion);
+  PutFixed32(&footer,
+             crc32c::Mask(crc32c::Value(footer.data(), footer.size())));
+  PutFixed64(&footer, kCacheSnapshotMagicNumber);
+  assert(footer.size() == kCacheSnapshotFooterSize);
+  return file_writer_->Append(IOOptions(), footer);
+}
+
+IOStatus CacheSnapshotReader::Open(
+    const std::shared_ptr<FileSystem>& fs, const std::string& file_name,
+    std::unique_ptr<CacheSnapshotReader>* reader) {
+  FileOptions file_opts;
+  file_opts.use_mmap_reads = true;
+  uint64_t file_size = 0;
+  IOStatus io_s =
+      fs->GetFileSize(file_name, file_opts.io_options, &file_size, nullptr);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  if (file_size < kCacheSnapshotFooterSize) {
+    return IOStatus::Corruption("Cache snapshot file too short", file_name);
+  }
+  std::unique_ptr<CacheSnapshotReader> r(new CacheSnapshotReader());
+  io_s = RandomAccessFileReader::Create(fs, file_name, file_opts,
+                                        &r->file_reader_, nullptr);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+
+  char footer_buf[kCacheSnapshotFooterSize];
+  Slice footer;
+  io_s = r->file_reader_->Read(IOOptions(), file_size - sizeof(footer_buf),
+                               sizeof(footer_buf), &footer, footer_buf,
+                               nullptr);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  if (footer.size() != kCacheSnapshotFooterSize ||
+      DecodeFixed64(footer.data() + 24) != kCacheSnapshotMagicNumber) {
+    return IOStatus::Corruption("Not a cache snapshot file", file_name);
+  }
+  if (crc32c::Unmask(DecodeFixed32(footer.data() + 20)) !=
+      crc32c::Value(footer.data(), 20)) {
+    return IOStatus::Corruption("Cache snapshot footer checksum mismatch",
+                                file_name);
+  }
+  if (DecodeFixed32(footer.data() + 16) != kCacheSnapshotFormatVersion) {
+    return IOStatus::NotSupported("Unknown cache snapshot format version",
+                                  file_name);
+  }
+  uint64_t index_offset = DecodeFixed64(footer.data());
+  r->num_entries_ = DecodeFixed32(footer.data() + 8);
+  const uint64_t index_size =
+      uint64_t{r->num_entries_} * kCacheSnapshotIndexEntrySize;
+  if (index_offset + index_size + kCacheSnapshotFooterSize != file_size) {
+    return IOStatus::Corruption("Cache snapshot index out of bounds",
+                                file_name);
+  }
+  r->index_buf_.reset(new char[index_size]);
+  io_s = r->file_reader_->Read(IOOptions(), index_offset, index_size,
+                               &r->index_, r->index_buf_.get(), nullptr);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  if (r->index_.data() != r->index_buf_.get()) {
+    // Memory mapped, so neither the index nor the blocks need to be copied
+    r->mmapped_ = true;
+    r->index_buf_.reset();
+  }
+  if (r->index_.size() != index_size ||
+      crc32c::Unmask(DecodeFixed32(footer.data() + 12)) !=
+          crc32c::Value(r->index_.data(), r->index_.size())) {
+    return IOStatus::Corruption("Cache snapshot index checksum mismatch",
+                                file_name);
+  }
+  *reader = std::move(r);
+  return IOStatus::OK();
+}
+
+Slice CacheSnapshotReader::KeyAt(size_t i) const {
+  assert(i < num_entries_);
+  return Slice(EntryAt(i), kCacheKeySize);
+}
+
+size_t CacheSnapshotReader::Find(const Slice& key) const {
+  if (key.size() != kCacheKeySize) {
+    return num_entries_;
+  }
+  size_t lo = 0;
+  size_t hi = num_entries_;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (KeyAt(mid).compare(key) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo < num_entries_ && KeyAt(lo) == key ? lo : num_entries_;
+}
+
+IOStatus CacheSnapshotReader::ReadBlock(size_t i,
+                                        std::unique_ptr<char[]>* scratch,
+                                        Slice* block) const {
+  assert(i < num_entries_);
+  const char* entry = EntryAt(i) + kCacheKeySize;
+  uint64_t offset = DecodeFixed64(entry);
+  uint32_t size = DecodeFixed32(entry + 8);
+  uint32_t checksum = crc32c::Unmask(DecodeFixed32(entry + 12));
+  if (!mmapped_) {
+    scratch->reset(new char[size]);
+  }
+  IOStatus io_s = file_reader_->Read(IOOptions(), offset, size, block,
+                                     mmapped_ ? nullptr : scratch->get(),
+                                     nullptr);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  if (block->size() != size ||
+      crc32c::Value(block->data(), block->size()) != checksum) {
+    return IOStatus::Corruption("Cache snapshot block checksum mismatch");
+  }
+  return io_s;
+}
+
+Status CacheSnapshotLoaderImpl::SetLoadFilter(std::vector<DB*> db_list) {
+  load_all_keys_ = false;
+  return CacheDumperHelper::GetStableKeyPrefixes(db_list, &prefix_filter_);
+}
+
+// Insert every block of the snapshot that passes the filter into the
+// secondary cache. Corrupted blocks are skipped, as the SST files still have
+// them.
+IOStatus CacheSnapshotLoaderImpl::RestoreCacheEntriesToSecondaryCache() {
+  if (secondary_cache_ == nullptr) {
+    return IOStatus::InvalidArgument("Secondary Cache is null");
+  }
+  if (fs_ == nullptr) {
+    return IOStatus::InvalidArgument("FileSystem is null");
+  }
+  if (options_.deadline.count() && options_.clock == nullptr) {
+    return IOStatus::InvalidArgument("System clock is null");
+  }
+  std::unique_ptr<CacheSnapshotReader> reader;
+  IOStatus io_s = CacheSnapshotReader::Open(fs_, file_name_, &reader);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  std::unique_ptr<char[]> scratch;
+  uint64_t loaded_size_bytes = 0;
+  for (size_t i = 0; i < reader->NumEntries(); ++i) {
+    if (options_.max_size_bytes > 0 &&
+        loaded_size_bytes > options_.max_size_bytes) {
+      break;
+    }
+    if (options_.deadline.count() &&
+        std::chrono::microseconds(options_.clock->NowMicros()) >=
+            options_.deadline) {
+      break;
+    }
+    Slice key = reader->KeyAt(i);
+    if (!load_all_keys_ &&
+        CacheDumperHelper::ShouldFilterOut(prefix_filter_, key)) {
+      continue;
+    }
+    Slice block;
+    io_s = reader->ReadBlock(i, &scratch, &block);
+    if (io_s.IsCorruption()) {
+      continue;
+    }
+    if (!io_s.ok()) {
+      return io_s;
+    }
+    Status s = secondary_cache_->InsertSaved(key, block);
+    if (!s.ok()) {
+      return status_to_io_status(std::move(s));
+    }
+    loaded_size_bytes += block.size();
+  }
+  return IOStatus::OK();
+}
+
+class CacheSnapshotSecondaryCache::ResultHandle
+    : public SecondaryCacheResultHandle {
+ public:
+  ResultHandle(Cache::ObjectPtr value, size_t size)
+      : value_(value), size_(size) {}
+
+  bool IsReady() override { return true; }
+  void Wait() override {}
+  Cache::ObjectPtr Value() override { return value_; }
+  size_t Size() override { return size_; }
+
+ private:
+  Cache::ObjectPtr value_;
+  size_t size_;
+};
+
+CacheSnapshotSecondaryCache::CacheSnapshotSecondaryCache(
+    std::unique_ptr<CacheSnapshotReader>&& reader)
+    : reader_(std::move(reader)), dropped_(reader_->NumEntries()) {}
+
+std::unique_ptr<SecondaryCacheResultHandle> CacheSnapshotSecondaryCache::Lookup(
+    const Slice& key, const Cache::CacheItemHelper* helper,
+    Cache::CreateContext* create_context, bool /*wait*/,
+    bool /*advise_erase*/, Statistics* /*stats*/, bool& kept_in_sec_cache) {
+  kept_in_sec_cache = true;
+  if (helper == nullptr || helper->create_cb == nullptr) {
+    return nullptr;
+  }
+  size_t i = reader_->Find(key);
+  if (i == reader_->NumEntries() || dropped_[i].LoadRelaxed()) {
+    return nullptr;
+  }
+  std::unique_ptr<char[]> scratch;
+  Slice block;
+  IOStatus io_s = reader_->ReadBlock(i, &scratch, &block);
+  if (!io_s.ok()) {
+    if (io_s.IsCorruption()) {
+      dropped_[i].StoreRelaxed(true);
+    }
+    return nullptr;
+  }
+  Cache::ObjectPtr value = nullptr;
+  size_t charge = 0;
+  Status s = helper->create_cb(block, kNoCompression, CacheTier::kVolatileTier,
+                               create_context, /*allocator=*/nullptr, &value,
+                               &charge);
+  if (!s.ok()) {
+    return nullptr;
+  }
+  return std::make_unique<ResultHandle>(value, charge);
+}
+
+void CacheSnapshotSecondaryCache::Erase(const Slice& key) {
+  size_t i = reader_->Find(key);
+  if (i < reader_->NumEntries()) {
+    dropped_[i].StoreRelaxed(true);
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <set>
 #include <unordered_map>
 
 #include "file/random_access_file_reader.h"
@@ -15,6 +16,7 @@
 #include "table/block_based/cachable_entry.h"
 #include "table/block_based/parsed_full_filter_block.h"
 #include "table/block_based/reader_common.h"
+#include "util/atomic.h"
 #include "util/hash_containers.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -154,6 +156,156 @@ class CacheDumpedLoaderImpl : public CacheDumpedLoader {
   std::unique_ptr<CacheDumpReader> reader_;
 };
 
+// The cache snapshot layout (see NewCacheSnapshotDumper()), with all integers
+// in little endian:
+//
+//   [block 0] ... [block N-1]
+//   [index entry 0] ... [index entry N-1], sorted by cache key
+//   [footer]
+//
+// index entry (kCacheSnapshotIndexEntrySize bytes):
+//   cache key (kCacheKeySize) | block offset (fixed64) | block size (fixed32)
+//   | masked crc32c of the block (fixed32) | CacheDumpUnitType (1) | padding
+// footer (kCacheSnapshotFooterSize bytes):
+//   index offset (fixed64) | number of index entries (fixed32)
+//   | masked crc32c of the index (fixed32) | format version (fixed32)
+//   | masked crc32c of the footer bytes before it (fixed32) | magic (fixed64)
+constexpr uint64_t kCacheSnapshotMagicNumber = 0x5e3a8c01d4b7f92cull;
+constexpr uint32_t kCacheSnapshotFormatVersion = 1;
+constexpr size_t kCacheSnapshotIndexEntrySize = 40;
+constexpr size_t kCacheSnapshotFooterSize = 32;
+
+// Writes a cache snapshot of the blocks in a Cache to a file
+class CacheSnapshotDumperImpl : public CacheDumper {
+ public:
+  CacheSnapshotDumperImpl(const CacheDumpOptions& dump_options,
+                          const std::shared_ptr<Cache>& cache,
+                          const std::shared_ptr<FileSystem>& fs,
+                          const std::string& file_name)
+      : options_(dump_options), cache_(cache), fs_(fs), file_name_(file_name) {}
+  Status SetDumpFilter(std::vector<DB*> db_list) override;
+  IOStatus DumpCacheEntriesToWriter() override;
+
+ private:
+  struct IndexEntry {
+    std::string key;
+    uint64_t offset;
+    uint32_t size;
+    uint32_t masked_checksum;
+    CacheDumpUnitType type;
+  };
+
+  IOStatus WriteIndexAndFooter(uint64_t index_offset);
+
+  CacheDumpOptions options_;
+  std::shared_ptr<Cache> cache_;
+  std::shared_ptr<FileSystem> fs_;
+  std::string file_name_;
+  std::unique_ptr<WritableFileWriter> file_writer_;
+  std::vector<IndexEntry> index_;
+  std::set<std::string> prefix_filter_;
+  bool dump_all_keys_ = true;
+};
+
+// Read-only access to a cache snapshot file, memory mapped when the
+// FileSystem supports it. The footer and the index are verified by Open(),
+// and each block by ReadBlock().
+class CacheSnapshotReader {
+ public:
+  static IOStatus Open(const std::shared_ptr<FileSystem>& fs,
+                       const std::string& file_name,
+                       std::unique_ptr<CacheSnapshotReader>* reader);
+
+  size_t NumEntries() const { return num_entries_; }
+  Slice KeyAt(size_t i) const;
+  // Binary search of the index. Returns NumEntries() if `key` is not found.
+  size_t Find(const Slice& key) const;
+  // Read the block of the i-th index entry and verify its checksum. `block`
+  // points either into the mapped file or into `scratch`, which is only
+  // allocated when the file is not memory mapped.
+  IOStatus ReadBlock(size_t i, std::unique_ptr<char[]>* scratch,
+                     Slice* block) const;
+
+ private:
+  CacheSnapshotReader() = default;
+
+  const char* EntryAt(size_t i) const {
+    return index_.data() + i * kCacheSnapshotIndexEntrySize;
+  }
+
+  std::unique_ptr<RandomAccessFileReader> file_reader_;
+  // Only used when the file is not memory mapped
+  std::unique_ptr<char[]> index_buf_;
+  bool mmapped_ = false;
+  Slice index_;
+  size_t num_entries_ = 0;
+};
+
+// Bulk loads a cache snapshot into a SecondaryCache
+class CacheSnapshotLoaderImpl : public CacheDumpedLoader {
+ public:
+  CacheSnapshotLoaderImpl(
+      const CacheDumpOptions& dump_options,
+      const std::shared_ptr<FileSystem>& fs, const std::string& file_name,
+      const std::shared_ptr<SecondaryCache>& secondary_cache)
+      : options_(dump_options),
+        fs_(fs),
+        file_name_(file_name),
+        secondary_cache_(secondary_cache) {}
+  Status SetLoadFilter(std::vector<DB*> db_list) override;
+  IOStatus RestoreCacheEntriesToSecondaryCache() override;
+
+ private:
+  CacheDumpOptions options_;
+  std::shared_ptr<FileSystem> fs_;
+  std::string file_name_;
+  std::shared_ptr<SecondaryCache> secondary_cache_;
+  std::set<std::string> prefix_filter_;
+  bool load_all_keys_ = true;
+};
+
+// A read-only SecondaryCache serving the blocks of a cache snapshot straight
+// from the mapped file. Inserts are ignored, and blocks that fail their
+// checksum or are erased are treated as misses from then on.
+class CacheSnapshotSecondaryCache : public SecondaryCache {
+ public:
+  explicit CacheSnapshotSecondaryCache(
+      std::unique_ptr<CacheSnapshotReader>&& reader);
+
+  const char* Name() const override { return "CacheSnapshotSecondaryCache"; }
+
+  Status Insert(const Slice& /*key*/, Cache::ObjectPtr /*obj*/,
+                const Cache::CacheItemHelper* /*helper*/,
+                bool /*force_insert*/) override {
+    return Status::OK();
+  }
+
+  Status InsertSaved(const Slice& /*key*/, const Slice& /*saved*/,
+                     CompressionType /*type*/,
+                     CacheTier /*source*/) override {
+    return Status::OK();
+  }
+
+  std::unique_ptr<SecondaryCacheResultHandle> Lookup(
+      const Slice& key, const Cache::CacheItemHelper* helper,
+      Cache::CreateContext* create_context, bool wait, bool advise_erase,
+      Statistics* stats, bool& kept_in_sec_cache) override;
+
+  bool SupportForceErase() const override { return false; }
+
+  void Erase(const Slice& key) override;
+
+  void WaitAll(std::vector<SecondaryCacheResultHandle*> /*handles*/) override {
+  }
+
+ private:
+  class ResultHandle;
+
+  std::unique_ptr<CacheSnapshotReader> reader_;
+  // One per index entry
+  std::vector<RelaxedAtomic<bool>> dropped_;
+};
+
 // The default implementation of CacheDumpWriter. We write the blocks to a file
 // sequentially.
 class ToFileCacheDumpWriter : public CacheDumpWriter {
@@ -287,6 +439,14 @@ class FromFileCacheDumpReader : public CacheDumpReader {
 // The cache dump and load helper class
 class CacheDumperHelper {
  public:
+  static Status GetStableKeyPrefixes(const std::vector<DB*>& db_list,
+                                     std::set<std::string>* prefixes);
+
+  static bool ShouldFilterOut(const std::set<std::string>& prefix_filter,
+                              const Slice& key);
+
+  static CacheDumpUnitType GetDumpUnitType(CacheEntryRole role);
+
   // serialize the dump_unit_meta to a string, it is fixed 16 bytes size.
   static void EncodeDumpUnitMeta(const DumpUnitMeta& meta, std::string* data) {
     assert(data);
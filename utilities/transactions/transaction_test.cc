@@ -2319,6 +2319,39 @@ TEST_P(TransactionTest, WriteOptionsTest) {
   delete txn;
 }
 
+TEST_P(TransactionTest, WritePinnedBatch) {
+  WriteOptions write_options;
+  write_options.protection_bytes_per_key = 8;
+  ReadOptions read_options;
+  std::string value;
+  const std::string value_a(1000, 'a');
+  const std::string value_b(1000, 'b');
+
+  // The batch locks its keys like a transaction would.
+  WriteBatch batch;
+  ASSERT_OK(batch.PutPinned("foo", value_a));
+  ASSERT_OK(batch.Put("foo2", "small"));
+  ASSERT_OK(batch.PutPinned("foo3", value_b));
+  ASSERT_OK(db->Write(write_options, &batch));
+
+  // And the same without concurrency control
+  TransactionDBWriteOptimizations optimizations;
+  optimizations.skip_concurrency_control = true;
+  batch.Clear();
+  ASSERT_OK(batch.PutPinned("foo4", value_b));
+  ASSERT_OK(batch.Delete("foo2"));
+  ASSERT_OK(db->Write(write_options, optimizations, &batch));
+
+  ASSERT_OK(ReOpenNoDelete());
+  ASSERT_OK(db->Get(read_options, "foo", &value));
+  ASSERT_EQ(value_a, value);
+  ASSERT_TRUE(db->Get(read_options, "foo2", &value).IsNotFound());
+  ASSERT_OK(db->Get(read_options, "foo3", &value));
+  ASSERT_EQ(value_b, value);
+  ASSERT_OK(db->Get(read_options, "foo4", &value));
+  ASSERT_EQ(value_b, value);
+}
+
 TEST_P(TransactionTest, WriteConflictTest) {
   WriteOptions write_options;
   ReadOptions read_options;